@@ -122,6 +122,7 @@ typedef struct {
     uint net_tile_count;
     uint quic_tile_count;
     uint verify_tile_count;
+    uint dedup_tile_count;
     uint bank_tile_count;
     uint shred_tile_count;
   } layout;
@@ -184,8 +185,10 @@ typedef struct {
       uint xdp_rx_queue_size;
       uint xdp_tx_queue_size;
       uint xdp_aio_depth;
+      uint xdp_queues_per_tile;
 
       uint send_buffer_size;
+      int  rx_in_place;
     } net;
 
     struct {
@@ -196,6 +199,8 @@ typedef struct {
       uint max_concurrent_connections;
       uint max_concurrent_streams_per_connection;
       uint stream_pool_cnt;
+      uint staked_connection_reserve;
+      uint unstaked_streams_per_connection;
       uint max_concurrent_handshakes;
       uint max_inflight_quic_packets;
       uint tx_buf_size;
@@ -244,6 +249,9 @@ typedef struct {
     struct {
       char  blockstore_checkpt[ PATH_MAX ];
       int   blockstore_publish;
+      char  blockstore_archive[ PATH_MAX ];
+      ulong blockstore_archive_sz_gb;
+      ulong blockstore_sig_index_lg_max;
       char  capture[ PATH_MAX ];
       char  funk_checkpt[ PATH_MAX ];
       ulong funk_rec_max;
@@ -251,9 +259,12 @@ typedef struct {
       ulong funk_txn_max;
       char  genesis[ PATH_MAX ];
       char  incremental[ PATH_MAX ];
+      ulong jit_cache_sz_mb;
+      ulong owner_index_max;
       char  slots_replayed[PATH_MAX ];
       char  snapshot[ PATH_MAX ];
       char  status_cache[ PATH_MAX ];
+      ulong token_index_max;
       ulong tpool_thread_count;
       uint  cluster_version;
     } replay;
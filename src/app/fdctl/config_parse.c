@@ -264,6 +264,7 @@ fdctl_pod_to_cfg( config_t * config,
   CFG_POP      ( uint,   layout.net_tile_count                            );
   CFG_POP      ( uint,   layout.quic_tile_count                           );
   CFG_POP      ( uint,   layout.verify_tile_count                         );
+  CFG_POP      ( uint,   layout.dedup_tile_count                          );
   CFG_POP      ( uint,   layout.bank_tile_count                           );
   CFG_POP      ( uint,   layout.shred_tile_count                          );
 
@@ -274,7 +275,9 @@ fdctl_pod_to_cfg( config_t * config,
   CFG_POP      ( uint,   tiles.net.xdp_rx_queue_size                      );
   CFG_POP      ( uint,   tiles.net.xdp_tx_queue_size                      );
   CFG_POP      ( uint,   tiles.net.xdp_aio_depth                          );
+  CFG_POP      ( uint,   tiles.net.xdp_queues_per_tile                    );
   CFG_POP      ( uint,   tiles.net.send_buffer_size                       );
+  CFG_POP      ( bool,   tiles.net.rx_in_place                            );
 
   CFG_POP      ( ushort, tiles.quic.regular_transaction_listen_port       );
   CFG_POP      ( ushort, tiles.quic.quic_transaction_listen_port          );
@@ -282,6 +285,8 @@ fdctl_pod_to_cfg( config_t * config,
   CFG_POP      ( uint,   tiles.quic.max_concurrent_connections            );
   CFG_POP      ( uint,   tiles.quic.max_concurrent_streams_per_connection );
   CFG_POP      ( uint,   tiles.quic.stream_pool_cnt                       );
+  CFG_POP      ( uint,   tiles.quic.staked_connection_reserve             );
+  CFG_POP      ( uint,   tiles.quic.unstaked_streams_per_connection       );
   CFG_POP      ( uint,   tiles.quic.max_concurrent_handshakes             );
   CFG_POP      ( uint,   tiles.quic.max_inflight_quic_packets             );
   CFG_POP      ( uint,   tiles.quic.tx_buf_size                           );
@@ -344,6 +349,9 @@ fdctl_pod_to_cfg( config_t * config,
 
   CFG_POP      ( cstr,   tiles.replay.blockstore_checkpt                  );
   CFG_POP      ( bool,   tiles.replay.blockstore_publish                  );
+  CFG_POP      ( cstr,   tiles.replay.blockstore_archive                  );
+  CFG_POP      ( ulong,  tiles.replay.blockstore_archive_sz_gb            );
+  CFG_POP      ( ulong,  tiles.replay.blockstore_sig_index_lg_max         );
   CFG_POP      ( cstr,   tiles.replay.capture                             );
   CFG_POP      ( cstr,   tiles.replay.funk_checkpt                        );
   CFG_POP      ( ulong,  tiles.replay.funk_rec_max                        );
@@ -351,9 +359,12 @@ fdctl_pod_to_cfg( config_t * config,
   CFG_POP      ( ulong,  tiles.replay.funk_txn_max                        );
   CFG_POP      ( cstr,   tiles.replay.genesis                             );
   CFG_POP      ( cstr,   tiles.replay.incremental                         );
+  CFG_POP      ( ulong,  tiles.replay.jit_cache_sz_mb                     );
+  CFG_POP      ( ulong,  tiles.replay.owner_index_max                     );
   CFG_POP      ( cstr,   tiles.replay.slots_replayed                      );
   CFG_POP      ( cstr,   tiles.replay.snapshot                            );
   CFG_POP      ( cstr,   tiles.replay.status_cache                        );
+  CFG_POP      ( ulong,  tiles.replay.token_index_max                     );
   CFG_POP      ( ulong,  tiles.replay.tpool_thread_count                  );
   CFG_POP      ( uint,   tiles.replay.cluster_version                     );
 
@@ -410,6 +421,7 @@ fdctl_cfg_validate( config_t * cfg ) {
   CFG_HAS_NON_ZERO ( layout.net_tile_count );
   CFG_HAS_NON_ZERO ( layout.quic_tile_count );
   CFG_HAS_NON_ZERO ( layout.verify_tile_count );
+  CFG_HAS_NON_ZERO ( layout.dedup_tile_count );
   CFG_HAS_NON_ZERO ( layout.bank_tile_count );
   CFG_HAS_NON_ZERO ( layout.shred_tile_count );
 
@@ -419,6 +431,7 @@ fdctl_cfg_validate( config_t * cfg ) {
   CFG_HAS_POW2     ( tiles.net.xdp_rx_queue_size );
   CFG_HAS_POW2     ( tiles.net.xdp_tx_queue_size );
   CFG_HAS_NON_ZERO ( tiles.net.xdp_aio_depth );
+  CFG_HAS_NON_ZERO ( tiles.net.xdp_queues_per_tile );
   CFG_HAS_NON_ZERO ( tiles.net.send_buffer_size );
 
   CFG_HAS_NON_ZERO( tiles.quic.regular_transaction_listen_port );
@@ -426,6 +439,7 @@ fdctl_cfg_validate( config_t * cfg ) {
   CFG_HAS_NON_ZERO( tiles.quic.max_concurrent_connections );
   CFG_HAS_NON_ZERO( tiles.quic.max_concurrent_streams_per_connection );
   CFG_HAS_NON_ZERO( tiles.quic.stream_pool_cnt );
+  CFG_HAS_NON_ZERO( tiles.quic.unstaked_streams_per_connection );
   CFG_HAS_NON_ZERO( tiles.quic.txn_reassembly_count );
   CFG_HAS_NON_ZERO( tiles.quic.max_concurrent_handshakes );
   CFG_HAS_NON_ZERO( tiles.quic.max_inflight_quic_packets );
@@ -22,7 +22,7 @@ static void
 init_perm( fd_caps_ctx_t *  caps,
            config_t * const config ) {
   (void)config;
-  fd_caps_check_root( caps, NAME, "increase network device channels with `ethtool --set-channels`" );
+  fd_caps_check_root( caps, NAME, "increase network device channels with `ethtool --set-channels` and configure RSS with `ethtool --config-nfc`" );
 }
 
 static int
@@ -56,6 +56,42 @@ device_read_slaves( const char * device,
   output[ strlen( output ) - 1 ] = '\0';
 }
 
+/* RSS_UDP4_HASH is the set of header fields the device should hash
+   UDP/IPv4 packets on to select a receive queue.  Hashing on the ports
+   in addition to the addresses spreads the many flows of a single peer
+   across queues, while still steering all packets of a flow to the
+   same queue, and thus to the same net tile. */
+
+#define RSS_UDP4_HASH (RXH_IP_SRC | RXH_IP_DST | RXH_L4_B_0_1 | RXH_L4_B_2_3)
+
+static void
+init_device_rss( int          sock,
+                 const char * device ) {
+  struct ifreq ifr = {0};
+  strncpy( ifr.ifr_name, device, IF_NAMESIZE-1 );
+
+  /* Reset the RSS indirection table, so that flows are spread evenly
+     across all channels, including any that were just added. */
+
+  struct ethtool_rxfh_indir indir = { .cmd = ETHTOOL_SRXFHINDIR, .size = 0 };
+  ifr.ifr_data = (void *)&indir;
+  FD_LOG_NOTICE(( "RUN: `ethtool --set-rxfh-indir %s default`", device ));
+  if( FD_UNLIKELY( ioctl( sock, SIOCETHTOOL, &ifr ) ) ) {
+    if( FD_LIKELY( errno==EOPNOTSUPP ) ) FD_LOG_WARNING(( "device `%s` does not support configuring the RSS indirection table", device ));
+    else FD_LOG_ERR(( "error configuring network device, ioctl(SIOCETHTOOL,ETHTOOL_SRXFHINDIR) failed (%i-%s)",
+                      errno, fd_io_strerror( errno ) ));
+  }
+
+  struct ethtool_rxnfc nfc = { .cmd = ETHTOOL_SRXFH, .flow_type = UDP_V4_FLOW, .data = RSS_UDP4_HASH };
+  ifr.ifr_data = (void *)&nfc;
+  FD_LOG_NOTICE(( "RUN: `ethtool --config-nfc %s rx-flow-hash udp4 sdfn`", device ));
+  if( FD_UNLIKELY( ioctl( sock, SIOCETHTOOL, &ifr ) ) ) {
+    if( FD_LIKELY( errno==EOPNOTSUPP ) ) FD_LOG_WARNING(( "device `%s` does not support configuring the RSS hash fields", device ));
+    else FD_LOG_ERR(( "error configuring network device, ioctl(SIOCETHTOOL,ETHTOOL_SRXFH) failed (%i-%s)",
+                      errno, fd_io_strerror( errno ) ));
+  }
+}
+
 static void
 init_device( const char * device,
              uint         combined_channel_count ) {
@@ -103,14 +139,25 @@ init_device( const char * device,
                    errno, fd_io_strerror( errno ) ));
   }
 
+  if( FD_LIKELY( combined_channel_count>1U ) ) init_device_rss( sock, device );
+
   if( FD_UNLIKELY( close( sock ) ) )
     FD_LOG_ERR(( "error configuring network device, close() socket failed (%i-%s)", errno, fd_io_strerror( errno ) ));
 }
 
+/* channel_count returns the number of channels the network device
+   needs, one for every queue served by a net tile. */
+
+static uint
+channel_count( config_t const * config ) {
+  return config->layout.net_tile_count * config->tiles.net.xdp_queues_per_tile;
+}
+
 static void
 init( config_t * const config ) {
-  /* we need one channel for both TX and RX on the NIC for each QUIC
-     tile, but the interface probably defaults to one channel total */
+  /* we need one channel for both TX and RX on the NIC for each queue
+     of each net tile, but the interface probably defaults to one
+     channel total */
   if( FD_UNLIKELY( device_is_bonded( config->tiles.net.interface ) ) ) {
     /* if using a bonded device, we need to set channels on the
        underlying devices. */
@@ -118,10 +165,10 @@ init( config_t * const config ) {
     device_read_slaves( config->tiles.net.interface, line );
     char * saveptr;
     for( char * token=strtok_r( line , " \t", &saveptr ); token!=NULL; token=strtok_r( NULL, " \t", &saveptr ) ) {
-      init_device( token, config->layout.net_tile_count );
+      init_device( token, channel_count( config ) );
     }
   } else {
-    init_device( config->tiles.net.interface, config->layout.net_tile_count );
+    init_device( config->tiles.net.interface, channel_count( config ) );
   }
 }
 
@@ -157,9 +204,24 @@ check_device( const char * device,
     }
   }
 
+  /* Devices that cannot configure RSS hash fields are accepted as is,
+     see init_device_rss. */
+
+  struct ethtool_rxnfc nfc = { .cmd = ETHTOOL_GRXFH, .flow_type = UDP_V4_FLOW };
+  ifr.ifr_data = (void *)&nfc;
+  int supports_rss = 1;
+  if( FD_UNLIKELY( ioctl( sock, SIOCETHTOOL, &ifr ) ) ) {
+    if( FD_LIKELY( errno==EOPNOTSUPP ) ) supports_rss = 0;
+    else FD_LOG_ERR(( "error configuring network device `%s`, ioctl(SIOCETHTOOL,ETHTOOL_GRXFH) failed (%i-%s)",
+                      device, errno, fd_io_strerror( errno ) ));
+  }
+
   if( FD_UNLIKELY( close( sock ) ) )
     FD_LOG_ERR(( "error configuring network device, close() socket failed (%i-%s)", errno, fd_io_strerror( errno ) ));
 
+  if( FD_UNLIKELY( supports_rss && expected_channel_count>1U && nfc.data!=RSS_UDP4_HASH ) )
+    NOT_CONFIGURED( "device `%s` does not hash UDP/IPv4 packets on addresses and ports to select a channel", device );
+
   if( channels.combined_count ) {
     current_channels = channels.combined_count;
   } else if( channels.rx_count || channels.tx_count ) {
@@ -177,7 +239,8 @@ check_device( const char * device,
                    "and there must be one channel per tile. You can either use a NIC "
                    "that supports multiple channels, or run Firedancer with only one "
                    "net tile. You can configure Firedancer to run with only one QUIC "
-                   "tile by setting `layout.net_tile_count` to 1 in your "
+                   "tile by setting `layout.net_tile_count` and "
+                   "`tiles.net.xdp_queues_per_tile` to 1 in your "
                    "configuration file. It is not recommended to do this in production "
                    "as it will limit network performance.",
                    device, expected_channel_count ));
@@ -198,10 +261,10 @@ check( config_t * const config ) {
     device_read_slaves( config->tiles.net.interface, line );
     char * saveptr;
     for( char * token=strtok_r( line, " \t", &saveptr ); token!=NULL; token=strtok_r( NULL, " \t", &saveptr ) ) {
-      CHECK( check_device( token, config->layout.net_tile_count ) );
+      CHECK( check_device( token, channel_count( config ) ) );
     }
   } else {
-    CHECK( check_device( config->tiles.net.interface, config->layout.net_tile_count ) );
+    CHECK( check_device( config->tiles.net.interface, channel_count( config ) ) );
   }
 
   CONFIGURE_OK();
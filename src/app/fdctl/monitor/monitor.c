@@ -433,12 +433,18 @@ run_monitor( config_t * const config,
         verify_sent += fd_mcache_seq_query( fd_mcache_seq_laddr( topo->links[ verify->out_link_id_primary ].mcache ) );
       }
 
-      fd_topo_tile_t const * dedup = &topo->tiles[ fd_topo_find_tile( topo, "dedup", 0UL ) ];
+      /* Each verified txn is seen by every dedup tile, and filtered by
+         all but the one owning its shard, so discount those. */
       ulong dedup_failed = 0UL;
-      for( ulong i=0UL; i<config->layout.verify_tile_count; i++) {
-        dedup_failed += fd_metrics_link_in( dedup->metrics, i )[ FD_METRICS_COUNTER_LINK_FILTERED_COUNT_OFF ];
+      ulong dedup_sent   = 0UL;
+      for( ulong i=0UL; i<config->layout.dedup_tile_count; i++ ) {
+        fd_topo_tile_t const * dedup = &topo->tiles[ fd_topo_find_tile( topo, "dedup", i ) ];
+        for( ulong j=0UL; j<config->layout.verify_tile_count; j++) {
+          dedup_failed += fd_metrics_link_in( dedup->metrics, j )[ FD_METRICS_COUNTER_LINK_FILTERED_COUNT_OFF ];
+        }
+        dedup_sent += fd_mcache_seq_query( fd_mcache_seq_laddr( topo->links[ dedup->out_link_id_primary ].mcache ) );
       }
-      ulong dedup_sent = fd_mcache_seq_query( fd_mcache_seq_laddr( topo->links[ dedup->out_link_id_primary ].mcache ) );
+      dedup_failed -= fd_ulong_min( dedup_failed, (config->layout.dedup_tile_count-1UL)*verify_sent );
 
       fd_topo_tile_t const * pack = &topo->tiles[ fd_topo_find_tile( topo, "pack", 0UL ) ];
       ulong * pack_metrics = fd_metrics_tile( pack->metrics );
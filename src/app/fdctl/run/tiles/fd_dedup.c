@@ -10,7 +10,13 @@
 
    The dedup tile is simply a wrapper around the mux tile, that also
    checks the transaction signature field for duplicates and filters
-   them out. */
+   them out.
+
+   There can be multiple dedup tiles, in which case the transaction
+   signature space is partitioned between them.  Every dedup tile reads
+   from every verify tile, and only keeps the transactions of its own
+   shard (see fd_disco_dedup_shard), so each dedup tile owns a disjoint
+   part of the signature history, and pack merges their outputs. */
 
 /* fd_dedup_in_ctx_t is a context object for each in (producer) mcache
    connected to the dedup tile. */
@@ -31,6 +37,9 @@ typedef struct {
   ulong * tcache_ring;
   ulong * tcache_map;
 
+  ulong   shard_cnt;
+  ulong   shard_idx;
+
   fd_dedup_in_ctx_t in[ 64UL ];
 
   fd_wksp_t * out_mem;
@@ -58,6 +67,23 @@ mux_ctx( void * scratch ) {
   return (void*)fd_ulong_align_up( (ulong)scratch, alignof( fd_dedup_ctx_t ) );
 }
 
+/* before_frag is called when a new fragment has been detected on an
+   in link.  Transactions belonging to the shard of another dedup tile
+   are skipped without reading them. */
+
+static inline void
+before_frag( void * _ctx,
+             ulong  in_idx,
+             ulong  seq,
+             ulong  sig,
+             int *  opt_filter ) {
+  (void)in_idx;
+  (void)seq;
+
+  fd_dedup_ctx_t * ctx = (fd_dedup_ctx_t *)_ctx;
+  if( FD_LIKELY( fd_disco_dedup_shard( sig, ctx->shard_cnt )!=ctx->shard_idx ) ) *opt_filter = 1;
+}
+
 /* during_frag is called between pairs for sequence number checks, as
    we are reading incoming frags.  We don't actually need to copy the
    fragment here, flow control prevents it getting overrun, and
@@ -146,6 +172,9 @@ unprivileged_init( fd_topo_t *      topo,
   ctx->tcache_ring    = fd_tcache_ring_laddr  ( tcache );
   ctx->tcache_map     = fd_tcache_map_laddr   ( tcache );
 
+  ctx->shard_cnt = fd_topo_tile_name_cnt( topo, tile->name );
+  ctx->shard_idx = tile->kind_id;
+
   FD_TEST( tile->in_cnt<=sizeof( ctx->in )/sizeof( ctx->in[ 0 ] ) );
   for( ulong i=0; i<tile->in_cnt; i++ ) {
     fd_topo_link_t * link = &topo->links[ tile->in_link_id[ i ] ];
@@ -194,6 +223,7 @@ fd_topo_run_tile_t fd_tile_dedup = {
   .mux_flags                = FD_MUX_FLAG_COPY,
   .burst                    = 1UL,
   .mux_ctx                  = mux_ctx,
+  .mux_before_frag          = before_frag,
   .mux_during_frag          = during_frag,
   .mux_after_frag           = after_frag,
   .populate_allowed_seccomp = populate_allowed_seccomp,
@@ -44,6 +44,16 @@
 #include <linux/unistd.h>
 
 #define MAX_NET_INS (32UL)
+#define MAX_NET_OUT_CONSUMERS (32UL)
+
+/* MAX_NET_QUEUES is the max number of RX queues of the main interface
+   served by a single net tile, each with its own XSK.  Bounded by the
+   number of XSK file descriptors in net.seccomppolicy.  MAX_NET_XSKS
+   additionally counts the loopback XSK. */
+#define MAX_NET_QUEUES (4UL)
+#define MAX_NET_XSKS   (MAX_NET_QUEUES+1UL)
+
+FD_STATIC_ASSERT( MAX_NET_XSKS<=FD_NET_MTU, hold_encoding );
 
 typedef struct {
   fd_wksp_t * mem;
@@ -61,11 +71,26 @@ typedef struct {
   ulong       chunk0;
   ulong       wmark;
   ulong       chunk;
+
+  /* Only used if rx_in_place.  hold[ seq & hold_mask ] is the UMEM
+     frame of the frag published at seq, as frame_off|xsk_idx (frame
+     offsets are multiples of FD_NET_MTU, which exceeds MAX_NET_XSKS).
+     Frames of frags in [release_seq,seq) may still be read by a
+     consumer, whose progress is tracked by cons_fseq. */
+  ulong *       hold;
+  ulong         hold_mask;
+  ulong         release_seq;
+  ulong         cons_cnt;
+  ulong const * cons_fseq[ MAX_NET_OUT_CONSUMERS ];
 } fd_net_out_ctx_t;
 
 typedef struct {
+  /* xsk_aio[ i ] for i in [0,xsk_aio_cnt) are the XSKs serviced by this
+     tile, one per RX queue of the main interface, followed by the
+     loopback XSK (if any) at lo_xsk_idx. */
   ulong xsk_aio_cnt;
-  fd_xsk_aio_t * xsk_aio[ 2 ];
+  ulong lo_xsk_idx;
+  fd_xsk_aio_t * xsk_aio[ MAX_NET_XSKS ];
 
   ulong round_robin_cnt;
   ulong round_robin_id;
@@ -95,11 +120,23 @@ typedef struct {
 
   fd_ip_t *   ip;
   long        ip_next_upd;
+
+  /* If rx_in_place, received packets are published from the UMEM
+     frame they were received in.  spare[ i ] is a stack of spare_cnt[ i ]
+     free frames of xsk_aio[ i ], handed to the fill ring in exchange for
+     frames held by an out link.  rx_xsk_idx is the xsk_aio currently
+     being serviced. */
+  int     rx_in_place;
+  ulong   rx_xsk_idx;
+  uchar * umem[ MAX_NET_XSKS ];
+  ulong * spare[ MAX_NET_XSKS ];
+  ulong   spare_cnt[ MAX_NET_XSKS ];
 } fd_net_ctx_t;
 
 typedef struct {
-  fd_xsk_t * xsk;
-  void *     xsk_aio;
+  ulong      xsk_cnt;
+  fd_xsk_t * xsk[ MAX_NET_QUEUES ];
+  void *     xsk_aio[ MAX_NET_QUEUES ];
   int        xsk_map_fd;
   int        xdp_prog_link_fd;
 
@@ -136,6 +173,14 @@ scratch_align( void ) {
   return 4096UL;
 }
 
+/* rx_frame_max returns the max number of spare UMEM frames of an XSK,
+   which also bounds the number of frames held by out links. */
+
+FD_FN_PURE static inline ulong
+rx_frame_max( fd_topo_tile_t const * tile ) {
+  return tile->net.xdp_rx_queue_size + tile->net.xdp_tx_queue_size;
+}
+
 FD_FN_PURE static inline ulong
 scratch_footprint( fd_topo_tile_t const * tile ) {
   /* TODO reproducing this conditional memory layout twice is susceptible to bugs. Use more robust object discovery */
@@ -144,15 +189,23 @@ scratch_footprint( fd_topo_tile_t const * tile ) {
   l = FD_LAYOUT_APPEND( l, alignof(fd_net_init_ctx_t), sizeof(fd_net_init_ctx_t) );
   l = FD_LAYOUT_APPEND( l, alignof(fd_net_ctx_t),      sizeof(fd_net_ctx_t) );
   l = FD_LAYOUT_APPEND( l, fd_aio_align(),             fd_aio_footprint() );
+  if( tile->net.rx_in_place ) {
+    l = FD_LAYOUT_APPEND( l, alignof(ulong), MAX_NET_XSKS*rx_frame_max( tile )*sizeof(ulong) ); /* spare */
+    l = FD_LAYOUT_APPEND( l, alignof(ulong), 4UL*rx_frame_max( tile )*sizeof(ulong) ); /* hold */
+  }
   if( tile->kind_id == 0 ) {
     l = FD_LAYOUT_APPEND( l, alignof(fd_xdp_session_t),      sizeof(fd_xdp_session_t)      );
     l = FD_LAYOUT_APPEND( l, alignof(fd_xdp_link_session_t), sizeof(fd_xdp_link_session_t) );
     l = FD_LAYOUT_APPEND( l, alignof(fd_xdp_link_session_t), sizeof(fd_xdp_link_session_t) );
   }
-  l = FD_LAYOUT_APPEND( l, fd_xsk_align(),     fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size ) );
-  l = FD_LAYOUT_APPEND( l, fd_xsk_aio_align(), fd_xsk_aio_footprint( tile->net.xdp_tx_queue_size, tile->net.xdp_aio_depth ) );
+  /* If rx_in_place, the XSKs live in the dcache shared by the out links
+     instead, see privileged_init */
+  for( ulong i=0UL; i<tile->net.xdp_queue_cnt; i++ ) {
+    if( !tile->net.rx_in_place ) l = FD_LAYOUT_APPEND( l, fd_xsk_align(), fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size ) );
+    l = FD_LAYOUT_APPEND( l, fd_xsk_aio_align(), fd_xsk_aio_footprint( tile->net.xdp_tx_queue_size, tile->net.xdp_aio_depth ) );
+  }
   if( FD_UNLIKELY( strcmp( tile->net.interface, "lo" ) && tile->kind_id == 0 ) ) {
-    l = FD_LAYOUT_APPEND( l, fd_xsk_align(),     fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size ) );
+    if( !tile->net.rx_in_place ) l = FD_LAYOUT_APPEND( l, fd_xsk_align(), fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size ) );
     l = FD_LAYOUT_APPEND( l, fd_xsk_aio_align(), fd_xsk_aio_footprint( tile->net.xdp_tx_queue_size, tile->net.xdp_aio_depth ) );
   }
   l = FD_LAYOUT_APPEND( l, fd_ip_align(), fd_ip_footprint( 0U, 0U ) );
@@ -165,6 +218,60 @@ mux_ctx( void * scratch ) {
   return (void*)fd_ulong_align_up( net_init + sizeof( fd_net_init_ctx_t ), alignof( fd_net_ctx_t ) );
 }
 
+/* net_out_release returns the UMEM frames of all frags of out that
+   were consumed by every consumer to the spare frames.  The consumer
+   fseqs are only updated during housekeeping of the consumer, so this
+   lags behind actual consumption a bit. */
+
+static void
+net_out_release( fd_net_ctx_t *     ctx,
+                 fd_net_out_ctx_t * out ) {
+  ulong seq = out->seq;
+  for( ulong i=0UL; i<out->cons_cnt; i++ ) {
+    ulong cons_seq = fd_fseq_query( out->cons_fseq[ i ] );
+    if( fd_seq_lt( cons_seq, seq ) ) seq = cons_seq;
+  }
+
+  for( ; fd_seq_lt( out->release_seq, seq ); out->release_seq = fd_seq_inc( out->release_seq, 1UL ) ) {
+    ulong frame   = out->hold[ out->release_seq & out->hold_mask ];
+    ulong xsk_idx = frame &  (FD_NET_MTU-1UL);
+    ctx->spare[ xsk_idx ][ ctx->spare_cnt[ xsk_idx ]++ ] = frame & ~(FD_NET_MTU-1UL);
+  }
+}
+
+/* net_rx_hold takes ownership of the UMEM frame of the pkt_idx-th
+   packet of the batch currently being received, so it can be published
+   to out in place.  On success, returns 1 and sets *chunk to the chunk
+   of the packet.  Returns 0 if the packet has to be dropped because
+   consumers of out are too far behind. */
+
+static inline int
+net_rx_hold( fd_net_ctx_t *     ctx,
+             fd_net_out_ctx_t * out,
+             ulong              pkt_idx,
+             uchar *            packet,
+             ulong              sz,
+             ulong *            chunk ) {
+  if( FD_UNLIKELY( fd_seq_diff( out->seq, out->release_seq )>(long)out->hold_mask ) ) {
+    net_out_release( ctx, out );
+    if( FD_UNLIKELY( fd_seq_diff( out->seq, out->release_seq )>(long)out->hold_mask ) ) return 0;
+  }
+
+  ulong xsk_idx = ctx->rx_xsk_idx;
+  if( FD_UNLIKELY( !ctx->spare_cnt[ xsk_idx ] ) ) return 0;
+
+  ulong   frame_off = fd_xsk_aio_rx_swap( ctx->xsk_aio[ xsk_idx ], pkt_idx, ctx->spare[ xsk_idx ][ --ctx->spare_cnt[ xsk_idx ] ] );
+  uchar * frame     = ctx->umem[ xsk_idx ] + frame_off;
+
+  /* Frags must start at a chunk boundary, so move the packet to the
+     start of its frame if the kernel placed it at an offset */
+  if( FD_UNLIKELY( packet!=frame ) ) memmove( frame, packet, sz );
+
+  out->hold[ out->seq & out->hold_mask ] = frame_off | xsk_idx;
+  *chunk = fd_laddr_to_chunk( out->mem, frame );
+  return 1;
+}
+
 /* net_rx_aio_send is a callback invoked by aio when new data is
    received on an incoming xsk.  The xsk might be bound to any interface
    or ports, so the purpose of this callback is to determine if the
@@ -252,16 +359,22 @@ net_rx_aio_send( void *                    _ctx,
                    ctx->repair_serve_listen_port ));
     }
 
-    fd_memcpy( fd_chunk_to_laddr( out->mem, out->chunk ), packet, batch[ i ].buf_sz );
+    ulong chunk;
+    if( ctx->rx_in_place ) {
+      if( FD_UNLIKELY( !net_rx_hold( ctx, out, i, (uchar *)packet, batch[ i ].buf_sz, &chunk ) ) ) continue;
+    } else {
+      chunk = out->chunk;
+      fd_memcpy( fd_chunk_to_laddr( out->mem, chunk ), packet, batch[ i ].buf_sz );
+      out->chunk = fd_dcache_compact_next( out->chunk, FD_NET_MTU, out->chunk0, out->wmark );
+    }
 
     /* tile can decide how to partition based on src ip addr and src port */
     ulong sig = fd_disco_netmux_sig( ip_srcaddr, udp_srcport, 0U, proto, 14UL+8UL+iplen );
 
     ulong tspub  = (ulong)fd_frag_meta_ts_comp( fd_tickcount() );
-    fd_mcache_publish( out->mcache, out->depth, out->seq, sig, out->chunk, batch[ i ].buf_sz, 0, 0, tspub );
+    fd_mcache_publish( out->mcache, out->depth, out->seq, sig, chunk, batch[ i ].buf_sz, 0, 0, tspub );
 
     out->seq = fd_seq_inc( out->seq, 1UL );
-    out->chunk = fd_dcache_compact_next( out->chunk, FD_NET_MTU, out->chunk0, out->wmark );
   }
 
   if( FD_LIKELY( opt_batch_idx ) ) {
@@ -279,6 +392,7 @@ before_credit( void * _ctx,
   fd_net_ctx_t * ctx = (fd_net_ctx_t *)_ctx;
 
   for( ulong i=0; i<ctx->xsk_aio_cnt; i++ ) {
+    ctx->rx_xsk_idx = i;
     fd_xsk_aio_service( ctx->xsk_aio[i] );
   }
 }
@@ -286,6 +400,13 @@ before_credit( void * _ctx,
 static void
 during_housekeeping( void * _ctx ) {
   fd_net_ctx_t * ctx = (fd_net_ctx_t *)_ctx;
+  if( ctx->rx_in_place ) {
+    fd_net_out_ctx_t * outs[ 4 ] = { ctx->quic_out, ctx->shred_out, ctx->gossip_out, ctx->repair_out };
+    for( ulong i=0UL; i<4UL; i++ ) {
+      if( FD_LIKELY( outs[ i ]->mcache ) ) net_out_release( ctx, outs[ i ] );
+    }
+  }
+
   long now = fd_log_wallclock();
   if( FD_UNLIKELY( now > ctx->ip_next_upd ) ) {
     ctx->ip_next_upd = now + (long)60e9;
@@ -402,7 +523,7 @@ after_frag( void *             _ctx,
 
   fd_aio_pkt_info_t aio_buf = { .buf = ctx->frame, .buf_sz = (ushort)*opt_sz };
   if( FD_UNLIKELY( route_loopback( ctx->src_ip_addr, *opt_sig ) ) ) {
-    ctx->lo_tx->send_func( ctx->xsk_aio[ 1 ], &aio_buf, 1, NULL, 1 );
+    ctx->lo_tx->send_func( ctx->xsk_aio[ ctx->lo_xsk_idx ], &aio_buf, 1, NULL, 1 );
   } else {
     /* extract dst ip */
     uint dst_ip = fd_uint_bswap( fd_disco_netmux_sig_dst_ip( *opt_sig ) );
@@ -585,6 +706,10 @@ privileged_init( fd_topo_t *      topo,
   fd_net_init_ctx_t * ctx = fd_net_init_ctx_init( FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_net_init_ctx_t), sizeof(fd_net_init_ctx_t) ) );
   FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_net_ctx_t), sizeof(fd_net_ctx_t) );
   FD_SCRATCH_ALLOC_APPEND( l, fd_aio_align(),        fd_aio_footprint()   );
+  if( tile->net.rx_in_place ) {
+    FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong), 2UL*rx_frame_max( tile )*sizeof(ulong) );
+    FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong), 4UL*rx_frame_max( tile )*sizeof(ulong) );
+  }
 
   uint if_idx = if_nametoindex( tile->net.interface );
   if( FD_UNLIKELY( !if_idx ) ) FD_LOG_ERR(( "if_nametoindex(%s) failed", tile->net.interface ));
@@ -638,35 +763,76 @@ privileged_init( fd_topo_t *      topo,
 
   }
 
-  /* Create and install XSKs */
+  /* Create and install XSKs
+
+     If rx_in_place, the XSKs (including their UMEM) are placed in the
+     dcache shared by the out links, rather than in tile scratch, so
+     that consumers can read received packets in place.  Every UMEM
+     frame must be below the dcache watermark, as consumers bounds
+     check chunks against it. */
+
+  ulong xsk_cnt = tile->net.xdp_queue_cnt;
+  if( FD_UNLIKELY( !xsk_cnt || xsk_cnt>MAX_NET_QUEUES ) )
+    FD_LOG_ERR(( "net tile xdp_queue_cnt %lu must be in [1,%lu]", xsk_cnt, MAX_NET_QUEUES ));
+
+  ulong  xsk_footprint = fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size );
+  void * xsk_mem[ MAX_NET_QUEUES ];
+  void * lo_xsk_mem = NULL;
+  if( tile->net.rx_in_place ) {
+    if( FD_UNLIKELY( !tile->out_cnt ) ) FD_LOG_ERR(( "net tile has no out links" ));
+    uchar * umem = fd_dcache_join( fd_topo_obj_laddr( topo, topo->links[ tile->out_link_id[ 0 ] ].dcache_obj_id ) );
+    if( FD_UNLIKELY( !umem ) ) FD_LOG_ERR(( "fd_dcache_join failed" ));
+
+    ulong mem = (ulong)umem;
+    for( ulong i=0UL; i<xsk_cnt; i++ ) {
+      mem          = fd_ulong_align_up( mem, fd_xsk_align() );
+      xsk_mem[ i ] = (void *)mem;
+      mem         += xsk_footprint;
+    }
+    mem        = fd_ulong_align_up( mem, fd_xsk_align() );
+    lo_xsk_mem = (void *)mem;
+    mem       += xsk_footprint;
+    if( FD_UNLIKELY( mem+FD_NET_MTU > (ulong)umem+fd_dcache_data_sz( umem ) ) )
+      FD_LOG_ERR(( "net tile UMEM dcache too small (%lu bytes, need %lu)", fd_dcache_data_sz( umem ), mem+FD_NET_MTU-(ulong)umem ));
+  }
+
+  /* Net tile i serves RX queues [i*xsk_cnt,(i+1)*xsk_cnt) of the
+     interface, with one XSK each.  The XDP program redirects packets
+     to the XSK registered in the XSKMAP at their RX queue index. */
 
-  fd_xsk_t * xsk =
-      fd_xsk_join(
-      fd_xsk_new( FD_SCRATCH_ALLOC_APPEND( l, fd_xsk_align(), fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size ) ),
-                  FD_NET_MTU,
-                  tile->net.xdp_rx_queue_size,
-                  tile->net.xdp_rx_queue_size,
-                  tile->net.xdp_tx_queue_size,
-                  tile->net.xdp_tx_queue_size ) );
-  if( FD_UNLIKELY( !xsk ) ) FD_LOG_ERR(( "fd_xsk_new failed" ));
-  
   uint flags = tile->net.zero_copy ? XDP_ZEROCOPY : XDP_COPY;
-  if( FD_UNLIKELY( !fd_xsk_init( xsk, if_idx, (uint)tile->kind_id, flags ) ) )
-    FD_LOG_ERR(( "failed to bind xsk for net tile %lu", tile->kind_id ));
+  for( ulong i=0UL; i<xsk_cnt; i++ ) {
+    if( !tile->net.rx_in_place ) xsk_mem[ i ] = FD_SCRATCH_ALLOC_APPEND( l, fd_xsk_align(), xsk_footprint );
 
-  if( FD_UNLIKELY( !fd_xsk_activate( xsk, ctx->xsk_map_fd ) ) )
-    FD_LOG_ERR(( "failed to activate xsk for net tile %lu", tile->kind_id ));
-  ctx->xsk = xsk;
+    fd_xsk_t * xsk =
+        fd_xsk_join(
+        fd_xsk_new( xsk_mem[ i ],
+                    FD_NET_MTU,
+                    tile->net.xdp_rx_queue_size,
+                    tile->net.xdp_rx_queue_size,
+                    tile->net.xdp_tx_queue_size,
+                    tile->net.xdp_tx_queue_size ) );
+    if( FD_UNLIKELY( !xsk ) ) FD_LOG_ERR(( "fd_xsk_new failed" ));
+
+    uint queue_id = (uint)( tile->kind_id*xsk_cnt + i );
+    if( FD_UNLIKELY( !fd_xsk_init( xsk, if_idx, queue_id, flags ) ) )
+      FD_LOG_ERR(( "failed to bind xsk for net tile %lu to queue %u", tile->kind_id, queue_id ));
+
+    if( FD_UNLIKELY( !fd_xsk_activate( xsk, ctx->xsk_map_fd ) ) )
+      FD_LOG_ERR(( "failed to activate xsk for net tile %lu on queue %u", tile->kind_id, queue_id ));
+    ctx->xsk[ i ] = xsk;
+
+    ctx->xsk_aio[ i ] = fd_xsk_aio_new( FD_SCRATCH_ALLOC_APPEND( l, fd_xsk_aio_align(), fd_xsk_aio_footprint( tile->net.xdp_tx_queue_size, tile->net.xdp_aio_depth ) ),
+                                        tile->net.xdp_tx_queue_size,
+                                        tile->net.xdp_aio_depth );
+    if( FD_UNLIKELY( !ctx->xsk_aio[ i ] ) ) FD_LOG_ERR(( "fd_xsk_aio_new failed" ));
+  }
+  ctx->xsk_cnt = xsk_cnt;
   if( tile->kind_id != 0 ) {
     FD_TEST( 0==close( ctx->xsk_map_fd ) );
     ctx->xsk_map_fd = -1;
   }
 
-  ctx->xsk_aio = fd_xsk_aio_new( FD_SCRATCH_ALLOC_APPEND( l, fd_xsk_aio_align(), fd_xsk_aio_footprint( tile->net.xdp_tx_queue_size, tile->net.xdp_aio_depth ) ),
-                                 tile->net.xdp_tx_queue_size,
-                                 tile->net.xdp_aio_depth );
-  if( FD_UNLIKELY( !ctx->xsk_aio ) ) FD_LOG_ERR(( "fd_xsk_aio_new failed" ));
-
   /* Networking tile at index 0 also binds to loopback (only queue 0 available on lo) */
 
   ctx->lo_xsk     = NULL;
@@ -675,7 +841,7 @@ privileged_init( fd_topo_t *      topo,
 
     fd_xsk_t * lo_xsk =
         fd_xsk_join( 
-        fd_xsk_new( FD_SCRATCH_ALLOC_APPEND( l, fd_xsk_align(), fd_xsk_footprint( FD_NET_MTU, tile->net.xdp_rx_queue_size, tile->net.xdp_rx_queue_size, tile->net.xdp_tx_queue_size, tile->net.xdp_tx_queue_size ) ),
+        fd_xsk_new( tile->net.rx_in_place ? lo_xsk_mem : FD_SCRATCH_ALLOC_APPEND( l, fd_xsk_align(), xsk_footprint ),
                     FD_NET_MTU,
                     tile->net.xdp_rx_queue_size,
                     tile->net.xdp_rx_queue_size,
@@ -700,6 +866,66 @@ privileged_init( fd_topo_t *      topo,
                                    0UL, 0UL ) );
 }
 
+/* rx_in_place_init sets up publishing received packets in place.  The
+   spare frames of each XSK are split evenly between the out links, so
+   that consumers falling behind on one link cannot starve the fill
+   ring and thereby the other links. */
+
+static void
+rx_in_place_init( fd_net_ctx_t *            ctx,
+                  fd_topo_t *               topo,
+                  fd_topo_tile_t *          tile,
+                  fd_net_init_ctx_t const * init_ctx,
+                  ulong *                   spare,
+                  ulong *                   hold ) {
+  ulong frame_max = rx_frame_max( tile );
+
+  fd_xsk_t * xsks[ MAX_NET_XSKS ];
+  for( ulong i=0UL; i<init_ctx->xsk_cnt; i++ ) xsks[ i ] = init_ctx->xsk[ i ];
+  if( init_ctx->lo_xsk ) xsks[ ctx->lo_xsk_idx ] = init_ctx->lo_xsk;
+  ulong spare_min = ULONG_MAX;
+  for( ulong i=0UL; i<ctx->xsk_aio_cnt; i++ ) {
+    ctx->umem     [ i ] = fd_xsk_umem_laddr( xsks[ i ] );
+    ctx->spare    [ i ] = spare + i*frame_max;
+    ctx->spare_cnt[ i ] = fd_ulong_min( fd_xsk_aio_spare_cnt( ctx->xsk_aio[ i ] ), frame_max );
+    for( ulong j=0UL; j<ctx->spare_cnt[ i ]; j++ ) ctx->spare[ i ][ j ] = fd_xsk_aio_spare_off( ctx->xsk_aio[ i ], j );
+    spare_min = fd_ulong_min( spare_min, ctx->spare_cnt[ i ] );
+  }
+
+  ulong hold_depth = spare_min / tile->out_cnt;
+  if( FD_UNLIKELY( !hold_depth ) ) FD_LOG_ERR(( "not enough spare UMEM frames (%lu) for %lu out links", spare_min, tile->out_cnt ));
+  hold_depth = fd_ulong_pow2_dn( hold_depth );
+
+  for( ulong i=0UL; i<tile->out_cnt; i++ ) {
+    fd_topo_link_t const * link = &topo->links[ tile->out_link_id[ i ] ];
+    if( FD_UNLIKELY( link->dcache_obj_id!=topo->links[ tile->out_link_id[ 0 ] ].dcache_obj_id ) )
+      FD_LOG_ERR(( "out link `%s` does not share the UMEM dcache", link->name ));
+
+    fd_net_out_ctx_t * out = NULL;
+    if(      !strcmp( link->name, "net_quic"   ) ) out = ctx->quic_out;
+    else if( !strcmp( link->name, "net_shred"  ) ) out = ctx->shred_out;
+    else if( !strcmp( link->name, "net_gossip" ) ) out = ctx->gossip_out;
+    else if( !strcmp( link->name, "net_repair" ) ) out = ctx->repair_out;
+    else FD_LOG_ERR(( "unrecognized out link `%s`", link->name ));
+
+    /* Consumers must not be overrun, they may not detect it as frames
+       are reused out of order */
+    out->hold        = hold + i*frame_max;
+    out->hold_mask   = fd_ulong_min( hold_depth, fd_ulong_pow2_dn( out->depth ) ) - 1UL;
+    out->release_seq = out->seq;
+    out->cons_cnt    = 0UL;
+    for( ulong j=0UL; j<topo->tile_cnt; j++ ) {
+      fd_topo_tile_t const * consumer = &topo->tiles[ j ];
+      for( ulong k=0UL; k<consumer->in_cnt; k++ ) {
+        if( consumer->in_link_id[ k ]!=link->id ) continue;
+        if( FD_UNLIKELY( out->cons_cnt>=MAX_NET_OUT_CONSUMERS ) ) FD_LOG_ERR(( "too many consumers of out link `%s`", link->name ));
+        if( FD_UNLIKELY( !consumer->in_link_fseq[ k ] ) ) FD_LOG_ERR(( "fseq of consumer `%s` of out link `%s` is not mapped", consumer->name, link->name ));
+        out->cons_fseq[ out->cons_cnt++ ] = consumer->in_link_fseq[ k ];
+      }
+    }
+  }
+}
+
 static void
 unprivileged_init( fd_topo_t *      topo,
                    fd_topo_tile_t * tile,
@@ -710,21 +936,34 @@ unprivileged_init( fd_topo_t *      topo,
   fd_net_ctx_t *      ctx        = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_net_ctx_t),      sizeof(fd_net_ctx_t)      );
   fd_aio_t *          net_rx_aio = fd_aio_join( fd_aio_new( FD_SCRATCH_ALLOC_APPEND( l, fd_aio_align(), fd_aio_footprint() ), ctx, net_rx_aio_send ) );
   if( FD_UNLIKELY( !net_rx_aio ) ) FD_LOG_ERR(( "fd_aio_join failed" ));
+  ulong * spare = NULL;
+  ulong * hold  = NULL;
+  if( tile->net.rx_in_place ) {
+    spare = FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong), MAX_NET_XSKS*rx_frame_max( tile )*sizeof(ulong) );
+    hold  = FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong), 4UL*rx_frame_max( tile )*sizeof(ulong) );
+  }
 
+  ctx->rx_in_place     = tile->net.rx_in_place;
   ctx->round_robin_cnt = fd_topo_tile_name_cnt( topo, tile->name );
   ctx->round_robin_id  = tile->kind_id;
 
-  ctx->xsk_aio_cnt = 1;
-  ctx->xsk_aio[ 0 ] = fd_xsk_aio_join( init_ctx->xsk_aio, init_ctx->xsk );
-  if( FD_UNLIKELY( !ctx->xsk_aio[ 0 ] ) ) FD_LOG_ERR(( "fd_xsk_aio_join failed" ));
-  fd_xsk_aio_set_rx( ctx->xsk_aio[ 0 ], net_rx_aio );
-  ctx->tx = fd_xsk_aio_get_tx( init_ctx->xsk_aio );
+  /* All outgoing packets on the main interface are sent on the XSK of
+     the first queue, received packets are taken from every queue. */
+
+  for( ulong i=0UL; i<init_ctx->xsk_cnt; i++ ) {
+    ctx->xsk_aio[ i ] = fd_xsk_aio_join( init_ctx->xsk_aio[ i ], init_ctx->xsk[ i ] );
+    if( FD_UNLIKELY( !ctx->xsk_aio[ i ] ) ) FD_LOG_ERR(( "fd_xsk_aio_join failed" ));
+    fd_xsk_aio_set_rx( ctx->xsk_aio[ i ], net_rx_aio );
+  }
+  ctx->xsk_aio_cnt = init_ctx->xsk_cnt;
+  ctx->tx = fd_xsk_aio_get_tx( init_ctx->xsk_aio[ 0 ] );
   if( FD_UNLIKELY( init_ctx->lo_xsk ) ) {
-    ctx->xsk_aio[ 1 ] = fd_xsk_aio_join( init_ctx->lo_xsk_aio, init_ctx->lo_xsk );
-    if( FD_UNLIKELY( !ctx->xsk_aio[ 1 ] ) ) FD_LOG_ERR(( "fd_xsk_aio_join failed" ));
-    fd_xsk_aio_set_rx( ctx->xsk_aio[ 1 ], net_rx_aio );
+    ctx->lo_xsk_idx = ctx->xsk_aio_cnt;
+    ctx->xsk_aio[ ctx->lo_xsk_idx ] = fd_xsk_aio_join( init_ctx->lo_xsk_aio, init_ctx->lo_xsk );
+    if( FD_UNLIKELY( !ctx->xsk_aio[ ctx->lo_xsk_idx ] ) ) FD_LOG_ERR(( "fd_xsk_aio_join failed" ));
+    fd_xsk_aio_set_rx( ctx->xsk_aio[ ctx->lo_xsk_idx ], net_rx_aio );
     ctx->lo_tx = fd_xsk_aio_get_tx( init_ctx->lo_xsk_aio );
-    ctx->xsk_aio_cnt = 2;
+    ctx->xsk_aio_cnt++;
   }
 
   ctx->src_ip_addr = tile->net.src_ip_addr;
@@ -813,6 +1052,8 @@ unprivileged_init( fd_topo_t *      topo,
     FD_LOG_ERR(( "repair serve listen port set but no out link was found" ));
   }
 
+  if( tile->net.rx_in_place ) rx_in_place_init( ctx, topo, tile, init_ctx, spare, hold );
+
   ctx->ip = init_ctx->ip;
 
   ulong scratch_top = FD_SCRATCH_ALLOC_FINI( l, 1UL );
@@ -827,12 +1068,19 @@ populate_allowed_seccomp( void *               scratch,
   FD_SCRATCH_ALLOC_INIT( l, scratch );
   fd_net_init_ctx_t * init_ctx = FD_SCRATCH_ALLOC_APPEND( l, alignof( fd_net_init_ctx_t ), sizeof( fd_net_init_ctx_t ) );
 
-  /* A bit of a hack, if there is no loopback XSK for this tile, we still need to pass
-     two "allow" FD arguments to the net policy, so we just make them both the same. */
-  int allow_fd2 = init_ctx->lo_xsk ? init_ctx->lo_xsk->xsk_fd : init_ctx->xsk->xsk_fd;
-  FD_TEST( init_ctx->xsk->xsk_fd >= 0 && allow_fd2 >= 0 );
+  /* A bit of a hack, the net policy takes a fixed number of "allow" XSK
+     FD arguments.  Slots of queues this tile doesn't serve, and the
+     loopback slot if there is no loopback XSK for this tile, are just
+     filled with the FD of the first XSK. */
+  uint allow_fd[ MAX_NET_XSKS ];
+  for( ulong i=0UL; i<MAX_NET_QUEUES; i++ ) {
+    fd_xsk_t * xsk = init_ctx->xsk[ i<init_ctx->xsk_cnt ? i : 0UL ];
+    FD_TEST( xsk->xsk_fd >= 0 );
+    allow_fd[ i ] = (uint)xsk->xsk_fd;
+  }
+  allow_fd[ MAX_NET_QUEUES ] = init_ctx->lo_xsk ? (uint)init_ctx->lo_xsk->xsk_fd : allow_fd[ 0 ];
   int netlink_fd = fd_ip_netlink_get( init_ctx->ip )->fd;
-  populate_sock_filter_policy_net( out_cnt, out, (uint)fd_log_private_logfile_fd(), (uint)init_ctx->xsk->xsk_fd, (uint)allow_fd2, (uint)netlink_fd );
+  populate_sock_filter_policy_net( out_cnt, out, (uint)fd_log_private_logfile_fd(), allow_fd[ 0 ], allow_fd[ 1 ], allow_fd[ 2 ], allow_fd[ 3 ], allow_fd[ 4 ], (uint)netlink_fd );
   return sock_filter_policy_net_instr_cnt;
 }
 
@@ -843,7 +1091,7 @@ populate_allowed_fds( void * scratch,
   FD_SCRATCH_ALLOC_INIT( l, scratch );
   fd_net_init_ctx_t * init_ctx = FD_SCRATCH_ALLOC_APPEND( l, alignof( fd_net_init_ctx_t ), sizeof( fd_net_init_ctx_t ) );
 
-  if( FD_UNLIKELY( out_fds_cnt < 7 ) ) FD_LOG_ERR(( "out_fds_cnt %lu", out_fds_cnt ));
+  if( FD_UNLIKELY( out_fds_cnt < 6UL+MAX_NET_QUEUES ) ) FD_LOG_ERR(( "out_fds_cnt %lu", out_fds_cnt ));
 
   ulong out_cnt = 0;
 
@@ -852,7 +1100,8 @@ populate_allowed_fds( void * scratch,
     out_fds[ out_cnt++ ] = fd_log_private_logfile_fd(); /* logfile */
   out_fds[ out_cnt++ ] = fd_ip_netlink_get( init_ctx->ip )->fd;
 
-  out_fds[ out_cnt++ ] = init_ctx->xsk->xsk_fd;
+  for( ulong i=0UL; i<init_ctx->xsk_cnt; i++ )
+    out_fds[ out_cnt++ ] = init_ctx->xsk[ i ]->xsk_fd;
   if( init_ctx->xdp_prog_link_fd >= 0 )
     out_fds[ out_cnt++ ] = init_ctx->xdp_prog_link_fd;
   if( init_ctx->xsk_map_fd >= 0 )
@@ -14,8 +14,6 @@
    multiple microblocks can execute in parallel, if they don't
    write to the same accounts. */
 
-#define POH_IN_IDX (2UL)
-
 #define MAX_SLOTS_PER_EPOCH          432000UL
 
 /* For now, produce microblocks as fast as possible. */
@@ -155,6 +153,7 @@ typedef struct {
   int          insert_to_extra; /* whether the last insert was into pack or the extra deq */
 
   fd_pack_in_ctx_t in[ 32 ];
+  ulong            poh_in_idx; /* in link of leader updates, the others carry transactions */
 
   ulong    bank_cnt;
   ulong    bank_idle_bitset; /* bit i is 1 if we've observed *bank_current[i]==bank_expect[i] */
@@ -463,7 +462,7 @@ during_frag( void * _ctx,
 
   uchar const * dcache_entry = fd_chunk_to_laddr_const( ctx->in[ in_idx ].mem, chunk );
 
-  if( FD_UNLIKELY( in_idx==POH_IN_IDX ) ) {
+  if( FD_UNLIKELY( in_idx==ctx->poh_in_idx ) ) {
     if( fd_disco_poh_sig_pkt_type( sig )!=POH_PKT_TYPE_BECAME_LEADER ) {
       /* Not interested in stamped microblocks, only leader updates. */
       *opt_filter = 1;
@@ -586,7 +585,7 @@ after_frag( void *             _ctx,
   fd_pack_ctx_t * ctx = (fd_pack_ctx_t *)_ctx;
   long now = fd_tickcount();
 
-  if( FD_UNLIKELY( in_idx==POH_IN_IDX ) ) {
+  if( FD_UNLIKELY( in_idx==ctx->poh_in_idx ) ) {
     ctx->slot_end_ns = ctx->_slot_end_ns;
     fd_pack_set_block_limits( ctx->pack, ctx->slot_max_microblocks, ctx->slot_max_data );
   } else {
@@ -672,6 +671,12 @@ unprivileged_init( fd_topo_t *      topo,
     FD_TEST( ULONG_MAX==fd_fseq_query( ctx->bank_current[ i ] ) );
   }
 
+  /* There is one dedup_pack in link per dedup tile, so the position of
+     the PoH in link depends on the topology. */
+  FD_TEST( tile->in_cnt<=sizeof(ctx->in)/sizeof(ctx->in[ 0 ]) );
+  ctx->poh_in_idx = fd_topo_find_tile_in_link( topo, tile, "poh_pack", 0UL );
+  if( FD_UNLIKELY( ctx->poh_in_idx==ULONG_MAX ) ) FD_LOG_ERR(( "pack tile has no poh_pack in link" ));
+
   for( ulong i=0UL; i<tile->in_cnt; i++ ) {
     fd_topo_link_t * link = &topo->links[ tile->in_link_id[ i ] ];
     fd_topo_wksp_t * link_wksp = &topo->workspaces[ topo->objs[ link->dcache_obj_id ].wksp_id ];
@@ -8,6 +8,7 @@
 #include "../../../../waltz/xdp/fd_xsk.h"
 #include "../../../../waltz/ip/fd_netlink.h"
 #include "../../../../disco/quic/fd_tpu.h"
+#include "../../../../disco/quic/fd_tpu_qos.h"
 
 #include <linux/unistd.h>
 #include <sys/random.h>
@@ -31,7 +32,28 @@
    packets being received by net tiles and forwarded on via. a mux
    (multiplexer).  An arbitrary number of QUIC tiles can be run, and
    these will round-robin packets from the networking queues based on
-   the source IP address. */
+   the source IP address.
+
+   Incoming QUIC packets are not handed to the QUIC engine one by one.
+   They are buffered while the input links keep delivering fragments
+   and passed as one burst once the input goes idle (or the burst
+   buffer is full), such that the QUIC engine can remove packet
+   protection for the whole burst with its batched AES-GCM path.
+
+   Connections from staked peers are prioritized.  The tile follows the
+   stake weights published on the stake_out link, and when a connection
+   is established, looks up the stake of the peer's TLS identity key.
+   Staked peers may use connection slots reserved for them and get a
+   stream quota proportional to their stake (see fd_tpu_qos). */
+
+/* QUIC_RX_BURST_MAX is the max number of packets buffered before they
+   are passed to the QUIC engine. */
+
+#define QUIC_RX_BURST_MAX (16UL)
+
+#define NET_IN_IDX   0
+#define SIGN_IN_IDX  1
+#define STAKE_IN_IDX 2
 
 typedef struct {
   fd_tpu_reasm_t * reasm;
@@ -44,7 +66,13 @@ typedef struct {
 
   fd_keyguard_client_t keyguard_client[1];
 
-  uchar buffer[ FD_NET_MTU ];
+  /* Receive burst: rx_buf[0,rx_cnt) are packets not yet passed to the
+     QUIC engine.  rx_seen is set if a fragment arrived since the last
+     mux loop iteration. */
+  uchar             rx_buf[ QUIC_RX_BURST_MAX ][ FD_NET_MTU ];
+  fd_aio_pkt_info_t rx_pkt[ QUIC_RX_BURST_MAX ];
+  ulong             rx_cnt;
+  int               rx_seen;
 
   ulong conn_seq; /* current quic connection sequence number */
 
@@ -55,6 +83,12 @@ typedef struct {
   ulong       in_chunk0;
   ulong       in_wmark;
 
+  fd_tpu_qos_t * qos;
+
+  fd_wksp_t * stake_in_mem;
+  ulong       stake_in_chunk0;
+  ulong       stake_in_wmark;
+
   fd_frag_meta_t * net_out_mcache;
   ulong *          net_out_sync;
   ulong            net_out_depth;
@@ -128,6 +162,7 @@ scratch_footprint( fd_topo_tile_t const * tile ) {
   l = FD_LAYOUT_APPEND( l, alignof( fd_quic_ctx_t ), sizeof( fd_quic_ctx_t )      );
   l = FD_LAYOUT_APPEND( l, fd_aio_align(),           fd_aio_footprint()           );
   l = FD_LAYOUT_APPEND( l, fd_quic_align(),          fd_quic_footprint( &limits ) );
+  l = FD_LAYOUT_APPEND( l, fd_tpu_qos_align(),       fd_tpu_qos_footprint()       );
   return FD_LAYOUT_FINI( l, scratch_align() );
 }
 
@@ -169,6 +204,16 @@ legacy_stream_notify( fd_quic_ctx_t * ctx,
   fd_mux_advance( mux );
 }
 
+/* rx_flush passes all buffered packets to the QUIC engine in a single
+   burst. */
+
+static void
+rx_flush( fd_quic_ctx_t * ctx ) {
+  if( FD_UNLIKELY( !ctx->rx_cnt ) ) return;
+  fd_aio_send( ctx->quic_rx_aio, ctx->rx_pkt, ctx->rx_cnt, NULL, 1 );
+  ctx->rx_cnt = 0UL;
+}
+
 /* Because of the separate mcache for publishing network fragments
    back to networking tiles, which is not managed by the mux, we
    need to periodically update the sync. */
@@ -192,6 +237,10 @@ before_credit( void *             _ctx,
 
   ctx->mux = mux;
 
+  /* Pass buffered packets once the input went idle for an iteration */
+  if( !ctx->rx_seen ) rx_flush( ctx );
+  ctx->rx_seen = 0;
+
   /* Publishes to mcache via callbacks */
   fd_quic_service( ctx->quic );
 }
@@ -217,6 +266,7 @@ metrics_write( void * _ctx ) {
   FD_MCNT_SET(   QUIC, CONNECTIONS_RETRIED, ctx->quic->metrics.conn_retry_cnt );
 
   FD_MCNT_SET(   QUIC, CONNECTION_ERROR_NO_SLOTS,   ctx->quic->metrics.conn_err_no_slots_cnt );
+  FD_MCNT_SET(   QUIC, CONNECTIONS_EVICTED,         ctx->quic->metrics.conn_evicted_cnt );
   FD_MCNT_SET(   QUIC, CONNECTION_ERROR_TLS_FAIL,   ctx->quic->metrics.conn_err_tls_fail_cnt );
   FD_MCNT_SET(   QUIC, CONNECTION_ERROR_RETRY_FAIL, ctx->quic->metrics.conn_err_retry_fail_cnt );
 
@@ -237,11 +287,12 @@ before_frag( void * _ctx,
              ulong  seq,
              ulong  sig,
              int *  opt_filter ) {
-  (void)in_idx;
   (void)seq;
 
   fd_quic_ctx_t * ctx = (fd_quic_ctx_t *)_ctx;
 
+  if( FD_UNLIKELY( in_idx==STAKE_IN_IDX ) ) return;
+
   ulong proto = fd_disco_netmux_sig_proto( sig );
   if( FD_UNLIKELY( proto!=DST_PROTO_TPU_UDP && proto!=DST_PROTO_TPU_QUIC ) ) {
     *opt_filter = 1;
@@ -263,18 +314,27 @@ during_frag( void * _ctx,
              ulong  chunk,
              ulong  sz,
              int *  opt_filter ) {
-  (void)in_idx;
   (void)seq;
   (void)sig;
   (void)opt_filter;
 
   fd_quic_ctx_t * ctx = (fd_quic_ctx_t *)_ctx;
 
+  if( FD_UNLIKELY( in_idx==STAKE_IN_IDX ) ) {
+    if( FD_UNLIKELY( chunk<ctx->stake_in_chunk0 || chunk>ctx->stake_in_wmark ) )
+      FD_LOG_ERR(( "chunk %lu %lu corrupt, not in range [%lu,%lu]", chunk, sz,
+            ctx->stake_in_chunk0, ctx->stake_in_wmark ));
+
+    uchar const * dcache_entry = fd_chunk_to_laddr_const( ctx->stake_in_mem, chunk );
+    fd_tpu_qos_stake_msg_init( ctx->qos, dcache_entry );
+    return;
+  }
+
   if( FD_UNLIKELY( chunk<ctx->in_chunk0 || chunk>ctx->in_wmark || sz > FD_NET_MTU ) )
     FD_LOG_ERR(( "chunk %lu %lu corrupt, not in range [%lu,%lu]", chunk, sz, ctx->in_chunk0, ctx->in_wmark ));
 
   uchar * src = (uchar *)fd_chunk_to_laddr( ctx->in_mem, chunk );
-  fd_memcpy( ctx->buffer, src, sz ); /* TODO: Eliminate copy... fd_aio needs refactoring */
+  fd_memcpy( ctx->rx_buf[ ctx->rx_cnt ], src, sz ); /* TODO: Eliminate copy... fd_aio needs refactoring */
 }
 
 static void
@@ -287,7 +347,6 @@ after_frag( void *             _ctx,
             ulong *            opt_tsorig,
             int *              opt_filter,
             fd_mux_context_t * mux ) {
-  (void)in_idx;
   (void)seq;
   (void)opt_chunk;
   (void)opt_tsorig;
@@ -296,11 +355,19 @@ after_frag( void *             _ctx,
 
   fd_quic_ctx_t * ctx = (fd_quic_ctx_t *)_ctx;
 
+  if( FD_UNLIKELY( in_idx==STAKE_IN_IDX ) ) {
+    fd_tpu_qos_stake_msg_fini( ctx->qos );
+    return;
+  }
+
   ulong proto = fd_disco_netmux_sig_proto( *opt_sig );
 
+  uchar * buffer = ctx->rx_buf[ ctx->rx_cnt ];
+  ctx->rx_seen = 1;
+
   if( FD_LIKELY( proto==DST_PROTO_TPU_QUIC ) ) {
-    fd_aio_pkt_info_t pkt = { .buf = ctx->buffer, .buf_sz = (ushort)*opt_sz };
-    fd_aio_send( ctx->quic_rx_aio, &pkt, 1, NULL, 1 );
+    ctx->rx_pkt[ ctx->rx_cnt++ ] = (fd_aio_pkt_info_t) { .buf = buffer, .buf_sz = (ushort)*opt_sz };
+    if( FD_UNLIKELY( ctx->rx_cnt==QUIC_RX_BURST_MAX ) ) rx_flush( ctx );
   } else if( FD_LIKELY( proto==DST_PROTO_TPU_UDP ) ) {
     ulong network_hdr_sz = fd_disco_netmux_sig_hdr_sz( *opt_sig );
     if( FD_UNLIKELY( *opt_sz<network_hdr_sz ) ) {
@@ -318,7 +385,7 @@ after_frag( void *             _ctx,
       return;
     }
 
-    legacy_stream_notify( ctx, ctx->buffer+network_hdr_sz, (uint)(*opt_sz - network_hdr_sz) );
+    legacy_stream_notify( ctx, buffer+network_hdr_sz, (uint)(*opt_sz - network_hdr_sz) );
   }
 }
 
@@ -332,13 +399,20 @@ quic_now( void * ctx ) {
 }
 
 /* quic_conn_new is invoked by the QUIC engine whenever a new connection
-   is being established. */
+   is being established.  Applies the peer's stake based admission
+   class and stream quota. */
 static void
 quic_conn_new( fd_quic_conn_t * conn,
                void *           _ctx ) {
   fd_quic_ctx_t * ctx = (fd_quic_ctx_t *)_ctx;
 
   conn->local_conn_id = ++ctx->conn_seq;
+
+  uchar const * peer_pubkey = fd_quic_conn_peer_pubkey( conn );
+  ulong         stake       = peer_pubkey ? fd_tpu_qos_stake( ctx->qos, peer_pubkey ) : 0UL;
+
+  fd_quic_conn_set_staked     ( conn, stake!=0UL );
+  fd_quic_conn_set_max_streams( conn, FD_QUIC_TYPE_UNIDIR, fd_tpu_qos_stream_cnt( ctx->qos, stake ) );
 }
 
 /* quic_stream_new is called back by the QUIC engine whenever an open
@@ -562,11 +636,13 @@ static void
 unprivileged_init( fd_topo_t *      topo,
                    fd_topo_tile_t * tile,
                    void *           scratch ) {
-  if( FD_UNLIKELY( tile->in_cnt!=2UL ||
-                   strcmp( topo->links[ tile->in_link_id[ 0UL ] ].name, "net_quic" ) ||
-                   strcmp( topo->links[ tile->in_link_id[ 1UL ] ].name, "sign_quic" ) ) )
-    FD_LOG_ERR(( "quic tile has none or unexpected input links %lu %s %s",
-                 tile->in_cnt, topo->links[ tile->in_link_id[ 0 ] ].name, topo->links[ tile->in_link_id[ 1 ] ].name ));
+  if( FD_UNLIKELY( tile->in_cnt!=3UL ||
+                   strcmp( topo->links[ tile->in_link_id[ NET_IN_IDX   ] ].name, "net_quic" )  ||
+                   strcmp( topo->links[ tile->in_link_id[ SIGN_IN_IDX  ] ].name, "sign_quic" ) ||
+                   strcmp( topo->links[ tile->in_link_id[ STAKE_IN_IDX ] ].name, "stake_out" ) ) )
+    FD_LOG_ERR(( "quic tile has none or unexpected input links %lu %s %s %s",
+                 tile->in_cnt, topo->links[ tile->in_link_id[ 0 ] ].name, topo->links[ tile->in_link_id[ 1 ] ].name,
+                 topo->links[ tile->in_link_id[ 2 ] ].name ));
 
   if( FD_UNLIKELY( tile->out_cnt!=2UL ||
                    strcmp( topo->links[ tile->out_link_id[ 0UL ] ].name, "quic_net" ) ||
@@ -585,7 +661,7 @@ unprivileged_init( fd_topo_t *      topo,
 
   /* End privileged allocs */
 
-  fd_topo_link_t * sign_in = &topo->links[ tile->in_link_id[ 1UL ] ];
+  fd_topo_link_t * sign_in = &topo->links[ tile->in_link_id[ SIGN_IN_IDX ] ];
   fd_topo_link_t * sign_out = &topo->links[ tile->out_link_id[ 1UL ] ];
   FD_TEST( fd_keyguard_client_join( fd_keyguard_client_new( ctx->keyguard_client,
                                                             sign_out->mcache,
@@ -606,6 +682,8 @@ unprivileged_init( fd_topo_t *      topo,
   quic->config.idle_timeout               = tile->quic.idle_timeout_millis * 1000000UL;
   quic->config.initial_rx_max_stream_data = 1<<15;
   quic->config.retry                      = tile->quic.retry;
+  quic->config.conn_reserved_cnt          = tile->quic.staked_connection_reserve;
+  quic->config.conn_evict                 = tile->quic.retry;
   fd_memcpy( quic->config.link.src_mac_addr, tile->quic.src_mac_addr, 6 );
   fd_memcpy( quic->config.identity_public_key, ctx->identity_public_key, 32UL );
 
@@ -625,6 +703,17 @@ unprivileged_init( fd_topo_t *      topo,
   fd_quic_set_aio_net_tx( quic, quic_tx_aio );
   if( FD_UNLIKELY( !fd_quic_init( quic ) ) ) FD_LOG_ERR(( "fd_quic_init failed" ));
 
+  ctx->qos = fd_tpu_qos_join( fd_tpu_qos_new( FD_SCRATCH_ALLOC_APPEND( l, fd_tpu_qos_align(), fd_tpu_qos_footprint() ),
+                                              limits.stream_pool_cnt,
+                                              tile->quic.unstaked_streams_per_connection,
+                                              limits.stream_cnt[ FD_QUIC_STREAM_TYPE_UNI_CLIENT ] ) );
+  if( FD_UNLIKELY( !ctx->qos ) ) FD_LOG_ERR(( "fd_tpu_qos_join failed" ));
+
+  fd_topo_link_t * stake_in = &topo->links[ tile->in_link_id[ STAKE_IN_IDX ] ];
+  ctx->stake_in_mem    = topo->workspaces[ topo->objs[ stake_in->dcache_obj_id ].wksp_id ].wksp;
+  ctx->stake_in_chunk0 = fd_dcache_compact_chunk0( ctx->stake_in_mem, stake_in->dcache );
+  ctx->stake_in_wmark  = fd_dcache_compact_wmark ( ctx->stake_in_mem, stake_in->dcache, stake_in->mtu );
+
   /* Put a bound on chunks we read from the input, to make sure they
       are within in the data region of the workspace. */
   if( FD_UNLIKELY( !tile->in_cnt ) ) FD_LOG_ERR(( "quic tile in link cnt is zero" ));
@@ -633,7 +722,7 @@ unprivileged_init( fd_topo_t *      topo,
   for( ulong i=1; i<tile->in_cnt; i++ ) {
     fd_topo_link_t * link = &topo->links[ tile->in_link_id[ i ] ];
 
-    if( FD_UNLIKELY( !tile->in_link_poll[ i ] ) ) continue;
+    if( FD_UNLIKELY( !tile->in_link_poll[ i ] || i==STAKE_IN_IDX ) ) continue;
 
     if( FD_UNLIKELY( topo->objs[ link0->dcache_obj_id ].wksp_id!=topo->objs[ link->dcache_obj_id ].wksp_id ) ) FD_LOG_ERR(( "quic tile reads input from multiple workspaces" ));
     if( FD_UNLIKELY( link0->mtu!=link->mtu         ) ) FD_LOG_ERR(( "quic tile reads input from multiple links with different MTUs" ));
@@ -669,6 +758,8 @@ unprivileged_init( fd_topo_t *      topo,
 
   ctx->quic        = quic;
   ctx->quic_rx_aio = fd_quic_get_aio_net_rx( quic );
+  ctx->rx_cnt      = 0UL;
+  ctx->rx_seen     = 0;
 
   ctx->round_robin_cnt = fd_topo_tile_name_cnt( topo, tile->name );
   ctx->round_robin_id  = tile->kind_id;
@@ -20,7 +20,13 @@
 #include "../../../../flamenco/runtime/fd_runtime_init.h"
 #include "../../../../flamenco/snapshot/fd_snapshot.h"
 #include "../../../../flamenco/stakes/fd_stakes.h"
+#include "../../../../flamenco/vm/fd_vm.h"
+#include "../../../../flamenco/vm/fd_vm_jit.h"
 #include "../../../../flamenco/runtime/fd_runtime.h"
+#include "../../../../flamenco/runtime/fd_blockstore_archive.h"
+#include "../../../../flamenco/runtime/fd_blockstore_sig_idx.h"
+#include "../../../../flamenco/runtime/fd_acc_owner_idx.h"
+#include "../../../../flamenco/runtime/fd_acc_token_idx.h"
 #include "../../../../util/fd_util.h"
 #include "../../../../util/tile/fd_tile_private.h"
 #include "../../../../util/net/fd_net_headers.h"
@@ -73,6 +79,11 @@
 
 #define BANK_HASH_CMP_LG_MAX 16
 
+/* Max number of account owner / token index entries checked for
+   staleness per root advance */
+#define FD_REPLAY_OWNER_IDX_GC_BUDGET (1UL<<16)
+#define FD_REPLAY_TOKEN_IDX_GC_BUDGET (1UL<<16)
+
 struct fd_replay_tile_ctx {
   fd_wksp_t * wksp;
   fd_wksp_t * blockstore_wksp;
@@ -170,10 +181,29 @@ struct fd_replay_tile_ctx {
   fd_tpool_t * tpool;
   ulong        max_workers;
 
+  /* sBPF jit code caches, one per thread that executes transactions,
+     mapped in privileged_init (NULL if the jit is disabled) */
+
+  void * jit_cache[ FD_TILE_MAX ];
+
   /* Depends on store_int and is polled in after_credit */
 
   fd_blockstore_t *     blockstore;
 
+  /* On-disk tier for rooted blocks evicted from the blockstore, opened
+     in privileged_init and attached once the blockstore is joined */
+
+  fd_blockstore_archive_t blockstore_archive[1];
+  int                     blockstore_archive_open;
+
+  /* log2 capacity of the address signature index allocated in the
+     blockstore wksp once the blockstore is joined, 0 if disabled */
+
+  ulong blockstore_sig_idx_lg_max;
+
+  fd_acc_owner_idx_t * owner_idx; /* Account owner index in the funk wksp, NULL if disabled */
+  fd_acc_token_idx_t * token_idx; /* Token account index in the funk wksp, NULL if disabled */
+
   /* Updated during execution */
 
   fd_exec_slot_ctx_t *  slot_ctx;
@@ -497,6 +527,12 @@ funk_publish( fd_replay_tile_ctx_t * ctx, ulong root ) {
   if( FD_UNLIKELY( !rc ) ) {
     FD_LOG_WARNING(( "failed to funk publish slot %lu", root ));
   }
+  if( FD_LIKELY( ctx->owner_idx ) ) {
+    fd_acc_owner_idx_gc( ctx->owner_idx, ctx->funk, root, FD_REPLAY_OWNER_IDX_GC_BUDGET );
+  }
+  if( FD_LIKELY( ctx->token_idx ) ) {
+    fd_acc_token_idx_gc( ctx->token_idx, ctx->funk, root, FD_REPLAY_TOKEN_IDX_GC_BUDGET );
+  }
   fd_funk_end_write( ctx->funk );
 
   if( FD_LIKELY( ctx->slot_ctx->status_cache ) ) {
@@ -506,7 +542,7 @@ funk_publish( fd_replay_tile_ctx_t * ctx, ulong root ) {
   if( FD_LIKELY( FD_FEATURE_ACTIVE( ctx->slot_ctx, epoch_accounts_hash ) ) ) {
     fd_epoch_bank_t * epoch_bank = fd_exec_epoch_ctx_epoch_bank( ctx->slot_ctx->epoch_ctx );
     if( root >= epoch_bank->eah_start_slot ) {
-      fd_accounts_hash( ctx->slot_ctx, &ctx->slot_ctx->slot_bank.epoch_account_hash, NULL, 0, 0 );
+      fd_accounts_hash_tpool( ctx->slot_ctx, &ctx->slot_ctx->slot_bank.epoch_account_hash, NULL, 0, 0, ctx->tpool, ctx->max_workers );
       epoch_bank->eah_start_slot = FD_SLOT_NULL;
     }
   }
@@ -1037,6 +1073,28 @@ tpool_boot( fd_topo_t * topo, ulong total_thread_count ) {
   fd_tile_private_map_boot( tile_to_cpu, thread_count );
 }
 
+static void
+vm_pool_attach_task( void * tpool FD_PARAM_UNUSED,
+                     ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
+                     void * args,
+                     void * reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                     ulong l0 FD_PARAM_UNUSED, ulong l1 FD_PARAM_UNUSED,
+                     ulong m0 FD_PARAM_UNUSED, ulong m1 FD_PARAM_UNUSED,
+                     ulong n0 FD_PARAM_UNUSED, ulong n1 FD_PARAM_UNUSED ) {
+  fd_vm_pool_attach( args, FD_VM_POOL_VM_MAX );
+}
+
+static void
+jit_cache_attach_task( void * tpool FD_PARAM_UNUSED,
+                       ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
+                       void * args,
+                       void * reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                       ulong l0 FD_PARAM_UNUSED, ulong l1 FD_PARAM_UNUSED,
+                       ulong m0 FD_PARAM_UNUSED, ulong m1 FD_PARAM_UNUSED,
+                       ulong n0 FD_PARAM_UNUSED, ulong n1 FD_PARAM_UNUSED ) {
+  fd_vm_jit_cache_attach( args );
+}
+
 static void
 read_snapshot( void * _ctx, char const * snapshotfile, char const * incremental ) {
   fd_replay_tile_ctx_t * ctx = (fd_replay_tile_ctx_t *)_ctx;
@@ -1046,7 +1104,7 @@ read_snapshot( void * _ctx, char const * snapshotfile, char const * incremental
   const char * snapshot = snapshotfile;
   if( strncmp( snapshot, "wksp:", 5 ) != 0 ) {
     FD_MCNT_SET( REPLAY, SNAPSHOT_STATUS_SNAPSHOT_BEGIN, 1 );
-    fd_snapshot_load( snapshot, ctx->slot_ctx, false, false, FD_SNAPSHOT_TYPE_FULL );
+    fd_snapshot_load_tpool( snapshot, ctx->slot_ctx, false, false, FD_SNAPSHOT_TYPE_FULL, ctx->tpool, ctx->max_workers );
     FD_MCNT_SET( REPLAY, SNAPSHOT_STATUS_SNAPSHOT_END, 1 );
   } else {
     fd_runtime_recover_banks( ctx->slot_ctx, 0, 1 );
@@ -1056,7 +1114,7 @@ read_snapshot( void * _ctx, char const * snapshotfile, char const * incremental
 
   if( strlen( incremental ) > 0 ) {
     FD_MCNT_SET( REPLAY, SNAPSHOT_STATUS_INCREMENTAL_BEGIN, 1 );
-    fd_snapshot_load( incremental, ctx->slot_ctx, false, false, FD_SNAPSHOT_TYPE_INCREMENTAL );
+    fd_snapshot_load_tpool( incremental, ctx->slot_ctx, false, false, FD_SNAPSHOT_TYPE_INCREMENTAL, ctx->tpool, ctx->max_workers );
     FD_MCNT_SET( REPLAY, SNAPSHOT_STATUS_INCREMENTAL_END, 1 );
     ctx->epoch_ctx->bank_hash_cmp = ctx->bank_hash_cmp;
   }
@@ -1069,6 +1127,24 @@ read_snapshot( void * _ctx, char const * snapshotfile, char const * incremental
   fd_funk_end_write( ctx->slot_ctx->acc_mgr->funk );
   FD_LOG_NOTICE( ( "finished fd_bpf_scan_and_create_bpf_program_cache_entry..." ) );
 
+  /* The snapshot load bypasses the account owner and token indices */
+
+  if( ctx->owner_idx ) {
+    FD_LOG_NOTICE(( "starting account owner index rebuild..." ));
+    fd_funk_start_write( ctx->funk );
+    ulong ele_cnt = fd_acc_owner_idx_rebuild( ctx->owner_idx, ctx->funk );
+    fd_funk_end_write( ctx->funk );
+    FD_LOG_NOTICE(( "finished account owner index rebuild (%lu accounts)", ele_cnt ));
+  }
+
+  if( ctx->token_idx ) {
+    FD_LOG_NOTICE(( "starting token account index rebuild..." ));
+    fd_funk_start_write( ctx->funk );
+    ulong ele_cnt = fd_acc_token_idx_rebuild( ctx->token_idx, ctx->funk );
+    fd_funk_end_write( ctx->funk );
+    FD_LOG_NOTICE(( "finished token account index rebuild (%lu entries)", ele_cnt ));
+  }
+
   ctx->epoch_ctx->bank_hash_cmp = ctx->bank_hash_cmp;
 
   fd_blockstore_start_write( ctx->slot_ctx->blockstore );
@@ -1140,6 +1216,24 @@ after_credit( void *             _ctx,
 
     if ( ctx->blockstore != NULL ) {
 
+      if( ctx->blockstore_archive_open ) {
+        if( FD_UNLIKELY( fd_blockstore_archive_attach( ctx->blockstore, ctx->blockstore_archive ) ) )
+          FD_LOG_ERR(( "failed to attach blockstore archive" ));
+      }
+
+      if( ctx->blockstore_sig_idx_lg_max && !fd_blockstore_sig_idx_query_attached( ctx->blockstore ) ) {
+        ulong  lg_ent_max  = ctx->blockstore_sig_idx_lg_max;
+        void * sig_idx_mem = fd_wksp_alloc_laddr( ctx->blockstore_wksp, fd_blockstore_sig_idx_align(), fd_blockstore_sig_idx_footprint( lg_ent_max ), FD_BLOCKSTORE_SIG_IDX_MAGIC );
+        if( FD_UNLIKELY( !sig_idx_mem ) )
+          FD_LOG_ERR(( "failed to allocate blockstore signature index (blockstore_sig_index_lg_max %lu)", lg_ent_max ));
+        fd_blockstore_sig_idx_t * sig_idx = fd_blockstore_sig_idx_join( fd_blockstore_sig_idx_new( sig_idx_mem, fd_blockstore_seed( ctx->blockstore ), lg_ent_max ) );
+        if( FD_UNLIKELY( !sig_idx ) )
+          FD_LOG_ERR(( "failed to join blockstore signature index" ));
+        fd_blockstore_start_write( ctx->blockstore );
+        fd_blockstore_sig_idx_attach( ctx->blockstore, sig_idx );
+        fd_blockstore_end_write( ctx->blockstore );
+      }
+
       /* Init slot_ctx */
 
       fd_exec_slot_ctx_t slot_ctx = { 0 };
@@ -1192,7 +1286,7 @@ during_housekeeping( void * _ctx ) {
 
 static void
 privileged_init( fd_topo_t *      topo    FD_PARAM_UNUSED,
-                 fd_topo_tile_t * tile    FD_PARAM_UNUSED,
+                 fd_topo_tile_t * tile,
                  void *           scratch ) {
 
   FD_SCRATCH_ALLOC_INIT( l, scratch );
@@ -1200,6 +1294,30 @@ privileged_init( fd_topo_t *      topo    FD_PARAM_UNUSED,
 
   FD_TEST( sizeof(ulong) == getrandom( &ctx->funk_seed, sizeof(ulong), 0 ) );
   FD_TEST( sizeof(ulong) == getrandom( &ctx->status_cache_seed, sizeof(ulong), 0 ) );
+
+  /* The archive geometry is derived from the data region size, assuming
+     blocks average at least 64 KiB and txns at least 512 B. */
+
+  ctx->blockstore_archive_open = 0;
+  if( FD_UNLIKELY( strlen( tile->replay.blockstore_archive ) > 0 ) ) {
+    ulong data_max    = tile->replay.blockstore_archive_sz_gb << 30;
+    ulong slot_lg_max = (ulong)fd_ulong_find_msb( fd_ulong_pow2_up( fd_ulong_max( data_max >> 16, 1024UL ) ) );
+    ulong txn_lg_max  = (ulong)fd_ulong_find_msb( fd_ulong_pow2_up( fd_ulong_max( data_max >> 9,  1024UL ) ) );
+    if( FD_UNLIKELY( !fd_blockstore_archive_open( ctx->blockstore_archive, tile->replay.blockstore_archive, 1, slot_lg_max, txn_lg_max, data_max ) ) )
+      FD_LOG_ERR(( "failed to open blockstore archive %s", tile->replay.blockstore_archive ));
+    ctx->blockstore_archive_open = 1;
+  }
+
+  /* The jit code caches are executable mappings, which cannot be made
+     once the tile is sandboxed */
+
+  memset( ctx->jit_cache, 0, sizeof(ctx->jit_cache) );
+  if( tile->replay.jit_cache_sz_mb ) {
+    for( ulong i=0UL; i<tile->replay.tpool_thread_count; i++ ) {
+      ctx->jit_cache[ i ] = fd_vm_jit_cache_new( tile->replay.jit_cache_sz_mb<<20 );
+      if( FD_UNLIKELY( !ctx->jit_cache[ i ] ) ) FD_LOG_ERR(( "failed to create jit code cache (jit_cache_sz_mb %lu)", tile->replay.jit_cache_sz_mb ));
+    }
+  }
 }
 
 static void
@@ -1291,6 +1409,7 @@ unprivileged_init( fd_topo_t *      topo,
 
   ctx->blockstore_checkpt = tile->replay.blockstore_checkpt;
   ctx->blockstore_publish = tile->replay.blockstore_publish;
+  ctx->blockstore_sig_idx_lg_max = tile->replay.blockstore_sig_index_lg_max;
   ctx->funk_checkpt       = tile->replay.funk_checkpt;
   ctx->genesis            = tile->replay.genesis;
   ctx->incremental        = tile->replay.incremental;
@@ -1355,6 +1474,54 @@ unprivileged_init( fd_topo_t *      topo,
     }
   }
 
+  /**********************************************************************/
+  /* account owner index                                                */
+  /**********************************************************************/
+
+  ctx->owner_idx = NULL;
+  if( tile->replay.owner_index_max ) {
+    fd_wksp_tag_query_info_t info;
+    ulong tag = FD_ACC_OWNER_IDX_MAGIC;
+    if( fd_wksp_tag_query( ctx->funk_wksp, &tag, 1, &info, 1 ) > 0 ) {
+      ctx->owner_idx = fd_acc_owner_idx_join( fd_wksp_laddr_fast( ctx->funk_wksp, info.gaddr_lo ) );
+    } else {
+      ulong ele_max   = tile->replay.owner_index_max;
+      ulong owner_max = fd_ulong_max( ele_max / 16UL, 1024UL );
+      void * owner_idx_shmem = fd_wksp_alloc_laddr( ctx->funk_wksp, fd_acc_owner_idx_align(), fd_acc_owner_idx_footprint( ele_max, owner_max ), FD_ACC_OWNER_IDX_MAGIC );
+      if( FD_UNLIKELY( !owner_idx_shmem ) ) {
+        FD_LOG_ERR(( "failed to allocate account owner index (owner_index_max %lu)", ele_max ));
+      }
+      ctx->owner_idx = fd_acc_owner_idx_join( fd_acc_owner_idx_new( owner_idx_shmem, ctx->funk_seed, ele_max, owner_max ) );
+    }
+    if( FD_UNLIKELY( !ctx->owner_idx ) ) {
+      FD_LOG_ERR(( "failed to join account owner index" ));
+    }
+  }
+
+  /**********************************************************************/
+  /* token account index                                                */
+  /**********************************************************************/
+
+  ctx->token_idx = NULL;
+  if( tile->replay.token_index_max ) {
+    fd_wksp_tag_query_info_t info;
+    ulong tag = FD_ACC_TOKEN_IDX_MAGIC;
+    if( fd_wksp_tag_query( ctx->funk_wksp, &tag, 1, &info, 1 ) > 0 ) {
+      ctx->token_idx = fd_acc_token_idx_join( fd_wksp_laddr_fast( ctx->funk_wksp, info.gaddr_lo ) );
+    } else {
+      ulong ele_max  = tile->replay.token_index_max;
+      ulong list_max = fd_ulong_max( ele_max / 16UL, 1024UL );
+      void * token_idx_shmem = fd_wksp_alloc_laddr( ctx->funk_wksp, fd_acc_token_idx_align(), fd_acc_token_idx_footprint( ele_max, list_max ), FD_ACC_TOKEN_IDX_MAGIC );
+      if( FD_UNLIKELY( !token_idx_shmem ) ) {
+        FD_LOG_ERR(( "failed to allocate token account index (token_index_max %lu)", ele_max ));
+      }
+      ctx->token_idx = fd_acc_token_idx_join( fd_acc_token_idx_new( token_idx_shmem, ctx->funk_seed, ele_max, list_max ) );
+    }
+    if( FD_UNLIKELY( !ctx->token_idx ) ) {
+      FD_LOG_ERR(( "failed to join token account index" ));
+    }
+  }
+
   /**********************************************************************/
   /* status cache                                                       */
   /**********************************************************************/
@@ -1396,6 +1563,8 @@ unprivileged_init( fd_topo_t *      topo,
   /**********************************************************************/
 
   ctx->acc_mgr       = fd_acc_mgr_new( acc_mgr_shmem, ctx->funk );
+  ctx->acc_mgr->owner_idx = ctx->owner_idx;
+  ctx->acc_mgr->token_idx = ctx->token_idx;
   ctx->bank_hash_cmp = fd_bank_hash_cmp_join( fd_bank_hash_cmp_new( bank_hash_cmp_mem ) );
   ctx->epoch_ctx = fd_exec_epoch_ctx_join( fd_exec_epoch_ctx_new( epoch_ctx_mem, VOTE_ACC_MAX ) );
   if( tile->replay.cluster_version ) {
@@ -1440,6 +1609,27 @@ unprivileged_init( fd_topo_t *      topo,
     }
   }
 
+  /* Give every thread that executes transactions (the tile itself and
+     each tpool worker) its own pool of preformatted VMs. */
+  ulong   vm_pool_footprint = fd_vm_pool_footprint( FD_VM_POOL_VM_MAX );
+  uchar * vm_pool_mem       = fd_wksp_alloc_laddr( ctx->wksp, fd_vm_pool_align(), vm_pool_footprint*ctx->max_workers, 422UL );
+  if( FD_UNLIKELY( !vm_pool_mem ) ) FD_LOG_ERR(( "failed to allocate vm pools" ));
+  fd_vm_pool_attach( vm_pool_mem, FD_VM_POOL_VM_MAX );
+  for( ulong i=1UL; i<ctx->max_workers; i++ ) {
+    fd_tpool_exec( ctx->tpool, i, vm_pool_attach_task, NULL, 0UL, 0UL, vm_pool_mem + vm_pool_footprint*i, NULL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL );
+    fd_tpool_wait( ctx->tpool, i );
+  }
+
+  /* Likewise for the jit code caches.  The tile itself also compiles
+     programs when it builds the program cache. */
+  if( ctx->jit_cache[ 0 ] ) {
+    fd_vm_jit_cache_attach( ctx->jit_cache[ 0 ] );
+    for( ulong i=1UL; i<ctx->max_workers; i++ ) {
+      fd_tpool_exec( ctx->tpool, i, jit_cache_attach_task, NULL, 0UL, 0UL, ctx->jit_cache[ i ], NULL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL );
+      fd_tpool_wait( ctx->tpool, i );
+    }
+  }
+
   ctx->tpool = ctx->tpool;
   ctx->max_workers = ctx->max_workers;
 
@@ -1566,15 +1756,20 @@ populate_allowed_seccomp( void *               scratch FD_PARAM_UNUSED,
 }
 
 static ulong
-populate_allowed_fds( void * scratch      FD_PARAM_UNUSED,
+populate_allowed_fds( void * scratch,
                       ulong  out_fds_cnt,
                       int *  out_fds ) {
-  if( FD_UNLIKELY( out_fds_cnt<2 ) ) FD_LOG_ERR(( "out_fds_cnt %lu", out_fds_cnt ));
+  FD_SCRATCH_ALLOC_INIT( l, scratch );
+  fd_replay_tile_ctx_t * ctx = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_replay_tile_ctx_t), sizeof(fd_replay_tile_ctx_t) );
+
+  if( FD_UNLIKELY( out_fds_cnt<3 ) ) FD_LOG_ERR(( "out_fds_cnt %lu", out_fds_cnt ));
 
   ulong out_cnt = 0;
   out_fds[ out_cnt++ ] = 2; /* stderr */
   if( FD_LIKELY( -1!=fd_log_private_logfile_fd() ) )
     out_fds[ out_cnt++ ] = fd_log_private_logfile_fd(); /* logfile */
+  if( FD_UNLIKELY( ctx->blockstore_archive_open ) )
+    out_fds[ out_cnt++ ] = ctx->blockstore_archive->fd; /* blockstore archive */
   return out_cnt;
 }
 
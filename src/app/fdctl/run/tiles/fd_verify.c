@@ -9,7 +9,14 @@
 
 /* The verify tile is a wrapper around the mux tile, that also verifies
    incoming transaction signatures match the data being signed.
-   Non-matching transactions are filtered out of the frag stream. */
+   Non-matching transactions are filtered out of the frag stream.
+
+   Parsed transactions are buffered (in place in the out dcache) until
+   VERIFY_BATCH_TXN_MAX transactions or VERIFY_BATCH_SIG_MAX signatures
+   are pending, or the tile runs out of incoming frags.  The whole
+   batch is then verified at once, so that SHA-512 hashing is done
+   across multiple transactions in parallel, and the transactions that
+   pass are published in arrival order. */
 
 FD_FN_CONST static inline ulong
 scratch_align( void ) {
@@ -22,9 +29,6 @@ scratch_footprint( fd_topo_tile_t const * tile ) {
   ulong l = FD_LAYOUT_INIT;
   l = FD_LAYOUT_APPEND( l, alignof( fd_verify_ctx_t ), sizeof( fd_verify_ctx_t ) );
   l = FD_LAYOUT_APPEND( l, fd_tcache_align(), fd_tcache_footprint( VERIFY_TCACHE_DEPTH, VERIFY_TCACHE_MAP_CNT ) );
-  for( ulong i=0; i<FD_TXN_ACTUAL_SIG_MAX; i++ ) {
-    l = FD_LAYOUT_APPEND( l, fd_sha512_align(), fd_sha512_footprint() );
-  }
   return FD_LAYOUT_FINI( l, scratch_align() );
 }
 
@@ -33,6 +37,46 @@ mux_ctx( void * scratch ) {
   return (void*)fd_ulong_align_up( (ulong)scratch, alignof( fd_verify_ctx_t ) );
 }
 
+/* flush verifies the pending transactions and publishes the ones that
+   pass.  Failed transactions leave a hole in the out dcache, which is
+   fine since it is compact and the chunks get reused on wrap. */
+
+static void
+flush( fd_verify_ctx_t *  ctx,
+       fd_mux_context_t * mux ) {
+  fd_txn_verify_batch( ctx, ctx->pending, ctx->pending_cnt );
+
+  ulong tspub = (ulong)fd_frag_meta_ts_comp( fd_tickcount() );
+  for( ulong i=0UL; i<ctx->pending_cnt; i++ ) {
+    fd_verify_pending_t const * p = ctx->pending + i;
+    if( FD_UNLIKELY( p->res!=FD_TXN_VERIFY_SUCCESS ) ) continue; /* Signature verification failed or dup. */
+    fd_mux_publish( mux, p->sig, p->chunk, p->sz, 0UL, p->tsorig, tspub );
+  }
+
+  ctx->pending_cnt     = 0UL;
+  ctx->pending_sig_cnt = 0UL;
+}
+
+/* after_credit flushes a partial batch once no new frag arrived for a
+   whole run loop iteration, so transactions are not held back when
+   the tile is not saturated. */
+
+static inline void
+after_credit( void *             _ctx,
+              fd_mux_context_t * mux,
+              int *              opt_poll_in ) {
+  fd_verify_ctx_t * ctx = (fd_verify_ctx_t *)_ctx;
+
+  if( FD_LIKELY( !ctx->pending_cnt ) ) return;
+  if( FD_LIKELY( !ctx->pending_idle ) ) {
+    ctx->pending_idle = 1;
+    return;
+  }
+
+  flush( ctx, mux );
+  *opt_poll_in = 0;
+}
+
 static void
 before_frag( void * _ctx,
              ulong  in_idx,
@@ -142,16 +186,26 @@ after_frag( void *             _ctx,
     FD_LOG_ERR( ("txn is invalid: payload_sz = %lx, recent_blockhash_off = %x", *opt_sz, recent_blockhash_off ) );
   }
 
-  ulong txn_sig;
-  int res = fd_txn_verify( ctx, txn, (ushort)payload_sz, txn_t, &txn_sig );
-  if( FD_UNLIKELY( res!=FD_TXN_VERIFY_SUCCESS ) ) {
-    *opt_filter = 1; /* Signature verification failed. */
-    return;
-  }
+  /* Queue for batch verification.  The frag stays where it is in the
+     out dcache and is published by flush if it verifies. */
+
+  ulong signature_cnt = (ulong)txn_t->signature_cnt;
+  if( FD_UNLIKELY( ctx->pending_sig_cnt+signature_cnt>VERIFY_BATCH_SIG_MAX ) ) flush( ctx, mux );
+
+  fd_verify_pending_t * p = ctx->pending + ctx->pending_cnt;
+  p->payload    = txn;
+  p->txn        = txn_t;
+  p->payload_sz = (ushort)payload_sz;
+  p->chunk      = ctx->out_chunk;
+  p->sz         = new_sz;
+  p->tsorig     = *opt_tsorig;
+  ctx->pending_cnt++;
+  ctx->pending_sig_cnt += signature_cnt;
+  ctx->pending_idle     = 0;
 
-  ulong tspub = (ulong)fd_frag_meta_ts_comp( fd_tickcount() );
-  fd_mux_publish( mux, txn_sig, ctx->out_chunk, new_sz, 0UL, *opt_tsorig, tspub );
   ctx->out_chunk = fd_dcache_compact_next( ctx->out_chunk, new_sz, ctx->out_chunk0, ctx->out_wmark );
+
+  if( FD_UNLIKELY( ctx->pending_cnt==VERIFY_BATCH_TXN_MAX ) ) flush( ctx, mux );
 }
 
 static void
@@ -166,11 +220,9 @@ unprivileged_init( fd_topo_t *      topo,
   ctx->round_robin_cnt = fd_topo_tile_name_cnt( topo, tile->name );
   ctx->round_robin_idx = tile->kind_id;
 
-  for ( ulong i=0; i<FD_TXN_ACTUAL_SIG_MAX; i++ ) {
-    fd_sha512_t * sha = fd_sha512_join( fd_sha512_new( FD_SCRATCH_ALLOC_APPEND( l, alignof( fd_sha512_t ), sizeof( fd_sha512_t ) ) ) );
-    if( FD_UNLIKELY( !sha ) ) FD_LOG_ERR(( "fd_sha512_join failed" ));
-    ctx->sha[i] = sha;
-  }
+  ctx->pending_cnt     = 0UL;
+  ctx->pending_sig_cnt = 0UL;
+  ctx->pending_idle    = 0;
 
   ctx->tcache_depth   = fd_tcache_depth       ( tcache );
   ctx->tcache_map_cnt = fd_tcache_map_cnt     ( tcache );
@@ -230,8 +282,9 @@ populate_allowed_fds( void * scratch,
 fd_topo_run_tile_t fd_tile_verify = {
   .name                     = "verify",
   .mux_flags                = FD_MUX_FLAG_COPY | FD_MUX_FLAG_MANUAL_PUBLISH,
-  .burst                    = 1UL,
+  .burst                    = VERIFY_BATCH_TXN_MAX,
   .mux_ctx                  = mux_ctx,
+  .mux_after_credit         = after_credit,
   .mux_before_frag          = before_frag,
   .mux_during_frag          = during_frag,
   .mux_after_frag           = after_frag,
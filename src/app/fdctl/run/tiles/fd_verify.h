@@ -19,10 +19,33 @@ typedef struct {
   ulong       wmark;
 } fd_verify_in_ctx_t;
 
+/* VERIFY_BATCH_{TXN,SIG}_MAX bound the number of transactions and
+   signatures buffered by the verify tile before their signatures get
+   verified together (see fd_txn_verify_batch). */
+
+#define VERIFY_BATCH_TXN_MAX (16UL)
+#define VERIFY_BATCH_SIG_MAX FD_ED25519_VERIFY_BATCH_MAX
+
+FD_STATIC_ASSERT( FD_TXN_ACTUAL_SIG_MAX<=VERIFY_BATCH_SIG_MAX, verify_batch );
+
+/* fd_verify_pending_t is a parsed transaction waiting for signature
+   verification.  chunk, sz and tsorig describe the frag to publish if
+   the transaction verifies. */
+
 typedef struct {
-  /* TODO switch to fd_sha512_batch_t? */
-  fd_sha512_t * sha[ FD_TXN_ACTUAL_SIG_MAX ];
+  uchar const *    payload;
+  fd_txn_t const * txn;
+  ushort           payload_sz;
+
+  ulong            chunk;
+  ulong            sz;
+  ulong            tsorig;
+
+  ulong            sig; /* Out: dedup tag on success */
+  int              res; /* Out: FD_TXN_VERIFY_* */
+} fd_verify_pending_t;
 
+typedef struct {
   ulong round_robin_idx;
   ulong round_robin_cnt;
 
@@ -32,6 +55,12 @@ typedef struct {
   ulong * tcache_ring;
   ulong * tcache_map;
 
+  /* Transactions buffered for batch verification, in arrival order */
+  fd_verify_pending_t pending[ VERIFY_BATCH_TXN_MAX ];
+  ulong               pending_cnt;
+  ulong               pending_sig_cnt;
+  int                 pending_idle; /* No frag arrived since the last after_credit */
+
   fd_verify_in_ctx_t in[ 32 ];
 
   fd_wksp_t * out_mem;
@@ -40,51 +69,100 @@ typedef struct {
   ulong       out_chunk;
 } fd_verify_ctx_t;
 
+/* fd_txn_verify_batch verifies the signatures of txn_cnt transactions
+   in [1,VERIFY_BATCH_TXN_MAX] with a total of at most
+   VERIFY_BATCH_SIG_MAX signatures, and dedups them against recently
+   verified transactions.  All signatures of the batch are verified
+   with a single fd_ed25519_verify_batch_multi_msg call.  Sets res (and
+   sig on success) of each pending transaction.  The result is the
+   same as calling fd_txn_verify on each transaction in order. */
+
+static inline void
+fd_txn_verify_batch( fd_verify_ctx_t *     ctx,
+                     fd_verify_pending_t * pending,
+                     ulong                 txn_cnt ) {
+
+  uchar const * msgs[ VERIFY_BATCH_SIG_MAX ];
+  ulong         msg_szs[ VERIFY_BATCH_SIG_MAX ];
+  uchar const * sigs[ VERIFY_BATCH_SIG_MAX ];
+  uchar const * pubkeys[ VERIFY_BATCH_SIG_MAX ];
+  int           sig_res[ VERIFY_BATCH_SIG_MAX ];
+  ulong         sig_cnt = 0UL;
+
+  for( ulong i=0UL; i<txn_cnt; i++ ) {
+    fd_verify_pending_t * p = pending + i;
+
+    /* We do not want to deref any non-data field from the txn struct more than once */
+    uchar  signature_cnt = p->txn->signature_cnt;
+    ushort signature_off = p->txn->signature_off;
+    ushort acct_addr_off = p->txn->acct_addr_off;
+    ushort message_off   = p->txn->message_off;
+
+    uchar const * signatures = p->payload + signature_off;
+
+    /* The first signature is the transaction id, i.e. a unique identifier.
+       So use this to do a quick dedup of ha traffic. */
+
+    /* TODO: use more than 64 bits to dedup. */
+    p->sig = FD_LOAD( ulong, signatures );
+    int ha_dup;
+    FD_FN_UNUSED ulong tcache_map_idx = 0; /* ignored */
+    FD_TCACHE_QUERY( ha_dup, tcache_map_idx, ctx->tcache_map, ctx->tcache_map_cnt, p->sig );
+    if( FD_UNLIKELY( ha_dup ) ) {
+      p->res = FD_TXN_VERIFY_DEDUP;
+      continue;
+    }
+
+    if( FD_UNLIKELY( !signature_cnt || sig_cnt+signature_cnt>VERIFY_BATCH_SIG_MAX ) ) {
+      FD_LOG_CRIT(( "invalid verify batch (sig_cnt=%lu signature_cnt=%u)", sig_cnt, (uint)signature_cnt ));
+    }
+
+    p->res = FD_TXN_VERIFY_SUCCESS;
+    for( ulong j=0UL; j<signature_cnt; j++ ) {
+      msgs   [ sig_cnt ] = p->payload + message_off;
+      msg_szs[ sig_cnt ] = (ulong)p->payload_sz - message_off;
+      sigs   [ sig_cnt ] = signatures + j*FD_ED25519_SIG_SZ;
+      pubkeys[ sig_cnt ] = p->payload + acct_addr_off + j*32UL;
+      sig_cnt++;
+    }
+  }
+
+  /* Verify signatures */
+  if( FD_LIKELY( sig_cnt ) ) fd_ed25519_verify_batch_multi_msg( msgs, msg_szs, sigs, pubkeys, sig_res, sig_cnt );
+
+  /* Insert into the tcache to dedup ha traffic, in arrival order.
+     The dedup check is repeated to guard against duped txs verifying
+     signatures at the same time (including within this batch) */
+  sig_cnt = 0UL;
+  for( ulong i=0UL; i<txn_cnt; i++ ) {
+    fd_verify_pending_t * p = pending + i;
+    if( FD_UNLIKELY( p->res!=FD_TXN_VERIFY_SUCCESS ) ) continue;
+
+    ulong signature_cnt = (ulong)p->txn->signature_cnt;
+    int   ok            = 1;
+    for( ulong j=0UL; j<signature_cnt; j++ ) ok &= sig_res[ sig_cnt+j ]==FD_ED25519_SUCCESS;
+    sig_cnt += signature_cnt;
+    if( FD_UNLIKELY( !ok ) ) {
+      p->res = FD_TXN_VERIFY_FAILED;
+      continue;
+    }
+
+    int ha_dup;
+    FD_TCACHE_INSERT( ha_dup, *ctx->tcache_sync, ctx->tcache_ring, ctx->tcache_depth, ctx->tcache_map, ctx->tcache_map_cnt, p->sig );
+    if( FD_UNLIKELY( ha_dup ) ) p->res = FD_TXN_VERIFY_DEDUP;
+  }
+}
+
 static inline int
 fd_txn_verify( fd_verify_ctx_t * ctx,
                uchar const *     udp_payload,
                ushort const      payload_sz,
                fd_txn_t const *  txn,
                ulong *           opt_sig ) {
-
-  /* We do not want to deref any non-data field from the txn struct more than once */
-  uchar  signature_cnt = txn->signature_cnt;
-  ushort signature_off = txn->signature_off;
-  ushort acct_addr_off = txn->acct_addr_off;
-  ushort message_off   = txn->message_off;
-
-  uchar const * signatures = udp_payload + signature_off;
-  uchar const * pubkeys = udp_payload + acct_addr_off;
-  uchar const * msg = udp_payload + message_off;
-  ulong msg_sz = (ulong)payload_sz - message_off;
-
-  /* The first signature is the transaction id, i.e. a unique identifier.
-     So use this to do a quick dedup of ha traffic. */
-
-  /* TODO: use more than 64 bits to dedup. */
-  ulong ha_dedup_tag = FD_LOAD( ulong, signatures );
-  int ha_dup;
-  FD_FN_UNUSED ulong tcache_map_idx = 0; /* ignored */
-  FD_TCACHE_QUERY( ha_dup, tcache_map_idx, ctx->tcache_map, ctx->tcache_map_cnt, ha_dedup_tag );
-  if( FD_UNLIKELY( ha_dup ) ) {
-    return FD_TXN_VERIFY_DEDUP;
-  }
-
-  /* Verify signatures */
-  int res = fd_ed25519_verify_batch_single_msg( msg, msg_sz, signatures, pubkeys, ctx->sha, signature_cnt );
-  if( FD_UNLIKELY( res != FD_ED25519_SUCCESS ) ) {
-    return FD_TXN_VERIFY_FAILED;
-  }
-
-  /* Insert into the tcache to dedup ha traffic.
-     The dedup check is repeated to guard against duped txs verifying signatures at the same time */
-  FD_TCACHE_INSERT( ha_dup, *ctx->tcache_sync, ctx->tcache_ring, ctx->tcache_depth, ctx->tcache_map, ctx->tcache_map_cnt, ha_dedup_tag );
-  if( FD_UNLIKELY( ha_dup ) ) {
-    return FD_TXN_VERIFY_DEDUP;
-  }
-
-  *opt_sig = ha_dedup_tag;
-  return FD_TXN_VERIFY_SUCCESS;
+  fd_verify_pending_t p[1] = {{ .payload = udp_payload, .txn = txn, .payload_sz = payload_sz }};
+  fd_txn_verify_batch( ctx, p, 1UL );
+  if( FD_LIKELY( p->res==FD_TXN_VERIFY_SUCCESS ) ) *opt_sig = p->sig;
+  return p->res;
 }
 
 #endif /* HEADER_fd_src_app_fdctl_run_tiles_verify_h */
@@ -125,20 +125,12 @@ setup_verify_ctx( fd_verify_ctx_t * ctx, void ** mem ) {
   ctx->tcache_ring    = fd_tcache_ring_laddr  ( tcache );
   ctx->tcache_map     = fd_tcache_map_laddr   ( tcache );
   fd_tcache_reset( ctx->tcache_ring, ctx->tcache_depth, ctx->tcache_map, ctx->tcache_map_cnt );
-
-  /* ctx->sha */
-  uchar * _sha = aligned_alloc( FD_SHA512_ALIGN, sizeof(fd_sha512_t)*FD_TXN_ACTUAL_SIG_MAX );
-  for ( ulong i=0; i<FD_TXN_ACTUAL_SIG_MAX; i++ ) {
-    fd_sha512_t * sha = fd_sha512_join( fd_sha512_new( _sha + i*sizeof(fd_sha512_t) ) );
-    if( FD_UNLIKELY( !sha ) ) FD_LOG_ERR(( "fd_sha512_join failed" ));
-    ctx->sha[i] = sha;
-  }
 }
 
 static void
 free_verify_ctx( fd_verify_ctx_t * ctx, void * mem ) {
+  (void)ctx;
   free(mem);
-  free(ctx->sha[0]); // all sha allocated in a single malloc, the first one has the address
 }
 
 static void
@@ -265,6 +257,55 @@ test_verify_invalid_dedup_success( void ) {
   free_verify_ctx( ctx, mem );
 }
 
+static void
+test_verify_batch_success( void ) {
+  fd_verify_ctx_t     ctx[1];
+  void *              mem = NULL;
+  uchar               out_buf[ 4 ][ FD_TXN_MAX_SZ ];
+  uchar *             payload[ 4 ];
+  ulong               payload_sz[ 4 ];
+  fd_verify_pending_t pending[ 6 ];
+
+  FD_LOG_NOTICE(( "test_verify_batch_success" ));
+  setup_verify_ctx( ctx, &mem );
+
+  payload[0] = load_test_txn( valid_txn_2sigs,       sizeof(valid_txn_2sigs),       &payload_sz[0] );
+  payload[1] = load_test_txn( invalid_txn_2sigs,     sizeof(invalid_txn_2sigs),     &payload_sz[1] );
+  payload[2] = load_test_txn( invalid_txn_same_1sig, sizeof(invalid_txn_same_1sig), &payload_sz[2] );
+  payload[3] = load_test_txn( valid_txn_1sig,        sizeof(valid_txn_1sig),        &payload_sz[3] );
+  for( ulong i=0UL; i<4UL; i++ ) FD_TEST( fd_txn_parse( payload[i], payload_sz[i], out_buf[i], NULL ) );
+
+  /* One batch mixing valid, invalid and duplicate txns.  Results must
+     match verifying the txns one after the other: the invalid txn with
+     the signature of a valid one does not poison the valid one, and the
+     second copy of a valid txn is deduped. */
+
+  static ulong const order[ 6 ] = { 0UL, 1UL, 2UL, 3UL, 0UL, 3UL };
+  for( ulong i=0UL; i<6UL; i++ ) {
+    ulong k = order[ i ];
+    pending[ i ] = (fd_verify_pending_t){ .payload = payload[k], .txn = (fd_txn_t const *)out_buf[k], .payload_sz = (ushort)payload_sz[k] };
+  }
+  fd_txn_verify_batch( ctx, pending, 6UL );
+  FD_TEST( pending[0].res==FD_TXN_VERIFY_SUCCESS );
+  FD_TEST( pending[1].res==FD_TXN_VERIFY_FAILED  );
+  FD_TEST( pending[2].res==FD_TXN_VERIFY_FAILED  );
+  FD_TEST( pending[3].res==FD_TXN_VERIFY_SUCCESS );
+  FD_TEST( pending[4].res==FD_TXN_VERIFY_DEDUP   );
+  FD_TEST( pending[5].res==FD_TXN_VERIFY_DEDUP   );
+  FD_TEST( pending[0].sig==FD_LOAD( ulong, payload[0]+1 ) );
+  FD_TEST( pending[3].sig==FD_LOAD( ulong, payload[3]+1 ) );
+
+  /* Already verified txns are deduped before verification, a batch of
+     only dups verifies nothing */
+
+  fd_txn_verify_batch( ctx, pending+4, 2UL );
+  FD_TEST( pending[4].res==FD_TXN_VERIFY_DEDUP );
+  FD_TEST( pending[5].res==FD_TXN_VERIFY_DEDUP );
+
+  for( ulong i=0UL; i<4UL; i++ ) free( payload[i] );
+  free_verify_ctx( ctx, mem );
+}
+
 int
 main( int     argc,
       char ** argv ) {
@@ -273,6 +314,7 @@ main( int     argc,
   test_verify_success();
   test_verify_invalid_sigs_success();
   test_verify_invalid_dedup_success();
+  test_verify_batch_success();
 
   FD_LOG_NOTICE(( "pass" ));
   fd_halt();
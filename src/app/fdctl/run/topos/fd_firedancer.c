@@ -1,6 +1,7 @@
 /* Firedancer topology used for testing the full validator.
    Associated test script: test_firedancer.sh */
 #include "../../fdctl.h"
+#include "topos.h"
 
 #include "../tiles/fd_replay_notif.h"
 #include "../../../../disco/tiles.h"
@@ -22,6 +23,7 @@ fd_topo_firedancer( config_t * _config ) {
   ulong shred_tile_cnt  = config->layout.shred_tile_count;
   ulong quic_tile_cnt   = config->layout.quic_tile_count;
   ulong verify_tile_cnt = config->layout.verify_tile_count;
+  ulong dedup_tile_cnt  = config->layout.dedup_tile_count;
 
   ulong replay_tpool_thread_count = config->tiles.replay.tpool_thread_count;
 
@@ -34,6 +36,12 @@ fd_topo_firedancer( config_t * _config ) {
   fd_topob_wksp( topo, "net_quic"   );
   fd_topob_wksp( topo, "net_voter"  );
 
+  fd_topo_obj_t * net_umem[ FD_TOPO_MAX_TILES ] = { NULL };
+  if( FD_UNLIKELY( config->tiles.net.rx_in_place ) ) {
+    fd_topob_wksp( topo, "net_umem" );
+    for( ulong i=0UL; i<net_tile_cnt; i++ ) net_umem[ i ] = fd_topo_net_umem( topo, config, "net_umem" );
+  }
+
   fd_topob_wksp( topo, "quic_verify"  );
   fd_topob_wksp( topo, "verify_dedup" );
   fd_topob_wksp( topo, "dedup_pack"   );
@@ -98,15 +106,16 @@ fd_topo_firedancer( config_t * _config ) {
   #define FOR(cnt) for( ulong i=0UL; i<cnt; i++ )
 
   /*                                  topo, link_name,      wksp_name,      is_reasm, depth,                                    mtu,                           burst */
-  FOR(net_tile_cnt)    fd_topob_link( topo, "net_gossip",   "net_gossip",   0,        config->tiles.net.send_buffer_size,       FD_NET_MTU,                    1UL );
-  FOR(net_tile_cnt)    fd_topob_link( topo, "net_repair",   "net_repair",   0,        config->tiles.net.send_buffer_size,       FD_NET_MTU,                    1UL );
-  FOR(net_tile_cnt)    fd_topob_link( topo, "net_quic",     "net_quic",     0,        config->tiles.net.send_buffer_size,       FD_NET_MTU,                    1UL );
+  FOR(net_tile_cnt)    fd_topo_net_out_link( topo, config, "net_gossip",  "net_gossip",  net_umem[ i ] );
+  FOR(net_tile_cnt)    fd_topo_net_out_link( topo, config, "net_repair",  "net_repair",  net_umem[ i ] );
+  FOR(net_tile_cnt)    fd_topo_net_out_link( topo, config, "net_quic",    "net_quic",    net_umem[ i ] );
   FOR(quic_tile_cnt)   fd_topob_link( topo, "quic_net",     "net_quic",     0,        config->tiles.net.send_buffer_size,       FD_NET_MTU,                    1UL );
-  FOR(net_tile_cnt)    fd_topob_link( topo, "net_shred",    "net_shred",    0,        config->tiles.net.send_buffer_size,       FD_NET_MTU,                    1UL );
+  FOR(net_tile_cnt)    fd_topo_net_out_link( topo, config, "net_shred",   "net_shred",   net_umem[ i ] );
   FOR(shred_tile_cnt)  fd_topob_link( topo, "shred_net",    "net_shred",    0,        config->tiles.net.send_buffer_size,       FD_NET_MTU,                    1UL );
   FOR(quic_tile_cnt)   fd_topob_link( topo, "quic_verify",  "quic_verify",  1,        config->tiles.verify.receive_buffer_size, 0UL,                           config->tiles.quic.txn_reassembly_count );
-  FOR(verify_tile_cnt) fd_topob_link( topo, "verify_dedup", "verify_dedup", 0,        config->tiles.verify.receive_buffer_size, FD_TPU_DCACHE_MTU,             1UL );
-  /**/                 fd_topob_link( topo, "dedup_pack",   "dedup_pack",   0,        config->tiles.verify.receive_buffer_size, FD_TPU_DCACHE_MTU,             1UL );
+  /* verify publishes a batch of up to VERIFY_BATCH_TXN_MAX txns at once, see fd_verify.c */
+  FOR(verify_tile_cnt) fd_topob_link( topo, "verify_dedup", "verify_dedup", 0,        config->tiles.verify.receive_buffer_size, FD_TPU_DCACHE_MTU,             16UL );
+  FOR(dedup_tile_cnt)  fd_topob_link( topo, "dedup_pack",   "dedup_pack",   0,        config->tiles.verify.receive_buffer_size, FD_TPU_DCACHE_MTU,             1UL );
 
   /**/                 fd_topob_link( topo, "stake_out",    "stake_out",    0,        128UL,                                    40UL + 40200UL * 40UL,         1UL );
   /* See long comment in fd_shred.c for an explanation about the size of this dcache. */
@@ -163,7 +172,7 @@ fd_topo_firedancer( config_t * _config ) {
   FOR(net_tile_cnt)                fd_topob_tile( topo, "net",     "net",     "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       NULL,           0UL );
   FOR(quic_tile_cnt)               fd_topob_tile( topo, "quic",    "quic",    "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "quic_verify",  i   );
   FOR(verify_tile_cnt)             fd_topob_tile( topo, "verify",  "verify",  "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "verify_dedup", i   );
-  /**/                             fd_topob_tile( topo, "dedup",   "dedup",   "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "dedup_pack",   0UL );
+  FOR(dedup_tile_cnt)              fd_topob_tile( topo, "dedup",   "dedup",   "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "dedup_pack",   i   );
   FOR(shred_tile_cnt)              fd_topob_tile( topo, "shred",   "shred",   "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "shred_storei", i   );
   /**/                             fd_topob_tile( topo, "gossip",  "gossip",  "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "gossip_net",   0UL );
   /**/                             fd_topob_tile( topo, "repair",  "repair",  "metric_in", "metric_in",  tile_to_cpu[ topo->tile_cnt ], 0,       "repair_store", 0UL );
@@ -266,7 +275,9 @@ fd_topo_firedancer( config_t * _config ) {
   /* All verify tiles read from all QUIC tiles, packets are round robin. */
   FOR(verify_tile_cnt) for( ulong j=0UL; j<quic_tile_cnt; j++ )
                        fd_topob_tile_in(  topo, "verify",  i,            "metric_in", "quic_verify",  j,            FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED ); /* No reliable consumers, verify tiles may be overrun */
-  FOR(verify_tile_cnt) fd_topob_tile_in(  topo, "dedup",   0UL,          "metric_in", "verify_dedup", i,            FD_TOPOB_RELIABLE,   FD_TOPOB_POLLED );
+  /* All dedup tiles read from all verify tiles, txns are partitioned by signature. */
+  FOR(dedup_tile_cnt) for( ulong j=0UL; j<verify_tile_cnt; j++ )
+                       fd_topob_tile_in(  topo, "dedup",   i,            "metric_in", "verify_dedup", j,            FD_TOPOB_RELIABLE,   FD_TOPOB_POLLED );
 
   FOR(net_tile_cnt)    fd_topob_tile_in(  topo, "net",     i,            "metric_in", "gossip_net",   0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED ); /* No reliable consumers of networking fragments, may be dropped or overrun */
   FOR(net_tile_cnt)    fd_topob_tile_in(  topo, "net",     i,            "metric_in", "repair_net",   0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED ); /* No reliable consumers of networking fragments, may be dropped or overrun */
@@ -295,6 +306,7 @@ fd_topo_firedancer( config_t * _config ) {
     /**/               fd_topob_tile_in(  topo, "sign",   0UL,           "metric_in", "quic_sign",      i,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   );
     /**/               fd_topob_tile_out( topo, "quic",     i,                        "quic_sign",      i                                                  );
     /**/               fd_topob_tile_in(  topo, "quic",     i,           "metric_in", "sign_quic",      i,          FD_TOPOB_UNRELIABLE, FD_TOPOB_UNPOLLED );
+    /**/               fd_topob_tile_in(  topo, "quic",     i,           "metric_in", "stake_out",      0UL,        FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   ); /* QoS only, may be overrun */
     /**/               fd_topob_tile_out( topo, "sign",   0UL,                        "sign_quic",      i                                                  );
   }
 
@@ -342,7 +354,7 @@ fd_topo_firedancer( config_t * _config ) {
   /**/                 fd_topob_tile_in(  topo, "sender",  0UL,          "metric_in",  "sign_voter",   0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_UNPOLLED );
 
   /**/                 fd_topob_tile_in(  topo, "pack",    0UL,          "metric_in",  "voter_pack",   0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   );
-  /**/                 fd_topob_tile_in(  topo, "pack",   0UL,           "metric_in",  "dedup_pack",    0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   ); /* No reliable consumers of networking fragments, may be dropped or overrun */
+  FOR(dedup_tile_cnt)  fd_topob_tile_in(  topo, "pack",   0UL,           "metric_in",  "dedup_pack",    i,            FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   ); /* No reliable consumers of networking fragments, may be dropped or overrun */
   /**/                 fd_topob_tile_in(  topo, "pack",   0UL,           "metric_in",  "poh_pack",      0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED );
   /**/                 fd_topob_tile_in(  topo, "pack",   0UL,           "metric_in",  "gossip_pack",  0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   ); /* No reliable consumers of networking fragments, may be dropped or overrun */
   /**/                 fd_topob_tile_in(  topo, "bhole",  0UL,           "metric_in",  "replay_notif", 0UL,          FD_TOPOB_UNRELIABLE, FD_TOPOB_POLLED   ); /* No reliable consumers of networking fragments, may be dropped or overrun */
@@ -368,10 +380,12 @@ fd_topo_firedancer( config_t * _config ) {
       memcpy(  tile->net.src_mac_addr, config->tiles.net.mac_addr,  6UL );
 
       tile->net.xdp_aio_depth                  = config->tiles.net.xdp_aio_depth;
+      tile->net.xdp_queue_cnt                  = config->tiles.net.xdp_queues_per_tile;
       tile->net.xdp_rx_queue_size              = config->tiles.net.xdp_rx_queue_size;
       tile->net.xdp_tx_queue_size              = config->tiles.net.xdp_tx_queue_size;
       tile->net.src_ip_addr                    = config->tiles.net.ip_addr;
       tile->net.zero_copy                      = !!strcmp( config->tiles.net.xdp_mode, "skb" ); /* disable zc for skb */
+      tile->net.rx_in_place                    = config->tiles.net.rx_in_place;
       fd_memset( tile->net.xdp_mode, 0, 4 );
       fd_memcpy( tile->net.xdp_mode, config->tiles.net.xdp_mode, strnlen( config->tiles.net.xdp_mode, 3 ) );  /* GCC complains about strncpy */
 
@@ -400,6 +414,8 @@ fd_topo_firedancer( config_t * _config ) {
       tile->quic.retry                          = config->tiles.quic.retry;
       tile->quic.max_concurrent_streams_per_connection = config->tiles.quic.max_concurrent_streams_per_connection;
       tile->quic.stream_pool_cnt                = config->tiles.quic.stream_pool_cnt;
+      tile->quic.staked_connection_reserve      = config->tiles.quic.staked_connection_reserve;
+      tile->quic.unstaked_streams_per_connection = config->tiles.quic.unstaked_streams_per_connection;
 
     } else if( FD_UNLIKELY( !strcmp( tile->name, "verify" ) ) ) {
 
@@ -458,6 +474,9 @@ fd_topo_firedancer( config_t * _config ) {
 
       strncpy( tile->replay.blockstore_checkpt, config->tiles.replay.blockstore_checkpt, sizeof(tile->replay.blockstore_checkpt) );
       tile->replay.blockstore_publish = config->tiles.replay.blockstore_publish;
+      strncpy( tile->replay.blockstore_archive, config->tiles.replay.blockstore_archive, sizeof(tile->replay.blockstore_archive) );
+      tile->replay.blockstore_archive_sz_gb = config->tiles.replay.blockstore_archive_sz_gb;
+      tile->replay.blockstore_sig_index_lg_max = config->tiles.replay.blockstore_sig_index_lg_max;
       strncpy( tile->replay.capture, config->tiles.replay.capture, sizeof(tile->replay.capture) );
       strncpy( tile->replay.funk_checkpt, config->tiles.replay.funk_checkpt, sizeof(tile->replay.funk_checkpt) );
       tile->replay.funk_rec_max = config->tiles.replay.funk_rec_max;
@@ -465,9 +484,12 @@ fd_topo_firedancer( config_t * _config ) {
       tile->replay.funk_txn_max = config->tiles.replay.funk_txn_max;
       strncpy( tile->replay.genesis, config->tiles.replay.genesis, sizeof(tile->replay.genesis) );
       strncpy( tile->replay.incremental, config->tiles.replay.incremental, sizeof(tile->replay.incremental) );
+      tile->replay.jit_cache_sz_mb = config->tiles.replay.jit_cache_sz_mb;
+      tile->replay.owner_index_max = config->tiles.replay.owner_index_max;
       strncpy( tile->replay.slots_replayed, config->tiles.replay.slots_replayed, sizeof(tile->replay.slots_replayed) );
       strncpy( tile->replay.snapshot, config->tiles.replay.snapshot, sizeof(tile->replay.snapshot) );
       strncpy( tile->replay.status_cache, config->tiles.replay.status_cache, sizeof(tile->replay.status_cache) );
+      tile->replay.token_index_max = config->tiles.replay.token_index_max;
       tile->replay.tpool_thread_count = config->tiles.replay.tpool_thread_count;
       if( FD_UNLIKELY( tile->replay.tpool_thread_count == 0 || tile->replay.tpool_thread_count>FD_TILE_MAX ) ) {
         FD_LOG_ERR(( "bad tpool_thread_count %lu", tile->replay.tpool_thread_count ));
@@ -1,5 +1,9 @@
 #include "topos.h"
 
+#include "../../../../disco/topo/fd_topob.h"
+#include "../../../../disco/topo/fd_pod_format.h"
+#include "../../../../waltz/xdp/fd_xsk.h"
+
 #define FD_TOPO_KIND_CSTR_LEN_MAX (32UL)
 
 FD_FN_CONST fd_topo_config_fn *
@@ -10,3 +14,33 @@ fd_topo_kind_str_to_topo_config_fn( char const * topo_kind_str ) {
     FD_LOG_ERR(( "unknown topo kind %s", topo_kind_str ));
   }
 }
+
+fd_topo_obj_t *
+fd_topo_net_umem( fd_topo_t *      topo,
+                  config_t const * config,
+                  char const *     wksp_name ) {
+  ulong rx_depth = config->tiles.net.xdp_rx_queue_size;
+  ulong tx_depth = config->tiles.net.xdp_tx_queue_size;
+
+  /* Room for an XSK per queue and the loopback XSK, each possibly
+     misaligned within the dcache data region, and a trailing MTU so
+     that every UMEM frame is below the dcache watermark. */
+  ulong xsk_sz  = FD_XSK_ALIGN + fd_xsk_footprint( FD_NET_MTU, rx_depth, rx_depth, tx_depth, tx_depth );
+  ulong data_sz = ( config->tiles.net.xdp_queues_per_tile+1UL )*xsk_sz + FD_NET_MTU;
+
+  fd_topo_obj_t * obj = fd_topob_obj( topo, "dcache", wksp_name );
+  FD_TEST( fd_pod_insertf_ulong( topo->props, fd_ulong_align_up( data_sz, FD_NET_MTU )/FD_NET_MTU, "obj.%lu.depth", obj->id ) );
+  FD_TEST( fd_pod_insertf_ulong( topo->props, 1UL,                                                  "obj.%lu.burst", obj->id ) );
+  FD_TEST( fd_pod_insertf_ulong( topo->props, FD_NET_MTU,                                           "obj.%lu.mtu",   obj->id ) );
+  return obj;
+}
+
+void
+fd_topo_net_out_link( fd_topo_t *           topo,
+                      config_t const *      config,
+                      char const *          link_name,
+                      char const *          wksp_name,
+                      fd_topo_obj_t const * umem ) {
+  if( FD_LIKELY( !umem ) ) fd_topob_link       ( topo, link_name, wksp_name, 0, config->tiles.net.send_buffer_size, FD_NET_MTU, 1UL );
+  else                     fd_topob_link_shared( topo, link_name, wksp_name,    config->tiles.net.send_buffer_size, FD_NET_MTU, 1UL, umem );
+}
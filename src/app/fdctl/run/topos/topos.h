@@ -11,4 +11,29 @@ extern fd_topo_config_fn fd_topo_firedancer;
 FD_FN_CONST fd_topo_config_fn *
 fd_topo_kind_str_to_topo_config_fn( char const * topo_kind_str );
 
+/* fd_topo_net_umem creates a dcache object in the given workspace that
+   is large enough to hold the XSKs (including their UMEM frames) of a
+   single net tile.  It is used when tiles.net.rx_in_place is enabled,
+   in which case the net tile places its XSKs in this object and
+   publishes received packets to its out links directly from the UMEM,
+   see fd_net.c. */
+
+fd_topo_obj_t *
+fd_topo_net_umem( fd_topo_t *      topo,
+                  config_t const * config,
+                  char const *     wksp_name );
+
+/* fd_topo_net_out_link creates a link from a net tile to a consumer
+   of received packets.  If umem is NULL, the link gets a dcache of its
+   own like any other link.  Otherwise, frags of the link point into
+   umem, which was created with fd_topo_net_umem for the producing net
+   tile. */
+
+void
+fd_topo_net_out_link( fd_topo_t *           topo,
+                      config_t const *      config,
+                      char const *          link_name,
+                      char const *          wksp_name,
+                      fd_topo_obj_t const * umem );
+
 #endif /* HEADER_fd_src_app_fdctl_run_topos_h */
@@ -26,14 +26,14 @@ fini_perm( fd_caps_ctx_t *  caps,
 
 static void
 init( config_t * const config ) {
-  uint tiles              = config->layout.net_tile_count;
+  uint queues             = config->layout.net_tile_count * config->tiles.net.xdp_queues_per_tile;
   const char * interface0 = config->development.netns.interface0;
   const char * interface1 = config->development.netns.interface1;
 
   RUN( "ip netns add %s", interface0 );
   RUN( "ip netns add %s", interface1 );
   RUN( "ip link add dev %s netns %s type veth peer name %s netns %s numrxqueues %u numtxqueues %u",
-        interface0, interface0, interface1, interface1, tiles, tiles );
+        interface0, interface0, interface1, interface1, queues, queues );
   RUN( "ip netns exec %s ip link set dev %s address %s",
        interface0, interface0, config->development.netns.interface0_mac );
   RUN( "ip netns exec %s ip link set dev %s address %s",
@@ -45,12 +45,13 @@ init( config_t * const config ) {
   RUN( "ip netns exec %s ip link set dev %s up", interface0, interface0 );
   RUN( "ip netns exec %s ip link set dev %s up", interface1, interface1 );
 
-  /* we need one channel for both TX and RX on the NIC for each QUIC
-     tile, but the virtual interfaces default to one channel total */
+  /* we need one channel for both TX and RX on the NIC for each queue
+     of each net tile, but the virtual interfaces default to one channel
+     total */
   RUN( "nsenter --net=/var/run/netns/%s ethtool --set-channels %s rx %u tx %u",
-       interface0, interface0, tiles, tiles );
+       interface0, interface0, queues, queues );
   RUN( "nsenter --net=/var/run/netns/%s ethtool --set-channels %s rx %u tx %u",
-       interface1, interface1, tiles, tiles );
+       interface1, interface1, queues, queues );
 
   /* UDP segmentation is a kernel feature that batches multiple UDP
      packets into one in the kernel before splitting them later when
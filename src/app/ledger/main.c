@@ -89,6 +89,7 @@ struct fd_ledger_args {
   ulong                 rocksdb_list_slot[32];   /* start slot for each rocksdb dir that's passed in assuming there are mulitple */
   ulong                 rocksdb_list_cnt;        /* number of rocksdb dirs passed in */
   uint                  cluster_version;         /* What version of solana is the genesis block? */
+  ulong                 scheduler;               /* txn scheduler used during replay (FD_RUNTIME_SCHEDULER_*) */
 
   /* These values are setup before replay */
   fd_capture_ctx_t *    capture_ctx;             /* capture_ctx is used in runtime_replay for various debugging tasks */
@@ -105,9 +106,11 @@ struct fd_ledger_args {
 };
 typedef struct fd_ledger_args fd_ledger_args_t;
 
-/* Runtime Replay *************************************************************/
-int
-runtime_replay( fd_ledger_args_t * ledger_args ) {
+/* init_tpool creates the thread pool used for snapshot loading and
+   execution.  No-op if the thread pool already exists. */
+static void
+init_tpool( fd_ledger_args_t * ledger_args ) {
+  if( ledger_args->tpool ) return;
   ulong tcnt = fd_tile_cnt();
   uchar * tpool_scr_mem = NULL;
   fd_tpool_t * tpool = NULL;
@@ -132,6 +135,12 @@ runtime_replay( fd_ledger_args_t * ledger_args ) {
   }
   ledger_args->tpool       = tpool;
   ledger_args->max_workers = tcnt;
+}
+
+/* Runtime Replay *************************************************************/
+int
+runtime_replay( fd_ledger_args_t * ledger_args ) {
+  init_tpool( ledger_args );
 
   fd_funk_start_write( ledger_args->slot_ctx->acc_mgr->funk );
   ulong r = fd_funk_txn_cancel_all( ledger_args->slot_ctx->acc_mgr->funk, 1 );
@@ -147,6 +156,7 @@ runtime_replay( fd_ledger_args_t * ledger_args ) {
   long              replay_time = -fd_log_wallclock();
   ulong             txn_cnt     = 0;
   ulong             slot_cnt    = 0;
+  long              eval_max    = 0L;
   fd_blockstore_t * blockstore  = ledger_args->slot_ctx->blockstore;
 
   ulong prev_slot  = ledger_args->slot_ctx->slot_bank.slot;
@@ -216,14 +226,17 @@ runtime_replay( fd_ledger_args_t * ledger_args ) {
     fd_blockstore_end_read( blockstore );
 
     ulong blk_txn_cnt = 0;
+    long  eval_time   = -fd_log_wallclock();
     FD_TEST( fd_runtime_block_eval_tpool( ledger_args->slot_ctx,
                                           ledger_args->capture_ctx,
                                           val,
                                           sz,
                                           ledger_args->tpool,
                                           ledger_args->max_workers,
-                                          1,
+                                          ledger_args->scheduler,
                                           &blk_txn_cnt ) == FD_RUNTIME_EXECUTE_SUCCESS );
+    eval_time += fd_log_wallclock();
+    eval_max   = fd_long_max( eval_max, eval_time );
     txn_cnt += blk_txn_cnt;
     slot_cnt++;
 
@@ -316,12 +329,14 @@ runtime_replay( fd_ledger_args_t * ledger_args ) {
   double tps           = (double)txn_cnt / replay_time_s;
   double sec_per_slot  = replay_time_s / (double)slot_cnt;
   FD_LOG_NOTICE((
-        "replay completed - slots: %lu, elapsed: %6.6f s, txns: %lu, tps: %6.6f, sec/slot: %6.6f",
+        "replay completed - slots: %lu, elapsed: %6.6f s, txns: %lu, tps: %6.6f, sec/slot: %6.6f, max sec/slot: %6.6f, scheduler: %s",
         slot_cnt,
         replay_time_s,
         txn_cnt,
         tps,
-        sec_per_slot ));
+        sec_per_slot,
+        (double)eval_max * 1e-9,
+        ledger_args->scheduler==FD_RUNTIME_SCHEDULER_DAG ? "dag" : "wave" ));
 
   if ( slot_cnt == 0 ) {
     FD_LOG_ERR(( "No slots replayed" ));
@@ -995,12 +1010,13 @@ replay( fd_ledger_args_t * args ) {
   ulong rec_cnt = fd_funk_rec_cnt( fd_funk_rec_map( funk, fd_funk_wksp( funk ) ) );
   if( !rec_cnt ) {
     /* Load in snapshot(s) */
+    init_tpool( args );
     if( args->snapshot ) {
-      fd_snapshot_load( args->snapshot, args->slot_ctx, args->verify_acc_hash, args->check_acc_hash, FD_SNAPSHOT_TYPE_FULL );
+      fd_snapshot_load_tpool( args->snapshot, args->slot_ctx, args->verify_acc_hash, args->check_acc_hash, FD_SNAPSHOT_TYPE_FULL, args->tpool, args->max_workers );
       FD_LOG_NOTICE(( "imported %lu records from snapshot", fd_funk_rec_cnt( fd_funk_rec_map( funk, fd_funk_wksp( funk ) ) ) ));
     }
     if( args->incremental ) {
-      fd_snapshot_load( args->incremental, args->slot_ctx, args->verify_acc_hash, args->check_acc_hash, FD_SNAPSHOT_TYPE_INCREMENTAL );
+      fd_snapshot_load_tpool( args->incremental, args->slot_ctx, args->verify_acc_hash, args->check_acc_hash, FD_SNAPSHOT_TYPE_INCREMENTAL, args->tpool, args->max_workers );
       FD_LOG_NOTICE(( "imported %lu records from snapshot", fd_funk_rec_cnt( fd_funk_rec_map( funk, fd_funk_wksp( funk ) ) ) ));
     }
     if( args->genesis ) {
@@ -1348,6 +1364,7 @@ initial_setup( int argc, char ** argv, fd_ledger_args_t * args ) {
   char const * rocksdb_list_starts     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--rocksdb-starts",          NULL, NULL      );
   uint         cluster_version         = fd_env_strip_cmdline_uint ( &argc, &argv, "--cluster-version",         NULL, FD_DEFAULT_AGAVE_CLUSTER_VERSION );
   char const * checkpt_status_cache    = fd_env_strip_cmdline_cstr ( &argc, &argv, "--checkpt-status-cache",    NULL, NULL      );
+  char const * scheduler               = fd_env_strip_cmdline_cstr ( &argc, &argv, "--scheduler",               NULL, "wave"    );
 
 
   #ifdef _ENABLE_LTHASH
@@ -1465,6 +1482,9 @@ initial_setup( int argc, char ** argv, fd_ledger_args_t * args ) {
   args->vote_acct_max           = vote_acct_max;
   args->rocksdb_list_cnt        = 0UL;
   args->checkpt_status_cache    = checkpt_status_cache;
+  if(      !strcmp( scheduler, "dag"  ) ) args->scheduler = FD_RUNTIME_SCHEDULER_DAG;
+  else if( !strcmp( scheduler, "wave" ) ) args->scheduler = FD_RUNTIME_SCHEDULER_WAVE;
+  else FD_LOG_ERR(( "unknown --scheduler %s (expected dag or wave)", scheduler ));
   parse_rocksdb_list( args, rocksdb_list, rocksdb_list_starts );
 
   if( args->rocksdb_list_cnt==1UL ) {
@@ -4,6 +4,10 @@ typedef enum {
 
 enum fd_block_detail { FD_BLOCK_DETAIL_FULL, FD_BLOCK_DETAIL_ACCTS, FD_BLOCK_DETAIL_SIGS, FD_BLOCK_DETAIL_NONE };
 
+void fd_error_to_json( fd_textstream_t * ts,
+                       const uchar* bytes,
+                       ulong size );
+
 int fd_txn_meta_to_json( fd_textstream_t * ts,
                          const void * meta_raw,
                          ulong meta_raw_sz );
@@ -4,11 +4,16 @@
 #include "fd_webserver.h"
 #include "../../flamenco/types/fd_types.h"
 #include "../../flamenco/types/fd_solana_block.pb.h"
+#include "../../flamenco/nanopb/pb_decode.h"
 #include "../../flamenco/runtime/fd_runtime.h"
 #include "../../flamenco/runtime/fd_acc_mgr.h"
+#include "../../flamenco/runtime/fd_acc_owner_idx.h"
+#include "../../flamenco/runtime/fd_acc_token_idx.h"
+#include "../../flamenco/runtime/fd_blockstore_sig_idx.h"
 #include "../../flamenco/runtime/sysvar/fd_sysvar_rent.h"
 #include "../../flamenco/runtime/sysvar/fd_sysvar_epoch_schedule.h"
 #include "../../ballet/base58/fd_base58.h"
+#include "../../ballet/base64/fd_base64.h"
 #include "keywords.h"
 
 #define CRLF "\r\n"
@@ -35,6 +40,8 @@ struct fd_rpc_global_ctx {
   fd_readwrite_lock_t lock;
   fd_webserver_t ws;
   fd_funk_t * funk;
+  fd_acc_owner_idx_t * owner_idx;
+  fd_acc_token_idx_t * token_idx;
   fd_blockstore_t * blockstore;
   struct fd_ws_subscription sub_list[FD_WS_MAX_SUBS];
   ulong sub_cnt;
@@ -923,12 +930,277 @@ method_getMultipleAccounts(struct fd_web_replier* replier, struct json_values* v
   return 0;
 }
 
+/* Find the account owner index maintained by the replay tile in the
+   funk workspace, NULL if the validator does not keep one. */
+
+static fd_acc_owner_idx_t *
+get_owner_idx( fd_rpc_ctx_t * ctx ) {
+  fd_rpc_global_ctx_t * glob = ctx->global;
+  if( glob->owner_idx ) return glob->owner_idx;
+  fd_wksp_t * wksp = fd_funk_wksp( glob->funk );
+  fd_wksp_tag_query_info_t info;
+  ulong tag = FD_ACC_OWNER_IDX_MAGIC;
+  if( fd_wksp_tag_query( wksp, &tag, 1, &info, 1 ) > 0 ) {
+    glob->owner_idx = fd_acc_owner_idx_join( fd_wksp_laddr_fast( wksp, info.gaddr_lo ) );
+  }
+  return glob->owner_idx;
+}
+
+/* Decode an arbitrary length base58 string, returns the decoded size
+   or -1 on error */
+
+static long
+decode_base58( uchar * out, ulong out_max, char const * in, ulong in_sz ) {
+  static const char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+  ulong out_sz = 0;
+  ulong zeros = 0;
+  while( zeros < in_sz && in[zeros] == '1' ) zeros++;
+  for( ulong i = zeros; i < in_sz; ++i ) {
+    char const * p = memchr( alphabet, in[i], sizeof(alphabet)-1 );
+    if( p == NULL ) return -1;
+    ulong carry = (ulong)(p - alphabet);
+    /* out holds the big endian value so far, reversed */
+    for( ulong j = 0; j < out_sz; ++j ) {
+      carry += (ulong)out[j] * 58UL;
+      out[j] = (uchar)carry;
+      carry >>= 8;
+    }
+    while( carry ) {
+      if( out_sz == out_max ) return -1;
+      out[out_sz++] = (uchar)carry;
+      carry >>= 8;
+    }
+  }
+  if( out_sz + zeros > out_max ) return -1;
+  for( ulong j = 0; j < out_sz/2; ++j ) {
+    uchar t = out[j]; out[j] = out[out_sz-1-j]; out[out_sz-1-j] = t;
+  }
+  memmove( out + zeros, out, out_sz );
+  memset( out, 0, zeros );
+  return (long)(out_sz + zeros);
+}
+
+#define FD_RPC_FILTER_MAX      (4UL)
+#define FD_RPC_MEMCMP_MAX      (128UL)
+#define FD_RPC_PROGRAM_ACC_MAX (1UL<<20)
+
+struct fd_rpc_acct_filter {
+  long  data_sz;  /* FD_LONG_UNSET if not a dataSize filter */
+  ulong off;
+  ulong bytes_sz;
+  uchar bytes[FD_RPC_MEMCMP_MAX];
+};
+typedef struct fd_rpc_acct_filter fd_rpc_acct_filter_t;
+
+static int
+acct_filter_match( fd_rpc_acct_filter_t const * filters, ulong filter_cnt, uchar const * val, ulong val_sz ) {
+  fd_account_meta_t const * meta = (fd_account_meta_t const *)val;
+  uchar const * data    = val + meta->hlen;
+  ulong         data_sz = fd_ulong_min( meta->dlen, val_sz - meta->hlen );
+  for( ulong i = 0; i < filter_cnt; ++i ) {
+    fd_rpc_acct_filter_t const * f = filters + i;
+    if( f->data_sz != FD_LONG_UNSET ) {
+      if( (ulong)f->data_sz != data_sz ) return 0;
+    } else {
+      if( f->off > data_sz || f->bytes_sz > data_sz - f->off ) return 0;
+      if( memcmp( data + f->off, f->bytes, f->bytes_sz ) ) return 0;
+    }
+  }
+  return 1;
+}
+
 // Implementation of the "getProgramAccounts" methods
+// curl http://localhost:8123 -X POST -H "Content-Type: application/json" -d '{ "jsonrpc": "2.0", "id": 1, "method": "getProgramAccounts", "params": [ "Stake11111111111111111111111111111111111111", { "encoding": "base64", "filters": [ { "dataSize": 200 } ] } ] }'
+
 static int
 method_getProgramAccounts(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx) {
-  (void)values;
-  (void)ctx;
-  fd_web_replier_error(replier, "getProgramAccounts is not implemented");
+  FD_METHOD_SCRATCH_BEGIN( 64<<20 ) {
+    static const uint PATH[3] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 0,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong arg_sz = 0;
+    const void* arg = json_get_value(values, PATH, 3, &arg_sz);
+    if (arg == NULL) {
+      fd_web_replier_error(replier, "getProgramAccounts requires a string as first parameter");
+      return 0;
+    }
+    fd_pubkey_t owner;
+    if( fd_base58_decode_32((const char *)arg, owner.uc) == NULL ) {
+      fd_web_replier_error(replier, "invalid program id %s", (const char*)arg);
+      return 0;
+    }
+
+    fd_acc_owner_idx_t * idx = get_owner_idx(ctx);
+    if( idx == NULL ) {
+      fd_web_replier_error(replier, "getProgramAccounts requires the account owner index (replay tile owner_index_max)");
+      return 0;
+    }
+
+    static const uint ENC_PATH[4] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 1,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_ENCODING,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong enc_str_sz = 0;
+    const void* enc_str = json_get_value(values, ENC_PATH, 4, &enc_str_sz);
+    fd_rpc_encoding_t enc;
+    if (enc_str == NULL || MATCH_STRING(enc_str, enc_str_sz, "base58"))
+      enc = FD_ENC_BASE58;
+    else if (MATCH_STRING(enc_str, enc_str_sz, "base64"))
+      enc = FD_ENC_BASE64;
+    else if (MATCH_STRING(enc_str, enc_str_sz, "base64+zstd"))
+      enc = FD_ENC_BASE64_ZSTD;
+    else if (MATCH_STRING(enc_str, enc_str_sz, "jsonParsed"))
+      enc = FD_ENC_JSON;
+    else {
+      fd_web_replier_error(replier, "invalid data encoding %s", (const char*)enc_str);
+      return 0;
+    }
+
+    static const uint LEN_PATH[5] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 1,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_DATASLICE,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_LENGTH,
+      (JSON_TOKEN_INTEGER<<16)
+    };
+    static const uint OFF_PATH[5] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 1,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_DATASLICE,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_OFFSET,
+      (JSON_TOKEN_INTEGER<<16)
+    };
+    ulong len_sz = 0;
+    const void* len_ptr = json_get_value(values, LEN_PATH, 5, &len_sz);
+    ulong off_sz = 0;
+    const void* off_ptr = json_get_value(values, OFF_PATH, 5, &off_sz);
+    long off = (off_ptr ? *(long *)off_ptr : FD_LONG_UNSET);
+    long len = (len_ptr ? *(long *)len_ptr : FD_LONG_UNSET);
+
+    // Parse the filters
+    fd_rpc_acct_filter_t filters[FD_RPC_FILTER_MAX];
+    ulong filter_cnt = 0;
+    for ( ulong i = 0; ; ++i ) {
+      uint path[6];
+      path[0] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS;
+      path[1] = (JSON_TOKEN_LBRACKET<<16) | 1;
+      path[2] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_FILTERS;
+      path[3] = (uint) ((JSON_TOKEN_LBRACKET<<16) | i);
+
+      ulong val_sz = 0;
+      path[4] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_DATASIZE;
+      path[5] = (JSON_TOKEN_INTEGER<<16);
+      const void* data_sz = json_get_value(values, path, 5, &val_sz);
+
+      path[4] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_MEMCMP;
+      path[5] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_BYTES;
+      uint path_str[7];
+      fd_memcpy( path_str, path, sizeof(path) );
+      path_str[6] = (JSON_TOKEN_STRING<<16);
+      ulong bytes_str_sz = 0;
+      const void* bytes_str = json_get_value(values, path_str, 7, &bytes_str_sz);
+
+      if (data_sz == NULL && bytes_str == NULL)
+        // End of list
+        break;
+      if (filter_cnt == FD_RPC_FILTER_MAX) {
+        fd_web_replier_error(replier, "too many filters, at most %lu are supported", FD_RPC_FILTER_MAX);
+        return 0;
+      }
+
+      fd_rpc_acct_filter_t * f = filters + filter_cnt++;
+      if (data_sz != NULL) {
+        f->data_sz = *(long *)data_sz;
+        if (f->data_sz < 0) {
+          fd_web_replier_error(replier, "invalid dataSize filter");
+          return 0;
+        }
+        continue;
+      }
+
+      f->data_sz = FD_LONG_UNSET;
+      path_str[5] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_OFFSET;
+      path_str[6] = (JSON_TOKEN_INTEGER<<16);
+      const void* off_val = json_get_value(values, path_str, 7, &val_sz);
+      if (off_val == NULL || *(long *)off_val < 0) {
+        fd_web_replier_error(replier, "memcmp filter requires a non-negative offset");
+        return 0;
+      }
+      f->off = (ulong)*(long *)off_val;
+
+      path_str[5] = (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_ENCODING;
+      path_str[6] = (JSON_TOKEN_STRING<<16);
+      ulong fenc_sz = 0;
+      const void* fenc = json_get_value(values, path_str, 7, &fenc_sz);
+      long bytes_sz;
+      if (fenc == NULL || MATCH_STRING(fenc, fenc_sz, "base58")) {
+        bytes_sz = decode_base58(f->bytes, FD_RPC_MEMCMP_MAX, (const char *)bytes_str, bytes_str_sz);
+      } else if (MATCH_STRING(fenc, fenc_sz, "base64")) {
+        if (FD_BASE64_DEC_SZ(bytes_str_sz) > FD_RPC_MEMCMP_MAX)
+          bytes_sz = -1;
+        else
+          bytes_sz = fd_base64_decode(f->bytes, (const char *)bytes_str, bytes_str_sz);
+      } else {
+        fd_web_replier_error(replier, "invalid memcmp encoding %s", (const char*)fenc);
+        return 0;
+      }
+      if (bytes_sz < 0) {
+        fd_web_replier_error(replier, "invalid memcmp bytes %s", (const char*)bytes_str);
+        return 0;
+      }
+      f->bytes_sz = (ulong)bytes_sz;
+    }
+
+    // Collect the candidates from the index, then check each one
+    // against the current state of the funk
+    fd_funk_t * funk = ctx->global->funk;
+    ulong acct_max = FD_RPC_PROGRAM_ACC_MAX;
+    fd_pubkey_t * accts = fd_scratch_alloc( alignof(fd_pubkey_t), acct_max * sizeof(fd_pubkey_t) );
+    ulong acct_cnt = fd_acc_owner_idx_query_safe( idx, funk, &owner, accts, acct_max );
+    if (acct_cnt > acct_max) {
+      fd_web_replier_error(replier, "program has too many accounts (%lu)", acct_cnt);
+      return 0;
+    }
+
+    fd_blockstore_t * blockstore = ctx->global->blockstore;
+    fd_textstream_t * ts = fd_web_replier_textstream(replier);
+    fd_textstream_sprintf(ts, "{\"jsonrpc\":\"2.0\",\"result\":{\"context\":{\"apiVersion\":\"" FIREDANCER_VERSION "\",\"slot\":%lu},\"value\":[",
+                          blockstore->smr);
+
+    ulong out_cnt = 0;
+    for ( ulong i = 0; i < acct_cnt; ++i ) {
+      fd_scratch_push();
+      ulong val_sz;
+      uchar * val = read_account(ctx, accts + i, fd_scratch_virtual(), &val_sz);
+      fd_account_meta_t const * meta = (fd_account_meta_t const *)val;
+      if (val == NULL || val_sz < sizeof(fd_account_meta_t) || val_sz < meta->hlen ||
+          meta->info.lamports == 0 || memcmp(meta->info.owner, owner.uc, sizeof(fd_pubkey_t)) ||
+          !acct_filter_match(filters, filter_cnt, val, val_sz)) {
+        fd_scratch_pop();
+        continue;
+      }
+
+      if (out_cnt++ > 0)
+        fd_textstream_append(ts, ",", 1);
+      char pubkey_str[FD_BASE58_ENCODED_32_SZ];
+      fd_base58_encode_32(accts[i].uc, NULL, pubkey_str);
+      fd_textstream_sprintf(ts, "{\"pubkey\":\"%s\",\"account\":", pubkey_str);
+      const char * err = fd_account_to_json( ts, accts[i], enc, val, val_sz, off, len );
+      if( err ) {
+        fd_web_replier_error(replier, "%s", err);
+        return 0;
+      }
+      fd_textstream_append(ts, "}", 1);
+      fd_scratch_pop();
+    }
+
+    fd_textstream_sprintf(ts, "]},\"id\":%lu}" CRLF, ctx->call_id);
+    fd_web_replier_done(replier);
+  } FD_METHOD_SCRATCH_END;
   return 0;
 }
 
@@ -950,12 +1222,128 @@ method_getRecentPrioritizationFees(struct fd_web_replier* replier, struct json_v
   return 0;
 }
 
+#define FD_RPC_SIGNATURES_MAX (1000UL)
+
 // Implementation of the "getSignaturesForAddress" methods
+// curl http://localhost:8123 -X POST -H "Content-Type: application/json" -d '{"jsonrpc":"2.0","id":1,"method":"getSignaturesForAddress","params":["Vote111111111111111111111111111111111111111",{"limit":10}]}'
+
 static int
 method_getSignaturesForAddress(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx) {
-  (void)values;
-  (void)ctx;
-  fd_web_replier_error(replier, "getSignaturesForAddress is not implemented");
+  static const uint PATH[3] = {
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+    (JSON_TOKEN_LBRACKET<<16) | 0,
+    (JSON_TOKEN_STRING<<16)
+  };
+  ulong arg_sz = 0;
+  const void* arg = json_get_value(values, PATH, 3, &arg_sz);
+  if (arg == NULL) {
+    fd_web_replier_error(replier, "getSignaturesForAddress requires a string as first parameter");
+    return 0;
+  }
+  fd_pubkey_t addr;
+  if( fd_base58_decode_32((const char *)arg, addr.uc) == NULL ) {
+    fd_web_replier_error(replier, "invalid address %s", (const char*)arg);
+    return 0;
+  }
+
+  fd_blockstore_t * blockstore = ctx->global->blockstore;
+  if( fd_blockstore_sig_idx_query_attached( blockstore ) == NULL ) {
+    fd_web_replier_error(replier, "getSignaturesForAddress requires the blockstore signature index (replay tile blockstore_sig_index_lg_max)");
+    return 0;
+  }
+
+  static const uint LIMIT_PATH[4] = {
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+    (JSON_TOKEN_LBRACKET<<16) | 1,
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_LIMIT,
+    (JSON_TOKEN_INTEGER<<16)
+  };
+  ulong limit_sz = 0;
+  const void* limit_ptr = json_get_value(values, LIMIT_PATH, 4, &limit_sz);
+  ulong limit = FD_RPC_SIGNATURES_MAX;
+  if (limit_ptr != NULL) {
+    long limitn = *(long *)limit_ptr;
+    if (limitn < 1 || (ulong)limitn > FD_RPC_SIGNATURES_MAX) {
+      fd_web_replier_error(replier, "invalid limit %ld, must be between 1 and %lu", limitn, FD_RPC_SIGNATURES_MAX);
+      return 0;
+    }
+    limit = (ulong)limitn;
+  }
+
+  static const uint BEFORE_PATH[4] = {
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+    (JSON_TOKEN_LBRACKET<<16) | 1,
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_BEFORE,
+    (JSON_TOKEN_STRING<<16)
+  };
+  static const uint UNTIL_PATH[4] = {
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+    (JSON_TOKEN_LBRACKET<<16) | 1,
+    (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_UNTIL,
+    (JSON_TOKEN_STRING<<16)
+  };
+  uchar before[FD_ED25519_SIG_SZ];
+  uchar until[FD_ED25519_SIG_SZ];
+  ulong before_sz = 0;
+  const void* before_str = json_get_value(values, BEFORE_PATH, 4, &before_sz);
+  if (before_str != NULL && fd_base58_decode_64((const char *)before_str, before) == NULL) {
+    fd_web_replier_error(replier, "invalid signature %s", (const char*)before_str);
+    return 0;
+  }
+  ulong until_sz = 0;
+  const void* until_str = json_get_value(values, UNTIL_PATH, 4, &until_sz);
+  if (until_str != NULL && fd_base58_decode_64((const char *)until_str, until) == NULL) {
+    fd_web_replier_error(replier, "invalid signature %s", (const char*)until_str);
+    return 0;
+  }
+
+  fd_blockstore_sig_idx_res_t res[FD_RPC_SIGNATURES_MAX];
+  ulong res_cnt = fd_blockstore_sig_idx_query_volatile( blockstore, &addr,
+                                                        (before_str ? before : NULL),
+                                                        (until_str ? until : NULL),
+                                                        res, limit );
+
+  // Only rooted blocks are indexed, so every result is finalized. The
+  // status comes from the txn meta. A result without a readable meta
+  // (e.g. an archived slot) is still returned, with a null status, so
+  // that pages keep their length and no history is skipped.
+  fd_textstream_t * ts = fd_web_replier_textstream(replier);
+  fd_textstream_sprintf(ts, "{\"jsonrpc\":\"2.0\",\"result\":[");
+  for ( ulong i = 0; i < res_cnt; ++i ) {
+    char sig_str[FD_BASE58_ENCODED_64_SZ];
+    fd_base58_encode_64(res[i].sig, NULL, sig_str);
+    fd_textstream_sprintf(ts, "%s{\"signature\":\"%s\",\"slot\":%lu,\"err\":",
+                          (i==0 ? "" : ","), sig_str, res[i].slot);
+
+    uchar * txn_meta;
+    ulong txn_meta_sz;
+    int has_err = 0;
+    if (!fd_blockstore_txn_meta_query_volatile(blockstore, res[i].sig, fd_libc_alloc_virtual(), &txn_meta, &txn_meta_sz)) {
+      fd_solblock_TransactionStatusMeta txn_status = {0};
+      pb_istream_t stream = pb_istream_from_buffer( txn_meta, txn_meta_sz );
+      if (pb_decode( &stream, fd_solblock_TransactionStatusMeta_fields, &txn_status )) {
+        if (txn_status.has_err) {
+          fd_error_to_json(ts, txn_status.err.err->bytes, txn_status.err.err->size);
+          has_err = 1;
+        }
+      } else {
+        FD_LOG_WARNING(( "failed to decode txn status: %s", PB_GET_ERROR( &stream ) ));
+      }
+      pb_release( fd_solblock_TransactionStatusMeta_fields, &txn_status );
+      fd_valloc_free(fd_libc_alloc_virtual(), txn_meta);
+    }
+    if (!has_err)
+      fd_textstream_sprintf(ts, "null");
+
+    fd_block_map_t meta[1];
+    if (fd_blockstore_block_map_query_volatile(blockstore, res[i].slot, meta))
+      fd_textstream_sprintf(ts, ",\"memo\":null,\"blockTime\":null,\"confirmationStatus\":\"finalized\"}");
+    else
+      fd_textstream_sprintf(ts, ",\"memo\":null,\"blockTime\":%ld,\"confirmationStatus\":\"finalized\"}",
+                            meta->ts/(long)1e9);
+  }
+  fd_textstream_sprintf(ts, "],\"id\":%lu}" CRLF, ctx->call_id);
+  fd_web_replier_done(replier);
   return 0;
 }
 
@@ -1089,39 +1477,396 @@ method_getTokenAccountBalance(struct fd_web_replier* replier, struct json_values
   return 0;
 }
 
+/* Find the token account index maintained by the replay tile in the
+   funk workspace, NULL if the validator does not keep one. */
+
+static fd_acc_token_idx_t *
+get_token_idx( fd_rpc_ctx_t * ctx ) {
+  fd_rpc_global_ctx_t * glob = ctx->global;
+  if( glob->token_idx ) return glob->token_idx;
+  fd_wksp_t * wksp = fd_funk_wksp( glob->funk );
+  fd_wksp_tag_query_info_t info;
+  ulong tag = FD_ACC_TOKEN_IDX_MAGIC;
+  if( fd_wksp_tag_query( wksp, &tag, 1, &info, 1 ) > 0 ) {
+    glob->token_idx = fd_acc_token_idx_join( fd_wksp_laddr_fast( wksp, info.gaddr_lo ) );
+  }
+  return glob->token_idx;
+}
+
+/* Print a token amount with the given number of decimals as the
+   "amount", "decimals", "uiAmount" and "uiAmountString" fields of a
+   UiTokenAmount.  The decimal string is exact, trailing zeros are
+   trimmed. */
+
+static void
+token_amount_to_json( fd_textstream_t * ts, ulong amount, uint decimals ) {
+  char digits[64];
+  int  digits_sz = snprintf( digits, sizeof(digits), "%lu", amount );
+  char ui[ 64+256+2 ];
+  ulong ui_sz = 0;
+  if( (ulong)digits_sz > decimals ) {
+    ulong int_sz = (ulong)digits_sz - decimals;
+    fd_memcpy( ui, digits, int_sz );
+    ui_sz = int_sz;
+    ui[ui_sz++] = '.';
+    fd_memcpy( ui + ui_sz, digits + int_sz, decimals );
+    ui_sz += decimals;
+  } else {
+    ui[ui_sz++] = '0';
+    ui[ui_sz++] = '.';
+    for( ulong i = (ulong)digits_sz; i < decimals; ++i ) ui[ui_sz++] = '0';
+    fd_memcpy( ui + ui_sz, digits, (ulong)digits_sz );
+    ui_sz += (ulong)digits_sz;
+  }
+  while( ui[ui_sz-1] == '0' ) ui_sz--;
+  if( ui[ui_sz-1] == '.' ) ui_sz--;
+  ui[ui_sz] = '\0';
+  fd_textstream_sprintf(ts, "\"amount\":\"%s\",\"decimals\":%u,\"uiAmount\":%s,\"uiAmountString\":\"%s\"",
+                        digits, decimals, ui, ui);
+}
+
+/* Read a mint account, returns the mint data or NULL if the account is
+   not an initialized token mint */
+
+static uchar const *
+read_token_mint( fd_rpc_ctx_t * ctx, fd_pubkey_t * mint ) {
+  ulong val_sz;
+  uchar * val = read_account(ctx, mint, fd_scratch_virtual(), &val_sz);
+  if( val == NULL || val_sz < sizeof(fd_account_meta_t) ) return NULL;
+  fd_account_meta_t const * meta = (fd_account_meta_t const *)val;
+  if( val_sz < meta->hlen || val_sz - meta->hlen < meta->dlen ) return NULL;
+  if( meta->dlen < FD_TOKEN_MINT_SZ ) return NULL;
+  return fd_token_mint_data( meta );
+}
+
+/* Read a candidate token account from the index, returns the account
+   value or NULL if the account is not (or no longer) a token account
+   that has key of kind. */
+
+static uchar *
+read_token_account( fd_rpc_ctx_t * ctx, fd_pubkey_t * acct, ulong kind, fd_pubkey_t const * key, ulong * val_sz ) {
+  uchar * val = read_account(ctx, acct, fd_scratch_virtual(), val_sz);
+  if( val == NULL || *val_sz < sizeof(fd_account_meta_t) ) return NULL;
+  fd_account_meta_t const * meta = (fd_account_meta_t const *)val;
+  if( *val_sz < meta->hlen || *val_sz - meta->hlen < meta->dlen ) return NULL;
+  if( meta->info.lamports == 0 || meta->dlen < FD_TOKEN_ACCT_SZ ) return NULL;
+  uchar const * data = fd_token_acct_data( meta );
+  if( data == NULL ) return NULL;
+  fd_pubkey_t const * acct_key = fd_token_acct_key( data, kind );
+  if( acct_key == NULL || memcmp( acct_key, key, sizeof(fd_pubkey_t) ) ) return NULL;
+  return val;
+}
+
+#define FD_RPC_TOKEN_ACC_MAX     (1UL<<20)
+#define FD_RPC_TOKEN_LARGEST_MAX (20UL)
+
+/* Common implementation of getTokenAccountsByOwner and
+   getTokenAccountsByDelegate */
+
+static int
+token_accounts_by_key(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx, ulong kind, const char * method) {
+  FD_METHOD_SCRATCH_BEGIN( 64<<20 ) {
+    static const uint PATH[3] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 0,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong arg_sz = 0;
+    const void* arg = json_get_value(values, PATH, 3, &arg_sz);
+    if (arg == NULL) {
+      fd_web_replier_error(replier, "%s requires a string as first parameter", method);
+      return 0;
+    }
+    fd_pubkey_t key;
+    if( fd_base58_decode_32((const char *)arg, key.uc) == NULL ) {
+      fd_web_replier_error(replier, "invalid pubkey %s", (const char*)arg);
+      return 0;
+    }
+
+    // The second parameter selects either a mint or a token program
+    static const uint MINT_PATH[4] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 1,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_MINT,
+      (JSON_TOKEN_STRING<<16)
+    };
+    static const uint PROG_PATH[4] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 1,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PROGRAMID,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong mint_sz = 0;
+    const void* mint_str = json_get_value(values, MINT_PATH, 4, &mint_sz);
+    ulong prog_sz = 0;
+    const void* prog_str = json_get_value(values, PROG_PATH, 4, &prog_sz);
+    fd_pubkey_t mint;
+    fd_pubkey_t prog;
+    if (mint_str != NULL) {
+      if( fd_base58_decode_32((const char *)mint_str, mint.uc) == NULL ) {
+        fd_web_replier_error(replier, "invalid mint %s", (const char*)mint_str);
+        return 0;
+      }
+    } else if (prog_str != NULL) {
+      if( fd_base58_decode_32((const char *)prog_str, prog.uc) == NULL ||
+          !fd_token_program_is_owner(prog.uc) ) {
+        fd_web_replier_error(replier, "invalid token program id %s", (const char*)prog_str);
+        return 0;
+      }
+    } else {
+      fd_web_replier_error(replier, "%s requires a mint or programId as second parameter", method);
+      return 0;
+    }
+
+    fd_acc_token_idx_t * idx = get_token_idx(ctx);
+    if( idx == NULL ) {
+      fd_web_replier_error(replier, "%s requires the token account index (replay tile token_index_max)", method);
+      return 0;
+    }
+
+    static const uint ENC_PATH[4] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 2,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_ENCODING,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong enc_str_sz = 0;
+    const void* enc_str = json_get_value(values, ENC_PATH, 4, &enc_str_sz);
+    fd_rpc_encoding_t enc;
+    if (enc_str == NULL || MATCH_STRING(enc_str, enc_str_sz, "base58"))
+      enc = FD_ENC_BASE58;
+    else if (MATCH_STRING(enc_str, enc_str_sz, "base64"))
+      enc = FD_ENC_BASE64;
+    else if (MATCH_STRING(enc_str, enc_str_sz, "base64+zstd"))
+      enc = FD_ENC_BASE64_ZSTD;
+    else if (MATCH_STRING(enc_str, enc_str_sz, "jsonParsed"))
+      enc = FD_ENC_JSON;
+    else {
+      fd_web_replier_error(replier, "invalid data encoding %s", (const char*)enc_str);
+      return 0;
+    }
+
+    static const uint LEN_PATH[5] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 2,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_DATASLICE,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_LENGTH,
+      (JSON_TOKEN_INTEGER<<16)
+    };
+    static const uint OFF_PATH[5] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 2,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_DATASLICE,
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_OFFSET,
+      (JSON_TOKEN_INTEGER<<16)
+    };
+    ulong len_sz = 0;
+    const void* len_ptr = json_get_value(values, LEN_PATH, 5, &len_sz);
+    ulong off_sz = 0;
+    const void* off_ptr = json_get_value(values, OFF_PATH, 5, &off_sz);
+    long off = (off_ptr ? *(long *)off_ptr : FD_LONG_UNSET);
+    long len = (len_ptr ? *(long *)len_ptr : FD_LONG_UNSET);
+
+    // Collect the candidates from the index, then check each one
+    // against the current state of the funk
+    fd_funk_t * funk = ctx->global->funk;
+    ulong acct_max = FD_RPC_TOKEN_ACC_MAX;
+    fd_pubkey_t * accts = fd_scratch_alloc( alignof(fd_pubkey_t), acct_max * sizeof(fd_pubkey_t) );
+    ulong acct_cnt = fd_acc_token_idx_query_safe( idx, funk, kind, &key, accts, acct_max );
+    if (acct_cnt > acct_max) {
+      fd_web_replier_error(replier, "too many token accounts (%lu)", acct_cnt);
+      return 0;
+    }
+
+    fd_blockstore_t * blockstore = ctx->global->blockstore;
+    fd_textstream_t * ts = fd_web_replier_textstream(replier);
+    fd_textstream_sprintf(ts, "{\"jsonrpc\":\"2.0\",\"result\":{\"context\":{\"apiVersion\":\"" FIREDANCER_VERSION "\",\"slot\":%lu},\"value\":[",
+                          blockstore->smr);
+
+    ulong out_cnt = 0;
+    for ( ulong i = 0; i < acct_cnt; ++i ) {
+      fd_scratch_push();
+      ulong val_sz;
+      uchar * val = read_token_account(ctx, accts + i, kind, &key, &val_sz);
+      if (val == NULL) {
+        fd_scratch_pop();
+        continue;
+      }
+      fd_account_meta_t const * meta = (fd_account_meta_t const *)val;
+      uchar const * data = val + meta->hlen;
+      if ((mint_str != NULL && memcmp(data + FD_TOKEN_ACCT_MINT_OFF, mint.uc, sizeof(fd_pubkey_t))) ||
+          (mint_str == NULL && memcmp(meta->info.owner, prog.uc, sizeof(fd_pubkey_t)))) {
+        fd_scratch_pop();
+        continue;
+      }
+
+      if (out_cnt++ > 0)
+        fd_textstream_append(ts, ",", 1);
+      char pubkey_str[FD_BASE58_ENCODED_32_SZ];
+      fd_base58_encode_32(accts[i].uc, NULL, pubkey_str);
+      fd_textstream_sprintf(ts, "{\"pubkey\":\"%s\",\"account\":", pubkey_str);
+      const char * err = fd_account_to_json( ts, accts[i], enc, val, val_sz, off, len );
+      if( err ) {
+        fd_web_replier_error(replier, "%s", err);
+        return 0;
+      }
+      fd_textstream_append(ts, "}", 1);
+      fd_scratch_pop();
+    }
+
+    fd_textstream_sprintf(ts, "]},\"id\":%lu}" CRLF, ctx->call_id);
+    fd_web_replier_done(replier);
+  } FD_METHOD_SCRATCH_END;
+  return 0;
+}
+
 // Implementation of the "getTokenAccountsByDelegate" methods
+// curl http://localhost:8123 -X POST -H "Content-Type: application/json" -d '{"jsonrpc":"2.0","id":1,"method":"getTokenAccountsByDelegate","params":["4Nd1mBQtrMJVYVfKf2PJy9NZUZdTAsp7D4xWLs4gDB4T",{"programId":"TokenkegQfeZyiNwAJbNbGKPFXCWuBvf9Ss623VQ5DA"},{"encoding":"base64"}]}'
+
 static int
 method_getTokenAccountsByDelegate(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx) {
-  (void)values;
-  (void)ctx;
-  fd_web_replier_error(replier, "getTokenAccountsByDelegate is not implemented");
-  return 0;
+  return token_accounts_by_key(replier, values, ctx, FD_ACC_TOKEN_IDX_KIND_DELEGATE, "getTokenAccountsByDelegate");
 }
 
 // Implementation of the "getTokenAccountsByOwner" methods
+// curl http://localhost:8123 -X POST -H "Content-Type: application/json" -d '{"jsonrpc":"2.0","id":1,"method":"getTokenAccountsByOwner","params":["4Qkev8aNZcqFNSRhQzwyLMFSsi94jHqE8WNVTJzTP99F",{"mint":"3wyAj7Rt1TWVPZVteFJPLa26JmLvdb1CAKEFZm3NY75E"},{"encoding":"base64"}]}'
+
 static int
 method_getTokenAccountsByOwner(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx) {
-  (void)values;
-  (void)ctx;
-  fd_web_replier_error(replier, "getTokenAccountsByOwner is not implemented");
-  return 0;
+  return token_accounts_by_key(replier, values, ctx, FD_ACC_TOKEN_IDX_KIND_OWNER, "getTokenAccountsByOwner");
 }
 
+struct fd_rpc_token_balance {
+  fd_pubkey_t acct;
+  ulong       amount;
+};
+typedef struct fd_rpc_token_balance fd_rpc_token_balance_t;
+
 // Implementation of the "getTokenLargestAccounts" methods
+// curl http://localhost:8123 -X POST -H "Content-Type: application/json" -d '{"jsonrpc":"2.0","id":1,"method":"getTokenLargestAccounts","params":["3wyAj7Rt1TWVPZVteFJPLa26JmLvdb1CAKEFZm3NY75E"]}'
+
 static int
 method_getTokenLargestAccounts(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx) {
-  (void)values;
-  (void)ctx;
-  fd_web_replier_error(replier, "getTokenLargestAccounts is not implemented");
+  FD_METHOD_SCRATCH_BEGIN( 64<<20 ) {
+    static const uint PATH[3] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 0,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong arg_sz = 0;
+    const void* arg = json_get_value(values, PATH, 3, &arg_sz);
+    if (arg == NULL) {
+      fd_web_replier_error(replier, "getTokenLargestAccounts requires a string as first parameter");
+      return 0;
+    }
+    fd_pubkey_t mint;
+    if( fd_base58_decode_32((const char *)arg, mint.uc) == NULL ) {
+      fd_web_replier_error(replier, "invalid mint %s", (const char*)arg);
+      return 0;
+    }
+
+    fd_acc_token_idx_t * idx = get_token_idx(ctx);
+    if( idx == NULL ) {
+      fd_web_replier_error(replier, "getTokenLargestAccounts requires the token account index (replay tile token_index_max)");
+      return 0;
+    }
+
+    uchar const * mint_data = read_token_mint(ctx, &mint);
+    if( mint_data == NULL ) {
+      fd_web_replier_error(replier, "invalid param: not a token mint");
+      return 0;
+    }
+    uint decimals = fd_token_mint_decimals(mint_data);
+
+    fd_funk_t * funk = ctx->global->funk;
+    ulong acct_max = FD_RPC_TOKEN_ACC_MAX;
+    fd_pubkey_t * accts = fd_scratch_alloc( alignof(fd_pubkey_t), acct_max * sizeof(fd_pubkey_t) );
+    ulong acct_cnt = fd_acc_token_idx_query_safe( idx, funk, FD_ACC_TOKEN_IDX_KIND_MINT, &mint, accts, acct_max );
+    if (acct_cnt > acct_max) {
+      fd_web_replier_error(replier, "mint has too many token accounts (%lu)", acct_cnt);
+      return 0;
+    }
+
+    // Keep the largest balances in descending order by insertion
+    fd_rpc_token_balance_t top[FD_RPC_TOKEN_LARGEST_MAX];
+    ulong top_cnt = 0;
+    for ( ulong i = 0; i < acct_cnt; ++i ) {
+      fd_scratch_push();
+      ulong val_sz;
+      uchar * val = read_token_account(ctx, accts + i, FD_ACC_TOKEN_IDX_KIND_MINT, &mint, &val_sz);
+      if (val == NULL) {
+        fd_scratch_pop();
+        continue;
+      }
+      ulong amount = fd_token_acct_amount(val + ((fd_account_meta_t const *)val)->hlen);
+      fd_scratch_pop();
+
+      if (top_cnt == FD_RPC_TOKEN_LARGEST_MAX && amount <= top[top_cnt-1].amount)
+        continue;
+      ulong j = fd_ulong_min(top_cnt, FD_RPC_TOKEN_LARGEST_MAX-1);
+      while (j > 0 && top[j-1].amount < amount) {
+        top[j] = top[j-1];
+        j--;
+      }
+      top[j].acct   = accts[i];
+      top[j].amount = amount;
+      top_cnt = fd_ulong_min(top_cnt+1, FD_RPC_TOKEN_LARGEST_MAX);
+    }
+
+    fd_blockstore_t * blockstore = ctx->global->blockstore;
+    fd_textstream_t * ts = fd_web_replier_textstream(replier);
+    fd_textstream_sprintf(ts, "{\"jsonrpc\":\"2.0\",\"result\":{\"context\":{\"apiVersion\":\"" FIREDANCER_VERSION "\",\"slot\":%lu},\"value\":[",
+                          blockstore->smr);
+    for ( ulong i = 0; i < top_cnt; ++i ) {
+      char pubkey_str[FD_BASE58_ENCODED_32_SZ];
+      fd_base58_encode_32(top[i].acct.uc, NULL, pubkey_str);
+      fd_textstream_sprintf(ts, "%s{\"address\":\"%s\",", (i ? "," : ""), pubkey_str);
+      token_amount_to_json(ts, top[i].amount, decimals);
+      fd_textstream_append(ts, "}", 1);
+    }
+    fd_textstream_sprintf(ts, "]},\"id\":%lu}" CRLF, ctx->call_id);
+    fd_web_replier_done(replier);
+  } FD_METHOD_SCRATCH_END;
   return 0;
 }
 
 // Implementation of the "getTokenSupply" methods
+// curl http://localhost:8123 -X POST -H "Content-Type: application/json" -d '{"jsonrpc":"2.0","id":1,"method":"getTokenSupply","params":["3wyAj7Rt1TWVPZVteFJPLa26JmLvdb1CAKEFZm3NY75E"]}'
+
 static int
 method_getTokenSupply(struct fd_web_replier* replier, struct json_values* values, fd_rpc_ctx_t * ctx) {
-  (void)values;
-  (void)ctx;
-  fd_web_replier_error(replier, "getTokenSupply is not implemented");
+  FD_METHOD_SCRATCH_BEGIN( 11<<20 ) {
+    static const uint PATH[3] = {
+      (JSON_TOKEN_LBRACE<<16) | KEYW_JSON_PARAMS,
+      (JSON_TOKEN_LBRACKET<<16) | 0,
+      (JSON_TOKEN_STRING<<16)
+    };
+    ulong arg_sz = 0;
+    const void* arg = json_get_value(values, PATH, 3, &arg_sz);
+    if (arg == NULL) {
+      fd_web_replier_error(replier, "getTokenSupply requires a string as first parameter");
+      return 0;
+    }
+    fd_pubkey_t mint;
+    if( fd_base58_decode_32((const char *)arg, mint.uc) == NULL ) {
+      fd_web_replier_error(replier, "invalid mint %s", (const char*)arg);
+      return 0;
+    }
+
+    uchar const * mint_data = read_token_mint(ctx, &mint);
+    if( mint_data == NULL ) {
+      fd_web_replier_error(replier, "invalid param: not a token mint");
+      return 0;
+    }
+
+    fd_blockstore_t * blockstore = ctx->global->blockstore;
+    fd_textstream_t * ts = fd_web_replier_textstream(replier);
+    fd_textstream_sprintf(ts, "{\"jsonrpc\":\"2.0\",\"result\":{\"context\":{\"apiVersion\":\"" FIREDANCER_VERSION "\",\"slot\":%lu},\"value\":{",
+                          blockstore->smr);
+    token_amount_to_json(ts, fd_token_mint_supply(mint_data), fd_token_mint_decimals(mint_data));
+    fd_textstream_sprintf(ts, "}},\"id\":%lu}" CRLF, ctx->call_id);
+    fd_web_replier_done(replier);
+  } FD_METHOD_SCRATCH_END;
   return 0;
 }
 
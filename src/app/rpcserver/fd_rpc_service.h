@@ -3,7 +3,7 @@
 
 #include "../../util/fd_util.h"
 #include "../../funk/fd_funk.h"
-#include "../../flamenco/runtime/fd_blockstore.h"
+#include "../../flamenco/runtime/fd_blockstore_archive.h"
 #include "../../tango/mcache/fd_mcache.h"
 #include "../../util/textstream/fd_textstream.h"
 #include "../fdctl/run/tiles/fd_replay_notif.h"
@@ -291,6 +291,7 @@ int main(int argc, char** argv) {
     { "method", false, "KEYW_JSON_METHOD" },
     { "params", false, "KEYW_JSON_PARAMS" },
 
+    { "before", false, "KEYW_JSON_BEFORE" },
     { "bytes", false, "KEYW_JSON_BYTES" },
     { "commitment", false, "KEYW_JSON_COMMITMENT" },
     { "dataSize", false, "KEYW_JSON_DATASIZE" },
@@ -309,6 +310,7 @@ int main(int argc, char** argv) {
     { "rewards", false, "KEYW_JSON_REWARDS" },
     { "searchTransactionHistory", false, "KEYW_JSON_SEARCHTRANSACTIONHISTORY" },
     { "transactionDetails", false, "KEYW_JSON_TRANSACTIONDETAILS" },
+    { "until", false, "KEYW_JSON_UNTIL" },
     { "votePubkey", false, "KEYW_JSON_VOTEPUBKEY" },
 
     { "getAccountInfo", false, "KEYW_RPCMETHOD_GETACCOUNTINFO" },
@@ -29,10 +29,20 @@ long fd_webserver_json_keyword(const char* keyw, unsigned long keyw_sz) {
         return KEYW_JSON_LIMIT; // "limit"
       }
       break;
+    case 'u':
+      if (((*(unsigned long*)&keyw[1] & 0xFFFFFFFFUL) == 0x6C69746EUL)) {
+        return KEYW_JSON_UNTIL; // "until"
+      }
+      break;
     }
   break;
   case 6:
     switch (keyw[0]) {
+    case 'b':
+      if (((*(unsigned long*)&keyw[1] & 0xFFFFFFFFFFUL) == 0x65726F6665UL)) {
+        return KEYW_JSON_BEFORE; // "before"
+      }
+      break;
     case 'l':
       if (((*(unsigned long*)&keyw[1] & 0xFFFFFFFFFFUL) == 0x6874676E65UL)) {
         return KEYW_JSON_LENGTH; // "length"
@@ -723,6 +733,7 @@ const char* un_fd_webserver_json_keyword(long id) {
   case KEYW_JSON_ID: return "id";
   case KEYW_JSON_METHOD: return "method";
   case KEYW_JSON_PARAMS: return "params";
+  case KEYW_JSON_BEFORE: return "before";
   case KEYW_JSON_BYTES: return "bytes";
   case KEYW_JSON_COMMITMENT: return "commitment";
   case KEYW_JSON_DATASIZE: return "dataSize";
@@ -741,6 +752,7 @@ const char* un_fd_webserver_json_keyword(long id) {
   case KEYW_JSON_REWARDS: return "rewards";
   case KEYW_JSON_SEARCHTRANSACTIONHISTORY: return "searchTransactionHistory";
   case KEYW_JSON_TRANSACTIONDETAILS: return "transactionDetails";
+  case KEYW_JSON_UNTIL: return "until";
   case KEYW_JSON_VOTEPUBKEY: return "votePubkey";
   case KEYW_RPCMETHOD_GETACCOUNTINFO: return "getAccountInfo";
   case KEYW_RPCMETHOD_GETBALANCE: return "getBalance";
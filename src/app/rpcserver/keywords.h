@@ -3,106 +3,108 @@
 #define KEYW_JSON_ID 1L
 #define KEYW_JSON_METHOD 2L
 #define KEYW_JSON_PARAMS 3L
-#define KEYW_JSON_BYTES 4L
-#define KEYW_JSON_COMMITMENT 5L
-#define KEYW_JSON_DATASIZE 6L
-#define KEYW_JSON_DATASLICE 7L
-#define KEYW_JSON_ENCODING 8L
-#define KEYW_JSON_EPOCH 9L
-#define KEYW_JSON_FILTERS 10L
-#define KEYW_JSON_IDENTITY 11L
-#define KEYW_JSON_LENGTH 12L
-#define KEYW_JSON_LIMIT 13L
-#define KEYW_JSON_MAXSUPPORTEDTRANSACTIONVERSION 14L
-#define KEYW_JSON_MEMCMP 15L
-#define KEYW_JSON_MINT 16L
-#define KEYW_JSON_OFFSET 17L
-#define KEYW_JSON_PROGRAMID 18L
-#define KEYW_JSON_REWARDS 19L
-#define KEYW_JSON_SEARCHTRANSACTIONHISTORY 20L
-#define KEYW_JSON_TRANSACTIONDETAILS 21L
-#define KEYW_JSON_VOTEPUBKEY 22L
-#define KEYW_RPCMETHOD_GETACCOUNTINFO 23L
-#define KEYW_RPCMETHOD_GETBALANCE 24L
-#define KEYW_RPCMETHOD_GETBLOCK 25L
-#define KEYW_RPCMETHOD_GETBLOCKCOMMITMENT 26L
-#define KEYW_RPCMETHOD_GETBLOCKHEIGHT 27L
-#define KEYW_RPCMETHOD_GETBLOCKPRODUCTION 28L
-#define KEYW_RPCMETHOD_GETBLOCKS 29L
-#define KEYW_RPCMETHOD_GETBLOCKSWITHLIMIT 30L
-#define KEYW_RPCMETHOD_GETBLOCKTIME 31L
-#define KEYW_RPCMETHOD_GETCLUSTERNODES 32L
-#define KEYW_RPCMETHOD_GETCONFIRMEDBLOCK 33L
-#define KEYW_RPCMETHOD_GETCONFIRMEDBLOCKS 34L
-#define KEYW_RPCMETHOD_GETCONFIRMEDBLOCKSWITHLIMIT 35L
-#define KEYW_RPCMETHOD_GETCONFIRMEDSIGNATURESFORADDRESS2 36L
-#define KEYW_RPCMETHOD_GETCONFIRMEDTRANSACTION 37L
-#define KEYW_RPCMETHOD_GETEPOCHINFO 38L
-#define KEYW_RPCMETHOD_GETEPOCHSCHEDULE 39L
-#define KEYW_RPCMETHOD_GETFEECALCULATORFORBLOCKHASH 40L
-#define KEYW_RPCMETHOD_GETFEEFORMESSAGE 41L
-#define KEYW_RPCMETHOD_GETFEERATEGOVERNOR 42L
-#define KEYW_RPCMETHOD_GETFEES 43L
-#define KEYW_RPCMETHOD_GETFIRSTAVAILABLEBLOCK 44L
-#define KEYW_RPCMETHOD_GETGENESISHASH 45L
-#define KEYW_RPCMETHOD_GETHEALTH 46L
-#define KEYW_RPCMETHOD_GETHIGHESTSNAPSHOTSLOT 47L
-#define KEYW_RPCMETHOD_GETIDENTITY 48L
-#define KEYW_RPCMETHOD_GETINFLATIONGOVERNOR 49L
-#define KEYW_RPCMETHOD_GETINFLATIONRATE 50L
-#define KEYW_RPCMETHOD_GETINFLATIONREWARD 51L
-#define KEYW_RPCMETHOD_GETLARGESTACCOUNTS 52L
-#define KEYW_RPCMETHOD_GETLATESTBLOCKHASH 53L
-#define KEYW_RPCMETHOD_GETLEADERSCHEDULE 54L
-#define KEYW_RPCMETHOD_GETMAXRETRANSMITSLOT 55L
-#define KEYW_RPCMETHOD_GETMAXSHREDINSERTSLOT 56L
-#define KEYW_RPCMETHOD_GETMINIMUMBALANCEFORRENTEXEMPTION 57L
-#define KEYW_RPCMETHOD_GETMULTIPLEACCOUNTS 58L
-#define KEYW_RPCMETHOD_GETPROGRAMACCOUNTS 59L
-#define KEYW_RPCMETHOD_GETRECENTBLOCKHASH 60L
-#define KEYW_RPCMETHOD_GETRECENTPERFORMANCESAMPLES 61L
-#define KEYW_RPCMETHOD_GETRECENTPRIORITIZATIONFEES 62L
-#define KEYW_RPCMETHOD_GETSIGNATURESFORADDRESS 63L
-#define KEYW_RPCMETHOD_GETSIGNATURESTATUSES 64L
-#define KEYW_RPCMETHOD_GETSLOT 65L
-#define KEYW_RPCMETHOD_GETSLOTLEADER 66L
-#define KEYW_RPCMETHOD_GETSLOTLEADERS 67L
-#define KEYW_RPCMETHOD_GETSNAPSHOTSLOT 68L
-#define KEYW_RPCMETHOD_GETSTAKEACTIVATION 69L
-#define KEYW_RPCMETHOD_GETSTAKEMINIMUMDELEGATION 70L
-#define KEYW_RPCMETHOD_GETSUPPLY 71L
-#define KEYW_RPCMETHOD_GETTOKENACCOUNTBALANCE 72L
-#define KEYW_RPCMETHOD_GETTOKENACCOUNTSBYDELEGATE 73L
-#define KEYW_RPCMETHOD_GETTOKENACCOUNTSBYOWNER 74L
-#define KEYW_RPCMETHOD_GETTOKENLARGESTACCOUNTS 75L
-#define KEYW_RPCMETHOD_GETTOKENSUPPLY 76L
-#define KEYW_RPCMETHOD_GETTRANSACTION 77L
-#define KEYW_RPCMETHOD_GETTRANSACTIONCOUNT 78L
-#define KEYW_RPCMETHOD_GETVERSION 79L
-#define KEYW_RPCMETHOD_GETVOTEACCOUNTS 80L
-#define KEYW_RPCMETHOD_ISBLOCKHASHVALID 81L
-#define KEYW_RPCMETHOD_MINIMUMLEDGERSLOT 82L
-#define KEYW_RPCMETHOD_REQUESTAIRDROP 83L
-#define KEYW_RPCMETHOD_SENDTRANSACTION 84L
-#define KEYW_RPCMETHOD_SIMULATETRANSACTION 85L
-#define KEYW_WS_METHOD_ACCOUNTSUBSCRIBE 86L
-#define KEYW_WS_METHOD_ACCOUNTUNSUBSCRIBE 87L
-#define KEYW_WS_METHOD_BLOCKSUBSCRIBE 88L
-#define KEYW_WS_METHOD_BLOCKUNSUBSCRIBE 89L
-#define KEYW_WS_METHOD_LOGSSUBSCRIBE 90L
-#define KEYW_WS_METHOD_LOGSUNSUBSCRIBE 91L
-#define KEYW_WS_METHOD_PROGRAMSUBSCRIBE 92L
-#define KEYW_WS_METHOD_PROGRAMUNSUBSCRIBE 93L
-#define KEYW_WS_METHOD_ROOTSUBSCRIBE 94L
-#define KEYW_WS_METHOD_ROOTUNSUBSCRIBE 95L
-#define KEYW_WS_METHOD_SIGNATURESUBSCRIBE 96L
-#define KEYW_WS_METHOD_SIGNATUREUNSUBSCRIBE 97L
-#define KEYW_WS_METHOD_SLOTSUBSCRIBE 98L
-#define KEYW_WS_METHOD_SLOTUNSUBSCRIBE 99L
-#define KEYW_WS_METHOD_SLOTSUPDATESSUBSCRIBE 100L
-#define KEYW_WS_METHOD_SLOTSUPDATESUNSUBSCRIBE 101L
-#define KEYW_WS_METHOD_VOTESUBSCRIBE 102L
-#define KEYW_WS_METHOD_VOTEUNSUBSCRIBE 103L
+#define KEYW_JSON_BEFORE 4L
+#define KEYW_JSON_BYTES 5L
+#define KEYW_JSON_COMMITMENT 6L
+#define KEYW_JSON_DATASIZE 7L
+#define KEYW_JSON_DATASLICE 8L
+#define KEYW_JSON_ENCODING 9L
+#define KEYW_JSON_EPOCH 10L
+#define KEYW_JSON_FILTERS 11L
+#define KEYW_JSON_IDENTITY 12L
+#define KEYW_JSON_LENGTH 13L
+#define KEYW_JSON_LIMIT 14L
+#define KEYW_JSON_MAXSUPPORTEDTRANSACTIONVERSION 15L
+#define KEYW_JSON_MEMCMP 16L
+#define KEYW_JSON_MINT 17L
+#define KEYW_JSON_OFFSET 18L
+#define KEYW_JSON_PROGRAMID 19L
+#define KEYW_JSON_REWARDS 20L
+#define KEYW_JSON_SEARCHTRANSACTIONHISTORY 21L
+#define KEYW_JSON_TRANSACTIONDETAILS 22L
+#define KEYW_JSON_UNTIL 23L
+#define KEYW_JSON_VOTEPUBKEY 24L
+#define KEYW_RPCMETHOD_GETACCOUNTINFO 25L
+#define KEYW_RPCMETHOD_GETBALANCE 26L
+#define KEYW_RPCMETHOD_GETBLOCK 27L
+#define KEYW_RPCMETHOD_GETBLOCKCOMMITMENT 28L
+#define KEYW_RPCMETHOD_GETBLOCKHEIGHT 29L
+#define KEYW_RPCMETHOD_GETBLOCKPRODUCTION 30L
+#define KEYW_RPCMETHOD_GETBLOCKS 31L
+#define KEYW_RPCMETHOD_GETBLOCKSWITHLIMIT 32L
+#define KEYW_RPCMETHOD_GETBLOCKTIME 33L
+#define KEYW_RPCMETHOD_GETCLUSTERNODES 34L
+#define KEYW_RPCMETHOD_GETCONFIRMEDBLOCK 35L
+#define KEYW_RPCMETHOD_GETCONFIRMEDBLOCKS 36L
+#define KEYW_RPCMETHOD_GETCONFIRMEDBLOCKSWITHLIMIT 37L
+#define KEYW_RPCMETHOD_GETCONFIRMEDSIGNATURESFORADDRESS2 38L
+#define KEYW_RPCMETHOD_GETCONFIRMEDTRANSACTION 39L
+#define KEYW_RPCMETHOD_GETEPOCHINFO 40L
+#define KEYW_RPCMETHOD_GETEPOCHSCHEDULE 41L
+#define KEYW_RPCMETHOD_GETFEECALCULATORFORBLOCKHASH 42L
+#define KEYW_RPCMETHOD_GETFEEFORMESSAGE 43L
+#define KEYW_RPCMETHOD_GETFEERATEGOVERNOR 44L
+#define KEYW_RPCMETHOD_GETFEES 45L
+#define KEYW_RPCMETHOD_GETFIRSTAVAILABLEBLOCK 46L
+#define KEYW_RPCMETHOD_GETGENESISHASH 47L
+#define KEYW_RPCMETHOD_GETHEALTH 48L
+#define KEYW_RPCMETHOD_GETHIGHESTSNAPSHOTSLOT 49L
+#define KEYW_RPCMETHOD_GETIDENTITY 50L
+#define KEYW_RPCMETHOD_GETINFLATIONGOVERNOR 51L
+#define KEYW_RPCMETHOD_GETINFLATIONRATE 52L
+#define KEYW_RPCMETHOD_GETINFLATIONREWARD 53L
+#define KEYW_RPCMETHOD_GETLARGESTACCOUNTS 54L
+#define KEYW_RPCMETHOD_GETLATESTBLOCKHASH 55L
+#define KEYW_RPCMETHOD_GETLEADERSCHEDULE 56L
+#define KEYW_RPCMETHOD_GETMAXRETRANSMITSLOT 57L
+#define KEYW_RPCMETHOD_GETMAXSHREDINSERTSLOT 58L
+#define KEYW_RPCMETHOD_GETMINIMUMBALANCEFORRENTEXEMPTION 59L
+#define KEYW_RPCMETHOD_GETMULTIPLEACCOUNTS 60L
+#define KEYW_RPCMETHOD_GETPROGRAMACCOUNTS 61L
+#define KEYW_RPCMETHOD_GETRECENTBLOCKHASH 62L
+#define KEYW_RPCMETHOD_GETRECENTPERFORMANCESAMPLES 63L
+#define KEYW_RPCMETHOD_GETRECENTPRIORITIZATIONFEES 64L
+#define KEYW_RPCMETHOD_GETSIGNATURESFORADDRESS 65L
+#define KEYW_RPCMETHOD_GETSIGNATURESTATUSES 66L
+#define KEYW_RPCMETHOD_GETSLOT 67L
+#define KEYW_RPCMETHOD_GETSLOTLEADER 68L
+#define KEYW_RPCMETHOD_GETSLOTLEADERS 69L
+#define KEYW_RPCMETHOD_GETSNAPSHOTSLOT 70L
+#define KEYW_RPCMETHOD_GETSTAKEACTIVATION 71L
+#define KEYW_RPCMETHOD_GETSTAKEMINIMUMDELEGATION 72L
+#define KEYW_RPCMETHOD_GETSUPPLY 73L
+#define KEYW_RPCMETHOD_GETTOKENACCOUNTBALANCE 74L
+#define KEYW_RPCMETHOD_GETTOKENACCOUNTSBYDELEGATE 75L
+#define KEYW_RPCMETHOD_GETTOKENACCOUNTSBYOWNER 76L
+#define KEYW_RPCMETHOD_GETTOKENLARGESTACCOUNTS 77L
+#define KEYW_RPCMETHOD_GETTOKENSUPPLY 78L
+#define KEYW_RPCMETHOD_GETTRANSACTION 79L
+#define KEYW_RPCMETHOD_GETTRANSACTIONCOUNT 80L
+#define KEYW_RPCMETHOD_GETVERSION 81L
+#define KEYW_RPCMETHOD_GETVOTEACCOUNTS 82L
+#define KEYW_RPCMETHOD_ISBLOCKHASHVALID 83L
+#define KEYW_RPCMETHOD_MINIMUMLEDGERSLOT 84L
+#define KEYW_RPCMETHOD_REQUESTAIRDROP 85L
+#define KEYW_RPCMETHOD_SENDTRANSACTION 86L
+#define KEYW_RPCMETHOD_SIMULATETRANSACTION 87L
+#define KEYW_WS_METHOD_ACCOUNTSUBSCRIBE 88L
+#define KEYW_WS_METHOD_ACCOUNTUNSUBSCRIBE 89L
+#define KEYW_WS_METHOD_BLOCKSUBSCRIBE 90L
+#define KEYW_WS_METHOD_BLOCKUNSUBSCRIBE 91L
+#define KEYW_WS_METHOD_LOGSSUBSCRIBE 92L
+#define KEYW_WS_METHOD_LOGSUNSUBSCRIBE 93L
+#define KEYW_WS_METHOD_PROGRAMSUBSCRIBE 94L
+#define KEYW_WS_METHOD_PROGRAMUNSUBSCRIBE 95L
+#define KEYW_WS_METHOD_ROOTSUBSCRIBE 96L
+#define KEYW_WS_METHOD_ROOTUNSUBSCRIBE 97L
+#define KEYW_WS_METHOD_SIGNATURESUBSCRIBE 98L
+#define KEYW_WS_METHOD_SIGNATUREUNSUBSCRIBE 99L
+#define KEYW_WS_METHOD_SLOTSUBSCRIBE 100L
+#define KEYW_WS_METHOD_SLOTUNSUBSCRIBE 101L
+#define KEYW_WS_METHOD_SLOTSUPDATESSUBSCRIBE 102L
+#define KEYW_WS_METHOD_SLOTSUPDATESUNSUBSCRIBE 103L
+#define KEYW_WS_METHOD_VOTESUBSCRIBE 104L
+#define KEYW_WS_METHOD_VOTEUNSUBSCRIBE 105L
 #ifndef KEYW_UNKNOWN
 #define KEYW_UNKNOWN -1L
 #endif
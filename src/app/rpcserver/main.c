@@ -11,6 +11,7 @@ static void usage( char const * progname ) {
   fprintf( stderr, "fd_rpcserver usage: %s\n", progname );
   fprintf( stderr, " --wksp-name-funk <workspace name>          funk workspace name\n" );
   fprintf( stderr, " --wksp-name-blockstore <workspace name>    blockstore workspace name\n" );
+  fprintf( stderr, " --blockstore-archive <path>                blockstore archive file (optional)\n" );
   fprintf( stderr, " --wksp-name-replay-notify <workspace name> replay notification workspace name\n" );
   fprintf( stderr, " --num-threads <count>                      number of http service threads\n" );
   fprintf( stderr, " --port <port number>                       http service port\n" );
@@ -54,6 +55,15 @@ init_args( int * argc, char *** argv, fd_rpcserver_args_t * args ) {
                   args->blockstore->min, args->blockstore->smr, args->blockstore->max ));
   fd_wksp_mprotect( wksp, 1 );
 
+  char const * archive_path = fd_env_strip_cmdline_cstr ( argc, argv, "--blockstore-archive", NULL, NULL );
+  if( archive_path ) {
+    static fd_blockstore_archive_t archive[1];
+    if( FD_UNLIKELY( !fd_blockstore_archive_open( archive, archive_path, 0, 0UL, 0UL, 0UL ) ) )
+      FD_LOG_ERR(( "failed to open blockstore archive \"%s\"", archive_path ));
+    if( FD_UNLIKELY( fd_blockstore_archive_attach( args->blockstore, archive ) ) )
+      FD_LOG_ERR(( "failed to attach blockstore archive" ));
+  }
+
   wksp_name = fd_env_strip_cmdline_cstr ( argc, argv, "--wksp-name-replay-notify", NULL, "fd1_replay_notif.wksp" );
   FD_LOG_NOTICE(( "attaching to workspace \"%s\"", wksp_name ));
   args->rep_notify_wksp = wksp = fd_wksp_attach( wksp_name );
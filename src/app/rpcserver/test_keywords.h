@@ -32,6 +32,15 @@ void test_fd_webserver_json_keyword(void) {
   assert(fd_webserver_json_keyword("par|ms\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("para|s\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("param|\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("before\0\0\0\0\0\0\0", 6) == KEYW_JSON_BEFORE);
+  assert(fd_webserver_json_keyword("beforex\0\0\0\0\0\0\0", 7) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("befor\0\0\0\0\0\0\0", 5) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("|efore\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("b|fore\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("be|ore\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("bef|re\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("befo|e\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("befor|\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("bytes\0\0\0\0\0\0\0", 5) == KEYW_JSON_BYTES);
   assert(fd_webserver_json_keyword("bytesx\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("byte\0\0\0\0\0\0\0", 4) == KEYW_UNKNOWN);
@@ -261,6 +270,14 @@ void test_fd_webserver_json_keyword(void) {
   assert(fd_webserver_json_keyword("transactionDeta|ls\0\0\0\0\0\0\0", 18) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("transactionDetai|s\0\0\0\0\0\0\0", 18) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("transactionDetail|\0\0\0\0\0\0\0", 18) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("until\0\0\0\0\0\0\0", 5) == KEYW_JSON_UNTIL);
+  assert(fd_webserver_json_keyword("untilx\0\0\0\0\0\0\0", 6) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("unti\0\0\0\0\0\0\0", 4) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("|ntil\0\0\0\0\0\0\0", 5) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("u|til\0\0\0\0\0\0\0", 5) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("un|il\0\0\0\0\0\0\0", 5) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("unt|l\0\0\0\0\0\0\0", 5) == KEYW_UNKNOWN);
+  assert(fd_webserver_json_keyword("unti|\0\0\0\0\0\0\0", 5) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("votePubkey\0\0\0\0\0\0\0", 10) == KEYW_JSON_VOTEPUBKEY);
   assert(fd_webserver_json_keyword("votePubkeyx\0\0\0\0\0\0\0", 11) == KEYW_UNKNOWN);
   assert(fd_webserver_json_keyword("votePubke\0\0\0\0\0\0\0", 9) == KEYW_UNKNOWN);
@@ -16,10 +16,9 @@
 
    ### Optimization Notes
 
-   Currently supports 'all-in-one' API only, wherein the entire plain-
-   text is encrypted/decrypted in a single blocking call.  API may
-   change in the future to support a batched 'multi block' API or
-   streaming mode of operation.
+   Supports an 'all-in-one' API, wherein the entire plaintext is
+   encrypted/decrypted in a single blocking call, and a batched
+   decryption API for many short independent messages (see below).
 
    AES-GCM offers opportunity for processing of multiple AES blocks in
    parallel.  However, the computation of the auth tag is a sequential
@@ -104,6 +103,58 @@ fd_aes_gcm_aead_decrypt( fd_aes_gcm_t * aes_gcm,
                          ulong          aad_sz,
                          uchar const    tag[ static 16 ] );
 
+/* Batched API ********************************************************/
+
+/* fd_aes_gcm_batch_msg_t describes one AES-128-GCM message of a batch.
+   Unlike fd_aes_gcm_t, it holds the raw key instead of an expanded key
+   schedule.  Key expansion and derivation of the hash key are done as
+   part of the batch, such that messages with different keys (e.g. QUIC
+   packets of different connections) can be processed together without
+   per-message setup.  p may alias c (in-place decryption). */
+
+struct fd_aes_gcm_batch_msg {
+  uchar const * key;    /* 16 byte AES-128 key */
+  uchar const * iv;     /* 12 byte initialization vector */
+  uchar const * aad;    /* associated data */
+  ulong         aad_sz;
+  uchar const * c;      /* ciphertext */
+  uchar *       p;      /* plaintext */
+  ulong         sz;     /* size of c and p */
+  uchar const * tag;    /* 16 byte expected auth tag */
+};
+
+typedef struct fd_aes_gcm_batch_msg fd_aes_gcm_batch_msg_t;
+
+/* FD_AES_GCM_BATCH_MAX is the max number of messages of a batch. */
+
+#define FD_AES_GCM_BATCH_MAX (64UL)
+
+/* fd_aes_128_gcm_aead_decrypt_batch decrypts and authenticates the
+   msg_cnt messages in msg[0,msg_cnt) (msg_cnt in [0,FD_AES_GCM_BATCH_MAX]).
+   Returns a bit mask where bit i is set if message i authenticated
+   (equivalent to fd_aes_gcm_aead_decrypt returning 1).  The plaintext
+   of messages that failed authentication is undefined.
+
+   On targets with VAES and VPCLMULQDQ (AVX-512), messages are processed
+   four at a time, one per 128-bit lane.  This is most efficient for
+   batches of short messages of similar size.  Otherwise, messages are
+   processed one by one. */
+
+ulong
+fd_aes_128_gcm_aead_decrypt_batch( fd_aes_gcm_batch_msg_t const * msg,
+                                   ulong                          msg_cnt );
+
+/* fd_aes_128_encrypt_batch encrypts the 16 byte blocks in[i] with the
+   16 byte AES-128 keys key[i] and writes the results to out[i] for i in
+   [0,cnt).  This is the single block AES-ECB primitive used by QUIC
+   header protection. */
+
+void
+fd_aes_128_encrypt_batch( uchar const * const * key,
+                          uchar const * const * in,
+                          uchar * const *       out,
+                          ulong                 cnt );
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_ballet_aes_fd_aes_gcm_h */
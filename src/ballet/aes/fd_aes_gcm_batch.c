@@ -0,0 +1,63 @@
+#include "fd_aes_gcm.h"
+
+#if FD_AES_GCM_BATCH_VAES
+
+ulong
+fd_aes_128_gcm_aead_decrypt_x4_avx512( fd_aes_gcm_batch_msg_t const * msg,
+                                       ulong                          msg_cnt );
+
+void
+fd_aes_128_encrypt_x4_avx512( uchar const * const * key,
+                              uchar const * const * in,
+                              uchar * const *       out,
+                              ulong                 cnt );
+
+ulong
+fd_aes_128_gcm_aead_decrypt_batch( fd_aes_gcm_batch_msg_t const * msg,
+                                   ulong                          msg_cnt ) {
+  ulong ok = 0UL;
+  for( ulong i=0UL; i<msg_cnt; i+=4UL ) {
+    ulong cnt = fd_ulong_min( msg_cnt-i, 4UL );
+    ok |= fd_aes_128_gcm_aead_decrypt_x4_avx512( msg+i, cnt ) << i;
+  }
+  return ok;
+}
+
+void
+fd_aes_128_encrypt_batch( uchar const * const * key,
+                          uchar const * const * in,
+                          uchar * const *       out,
+                          ulong                 cnt ) {
+  for( ulong i=0UL; i<cnt; i+=4UL ) {
+    fd_aes_128_encrypt_x4_avx512( key+i, in+i, out+i, fd_ulong_min( cnt-i, 4UL ) );
+  }
+}
+
+#else /* Portable: one message at a time */
+
+ulong
+fd_aes_128_gcm_aead_decrypt_batch( fd_aes_gcm_batch_msg_t const * msg,
+                                   ulong                          msg_cnt ) {
+  ulong ok = 0UL;
+  fd_aes_gcm_t gcm[1];
+  for( ulong i=0UL; i<msg_cnt; i++ ) {
+    fd_aes_128_gcm_init( gcm, msg[i].key, msg[i].iv );
+    int res = fd_aes_gcm_aead_decrypt( gcm, msg[i].c, msg[i].p, msg[i].sz, msg[i].aad, msg[i].aad_sz, msg[i].tag );
+    ok |= (ulong)(!!res) << i;
+  }
+  return ok;
+}
+
+void
+fd_aes_128_encrypt_batch( uchar const * const * key,
+                          uchar const * const * in,
+                          uchar * const *       out,
+                          ulong                 cnt ) {
+  fd_aes_key_t ks[1];
+  for( ulong i=0UL; i<cnt; i++ ) {
+    fd_aes_set_encrypt_key( key[i], 128UL, ks );
+    fd_aes_encrypt( in[i], out[i], ks );
+  }
+}
+
+#endif /* FD_AES_GCM_BATCH_VAES */
@@ -0,0 +1,272 @@
+#include "fd_aes_gcm.h"
+
+#if FD_AES_GCM_BATCH_VAES
+
+#include "../../util/simd/fd_avx512.h"
+
+/* 4-wide AES-128-GCM kernels.  Each 128-bit lane of a zmm register
+   carries the state of an independent message (own key, IV, AAD and
+   ciphertext).  The key schedule and hash key are derived in-lane, so
+   no per-message setup is required.
+
+   GHASH is computed in the byte-reflected domain, following the
+   carry-less multiplication and reduction of Intel's "Carry-Less
+   Multiplication Instruction and its Usage for Computing the GCM Mode"
+   (Gueron, Kounavis 2010, Algorithm 5).  Messages are processed one
+   block at a time; lanes that ran out of data are masked off. */
+
+FD_STATIC_ASSERT( FD_AES_GCM_BATCH_MAX%4UL==0UL, compat );
+
+ulong
+fd_aes_128_gcm_aead_decrypt_x4_avx512( fd_aes_gcm_batch_msg_t const * msg,
+                                       ulong                          msg_cnt );
+
+void
+fd_aes_128_encrypt_x4_avx512( uchar const * const * key,
+                              uchar const * const * in,
+                              uchar * const *       out,
+                              ulong                 cnt );
+
+static uchar const fd_aes_gcm_batch_zero[ 16 ] __attribute__((aligned(16))) = {0};
+
+/* Lane load/store helpers.  sz in [0,16].  Bytes outside of [0,sz) are
+   not accessed (masked loads suppress faults). */
+
+static inline __m512i
+fd_aes_x4_insert( __m512i       v,
+                  ulong         lane,
+                  uchar const * p,
+                  ulong         sz ) {
+  __m128i x = _mm_maskz_loadu_epi8( (__mmask16)((1UL<<sz)-1UL), p );
+  switch( lane ) {
+  case 0UL: return _mm512_inserti32x4( v, x, 0 );
+  case 1UL: return _mm512_inserti32x4( v, x, 1 );
+  case 2UL: return _mm512_inserti32x4( v, x, 2 );
+  default:  return _mm512_inserti32x4( v, x, 3 );
+  }
+}
+
+static inline void
+fd_aes_x4_extract( uchar * p,
+                   ulong   sz,
+                   __m512i v,
+                   ulong   lane ) {
+  __m128i x;
+  switch( lane ) {
+  case 0UL: x = _mm512_extracti32x4_epi32( v, 0 ); break;
+  case 1UL: x = _mm512_extracti32x4_epi32( v, 1 ); break;
+  case 2UL: x = _mm512_extracti32x4_epi32( v, 2 ); break;
+  default:  x = _mm512_extracti32x4_epi32( v, 3 ); break;
+  }
+  _mm_mask_storeu_epi8( p, (__mmask16)((1UL<<sz)-1UL), x );
+}
+
+/* fd_aes_x4_expand_key derives the AES-128 round keys of each lane. */
+
+#define FD_AES_X4_EXPAND( i, rcon ) do {                                   \
+    __m512i k = rk[ (i)-1 ];                                               \
+    __m512i t = _mm512_shuffle_epi8( k, _mm512_set1_epi32( 0x0c0f0e0d ) ); \
+    t = _mm512_aesenclast_epi128( t, _mm512_set1_epi32( (rcon) ) );        \
+    __m512i s = _mm512_bslli_epi128( k, 4 );                               \
+    k = _mm512_xor_si512( k, s ); s = _mm512_bslli_epi128( s, 4 );         \
+    k = _mm512_xor_si512( k, s ); s = _mm512_bslli_epi128( s, 4 );         \
+    k = _mm512_xor_si512( k, s );                                          \
+    rk[ (i) ] = _mm512_xor_si512( k, t );                                  \
+  } while(0)
+
+static inline void
+fd_aes_x4_expand_key( __m512i rk[ 11 ],
+                      __m512i key ) {
+  rk[0] = key;
+  FD_AES_X4_EXPAND(  1, 0x01 );
+  FD_AES_X4_EXPAND(  2, 0x02 );
+  FD_AES_X4_EXPAND(  3, 0x04 );
+  FD_AES_X4_EXPAND(  4, 0x08 );
+  FD_AES_X4_EXPAND(  5, 0x10 );
+  FD_AES_X4_EXPAND(  6, 0x20 );
+  FD_AES_X4_EXPAND(  7, 0x40 );
+  FD_AES_X4_EXPAND(  8, 0x80 );
+  FD_AES_X4_EXPAND(  9, 0x1b );
+  FD_AES_X4_EXPAND( 10, 0x36 );
+}
+
+#undef FD_AES_X4_EXPAND
+
+static inline __m512i
+fd_aes_x4_encrypt( __m512i const rk[ 11 ],
+                   __m512i       x ) {
+  x = _mm512_xor_si512( x, rk[0] );
+  for( ulong r=1UL; r<10UL; r++ ) x = _mm512_aesenc_epi128( x, rk[r] );
+  return _mm512_aesenclast_epi128( x, rk[10] );
+}
+
+/* fd_aes_x4_gfmul multiplies a and b in GF(2^128) (byte-reflected). */
+
+static inline __m512i
+fd_aes_x4_gfmul( __m512i a,
+                 __m512i b ) {
+  __m512i t3 = _mm512_clmulepi64_epi128( a, b, 0x00 );
+  __m512i t4 = _mm512_clmulepi64_epi128( a, b, 0x10 );
+  __m512i t5 = _mm512_clmulepi64_epi128( a, b, 0x01 );
+  __m512i t6 = _mm512_clmulepi64_epi128( a, b, 0x11 );
+
+  t4 = _mm512_xor_si512( t4, t5 );
+  t5 = _mm512_bslli_epi128( t4, 8 );
+  t4 = _mm512_bsrli_epi128( t4, 8 );
+  t3 = _mm512_xor_si512( t3, t5 );
+  t6 = _mm512_xor_si512( t6, t4 );
+
+  /* Shift the 256-bit product t6:t3 left by one */
+
+  __m512i t7 = _mm512_srli_epi32( t3, 31 );
+  __m512i t8 = _mm512_srli_epi32( t6, 31 );
+  t3 = _mm512_slli_epi32( t3, 1 );
+  t6 = _mm512_slli_epi32( t6, 1 );
+  __m512i t9 = _mm512_bsrli_epi128( t7, 12 );
+  t8 = _mm512_bslli_epi128( t8, 4 );
+  t7 = _mm512_bslli_epi128( t7, 4 );
+  t3 = _mm512_or_si512( t3, t7 );
+  t6 = _mm512_or_si512( t6, t8 );
+  t6 = _mm512_or_si512( t6, t9 );
+
+  /* Reduce modulo x^128 + x^7 + x^2 + x + 1 */
+
+  t7 = _mm512_slli_epi32( t3, 31 );
+  t8 = _mm512_slli_epi32( t3, 30 );
+  t9 = _mm512_slli_epi32( t3, 25 );
+  t7 = _mm512_ternarylogic_epi32( t7, t8, t9, 0x96 );
+  t8 = _mm512_bsrli_epi128( t7, 4 );
+  t7 = _mm512_bslli_epi128( t7, 12 );
+  t3 = _mm512_xor_si512( t3, t7 );
+
+  __m512i t2 = _mm512_srli_epi32( t3, 1 );
+  t4 = _mm512_srli_epi32( t3, 2 );
+  t5 = _mm512_srli_epi32( t3, 7 );
+  t2 = _mm512_ternarylogic_epi32( t2, t4, t5, 0x96 );
+  t2 = _mm512_xor_si512( t2, t8 );
+  t3 = _mm512_xor_si512( t3, t2 );
+  return _mm512_xor_si512( t6, t3 );
+}
+
+ulong
+fd_aes_128_gcm_aead_decrypt_x4_avx512( fd_aes_gcm_batch_msg_t const * msg,
+                                       ulong                          msg_cnt ) {
+
+  __m512i const bswap = _mm512_broadcast_i32x4( _mm_set_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15 ) );
+
+  /* Gather keys and IVs.  Unused lanes use an all-zero key, IV and
+     empty message. */
+
+  uchar const * aad   [4]; ulong aad_sz[4];
+  uchar const * c     [4]; uchar *     p[4]; ulong sz[4];
+  ulong aad_blk_cnt = 0UL;
+  ulong blk_cnt     = 0UL;
+
+  __m512i key = _mm512_setzero_si512();
+  __m512i j0  = _mm512_setzero_si512();
+  for( ulong l=0UL; l<4UL; l++ ) {
+    if( l<msg_cnt ) {
+      key = fd_aes_x4_insert( key, l, msg[l].key, 16UL );
+      j0  = fd_aes_x4_insert( j0,  l, msg[l].iv,  12UL );
+      aad[l] = msg[l].aad; aad_sz[l] = msg[l].aad_sz;
+      c  [l] = msg[l].c;   p     [l] = msg[l].p;      sz[l] = msg[l].sz;
+    } else {
+      aad[l] = fd_aes_gcm_batch_zero; aad_sz[l] = 0UL;
+      c  [l] = fd_aes_gcm_batch_zero; p     [l] = NULL; sz[l] = 0UL;
+    }
+    aad_blk_cnt = fd_ulong_max( aad_blk_cnt, (aad_sz[l]+15UL)>>4 );
+    blk_cnt     = fd_ulong_max( blk_cnt,     (sz    [l]+15UL)>>4 );
+  }
+
+  __m512i rk[ 11 ];
+  fd_aes_x4_expand_key( rk, key );
+
+  /* Hash key H = E(K,0^128) and pre-counter block J0 = IV || 1 */
+
+  __m512i h   = _mm512_shuffle_epi8( fd_aes_x4_encrypt( rk, _mm512_setzero_si512() ), bswap );
+  __m512i ctr = _mm512_mask_set1_epi32( j0, 0x8888, (int)fd_uint_bswap( 1U ) );
+  __m512i ek0 = fd_aes_x4_encrypt( rk, ctr );
+  __m512i x   = _mm512_setzero_si512();
+
+  /* Associated data */
+
+  for( ulong b=0UL; b<aad_blk_cnt; b++ ) {
+    ulong     off    = b<<4;
+    __m512i   blk    = _mm512_setzero_si512();
+    __mmask8  active = 0;
+    for( ulong l=0UL; l<4UL; l++ ) {
+      if( off<aad_sz[l] ) {
+        blk     = fd_aes_x4_insert( blk, l, aad[l]+off, fd_ulong_min( aad_sz[l]-off, 16UL ) );
+        active |= (__mmask8)( 3U<<(2*l) );
+      }
+    }
+    blk = _mm512_xor_si512( x, _mm512_shuffle_epi8( blk, bswap ) );
+    x   = _mm512_mask_mov_epi64( x, active, fd_aes_x4_gfmul( blk, h ) );
+  }
+
+  /* Ciphertext.  Counter blocks are IV || be32(b+2). */
+
+  for( ulong b=0UL; b<blk_cnt; b++ ) {
+    ulong     off    = b<<4;
+    __m512i   blk    = _mm512_setzero_si512();
+    __mmask8  active = 0;
+    for( ulong l=0UL; l<4UL; l++ ) {
+      if( off<sz[l] ) {
+        blk     = fd_aes_x4_insert( blk, l, c[l]+off, fd_ulong_min( sz[l]-off, 16UL ) );
+        active |= (__mmask8)( 3U<<(2*l) );
+      }
+    }
+
+    ctr = _mm512_mask_set1_epi32( j0, 0x8888, (int)fd_uint_bswap( (uint)b+2U ) );
+    __m512i ks = fd_aes_x4_encrypt( rk, ctr );
+    __m512i pt = _mm512_xor_si512( blk, ks );
+    for( ulong l=0UL; l<4UL; l++ ) {
+      if( off<sz[l] ) fd_aes_x4_extract( p[l]+off, fd_ulong_min( sz[l]-off, 16UL ), pt, l );
+    }
+
+    blk = _mm512_xor_si512( x, _mm512_shuffle_epi8( blk, bswap ) );
+    x   = _mm512_mask_mov_epi64( x, active, fd_aes_x4_gfmul( blk, h ) );
+  }
+
+  /* Length block (bit lengths, reflected: lo qword is the ciphertext
+     length, hi qword is the AAD length) */
+
+  __m512i len = _mm512_set_epi64( (long)(aad_sz[3]<<3), (long)(sz[3]<<3),
+                                  (long)(aad_sz[2]<<3), (long)(sz[2]<<3),
+                                  (long)(aad_sz[1]<<3), (long)(sz[1]<<3),
+                                  (long)(aad_sz[0]<<3), (long)(sz[0]<<3) );
+  x = fd_aes_x4_gfmul( _mm512_xor_si512( x, len ), h );
+
+  __m512i tag = _mm512_xor_si512( _mm512_shuffle_epi8( x, bswap ), ek0 );
+
+  /* Compare auth tags */
+
+  __m512i expected = _mm512_setzero_si512();
+  for( ulong l=0UL; l<msg_cnt; l++ ) expected = fd_aes_x4_insert( expected, l, msg[l].tag, 16UL );
+  uint eq = (uint)_mm512_cmpeq_epi64_mask( tag, expected );
+
+  ulong ok = 0UL;
+  for( ulong l=0UL; l<msg_cnt; l++ ) ok |= (ulong)( ((eq>>(2*l))&3U)==3U ) << l;
+  return ok;
+}
+
+void
+fd_aes_128_encrypt_x4_avx512( uchar const * const * key,
+                              uchar const * const * in,
+                              uchar * const *       out,
+                              ulong                 cnt ) {
+  __m512i k = _mm512_setzero_si512();
+  __m512i x = _mm512_setzero_si512();
+  for( ulong l=0UL; l<cnt; l++ ) {
+    k = fd_aes_x4_insert( k, l, key[l], 16UL );
+    x = fd_aes_x4_insert( x, l, in [l], 16UL );
+  }
+
+  __m512i rk[ 11 ];
+  fd_aes_x4_expand_key( rk, k );
+  x = fd_aes_x4_encrypt( rk, x );
+
+  for( ulong l=0UL; l<cnt; l++ ) fd_aes_x4_extract( out[l], 16UL, x, l );
+}
+
+#endif /* FD_AES_GCM_BATCH_VAES */
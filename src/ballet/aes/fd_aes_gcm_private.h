@@ -109,6 +109,18 @@ fd_aesni_gcm_decrypt_private(
 
 #endif /* FD_HAS_AESNI */
 
+/* AES-GCM batch: AVX-512 VAES and VPCLMULQDQ (4x 128-bit lanes) *****/
+
+/* FD_AES_GCM_BATCH_VAES is 1 if fd_aes_128_gcm_aead_decrypt_batch uses
+   the 4-wide VAES kernels.  There is no separate build flag for these
+   extensions, so detect them via the compiler target. */
+
+#if FD_HAS_AVX512 && defined(__VAES__) && defined(__VPCLMULQDQ__)
+#define FD_AES_GCM_BATCH_VAES 1
+#else
+#define FD_AES_GCM_BATCH_VAES 0
+#endif
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_ballet_aes_fd_aes_gcm_private_h */
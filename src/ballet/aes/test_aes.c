@@ -483,6 +483,99 @@ test_aes_128_gcm_unroll( void ) {
   }
 }
 
+/* AES-GCM batch tests ************************************************/
+
+/* test_aes_128_gcm_batch checks that batched decryption matches the
+   single message API for messages with different keys and sizes. */
+
+static void
+test_aes_128_gcm_batch( fd_rng_t * rng ) {
+
+# define MSG_SZ_MAX (1500UL)
+# define AAD_SZ_MAX (  64UL)
+
+  static uchar key [ FD_AES_GCM_BATCH_MAX ][ 16 ];
+  static uchar iv  [ FD_AES_GCM_BATCH_MAX ][ 12 ];
+  static uchar aad [ FD_AES_GCM_BATCH_MAX ][ AAD_SZ_MAX ];
+  static uchar pt  [ FD_AES_GCM_BATCH_MAX ][ MSG_SZ_MAX ];
+  static uchar ct  [ FD_AES_GCM_BATCH_MAX ][ MSG_SZ_MAX ];
+  static uchar out [ FD_AES_GCM_BATCH_MAX ][ MSG_SZ_MAX ];
+  static uchar tag [ FD_AES_GCM_BATCH_MAX ][ 16 ];
+  fd_aes_gcm_batch_msg_t msg[ FD_AES_GCM_BATCH_MAX ];
+
+  for( ulong iter=0UL; iter<1024UL; iter++ ) {
+    ulong cnt    = fd_rng_ulong_roll( rng, FD_AES_GCM_BATCH_MAX+1UL );
+    ulong sz_max = (iter&1UL) ? MSG_SZ_MAX : 64UL;
+    ulong expect = 0UL;
+
+    for( ulong i=0UL; i<cnt; i++ ) {
+      ulong sz     = fd_rng_ulong_roll( rng, sz_max+1UL );
+      ulong aad_sz = fd_rng_ulong_roll( rng, AAD_SZ_MAX+1UL );
+      for( ulong j=0UL; j<16UL;   j++ ) key[i][j] = fd_rng_uchar( rng );
+      for( ulong j=0UL; j<12UL;   j++ ) iv [i][j] = fd_rng_uchar( rng );
+      for( ulong j=0UL; j<aad_sz; j++ ) aad[i][j] = fd_rng_uchar( rng );
+      for( ulong j=0UL; j<sz;     j++ ) pt [i][j] = fd_rng_uchar( rng );
+
+      fd_aes_gcm_t gcm[1];
+      fd_aes_128_gcm_init( gcm, key[i], iv[i] );
+      fd_aes_gcm_aead_encrypt( gcm, ct[i], pt[i], sz, aad[i], aad_sz, tag[i] );
+
+      /* Corrupt every 8th message */
+      int corrupt = fd_rng_uint_roll( rng, 8U )==0U;
+      if( corrupt ) {
+        switch( fd_rng_uint_roll( rng, 3U ) ) {
+        case 0U: tag[i][ fd_rng_uint_roll( rng, 16U ) ] ^= (uchar)( 1U<<fd_rng_uint_roll( rng, 8U ) ); break;
+        case 1U: if( sz     ) { ct [i][ fd_rng_ulong_roll( rng, sz     ) ] ^= 1; break; } tag[i][0] ^= 1; break;
+        case 2U: if( aad_sz ) { aad[i][ fd_rng_ulong_roll( rng, aad_sz ) ] ^= 1; break; } tag[i][0] ^= 1; break;
+        }
+      }
+      expect |= (ulong)(!corrupt) << i;
+
+      /* Decrypt in-place for odd messages */
+      if( i&1UL ) memcpy( out[i], ct[i], sz );
+      msg[i] = (fd_aes_gcm_batch_msg_t) {
+        .key = key[i], .iv = iv[i], .aad = aad[i], .aad_sz = aad_sz,
+        .c   = (i&1UL) ? out[i] : ct[i], .p = out[i], .sz = sz, .tag = tag[i]
+      };
+    }
+
+    ulong ok = fd_aes_128_gcm_aead_decrypt_batch( msg, cnt );
+    if( FD_UNLIKELY( ok!=expect ) )
+      FD_LOG_ERR(( "FAIL: AES-128-GCM batch auth (iter %lu cnt %lu got %016lx exp %016lx)", iter, cnt, ok, expect ));
+    for( ulong i=0UL; i<cnt; i++ ) {
+      if( !( (ok>>i)&1UL ) ) continue;
+      if( FD_UNLIKELY( 0!=memcmp( out[i], pt[i], msg[i].sz ) ) )
+        FD_LOG_ERR(( "FAIL: AES-128-GCM batch decrypt (iter %lu msg %lu sz %lu)", iter, i, msg[i].sz ));
+    }
+  }
+
+  /* Single block encrypt (QUIC header protection) */
+
+  uchar const * key_p[ FD_AES_GCM_BATCH_MAX ];
+  uchar const * in_p [ FD_AES_GCM_BATCH_MAX ];
+  uchar *       out_p[ FD_AES_GCM_BATCH_MAX ];
+  for( ulong i=0UL; i<FD_AES_GCM_BATCH_MAX; i++ ) {
+    for( ulong j=0UL; j<16UL; j++ ) { key[i][j] = fd_rng_uchar( rng ); pt[i][j] = fd_rng_uchar( rng ); }
+    key_p[i] = key[i]; in_p[i] = pt[i]; out_p[i] = out[i];
+  }
+  for( ulong cnt=0UL; cnt<=FD_AES_GCM_BATCH_MAX; cnt++ ) {
+    fd_aes_128_encrypt_batch( key_p, in_p, out_p, cnt );
+    for( ulong i=0UL; i<cnt; i++ ) {
+      fd_aes_key_t ks[1];
+      uchar        expected[ 16 ];
+      fd_aes_set_encrypt_key( key[i], 128UL, ks );
+      fd_aes_encrypt( pt[i], expected, ks );
+      if( FD_UNLIKELY( 0!=memcmp( out[i], expected, 16UL ) ) )
+        FD_LOG_ERR(( "FAIL: AES-128 batch encrypt (cnt %lu idx %lu)", cnt, i ));
+    }
+  }
+
+# undef AAD_SZ_MAX
+# undef MSG_SZ_MAX
+
+  FD_LOG_NOTICE(( "OK: AES-128-GCM batch (%s)", FD_AES_GCM_BATCH_VAES ? "VAES" : "portable" ));
+}
+
 /* Main ***************************************************************/
 
 int
@@ -498,6 +591,10 @@ main( int     argc,
   //test_aes_128_gcm();
   test_aes_128_gcm_unroll();
 
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+  test_aes_128_gcm_batch( rng );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
   FD_LOG_NOTICE(( "pass" ));
   fd_halt();
   return 0;
@@ -16,6 +16,15 @@
 /* FD_ED25519_SIG_SZ: the size of an Ed25519 signature in bytes. */
 #define FD_ED25519_SIG_SZ (64UL)
 
+/* FD_ED25519_VERIFY_BATCH_MAX: the max number of signatures verified
+   by a single call to fd_ed25519_verify_batch_multi_msg. */
+#define FD_ED25519_VERIFY_BATCH_MAX (16UL)
+
+/* FD_ED25519_VERIFY_BATCH_MSG_MAX: messages up to this size are hashed
+   lane-parallel by fd_ed25519_verify_batch_multi_msg.  Covers Solana
+   transactions (1232 byte MTU). */
+#define FD_ED25519_VERIFY_BATCH_MSG_MAX (1280UL)
+
 /* An Ed25519 signature. */
 typedef uchar fd_ed25519_sig_t[ FD_ED25519_SIG_SZ ];
 
@@ -129,6 +138,39 @@ fd_ed25519_verify_batch_single_msg( uchar const   msg[], /* msg_sz */
                                     fd_sha512_t * shas[ 1 ],               /* batch_sz */
                                     uchar const   batch_sz );
 
+/* fd_ed25519_verify_batch_multi_msg verifies a batch of independent
+   signatures, each over its own message with its own public key,
+   according to the ED25519 standard.  Unlike
+   fd_ed25519_verify_batch_single_msg, all signatures are verified and
+   the result of each one is reported.
+
+   msgs[i] points to the first byte of the msg_szs[i] byte message of
+   signature i.  sigs[i] points to the 64-byte signature i.  pubkeys[i]
+   points to the 32-byte public key of signature i.  On return, res[i]
+   holds the result of fd_ed25519_verify for signature i.  batch_sz is
+   in [1,FD_ED25519_VERIFY_BATCH_MAX] (otherwise returns
+   FD_ED25519_ERR_SIG and res is not written).
+
+   The signature hashes are computed across the batch with the
+   lane-parallel SHA-512 implementation (see fd_sha512_batch_t).  Each
+   signature is then checked with the same equation as
+   fd_ed25519_verify (in particular, no cofactored random linear
+   combination is used, which would accept signatures that
+   fd_ed25519_verify rejects).
+
+   Returns FD_ED25519_SUCCESS if all signatures are valid, otherwise
+   the first non-success entry of res.  Uses about
+   FD_ED25519_VERIFY_BATCH_MAX*(64+FD_ED25519_VERIFY_BATCH_MSG_MAX)
+   bytes of stack. */
+
+int
+fd_ed25519_verify_batch_multi_msg( uchar const * const msgs   [], /* batch_sz */
+                                   ulong const         msg_szs[], /* batch_sz */
+                                   uchar const * const sigs   [], /* batch_sz, 64 bytes each */
+                                   uchar const * const pubkeys[], /* batch_sz, 32 bytes each */
+                                   int                 res    [], /* batch_sz */
+                                   ulong               batch_sz );
+
 /* fd_ed25519_strerror converts an FD_ED25519_SUCCESS / FD_ED25519_ERR_*
    code into a human readable cstr.  The lifetime of the returned
    pointer is infinite.  The returned pointer is always to a non-NULL
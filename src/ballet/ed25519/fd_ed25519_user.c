@@ -309,6 +309,95 @@ int fd_ed25519_verify_batch_single_msg( uchar const   msg[], /* msg_sz */
 #undef MAX
 }
 
+int
+fd_ed25519_verify_batch_multi_msg( uchar const * const msgs   [], /* batch_sz */
+                                   ulong const         msg_szs[], /* batch_sz */
+                                   uchar const * const sigs   [], /* batch_sz, 64 bytes each */
+                                   uchar const * const pubkeys[], /* batch_sz, 32 bytes each */
+                                   int                 res    [], /* batch_sz */
+                                   ulong               batch_sz ) {
+#define MAX FD_ED25519_VERIFY_BATCH_MAX
+  if( FD_UNLIKELY( batch_sz==0UL || batch_sz>MAX ) ) {
+    return FD_ED25519_ERR_SIG;
+  }
+
+  fd_ed25519_point_t R     [MAX];
+  fd_ed25519_point_t Aprime[MAX];
+  uchar              k     [MAX][64];
+
+  /* Hash preimages R || A || M.  The batched SHA-512 API takes a
+     single contiguous buffer per message. */
+  uchar              pre   [MAX][64UL+FD_ED25519_VERIFY_BATCH_MSG_MAX];
+
+  fd_sha512_batch_t  batch_mem[1];
+  fd_sha512_batch_t * batch = fd_sha512_batch_init( batch_mem );
+  fd_sha512_t        sha_mem[1];
+  fd_sha512_t *      sha = NULL;
+
+  /* Validate scalars, decompress public keys and points R_j, check low
+     order points, and queue the k_j hashes.  Same checks as
+     fd_ed25519_verify. */
+
+  for( ulong j=0UL; j<batch_sz; j++ ) {
+    uchar const * r          = sigs[j];
+    uchar const * S          = sigs[j] + 32;
+    uchar const * public_key = pubkeys[j];
+
+    res[j] = FD_ED25519_SUCCESS;
+
+    if( FD_UNLIKELY( !fd_curve25519_scalar_validate( S ) ) ) {
+      res[j] = FD_ED25519_ERR_SIG;
+      continue;
+    }
+
+    int err = fd_ed25519_point_frombytes_2x( &Aprime[j], public_key, &R[j], r );
+    if( FD_UNLIKELY( err ) ) {
+      res[j] = err==1 ? FD_ED25519_ERR_PUBKEY : FD_ED25519_ERR_SIG;
+      continue;
+    }
+    if( FD_UNLIKELY( fd_ed25519_affine_is_small_order( &Aprime[j] ) ) ) {
+      res[j] = FD_ED25519_ERR_PUBKEY;
+      continue;
+    }
+    if( FD_UNLIKELY( fd_ed25519_affine_is_small_order( &R[j] ) ) ) {
+      res[j] = FD_ED25519_ERR_SIG;
+      continue;
+    }
+
+    ulong msg_sz = msg_szs[j];
+    if( FD_LIKELY( msg_sz<=FD_ED25519_VERIFY_BATCH_MSG_MAX ) ) {
+      fd_memcpy( pre[j],      r,          32UL   );
+      fd_memcpy( pre[j]+32UL, public_key, 32UL   );
+      fd_memcpy( pre[j]+64UL, msgs[j],    msg_sz );
+      fd_sha512_batch_add( batch, pre[j], 64UL+msg_sz, k[j] );
+    } else {
+      if( FD_UNLIKELY( !sha ) ) sha = fd_sha512_join( fd_sha512_new( sha_mem ) );
+      fd_sha512_fini( fd_sha512_append( fd_sha512_append( fd_sha512_append( fd_sha512_init( sha ),
+                      r, 32UL ), public_key, 32UL ), msgs[j], msg_sz ), k[j] );
+    }
+  }
+  fd_sha512_batch_fini( batch );
+  if( sha ) fd_sha512_delete( fd_sha512_leave( sha ) );
+
+  /* Check the group equation of each signature */
+
+  int ret = FD_ED25519_SUCCESS;
+  for( ulong j=0UL; j<batch_sz; j++ ) {
+    if( FD_LIKELY( res[j]==FD_ED25519_SUCCESS ) ) {
+      uchar const * S = sigs[j] + 32;
+      fd_curve25519_scalar_reduce( k[j], k[j] );
+
+      fd_ed25519_point_t Rcmp[1];
+      fd_ed25519_point_neg( &Aprime[j], &Aprime[j] );
+      fd_ed25519_double_scalar_mul_base( Rcmp, k[j], &Aprime[j], S );
+      if( FD_UNLIKELY( !fd_ed25519_point_eq_z1( Rcmp, &R[j] ) ) ) res[j] = FD_ED25519_ERR_MSG;
+    }
+    if( FD_UNLIKELY( (res[j]!=FD_ED25519_SUCCESS) & (ret==FD_ED25519_SUCCESS) ) ) ret = res[j];
+  }
+  return ret;
+#undef MAX
+}
+
 char const *
 fd_ed25519_strerror( int err ) {
   switch( err ) {
@@ -1069,6 +1069,80 @@ test_verify( fd_rng_t *    rng,
   }
 }
 
+void
+test_verify_batch_multi_msg( fd_rng_t *    rng,
+                             fd_sha512_t * sha ) {
+# define BATCH_MAX FD_ED25519_VERIFY_BATCH_MAX
+  static uchar  msg[ BATCH_MAX ][ 1536 ];
+  ulong         msg_sz [ BATCH_MAX ];
+  uchar         pub    [ BATCH_MAX ][ 32 ];
+  uchar         sig    [ BATCH_MAX ][ 64 ];
+  uchar const * msgs   [ BATCH_MAX ];
+  uchar const * pubs   [ BATCH_MAX ];
+  uchar const * sigs   [ BATCH_MAX ];
+  int           res    [ BATCH_MAX ];
+
+  for( ulong j=0UL; j<BATCH_MAX; j++ ) { msgs[j] = msg[j]; pubs[j] = pub[j]; sigs[j] = sig[j]; }
+
+  /* Compare against fd_ed25519_verify, including messages too large
+     for lane-parallel hashing and corrupted signatures */
+
+  for( ulong rem=200UL; rem; rem-- ) {
+    ulong batch_sz = 1UL + fd_rng_ulong_roll( rng, BATCH_MAX );
+    for( ulong j=0UL; j<batch_sz; j++ ) {
+      uchar prv[ 32 ];
+      msg_sz[j] = fd_rng_ulong_roll( rng, 1537UL );
+      for( ulong b=0UL; b<msg_sz[j]; b++ ) msg[j][b] = fd_rng_uchar( rng );
+      fd_ed25519_public_from_private( pub[j], fd_rng_b256( rng, prv ), sha );
+      fd_ed25519_sign( sig[j], msg[j], msg_sz[j], pub[j], prv, sha );
+
+      uint r = fd_rng_uint( rng );
+      if( !(r & 7U) ) { ulong idx = fd_rng_ulong_roll( rng, 512UL ); sig[j][ idx>>3 ] ^= (uchar)( 1U<<(idx&7UL) ); } r >>= 3;
+      if( !(r & 7U) ) { ulong idx = fd_rng_ulong_roll( rng, 256UL ); pub[j][ idx>>3 ] ^= (uchar)( 1U<<(idx&7UL) ); } r >>= 3;
+      if( !(r & 7U) && msg_sz[j] ) { msg[j][ fd_rng_ulong_roll( rng, msg_sz[j] ) ]++; }
+    }
+
+    int ret = fd_ed25519_verify_batch_multi_msg( msgs, msg_sz, sigs, pubs, res, batch_sz );
+    int exp_ret = FD_ED25519_SUCCESS;
+    for( ulong j=0UL; j<batch_sz; j++ ) {
+      int exp = fd_ed25519_verify( msg[j], msg_sz[j], sig[j], pub[j], sha );
+      FD_TEST( res[j]==exp );
+      if( exp_ret==FD_ED25519_SUCCESS ) exp_ret = exp;
+    }
+    FD_TEST( ret==exp_ret );
+  }
+
+  FD_TEST( fd_ed25519_verify_batch_multi_msg( msgs, msg_sz, sigs, pubs, res, 0UL           )==FD_ED25519_ERR_SIG );
+  FD_TEST( fd_ed25519_verify_batch_multi_msg( msgs, msg_sz, sigs, pubs, res, BATCH_MAX+1UL )==FD_ED25519_ERR_SIG );
+
+  /* Bench: transaction sized messages, one signature each */
+
+  for( ulong j=0UL; j<BATCH_MAX; j++ ) {
+    uchar prv[ 32 ];
+    msg_sz[j] = 1100UL;
+    for( ulong b=0UL; b<msg_sz[j]; b++ ) msg[j][b] = fd_rng_uchar( rng );
+    fd_ed25519_public_from_private( pub[j], fd_rng_b256( rng, prv ), sha );
+    fd_ed25519_sign( sig[j], msg[j], msg_sz[j], pub[j], prv, sha );
+  }
+
+  uchar const ** _msgs = msgs;
+  uchar const ** _sigs = sigs;
+  uchar const ** _pubs = pubs;
+  ulong iter = 1000UL;
+  for( ulong batch_sz=1UL; batch_sz<=BATCH_MAX; batch_sz<<=1 ) {
+    FD_TEST( fd_ed25519_verify_batch_multi_msg( msgs, msg_sz, sigs, pubs, res, batch_sz )==FD_ED25519_SUCCESS );
+    long dt = fd_log_wallclock();
+    for( ulong rem=iter; rem; rem-- ) {
+      FD_COMPILER_FORGET( _msgs ); FD_COMPILER_FORGET( _sigs ); FD_COMPILER_FORGET( _pubs );
+      fd_ed25519_verify_batch_multi_msg( _msgs, msg_sz, _sigs, _pubs, res, batch_sz );
+    }
+    dt = fd_log_wallclock() - dt;
+    char cstr[128];
+    log_bench( fd_cstr_printf( cstr, 128UL, NULL, "fd_..._verify_batch_multi_msg(1100 / %lu)", batch_sz ), iter*batch_sz, dt );
+  }
+# undef BATCH_MAX
+}
+
 void
 test_wycheproofs( fd_sha512_t * sha ) {
   char cstr[128];
@@ -1176,6 +1250,7 @@ main( int     argc,
   test_public_from_private( rng, sha );
   test_sign               ( rng, sha );
   test_verify             ( rng, sha );
+  test_verify_batch_multi_msg( rng, sha );
 
   test_wycheproofs( sha );
   test_cctv       ( sha );
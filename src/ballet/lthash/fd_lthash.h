@@ -8,6 +8,12 @@
 #include "../fd_ballet_base.h"
 #include "../blake3/fd_blake3.h"
 
+#if FD_HAS_AVX512
+#include "../../util/simd/fd_avx512.h"
+#elif FD_HAS_AVX
+#include "../../util/simd/fd_avx.h"
+#endif
+
 #define FD_LTHASH_ALIGN     (FD_BLAKE3_ALIGN)
 #define FD_LTHASH_LEN_BYTES (2048UL)
 #define FD_LTHASH_LEN_ELEMS (1024UL)
@@ -36,21 +42,43 @@ fd_lthash_zero( fd_lthash_value_t * r ) {
   return fd_memset( r->bytes, 0, FD_LTHASH_LEN_BYTES );
 }
 
+/* fd_lthash_{add,sub} do r = r +/- a in place, word by word (mod
+   2^16), and return r.  These are the hot loop of full-state lthash
+   accumulation so they use the widest vectors available.  Unaligned
+   accesses are used as callers commonly pun lthash bytes stored in
+   other structures (e.g. the slot bank) as values. */
+
 static inline fd_lthash_value_t *
 fd_lthash_add( fd_lthash_value_t * restrict       r,
                fd_lthash_value_t const * restrict a ) {
+# if FD_HAS_AVX512
+  for( ulong i=0UL; i<FD_LTHASH_LEN_BYTES; i+=64UL )
+    _mm512_storeu_si512( r->bytes+i, _mm512_add_epi16( _mm512_loadu_si512( r->bytes+i ), _mm512_loadu_si512( a->bytes+i ) ) );
+# elif FD_HAS_AVX
+  for( ulong i=0UL; i<FD_LTHASH_LEN_BYTES; i+=32UL )
+    wb_stu( r->bytes+i, _mm256_add_epi16( wb_ldu( r->bytes+i ), wb_ldu( a->bytes+i ) ) );
+# else
   for ( ulong i=0; i<FD_LTHASH_LEN_ELEMS; i++ ) {
     r->words[i] = (ushort)( r->words[i] + a->words[i] );
   }
+# endif
   return r;
 }
 
 static inline fd_lthash_value_t *
 fd_lthash_sub( fd_lthash_value_t * restrict       r,
                fd_lthash_value_t const * restrict a ) {
+# if FD_HAS_AVX512
+  for( ulong i=0UL; i<FD_LTHASH_LEN_BYTES; i+=64UL )
+    _mm512_storeu_si512( r->bytes+i, _mm512_sub_epi16( _mm512_loadu_si512( r->bytes+i ), _mm512_loadu_si512( a->bytes+i ) ) );
+# elif FD_HAS_AVX
+  for( ulong i=0UL; i<FD_LTHASH_LEN_BYTES; i+=32UL )
+    wb_stu( r->bytes+i, _mm256_sub_epi16( wb_ldu( r->bytes+i ), wb_ldu( a->bytes+i ) ) );
+# else
   for ( ulong i=0; i<FD_LTHASH_LEN_ELEMS; i++ ) {
     r->words[i] = (ushort)( r->words[i] - a->words[i] );
   }
+# endif
   return r;
 }
 
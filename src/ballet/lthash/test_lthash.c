@@ -204,6 +204,22 @@ main( int     argc,
     FD_LOG_ERR(( "FAIL fd_lthash_zero()" ));
   }
 
+  // random add/sub against a scalar reference
+  for( ulong iter=0UL; iter<1000UL; iter++ ) {
+    for( ulong i=0; i<1024; i++ ) {
+      value->words[i] = fd_rng_ushort( rng );
+      tmp->words[i]   = fd_rng_ushort( rng );
+    }
+    int sub = (int)(fd_rng_uint( rng ) & 1U);
+    for( ulong i=0; i<1024; i++ ) {
+      compute_extected[i] = sub ? (ushort)( value->words[i] - tmp->words[i] ) : (ushort)( value->words[i] + tmp->words[i] );
+    }
+    FD_TEST( ( sub ? fd_lthash_sub( value, tmp ) : fd_lthash_add( value, tmp ) )==value );
+    if( FD_UNLIKELY( memcmp( value, compute_extected, 2048 ) ) ) {
+      FD_LOG_ERR(( "FAIL random lthash %s", sub ? "sub" : "add" ));
+    }
+  }
+
   fd_rng_delete( fd_rng_leave( rng ) );
   FD_LOG_NOTICE(( "pass" ));
   fd_halt();
@@ -86,6 +86,17 @@ fd_zstd_peek( fd_zstd_peek_t * peek,
               void const *     buf,
               ulong            bufsz );
 
+/* fd_zstd_frame_sz returns the compressed size of the frame starting
+   at buf (including frame header and checksum).  [buf,buf+bufsz) must
+   contain the entire frame.  Skippable frames are supported.  Only
+   reads the frame and block headers, which makes it suitable for
+   splitting a multi-frame stream into frames before decompressing them
+   independently.  Returns 0UL if the frame is malformed or truncated. */
+
+ulong
+fd_zstd_frame_sz( void const * buf,
+                  ulong        bufsz );
+
 /* fd_zstd_dstream_{align,footprint} return the parameters of the
    memory region backing a fd_zstd_dstream_t.  max_window_sz is the
    largest window size that this object is able to handle. */
@@ -154,6 +165,91 @@ fd_zstd_dstream_read( fd_zstd_dstream_t *     dstream,
 
 FD_PROTOTYPES_END
 
+/* Compress API *******************************************************/
+
+/* fd_zstd_cstream_t provides streaming compression into Zstandard
+   frames.  Produces one frame at a time.  Independently compressed
+   frames can be concatenated into a valid Zstandard stream, which
+   allows for compressing a stream in parallel. */
+
+struct fd_zstd_cstream;
+typedef struct fd_zstd_cstream fd_zstd_cstream_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_zstd_cstream_{align,footprint} return the parameters of the
+   memory region backing a fd_zstd_cstream_t.  level is the Zstandard
+   compression level (e.g. 3 is the libzstd default). */
+
+FD_FN_CONST ulong
+fd_zstd_cstream_align( void );
+
+FD_FN_CONST ulong
+fd_zstd_cstream_footprint( int level );
+
+/* fd_zstd_cstream_new creates a new cstream object backed by the memory
+   region at mem.  mem matches align/footprint requirements for the
+   given level.  Returns a handle to the newly created cstream object on
+   success (not just a simple cast of mem).  The cstream is ready to
+   start a new frame on return.  On failure, returns NULL. */
+
+fd_zstd_cstream_t *
+fd_zstd_cstream_new( void * mem,
+                     int    level );
+
+/* fd_zstd_cstream_delete destroys the cstream object and releases its
+   memory region back to the caller.  Returns pointer to memory region
+   on success (same as provided in call to new).  Acts as a no-op if
+   cstream==NULL. */
+
+void *
+fd_zstd_cstream_delete( fd_zstd_cstream_t * cstream );
+
+/* fd_zstd_cstream_reset discards the current frame (if any), such that
+   the next compress call starts a new frame. */
+
+void
+fd_zstd_cstream_reset( fd_zstd_cstream_t * cstream );
+
+/* fd_zstd_cstream_compress compresses a fragment of uncompressed data
+   into the current frame (starting a new frame if none is in
+   progress).
+
+   *in_p points to the next byte of uncompressed data, in_end points to
+   one byte past the fragment.  *out_p points to the next free byte in
+   the destination buffer, out_end points to one byte past the buffer.
+   On return, *in_p and *out_p are advanced past the consumed input and
+   produced output.  If *in_p<in_end, the destination buffer ran out of
+   space and the caller should retry with a fresh buffer.  libzstd
+   buffers internally, so it is normal for no output to be produced.
+
+   Returns 0 on success and EPROTO on error (the caller should reset the
+   cstream in that case).  If opt_errcode!=NULL and an error occured,
+   *opt_errcode is set accordingly. */
+
+int
+fd_zstd_cstream_compress( fd_zstd_cstream_t *     cstream,
+                          uchar const ** restrict in_p,
+                          uchar const *           in_end,
+                          uchar ** restrict       out_p,
+                          uchar *                 out_end,
+                          ulong *                 opt_errcode );
+
+/* fd_zstd_cstream_end flushes all buffered data and ends the current
+   frame.  *out_p and out_end are as in fd_zstd_cstream_compress.
+   Returns -1 once the frame was completely written out, in which case
+   the next compress call starts a new frame.  Returns 0 if the
+   destination buffer ran out of space and the caller should call again
+   with a fresh buffer.  Returns EPROTO on error. */
+
+int
+fd_zstd_cstream_end( fd_zstd_cstream_t * cstream,
+                     uchar ** restrict   out_p,
+                     uchar *             out_end,
+                     ulong *             opt_errcode );
+
+FD_PROTOTYPES_END
+
 #endif /* FD_HAS_ZSTD */
 
 #endif /* HEADER_fd_src_ballet_zstd_fd_zstd_h */
@@ -12,6 +12,8 @@
 
 FD_STATIC_ASSERT( alignof ( fd_zstd_dstream_t      )==FD_ZSTD_DSTREAM_ALIGN, layout );
 FD_STATIC_ASSERT( offsetof( fd_zstd_dstream_t, mem )==FD_ZSTD_DSTREAM_ALIGN, layout );
+FD_STATIC_ASSERT( alignof ( fd_zstd_cstream_t      )==FD_ZSTD_CSTREAM_ALIGN, layout );
+FD_STATIC_ASSERT( offsetof( fd_zstd_cstream_t, mem )==FD_ZSTD_CSTREAM_ALIGN, layout );
 
 /* Test vectors */
 
@@ -130,6 +132,96 @@ test_decompress( void ) {
   FD_TEST( dstream->magic==0UL );
 }
 
+static void
+test_compress( void ) {
+  FD_TEST( fd_zstd_cstream_align()==FD_ZSTD_CSTREAM_ALIGN );
+
+  int   level  = 3;
+  ulong mem_sz = fd_zstd_cstream_footprint( level );
+  uchar mem[mem_sz];  /* Use VLA to assist AddressSanitizer */
+
+  fd_zstd_cstream_t * cstream = fd_zstd_cstream_new( mem, level );
+  FD_TEST( cstream );
+  FD_TEST( cstream->magic==FD_ZSTD_CSTREAM_MAGIC );
+  FD_TEST( cstream->mem_sz + sizeof(fd_zstd_cstream_t) == mem_sz );
+
+  /* Compress two independent frames into one stream, draining the
+     output byte by byte */
+
+  static uchar const msg[] = "ABCDABCDABCDABCDABCDABCDABCDABCD";
+  ulong const        msg_sz = sizeof(msg)-1UL;
+
+  uchar   comp[ 256 ];
+  uchar * comp_cur = comp;
+  for( ulong k=0UL; k<2UL; k++ ) {
+    uchar const * in_cur = msg;
+    while( in_cur<msg+msg_sz ) {
+      FD_TEST( comp_cur<comp+sizeof(comp) );
+      FD_TEST( 0==fd_zstd_cstream_compress( cstream, &in_cur, msg+msg_sz, &comp_cur, comp_cur+1, NULL ) );
+    }
+    int rc;
+    do {
+      FD_TEST( comp_cur<comp+sizeof(comp) );
+      rc = fd_zstd_cstream_end( cstream, &comp_cur, comp_cur+1, NULL );
+      FD_TEST( rc<=0 );
+    } while( rc==0 );
+  }
+
+  fd_zstd_peek_t peek[1]; memset( peek, 0, sizeof(fd_zstd_peek_t) );
+  FD_TEST( fd_zstd_peek( peek, comp, (ulong)(comp_cur-comp) )==peek );
+
+  /* Split stream into frames */
+
+  ulong comp_sz  = (ulong)(comp_cur-comp);
+  ulong frame_sz = fd_zstd_frame_sz( comp, comp_sz );
+  FD_TEST( frame_sz && frame_sz<comp_sz );
+  FD_TEST( fd_zstd_frame_sz( comp+frame_sz, comp_sz-frame_sz )==comp_sz-frame_sz );
+  FD_TEST( fd_zstd_frame_sz( comp, frame_sz-1UL )==0UL );
+  FD_TEST( fd_zstd_frame_sz( msg,  msg_sz       )==0UL );
+
+  /* Round trip */
+
+  ulong window_sz = 1UL<<21;
+  ulong dmem_sz   = fd_zstd_dstream_footprint( window_sz );
+  uchar dmem[dmem_sz];
+  fd_zstd_dstream_t * dstream = fd_zstd_dstream_new( dmem, window_sz );
+  FD_TEST( dstream );
+
+  uchar         out[ 128 ];
+  uchar *       out_cur = out;
+  uchar const * in_cur  = comp;
+  for( ulong k=0UL; k<2UL; k++ ) {
+    int rc = fd_zstd_dstream_read( dstream, &in_cur, comp_cur, &out_cur, out+sizeof(out), NULL );
+    FD_TEST( rc==-1 );
+  }
+  FD_TEST( in_cur ==comp_cur          );
+  FD_TEST( out_cur==out+2UL*msg_sz    );
+  FD_TEST( 0==memcmp( out,        msg, msg_sz ) );
+  FD_TEST( 0==memcmp( out+msg_sz, msg, msg_sz ) );
+
+  /* Abort partial frame */
+
+  in_cur = msg;
+  comp_cur = comp;
+  FD_TEST( 0==fd_zstd_cstream_compress( cstream, &in_cur, msg+4, &comp_cur, comp+sizeof(comp), NULL ) );
+  fd_zstd_cstream_reset( cstream );
+  comp_cur = comp;
+  in_cur   = msg+4;
+  FD_TEST( 0==fd_zstd_cstream_compress( cstream, &in_cur, msg+8, &comp_cur, comp+sizeof(comp), NULL ) );
+  FD_TEST( -1==fd_zstd_cstream_end( cstream, &comp_cur, comp+sizeof(comp), NULL ) );
+
+  fd_zstd_dstream_reset( dstream );
+  out_cur = out;
+  in_cur  = comp;
+  FD_TEST( -1==fd_zstd_dstream_read( dstream, &in_cur, comp_cur, &out_cur, out+sizeof(out), NULL ) );
+  FD_TEST( out_cur==out+4 );
+  FD_TEST( 0==memcmp( out, "ABCD", 4 ) );
+
+  FD_TEST( fd_zstd_dstream_delete( dstream )==dmem );
+  FD_TEST( fd_zstd_cstream_delete( cstream )==mem  );
+  FD_TEST( cstream->magic==0UL );
+}
+
 int
 main( int     argc,
       char ** argv ) {
@@ -148,6 +240,7 @@ main( int     argc,
   }
 
   test_decompress();
+  test_compress();
 
   FD_LOG_NOTICE(( "pass" ));
   fd_halt();
@@ -1 +1,2 @@
 # $(call make-unit-test,test_dedup,test_dedup,fd_disco fd_tango fd_util)
+$(call make-unit-test,bench_dedup_shard,bench_dedup_shard,fd_tango fd_util)
@@ -0,0 +1,210 @@
+#include "../fd_disco_base.h"
+
+/* bench_dedup_shard measures how the throughput of the dedup stage
+   scales with the number of dedup tiles.  A stream of dedup tags with
+   duplicates is generated up front.  For each shard count, every shard
+   scans the whole stream like a dedup tile reading all verify links,
+   skips the txns of other shards (before_frag), and copies and inserts
+   the others into its own tcache (during_frag and after_frag).
+
+   If there are enough tiles (see --tile-cpus), the shards run in
+   parallel, one per tile.  Otherwise they run one after another on the
+   main tile, and the throughput reported is the one of the slowest
+   shard, which is what the stage would achieve with one core per
+   shard.  In either case, the number of duplicates found must not
+   depend on the shard count. */
+
+#define SHARD_MAX (64UL)
+
+struct bench_shard {
+  ulong *       sig;
+  ulong         txn_cnt;
+  uchar const * src;
+  ulong         txn_sz;
+  ulong         shard_cnt;
+  ulong         shard_idx;
+  fd_tcache_t * tcache;
+  uchar *       dst;
+  ulong         dst_sz;
+
+  ulong         dup_cnt;  /* out */
+  ulong         pub_cnt;  /* out */
+  long          dt;       /* out */
+};
+
+typedef struct bench_shard bench_shard_t;
+
+static bench_shard_t shard_tbl[ SHARD_MAX ];
+
+static int
+shard_main( int     argc,
+            char ** argv ) {
+  (void)argv;
+  bench_shard_t * shard = &shard_tbl[ argc ];
+
+  fd_tcache_t * tcache  = fd_tcache_join( fd_tcache_new( fd_tcache_delete( fd_tcache_leave( shard->tcache ) ),
+                                                         fd_tcache_depth( shard->tcache ), fd_tcache_map_cnt( shard->tcache ) ) );
+  ulong   depth   = fd_tcache_depth       ( tcache );
+  ulong   map_cnt = fd_tcache_map_cnt     ( tcache );
+  ulong * oldest  = fd_tcache_oldest_laddr( tcache );
+  ulong * ring    = fd_tcache_ring_laddr  ( tcache );
+  ulong * map     = fd_tcache_map_laddr   ( tcache );
+
+  ulong const * sig       = shard->sig;
+  ulong         txn_cnt   = shard->txn_cnt;
+  ulong         txn_sz    = shard->txn_sz;
+  ulong         shard_cnt = shard->shard_cnt;
+  ulong         shard_idx = shard->shard_idx;
+  ulong         dst_off   = 0UL;
+  ulong         dup_cnt   = 0UL;
+  ulong         pub_cnt   = 0UL;
+
+  long dt = -fd_log_wallclock();
+  for( ulong i=0UL; i<txn_cnt; i++ ) {
+    if( FD_LIKELY( fd_disco_dedup_shard( sig[ i ], shard_cnt )!=shard_idx ) ) continue;
+
+    fd_memcpy( shard->dst + dst_off, shard->src + (i & 63UL)*txn_sz, txn_sz );
+
+    int is_dup;
+    FD_TCACHE_INSERT( is_dup, *oldest, ring, depth, map, map_cnt, sig[ i ] );
+    dup_cnt += (ulong)is_dup;
+    pub_cnt += (ulong)!is_dup;
+    dst_off  = fd_ulong_if( dst_off+2UL*txn_sz>shard->dst_sz, 0UL, dst_off+txn_sz );
+  }
+  dt += fd_log_wallclock();
+
+  shard->dup_cnt = dup_cnt;
+  shard->pub_cnt = pub_cnt;
+  shard->dt      = dt;
+  return 0;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong cpu_idx = fd_tile_cpu_id( fd_tile_idx() );
+  if( cpu_idx>fd_shmem_cpu_cnt() ) cpu_idx = 0UL;
+
+  char const * _page_sz  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",   NULL, "gigantic"                   );
+  ulong        page_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt",  NULL, 1UL                          );
+  ulong        numa_idx  = fd_env_strip_cmdline_ulong( &argc, &argv, "--numa-idx",  NULL, fd_shmem_numa_idx( cpu_idx ) );
+  ulong        txn_cnt   = fd_env_strip_cmdline_ulong( &argc, &argv, "--txn-cnt",   NULL, 1UL<<22                      );
+  ulong        txn_sz    = fd_env_strip_cmdline_ulong( &argc, &argv, "--txn-sz",    NULL, 512UL                        );
+  ulong        depth     = fd_env_strip_cmdline_ulong( &argc, &argv, "--depth",     NULL, 1UL<<20                      );
+  float        dup_frac  = fd_env_strip_cmdline_float( &argc, &argv, "--dup-frac",  NULL, 0.2f                         );
+  ulong        shard_max = fd_env_strip_cmdline_ulong( &argc, &argv, "--shard-max", NULL, 8UL                          );
+
+  if( FD_UNLIKELY( !txn_cnt                            ) ) FD_LOG_ERR(( "--txn-cnt must be positive" ));
+  if( FD_UNLIKELY( !txn_sz || txn_sz>FD_TPU_DCACHE_MTU ) ) FD_LOG_ERR(( "--txn-sz must be in [1,%lu]", FD_TPU_DCACHE_MTU ));
+  if( FD_UNLIKELY( !depth                              ) ) FD_LOG_ERR(( "--depth must be positive" ));
+  if( FD_UNLIKELY( !(dup_frac>=0.f && dup_frac<=1.f)   ) ) FD_LOG_ERR(( "--dup-frac must be in [0,1]" ));
+  if( FD_UNLIKELY( !shard_max || shard_max>SHARD_MAX   ) ) FD_LOG_ERR(( "--shard-max must be in [1,%lu]", SHARD_MAX ));
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-cnt %lu, --page-sz %s, --numa-idx %lu)", page_cnt, _page_sz, numa_idx ));
+  fd_wksp_t * wksp =
+    fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, fd_shmem_cpu_idx( numa_idx ), "wksp", 0UL );
+  FD_TEST( wksp );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  /* Generate the stream of dedup tags.  A duplicate repeats the tag of
+     a recent txn, as if the same txn was sent to multiple verify tiles
+     or resent by the client. */
+
+  ulong * sig = fd_wksp_alloc_laddr( wksp, alignof(ulong), txn_cnt*sizeof(ulong), 1UL );
+  if( FD_UNLIKELY( !sig ) ) FD_LOG_ERR(( "workspace too small for --txn-cnt %lu", txn_cnt ));
+  for( ulong i=0UL; i<txn_cnt; i++ ) {
+    if( i && fd_rng_float_c( rng )<dup_frac ) sig[ i ] = sig[ i-1UL-fd_rng_ulong_roll( rng, fd_ulong_min( i, 1024UL ) ) ];
+    else                                      sig[ i ] = fd_rng_ulong( rng ) | 1UL; /* non-null tag */
+  }
+
+  uchar * src = fd_wksp_alloc_laddr( wksp, FD_CHUNK_ALIGN, 64UL*txn_sz, 1UL );
+  FD_TEST( src );
+  for( ulong i=0UL; i<64UL*txn_sz; i++ ) src[ i ] = fd_rng_uchar( rng );
+
+  ulong dst_sz = 1UL<<20;
+
+  for( ulong i=0UL; i<shard_max; i++ ) {
+    void * tcache_mem = fd_wksp_alloc_laddr( wksp, fd_tcache_align(), fd_tcache_footprint( depth, 0UL ), 1UL );
+    uchar * dst       = fd_wksp_alloc_laddr( wksp, FD_CHUNK_ALIGN,    dst_sz,                            1UL );
+    if( FD_UNLIKELY( !tcache_mem || !dst ) ) FD_LOG_ERR(( "workspace too small for --shard-max %lu --depth %lu", shard_max, depth ));
+    shard_tbl[ i ] = (bench_shard_t){
+      .sig     = sig,
+      .txn_cnt = txn_cnt,
+      .src     = src,
+      .txn_sz  = txn_sz,
+      .tcache  = fd_tcache_join( fd_tcache_new( tcache_mem, depth, 0UL ) ),
+      .dst     = dst,
+      .dst_sz  = dst_sz
+    };
+    FD_TEST( shard_tbl[ i ].tcache );
+  }
+
+  ulong dup_ref = ULONG_MAX;
+  double tput_ref = 0.;
+  for( ulong shard_cnt=1UL; shard_cnt<=shard_max; shard_cnt<<=1 ) {
+    int parallel = fd_tile_cnt()>shard_cnt;
+
+    for( ulong i=0UL; i<shard_cnt; i++ ) {
+      shard_tbl[ i ].shard_cnt = shard_cnt;
+      shard_tbl[ i ].shard_idx = i;
+    }
+
+    if( parallel ) {
+      fd_tile_exec_t * exec[ SHARD_MAX ];
+      for( ulong i=0UL; i<shard_cnt; i++ ) {
+        exec[ i ] = fd_tile_exec_new( i+1UL, shard_main, (int)i, NULL );
+        FD_TEST( exec[ i ] );
+      }
+      for( ulong i=0UL; i<shard_cnt; i++ ) {
+        int ret;
+        FD_TEST( !fd_tile_exec_delete( exec[ i ], &ret ) );
+        FD_TEST( !ret );
+      }
+    } else {
+      for( ulong i=0UL; i<shard_cnt; i++ ) FD_TEST( !shard_main( (int)i, NULL ) );
+    }
+
+    ulong dup_cnt = 0UL;
+    ulong pub_cnt = 0UL;
+    long  dt_max  = 1L;
+    ulong txn_min = ULONG_MAX;
+    ulong txn_max = 0UL;
+    for( ulong i=0UL; i<shard_cnt; i++ ) {
+      ulong txn = shard_tbl[ i ].dup_cnt + shard_tbl[ i ].pub_cnt;
+      dup_cnt += shard_tbl[ i ].dup_cnt;
+      pub_cnt += shard_tbl[ i ].pub_cnt;
+      dt_max   = fd_long_max( dt_max, shard_tbl[ i ].dt );
+      txn_min  = fd_ulong_min( txn_min, txn );
+      txn_max  = fd_ulong_max( txn_max, txn );
+    }
+    FD_TEST( dup_cnt+pub_cnt==txn_cnt );
+
+    /* Splitting the tags over more tcaches can only reduce evictions,
+       so unless the tcache is deep enough to never evict, duplicates
+       found can only grow with the shard count. */
+    if( txn_cnt<=depth && dup_ref!=ULONG_MAX ) FD_TEST( dup_cnt==dup_ref );
+    if( dup_ref!=ULONG_MAX )                   FD_TEST( dup_cnt>=dup_ref );
+    if( dup_ref==ULONG_MAX ) dup_ref = dup_cnt;
+
+    double tput = (double)txn_cnt*1e3 / (double)dt_max; /* Mtxn/s */
+    if( shard_cnt==1UL ) tput_ref = tput;
+    FD_LOG_NOTICE(( "%2lu shard(s) (%s): %8.3f Mtxn/s (x%.2f), %lu dups, shard load [%lu,%lu] txn",
+                    shard_cnt, parallel ? "parallel" : "modeled", tput, tput/tput_ref, dup_cnt, txn_min, txn_max ));
+  }
+
+  for( ulong i=0UL; i<shard_max; i++ ) {
+    fd_wksp_free_laddr( fd_tcache_delete( fd_tcache_leave( shard_tbl[ i ].tcache ) ) );
+    fd_wksp_free_laddr( shard_tbl[ i ].dst );
+  }
+  fd_wksp_free_laddr( src );
+  fd_wksp_free_laddr( sig );
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
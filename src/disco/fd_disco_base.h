@@ -112,6 +112,21 @@ fd_disco_replay_sig( ulong slot,
 FD_FN_CONST static inline ulong fd_disco_replay_sig_flags( ulong sig ) { return (sig & 0xFFUL); }
 FD_FN_CONST static inline ulong fd_disco_replay_sig_slot( ulong sig ) { return (sig >> 8); }
 
+/* fd_disco_dedup_shard returns the index in [0,shard_cnt) of the dedup
+   tile responsible for a transaction, given the signature field of the
+   verify frag, which is the dedup tag (the leading bytes of the first
+   transaction signature).  Every verify tile is read by every dedup
+   tile, and each dedup tile only keeps the transactions of its own
+   shard, so all copies of a transaction land in the same tcache.  The
+   tag is mixed first, as the tcache indexes its map by the low bits of
+   the tag, and a shard must not select a subset of the map slots. */
+
+FD_FN_CONST static inline ulong
+fd_disco_dedup_shard( ulong sig,
+                      ulong shard_cnt ) {
+  return fd_ulong_hash( sig ) % shard_cnt;
+}
+
 FD_FN_PURE static inline ulong
 fd_disco_compact_chunk0( void * wksp ) {
   return (((struct fd_wksp_private *)wksp)->gaddr_lo) >> FD_CHUNK_LG_SZ;
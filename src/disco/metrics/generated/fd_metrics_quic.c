@@ -32,6 +32,7 @@ const fd_metrics_meta_t FD_METRICS_QUIC[FD_METRICS_QUIC_TOTAL] = {
     DECLARE_METRIC_COUNTER( QUIC, CONNECTIONS_ABORTED ),
     DECLARE_METRIC_COUNTER( QUIC, CONNECTIONS_RETRIED ),
     DECLARE_METRIC_COUNTER( QUIC, CONNECTION_ERROR_NO_SLOTS ),
+    DECLARE_METRIC_COUNTER( QUIC, CONNECTIONS_EVICTED ),
     DECLARE_METRIC_COUNTER( QUIC, CONNECTION_ERROR_TLS_FAIL ),
     DECLARE_METRIC_COUNTER( QUIC, CONNECTION_ERROR_RETRY_FAIL ),
     DECLARE_METRIC_COUNTER( QUIC, HANDSHAKES_CREATED ),
@@ -164,105 +164,110 @@
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_NO_SLOTS_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_NO_SLOTS_DESC "Number of connections that failed to create due to lack of slots."
 
-#define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_TLS_FAIL_OFF  (204UL)
+#define FD_METRICS_COUNTER_QUIC_CONNECTIONS_EVICTED_OFF  (204UL)
+#define FD_METRICS_COUNTER_QUIC_CONNECTIONS_EVICTED_NAME "quic_connections_evicted"
+#define FD_METRICS_COUNTER_QUIC_CONNECTIONS_EVICTED_TYPE (FD_METRICS_TYPE_COUNTER)
+#define FD_METRICS_COUNTER_QUIC_CONNECTIONS_EVICTED_DESC "Number of unstaked connections evicted to make room for a new connection."
+
+#define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_TLS_FAIL_OFF  (205UL)
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_TLS_FAIL_NAME "quic_connection_error_tls_fail"
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_TLS_FAIL_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_TLS_FAIL_DESC "Number of connections that aborted due to TLS failure."
 
-#define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_RETRY_FAIL_OFF  (205UL)
+#define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_RETRY_FAIL_OFF  (206UL)
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_RETRY_FAIL_NAME "quic_connection_error_retry_fail"
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_RETRY_FAIL_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_CONNECTION_ERROR_RETRY_FAIL_DESC "Number of connections that failed during retry (e.g. invalid token)."
 
-#define FD_METRICS_COUNTER_QUIC_HANDSHAKES_CREATED_OFF  (206UL)
+#define FD_METRICS_COUNTER_QUIC_HANDSHAKES_CREATED_OFF  (207UL)
 #define FD_METRICS_COUNTER_QUIC_HANDSHAKES_CREATED_NAME "quic_handshakes_created"
 #define FD_METRICS_COUNTER_QUIC_HANDSHAKES_CREATED_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_HANDSHAKES_CREATED_DESC "Number of handshake flows created."
 
-#define FD_METRICS_COUNTER_QUIC_HANDSHAKE_ERROR_ALLOC_FAIL_OFF  (207UL)
+#define FD_METRICS_COUNTER_QUIC_HANDSHAKE_ERROR_ALLOC_FAIL_OFF  (208UL)
 #define FD_METRICS_COUNTER_QUIC_HANDSHAKE_ERROR_ALLOC_FAIL_NAME "quic_handshake_error_alloc_fail"
 #define FD_METRICS_COUNTER_QUIC_HANDSHAKE_ERROR_ALLOC_FAIL_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_HANDSHAKE_ERROR_ALLOC_FAIL_DESC "Number of handshakes dropped due to alloc fail."
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_OFF  (208UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_OFF  (209UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_CNT  (4UL)
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_CLIENT_OFF  (208UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_CLIENT_OFF  (209UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_CLIENT_NAME "quic_stream_opened_bidi_client"
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_CLIENT_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_CLIENT_DESC "Number of streams opened. (Bidirectional client)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_SERVER_OFF  (209UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_SERVER_OFF  (210UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_SERVER_NAME "quic_stream_opened_bidi_server"
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_SERVER_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_BIDI_SERVER_DESC "Number of streams opened. (Bidirectional server)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_CLIENT_OFF  (210UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_CLIENT_OFF  (211UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_CLIENT_NAME "quic_stream_opened_uni_client"
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_CLIENT_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_CLIENT_DESC "Number of streams opened. (Unidirectional client)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_SERVER_OFF  (211UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_SERVER_OFF  (212UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_SERVER_NAME "quic_stream_opened_uni_server"
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_SERVER_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_OPENED_UNI_SERVER_DESC "Number of streams opened. (Unidirectional server)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_OFF  (212UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_OFF  (213UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_CNT  (4UL)
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_CLIENT_OFF  (212UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_CLIENT_OFF  (213UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_CLIENT_NAME "quic_stream_closed_bidi_client"
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_CLIENT_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_CLIENT_DESC "Number of streams closed. (Bidirectional client)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_SERVER_OFF  (213UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_SERVER_OFF  (214UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_SERVER_NAME "quic_stream_closed_bidi_server"
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_SERVER_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_BIDI_SERVER_DESC "Number of streams closed. (Bidirectional server)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_CLIENT_OFF  (214UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_CLIENT_OFF  (215UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_CLIENT_NAME "quic_stream_closed_uni_client"
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_CLIENT_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_CLIENT_DESC "Number of streams closed. (Unidirectional client)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_SERVER_OFF  (215UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_SERVER_OFF  (216UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_SERVER_NAME "quic_stream_closed_uni_server"
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_SERVER_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_CLOSED_UNI_SERVER_DESC "Number of streams closed. (Unidirectional server)"
 
-#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_OFF  (216UL)
+#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_OFF  (217UL)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_CNT  (4UL)
 
-#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_CLIENT_OFF  (216UL)
+#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_CLIENT_OFF  (217UL)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_CLIENT_NAME "quic_stream_active_bidi_client"
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_CLIENT_TYPE (FD_METRICS_TYPE_GAUGE)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_CLIENT_DESC "Number of active streams. (Bidirectional client)"
 
-#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_SERVER_OFF  (217UL)
+#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_SERVER_OFF  (218UL)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_SERVER_NAME "quic_stream_active_bidi_server"
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_SERVER_TYPE (FD_METRICS_TYPE_GAUGE)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_BIDI_SERVER_DESC "Number of active streams. (Bidirectional server)"
 
-#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_CLIENT_OFF  (218UL)
+#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_CLIENT_OFF  (219UL)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_CLIENT_NAME "quic_stream_active_uni_client"
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_CLIENT_TYPE (FD_METRICS_TYPE_GAUGE)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_CLIENT_DESC "Number of active streams. (Unidirectional client)"
 
-#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_SERVER_OFF  (219UL)
+#define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_SERVER_OFF  (220UL)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_SERVER_NAME "quic_stream_active_uni_server"
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_SERVER_TYPE (FD_METRICS_TYPE_GAUGE)
 #define FD_METRICS_GAUGE_QUIC_STREAM_ACTIVE_UNI_SERVER_DESC "Number of active streams. (Unidirectional server)"
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_EVENTS_OFF  (220UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_EVENTS_OFF  (221UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_EVENTS_NAME "quic_stream_received_events"
 #define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_EVENTS_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_EVENTS_DESC "Number of stream RX events."
 
-#define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_BYTES_OFF  (221UL)
+#define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_BYTES_OFF  (222UL)
 #define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_BYTES_NAME "quic_stream_received_bytes"
 #define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_BYTES_TYPE (FD_METRICS_TYPE_COUNTER)
 #define FD_METRICS_COUNTER_QUIC_STREAM_RECEIVED_BYTES_DESC "Total stream payload bytes received."
 
 
-#define FD_METRICS_QUIC_TOTAL (48UL)
+#define FD_METRICS_QUIC_TOTAL (49UL)
 extern const fd_metrics_meta_t FD_METRICS_QUIC[FD_METRICS_QUIC_TOTAL];
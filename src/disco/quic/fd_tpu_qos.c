@@ -0,0 +1,129 @@
+#include "fd_tpu_qos.h"
+
+static const fd_pubkey_t null_pubkey = {{ 0 }};
+
+#define MAP_NAME              fd_tpu_qos_map
+#define MAP_T                 fd_tpu_qos_entry_t
+#define MAP_KEY_T             fd_pubkey_t
+#define MAP_KEY_NULL          null_pubkey
+#define MAP_KEY_EQUAL_IS_SLOW 1
+#define MAP_MEMOIZE           0
+#define MAP_KEY_INVAL(k)      MAP_KEY_EQUAL((k),MAP_KEY_NULL)
+#define MAP_KEY_EQUAL(k0,k1)  (!memcmp( (k0).key, (k1).key, 32UL ))
+#define MAP_KEY_HASH(key)     ((MAP_HASH_T)( (key).ul[1] ))
+#include "../../util/tmpl/fd_map_dynamic.c"
+
+ulong
+fd_tpu_qos_align( void ) {
+  return fd_ulong_max( alignof(fd_tpu_qos_t), fd_tpu_qos_map_align() );
+}
+
+ulong
+fd_tpu_qos_footprint( void ) {
+  ulong l = FD_LAYOUT_INIT;
+  l = FD_LAYOUT_APPEND( l, alignof(fd_tpu_qos_t),   sizeof(fd_tpu_qos_t)                                  );
+  l = FD_LAYOUT_APPEND( l, fd_tpu_qos_map_align(), fd_tpu_qos_map_footprint( FD_TPU_QOS_MAP_LG_SLOT_CNT ) );
+  return FD_LAYOUT_FINI( l, fd_tpu_qos_align() );
+}
+
+void *
+fd_tpu_qos_new( void * mem,
+                ulong  stream_pool_cnt,
+                ulong  unstaked_stream_cnt,
+                ulong  max_stream_cnt ) {
+  if( FD_UNLIKELY( !mem ) ) {
+    FD_LOG_WARNING(( "NULL mem" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)mem, fd_tpu_qos_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned mem" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( unstaked_stream_cnt>max_stream_cnt ) ) {
+    FD_LOG_WARNING(( "unstaked_stream_cnt (%lu) exceeds max_stream_cnt (%lu)", unstaked_stream_cnt, max_stream_cnt ));
+    return NULL;
+  }
+
+  FD_SCRATCH_ALLOC_INIT( l, mem );
+  fd_tpu_qos_t * qos  = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_tpu_qos_t),   sizeof(fd_tpu_qos_t)                                  );
+  void *         _map = FD_SCRATCH_ALLOC_APPEND( l, fd_tpu_qos_map_align(), fd_tpu_qos_map_footprint( FD_TPU_QOS_MAP_LG_SLOT_CNT ) );
+  FD_SCRATCH_ALLOC_FINI( l, fd_tpu_qos_align() );
+
+  qos->epoch               = 0UL;
+  qos->staked_cnt          = 0UL;
+  qos->total_stake         = 0UL;
+  qos->stream_pool_cnt     = stream_pool_cnt;
+  qos->unstaked_stream_cnt = unstaked_stream_cnt;
+  qos->max_stream_cnt      = max_stream_cnt;
+  qos->map                 = fd_tpu_qos_map_join( fd_tpu_qos_map_new( _map, FD_TPU_QOS_MAP_LG_SLOT_CNT ) );
+
+  return (void *)qos;
+}
+
+fd_tpu_qos_t * fd_tpu_qos_join  ( void *         mem ) { return (fd_tpu_qos_t *)mem; }
+void *         fd_tpu_qos_leave ( fd_tpu_qos_t * qos ) { return (void *)qos;         }
+
+void *
+fd_tpu_qos_delete( void * mem ) {
+  fd_tpu_qos_t * qos = (fd_tpu_qos_t *)mem;
+  fd_tpu_qos_map_delete( fd_tpu_qos_map_leave( qos->map ) );
+  return mem;
+}
+
+void
+fd_tpu_qos_stake_msg_init( fd_tpu_qos_t * qos,
+                           uchar const  * new_message ) {
+  ulong const * hdr = fd_type_pun_const( new_message );
+
+  ulong epoch      = hdr[ 0 ];
+  ulong staked_cnt = hdr[ 1 ];
+
+  if( FD_UNLIKELY( staked_cnt > MAX_SHRED_DESTS ) )
+    FD_LOG_ERR(( "The stakes -> Firedancer splice sent a malformed update with %lu stakes in it,"
+                 " but the maximum allowed is %lu", staked_cnt, MAX_SHRED_DESTS ));
+
+  qos->scratch->epoch      = epoch;
+  qos->scratch->staked_cnt = staked_cnt;
+
+  fd_memcpy( qos->stake_weight, hdr+5UL, sizeof(fd_stake_weight_t)*staked_cnt );
+}
+
+void
+fd_tpu_qos_stake_msg_fini( fd_tpu_qos_t * qos ) {
+  ulong epoch      = qos->scratch->epoch;
+  ulong staked_cnt = qos->scratch->staked_cnt;
+
+  if( FD_UNLIKELY( qos->total_stake && epoch<qos->epoch ) ) return;
+
+  fd_tpu_qos_map_clear( qos->map );
+
+  ulong total_stake = 0UL;
+  ulong cnt         = 0UL;
+  for( ulong i=0UL; i<staked_cnt; i++ ) {
+    fd_stake_weight_t const * w = qos->stake_weight + i;
+    if( FD_UNLIKELY( !w->stake || !memcmp( w->key.key, null_pubkey.key, 32UL ) ) ) continue;
+
+    fd_tpu_qos_entry_t * entry = fd_tpu_qos_map_query( qos->map, w->key, NULL );
+    if( FD_UNLIKELY( !entry ) ) {
+      entry        = fd_tpu_qos_map_insert( qos->map, w->key );
+      entry->stake = 0UL;
+      cnt++;
+    }
+    entry->stake += w->stake;
+    total_stake  += w->stake;
+  }
+
+  qos->epoch       = epoch;
+  qos->staked_cnt  = cnt;
+  qos->total_stake = total_stake;
+}
+
+ulong
+fd_tpu_qos_stake( fd_tpu_qos_t const * qos,
+                  uchar const          pubkey[ static 32 ] ) {
+  fd_pubkey_t key;
+  fd_memcpy( key.uc, pubkey, 32UL );
+  if( FD_UNLIKELY( !memcmp( key.key, null_pubkey.key, 32UL ) ) ) return 0UL;
+  fd_tpu_qos_entry_t const * entry = fd_tpu_qos_map_query( qos->map, key, NULL );
+  return entry ? entry->stake : 0UL;
+}
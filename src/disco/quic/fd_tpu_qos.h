@@ -0,0 +1,122 @@
+#ifndef HEADER_fd_src_disco_quic_fd_tpu_qos_h
+#define HEADER_fd_src_disco_quic_fd_tpu_qos_h
+
+/* fd_tpu_qos decides how much of the TPU/QUIC server's capacity each
+   client gets, based on the client's stake.
+
+   Clients identify themselves with the Ed25519 key in their TLS
+   certificate, which for validators is the node identity.  Clients
+   that hold stake get access to connection slots reserved for staked
+   peers (see fd_quic_config_t::conn_reserved_cnt) and a number of
+   concurrent streams proportional to their share of the total stake.
+   Unstaked clients share the remaining connection slots and get a
+   fixed, small number of concurrent streams each.
+
+   Stake weights are taken from the same stake messages the shred tile
+   consumes (see fd_stake_ci_stake_msg_init).  Like fd_stake_ci, an
+   update is applied in two steps: stake_msg_init copies the message
+   out of the dcache during the mux during_frag callback, and
+   stake_msg_fini applies it once the frag was confirmed not overrun. */
+
+#include "../shred/fd_stake_ci.h"
+
+/* FD_TPU_QOS_MAP_LG_SLOT_CNT: log2 of the slot count of the stake map.
+   Sized such that the map is at most ~30% full with MAX_SHRED_DESTS
+   staked peers. */
+
+#define FD_TPU_QOS_MAP_LG_SLOT_CNT (17)
+
+struct fd_tpu_qos_entry {
+  fd_pubkey_t key;
+  ulong       stake;
+};
+typedef struct fd_tpu_qos_entry fd_tpu_qos_entry_t;
+
+struct fd_tpu_qos {
+  ulong epoch;        /* epoch of the current stake weights */
+  ulong staked_cnt;   /* number of peers with non-zero stake */
+  ulong total_stake;  /* sum of stake of all peers, in lamports */
+
+  /* stream quota parameters, see fd_tpu_qos_stream_cnt */
+  ulong stream_pool_cnt;
+  ulong unstaked_stream_cnt;
+  ulong max_stream_cnt;
+
+  fd_tpu_qos_entry_t * map;  /* pubkey -> stake, uses memory after this struct */
+
+  /* scratch and stake_weight are only relevant between stake_msg_init
+     and stake_msg_fini */
+  struct {
+    ulong epoch;
+    ulong staked_cnt;
+  } scratch[1];
+
+  fd_stake_weight_t stake_weight[ MAX_SHRED_DESTS ];
+};
+typedef struct fd_tpu_qos fd_tpu_qos_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_tpu_qos_{align,footprint} return the alignment and footprint
+   required of a region of memory to be used as an fd_tpu_qos_t. */
+
+FD_FN_CONST ulong
+fd_tpu_qos_align( void );
+
+FD_FN_CONST ulong
+fd_tpu_qos_footprint( void );
+
+/* fd_tpu_qos_new formats a region of memory with the required
+   footprint and alignment for use as an fd_tpu_qos_t.  Initially, no
+   peer is staked.
+
+   stream_pool_cnt is the number of streams shared by all conns of the
+   QUIC server (fd_quic_limits_t::stream_pool_cnt).  unstaked_stream_cnt
+   is the number of concurrent streams given to each unstaked peer.
+   max_stream_cnt is the max number of concurrent streams of any conn
+   (fd_quic_limits_t::stream_cnt of client unidirectional streams).
+   Requires unstaked_stream_cnt<=max_stream_cnt. */
+
+void *
+fd_tpu_qos_new( void * mem,
+                ulong  stream_pool_cnt,
+                ulong  unstaked_stream_cnt,
+                ulong  max_stream_cnt );
+
+fd_tpu_qos_t * fd_tpu_qos_join  ( void *         mem );
+void *         fd_tpu_qos_leave ( fd_tpu_qos_t * qos );
+void *         fd_tpu_qos_delete( void *         mem );
+
+/* fd_tpu_qos_stake_msg_{init,fini} update the stake weights from a
+   stake message.  Messages for an epoch older than the current one are
+   ignored.  Unlike fd_stake_ci, only the latest stake weights are
+   kept, as they only drive admission policy, and the stake
+   distribution between two consecutive epochs is nearly identical. */
+
+void fd_tpu_qos_stake_msg_init( fd_tpu_qos_t * qos, uchar const * new_message );
+void fd_tpu_qos_stake_msg_fini( fd_tpu_qos_t * qos );
+
+/* fd_tpu_qos_stake returns the stake in lamports of the peer with the
+   given identity key, or 0 if the peer is unstaked. */
+
+FD_FN_PURE ulong
+fd_tpu_qos_stake( fd_tpu_qos_t const * qos,
+                  uchar const          pubkey[ static 32 ] );
+
+/* fd_tpu_qos_stream_cnt returns the number of concurrent streams that
+   a peer with the given stake should be allowed to open.  Unstaked
+   peers get unstaked_stream_cnt streams.  Staked peers get their stake
+   proportional share of the stream pool, clamped to [unstaked_stream_cnt,
+   max_stream_cnt]. */
+
+FD_FN_PURE static inline ulong
+fd_tpu_qos_stream_cnt( fd_tpu_qos_t const * qos,
+                       ulong                stake ) {
+  if( !stake || !qos->total_stake ) return qos->unstaked_stream_cnt;
+  ulong share = (ulong)( ( (uint128)qos->stream_pool_cnt * (uint128)stake ) / (uint128)qos->total_stake );
+  return fd_ulong_min( fd_ulong_max( share, qos->unstaked_stream_cnt ), qos->max_stream_cnt );
+}
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_disco_quic_fd_tpu_qos_h */
@@ -0,0 +1,153 @@
+#include "fd_tpu_qos.h"
+
+static uchar stake_msg[ FD_STAKE_CI_STAKE_MSG_SZ ] __attribute__((aligned(8)));
+
+static uchar qos_mem[ 8UL<<20 ] __attribute__((aligned(128)));
+
+typedef struct {
+  ulong epoch;
+  ulong staked_cnt;
+  ulong start_slot;
+  ulong slot_cnt;
+  ulong excluded_stake;
+  fd_stake_weight_t weights[];
+} stake_msg_hdr_t;
+
+/* generate_stake_msg creates a stake message where the i-th character
+   of stakers is the byte pattern of the i-th staked peer's key, which
+   has stake stake[i]. */
+
+static uchar *
+generate_stake_msg( uchar *       _buf,
+                    ulong         epoch,
+                    char const *  stakers,
+                    ulong const * stake ) {
+  stake_msg_hdr_t * buf = (stake_msg_hdr_t *)_buf;
+
+  buf->epoch          = epoch;
+  buf->start_slot     = epoch * 1000UL;
+  buf->slot_cnt       = 1000UL;
+  buf->staked_cnt     = strlen( stakers );
+  buf->excluded_stake = 0UL;
+
+  for( ulong i=0UL; stakers[i]; i++ ) {
+    memset( buf->weights[i].key.uc, stakers[i], 32UL );
+    buf->weights[i].stake = stake[i];
+  }
+  return _buf;
+}
+
+static void
+apply_stake_msg( fd_tpu_qos_t * qos,
+                 ulong          epoch,
+                 char const *   stakers,
+                 ulong const *  stake ) {
+  fd_tpu_qos_stake_msg_init( qos, generate_stake_msg( stake_msg, epoch, stakers, stake ) );
+  fd_tpu_qos_stake_msg_fini( qos );
+}
+
+static ulong
+stake_of( fd_tpu_qos_t const * qos,
+          char                 c ) {
+  uchar key[ 32 ];
+  memset( key, c, 32UL );
+  return fd_tpu_qos_stake( qos, key );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong footprint = fd_tpu_qos_footprint();
+  FD_TEST( footprint>=sizeof(fd_tpu_qos_t) );
+  FD_TEST( footprint<=sizeof(qos_mem) );
+  FD_TEST( fd_tpu_qos_align()<=128UL );
+  void * mem = qos_mem;
+
+  FD_TEST( !fd_tpu_qos_new( NULL, 4096UL, 128UL, 1024UL ) );
+  FD_TEST( !fd_tpu_qos_new( mem,  4096UL, 2048UL, 1024UL ) );
+
+  fd_tpu_qos_t * qos = fd_tpu_qos_join( fd_tpu_qos_new( mem, 4096UL, 128UL, 1024UL ) );
+  FD_TEST( qos );
+
+  /* Nobody is staked initially */
+
+  FD_TEST( stake_of( qos, 'a' )==0UL );
+  FD_TEST( fd_tpu_qos_stream_cnt( qos, 0UL )==128UL );
+
+  /* Stake is looked up by identity key */
+
+  ulong stake0[ 4 ] = { 600UL, 300UL, 60UL, 40UL };
+  apply_stake_msg( qos, 10UL, "abcd", stake0 );
+  FD_TEST( qos->epoch==10UL );
+  FD_TEST( qos->staked_cnt==4UL );
+  FD_TEST( qos->total_stake==1000UL );
+  FD_TEST( stake_of( qos, 'a' )==600UL );
+  FD_TEST( stake_of( qos, 'b' )==300UL );
+  FD_TEST( stake_of( qos, 'd' )== 40UL );
+  FD_TEST( stake_of( qos, 'e' )==  0UL );
+  FD_TEST( stake_of( qos, '\0' )== 0UL );
+
+  /* Stream quota is the stake proportional share of the pool, clamped
+     to [unstaked_stream_cnt,max_stream_cnt] */
+
+  FD_TEST( fd_tpu_qos_stream_cnt( qos,   0UL )== 128UL );
+  FD_TEST( fd_tpu_qos_stream_cnt( qos, 600UL )==1024UL ); /* 2457 clamped */
+  FD_TEST( fd_tpu_qos_stream_cnt( qos, 100UL )== 409UL );
+  FD_TEST( fd_tpu_qos_stream_cnt( qos,  40UL )== 163UL );
+  FD_TEST( fd_tpu_qos_stream_cnt( qos,  10UL )== 128UL ); /* 40 raised */
+
+  /* Large stakes don't overflow */
+
+  FD_TEST( fd_tpu_qos_stream_cnt( qos, ULONG_MAX )==1024UL );
+
+  /* A newer epoch replaces all stakes, an older one is ignored */
+
+  ulong stake1[ 2 ] = { 50UL, 50UL };
+  apply_stake_msg( qos, 11UL, "be", stake1 );
+  FD_TEST( qos->epoch==11UL );
+  FD_TEST( qos->staked_cnt==2UL );
+  FD_TEST( qos->total_stake==100UL );
+  FD_TEST( stake_of( qos, 'a' )==0UL );
+  FD_TEST( stake_of( qos, 'b' )==50UL );
+  FD_TEST( stake_of( qos, 'e' )==50UL );
+
+  apply_stake_msg( qos, 9UL, "abcd", stake0 );
+  FD_TEST( qos->epoch==11UL );
+  FD_TEST( stake_of( qos, 'a' )==0UL );
+
+  /* Zero stake entries are not staked, duplicates are merged */
+
+  ulong stake2[ 3 ] = { 0UL, 7UL, 5UL };
+  apply_stake_msg( qos, 12UL, "aff", stake2 );
+  FD_TEST( qos->staked_cnt==1UL );
+  FD_TEST( qos->total_stake==12UL );
+  FD_TEST( stake_of( qos, 'a' )==0UL );
+  FD_TEST( stake_of( qos, 'f' )==12UL );
+
+  /* Max size update */
+
+  stake_msg_hdr_t * hdr = (stake_msg_hdr_t *)stake_msg;
+  hdr->epoch      = 13UL;
+  hdr->staked_cnt = MAX_SHRED_DESTS;
+  for( ulong i=0UL; i<MAX_SHRED_DESTS; i++ ) {
+    memset( hdr->weights[i].key.uc, 0, 32UL );
+    FD_STORE( ulong, hdr->weights[i].key.uc,     i+1UL );
+    FD_STORE( ulong, hdr->weights[i].key.uc+8UL, fd_ulong_hash( i ) );
+    hdr->weights[i].stake = i+1UL;
+  }
+  fd_tpu_qos_stake_msg_init( qos, stake_msg );
+  fd_tpu_qos_stake_msg_fini( qos );
+  FD_TEST( qos->staked_cnt==MAX_SHRED_DESTS );
+  FD_TEST( qos->total_stake==MAX_SHRED_DESTS*(MAX_SHRED_DESTS+1UL)/2UL );
+  for( ulong i=0UL; i<MAX_SHRED_DESTS; i++ ) {
+    FD_TEST( fd_tpu_qos_stake( qos, hdr->weights[i].key.uc )==i+1UL );
+  }
+
+  FD_TEST( fd_tpu_qos_delete( fd_tpu_qos_leave( qos ) )==mem );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -7,7 +7,24 @@ main( int     argc,
 
   fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
 
-  /* This is currently just a stub in anticipation of future tests */
+  /* fd_disco_dedup_shard spreads tags evenly over shards, including
+     tags that all share their low bits */
+
+  for( ulong shard_cnt=1UL; shard_cnt<=16UL; shard_cnt++ ) {
+    ulong cnt[ 16 ] = {0};
+    ulong iter_cnt  = 1UL<<16;
+    for( ulong i=0UL; i<iter_cnt; i++ ) {
+      ulong sig   = fd_rng_ulong( rng ) & ~0xffUL;
+      ulong shard = fd_disco_dedup_shard( sig, shard_cnt );
+      FD_TEST( shard<shard_cnt );
+      FD_TEST( fd_disco_dedup_shard( sig, shard_cnt )==shard );
+      cnt[ shard ]++;
+    }
+    for( ulong j=0UL; j<shard_cnt; j++ ) {
+      FD_TEST( cnt[ j ]*shard_cnt > iter_cnt*9UL/10UL );
+      FD_TEST( cnt[ j ]*shard_cnt < iter_cnt*11UL/10UL );
+    }
+  }
 
   fd_rng_delete( fd_rng_leave( rng ) );
 
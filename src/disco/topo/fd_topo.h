@@ -135,8 +135,10 @@ typedef struct {
       ulong  xdp_rx_queue_size;
       ulong  xdp_tx_queue_size;
       ulong  xdp_aio_depth;
+      ulong  xdp_queue_cnt;
       char   xdp_mode[4];
       int    zero_copy;
+      int    rx_in_place;
       uint   src_ip_addr;
       uchar  src_mac_addr[6];
 
@@ -157,6 +159,8 @@ typedef struct {
       ulong  tx_buf_size;
       ulong  max_concurrent_streams_per_connection;
       ulong  stream_pool_cnt;
+      ulong  staked_connection_reserve;
+      ulong  unstaked_streams_per_connection;
       uint   ip_addr;
       uchar  src_mac_addr[ 6 ];
       ushort quic_transaction_listen_port;
@@ -206,6 +210,9 @@ typedef struct {
 
       char  blockstore_checkpt[ PATH_MAX ];
       int   blockstore_publish;
+      char  blockstore_archive[ PATH_MAX ];
+      ulong blockstore_archive_sz_gb;
+      ulong blockstore_sig_index_lg_max;
       char  capture[ PATH_MAX ];
       char  funk_checkpt[ PATH_MAX ];
       ulong funk_rec_max;
@@ -213,9 +220,12 @@ typedef struct {
       ulong funk_txn_max;
       char  genesis[ PATH_MAX ];
       char  incremental[ PATH_MAX ];
+      ulong jit_cache_sz_mb;
+      ulong owner_index_max;
       char  slots_replayed[ PATH_MAX ];
       char  snapshot[ PATH_MAX ];
       char  status_cache[ PATH_MAX ];
+      ulong token_index_max;
       ulong tpool_thread_count;
       uint  cluster_version;
 
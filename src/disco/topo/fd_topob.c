@@ -121,6 +121,25 @@ fd_topob_link( fd_topo_t *  topo,
   topo->link_cnt++;
 }
 
+void
+fd_topob_link_shared( fd_topo_t *           topo,
+                      char const *          link_name,
+                      char const *          wksp_name,
+                      ulong                 depth,
+                      ulong                 mtu,
+                      ulong                 burst,
+                      fd_topo_obj_t const * dcache ) {
+  if( FD_UNLIKELY( !dcache ) ) FD_LOG_ERR(( "NULL args" ));
+  if( FD_UNLIKELY( strcmp( dcache->name, "dcache" ) ) ) FD_LOG_ERR(( "link %s cannot share object `%s`, it is not a dcache", link_name, dcache->name ));
+  if( FD_UNLIKELY( !mtu ) ) FD_LOG_ERR(( "link %s shares a dcache but has no mtu", link_name ));
+
+  fd_topob_link( topo, link_name, wksp_name, 0, depth, 0UL, burst );
+
+  fd_topo_link_t * link = &topo->links[ topo->link_cnt-1UL ];
+  link->mtu           = mtu;
+  link->dcache_obj_id = dcache->id;
+}
+
 void
 fd_topob_tile_uses( fd_topo_t *      topo,
                     fd_topo_tile_t * tile,
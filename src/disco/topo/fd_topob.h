@@ -99,6 +99,22 @@ fd_topob_link( fd_topo_t *  topo,
                ulong        mtu,
                ulong        burst );
 
+/* Add a link to the topology like fd_topob_link, except that instead of
+   having a dcache of its own, frags published to the link point into
+   the existing dcache object dcache.  Several links can share a dcache
+   this way, when the producer manages the memory of the dcache itself
+   and makes sure not to reuse any part of it that might still be read
+   by a consumer of any of the links. */
+
+void
+fd_topob_link_shared( fd_topo_t *           topo,
+                      char const *          link_name,
+                      char const *          wksp_name,
+                      ulong                 depth,
+                      ulong                 mtu,
+                      ulong                 burst,
+                      fd_topo_obj_t const * dcache );
+
 /* Add a tile to the topology.  This creates various objects needed for
    a standard tile, including a cnc object, tile scratch memory, metrics
    memory and so on.  These objects will be created and linked to the
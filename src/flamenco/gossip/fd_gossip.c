@@ -25,7 +25,12 @@
 /* Max number of validators that can be actively pinged */
 #define FD_ACTIVE_KEY_MAX (1<<8)
 /* Max number of values that can be remembered */
+#ifndef FD_VALUE_KEY_MAX
 #define FD_VALUE_KEY_MAX (1<<16)
+#endif
+/* Values are indexed by the high FD_VALUE_SHARD_LG bits of their hash */
+#define FD_VALUE_SHARD_LG  (12)
+#define FD_VALUE_SHARD_CNT (1UL<<FD_VALUE_SHARD_LG)
 /* Max number of pending timed events */
 #define FD_PENDING_MAX (1<<9)
 /* Number of bloom filter bits in an outgoing pull request packet */
@@ -146,6 +151,8 @@ void fd_hash_copy( fd_hash_t * keyd, const fd_hash_t * keys ) {
 struct fd_value_elem {
     fd_hash_t key;
     ulong next;
+    ulong shard_prev; /* Links in the shard list for the high bits of key */
+    ulong shard_next;
     fd_pubkey_t origin; /* Where did this value originate */
     ulong wallclock; /* Original timestamp of value in millis */
     uchar data[PACKET_DATA_SIZE]; /* Serialized form of value (bincode) including signature */
@@ -161,6 +168,21 @@ typedef struct fd_value_elem fd_value_elem_t;
 #define MAP_T        fd_value_elem_t
 #include "../../util/tmpl/fd_map_giant.c"
 
+/* Value shard lists. Pull requests partition the hash space by the
+   high bits of the hash (mask/mask_bits), so keeping a list of values
+   per high bits prefix lets a request only visit the values it can
+   possibly match. Elements are indexed in the value table. */
+#define DLIST_NAME  fd_value_shard
+#define DLIST_ELE_T fd_value_elem_t
+#define DLIST_PREV  shard_prev
+#define DLIST_NEXT  shard_next
+#include "../../util/tmpl/fd_dlist.c"
+
+static inline ulong
+fd_value_shard_idx( fd_hash_t const * hash ) {
+  return hash->ul[0] >> (64U - FD_VALUE_SHARD_LG);
+}
+
 /* Weights table element. This table stores the weight for each peer
    (determined by stake). */
 struct fd_weights_elem {
@@ -278,6 +300,8 @@ struct fd_gossip {
 #define INACTIVES_MAX 1024U
     /* Table of crds values that we have received in the last 5 minutes, keys by hash */
     fd_value_elem_t * values;
+    /* Values in the table by the high bits of the hash, indexed [0,FD_VALUE_SHARD_CNT) */
+    fd_value_shard_t * value_shards;
     /* The last timestamp hash that we pushed our own contact info */
     long last_contact_time;
     fd_hash_t last_contact_info_key;
@@ -328,6 +352,7 @@ fd_gossip_footprint( void ) {
   l = FD_LAYOUT_APPEND( l, alignof(fd_gossip_peer_addr_t), INACTIVES_MAX*sizeof(fd_gossip_peer_addr_t) );
   l = FD_LAYOUT_APPEND( l, alignof(fd_hash_t), FD_NEED_PUSH_MAX*sizeof(fd_hash_t) );
   l = FD_LAYOUT_APPEND( l, fd_value_table_align(), fd_value_table_footprint(FD_VALUE_KEY_MAX) );
+  l = FD_LAYOUT_APPEND( l, fd_value_shard_align(), FD_VALUE_SHARD_CNT*fd_value_shard_footprint() );
   l = FD_LAYOUT_APPEND( l, fd_pending_pool_align(), fd_pending_pool_footprint(FD_PENDING_MAX) );
   l = FD_LAYOUT_APPEND( l, fd_pending_heap_align(), fd_pending_heap_footprint(FD_PENDING_MAX) );
   l = FD_LAYOUT_APPEND( l, fd_stats_table_align(), fd_stats_table_footprint(FD_STATS_KEY_MAX) );
@@ -356,6 +381,10 @@ fd_gossip_new ( void * shmem, ulong seed ) {
   shm = FD_SCRATCH_ALLOC_APPEND(l, fd_value_table_align(), fd_value_table_footprint(FD_VALUE_KEY_MAX));
   glob->values = fd_value_table_join(fd_value_table_new(shm, FD_VALUE_KEY_MAX, seed));
 
+  glob->value_shards = (fd_value_shard_t*)FD_SCRATCH_ALLOC_APPEND(l, fd_value_shard_align(), FD_VALUE_SHARD_CNT*fd_value_shard_footprint());
+  for( ulong i = 0; i < FD_VALUE_SHARD_CNT; ++i )
+    fd_value_shard_join( fd_value_shard_new( glob->value_shards + i ) );
+
   glob->last_contact_time = 0;
   shm = FD_SCRATCH_ALLOC_APPEND(l, fd_pending_pool_align(), fd_pending_pool_footprint(FD_PENDING_MAX));
   glob->event_pool = fd_pending_pool_join(fd_pending_pool_new(shm, FD_PENDING_MAX));
@@ -392,6 +421,8 @@ fd_gossip_delete ( void * shmap ) {
   fd_peer_table_delete( fd_peer_table_leave( glob->peers ) );
   fd_active_table_delete( fd_active_table_leave( glob->actives ) );
 
+  for( ulong i = 0; i < FD_VALUE_SHARD_CNT; ++i )
+    fd_value_shard_delete( fd_value_shard_leave( glob->value_shards + i ) );
   fd_value_table_delete( fd_value_table_leave( glob->values ) );
   fd_pending_pool_delete( fd_pending_pool_leave( glob->event_pool ) );
   fd_pending_heap_delete( fd_pending_heap_leave( glob->event_heap ) );
@@ -421,6 +452,22 @@ fd_gossip_unlock( fd_gossip_t * gossip ) {
   FD_VOLATILE( gossip->lock ) = 0UL;
 }
 
+/* Insert a value into the value table and its shard list. The table
+   must not be full and must not already contain key. */
+static fd_value_elem_t *
+fd_gossip_value_insert( fd_gossip_t * glob, fd_hash_t const * key ) {
+  fd_value_elem_t * ele = fd_value_table_insert( glob->values, key );
+  fd_value_shard_ele_push_tail( glob->value_shards + fd_value_shard_idx( key ), ele, glob->values );
+  return ele;
+}
+
+/* Remove a value from the value table and its shard list */
+static void
+fd_gossip_value_remove( fd_gossip_t * glob, fd_value_elem_t * ele ) {
+  fd_value_shard_ele_remove( glob->value_shards + fd_value_shard_idx( &ele->key ), ele, glob->values );
+  fd_value_table_remove( glob->values, &ele->key );
+}
+
 /* Convert my style of address to solana style */
 int
 fd_gossip_to_soladdr( fd_gossip_socket_addr_t * dst, fd_gossip_peer_addr_t const * src ) {
@@ -868,7 +915,7 @@ fd_gossip_random_pull( fd_gossip_t * glob, fd_pending_event_arg_t * arg ) {
     fd_hash_t * hash = &(ele->key);
     /* Purge expired values */
     if (ele->wallclock < expire) {
-      fd_value_table_remove( glob->values, hash );
+      fd_gossip_value_remove( glob, ele );
       continue;
     }
     /* Choose which filter packet based on the high bits in the hash */
@@ -1022,10 +1069,54 @@ fd_gossip_random_ping( fd_gossip_t * glob, fd_pending_event_arg_t * arg ) {
   fd_gossip_make_ping(glob, &arg2);
 }
 
-/* Process an incoming crds value */
+/* Inbound crds values are verified in batches of up to
+   FD_ED25519_VERIFY_BATCH_MAX signatures.  A fd_crds_pending_t holds
+   a value between the duplicate check and signature verification. */
+struct fd_crds_pending {
+    fd_crds_value_t * crd;
+    fd_pubkey_t *     pubkey;
+    ulong             wallclock;
+    fd_hash_t         key;
+    ulong             datalen;
+    uchar             buf[PACKET_DATA_SIZE]; /* Serialized form of value (bincode) including signature */
+};
+typedef struct fd_crds_pending fd_crds_pending_t;
+
+/* Record a duplicate value in the receive statistics table */
 static void
-fd_gossip_recv_crds_value(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_pubkey_t * pubkey, fd_crds_value_t* crd) {
-  /* Verify the signature */
+fd_gossip_recv_dup( fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_pubkey_t * pubkey ) {
+  glob->recv_dup_cnt++;
+  if (from == NULL)
+    return;
+  fd_stats_elem_t * val = fd_stats_table_query(glob->stats, from, NULL);
+  if (val == NULL) {
+    if (!fd_stats_table_is_full(glob->stats)) {
+      val = fd_stats_table_insert(glob->stats, from);
+      val->dups_cnt = 0;
+    }
+  }
+  if (val != NULL) {
+    val->last = glob->now;
+    for (ulong i = 0; i < val->dups_cnt; ++i)
+      if (fd_hash_eq(&val->dups[i].origin, pubkey)) {
+        val->dups[i].cnt++;
+        return;
+      }
+    if (val->dups_cnt < 8) {
+      ulong i = val->dups_cnt++;
+      fd_hash_copy(&val->dups[i].origin, pubkey);
+      val->dups[i].cnt = 1;
+    }
+  }
+}
+
+/* Prepare an incoming crds value for signature verification. Values
+   that are already in the value table never reach signature
+   verification. The value hash covers the signature, so a value with
+   a known hash was verified when it was first received. Returns 1 if
+   the value needs to be verified, 0 if it was dropped. */
+static int
+fd_gossip_recv_crds_prepare(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_pubkey_t * pubkey, fd_crds_value_t * crd, fd_crds_pending_t * pend) {
   ulong wallclock;
   switch (crd->data.discriminant) {
   case fd_crds_data_enum_contact_info_v1:
@@ -1078,67 +1169,47 @@ fd_gossip_recv_crds_value(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from
   }
   if (memcmp(pubkey->uc, glob->public_key->uc, 32U) == 0)
     /* Ignore my own messages */
-    return;
-  uchar buf[PACKET_DATA_SIZE];
-  fd_bincode_encode_ctx_t ctx;
-  ctx.data = buf;
-  ctx.dataend = buf + PACKET_DATA_SIZE;
-  if ( fd_crds_data_encode( &crd->data, &ctx ) ) {
-    FD_LOG_ERR(("fd_crds_data_encode failed"));
-    return;
-  }
-  fd_sha512_t sha[1];
-  if (fd_ed25519_verify( /* msg */ buf,
-                         /* sz  */ (ulong)((uchar*)ctx.data - buf),
-                         /* sig */ crd->signature.uc,
-                         /* public_key */ pubkey->uc,
-                         sha )) {
-    FD_LOG_DEBUG(("received crds_value with invalid signature"));
-    return;
-  }
+    return 0;
 
-  /* Perform the value hash to get the value table key */
-  ctx.data = buf;
-  ctx.dataend = buf + PACKET_DATA_SIZE;
+  /* Perform the value hash to get the value table key. The signed
+     message is the serialized data following the signature. */
+  fd_bincode_encode_ctx_t ctx;
+  ctx.data = pend->buf;
+  ctx.dataend = pend->buf + PACKET_DATA_SIZE;
   if ( fd_crds_value_encode( crd, &ctx ) ) {
     FD_LOG_ERR(("fd_crds_value_encode failed"));
-    return;
+    return 0;
   }
+  pend->datalen = (ulong)((uchar*)ctx.data - pend->buf);
   fd_sha256_t sha2[1];
   fd_sha256_init( sha2 );
-  ulong datalen = (ulong)((uchar*)ctx.data - buf);
-  fd_sha256_append( sha2, buf, datalen );
-  fd_hash_t key;
-  fd_sha256_fini( sha2, key.uc );
+  fd_sha256_append( sha2, pend->buf, pend->datalen );
+  fd_sha256_fini( sha2, pend->key.uc );
 
-  fd_value_elem_t * msg = fd_value_table_query(glob->values, &key, NULL);
-  if (msg != NULL) {
+  if (fd_value_table_query(glob->values, &pend->key, NULL) != NULL) {
     /* Already have this value */
-    glob->recv_dup_cnt++;
-    if (from != NULL) {
-      /* Record the dup in the receive statistics table */
-      fd_stats_elem_t * val = fd_stats_table_query(glob->stats, from, NULL);
-      if (val == NULL) {
-        if (!fd_stats_table_is_full(glob->stats)) {
-          val = fd_stats_table_insert(glob->stats, from);
-          val->dups_cnt = 0;
-        }
-      }
-      if (val != NULL) {
-        val->last = glob->now;
-        for (ulong i = 0; i < val->dups_cnt; ++i)
-          if (fd_hash_eq(&val->dups[i].origin, pubkey)) {
-            val->dups[i].cnt++;
-            goto found_origin;
-          }
-        if (val->dups_cnt < 8) {
-          ulong i = val->dups_cnt++;
-          fd_hash_copy(&val->dups[i].origin, pubkey);
-          val->dups[i].cnt = 1;
-        }
-        found_origin: ;
-      }
-    }
+    fd_gossip_recv_dup(glob, from, pubkey);
+    return 0;
+  }
+
+  pend->crd = crd;
+  pend->pubkey = pubkey;
+  pend->wallclock = wallclock;
+  return 1;
+}
+
+/* Process an incoming crds value with a valid signature */
+static void
+fd_gossip_recv_crds_value(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_crds_pending_t * pend) {
+  fd_crds_value_t * crd = pend->crd;
+  fd_pubkey_t * pubkey = pend->pubkey;
+  ulong wallclock = pend->wallclock;
+
+  /* Check again, the value might have arrived earlier in the same
+     batch or while the lock was released */
+  fd_value_elem_t * msg = fd_value_table_query(glob->values, &pend->key, NULL);
+  if (msg != NULL) {
+    fd_gossip_recv_dup(glob, from, pubkey);
     return;
   }
 
@@ -1148,18 +1219,18 @@ fd_gossip_recv_crds_value(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from
     FD_LOG_DEBUG(("too many values"));
     return;
   }
-  msg = fd_value_table_insert(glob->values, &key);
+  msg = fd_gossip_value_insert(glob, &pend->key);
   msg->wallclock = wallclock;
   fd_hash_copy(&msg->origin, pubkey);
 
   /* We store the serialized form for convenience */
-  fd_memcpy(msg->data, buf, datalen);
-  msg->datalen = datalen;
+  fd_memcpy(msg->data, pend->buf, pend->datalen);
+  msg->datalen = pend->datalen;
 
   if (glob->need_push_cnt < FD_NEED_PUSH_MAX) {
     /* Remember that I need to push this value */
     ulong i = ((glob->need_push_head + (glob->need_push_cnt++)) & (FD_NEED_PUSH_MAX-1U));
-    fd_hash_copy(glob->need_push + i, &key);
+    fd_hash_copy(glob->need_push + i, &pend->key);
   }
 
   if (crd->data.discriminant == fd_crds_data_enum_contact_info_v1) {
@@ -1203,6 +1274,45 @@ fd_gossip_recv_crds_value(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from
   fd_gossip_lock( glob );
 }
 
+/* Process the crds values of a push message or pull response. Values
+   are verified in batches. */
+static void
+fd_gossip_recv_crds_values(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_pubkey_t * pubkey, fd_crds_value_t * crds, ulong crds_len) {
+  fd_crds_pending_t pend[FD_ED25519_VERIFY_BATCH_MAX];
+  uchar const *     msgs[FD_ED25519_VERIFY_BATCH_MAX];
+  ulong             msg_szs[FD_ED25519_VERIFY_BATCH_MAX];
+  uchar const *     sigs[FD_ED25519_VERIFY_BATCH_MAX];
+  uchar const *     pubkeys[FD_ED25519_VERIFY_BATCH_MAX];
+  int               res[FD_ED25519_VERIFY_BATCH_MAX];
+
+  ulong i = 0;
+  while (i < crds_len) {
+    /* Gather a batch of values that need verification */
+    ulong cnt = 0;
+    for (; i < crds_len && cnt < FD_ED25519_VERIFY_BATCH_MAX; ++i) {
+      if (!fd_gossip_recv_crds_prepare(glob, from, pubkey, crds + i, pend + cnt))
+        continue;
+      msgs[cnt]    = pend[cnt].buf + sizeof(fd_signature_t);
+      msg_szs[cnt] = pend[cnt].datalen - sizeof(fd_signature_t);
+      sigs[cnt]    = pend[cnt].crd->signature.uc;
+      pubkeys[cnt] = pend[cnt].pubkey->uc;
+      cnt++;
+    }
+    if (cnt == 0)
+      break;
+
+    fd_ed25519_verify_batch_multi_msg(msgs, msg_szs, sigs, pubkeys, res, cnt);
+
+    for (ulong j = 0; j < cnt; ++j) {
+      if (res[j] != FD_ED25519_SUCCESS) {
+        FD_LOG_DEBUG(("received crds_value with invalid signature"));
+        continue;
+      }
+      fd_gossip_recv_crds_value(glob, from, pend + j);
+    }
+  }
+}
+
 /* Handle a prune request from somebody else */
 static void
 fd_gossip_handle_prune(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_gossip_prune_msg_t * msg) {
@@ -1283,13 +1393,13 @@ fd_gossip_push_updated_contact(fd_gossip_t * glob) {
     /* Remove the old contact value */
     fd_value_elem_t * ele = fd_value_table_query(glob->values, &glob->last_contact_info_key, NULL);
     if (ele != NULL) {
-      fd_value_table_remove( glob->values, &glob->last_contact_info_key );
+      fd_gossip_value_remove( glob, ele );
     }
 
     /* Remove the old version value */
     ele = fd_value_table_query(glob->values, &glob->last_contact_version_key, NULL);
     if (ele != NULL) {
-      fd_value_table_remove( glob->values, &glob->last_contact_version_key );
+      fd_gossip_value_remove( glob, ele );
     }
 
   }
@@ -1360,48 +1470,64 @@ fd_gossip_handle_pull_req(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from
   ulong hits = 0;
   ulong misses = 0;
   uint npackets = 0;
-  for( fd_value_table_iter_t iter = fd_value_table_iter_init( glob->values );
-       !fd_value_table_iter_done( glob->values, iter );
-       iter = fd_value_table_iter_next( glob->values, iter ) ) {
-    fd_value_elem_t * ele = fd_value_table_iter_ele( glob->values, iter );
-    fd_hash_t * hash = &(ele->key);
-    if (ele->wallclock < expire)
-      continue;
-    /* Execute the bloom filter */
-    if (filter->mask_bits != 0U) {
-      ulong m = (~0UL >> filter->mask_bits);
-      if ((hash->ul[0] | m) != filter->mask)
+  /* Only visit the shards whose hash prefix can match the mask */
+  uint mask_bits = filter->mask_bits;
+  ulong m = (mask_bits < 64U ? (~0UL >> mask_bits) : 0UL);
+  ulong shard_lo, shard_hi;
+  if (mask_bits == 0U) {
+    shard_lo = 0;
+    shard_hi = FD_VALUE_SHARD_CNT;
+  } else if (mask_bits <= FD_VALUE_SHARD_LG) {
+    shard_lo = (filter->mask >> (64U - mask_bits)) << (FD_VALUE_SHARD_LG - mask_bits);
+    shard_hi = shard_lo + (1UL << (FD_VALUE_SHARD_LG - mask_bits));
+  } else {
+    shard_lo = filter->mask >> (64U - FD_VALUE_SHARD_LG);
+    shard_hi = shard_lo + 1;
+  }
+  for( ulong shard = shard_lo; shard < shard_hi; ++shard ) {
+    fd_value_shard_t * shard_list = glob->value_shards + shard;
+    for( fd_value_shard_iter_t iter = fd_value_shard_iter_fwd_init( shard_list, glob->values );
+         !fd_value_shard_iter_done( iter, shard_list, glob->values );
+         iter = fd_value_shard_iter_fwd_next( iter, shard_list, glob->values ) ) {
+      fd_value_elem_t * ele = fd_value_shard_iter_ele( iter, shard_list, glob->values );
+      fd_hash_t * hash = &(ele->key);
+      if (ele->wallclock < expire)
         continue;
-    }
-    int miss = 0;
-    for (ulong i = 0; i < nkeys; ++i) {
-      ulong pos = fd_gossip_bloom_pos(hash, keys[i], bitvec->len);
-      ulong * j = bitvec2 + (pos>>6U); /* divide by 64 */
-      ulong bit = 1UL<<(pos & 63U);
-      if (!((*j) & bit)) {
-        miss = 1;
-        break;
+      /* Execute the bloom filter */
+      if (mask_bits != 0U) {
+        if ((hash->ul[0] | m) != filter->mask)
+          continue;
       }
+      int miss = 0;
+      for (ulong i = 0; i < nkeys; ++i) {
+        ulong pos = fd_gossip_bloom_pos(hash, keys[i], bitvec->len);
+        ulong * j = bitvec2 + (pos>>6U); /* divide by 64 */
+        ulong bit = 1UL<<(pos & 63U);
+        if (!((*j) & bit)) {
+          miss = 1;
+          break;
+        }
+      }
+      if (!miss) {
+        hits++;
+        continue;
+      }
+      misses++;
+      /* Add the value in already encoded form */
+      if (newend + ele->datalen - buf > PACKET_DATA_SIZE) {
+        /* Packet is getting too large. Flush it */
+        ulong sz = (ulong)(newend - buf);
+        fd_gossip_send_raw(glob, from, buf, sz);
+        char tmp[100];
+        FD_LOG_DEBUG(("sent msg type %d to %s size=%lu", gmsg.discriminant, fd_gossip_addr_str(tmp, sizeof(tmp), from), sz));
+        ++npackets;
+        newend = (uchar *)ctx.data;
+        *crds_len = 0;
+      }
+      fd_memcpy(newend, ele->data, ele->datalen);
+      newend += ele->datalen;
+      (*crds_len)++;
     }
-    if (!miss) {
-      hits++;
-      continue;
-    }
-    misses++;
-    /* Add the value in already encoded form */
-    if (newend + ele->datalen - buf > PACKET_DATA_SIZE) {
-      /* Packet is getting too large. Flush it */
-      ulong sz = (ulong)(newend - buf);
-      fd_gossip_send_raw(glob, from, buf, sz);
-      char tmp[100];
-      FD_LOG_DEBUG(("sent msg type %d to %s size=%lu", gmsg.discriminant, fd_gossip_addr_str(tmp, sizeof(tmp), from), sz));
-      ++npackets;
-      newend = (uchar *)ctx.data;
-      *crds_len = 0;
-    }
-    fd_memcpy(newend, ele->data, ele->datalen);
-    newend += ele->datalen;
-    (*crds_len)++;
   }
 
   /* Flush final packet */
@@ -1426,14 +1552,12 @@ fd_gossip_recv(fd_gossip_t * glob, const fd_gossip_peer_addr_t * from, fd_gossip
     break;
   case fd_gossip_msg_enum_pull_resp: {
     fd_gossip_pull_resp_t * pull_resp = &gmsg->inner.pull_resp;
-    for (ulong i = 0; i < pull_resp->crds_len; ++i)
-      fd_gossip_recv_crds_value(glob, NULL, &pull_resp->pubkey, pull_resp->crds + i);
+    fd_gossip_recv_crds_values(glob, NULL, &pull_resp->pubkey, pull_resp->crds, pull_resp->crds_len);
     break;
   }
   case fd_gossip_msg_enum_push_msg: {
     fd_gossip_push_msg_t * push_msg = &gmsg->inner.push_msg;
-    for (ulong i = 0; i < push_msg->crds_len; ++i)
-      fd_gossip_recv_crds_value(glob, from, &push_msg->pubkey, push_msg->crds + i);
+    fd_gossip_recv_crds_values(glob, from, &push_msg->pubkey, push_msg->crds, push_msg->crds_len);
     break;
   }
   case fd_gossip_msg_enum_prune_msg:
@@ -1662,7 +1786,7 @@ fd_gossip_push_value_nolock( fd_gossip_t * glob, fd_crds_data_t * data, fd_hash_
     FD_LOG_DEBUG(("too many values"));
     return -1;
   }
-  msg = fd_value_table_insert(glob->values, &key);
+  msg = fd_gossip_value_insert(glob, &key);
   msg->wallclock = FD_NANOSEC_TO_MILLI(glob->now); /* convert to ms */
   fd_hash_copy(&msg->origin, glob->public_key);
 
@@ -0,0 +1,277 @@
+/* Unit test and benchmark for gossip value handling.  Includes the
+   implementation to get at the value table internals. */
+
+#define FD_VALUE_KEY_MAX (1<<17)
+#include "fd_gossip.c"
+
+static ulong test_pkt_cnt;
+static ulong test_val_cnt;
+
+static void
+test_send( uchar const *                 msg,
+           size_t                        msglen,
+           fd_gossip_peer_addr_t const * addr,
+           void *                        arg ) {
+  (void)addr; (void)arg;
+  /* pull response: discriminant, pubkey, value count, values */
+  FD_TEST( msglen>=sizeof(uint)+sizeof(fd_pubkey_t)+sizeof(ulong) );
+  FD_TEST( msglen<=PACKET_DATA_SIZE );
+  FD_TEST( FD_LOAD( uint, msg )==fd_gossip_msg_enum_pull_resp );
+  test_pkt_cnt++;
+  test_val_cnt += FD_LOAD( ulong, msg+sizeof(uint)+sizeof(fd_pubkey_t) );
+}
+
+static uchar       test_private_key[32];
+static fd_pubkey_t test_public_key[1];
+
+static void
+test_sign( void *        ctx,
+           uchar *       sig,
+           uchar const * buffer,
+           ulong         len ) {
+  fd_sha512_t sha[1];
+  FD_TEST( fd_ed25519_sign( sig, buffer, len, test_public_key->uc, test_private_key, fd_sha512_join( fd_sha512_new( sha ) ) ) );
+  (void)ctx;
+}
+
+static ulong test_deliver_cnt;
+
+static void
+test_deliver( fd_crds_data_t * data,
+              void *           arg ) {
+  (void)arg;
+  FD_TEST( data->discriminant==fd_crds_data_enum_node_instance );
+  test_deliver_cnt++;
+}
+
+/* Count the values a pull request should be answered with by scanning
+   the whole table (the original implementation) */
+
+static ulong
+test_scan( fd_gossip_t * glob, fd_crds_filter_t * filter ) {
+  ulong expire = FD_NANOSEC_TO_MILLI(glob->now) - FD_GOSSIP_PULL_TIMEOUT;
+  ulong cnt = 0;
+  for( fd_value_table_iter_t iter = fd_value_table_iter_init( glob->values );
+       !fd_value_table_iter_done( glob->values, iter );
+       iter = fd_value_table_iter_next( glob->values, iter ) ) {
+    fd_value_elem_t * ele = fd_value_table_iter_ele( glob->values, iter );
+    fd_hash_t * hash = &(ele->key);
+    if (ele->wallclock < expire)
+      continue;
+    if (filter->mask_bits != 0U) {
+      ulong m = (~0UL >> filter->mask_bits);
+      if ((hash->ul[0] | m) != filter->mask)
+        continue;
+    }
+    int miss = 0;
+    for (ulong i = 0; i < filter->filter.keys_len; ++i) {
+      ulong pos = fd_gossip_bloom_pos(hash, filter->filter.keys[i], filter->filter.bits.len);
+      if (!(filter->filter.bits.bits.vec[pos>>6U] & (1UL<<(pos & 63U)))) {
+        miss = 1;
+        break;
+      }
+    }
+    cnt += (ulong)miss;
+  }
+  return cnt;
+}
+
+static void
+test_filter( fd_crds_filter_t * filter,
+             fd_rng_t *         rng,
+             uint               mask_bits ) {
+  filter->mask_bits = mask_bits;
+  filter->mask      = mask_bits ? (fd_rng_ulong( rng ) | (~0UL >> mask_bits)) : ~0UL;
+  for( ulong i=0UL; i<filter->filter.keys_len; i++ ) filter->filter.keys[i] = fd_rng_ulong( rng );
+  for( ulong i=0UL; i<filter->filter.bits.bits.vec_len; i++ ) filter->filter.bits.bits.vec[i] = fd_rng_ulong( rng ) | fd_rng_ulong( rng );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",   NULL, "gigantic"                 );
+  ulong        page_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt",  NULL, 1UL                        );
+  ulong        near_cpu  = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu",  NULL, fd_log_cpu_id()            );
+  ulong        value_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--value-cnt", NULL, 120000UL                   );
+  ulong        req_cnt   = fd_env_strip_cmdline_ulong( &argc, &argv, "--req-cnt",   NULL, 20000UL                    );
+  uint         mask_bits = fd_env_strip_cmdline_uint ( &argc, &argv, "--mask-bits", NULL, 7U                         );
+
+  if( FD_UNLIKELY( value_cnt>FD_VALUE_KEY_MAX ) ) FD_LOG_ERR(( "--value-cnt too large" ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-sz %s, --page-cnt %lu, --near-cpu %lu)", _page_sz, page_cnt, near_cpu ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  void * mem = fd_wksp_alloc_laddr( wksp, fd_gossip_align(), fd_gossip_footprint(), 1UL );
+  FD_TEST( mem );
+  fd_gossip_t * glob = fd_gossip_join( fd_gossip_new( mem, 42UL ) );
+  FD_TEST( glob );
+
+  fd_pubkey_t public_key[1]; memset( public_key, 0x11, sizeof(fd_pubkey_t) );
+  glob->public_key = public_key;
+  glob->send_fun   = test_send;
+  glob->now        = (long)1e18;
+
+  /* Requester must be an active peer with a pong */
+
+  fd_gossip_peer_addr_t from[1]; memset( from, 0, sizeof(fd_gossip_peer_addr_t) );
+  from->addr = 0x0100007fU; from->port = 8001;
+  fd_active_elem_t * active = fd_active_table_insert( glob->actives, from );
+  fd_active_new_value( active );
+  active->pongtime = glob->now;
+
+  /* Fill the value table, some values too old to be pulled */
+
+  ulong now_ms = FD_NANOSEC_TO_MILLI( glob->now );
+  for( ulong i=0UL; i<value_cnt; i++ ) {
+    fd_hash_t key[1];
+    for( ulong j=0UL; j<4UL; j++ ) key->ul[j] = fd_rng_ulong( rng );
+    FD_TEST( !fd_value_table_query( glob->values, key, NULL ) );
+    fd_value_elem_t * ele = fd_gossip_value_insert( glob, key );
+    ele->wallclock = (i%16UL) ? now_ms : now_ms - 2UL*FD_GOSSIP_PULL_TIMEOUT;
+    fd_hash_copy( &ele->origin, public_key );
+    ele->datalen = 64UL + (i%64UL);
+    memset( ele->data, (int)i, ele->datalen );
+  }
+  FD_TEST( fd_value_table_key_cnt( glob->values )==value_cnt );
+
+  /* Remove some values again, replaying the key sequence */
+
+  fd_rng_t _rng_replay[1]; fd_rng_t * rng_replay = fd_rng_join( fd_rng_new( _rng_replay, 0U, 0UL ) );
+  for( ulong i=0UL; i<value_cnt; i++ ) {
+    fd_hash_t key[1];
+    for( ulong j=0UL; j<4UL; j++ ) key->ul[j] = fd_rng_ulong( rng_replay );
+    if( i%8UL ) continue;
+    fd_value_elem_t * ele = fd_value_table_query( glob->values, key, NULL );
+    FD_TEST( ele );
+    fd_gossip_value_remove( glob, ele );
+  }
+  fd_rng_delete( fd_rng_leave( rng_replay ) );
+  value_cnt -= (value_cnt+7UL)/8UL;
+  FD_TEST( fd_value_table_key_cnt( glob->values )==value_cnt );
+
+  /* Every value is on the list of its shard */
+
+  ulong shard_cnt = 0UL;
+  for( ulong i=0UL; i<FD_VALUE_SHARD_CNT; i++ ) {
+    for( fd_value_shard_iter_t iter = fd_value_shard_iter_fwd_init( glob->value_shards+i, glob->values );
+         !fd_value_shard_iter_done( iter, glob->value_shards+i, glob->values );
+         iter = fd_value_shard_iter_fwd_next( iter, glob->value_shards+i, glob->values ) ) {
+      FD_TEST( fd_value_shard_idx( &fd_value_shard_iter_ele( iter, glob->value_shards+i, glob->values )->key )==i );
+      shard_cnt++;
+    }
+  }
+  FD_TEST( shard_cnt==value_cnt );
+
+  ulong keys[3];
+  ulong bits[ FD_BLOOM_NUM_BITS/64U ];
+  fd_gossip_pull_req_t req[1]; memset( req, 0, sizeof(fd_gossip_pull_req_t) );
+  fd_crds_filter_t * filter = &req->filter;
+  filter->filter.keys_len          = 3UL;
+  filter->filter.keys              = keys;
+  filter->filter.bits.has_bits     = 1;
+  filter->filter.bits.bits.vec_len = FD_BLOOM_NUM_BITS/64U;
+  filter->filter.bits.bits.vec     = bits;
+  filter->filter.bits.len          = FD_BLOOM_NUM_BITS;
+
+  /* Responses match a scan of the whole table for all mask sizes,
+     including masks finer and coarser than the shards */
+
+  fd_gossip_lock( glob );
+  for( uint b=0U; b<=FD_VALUE_SHARD_LG+4U; b++ ) {
+    for( ulong trial=0UL; trial<8UL; trial++ ) {
+      test_filter( filter, rng, b );
+      test_pkt_cnt = 0UL; test_val_cnt = 0UL;
+      fd_gossip_handle_pull_req( glob, from, req );
+      FD_TEST( test_val_cnt==test_scan( glob, filter ) );
+    }
+  }
+  fd_gossip_unlock( glob );
+
+  /* Benchmark */
+
+  FD_LOG_NOTICE(( "Benchmarking %lu pull requests against %lu values (--mask-bits %u)", req_cnt, value_cnt, mask_bits ));
+
+  test_pkt_cnt = 0UL; test_val_cnt = 0UL;
+  long dt = 0L;
+  fd_gossip_lock( glob );
+  for( ulong i=0UL; i<req_cnt; i++ ) {
+    test_filter( filter, rng, mask_bits );
+    dt -= fd_log_wallclock();
+    fd_gossip_handle_pull_req( glob, from, req );
+    dt += fd_log_wallclock();
+  }
+  fd_gossip_unlock( glob );
+  FD_LOG_NOTICE(( "indexed: %.3f us/req (%.0f req/s), %lu values in %lu packets",
+                  1e-3*(double)dt/(double)req_cnt, 1e9*(double)req_cnt/(double)dt, test_val_cnt, test_pkt_cnt ));
+
+  ulong scan_cnt = fd_ulong_max( req_cnt/16UL, 1UL );
+  ulong scan_val = 0UL;
+  dt = -fd_log_wallclock();
+  for( ulong i=0UL; i<scan_cnt; i++ ) {
+    test_filter( filter, rng, mask_bits );
+    scan_val += test_scan( glob, filter );
+  }
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "full scan (no packet assembly): %.3f us/req (%.0f req/s), %lu values",
+                  1e-3*(double)dt/(double)scan_cnt, 1e9*(double)scan_cnt/(double)dt, scan_val ));
+
+  /* Push messages: signatures are verified in batches, duplicates
+     (in the table or earlier in the same message) and bad signatures
+     are never delivered */
+
+# define TEST_PUSH_CNT (40UL)
+  fd_sha512_t _sha[1]; fd_sha512_t * sha = fd_sha512_join( fd_sha512_new( _sha ) );
+  for( ulong i=0UL; i<32UL; i++ ) test_private_key[i] = fd_rng_uchar( rng );
+  FD_TEST( fd_ed25519_public_from_private( test_public_key->uc, test_private_key, sha ) );
+  fd_sha512_delete( fd_sha512_leave( sha ) );
+
+  static fd_crds_value_t crds[ TEST_PUSH_CNT ];
+  glob->public_key = test_public_key;
+  glob->sign_fun   = test_sign;
+  for( ulong i=0UL; i<TEST_PUSH_CNT; i++ ) {
+    memset( crds+i, 0, sizeof(fd_crds_value_t) );
+    crds[i].data.discriminant = fd_crds_data_enum_node_instance;
+    crds[i].data.inner.node_instance.timestamp = (long)i;
+    crds[i].data.inner.node_instance.token     = fd_rng_ulong( rng );
+    fd_gossip_sign_crds_value( glob, crds+i );
+  }
+  glob->public_key = public_key;
+  crds[20].signature.uc[7] ^= (uchar)1;
+  crds[6]  = crds[5];
+  crds[30] = crds[3];
+
+  fd_gossip_msg_t gmsg[1];
+  fd_gossip_msg_new_disc( gmsg, fd_gossip_msg_enum_push_msg );
+  fd_hash_copy( &gmsg->inner.push_msg.pubkey, test_public_key );
+  gmsg->inner.push_msg.crds_len = TEST_PUSH_CNT;
+  gmsg->inner.push_msg.crds     = crds;
+  glob->deliver_fun = test_deliver;
+
+  ulong key_cnt = fd_value_table_key_cnt( glob->values );
+  fd_gossip_lock( glob );
+  test_deliver_cnt = 0UL; glob->recv_dup_cnt = 0UL;
+  fd_gossip_recv( glob, from, gmsg );
+  FD_TEST( test_deliver_cnt==TEST_PUSH_CNT-3UL );
+  FD_TEST( glob->recv_dup_cnt==2UL );
+  FD_TEST( fd_value_table_key_cnt( glob->values )==key_cnt+TEST_PUSH_CNT-3UL );
+
+  test_deliver_cnt = 0UL; glob->recv_dup_cnt = 0UL;
+  fd_gossip_recv( glob, from, gmsg );
+  FD_TEST( test_deliver_cnt==0UL );
+  FD_TEST( glob->recv_dup_cnt==TEST_PUSH_CNT-1UL );
+  fd_gossip_unlock( glob );
+# undef TEST_PUSH_CNT
+
+  fd_wksp_free_laddr( fd_gossip_delete( fd_gossip_leave( glob ) ) );
+  fd_wksp_delete_anonymous( wksp );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -2,14 +2,28 @@ ifdef FD_HAS_INT128
 $(call add-hdrs,fd_acc_mgr.h)
 $(call add-objs,fd_acc_mgr,fd_flamenco)
 
+$(call add-hdrs,fd_acc_owner_idx.h)
+$(call add-objs,fd_acc_owner_idx,fd_flamenco)
+$(call make-unit-test,test_acc_owner_idx,test_acc_owner_idx,fd_flamenco fd_funk fd_ballet fd_util)
+$(call run-unit-test,test_acc_owner_idx)
+
+$(call add-hdrs,fd_acc_token_idx.h)
+$(call add-objs,fd_acc_token_idx,fd_flamenco)
+$(call make-unit-test,test_acc_token_idx,test_acc_token_idx,fd_flamenco fd_funk fd_ballet fd_util)
+$(call run-unit-test,test_acc_token_idx)
+
 $(call add-hdrs,fd_account.h)
 $(call add-objs,fd_account,fd_flamenco)
 
 $(call add-hdrs,fd_bank_hash_cmp.h fd_readwrite_lock.h)
 $(call add-objs,fd_bank_hash_cmp,fd_flamenco)
 
-$(call add-hdrs,fd_blockstore.h fd_readwrite_lock.h)
-$(call add-objs,fd_blockstore,fd_flamenco)
+$(call add-hdrs,fd_blockstore.h fd_blockstore_archive.h fd_blockstore_sig_idx.h fd_readwrite_lock.h)
+$(call add-objs,fd_blockstore fd_blockstore_archive fd_blockstore_sig_idx,fd_flamenco)
+$(call make-unit-test,test_blockstore_archive,test_blockstore_archive,fd_flamenco fd_ballet fd_util)
+$(call run-unit-test,test_blockstore_archive)
+$(call make-unit-test,test_blockstore_sig_idx,test_blockstore_sig_idx,fd_flamenco fd_ballet fd_util)
+$(call run-unit-test,test_blockstore_sig_idx)
 
 $(call add-hdrs,fd_borrowed_account.h)
 $(call add-objs,fd_borrowed_account,fd_flamenco)
@@ -19,6 +33,8 @@ $(call add-objs,fd_executor,fd_flamenco)
 
 $(call add-hdrs,fd_hashes.h)
 $(call add-objs,fd_hashes,fd_flamenco)
+$(call make-unit-test,test_hashes,test_hashes,fd_flamenco fd_disco fd_funk fd_ballet fd_util)
+$(call run-unit-test,test_hashes)
 
 $(call add-hdrs,fd_pubkey_utils.h)
 $(call add-objs,fd_pubkey_utils,fd_flamenco)
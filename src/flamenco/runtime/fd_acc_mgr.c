@@ -1,4 +1,6 @@
 #include "fd_acc_mgr.h"
+#include "fd_acc_owner_idx.h"
+#include "fd_acc_token_idx.h"
 #include "../../ballet/base58/fd_base58.h"
 #include "context/fd_exec_epoch_ctx.h"
 #include "context/fd_exec_slot_ctx.h"
@@ -319,7 +321,10 @@ fd_acc_mgr_save_non_tpool( fd_acc_mgr_t *          acc_mgr,
   if( fd_funk_val_truncate( account->rec, reclen, fd_funk_alloc( acc_mgr->funk, wksp ), wksp, &err ) == NULL ) {
     FD_LOG_ERR(( "unable to allocate account value, err %d", err ));
   }
-  return fd_acc_mgr_save( acc_mgr, account );
+  err = fd_acc_mgr_save( acc_mgr, account );
+  if( acc_mgr->owner_idx ) fd_acc_owner_idx_update( acc_mgr->owner_idx, funk, rec );
+  if( acc_mgr->token_idx ) fd_acc_token_idx_update( acc_mgr->token_idx, funk, rec );
+  return err;
 }
 
 void
@@ -335,7 +340,8 @@ fd_acc_mgr_unlock( fd_acc_mgr_t * acc_mgr ) {
 }
 
 struct fd_acc_mgr_save_task_args {
-  fd_acc_mgr_t * acc_mgr;
+  fd_acc_mgr_t *  acc_mgr;
+  fd_funk_txn_t * txn;
 };
 typedef struct fd_acc_mgr_save_task_args fd_acc_mgr_save_task_args_t;
 
@@ -346,6 +352,11 @@ struct fd_acc_mgr_save_task_info {
 };
 typedef struct fd_acc_mgr_save_task_info fd_acc_mgr_save_task_info_t;
 
+/* fd_acc_mgr_save_task creates (if needed), sizes and writes the funk
+   records of one batch of accounts.  Batches are keyed by pubkey so
+   no two batches ever touch the same record, which is what makes the
+   concurrent funk insert below safe. */
+
 static void
 fd_acc_mgr_save_task( void *tpool,
                       ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
@@ -357,8 +368,27 @@ fd_acc_mgr_save_task( void *tpool,
   fd_acc_mgr_save_task_args_t * task_args = (fd_acc_mgr_save_task_args_t *)args;
   fd_acc_mgr_save_task_info_t * task_info = (fd_acc_mgr_save_task_info_t *)tpool + m0;
 
+  fd_acc_mgr_t * acc_mgr = task_args->acc_mgr;
+  fd_funk_t *    funk    = acc_mgr->funk;
+  fd_wksp_t *    wksp    = fd_funk_wksp( funk );
+
   for( ulong i = 0; i < task_info->accounts_cnt; i++ ) {
-    int err = fd_acc_mgr_save(task_args->acc_mgr,task_info->accounts[i] );
+    fd_borrowed_account_t * account = task_info->accounts[i];
+    fd_funk_rec_key_t key = fd_acc_funk_key( account->pubkey );
+    fd_funk_rec_t * rec = (fd_funk_rec_t *)fd_funk_rec_query( funk, task_args->txn, &key );
+    if( rec == NULL ) {
+      int err;
+      rec = (fd_funk_rec_t *)fd_funk_rec_insert_concur( funk, task_args->txn, &key, &err );
+      if( rec == NULL ) FD_LOG_ERR(( "unable to insert a new record, error %d", err ));
+    }
+    account->rec = rec;
+    ulong reclen = sizeof(fd_account_meta_t)+account->const_meta->dlen;
+    int err;
+    if( fd_funk_val_truncate( account->rec, reclen, fd_funk_alloc( funk, wksp ), wksp, &err ) == NULL ) {
+      FD_LOG_ERR(( "unable to allocate account value, err %d", err ));
+    }
+
+    err = fd_acc_mgr_save( acc_mgr, account );
     if( FD_UNLIKELY( err != FD_ACC_MGR_SUCCESS ) ) {
       task_info->result = err;
       return;
@@ -367,6 +397,12 @@ fd_acc_mgr_save_task( void *tpool,
   task_info->result = FD_ACC_MGR_SUCCESS;
 }
 
+static inline ulong
+fd_acc_mgr_save_batch_idx( fd_borrowed_account_t const * account,
+                           ulong                         batch_mask ) {
+  return fd_ulong_hash( account->pubkey->ul[0] ) & batch_mask;
+}
+
 int
 fd_acc_mgr_save_many_tpool( fd_acc_mgr_t *          acc_mgr,
                             fd_funk_txn_t *         txn,
@@ -388,9 +424,10 @@ fd_acc_mgr_save_many_tpool( fd_acc_mgr_t *          acc_mgr,
     ulong * batch_szs = fd_scratch_alloc( 8UL, batch_cnt * sizeof(ulong) );
     fd_memset( batch_szs, 0, batch_cnt * sizeof(ulong) );
 
-    /* Compute the batch sizes */
+    /* Compute the batch sizes.  Accounts are batched by pubkey such
+       that repeated pubkeys land in the same batch. */
     for( ulong i = 0; i < accounts_cnt; i++ ) {
-      ulong batch_idx = i & batch_mask;
+      ulong batch_idx = fd_acc_mgr_save_batch_idx( accounts[i], batch_mask );
       batch_szs[batch_idx]++;
     }
 
@@ -410,37 +447,47 @@ fd_acc_mgr_save_many_tpool( fd_acc_mgr_t *          acc_mgr,
       task_accounts_cursor += batch_sz;
     }
 
-    fd_funk_start_write( funk );
-
     for( ulong i = 0; i < accounts_cnt; i++ ) {
       fd_borrowed_account_t * account = accounts[i];
-      ulong batch_idx = i & batch_mask;
+      ulong batch_idx = fd_acc_mgr_save_batch_idx( account, batch_mask );
       fd_acc_mgr_save_task_info_t * task_info = &task_infos[batch_idx];
       task_info->accounts[task_info->accounts_cnt++] = account;
-      fd_funk_rec_key_t key = fd_acc_funk_key( account->pubkey );
-      fd_funk_rec_t * rec = (fd_funk_rec_t *)fd_funk_rec_query( funk, txn, &key );
-      if( rec == NULL ) {
-        int err;
-        rec = (fd_funk_rec_t *)fd_funk_rec_insert( funk, txn, &key, &err );
-        if( rec == NULL ) FD_LOG_ERR(( "unable to insert a new record, error %s", err ));
-      }
-      account->rec = rec;
-      if ( acc_mgr->slots_per_epoch != 0 )
-        fd_funk_part_set(funk, rec, (uint)fd_rent_lists_key_to_bucket( acc_mgr, rec ));
-      ulong reclen = sizeof(fd_account_meta_t)+account->const_meta->dlen;
-      int err;
-      if( fd_funk_val_truncate( account->rec, reclen, fd_funk_alloc( acc_mgr->funk, wksp ), wksp, &err ) == NULL ) {
-        FD_LOG_ERR(( "unable to allocate account value, err %d", err ));
-      }
     }
 
     fd_acc_mgr_save_task_args_t task_args = {
-      .acc_mgr = acc_mgr
+      .acc_mgr = acc_mgr,
+      .txn     = txn
     };
 
-    /* Save accounts in a thread pool */
+    fd_funk_start_write( funk );
+
+    /* Insert, size and save accounts in a thread pool */
     fd_tpool_exec_all_taskq( tpool, 0, max_workers, fd_acc_mgr_save_task, task_infos, &task_args, NULL, 1, 0, batch_cnt );
 
+    /* Partition membership and the owner and token indices are shared
+       linked lists and are updated serially once all records exist. */
+    if( acc_mgr->slots_per_epoch != 0 ) {
+      for( ulong i = 0; i < accounts_cnt; i++ ) {
+        fd_funk_rec_t * rec = accounts[i]->rec;
+        if( FD_UNLIKELY( !rec ) ) continue;
+        fd_funk_part_set( funk, rec, (uint)fd_rent_lists_key_to_bucket( acc_mgr, rec ) );
+      }
+    }
+    if( acc_mgr->owner_idx ) {
+      for( ulong i = 0; i < accounts_cnt; i++ ) {
+        fd_funk_rec_t * rec = accounts[i]->rec;
+        if( FD_UNLIKELY( !rec ) ) continue;
+        fd_acc_owner_idx_update( acc_mgr->owner_idx, funk, rec );
+      }
+    }
+    if( acc_mgr->token_idx ) {
+      for( ulong i = 0; i < accounts_cnt; i++ ) {
+        fd_funk_rec_t * rec = accounts[i]->rec;
+        if( FD_UNLIKELY( !rec ) ) continue;
+        fd_acc_token_idx_update( acc_mgr->token_idx, funk, rec );
+      }
+    }
+
     fd_funk_end_write( funk );
 
     /* Check results */
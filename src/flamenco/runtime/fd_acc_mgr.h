@@ -32,7 +32,18 @@
    "deleted accounts".
 
    The memory layout of the acc_mgr funk record data is
-   (fd_account_meta_t, padding, account data). */
+   (fd_account_meta_t, padding, account data).
+
+   ### Owner index
+
+   If owner_idx is set, accounts saved through fd_acc_mgr_save_non_tpool
+   and fd_acc_mgr_save_many_tpool are recorded in the account owner
+   index (see fd_acc_owner_idx.h).  Likewise, if token_idx is set, token
+   accounts are recorded in the token account index (see
+   fd_acc_token_idx.h). */
+
+typedef struct fd_acc_owner_idx fd_acc_owner_idx_t;
+typedef struct fd_acc_token_idx fd_acc_token_idx_t;
 
 struct __attribute__((aligned(16UL))) fd_acc_mgr {
   fd_funk_t * funk;
@@ -51,6 +62,9 @@ struct __attribute__((aligned(16UL))) fd_acc_mgr {
   uchar skip_rent_rewrites : 1;
 
   uint is_locked;
+
+  fd_acc_owner_idx_t * owner_idx; /* Optional account owner index, NULL if none */
+  fd_acc_token_idx_t * token_idx; /* Optional token account index, NULL if none */
 };
 
 /* FD_ACC_MGR_{ALIGN,FOOTPRINT} specify the parameters for the memory
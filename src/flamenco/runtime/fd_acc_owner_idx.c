@@ -0,0 +1,433 @@
+#include "fd_acc_owner_idx.h"
+
+/* Provide the actual map implementations */
+
+#define MAP_NAME              fd_acc_owner_idx_ele_map
+#define MAP_T                 fd_acc_owner_idx_ele_t
+#define MAP_KEY_T             fd_acc_owner_idx_key_t
+#define MAP_KEY_EQ(k0,k1)     (!memcmp( (k0), (k1), sizeof(fd_acc_owner_idx_key_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_acc_owner_idx_key_t) )
+#define MAP_KEY_COPY(kd,ks)   fd_memcpy( (kd), (ks), sizeof(fd_acc_owner_idx_key_t) )
+#define MAP_MAGIC             (0xf17eda2ce7a0e1e0UL) /* firedancer owner idx entries version 0 */
+#define MAP_IMPL_STYLE        2
+#include "../../util/tmpl/fd_map_giant.c"
+
+#define MAP_NAME              fd_acc_owner_idx_owner_map
+#define MAP_T                 fd_acc_owner_idx_owner_t
+#define MAP_KEY               owner
+#define MAP_KEY_T             fd_pubkey_t
+#define MAP_KEY_EQ(k0,k1)     (!memcmp( (k0), (k1), sizeof(fd_pubkey_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_pubkey_t) )
+#define MAP_KEY_COPY(kd,ks)   fd_memcpy( (kd), (ks), sizeof(fd_pubkey_t) )
+#define MAP_MAGIC             (0xf17eda2ce7a0e10eUL) /* firedancer owner idx owners version 0 */
+#define MAP_IMPL_STYLE        2
+#include "../../util/tmpl/fd_map_giant.c"
+
+ulong
+fd_acc_owner_idx_align( void ) {
+  return FD_ACC_OWNER_IDX_ALIGN;
+}
+
+ulong
+fd_acc_owner_idx_footprint( ulong ele_max,
+                            ulong owner_max ) {
+  if( FD_UNLIKELY( !ele_max || !owner_max ) ) return 0UL;
+  ulong ele_footprint   = fd_acc_owner_idx_ele_map_footprint( ele_max );
+  ulong owner_footprint = fd_acc_owner_idx_owner_map_footprint( owner_max );
+  if( FD_UNLIKELY( !ele_footprint || !owner_footprint ) ) return 0UL;
+  return FD_LAYOUT_FINI(
+    FD_LAYOUT_APPEND(
+    FD_LAYOUT_APPEND(
+    FD_LAYOUT_APPEND(
+    FD_LAYOUT_INIT,
+      alignof(fd_acc_owner_idx_t),               sizeof(fd_acc_owner_idx_t) ),
+      fd_acc_owner_idx_ele_map_align(),          ele_footprint ),
+      fd_acc_owner_idx_owner_map_align(),        owner_footprint ),
+    fd_acc_owner_idx_align() );
+}
+
+void *
+fd_acc_owner_idx_new( void * shmem,
+                      ulong  seed,
+                      ulong  ele_max,
+                      ulong  owner_max ) {
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_acc_owner_idx_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  ulong footprint = fd_acc_owner_idx_footprint( ele_max, owner_max );
+  if( FD_UNLIKELY( !footprint ) ) {
+    FD_LOG_WARNING(( "bad ele_max (%lu) or owner_max (%lu)", ele_max, owner_max ));
+    return NULL;
+  }
+
+  FD_SCRATCH_ALLOC_INIT( l, shmem );
+  fd_acc_owner_idx_t * idx = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_acc_owner_idx_t),       sizeof(fd_acc_owner_idx_t) );
+  void *         ele_shmem = FD_SCRATCH_ALLOC_APPEND( l, fd_acc_owner_idx_ele_map_align(),   fd_acc_owner_idx_ele_map_footprint( ele_max ) );
+  void *       owner_shmem = FD_SCRATCH_ALLOC_APPEND( l, fd_acc_owner_idx_owner_map_align(), fd_acc_owner_idx_owner_map_footprint( owner_max ) );
+  FD_SCRATCH_ALLOC_FINI( l, fd_acc_owner_idx_align() );
+
+  fd_memset( idx, 0, sizeof(fd_acc_owner_idx_t) );
+  idx->ele_max   = ele_max;
+  idx->owner_max = owner_max;
+  idx->ele_off   = (ulong)fd_acc_owner_idx_ele_map_join  ( fd_acc_owner_idx_ele_map_new  ( ele_shmem,   ele_max,   seed ) ) - (ulong)idx;
+  idx->owner_off = (ulong)fd_acc_owner_idx_owner_map_join( fd_acc_owner_idx_owner_map_new( owner_shmem, owner_max, seed ) ) - (ulong)idx;
+  idx->gc_iter   = 0UL;
+  idx->full      = 0;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( idx->magic ) = FD_ACC_OWNER_IDX_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_acc_owner_idx_t *
+fd_acc_owner_idx_join( void * shidx ) {
+  fd_acc_owner_idx_t * idx = (fd_acc_owner_idx_t *)shidx;
+
+  if( FD_UNLIKELY( !idx ) ) {
+    FD_LOG_WARNING(( "NULL shidx" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)idx, fd_acc_owner_idx_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shidx" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( idx->magic!=FD_ACC_OWNER_IDX_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return idx;
+}
+
+void *
+fd_acc_owner_idx_leave( fd_acc_owner_idx_t * idx ) {
+  if( FD_UNLIKELY( !idx ) ) {
+    FD_LOG_WARNING(( "NULL idx" ));
+    return NULL;
+  }
+  return (void *)idx;
+}
+
+void *
+fd_acc_owner_idx_delete( void * shidx ) {
+  fd_acc_owner_idx_t * idx = (fd_acc_owner_idx_t *)shidx;
+
+  if( FD_UNLIKELY( !idx ) ) {
+    FD_LOG_WARNING(( "NULL shidx" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( idx->magic!=FD_ACC_OWNER_IDX_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( idx->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shidx;
+}
+
+/* fd_acc_owner_idx_ele_idx converts between entry pointers and
+   indices into the entry map. */
+
+static inline ulong
+fd_acc_owner_idx_ele_idx( fd_acc_owner_idx_ele_t const * map,
+                          fd_acc_owner_idx_ele_t const * ele ) {
+  return (ulong)( ele - map );
+}
+
+static void
+fd_acc_owner_idx_remove( fd_acc_owner_idx_t *     idx,
+                         fd_acc_owner_idx_ele_t * ele ) {
+  fd_acc_owner_idx_ele_t *   ele_map   = fd_acc_owner_idx_ele_map( idx );
+  fd_acc_owner_idx_owner_t * owner_map = fd_acc_owner_idx_owner_map( idx );
+
+  fd_acc_owner_idx_owner_t * owner = fd_acc_owner_idx_owner_map_query( owner_map, &ele->key.owner, NULL );
+  if( FD_UNLIKELY( !owner ) ) FD_LOG_CRIT(( "memory corruption detected (entry without owner)" ));
+
+  ulong prev_idx = ele->prev_idx;
+  ulong next_idx = ele->next_idx;
+  if( prev_idx==FD_ACC_OWNER_IDX_IDX_NULL ) owner->head_idx             = next_idx;
+  else                                      ele_map[ prev_idx ].next_idx = next_idx;
+  if( next_idx!=FD_ACC_OWNER_IDX_IDX_NULL ) ele_map[ next_idx ].prev_idx = prev_idx;
+
+  if( !--owner->ele_cnt ) fd_acc_owner_idx_owner_map_remove( owner_map, &ele->key.owner );
+  fd_acc_owner_idx_ele_map_remove( ele_map, &ele->key );
+}
+
+int
+fd_acc_owner_idx_insert( fd_acc_owner_idx_t * idx,
+                         fd_pubkey_t const *  owner,
+                         fd_pubkey_t const *  acct,
+                         ulong                slot ) {
+  fd_acc_owner_idx_ele_t *   ele_map   = fd_acc_owner_idx_ele_map( idx );
+  fd_acc_owner_idx_owner_t * owner_map = fd_acc_owner_idx_owner_map( idx );
+
+  fd_acc_owner_idx_key_t key;
+  key.owner = *owner;
+  key.acct  = *acct;
+
+  /* Already indexed, the common case of an account being saved again */
+
+  fd_acc_owner_idx_ele_t * ele = fd_acc_owner_idx_ele_map_query( ele_map, &key, NULL );
+  if( FD_LIKELY( ele ) ) {
+    ele->slot = fd_ulong_max( ele->slot, slot );
+    return FD_ACC_OWNER_IDX_SUCCESS;
+  }
+
+  fd_acc_owner_idx_owner_t * owner_ele = fd_acc_owner_idx_owner_map_query( owner_map, owner, NULL );
+  if( FD_UNLIKELY( fd_acc_owner_idx_ele_map_is_full( ele_map ) ||
+                   ( !owner_ele && fd_acc_owner_idx_owner_map_is_full( owner_map ) ) ) ) {
+    if( !idx->full ) FD_LOG_WARNING(( "account owner index is full, owner queries will be incomplete" ));
+    idx->full = 1;
+    return FD_ACC_OWNER_IDX_ERR_FULL;
+  }
+
+  if( !owner_ele ) {
+    owner_ele           = fd_acc_owner_idx_owner_map_insert( owner_map, owner );
+    owner_ele->head_idx = FD_ACC_OWNER_IDX_IDX_NULL;
+    owner_ele->ele_cnt  = 0UL;
+  }
+
+  ele           = fd_acc_owner_idx_ele_map_insert( ele_map, &key );
+  ele->slot     = slot;
+  ele->prev_idx = FD_ACC_OWNER_IDX_IDX_NULL;
+  ele->next_idx = owner_ele->head_idx;
+
+  ulong ele_idx = fd_acc_owner_idx_ele_idx( ele_map, ele );
+  if( ele->next_idx!=FD_ACC_OWNER_IDX_IDX_NULL ) ele_map[ ele->next_idx ].prev_idx = ele_idx;
+  owner_ele->head_idx = ele_idx;
+  owner_ele->ele_cnt++;
+
+  return FD_ACC_OWNER_IDX_SUCCESS;
+}
+
+/* fd_acc_owner_idx_rec_meta returns the account meta of rec or NULL if
+   rec does not hold an existing account. */
+
+static fd_account_meta_t const *
+fd_acc_owner_idx_rec_meta( fd_funk_t *           funk,
+                           fd_funk_rec_t const * rec ) {
+  if( FD_UNLIKELY( !rec || ( rec->flags & FD_FUNK_REC_FLAG_ERASE ) ) ) return NULL;
+  if( FD_UNLIKELY( !fd_funk_key_is_acc( rec->pair.key ) ) ) return NULL;
+  if( FD_UNLIKELY( fd_funk_val_sz( rec )<sizeof(fd_account_meta_t) ) ) return NULL;
+  fd_account_meta_t const * meta = fd_funk_val_const( rec, fd_funk_wksp( funk ) );
+  if( FD_UNLIKELY( meta->magic!=FD_ACCOUNT_META_MAGIC || !fd_acc_exists( meta ) ) ) return NULL;
+  return meta;
+}
+
+int
+fd_acc_owner_idx_update( fd_acc_owner_idx_t *  idx,
+                         fd_funk_t *           funk,
+                         fd_funk_rec_t const * rec ) {
+  fd_account_meta_t const * meta = fd_acc_owner_idx_rec_meta( funk, rec );
+  if( !meta ) return FD_ACC_OWNER_IDX_SUCCESS;
+
+  /* Records of the last published txn are stored under the root xid */
+
+  fd_funk_txn_xid_t const * xid = rec->pair.xid;
+  ulong slot = fd_funk_txn_xid_eq_root( xid ) ? fd_funk_last_publish( funk )->ul[0] : xid->ul[0];
+
+  return fd_acc_owner_idx_insert( idx, (fd_pubkey_t const *)meta->info.owner, fd_funk_key_to_acc( rec->pair.key ), slot );
+}
+
+ulong
+fd_acc_owner_idx_gc( fd_acc_owner_idx_t * idx,
+                     fd_funk_t *          funk,
+                     ulong                root_slot,
+                     ulong                budget ) {
+  fd_acc_owner_idx_ele_t * ele_map = fd_acc_owner_idx_ele_map( idx );
+
+  budget = fd_ulong_min( budget, fd_acc_owner_idx_ele_map_key_cnt( ele_map ) ); /* visit each entry at most once */
+
+  ulong remove_cnt = 0UL;
+  fd_acc_owner_idx_ele_map_iter_t iter = idx->gc_iter;
+  for( ulong i=0UL; i<budget; i++ ) {
+    if( fd_acc_owner_idx_ele_map_iter_done( ele_map, iter ) ) {
+      iter = fd_acc_owner_idx_ele_map_iter_init( ele_map );
+      if( fd_acc_owner_idx_ele_map_iter_done( ele_map, iter ) ) break; /* empty */
+    }
+
+    fd_acc_owner_idx_ele_t * ele = fd_acc_owner_idx_ele_map_iter_ele( ele_map, iter );
+
+    /* The iterator walks the entry slots downward so it stays valid
+       when the current entry is removed. */
+
+    iter = fd_acc_owner_idx_ele_map_iter_next( ele_map, iter );
+
+    if( ele->slot>root_slot ) continue; /* a live fork can still have the owner */
+
+    fd_funk_rec_key_t         key  = fd_acc_funk_key( &ele->key.acct );
+    fd_account_meta_t const * meta = fd_acc_owner_idx_rec_meta( funk, fd_funk_rec_query( funk, NULL, &key ) );
+    if( meta && !memcmp( meta->info.owner, ele->key.owner.uc, sizeof(fd_pubkey_t) ) ) continue;
+
+    fd_acc_owner_idx_remove( idx, ele );
+    remove_cnt++;
+  }
+  idx->gc_iter = iter;
+
+  return remove_cnt;
+}
+
+ulong
+fd_acc_owner_idx_rebuild( fd_acc_owner_idx_t * idx,
+                          fd_funk_t *          funk ) {
+  fd_acc_owner_idx_ele_t *   ele_map   = fd_acc_owner_idx_ele_map( idx );
+  fd_acc_owner_idx_owner_t * owner_map = fd_acc_owner_idx_owner_map( idx );
+
+  /* Clear */
+
+  for( fd_acc_owner_idx_ele_map_iter_t iter = fd_acc_owner_idx_ele_map_iter_init( ele_map );
+       !fd_acc_owner_idx_ele_map_iter_done( ele_map, iter );
+       iter = fd_acc_owner_idx_ele_map_iter_next( ele_map, iter ) ) {
+    fd_acc_owner_idx_ele_map_remove( ele_map, &fd_acc_owner_idx_ele_map_iter_ele( ele_map, iter )->key );
+  }
+  for( fd_acc_owner_idx_owner_map_iter_t iter = fd_acc_owner_idx_owner_map_iter_init( owner_map );
+       !fd_acc_owner_idx_owner_map_iter_done( owner_map, iter );
+       iter = fd_acc_owner_idx_owner_map_iter_next( owner_map, iter ) ) {
+    fd_acc_owner_idx_owner_map_remove( owner_map, &fd_acc_owner_idx_owner_map_iter_ele( owner_map, iter )->owner );
+  }
+  idx->gc_iter = 0UL;
+  idx->full    = 0;
+
+  /* Index all account records */
+
+  fd_funk_rec_t * rec_map = fd_funk_rec_map( funk, fd_funk_wksp( funk ) );
+  for( fd_funk_rec_map_iter_t iter = fd_funk_rec_map_iter_init( rec_map );
+       !fd_funk_rec_map_iter_done( rec_map, iter );
+       iter = fd_funk_rec_map_iter_next( rec_map, iter ) ) {
+    if( FD_UNLIKELY( fd_acc_owner_idx_update( idx, funk, fd_funk_rec_map_iter_ele( rec_map, iter ) ) ) ) break;
+  }
+
+  return fd_acc_owner_idx_ele_cnt( idx );
+}
+
+ulong
+fd_acc_owner_idx_query( fd_acc_owner_idx_t *   idx,
+                        fd_funk_t *            funk,
+                        fd_funk_txn_t const *  txn,
+                        fd_pubkey_t const *    owner,
+                        fd_acc_owner_idx_cb_t  cb,
+                        void *                 arg ) {
+  fd_acc_owner_idx_ele_t *   ele_map   = fd_acc_owner_idx_ele_map( idx );
+  fd_acc_owner_idx_owner_t * owner_map = fd_acc_owner_idx_owner_map( idx );
+
+  fd_acc_owner_idx_owner_t const * owner_ele = fd_acc_owner_idx_owner_map_query_const( owner_map, owner, NULL );
+  if( !owner_ele ) return 0UL;
+
+  ulong cnt = 0UL;
+  for( ulong ele_idx = owner_ele->head_idx; ele_idx!=FD_ACC_OWNER_IDX_IDX_NULL; ele_idx = ele_map[ ele_idx ].next_idx ) {
+    fd_acc_owner_idx_ele_t const * ele = ele_map + ele_idx;
+
+    /* Check the candidate in the view of txn */
+
+    fd_funk_rec_key_t         key  = fd_acc_funk_key( &ele->key.acct );
+    fd_account_meta_t const * meta = fd_acc_owner_idx_rec_meta( funk, fd_funk_rec_query_global( funk, txn, &key ) );
+    if( !meta || memcmp( meta->info.owner, owner->uc, sizeof(fd_pubkey_t) ) ) continue;
+
+    cnt++;
+    if( cb( &ele->key.acct, meta, arg ) ) break;
+  }
+  return cnt;
+}
+
+ulong
+fd_acc_owner_idx_query_safe( fd_acc_owner_idx_t * idx,
+                             fd_funk_t *          funk,
+                             fd_pubkey_t const *  owner,
+                             fd_pubkey_t *        acct,
+                             ulong                acct_max ) {
+  fd_acc_owner_idx_ele_t const *   ele_map   = fd_acc_owner_idx_ele_map( idx );
+  fd_acc_owner_idx_owner_t const * owner_map = fd_acc_owner_idx_owner_map( idx );
+  ulong                            ele_max   = idx->ele_max;
+
+  for(;;) {
+    ulong lock_start;
+    for(;;) {
+      lock_start = funk->write_lock;
+      if( FD_LIKELY( !(lock_start&1UL) ) ) break;
+      /* Funk is currently write locked */
+      FD_SPIN_PAUSE();
+    }
+    FD_COMPILER_MFENCE();
+
+    /* The walk is bounded and bounds checked so a concurrent write
+       cannot make it run away, the result is discarded in that case. */
+
+    ulong cnt = 0UL;
+    fd_acc_owner_idx_owner_t const * owner_ele = fd_acc_owner_idx_owner_map_query_safe( owner_map, owner, NULL );
+    if( owner_ele ) {
+      ulong ele_idx = owner_ele->head_idx;
+      while( ele_idx<ele_max && cnt<=ele_max ) {
+        fd_acc_owner_idx_ele_t const * ele = ele_map + ele_idx;
+        if( cnt<acct_max ) acct[ cnt ] = ele->key.acct;
+        cnt++;
+        ele_idx = ele->next_idx;
+      }
+    }
+
+    FD_COMPILER_MFENCE();
+    if( lock_start==funk->write_lock ) return cnt;
+
+    /* else try again */
+    FD_SPIN_PAUSE();
+  }
+}
+
+int
+fd_acc_owner_idx_verify( fd_acc_owner_idx_t * idx ) {
+
+# define TEST(c) do {                                                      \
+    if( FD_UNLIKELY( !(c) ) ) { FD_LOG_WARNING(( "FAIL: %s", #c )); return -1; } \
+  } while(0)
+
+  TEST( idx );
+  TEST( idx->magic==FD_ACC_OWNER_IDX_MAGIC );
+
+  fd_acc_owner_idx_ele_t *   ele_map   = fd_acc_owner_idx_ele_map( idx );
+  fd_acc_owner_idx_owner_t * owner_map = fd_acc_owner_idx_owner_map( idx );
+  TEST( !fd_acc_owner_idx_ele_map_verify( ele_map ) );
+  TEST( !fd_acc_owner_idx_owner_map_verify( owner_map ) );
+
+  /* Every entry is on the list of its owner exactly once */
+
+  ulong ele_cnt = 0UL;
+  for( fd_acc_owner_idx_owner_map_iter_t iter = fd_acc_owner_idx_owner_map_iter_init( owner_map );
+       !fd_acc_owner_idx_owner_map_iter_done( owner_map, iter );
+       iter = fd_acc_owner_idx_owner_map_iter_next( owner_map, iter ) ) {
+    fd_acc_owner_idx_owner_t const * owner = fd_acc_owner_idx_owner_map_iter_ele_const( owner_map, iter );
+    ulong cnt  = 0UL;
+    ulong prev = FD_ACC_OWNER_IDX_IDX_NULL;
+    for( ulong ele_idx = owner->head_idx; ele_idx!=FD_ACC_OWNER_IDX_IDX_NULL; ele_idx = ele_map[ ele_idx ].next_idx ) {
+      TEST( ele_idx<idx->ele_max );
+      TEST( cnt<owner->ele_cnt );
+      fd_acc_owner_idx_ele_t const * ele = ele_map + ele_idx;
+      TEST( ele->prev_idx==prev );
+      TEST( !memcmp( ele->key.owner.uc, owner->owner.uc, sizeof(fd_pubkey_t) ) );
+      TEST( fd_acc_owner_idx_ele_map_query_const( ele_map, &ele->key, NULL )==ele );
+      prev = ele_idx;
+      cnt++;
+    }
+    TEST( cnt==owner->ele_cnt );
+    TEST( cnt );
+    ele_cnt += cnt;
+  }
+  TEST( ele_cnt==fd_acc_owner_idx_ele_map_key_cnt( ele_map ) );
+
+# undef TEST
+
+  return 0;
+}
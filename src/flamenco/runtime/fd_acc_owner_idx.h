@@ -0,0 +1,235 @@
+#ifndef HEADER_fd_src_flamenco_runtime_fd_acc_owner_idx_h
+#define HEADER_fd_src_flamenco_runtime_fd_acc_owner_idx_h
+
+/* fd_acc_owner_idx is a secondary index of the account database that
+   maps a program (account owner) to the accounts it owns.  It makes
+   owner scoped scans (e.g. getProgramAccounts) proportional to the
+   number of accounts of the program instead of the number of funk
+   records.
+
+   The index lives in the funk wksp and is maintained incrementally by
+   fd_acc_mgr when accounts are saved.  It holds (owner,account)
+   membership entries, each stamped with the highest slot in which the
+   account was saved with that owner.  Entries are never removed when
+   an account changes owner or is deleted because other forks may
+   still see the old owner.  Instead:
+
+   - Queries are fork aware by checking each candidate against the funk
+     txn tree (the account as seen by the queried txn must still have
+     the owner), so the index never needs to know about forks.
+
+   - Once the root passes the slot of an entry, the root view is
+     authoritative for it.  fd_acc_owner_idx_gc incrementally removes
+     such entries whose account no longer has the owner at the root.
+
+   Accounts written outside of fd_acc_mgr_save_{non_tpool,many_tpool}
+   (e.g. snapshot load) are picked up by fd_acc_owner_idx_rebuild.
+
+   The index is modified by a single writer that holds the funk write
+   lock (fd_funk_start_write).  Readers in other processes use
+   fd_acc_owner_idx_query_safe, which follows the funk write lock
+   protocol of fd_funk_rec_query_safe. */
+
+#include "fd_acc_mgr.h"
+
+/* FD_ACC_OWNER_IDX_{ALIGN,MAGIC} */
+
+#define FD_ACC_OWNER_IDX_ALIGN (128UL)
+#define FD_ACC_OWNER_IDX_MAGIC (0xf17eda2ce7a0e100UL) /* firedancer owner idx version 0 */
+
+/* FD_ACC_OWNER_IDX_{SUCCESS,ERR_FULL} are error codes. */
+
+#define FD_ACC_OWNER_IDX_SUCCESS  (0)
+#define FD_ACC_OWNER_IDX_ERR_FULL (-1)
+
+/* An index entry.  Entries of the same owner are linked in a doubly
+   linked list headed by the owner entry. */
+
+struct fd_acc_owner_idx_key {
+  fd_pubkey_t owner;
+  fd_pubkey_t acct;
+};
+typedef struct fd_acc_owner_idx_key fd_acc_owner_idx_key_t;
+
+struct fd_acc_owner_idx_ele {
+  fd_acc_owner_idx_key_t key;
+  ulong                  next;     /* Internal use by map */
+  ulong                  prev_idx; /* Previous entry of the owner, IDX_NULL if head */
+  ulong                  next_idx; /* Next entry of the owner, IDX_NULL if tail */
+  ulong                  slot;     /* Highest slot the account was saved in with this owner */
+};
+typedef struct fd_acc_owner_idx_ele fd_acc_owner_idx_ele_t;
+
+struct fd_acc_owner_idx_owner {
+  fd_pubkey_t owner;
+  ulong       next;     /* Internal use by map */
+  ulong       head_idx; /* First entry of the owner */
+  ulong       ele_cnt;  /* Number of entries of the owner */
+};
+typedef struct fd_acc_owner_idx_owner fd_acc_owner_idx_owner_t;
+
+#define MAP_NAME              fd_acc_owner_idx_ele_map
+#define MAP_T                 fd_acc_owner_idx_ele_t
+#define MAP_KEY_T             fd_acc_owner_idx_key_t
+#define MAP_KEY_EQ(k0,k1)     (!memcmp( (k0), (k1), sizeof(fd_acc_owner_idx_key_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_acc_owner_idx_key_t) )
+#define MAP_KEY_COPY(kd,ks)   fd_memcpy( (kd), (ks), sizeof(fd_acc_owner_idx_key_t) )
+#define MAP_MAGIC             (0xf17eda2ce7a0e1e0UL) /* firedancer owner idx entries version 0 */
+#define MAP_IMPL_STYLE        1
+#include "../../util/tmpl/fd_map_giant.c"
+
+#define MAP_NAME              fd_acc_owner_idx_owner_map
+#define MAP_T                 fd_acc_owner_idx_owner_t
+#define MAP_KEY               owner
+#define MAP_KEY_T             fd_pubkey_t
+#define MAP_KEY_EQ(k0,k1)     (!memcmp( (k0), (k1), sizeof(fd_pubkey_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_pubkey_t) )
+#define MAP_KEY_COPY(kd,ks)   fd_memcpy( (kd), (ks), sizeof(fd_pubkey_t) )
+#define MAP_MAGIC             (0xf17eda2ce7a0e10eUL) /* firedancer owner idx owners version 0 */
+#define MAP_IMPL_STYLE        1
+#include "../../util/tmpl/fd_map_giant.c"
+
+#define FD_ACC_OWNER_IDX_IDX_NULL (ULONG_MAX)
+
+struct __attribute__((aligned(FD_ACC_OWNER_IDX_ALIGN))) fd_acc_owner_idx {
+  ulong magic;     /* ==FD_ACC_OWNER_IDX_MAGIC */
+  ulong ele_max;
+  ulong owner_max;
+  ulong ele_off;   /* Offset of the entry map join from the start of the index */
+  ulong owner_off; /* Offset of the owner map join from the start of the index */
+  ulong gc_iter;   /* Position of the incremental gc in the entry map */
+  int   full;      /* Warned about running out of space */
+};
+/* fd_acc_owner_idx_t is typedef'd in fd_acc_mgr.h */
+
+FD_PROTOTYPES_BEGIN
+
+/* Constructors */
+
+FD_FN_CONST ulong
+fd_acc_owner_idx_align( void );
+
+FD_FN_CONST ulong
+fd_acc_owner_idx_footprint( ulong ele_max,
+                            ulong owner_max );
+
+/* fd_acc_owner_idx_new formats shmem as an owner index for up to
+   ele_max (owner,account) entries and owner_max distinct owners.  The
+   usual new/join/leave/delete semantics apply.  The index is position
+   independent and can be joined from any process that maps its wksp. */
+
+void *
+fd_acc_owner_idx_new( void * shmem,
+                      ulong  seed,
+                      ulong  ele_max,
+                      ulong  owner_max );
+
+fd_acc_owner_idx_t *
+fd_acc_owner_idx_join( void * shidx );
+
+void *
+fd_acc_owner_idx_leave( fd_acc_owner_idx_t * idx );
+
+void *
+fd_acc_owner_idx_delete( void * shidx );
+
+/* Accessors */
+
+FD_FN_PURE static inline fd_acc_owner_idx_ele_t *
+fd_acc_owner_idx_ele_map( fd_acc_owner_idx_t * idx ) {
+  return (fd_acc_owner_idx_ele_t *)( (ulong)idx + idx->ele_off );
+}
+
+FD_FN_PURE static inline fd_acc_owner_idx_owner_t *
+fd_acc_owner_idx_owner_map( fd_acc_owner_idx_t * idx ) {
+  return (fd_acc_owner_idx_owner_t *)( (ulong)idx + idx->owner_off );
+}
+
+FD_FN_PURE static inline ulong
+fd_acc_owner_idx_ele_cnt( fd_acc_owner_idx_t * idx ) {
+  return fd_acc_owner_idx_ele_map_key_cnt( fd_acc_owner_idx_ele_map( idx ) );
+}
+
+/* Writer API.  Caller holds the funk write lock. */
+
+/* fd_acc_owner_idx_insert records that acct was saved with owner in
+   slot.  Returns FD_ACC_OWNER_IDX_SUCCESS or FD_ACC_OWNER_IDX_ERR_FULL
+   if the index is out of space (warns once). */
+
+int
+fd_acc_owner_idx_insert( fd_acc_owner_idx_t * idx,
+                         fd_pubkey_t const *  owner,
+                         fd_pubkey_t const *  acct,
+                         ulong                slot );
+
+/* fd_acc_owner_idx_update records the account saved in funk record rec
+   (which must hold an account).  Deleted accounts are ignored. */
+
+int
+fd_acc_owner_idx_update( fd_acc_owner_idx_t *  idx,
+                         fd_funk_t *           funk,
+                         fd_funk_rec_t const * rec );
+
+/* fd_acc_owner_idx_gc visits the next up to budget entries of the index
+   (wrapping around, each entry at most once per call) and removes the
+   entries with a slot at or below root_slot whose account no longer
+   exists or has a different owner in the last published txn.  Call
+   after publishing the funk.  Returns the number of entries removed. */
+
+ulong
+fd_acc_owner_idx_gc( fd_acc_owner_idx_t * idx,
+                     fd_funk_t *          funk,
+                     ulong                root_slot,
+                     ulong                budget );
+
+/* fd_acc_owner_idx_rebuild clears idx and indexes every account record
+   of funk, including those of in-preparation txns.  Returns the number
+   of entries. */
+
+ulong
+fd_acc_owner_idx_rebuild( fd_acc_owner_idx_t * idx,
+                          fd_funk_t *          funk );
+
+/* Reader API */
+
+/* fd_acc_owner_idx_query calls cb for each account that has owner as
+   seen by funk txn txn (NULL for the last published txn), with meta
+   the account as seen by txn.  Iteration stops early if cb returns
+   non-zero.  Returns the number of cb calls.  Caller is the writer or
+   otherwise guarantees funk and idx are not concurrently modified. */
+
+typedef int (*fd_acc_owner_idx_cb_t)( fd_pubkey_t const *       acct,
+                                      fd_account_meta_t const * meta,
+                                      void *                    arg );
+
+ulong
+fd_acc_owner_idx_query( fd_acc_owner_idx_t *   idx,
+                        fd_funk_t *            funk,
+                        fd_funk_txn_t const *  txn,
+                        fd_pubkey_t const *    owner,
+                        fd_acc_owner_idx_cb_t  cb,
+                        void *                 arg );
+
+/* fd_acc_owner_idx_query_safe copies up to acct_max candidate accounts
+   of owner into acct and returns the number of candidates (which can
+   be more than acct_max).  Safe to call concurrently with the writer.
+   Candidates are a superset of the accounts of owner, the caller must
+   check the owner of each candidate in its own view of the funk (e.g.
+   with fd_funk_rec_query_safe). */
+
+ulong
+fd_acc_owner_idx_query_safe( fd_acc_owner_idx_t * idx,
+                             fd_funk_t *          funk,
+                             fd_pubkey_t const *  owner,
+                             fd_pubkey_t *        acct,
+                             ulong                acct_max );
+
+/* fd_acc_owner_idx_verify checks the integrity of the index.  Returns 0
+   on success and -1 on failure (logs details). */
+
+int
+fd_acc_owner_idx_verify( fd_acc_owner_idx_t * idx );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_flamenco_runtime_fd_acc_owner_idx_h */
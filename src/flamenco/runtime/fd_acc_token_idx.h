@@ -0,0 +1,349 @@
+#ifndef HEADER_fd_src_flamenco_runtime_fd_acc_token_idx_h
+#define HEADER_fd_src_flamenco_runtime_fd_acc_token_idx_h
+
+/* fd_acc_token_idx is a secondary index of the account database that
+   maps a token owner, delegate or mint to the SPL Token (and Token-2022)
+   accounts that reference it.  It serves the token scoped RPC queries
+   (getTokenAccountsByOwner, getTokenAccountsByDelegate,
+   getTokenLargestAccounts) without scanning the funk.
+
+   The index follows the design of fd_acc_owner_idx.  It lives in the
+   funk wksp and is maintained by fd_acc_mgr when accounts are saved.
+   The fields are read directly from the token account layout in the
+   funk value.  Each (kind,key,account) entry is stamped with the
+   highest slot in which the account was saved with that key, and:
+
+   - Queries check each candidate against the funk txn tree (the token
+     account as seen by the queried txn must still have the key), so
+     the index never needs to know about forks.
+
+   - fd_acc_token_idx_gc incrementally removes entries at or below the
+     root whose account no longer has the key at the root.
+
+   Accounts written outside of fd_acc_mgr_save_{non_tpool,many_tpool}
+   (e.g. snapshot load) are picked up by fd_acc_token_idx_rebuild.
+
+   The index is modified by a single writer that holds the funk write
+   lock (fd_funk_start_write).  Readers in other processes use
+   fd_acc_token_idx_query_safe, which follows the funk write lock
+   protocol of fd_funk_rec_query_safe. */
+
+#include "fd_acc_mgr.h"
+#include "fd_system_ids.h"
+
+/* FD_ACC_TOKEN_IDX_{ALIGN,MAGIC} */
+
+#define FD_ACC_TOKEN_IDX_ALIGN (128UL)
+#define FD_ACC_TOKEN_IDX_MAGIC (0xf17eda2ce7a0c100UL) /* firedancer token idx version 0 */
+
+/* FD_ACC_TOKEN_IDX_{SUCCESS,ERR_FULL} are error codes. */
+
+#define FD_ACC_TOKEN_IDX_SUCCESS  (0)
+#define FD_ACC_TOKEN_IDX_ERR_FULL (-1)
+
+/* FD_ACC_TOKEN_IDX_KIND_* are the token account fields that are
+   indexed. */
+
+#define FD_ACC_TOKEN_IDX_KIND_OWNER    (0UL)
+#define FD_ACC_TOKEN_IDX_KIND_DELEGATE (1UL)
+#define FD_ACC_TOKEN_IDX_KIND_MINT     (2UL)
+#define FD_ACC_TOKEN_IDX_KIND_CNT      (3UL)
+
+/* SPL Token account and mint layouts.  Token-2022 accounts and mints
+   with extensions are longer than the base layout and have an account
+   type byte right after the base token account layout. */
+
+#define FD_TOKEN_ACCT_SZ                (165UL)
+#define FD_TOKEN_ACCT_MINT_OFF          (0UL)
+#define FD_TOKEN_ACCT_OWNER_OFF         (32UL)
+#define FD_TOKEN_ACCT_AMOUNT_OFF        (64UL)
+#define FD_TOKEN_ACCT_DELEGATE_TAG_OFF  (72UL)  /* COption<Pubkey> */
+#define FD_TOKEN_ACCT_DELEGATE_OFF      (76UL)
+#define FD_TOKEN_ACCT_STATE_OFF         (108UL) /* 0 is uninitialized */
+#define FD_TOKEN_ACCT_TYPE_OFF          (165UL) /* Token-2022 only */
+
+#define FD_TOKEN_MINT_SZ                (82UL)
+#define FD_TOKEN_MINT_SUPPLY_OFF        (36UL)
+#define FD_TOKEN_MINT_DECIMALS_OFF      (44UL)
+#define FD_TOKEN_MINT_IS_INITIALIZED_OFF (45UL)
+
+#define FD_TOKEN_ACCT_TYPE_MINT    (1)
+#define FD_TOKEN_ACCT_TYPE_ACCOUNT (2)
+
+/* An index entry.  Entries of the same (kind,key) are linked in a
+   doubly linked list headed by the list entry. */
+
+struct fd_acc_token_idx_key {
+  fd_pubkey_t key;
+  fd_pubkey_t acct;
+  ulong       kind;
+};
+typedef struct fd_acc_token_idx_key fd_acc_token_idx_key_t;
+
+struct fd_acc_token_idx_ele {
+  fd_acc_token_idx_key_t key;
+  ulong                  next;     /* Internal use by map */
+  ulong                  prev_idx; /* Previous entry of the list, IDX_NULL if head */
+  ulong                  next_idx; /* Next entry of the list, IDX_NULL if tail */
+  ulong                  slot;     /* Highest slot the account was saved in with this key */
+};
+typedef struct fd_acc_token_idx_ele fd_acc_token_idx_ele_t;
+
+struct fd_acc_token_idx_list_key {
+  fd_pubkey_t key;
+  ulong       kind;
+};
+typedef struct fd_acc_token_idx_list_key fd_acc_token_idx_list_key_t;
+
+struct fd_acc_token_idx_list {
+  fd_acc_token_idx_list_key_t key;
+  ulong                       next;     /* Internal use by map */
+  ulong                       head_idx; /* First entry of the list */
+  ulong                       ele_cnt;  /* Number of entries of the list */
+};
+typedef struct fd_acc_token_idx_list fd_acc_token_idx_list_t;
+
+#define MAP_NAME              fd_acc_token_idx_ele_map
+#define MAP_T                 fd_acc_token_idx_ele_t
+#define MAP_KEY_T             fd_acc_token_idx_key_t
+#define MAP_KEY_EQ(k0,k1)     (!memcmp( (k0), (k1), sizeof(fd_acc_token_idx_key_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_acc_token_idx_key_t) )
+#define MAP_KEY_COPY(kd,ks)   fd_memcpy( (kd), (ks), sizeof(fd_acc_token_idx_key_t) )
+#define MAP_MAGIC             (0xf17eda2ce7a0c1e0UL) /* firedancer token idx entries version 0 */
+#define MAP_IMPL_STYLE        1
+#include "../../util/tmpl/fd_map_giant.c"
+
+#define MAP_NAME              fd_acc_token_idx_list_map
+#define MAP_T                 fd_acc_token_idx_list_t
+#define MAP_KEY_T             fd_acc_token_idx_list_key_t
+#define MAP_KEY_EQ(k0,k1)     (!memcmp( (k0), (k1), sizeof(fd_acc_token_idx_list_key_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_acc_token_idx_list_key_t) )
+#define MAP_KEY_COPY(kd,ks)   fd_memcpy( (kd), (ks), sizeof(fd_acc_token_idx_list_key_t) )
+#define MAP_MAGIC             (0xf17eda2ce7a0c11eUL) /* firedancer token idx lists version 0 */
+#define MAP_IMPL_STYLE        1
+#include "../../util/tmpl/fd_map_giant.c"
+
+#define FD_ACC_TOKEN_IDX_IDX_NULL (ULONG_MAX)
+
+struct __attribute__((aligned(FD_ACC_TOKEN_IDX_ALIGN))) fd_acc_token_idx {
+  ulong magic;    /* ==FD_ACC_TOKEN_IDX_MAGIC */
+  ulong ele_max;
+  ulong list_max;
+  ulong ele_off;  /* Offset of the entry map join from the start of the index */
+  ulong list_off; /* Offset of the list map join from the start of the index */
+  ulong gc_iter;  /* Position of the incremental gc in the entry map */
+  int   full;     /* Warned about running out of space */
+};
+/* fd_acc_token_idx_t is typedef'd in fd_acc_mgr.h */
+
+FD_PROTOTYPES_BEGIN
+
+/* Token account layout accessors */
+
+/* fd_token_program_is_owner returns 1 if owner is the SPL Token or the
+   Token-2022 program and 0 otherwise. */
+
+FD_FN_PURE static inline int
+fd_token_program_is_owner( uchar const * owner ) {
+  return !memcmp( owner, fd_solana_spl_token_id.uc,      sizeof(fd_pubkey_t) ) ||
+         !memcmp( owner, fd_solana_spl_token_2022_id.uc, sizeof(fd_pubkey_t) );
+}
+
+/* fd_token_acct_data returns the data of the account meta if it is an
+   initialized token account and NULL otherwise. */
+
+FD_FN_PURE static inline uchar const *
+fd_token_acct_data( fd_account_meta_t const * meta ) {
+  if( FD_UNLIKELY( !fd_token_program_is_owner( meta->info.owner ) ) ) return NULL;
+  uchar const * data = (uchar const *)meta + meta->hlen;
+  if( meta->dlen!=FD_TOKEN_ACCT_SZ &&
+      ( meta->dlen<=FD_TOKEN_ACCT_SZ || data[ FD_TOKEN_ACCT_TYPE_OFF ]!=FD_TOKEN_ACCT_TYPE_ACCOUNT ) ) return NULL;
+  if( FD_UNLIKELY( !data[ FD_TOKEN_ACCT_STATE_OFF ] ) ) return NULL;
+  return data;
+}
+
+/* fd_token_mint_data returns the data of the account meta if it is an
+   initialized token mint and NULL otherwise. */
+
+FD_FN_PURE static inline uchar const *
+fd_token_mint_data( fd_account_meta_t const * meta ) {
+  if( FD_UNLIKELY( !fd_token_program_is_owner( meta->info.owner ) ) ) return NULL;
+  uchar const * data = (uchar const *)meta + meta->hlen;
+  if( meta->dlen!=FD_TOKEN_MINT_SZ &&
+      ( meta->dlen<=FD_TOKEN_ACCT_SZ || data[ FD_TOKEN_ACCT_TYPE_OFF ]!=FD_TOKEN_ACCT_TYPE_MINT ) ) return NULL;
+  if( FD_UNLIKELY( !data[ FD_TOKEN_MINT_IS_INITIALIZED_OFF ] ) ) return NULL;
+  return data;
+}
+
+/* fd_token_acct_key returns the key of kind of the token account data
+   (as returned by fd_token_acct_data) or NULL if the account has no
+   key of that kind (i.e. no delegate). */
+
+FD_FN_PURE static inline fd_pubkey_t const *
+fd_token_acct_key( uchar const * data,
+                   ulong         kind ) {
+  switch( kind ) {
+  case FD_ACC_TOKEN_IDX_KIND_OWNER:
+    return (fd_pubkey_t const *)( data + FD_TOKEN_ACCT_OWNER_OFF );
+  case FD_ACC_TOKEN_IDX_KIND_DELEGATE:
+    if( FD_LOAD( uint, data + FD_TOKEN_ACCT_DELEGATE_TAG_OFF )!=1U ) return NULL;
+    return (fd_pubkey_t const *)( data + FD_TOKEN_ACCT_DELEGATE_OFF );
+  case FD_ACC_TOKEN_IDX_KIND_MINT:
+    return (fd_pubkey_t const *)( data + FD_TOKEN_ACCT_MINT_OFF );
+  default:
+    return NULL;
+  }
+}
+
+FD_FN_PURE static inline ulong
+fd_token_acct_amount( uchar const * data ) {
+  return FD_LOAD( ulong, data + FD_TOKEN_ACCT_AMOUNT_OFF );
+}
+
+FD_FN_PURE static inline ulong
+fd_token_mint_supply( uchar const * data ) {
+  return FD_LOAD( ulong, data + FD_TOKEN_MINT_SUPPLY_OFF );
+}
+
+FD_FN_PURE static inline uint
+fd_token_mint_decimals( uchar const * data ) {
+  return (uint)data[ FD_TOKEN_MINT_DECIMALS_OFF ];
+}
+
+/* Constructors */
+
+FD_FN_CONST ulong
+fd_acc_token_idx_align( void );
+
+FD_FN_CONST ulong
+fd_acc_token_idx_footprint( ulong ele_max,
+                            ulong list_max );
+
+/* fd_acc_token_idx_new formats shmem as a token index for up to
+   ele_max (kind,key,account) entries and list_max distinct (kind,key)
+   pairs.  The usual new/join/leave/delete semantics apply.  The index
+   is position independent and can be joined from any process that maps
+   its wksp. */
+
+void *
+fd_acc_token_idx_new( void * shmem,
+                      ulong  seed,
+                      ulong  ele_max,
+                      ulong  list_max );
+
+fd_acc_token_idx_t *
+fd_acc_token_idx_join( void * shidx );
+
+void *
+fd_acc_token_idx_leave( fd_acc_token_idx_t * idx );
+
+void *
+fd_acc_token_idx_delete( void * shidx );
+
+/* Accessors */
+
+FD_FN_PURE static inline fd_acc_token_idx_ele_t *
+fd_acc_token_idx_ele_map( fd_acc_token_idx_t * idx ) {
+  return (fd_acc_token_idx_ele_t *)( (ulong)idx + idx->ele_off );
+}
+
+FD_FN_PURE static inline fd_acc_token_idx_list_t *
+fd_acc_token_idx_list_map( fd_acc_token_idx_t * idx ) {
+  return (fd_acc_token_idx_list_t *)( (ulong)idx + idx->list_off );
+}
+
+FD_FN_PURE static inline ulong
+fd_acc_token_idx_ele_cnt( fd_acc_token_idx_t * idx ) {
+  return fd_acc_token_idx_ele_map_key_cnt( fd_acc_token_idx_ele_map( idx ) );
+}
+
+/* Writer API.  Caller holds the funk write lock. */
+
+/* fd_acc_token_idx_insert records that token account acct was saved
+   with key of kind in slot.  Returns FD_ACC_TOKEN_IDX_SUCCESS or
+   FD_ACC_TOKEN_IDX_ERR_FULL if the index is out of space (warns
+   once). */
+
+int
+fd_acc_token_idx_insert( fd_acc_token_idx_t * idx,
+                         ulong                kind,
+                         fd_pubkey_t const *  key,
+                         fd_pubkey_t const *  acct,
+                         ulong                slot );
+
+/* fd_acc_token_idx_update records the account saved in funk record rec
+   (which must hold an account).  Deleted accounts and accounts that
+   are not initialized token accounts are ignored. */
+
+int
+fd_acc_token_idx_update( fd_acc_token_idx_t *  idx,
+                         fd_funk_t *           funk,
+                         fd_funk_rec_t const * rec );
+
+/* fd_acc_token_idx_gc visits the next up to budget entries of the index
+   (wrapping around, each entry at most once per call) and removes the
+   entries with a slot at or below root_slot whose account no longer is
+   a token account with the key in the last published txn.  Call after
+   publishing the funk.  Returns the number of entries removed. */
+
+ulong
+fd_acc_token_idx_gc( fd_acc_token_idx_t * idx,
+                     fd_funk_t *          funk,
+                     ulong                root_slot,
+                     ulong                budget );
+
+/* fd_acc_token_idx_rebuild clears idx and indexes every token account
+   record of funk, including those of in-preparation txns.  Returns the
+   number of entries. */
+
+ulong
+fd_acc_token_idx_rebuild( fd_acc_token_idx_t * idx,
+                          fd_funk_t *          funk );
+
+/* Reader API */
+
+/* fd_acc_token_idx_query calls cb for each token account that has key
+   of kind as seen by funk txn txn (NULL for the last published txn),
+   with meta the account as seen by txn.  Iteration stops early if cb
+   returns non-zero.  Returns the number of cb calls.  Caller is the
+   writer or otherwise guarantees funk and idx are not concurrently
+   modified. */
+
+typedef int (*fd_acc_token_idx_cb_t)( fd_pubkey_t const *       acct,
+                                      fd_account_meta_t const * meta,
+                                      void *                    arg );
+
+ulong
+fd_acc_token_idx_query( fd_acc_token_idx_t *   idx,
+                        fd_funk_t *            funk,
+                        fd_funk_txn_t const *  txn,
+                        ulong                  kind,
+                        fd_pubkey_t const *    key,
+                        fd_acc_token_idx_cb_t  cb,
+                        void *                 arg );
+
+/* fd_acc_token_idx_query_safe copies up to acct_max candidate token
+   accounts that have key of kind into acct and returns the number of
+   candidates (which can be more than acct_max).  Safe to call
+   concurrently with the writer.  Candidates are a superset of the
+   matching accounts, the caller must check each candidate in its own
+   view of the funk (e.g. with fd_funk_rec_query_safe and
+   fd_token_acct_key). */
+
+ulong
+fd_acc_token_idx_query_safe( fd_acc_token_idx_t * idx,
+                             fd_funk_t *          funk,
+                             ulong                kind,
+                             fd_pubkey_t const *  key,
+                             fd_pubkey_t *        acct,
+                             ulong                acct_max );
+
+/* fd_acc_token_idx_verify checks the integrity of the index.  Returns 0
+   on success and -1 on failure (logs details). */
+
+int
+fd_acc_token_idx_verify( fd_acc_token_idx_t * idx );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_flamenco_runtime_fd_acc_token_idx_h */
@@ -1,4 +1,6 @@
 #include "fd_blockstore.h"
+#include "fd_blockstore_archive.h"
+#include "fd_blockstore_sig_idx.h"
 
 ulong
 fd_blockstore_align( void ) {
@@ -535,6 +537,9 @@ int
 fd_blockstore_publish( fd_blockstore_t * blockstore, ulong root ) {
   long  prune_time_ns    = -fd_log_wallclock();
   ulong prune_cnt  = 0UL;
+  ulong archive_cnt = 0UL;
+  ulong sig_idx_cnt = 0UL;
+  ulong sig_idx_rm_cnt = 0UL;
 
   fd_wksp_t * wksp = fd_blockstore_wksp( blockstore );
   ulong *     q    = fd_wksp_laddr_fast( wksp, blockstore->slot_deque_gaddr );
@@ -563,6 +568,48 @@ fd_blockstore_publish( fd_blockstore_t * blockstore, ulong root ) {
 
   fd_blockstore_slot_deque_remove_all( q );
 
+  /* Walk the newly rooted chain (the current root up to the new root),
+     oldest first.  The slots that are about to be pruned (all but the
+     new root) are appended to the archive.  The signature index only
+     covers txns that stay queryable, i.e. the new root and the slots
+     that made it into the archive.  The current root was indexed when
+     it was rooted and its entries are removed if it is pruned without
+     being archived. */
+
+  fd_blockstore_archive_t * archive = fd_blockstore_archive_query_attached( blockstore );
+  fd_blockstore_sig_idx_t * sig_idx = fd_blockstore_sig_idx_query_attached( blockstore );
+  if( archive && !archive->writable ) archive = NULL;
+  if( archive || sig_idx ) {
+    ulong slot = root;
+    fd_block_map_t * block_map_entry;
+    while( slot >= blockstore->root && slot != FD_SLOT_NULL &&
+           ( block_map_entry = fd_blockstore_block_map_query( blockstore, slot ) ) ) {
+      fd_blockstore_slot_deque_push_head( q, slot );
+      if( slot == blockstore->root ) break;
+      slot = block_map_entry->parent_slot;
+    }
+    while( !fd_blockstore_slot_deque_empty( q ) ) {
+      slot = fd_blockstore_slot_deque_pop_head( q );
+      block_map_entry = fd_blockstore_block_map_query( blockstore, slot );
+      int archived = 0;
+      if( archive && slot != root ) {
+        if( FD_UNLIKELY( fd_blockstore_archive_write( archive, blockstore, block_map_entry ) ) ) {
+          archive = NULL;
+        } else {
+          archive_cnt++;
+          archived = 1;
+        }
+      }
+      if( sig_idx ) {
+        if( slot == blockstore->root ) {
+          if( !archived ) sig_idx_rm_cnt += fd_blockstore_sig_idx_slot_remove( sig_idx, slot );
+        } else if( slot == root || archived ) {
+          sig_idx_cnt += fd_blockstore_sig_idx_block_append( sig_idx, blockstore, block_map_entry );
+        }
+      }
+    }
+  }
+
   /* Push the root onto the queue. */
 
   fd_blockstore_slot_deque_push_tail( q, blockstore->root );
@@ -613,10 +660,13 @@ fd_blockstore_publish( fd_blockstore_t * blockstore, ulong root ) {
 
   prune_time_ns += fd_log_wallclock();
 
-  FD_LOG_NOTICE( ( "[fd_blockstore_publish] new root: %lu, old root: %lu, prune cnt: %lu, took: %6.6f ms",
+  FD_LOG_NOTICE( ( "[fd_blockstore_publish] new root: %lu, old root: %lu, prune cnt: %lu, archive cnt: %lu, sig idx cnt: %lu, sig idx rm cnt: %lu, took: %6.6f ms",
                    root,
                    blockstore->root,
                    prune_cnt,
+                   archive_cnt,
+                   sig_idx_cnt,
+                   sig_idx_rm_cnt,
                    (double)prune_time_ns * 1e-6 ) );
 
   blockstore->root = root;
@@ -1002,6 +1052,63 @@ fd_blockstore_child_slots_query( fd_blockstore_t * blockstore, ulong slot, ulong
   return FD_BLOCKSTORE_OK;
 }
 
+/* Archive fall through for the volatile queries.  Archived entries
+   are immutable, so unlike the wksp queries these need no retry. */
+
+static fd_blockstore_archive_block_t const *
+fd_blockstore_archive_block_map_query( fd_blockstore_t * blockstore, ulong slot, fd_block_map_t * block_map_entry_out ) {
+  fd_blockstore_archive_t * archive = fd_blockstore_archive_query_attached( blockstore );
+  if( FD_LIKELY( !archive ) ) return NULL;
+  fd_blockstore_archive_block_t const * blk = fd_blockstore_archive_block_query( archive, slot );
+  if( FD_UNLIKELY( !blk ) ) return NULL;
+
+  fd_memset( block_map_entry_out, 0, sizeof( fd_block_map_t ) );
+  block_map_entry_out->slot           = blk->slot;
+  block_map_entry_out->parent_slot    = blk->parent_slot;
+  for( ulong i = 0; i < FD_BLOCKSTORE_CHILD_SLOT_MAX; i++ ) block_map_entry_out->child_slots[i] = FD_SLOT_NULL;
+  block_map_entry_out->height         = blk->height;
+  block_map_entry_out->block_hash     = blk->block_hash;
+  block_map_entry_out->bank_hash      = blk->bank_hash;
+  block_map_entry_out->flags          = blk->flags;
+  block_map_entry_out->reference_tick = blk->reference_tick;
+  block_map_entry_out->ts             = blk->ts;
+  block_map_entry_out->consumed_idx   = blk->complete_idx;
+  block_map_entry_out->received_idx   = blk->complete_idx;
+  block_map_entry_out->complete_idx   = blk->complete_idx;
+  return blk;
+}
+
+static int
+fd_blockstore_archive_block_data_query( fd_blockstore_t * blockstore, ulong slot, fd_block_map_t * block_map_entry_out, fd_valloc_t alloc, uchar ** block_data_out, ulong * block_data_out_sz ) {
+  fd_blockstore_archive_block_t const * blk = fd_blockstore_archive_block_map_query( blockstore, slot, block_map_entry_out );
+  if( FD_UNLIKELY( !blk ) ) return FD_BLOCKSTORE_ERR_SLOT_MISSING;
+  uchar * data_out = fd_valloc_malloc( alloc, 128UL, blk->data_sz );
+  if( FD_UNLIKELY( data_out == NULL ) ) return FD_BLOCKSTORE_ERR_SLOT_MISSING;
+  fd_memcpy( data_out, fd_blockstore_archive_block_data( blk ), blk->data_sz );
+  *block_data_out    = data_out;
+  *block_data_out_sz = blk->data_sz;
+  return FD_BLOCKSTORE_OK;
+}
+
+static int
+fd_blockstore_archive_txn_data_query( fd_blockstore_t * blockstore, uchar const sig[FD_ED25519_SIG_SZ], fd_blockstore_txn_map_t * txn_out, long * blk_ts, uchar * blk_flags, uchar txn_data_out[FD_TXN_MTU] ) {
+  fd_blockstore_archive_t * archive = fd_blockstore_archive_query_attached( blockstore );
+  if( FD_LIKELY( !archive ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+  fd_blockstore_archive_block_t const * blk = NULL;
+  fd_blockstore_archive_txn_t const *   txn = fd_blockstore_archive_txn_query( archive, sig, &blk );
+  if( FD_UNLIKELY( !txn ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+
+  fd_memset( txn_out, 0, sizeof( fd_blockstore_txn_map_t ) );
+  txn_out->sig    = txn->sig;
+  txn_out->slot   = blk->slot;
+  txn_out->offset = txn->txn_off;
+  txn_out->sz     = txn->sz;
+  if( blk_ts ) *blk_ts = blk->ts;
+  if( blk_flags ) *blk_flags = blk->flags;
+  if( txn_data_out ) fd_memcpy( txn_data_out, fd_blockstore_archive_block_data( blk ) + txn->txn_off, txn->sz );
+  return FD_BLOCKSTORE_OK;
+}
+
 int
 fd_blockstore_block_data_query_volatile( fd_blockstore_t * blockstore, ulong slot, fd_block_map_t * block_map_entry_out, fd_valloc_t alloc, uchar ** block_data_out, ulong * block_data_out_sz ) {
   /* WARNING: this code is extremely delicate. Do NOT modify without
@@ -1017,7 +1124,7 @@ fd_blockstore_block_data_query_volatile( fd_blockstore_t * blockstore, ulong slo
     if( FD_UNLIKELY( fd_readwrite_start_concur_read( &blockstore->lock, &seqnum ) ) ) continue;
 
     fd_block_map_t const * query = fd_block_map_query_safe( block_map, &slot, NULL );
-    if( FD_UNLIKELY( !query ) ) return FD_BLOCKSTORE_ERR_SLOT_MISSING;
+    if( FD_UNLIKELY( !query ) ) return fd_blockstore_archive_block_data_query( blockstore, slot, block_map_entry_out, alloc, block_data_out, block_data_out_sz );
     memcpy( block_map_entry_out, query, sizeof( fd_block_map_t ) );
     ulong blk_gaddr = query->block_gaddr;
     if( FD_UNLIKELY( !blk_gaddr ) ) return FD_BLOCKSTORE_ERR_SLOT_MISSING;
@@ -1061,7 +1168,7 @@ fd_blockstore_block_map_query_volatile( fd_blockstore_t * blockstore, ulong slot
     if( FD_UNLIKELY( fd_readwrite_start_concur_read( &blockstore->lock, &seqnum ) ) ) continue;
 
     fd_block_map_t const * query = fd_block_map_query_safe( slot_map, &slot, NULL );
-    if( FD_UNLIKELY( !query ) ) return FD_BLOCKSTORE_ERR_SLOT_MISSING;
+    if( FD_UNLIKELY( !query ) ) return fd_blockstore_archive_block_map_query( blockstore, slot, block_map_entry_out ) ? FD_BLOCKSTORE_OK : FD_BLOCKSTORE_ERR_SLOT_MISSING;
     memcpy( block_map_entry_out, query, sizeof( fd_block_map_t ) );
     ulong blk_gaddr = query->block_gaddr;
     if( FD_UNLIKELY( !blk_gaddr ) ) return FD_BLOCKSTORE_ERR_SLOT_MISSING;
@@ -1100,13 +1207,13 @@ fd_blockstore_txn_query_volatile( fd_blockstore_t * blockstore, uchar const sig[
     fd_blockstore_txn_key_t key;
     fd_memcpy( &key, sig, sizeof( key ) );
     fd_blockstore_txn_map_t const * txn_map_entry = fd_blockstore_txn_map_query_safe( txn_map, &key, NULL );
-    if( FD_UNLIKELY( txn_map_entry == NULL ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+    if( FD_UNLIKELY( txn_map_entry == NULL ) ) return fd_blockstore_archive_txn_data_query( blockstore, sig, txn_out, blk_ts, blk_flags, txn_data_out );
     fd_memcpy( txn_out, txn_map_entry, sizeof(fd_blockstore_txn_map_t) );
 
     if( FD_UNLIKELY( fd_readwrite_check_concur_read( &blockstore->lock, seqnum ) ) ) continue;
 
     fd_block_map_t const * query = fd_block_map_query_safe( slot_map, &txn_out->slot, NULL );
-    if( FD_UNLIKELY( !query ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+    if( FD_UNLIKELY( !query ) ) return fd_blockstore_archive_txn_data_query( blockstore, sig, txn_out, blk_ts, blk_flags, txn_data_out );
     ulong blk_gaddr = query->block_gaddr;
     if( FD_UNLIKELY( !blk_gaddr ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
 
@@ -1131,6 +1238,46 @@ fd_blockstore_txn_query_volatile( fd_blockstore_t * blockstore, uchar const sig[
   }
 }
 
+int
+fd_blockstore_txn_meta_query_volatile( fd_blockstore_t * blockstore, uchar const sig[FD_ED25519_SIG_SZ], fd_valloc_t alloc, uchar ** meta_out, ulong * meta_out_sz ) {
+  /* WARNING: this code is extremely delicate. Do NOT modify without
+     understanding all the invariants. In particular, we must never
+     dereference through a corrupt pointer. It's OK for the
+     destination data to be overwritten/invalid as long as the memory
+     location is valid. As long as we don't crash, we can validate the
+     data after it is read. */
+  fd_wksp_t * wksp = fd_blockstore_wksp( blockstore );
+  fd_blockstore_txn_map_t * txn_map = fd_wksp_laddr_fast( wksp, blockstore->txn_map_gaddr );
+  for(;;) {
+    uint seqnum;
+    if( FD_UNLIKELY( fd_readwrite_start_concur_read( &blockstore->lock, &seqnum ) ) ) continue;
+
+    fd_blockstore_txn_key_t key;
+    fd_memcpy( &key, sig, sizeof( key ) );
+    fd_blockstore_txn_map_t const * txn_map_entry = fd_blockstore_txn_map_query_safe( txn_map, &key, NULL );
+    if( FD_UNLIKELY( txn_map_entry == NULL ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+    ulong meta_gaddr = txn_map_entry->meta_gaddr;
+    ulong sz         = txn_map_entry->meta_sz;
+
+    if( FD_UNLIKELY( fd_readwrite_check_concur_read( &blockstore->lock, seqnum ) ) ) continue;
+
+    if( FD_UNLIKELY( !meta_gaddr || !sz ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+
+    uchar * data_out = fd_valloc_malloc( alloc, 1UL, sz );
+    if( FD_UNLIKELY( data_out == NULL ) ) return FD_BLOCKSTORE_ERR_TXN_MISSING;
+    fd_memcpy( data_out, fd_wksp_laddr_fast( wksp, meta_gaddr ), sz );
+
+    if( FD_UNLIKELY( fd_readwrite_check_concur_read( &blockstore->lock, seqnum ) ) ) {
+      fd_valloc_free( alloc, data_out );
+      continue;
+    }
+
+    *meta_out    = data_out;
+    *meta_out_sz = sz;
+    return FD_BLOCKSTORE_OK;
+  }
+}
+
 void
 fd_blockstore_block_height_update( fd_blockstore_t * blockstore, ulong slot, ulong height ) {
   fd_block_map_t * query = fd_blockstore_block_map_query( blockstore, slot );
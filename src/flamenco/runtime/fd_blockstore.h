@@ -282,6 +282,8 @@ struct __attribute__((aligned(FD_BLOCKSTORE_ALIGN))) fd_blockstore_private {
   int   lg_txn_max;
   ulong txn_map_gaddr;
 
+  ulong sig_idx_gaddr; /* address signature index (fd_blockstore_sig_idx.h), 0 if none */
+
   /* The blockstore alloc is used for allocating wksp resources for shred headers, microblock
      headers, and blocks.  This is an fd_alloc. Allocations from this allocator will be tagged with
      wksp_tag and operations on this allocator will use concurrency group 0. */
@@ -526,6 +528,18 @@ fd_blockstore_txn_query( fd_blockstore_t * blockstore, uchar const sig[static FD
 int
 fd_blockstore_txn_query_volatile( fd_blockstore_t * blockstore, uchar const sig[static FD_ED25519_SIG_SZ], fd_blockstore_txn_map_t * txn_out, long * blk_ts, uchar * blk_flags, uchar txn_data_out[FD_TXN_MTU] );
 
+/* fd_blockstore_txn_meta_query_volatile queries the status metadata
+   (protobuf TransactionStatusMeta) of the transaction with the given
+   signature in a thread safe manner.  Allocates a buffer using alloc,
+   copies the metadata into it and sets meta_out and meta_out_sz.
+   Returns FD_BLOCKSTORE_ERR_TXN_MISSING if the transaction or its
+   metadata is not available (e.g. the transaction was archived or
+   ingested without metadata): caller MUST ignore out pointers in this
+   case.  Otherwise returns FD_BLOCKSTORE_OK. */
+
+int
+fd_blockstore_txn_meta_query_volatile( fd_blockstore_t * blockstore, uchar const sig[static FD_ED25519_SIG_SZ], fd_valloc_t alloc, uchar ** meta_out, ulong * meta_out_sz );
+
 /* Remove slot from blockstore, including all relevant internal structures. */
 int
 fd_blockstore_slot_remove( fd_blockstore_t * blockstore, ulong slot );
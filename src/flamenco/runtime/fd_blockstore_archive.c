@@ -0,0 +1,379 @@
+#include "fd_blockstore_archive.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FD_BLOCKSTORE_ARCHIVE_PAGE_SZ (4096UL)
+
+/* Indices are kept at most 3/4 full so probe sequences stay short */
+
+#define FD_BLOCKSTORE_ARCHIVE_LOAD_MAX(lg) ( ( 3UL << (lg) ) >> 2 )
+
+FD_STATIC_ASSERT( sizeof(fd_blockstore_archive_hdr_t)<=FD_BLOCKSTORE_ARCHIVE_PAGE_SZ, archive_hdr );
+
+static void
+fd_blockstore_archive_layout( fd_blockstore_archive_hdr_t * hdr ) {
+  hdr->slot_off = FD_BLOCKSTORE_ARCHIVE_PAGE_SZ;
+  hdr->txn_off  = fd_ulong_align_up( hdr->slot_off + ( sizeof(fd_blockstore_archive_slot_t) << hdr->slot_lg_max ),
+                                     FD_BLOCKSTORE_ARCHIVE_PAGE_SZ );
+  hdr->data_off = fd_ulong_align_up( hdr->txn_off + ( sizeof(fd_blockstore_archive_txn_t) << hdr->txn_lg_max ),
+                                     FD_BLOCKSTORE_ARCHIVE_PAGE_SZ );
+}
+
+fd_blockstore_archive_t *
+fd_blockstore_archive_open( fd_blockstore_archive_t * archive,
+                            char const *              path,
+                            int                       writable,
+                            ulong                     slot_lg_max,
+                            ulong                     txn_lg_max,
+                            ulong                     data_max ) {
+  if( FD_UNLIKELY( !archive ) ) {
+    FD_LOG_WARNING(( "NULL archive" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( !path ) ) {
+    FD_LOG_WARNING(( "NULL path" ));
+    return NULL;
+  }
+
+  int fd = open( path, writable ? ( O_RDWR | O_CREAT ) : O_RDONLY, 0644 );
+  if( FD_UNLIKELY( fd<0 ) ) {
+    FD_LOG_WARNING(( "open(%s) failed (%d-%s)", path, errno, fd_io_strerror( errno ) ));
+    return NULL;
+  }
+
+  struct stat st;
+  if( FD_UNLIKELY( 0!=fstat( fd, &st ) ) ) {
+    FD_LOG_WARNING(( "fstat(%s) failed (%d-%s)", path, errno, fd_io_strerror( errno ) ));
+    goto fail;
+  }
+
+  fd_blockstore_archive_hdr_t hdr[1];
+  int create = 0;
+  if( st.st_size==0 ) {
+    if( FD_UNLIKELY( !writable ) ) {
+      FD_LOG_WARNING(( "%s is empty", path ));
+      goto fail;
+    }
+    if( FD_UNLIKELY( slot_lg_max<1UL || slot_lg_max>40UL || txn_lg_max<1UL || txn_lg_max>40UL || !data_max ) ) {
+      FD_LOG_WARNING(( "invalid archive geometry (slot_lg_max %lu, txn_lg_max %lu, data_max %lu)",
+                       slot_lg_max, txn_lg_max, data_max ));
+      goto fail;
+    }
+    fd_memset( hdr, 0, sizeof(fd_blockstore_archive_hdr_t) );
+    hdr->slot_lg_max = slot_lg_max;
+    hdr->txn_lg_max  = txn_lg_max;
+    hdr->data_max    = fd_ulong_align_up( data_max, FD_BLOCKSTORE_ARCHIVE_PAGE_SZ );
+    hdr->slot_lo     = FD_SLOT_NULL;
+    hdr->slot_hi     = FD_SLOT_NULL;
+    fd_blockstore_archive_layout( hdr );
+    create = 1;
+  } else {
+    if( FD_UNLIKELY( pread( fd, hdr, sizeof(fd_blockstore_archive_hdr_t), 0 )!=(long)sizeof(fd_blockstore_archive_hdr_t) ) ) {
+      FD_LOG_WARNING(( "failed to read archive header of %s", path ));
+      goto fail;
+    }
+    if( FD_UNLIKELY( hdr->magic!=FD_BLOCKSTORE_ARCHIVE_MAGIC ) ) {
+      FD_LOG_WARNING(( "%s is not a blockstore archive (bad magic)", path ));
+      goto fail;
+    }
+    fd_blockstore_archive_hdr_t chk[1] = { *hdr };
+    fd_blockstore_archive_layout( chk );
+    if( FD_UNLIKELY( hdr->slot_lg_max>40UL || hdr->txn_lg_max>40UL ||
+                     chk->slot_off!=hdr->slot_off || chk->txn_off!=hdr->txn_off || chk->data_off!=hdr->data_off ||
+                     (ulong)st.st_size < hdr->data_off + hdr->data_max ) ) {
+      FD_LOG_WARNING(( "%s has a corrupt archive header", path ));
+      goto fail;
+    }
+  }
+
+  ulong map_sz = hdr->data_off + hdr->data_max;
+  if( create && FD_UNLIKELY( 0!=ftruncate( fd, (long)map_sz ) ) ) {
+    FD_LOG_WARNING(( "ftruncate(%s,%lu) failed (%d-%s)", path, map_sz, errno, fd_io_strerror( errno ) ));
+    goto fail;
+  }
+
+  uchar * map = mmap( NULL, map_sz, writable ? ( PROT_READ | PROT_WRITE ) : PROT_READ, MAP_SHARED, fd, 0 );
+  if( FD_UNLIKELY( map==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(%s) failed (%d-%s)", path, errno, fd_io_strerror( errno ) ));
+    goto fail;
+  }
+
+  if( create ) {
+    fd_memcpy( map, hdr, sizeof(fd_blockstore_archive_hdr_t) );
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( ( (fd_blockstore_archive_hdr_t *)map )->magic ) = FD_BLOCKSTORE_ARCHIVE_MAGIC;
+    FD_COMPILER_MFENCE();
+  }
+
+  archive->fd       = fd;
+  archive->writable = !!writable;
+  archive->map      = map;
+  archive->map_sz   = map_sz;
+  archive->hdr      = (fd_blockstore_archive_hdr_t *)map;
+  archive->slots    = (fd_blockstore_archive_slot_t *)( map + hdr->slot_off );
+  archive->txns     = (fd_blockstore_archive_txn_t *)( map + hdr->txn_off );
+  archive->data     = map + hdr->data_off;
+  archive->full     = 0;
+
+  FD_LOG_NOTICE(( "%s blockstore archive %s (blocks %lu, txns %lu, data %lu of %lu bytes)",
+                  create ? "created" : "opened", path,
+                  archive->hdr->slot_cnt, archive->hdr->txn_cnt, archive->hdr->data_sz, archive->hdr->data_max ));
+  return archive;
+
+fail:
+  close( fd );
+  return NULL;
+}
+
+void
+fd_blockstore_archive_close( fd_blockstore_archive_t * archive ) {
+  if( FD_UNLIKELY( !archive || !archive->map ) ) return;
+  if( FD_UNLIKELY( munmap( archive->map, archive->map_sz ) ) )
+    FD_LOG_WARNING(( "munmap failed (%d-%s)", errno, fd_io_strerror( errno ) ));
+  if( FD_UNLIKELY( close( archive->fd ) ) )
+    FD_LOG_WARNING(( "close failed (%d-%s)", errno, fd_io_strerror( errno ) ));
+  fd_memset( archive, 0, sizeof(fd_blockstore_archive_t) );
+  archive->fd = -1;
+}
+
+static inline ulong
+fd_blockstore_archive_txn_hash( fd_blockstore_txn_key_t const * sig ) {
+  return fd_ulong_hash( sig->v[0] );
+}
+
+/* fd_blockstore_archive_record returns the block record at offset off
+   of the data region if it lies entirely within the published part of
+   the data region (data_sz), NULL otherwise. */
+
+static fd_blockstore_archive_block_t const *
+fd_blockstore_archive_record( fd_blockstore_archive_t const * archive,
+                              ulong                           off,
+                              ulong                           data_sz ) {
+  if( FD_UNLIKELY( data_sz < sizeof(fd_blockstore_archive_block_t) ||
+                   off > data_sz - sizeof(fd_blockstore_archive_block_t) ) ) return NULL;
+  fd_blockstore_archive_block_t const * blk = (fd_blockstore_archive_block_t const *)( archive->data + off );
+  if( FD_UNLIKELY( blk->data_sz > data_sz - off - sizeof(fd_blockstore_archive_block_t) ) ) return NULL;
+  return blk;
+}
+
+/* Index entries are made visible before the header publishes the
+   block record they refer to.  If the writer crashed in between, an
+   entry may refer to a record that was never published, or that was
+   overwritten by a different block after the restart.  Queries skip
+   such entries (and the writer indexes the block again past them). */
+
+fd_blockstore_archive_block_t const *
+fd_blockstore_archive_block_query( fd_blockstore_archive_t const * archive,
+                                   ulong                           slot ) {
+  fd_blockstore_archive_hdr_t const * hdr = archive->hdr;
+  ulong data_sz = FD_VOLATILE_CONST( hdr->data_sz );
+  FD_COMPILER_MFENCE();
+  ulong mask = ( 1UL << hdr->slot_lg_max ) - 1UL;
+  for( ulong i = fd_ulong_hash( slot ) & mask;; i = ( i + 1UL ) & mask ) {
+    fd_blockstore_archive_slot_t const * ele = archive->slots + i;
+    ulong tag = FD_VOLATILE_CONST( ele->tag );
+    if( !tag ) return NULL;
+    if( tag != slot + 1UL ) continue;
+    FD_COMPILER_MFENCE();
+    fd_blockstore_archive_block_t const * blk = fd_blockstore_archive_record( archive, ele->off, data_sz );
+    if( FD_UNLIKELY( !blk || blk->slot != slot ) ) continue; /* stale */
+    return blk;
+  }
+}
+
+/* fd_blockstore_archive_txn_block returns the block record of txn
+   index entry ele if the entry is valid: the record is published, it
+   is the indexed record of its slot, the txn lies within the block
+   data and its signatures include the entry's signature.  Otherwise
+   returns NULL. */
+
+static fd_blockstore_archive_block_t const *
+fd_blockstore_archive_txn_block( fd_blockstore_archive_t const *     archive,
+                                 fd_blockstore_archive_txn_t const * ele,
+                                 ulong                               data_sz ) {
+  fd_blockstore_archive_block_t const * blk = fd_blockstore_archive_record( archive, ele->blk_off, data_sz );
+  if( FD_UNLIKELY( !blk ) ) return NULL;
+  if( FD_UNLIKELY( fd_blockstore_archive_block_query( archive, blk->slot ) != blk ) ) return NULL;
+  if( FD_UNLIKELY( ele->sz < 1UL || ele->sz > FD_TXN_MTU ||
+                   ele->txn_off > blk->data_sz || ele->sz > blk->data_sz - ele->txn_off ) ) return NULL;
+
+  /* signatures follow the (single byte, <=FD_TXN_SIG_MAX) compact-u16
+     signature count at the start of the payload */
+
+  uchar const * payload = fd_blockstore_archive_block_data( blk ) + ele->txn_off;
+  ulong         sig_cnt = fd_ulong_min( payload[0], ( ele->sz - 1UL ) / FD_ED25519_SIG_SZ );
+  for( ulong k = 0; k < sig_cnt; k++ ) {
+    if( !memcmp( payload + 1UL + k*FD_ED25519_SIG_SZ, &ele->sig, FD_ED25519_SIG_SZ ) ) return blk;
+  }
+  return NULL;
+}
+
+fd_blockstore_archive_txn_t const *
+fd_blockstore_archive_txn_query( fd_blockstore_archive_t const *         archive,
+                                 uchar const                             sig[static FD_ED25519_SIG_SZ],
+                                 fd_blockstore_archive_block_t const * * opt_blk ) {
+  fd_blockstore_txn_key_t key;
+  fd_memcpy( &key, sig, sizeof( key ) );
+  ulong data_sz = FD_VOLATILE_CONST( archive->hdr->data_sz );
+  FD_COMPILER_MFENCE();
+  ulong mask = ( 1UL << archive->hdr->txn_lg_max ) - 1UL;
+  for( ulong i = fd_blockstore_archive_txn_hash( &key ) & mask;; i = ( i + 1UL ) & mask ) {
+    fd_blockstore_archive_txn_t const * ele = archive->txns + i;
+    ulong tag = FD_VOLATILE_CONST( ele->tag );
+    if( !tag ) return NULL;
+    if( tag != ( key.v[0] | 1UL ) ) continue;
+    FD_COMPILER_MFENCE();
+    if( !fd_blockstore_txn_key_equal( &ele->sig, &key ) ) continue;
+    fd_blockstore_archive_block_t const * blk = fd_blockstore_archive_txn_block( archive, ele, data_sz );
+    if( FD_UNLIKELY( !blk ) ) continue; /* stale */
+    if( opt_blk ) *opt_blk = blk;
+    return ele;
+  }
+}
+
+int
+fd_blockstore_archive_write( fd_blockstore_archive_t * archive,
+                             fd_blockstore_t *         blockstore,
+                             fd_block_map_t const *    block_map_entry ) {
+  fd_blockstore_archive_hdr_t * hdr = archive->hdr;
+  ulong slot = block_map_entry->slot;
+
+  if( FD_UNLIKELY( !block_map_entry->block_gaddr ) ) return FD_BLOCKSTORE_OK;
+  if( FD_UNLIKELY( fd_blockstore_archive_block_query( archive, slot ) ) ) return FD_BLOCKSTORE_OK;
+
+  fd_wksp_t *                wksp  = fd_blockstore_wksp( blockstore );
+  fd_block_t const *         block = fd_wksp_laddr_fast( wksp, block_map_entry->block_gaddr );
+  if( FD_UNLIKELY( !block->data_gaddr ) ) return FD_BLOCKSTORE_OK; /* e.g. the fake block of the snapshot slot */
+  uchar const *              data  = fd_wksp_laddr_fast( wksp, block->data_gaddr );
+  fd_block_txn_ref_t const * txns  = block->txns_gaddr ? fd_wksp_laddr_fast( wksp, block->txns_gaddr ) : NULL;
+  ulong                      txns_cnt = txns ? block->txns_cnt : 0UL;
+
+  ulong rec_off = hdr->data_sz;
+  ulong rec_sz  = fd_ulong_align_up( sizeof(fd_blockstore_archive_block_t) + block->data_sz, 8UL );
+  if( FD_UNLIKELY( rec_sz > hdr->data_max - rec_off ||
+                   hdr->slot_cnt + 1UL > FD_BLOCKSTORE_ARCHIVE_LOAD_MAX( hdr->slot_lg_max ) ||
+                   hdr->txn_cnt + txns_cnt > FD_BLOCKSTORE_ARCHIVE_LOAD_MAX( hdr->txn_lg_max ) ) ) {
+    if( !archive->full ) {
+      FD_LOG_WARNING(( "[fd_blockstore_archive_write] archive full at slot %lu (blocks %lu, txns %lu, data %lu of %lu bytes), not archiving any more blocks",
+                       slot, hdr->slot_cnt, hdr->txn_cnt, hdr->data_sz, hdr->data_max ));
+      archive->full = 1;
+    }
+    return FD_BLOCKSTORE_ERR_NO_MEM;
+  }
+
+  /* Append the block record.  It is beyond data_sz, so no reader can
+     see it yet. */
+
+  fd_blockstore_archive_block_t * rec = (fd_blockstore_archive_block_t *)( archive->data + rec_off );
+  rec->slot           = slot;
+  rec->parent_slot    = block_map_entry->parent_slot;
+  rec->height         = block_map_entry->height;
+  rec->block_hash     = block_map_entry->block_hash;
+  rec->bank_hash      = block_map_entry->bank_hash;
+  rec->ts             = block_map_entry->ts;
+  rec->flags          = fd_uchar_clear_bit( block_map_entry->flags, FD_BLOCK_FLAG_PREPARING );
+  rec->reference_tick = block_map_entry->reference_tick;
+  rec->complete_idx   = block_map_entry->complete_idx;
+  rec->data_sz        = block->data_sz;
+  rec->txns_cnt       = txns_cnt;
+  fd_memcpy( rec + 1, data, block->data_sz );
+
+  /* Index the txn signatures */
+
+  ulong txn_mask = ( 1UL << hdr->txn_lg_max ) - 1UL;
+  ulong txn_cnt  = 0UL;
+  for( ulong j = 0; j < txns_cnt; j++ ) {
+    fd_blockstore_txn_key_t sig;
+    fd_memcpy( &sig, data + txns[j].id_off, sizeof( sig ) );
+    ulong tag = sig.v[0] | 1UL;
+    for( ulong i = fd_blockstore_archive_txn_hash( &sig ) & txn_mask;; i = ( i + 1UL ) & txn_mask ) {
+      fd_blockstore_archive_txn_t * ele = archive->txns + i;
+      if( ele->tag == tag && fd_blockstore_txn_key_equal( &ele->sig, &sig ) &&
+          fd_blockstore_archive_txn_block( archive, ele, rec_off ) ) break; /* already archived */
+      if( ele->tag ) continue;
+      ele->sig     = sig;
+      ele->blk_off = rec_off;
+      ele->txn_off = txns[j].txn_off;
+      ele->sz      = txns[j].sz;
+      FD_COMPILER_MFENCE();
+      FD_VOLATILE( ele->tag ) = tag;
+      txn_cnt++;
+      break;
+    }
+  }
+
+  /* Index the slot */
+
+  ulong slot_mask = ( 1UL << hdr->slot_lg_max ) - 1UL;
+  for( ulong i = fd_ulong_hash( slot ) & slot_mask;; i = ( i + 1UL ) & slot_mask ) {
+    fd_blockstore_archive_slot_t * ele = archive->slots + i;
+    if( ele->tag ) continue;
+    ele->off = rec_off;
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( ele->tag ) = slot + 1UL;
+    break;
+  }
+
+  FD_COMPILER_MFENCE();
+  hdr->txn_cnt += txn_cnt;
+  hdr->slot_cnt++;
+  if( hdr->slot_lo == FD_SLOT_NULL || slot < hdr->slot_lo ) hdr->slot_lo = slot;
+  if( hdr->slot_hi == FD_SLOT_NULL || slot > hdr->slot_hi ) hdr->slot_hi = slot;
+  FD_VOLATILE( hdr->data_sz ) = rec_off + rec_sz;
+  FD_COMPILER_MFENCE();
+
+  return FD_BLOCKSTORE_OK;
+}
+
+/* Process local registry of attached archives */
+
+static struct {
+  fd_blockstore_t const *   blockstore;
+  fd_blockstore_archive_t * archive;
+} fd_blockstore_archive_attached[ FD_BLOCKSTORE_ARCHIVE_ATTACH_MAX ];
+
+int
+fd_blockstore_archive_attach( fd_blockstore_t * blockstore, fd_blockstore_archive_t * archive ) {
+  if( FD_UNLIKELY( !blockstore || !archive ) ) {
+    FD_LOG_WARNING(( "NULL blockstore or archive" ));
+    return -1;
+  }
+  if( FD_UNLIKELY( fd_blockstore_archive_query_attached( blockstore ) ) ) {
+    FD_LOG_WARNING(( "blockstore already has an archive attached" ));
+    return -1;
+  }
+  for( ulong i = 0; i < FD_BLOCKSTORE_ARCHIVE_ATTACH_MAX; i++ ) {
+    if( fd_blockstore_archive_attached[i].blockstore ) continue;
+    fd_blockstore_archive_attached[i].archive    = archive;
+    FD_COMPILER_MFENCE();
+    fd_blockstore_archive_attached[i].blockstore = blockstore;
+    return 0;
+  }
+  FD_LOG_WARNING(( "too many attached archives" ));
+  return -1;
+}
+
+int
+fd_blockstore_archive_detach( fd_blockstore_t * blockstore ) {
+  for( ulong i = 0; i < FD_BLOCKSTORE_ARCHIVE_ATTACH_MAX; i++ ) {
+    if( fd_blockstore_archive_attached[i].blockstore != blockstore ) continue;
+    fd_blockstore_archive_attached[i].blockstore = NULL;
+    FD_COMPILER_MFENCE();
+    fd_blockstore_archive_attached[i].archive    = NULL;
+    return 0;
+  }
+  FD_LOG_WARNING(( "blockstore has no archive attached" ));
+  return -1;
+}
+
+fd_blockstore_archive_t *
+fd_blockstore_archive_query_attached( fd_blockstore_t const * blockstore ) {
+  for( ulong i = 0; i < FD_BLOCKSTORE_ARCHIVE_ATTACH_MAX; i++ ) {
+    if( fd_blockstore_archive_attached[i].blockstore == blockstore ) return fd_blockstore_archive_attached[i].archive;
+  }
+  return NULL;
+}
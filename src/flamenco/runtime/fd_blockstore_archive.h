@@ -0,0 +1,201 @@
+#ifndef HEADER_fd_src_flamenco_runtime_fd_blockstore_archive_h
+#define HEADER_fd_src_flamenco_runtime_fd_blockstore_archive_h
+
+/* fd_blockstore_archive is an append-only, memory-mapped on-disk tier
+   of the blockstore.  Rooted blocks that fd_blockstore_publish evicts
+   from the wksp are appended to the archive together with their
+   transaction index.  The blockstore volatile queries (block data,
+   block map, txn) fall through to the archive when a slot or txn is no
+   longer in the wksp.  This keeps history queryable well beyond the
+   in-memory window with RAM bounded by the page cache.
+
+   The archive is a single sparse file with fixed geometry:
+
+     [ header | slot index | txn index | data region ]
+
+   The slot and txn indices are insert-only open addressing hash tables
+   (linear probing).  The data region holds block records
+   (fd_blockstore_archive_block_t followed by the block data) appended
+   back to back.  Once the data region or an index is full, further
+   blocks are not archived.
+
+   There is a single writer (the process that publishes the blockstore)
+   and any number of concurrent readers in any process.  Entries are
+   fully written before they are made visible (the index tag / header
+   data_sz are written last), so readers never need a lock.  Queries
+   only return index entries that refer to a block record within the
+   published data region (header data_sz), so entries left behind by a
+   writer that crashed before publishing are ignored.
+
+   The mapping of the file is local to the process.  Each process that
+   wants the fall through opens the archive and attaches it to its
+   blockstore join with fd_blockstore_archive_attach. */
+
+#include "fd_blockstore.h"
+
+#define FD_BLOCKSTORE_ARCHIVE_MAGIC (0xf17eda2ce7a4c400UL) /* firedancer archive version 0 */
+
+/* FD_BLOCKSTORE_ARCHIVE_ATTACH_MAX is the max number of blockstore
+   joins with an attached archive in a process. */
+
+#define FD_BLOCKSTORE_ARCHIVE_ATTACH_MAX (4UL)
+
+/* clang-format off */
+struct fd_blockstore_archive_hdr {
+  ulong magic;
+  ulong slot_lg_max;  /* log2 capacity of the slot index */
+  ulong txn_lg_max;   /* log2 capacity of the txn index */
+  ulong data_max;     /* capacity of the data region in bytes */
+  ulong slot_off;     /* file offset of the slot index */
+  ulong txn_off;      /* file offset of the txn index */
+  ulong data_off;     /* file offset of the data region */
+  ulong data_sz;      /* bytes of the data region in use */
+  ulong slot_cnt;     /* number of archived blocks */
+  ulong txn_cnt;      /* number of archived txn signatures */
+  ulong slot_lo;      /* lowest archived slot (FD_SLOT_NULL if none) */
+  ulong slot_hi;      /* highest archived slot (FD_SLOT_NULL if none) */
+};
+typedef struct fd_blockstore_archive_hdr fd_blockstore_archive_hdr_t;
+
+/* A slot index entry.  tag is zero if the entry is free, slot+1
+   otherwise. */
+
+struct fd_blockstore_archive_slot {
+  ulong tag;
+  ulong off;          /* offset of the block record in the data region */
+};
+typedef struct fd_blockstore_archive_slot fd_blockstore_archive_slot_t;
+
+/* A txn index entry.  tag is zero if the entry is free. */
+
+struct fd_blockstore_archive_txn {
+  ulong                   tag;
+  fd_blockstore_txn_key_t sig;
+  ulong                   blk_off; /* offset of the block record in the data region */
+  ulong                   txn_off; /* offset of the txn in the block data */
+  ulong                   sz;      /* txn payload size */
+};
+typedef struct fd_blockstore_archive_txn fd_blockstore_archive_txn_t;
+
+/* A block record in the data region.  The block data (data_sz bytes)
+   immediately follows the record.  Records are 8 byte aligned. */
+
+struct fd_blockstore_archive_block {
+  ulong     slot;
+  ulong     parent_slot;
+  ulong     height;
+  fd_hash_t block_hash;
+  fd_hash_t bank_hash;
+  long      ts;
+  uchar     flags;
+  uchar     reference_tick;
+  uint      complete_idx;
+  ulong     data_sz;
+  ulong     txns_cnt;
+};
+typedef struct fd_blockstore_archive_block fd_blockstore_archive_block_t;
+
+/* fd_blockstore_archive_t is a local join to an archive file. */
+
+struct fd_blockstore_archive {
+  int                            fd;
+  int                            writable;
+  uchar *                        map;
+  ulong                          map_sz;
+  fd_blockstore_archive_hdr_t *  hdr;
+  fd_blockstore_archive_slot_t * slots;
+  fd_blockstore_archive_txn_t *  txns;
+  uchar *                        data;
+  int                            full; /* writer only, warned about running out of space */
+};
+typedef struct fd_blockstore_archive fd_blockstore_archive_t;
+/* clang-format on */
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_blockstore_archive_open opens the archive file at path into the
+   caller provided archive.  If writable is non-zero, the archive is
+   opened for appending, and a new archive with the given geometry is
+   created if the file does not exist or is empty (slot_lg_max and
+   txn_lg_max in [1,40], data_max>0).  Otherwise, the archive is opened
+   read-only and the geometry arguments are ignored.  The geometry of
+   an existing archive is always taken from the file.  Returns archive
+   on success.  On failure, logs reason and returns NULL. */
+
+fd_blockstore_archive_t *
+fd_blockstore_archive_open( fd_blockstore_archive_t * archive,
+                            char const *              path,
+                            int                       writable,
+                            ulong                     slot_lg_max,
+                            ulong                     txn_lg_max,
+                            ulong                     data_max );
+
+/* fd_blockstore_archive_close unmaps and closes the archive.  It must
+   not be attached to any blockstore. */
+
+void
+fd_blockstore_archive_close( fd_blockstore_archive_t * archive );
+
+/* fd_blockstore_archive_write appends the block of block_map_entry to
+   the archive and indexes its slot and txns.  Slots that are already
+   archived are ignored.  Caller is the archive's single writer and
+   must hold the blockstore write lock.  Returns FD_BLOCKSTORE_OK on
+   success (or if the block was ignored), FD_BLOCKSTORE_ERR_NO_MEM if
+   the archive is full. */
+
+int
+fd_blockstore_archive_write( fd_blockstore_archive_t * archive,
+                             fd_blockstore_t *         blockstore,
+                             fd_block_map_t const *    block_map_entry );
+
+/* fd_blockstore_archive_block_query returns the block record of slot
+   or NULL if slot is not archived.  The record and the data following
+   it (blk->data_sz bytes) lie within the published data region and
+   are valid for the lifetime of the archive join. */
+
+fd_blockstore_archive_block_t const *
+fd_blockstore_archive_block_query( fd_blockstore_archive_t const * archive,
+                                   ulong                           slot );
+
+/* fd_blockstore_archive_txn_query returns the txn index entry of sig
+   or NULL if sig is not archived.  The entry is validated against the
+   block record it refers to: the record is the archived record of its
+   slot, the txn (at most FD_TXN_MTU bytes) lies within the block data
+   and is signed by sig.  If opt_blk is non-NULL, *opt_blk is set to the
+   block record on success.  Lifetime as above. */
+
+fd_blockstore_archive_txn_t const *
+fd_blockstore_archive_txn_query( fd_blockstore_archive_t const *         archive,
+                                 uchar const                             sig[static FD_ED25519_SIG_SZ],
+                                 fd_blockstore_archive_block_t const * * opt_blk );
+
+/* fd_blockstore_archive_block_data returns a pointer to the block data
+   following block record blk. */
+
+static inline uchar const *
+fd_blockstore_archive_block_data( fd_blockstore_archive_block_t const * blk ) {
+  return (uchar const *)( blk + 1 );
+}
+
+/* fd_blockstore_archive_{attach,detach} attach/detach archive to/from
+   the local blockstore join.  While attached, the blockstore volatile
+   queries fall through to archive and fd_blockstore_publish appends
+   evicted rooted blocks to archive if it is writable.  Not thread
+   safe, call during setup before any concurrent use of blockstore.
+   Returns 0 on success, -1 on failure (logs details). */
+
+int
+fd_blockstore_archive_attach( fd_blockstore_t * blockstore, fd_blockstore_archive_t * archive );
+
+int
+fd_blockstore_archive_detach( fd_blockstore_t * blockstore );
+
+/* fd_blockstore_archive_query_attached returns the archive attached to
+   blockstore or NULL if there is none. */
+
+fd_blockstore_archive_t *
+fd_blockstore_archive_query_attached( fd_blockstore_t const * blockstore );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_flamenco_runtime_fd_blockstore_archive_h */
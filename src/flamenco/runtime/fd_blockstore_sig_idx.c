@@ -0,0 +1,311 @@
+#include "fd_blockstore_sig_idx.h"
+#include "../../ballet/txn/fd_txn.h"
+
+#define MAP_NAME               fd_blockstore_sig_idx_addr_map
+#define MAP_T                  fd_blockstore_sig_idx_addr_t
+#define MAP_KEY                addr
+#define MAP_KEY_T              fd_pubkey_t
+#define MAP_KEY_EQ(k0,k1)      (!memcmp( (k0), (k1), sizeof(fd_pubkey_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_pubkey_t) )
+#define MAP_KEY_COPY(kd,ks)    fd_memcpy( (kd), (ks), sizeof(fd_pubkey_t) )
+#define MAP_MAGIC              (0xf17eda2ce75161a0UL) /* firedancer sig idx addrs version 0 */
+#define MAP_IMPL_STYLE         2
+#include "../../util/tmpl/fd_map_giant.c"
+
+#define FD_BLOCKSTORE_SIG_IDX_LG_ENT_MAX_MAX (40UL)
+
+ulong
+fd_blockstore_sig_idx_align( void ) {
+  return FD_BLOCKSTORE_SIG_IDX_ALIGN;
+}
+
+ulong
+fd_blockstore_sig_idx_footprint( ulong lg_ent_max ) {
+  if( FD_UNLIKELY( !lg_ent_max || lg_ent_max>FD_BLOCKSTORE_SIG_IDX_LG_ENT_MAX_MAX ) ) return 0UL;
+  ulong ent_max = 1UL<<lg_ent_max;
+  return FD_LAYOUT_FINI( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_INIT,
+      FD_BLOCKSTORE_SIG_IDX_ALIGN,             sizeof(fd_blockstore_sig_idx_t)                     ),
+      alignof(fd_blockstore_sig_idx_ent_t),    ent_max*sizeof(fd_blockstore_sig_idx_ent_t)         ),
+      fd_blockstore_sig_idx_addr_map_align(),  fd_blockstore_sig_idx_addr_map_footprint( ent_max ) ),
+      FD_BLOCKSTORE_SIG_IDX_ALIGN );
+}
+
+void *
+fd_blockstore_sig_idx_new( void * shmem,
+                           ulong  seed,
+                           ulong  lg_ent_max ) {
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_blockstore_sig_idx_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_blockstore_sig_idx_footprint( lg_ent_max ) ) ) {
+    FD_LOG_WARNING(( "bad lg_ent_max (%lu)", lg_ent_max ));
+    return NULL;
+  }
+
+  ulong ent_max = 1UL<<lg_ent_max;
+  FD_SCRATCH_ALLOC_INIT( l, shmem );
+  fd_blockstore_sig_idx_t *     idx      = FD_SCRATCH_ALLOC_APPEND( l, FD_BLOCKSTORE_SIG_IDX_ALIGN,            sizeof(fd_blockstore_sig_idx_t)                     );
+  fd_blockstore_sig_idx_ent_t * ents     = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_blockstore_sig_idx_ent_t),   ent_max*sizeof(fd_blockstore_sig_idx_ent_t)         );
+  void *                        addr_mem = FD_SCRATCH_ALLOC_APPEND( l, fd_blockstore_sig_idx_addr_map_align(), fd_blockstore_sig_idx_addr_map_footprint( ent_max ) );
+  FD_SCRATCH_ALLOC_FINI( l, FD_BLOCKSTORE_SIG_IDX_ALIGN );
+
+  fd_memset( idx, 0, sizeof(fd_blockstore_sig_idx_t) );
+  for( ulong i=0UL; i<ent_max; i++ ) ents[ i ].seq = FD_BLOCKSTORE_SIG_IDX_SEQ_NULL;
+
+  fd_blockstore_sig_idx_addr_t * addr_map = fd_blockstore_sig_idx_addr_map_join( fd_blockstore_sig_idx_addr_map_new( addr_mem, ent_max, seed ) );
+  if( FD_UNLIKELY( !addr_map ) ) {
+    FD_LOG_WARNING(( "fd_blockstore_sig_idx_addr_map_new failed" ));
+    return NULL;
+  }
+
+  idx->lg_ent_max = lg_ent_max;
+  idx->seq        = 0UL;
+  idx->slot_hi    = FD_SLOT_NULL;
+  idx->ent_off    = (ulong)ents     - (ulong)idx;
+  idx->addr_off   = (ulong)addr_map - (ulong)idx;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( idx->magic ) = FD_BLOCKSTORE_SIG_IDX_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_blockstore_sig_idx_t *
+fd_blockstore_sig_idx_join( void * shidx ) {
+  fd_blockstore_sig_idx_t * idx = (fd_blockstore_sig_idx_t *)shidx;
+
+  if( FD_UNLIKELY( !idx ) ) {
+    FD_LOG_WARNING(( "NULL shidx" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)idx, fd_blockstore_sig_idx_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shidx" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( idx->magic!=FD_BLOCKSTORE_SIG_IDX_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return idx;
+}
+
+void *
+fd_blockstore_sig_idx_leave( fd_blockstore_sig_idx_t * idx ) {
+  if( FD_UNLIKELY( !idx ) ) {
+    FD_LOG_WARNING(( "NULL idx" ));
+    return NULL;
+  }
+  return (void *)idx;
+}
+
+void *
+fd_blockstore_sig_idx_delete( void * shidx ) {
+  fd_blockstore_sig_idx_t * idx = (fd_blockstore_sig_idx_t *)shidx;
+
+  if( FD_UNLIKELY( !idx ) ) {
+    FD_LOG_WARNING(( "NULL shidx" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( idx->magic!=FD_BLOCKSTORE_SIG_IDX_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  fd_blockstore_sig_idx_addr_map_delete( fd_blockstore_sig_idx_addr_map_leave( fd_blockstore_sig_idx_addr_map( idx ) ) );
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( idx->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shidx;
+}
+
+void
+fd_blockstore_sig_idx_attach( fd_blockstore_t *         blockstore,
+                              fd_blockstore_sig_idx_t * idx ) {
+  ulong gaddr = idx ? fd_wksp_gaddr_fast( fd_blockstore_wksp( blockstore ), idx ) : 0UL;
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( blockstore->sig_idx_gaddr ) = gaddr;
+  FD_COMPILER_MFENCE();
+}
+
+void
+fd_blockstore_sig_idx_append( fd_blockstore_sig_idx_t * idx,
+                              fd_pubkey_t const *       addr,
+                              uchar const               sig[static FD_ED25519_SIG_SZ],
+                              ulong                     slot ) {
+  fd_blockstore_sig_idx_ent_t *  ents     = fd_blockstore_sig_idx_ents( idx );
+  fd_blockstore_sig_idx_addr_t * addr_map = fd_blockstore_sig_idx_addr_map( idx );
+
+  ulong                         seq = idx->seq;
+  fd_blockstore_sig_idx_ent_t * ent = ents + ( seq & ( ( 1UL<<idx->lg_ent_max ) - 1UL ) );
+
+  /* Evict the oldest entry.  If it was the newest entry of its address,
+     the whole history of the address is gone. */
+
+  if( FD_LIKELY( ent->seq!=FD_BLOCKSTORE_SIG_IDX_SEQ_NULL ) ) {
+    fd_blockstore_sig_idx_addr_t * old = addr_map + ent->addr_idx;
+    if( old->head==ent->seq ) fd_blockstore_sig_idx_addr_map_remove( addr_map, &old->addr );
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( ent->seq ) = FD_BLOCKSTORE_SIG_IDX_SEQ_NULL;
+    FD_COMPILER_MFENCE();
+  }
+
+  /* The addr map has as many slots as the ring, and every address in
+     the map has its newest entry in the ring, so this cannot fail. */
+
+  fd_blockstore_sig_idx_addr_t * ele = fd_blockstore_sig_idx_addr_map_query( addr_map, addr, NULL );
+  if( FD_UNLIKELY( !ele ) ) {
+    ele = fd_blockstore_sig_idx_addr_map_insert( addr_map, addr );
+    ele->head = FD_BLOCKSTORE_SIG_IDX_SEQ_NULL;
+  }
+
+  ent->prev     = ele->head;
+  ent->addr_idx = (ulong)( ele - addr_map );
+  ent->slot     = slot;
+  fd_memcpy( ent->sig, sig, FD_ED25519_SIG_SZ );
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( ent->seq ) = seq;
+  ele->head               = seq;
+  FD_VOLATILE( idx->seq ) = seq + 1UL;
+  FD_COMPILER_MFENCE();
+}
+
+ulong
+fd_blockstore_sig_idx_block_append( fd_blockstore_sig_idx_t * idx,
+                                    fd_blockstore_t *         blockstore,
+                                    fd_block_map_t const *    block_map_entry ) {
+  if( FD_UNLIKELY( !block_map_entry || !block_map_entry->block_gaddr ) ) return 0UL;
+
+  fd_wksp_t *        wksp  = fd_blockstore_wksp( blockstore );
+  fd_block_t const * block = fd_wksp_laddr_fast( wksp, block_map_entry->block_gaddr );
+  if( FD_UNLIKELY( !block->data_gaddr || !block->txns_gaddr ) ) return 0UL;
+
+  uchar const *              data = fd_wksp_laddr_fast( wksp, block->data_gaddr );
+  fd_block_txn_ref_t const * txns = fd_wksp_laddr_fast( wksp, block->txns_gaddr );
+  ulong                      slot = block_map_entry->slot;
+
+  ulong ent_cnt = 0UL;
+  for( ulong j = 0; j < block->txns_cnt; j++ ) {
+    fd_block_txn_ref_t const * ref = txns + j;
+    if( FD_UNLIKELY( ref->txn_off + ref->sz > block->data_sz ) ) continue;
+
+    uchar txn_out[FD_TXN_MAX_SZ];
+    uchar const * raw = data + ref->txn_off;
+    if( FD_UNLIKELY( !fd_txn_parse_core( raw, ref->sz, txn_out, NULL, NULL, 0 ) ) ) continue;
+    fd_txn_t const * txn = (fd_txn_t const *)txn_out;
+
+    /* There is a ref per signature, only index the txn once (by its
+       first signature) */
+
+    if( ref->id_off != ref->txn_off + txn->signature_off ) continue;
+
+    fd_acct_addr_t const * addrs = fd_txn_get_acct_addrs( txn, raw );
+    for( ulong k = 0; k < txn->acct_addr_cnt; k++ ) {
+      fd_blockstore_sig_idx_append( idx, (fd_pubkey_t const *)( addrs + k ), raw + txn->signature_off, slot );
+      ent_cnt++;
+    }
+  }
+
+  if( idx->slot_hi==FD_SLOT_NULL || slot > idx->slot_hi ) idx->slot_hi = slot;
+  return ent_cnt;
+}
+
+ulong
+fd_blockstore_sig_idx_slot_remove( fd_blockstore_sig_idx_t * idx,
+                                   ulong                     slot ) {
+  fd_blockstore_sig_idx_ent_t *  ents     = fd_blockstore_sig_idx_ents( idx );
+  fd_blockstore_sig_idx_addr_t * addr_map = fd_blockstore_sig_idx_addr_map( idx );
+  ulong                          ent_max  = 1UL<<idx->lg_ent_max;
+  ulong                          mask     = ent_max - 1UL;
+
+  /* Pop the newest entries while they belong to slot.  The popped entry
+     is the newest entry of its address, so the address head moves back
+     to the previous entry (or the address is removed if that entry is
+     gone too). */
+
+  ulong rm_cnt = 0UL;
+  while( idx->seq && rm_cnt < ent_max ) {
+    ulong                         seq = idx->seq - 1UL;
+    fd_blockstore_sig_idx_ent_t * ent = ents + ( seq & mask );
+    if( ent->seq!=seq || ent->slot!=slot ) break;
+
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( ent->seq ) = FD_BLOCKSTORE_SIG_IDX_SEQ_NULL;
+    FD_COMPILER_MFENCE();
+
+    fd_blockstore_sig_idx_addr_t * ele  = addr_map + ent->addr_idx;
+    ulong                          prev = ent->prev;
+    if( prev!=FD_BLOCKSTORE_SIG_IDX_SEQ_NULL && ents[ prev & mask ].seq==prev ) ele->head = prev;
+    else fd_blockstore_sig_idx_addr_map_remove( addr_map, &ele->addr );
+
+    FD_VOLATILE( idx->seq ) = seq;
+    rm_cnt++;
+  }
+
+  if( rm_cnt ) {
+    ulong                               seq = idx->seq - 1UL;
+    fd_blockstore_sig_idx_ent_t const * ent = ents + ( seq & mask );
+    idx->slot_hi = ( idx->seq && ent->seq==seq ) ? ent->slot : FD_SLOT_NULL;
+  }
+  return rm_cnt;
+}
+
+ulong
+fd_blockstore_sig_idx_query_volatile( fd_blockstore_t *             blockstore,
+                                      fd_pubkey_t const *           addr,
+                                      uchar const *                 before,
+                                      uchar const *                 until,
+                                      fd_blockstore_sig_idx_res_t * res,
+                                      ulong                         res_max ) {
+  fd_blockstore_sig_idx_t * idx = fd_blockstore_sig_idx_query_attached( blockstore );
+  if( FD_UNLIKELY( !idx ) ) return 0UL;
+
+  fd_blockstore_sig_idx_ent_t const *  ents     = fd_blockstore_sig_idx_ents( idx );
+  fd_blockstore_sig_idx_addr_t const * addr_map = fd_blockstore_sig_idx_addr_map( idx );
+  ulong                                ent_max  = 1UL<<idx->lg_ent_max;
+  ulong                                mask     = ent_max - 1UL;
+
+  for(;;) {
+    uint seqnum;
+    if( FD_UNLIKELY( fd_readwrite_start_concur_read( &blockstore->lock, &seqnum ) ) ) continue;
+
+    ulong res_cnt = 0UL;
+    fd_blockstore_sig_idx_addr_t const * ele = fd_blockstore_sig_idx_addr_map_query_safe( addr_map, addr, NULL );
+    ulong seq   = ele ? ele->head : FD_BLOCKSTORE_SIG_IDX_SEQ_NULL;
+    int   found = !before;
+
+    /* The walk is bounded so a concurrent write cannot make it run
+       away, the result is discarded in that case. */
+
+    for( ulong i = 0; i < ent_max && seq != FD_BLOCKSTORE_SIG_IDX_SEQ_NULL && res_cnt < res_max; i++ ) {
+      fd_blockstore_sig_idx_ent_t const * ent = ents + ( seq & mask );
+      if( FD_UNLIKELY( FD_VOLATILE_CONST( ent->seq ) != seq ) ) break; /* evicted */
+      if( FD_UNLIKELY( until && !memcmp( ent->sig, until, FD_ED25519_SIG_SZ ) ) ) break;
+      if( found ) {
+        fd_memcpy( res[ res_cnt ].sig, ent->sig, FD_ED25519_SIG_SZ );
+        res[ res_cnt ].slot = ent->slot;
+        res_cnt++;
+      } else {
+        found = !memcmp( ent->sig, before, FD_ED25519_SIG_SZ );
+      }
+      seq = ent->prev;
+    }
+
+    if( FD_UNLIKELY( fd_readwrite_check_concur_read( &blockstore->lock, seqnum ) ) ) continue;
+
+    return res_cnt;
+  }
+}
@@ -0,0 +1,202 @@
+#ifndef HEADER_fd_src_flamenco_runtime_fd_blockstore_sig_idx_h
+#define HEADER_fd_src_flamenco_runtime_fd_blockstore_sig_idx_h
+
+/* fd_blockstore_sig_idx is an address to transaction signature history
+   index of the blockstore (the index behind getSignaturesForAddress).
+
+   The index is a ring of entries that lives in the blockstore wksp.
+   fd_blockstore_publish appends one entry per (account address, txn)
+   of every block it roots, in block order, as long as the block stays
+   queryable: the new root is indexed, and the other rooted slots that
+   publish prunes are only indexed if they were archived.  When publish
+   prunes the previous root without archiving it, its entries (the
+   newest ones) are removed again.  Each entry links to the previous
+   entry of the same address, so the history of an address is walked
+   newest to oldest without touching any block:
+
+     addr map:  addr -> seq of its newest entry
+     ring:      [ ... | seq prev addr slot sig | ... ]
+                          |
+                          +--> previous entry of addr (seq) --> ...
+
+   Entries are identified by a seq assigned in append order and stored
+   at ring index seq mod ent_max.  When the ring is full, publish
+   overwrites the oldest entries, which implicitly truncates the
+   history of every address to the last ent_max indexed (address,txn)
+   pairs.  An address is removed from the addr map when its newest
+   entry is overwritten, so the map never holds more than ent_max
+   addresses.
+
+   Only the static account keys of a txn are indexed (addresses loaded
+   from address lookup tables are not resolved here).  A txn is
+   identified by its first signature.
+
+   The index is modified under the blockstore write lock (by publish).
+   Readers in any process use fd_blockstore_sig_idx_query_volatile,
+   which follows the blockstore concurrent read protocol. */
+
+#include "fd_blockstore.h"
+
+/* FD_BLOCKSTORE_SIG_IDX_{ALIGN,MAGIC} */
+
+#define FD_BLOCKSTORE_SIG_IDX_ALIGN (128UL)
+#define FD_BLOCKSTORE_SIG_IDX_MAGIC (0xf17eda2ce7516100UL) /* firedancer sig idx version 0 */
+
+#define FD_BLOCKSTORE_SIG_IDX_SEQ_NULL (ULONG_MAX)
+
+/* A ring entry.  seq is FD_BLOCKSTORE_SIG_IDX_SEQ_NULL while the entry
+   is free or being written. */
+
+struct fd_blockstore_sig_idx_ent {
+  ulong seq;
+  ulong prev;     /* seq of the previous entry of the address, SEQ_NULL if none */
+  ulong addr_idx; /* index of the address in the addr map */
+  ulong slot;
+  uchar sig[FD_ED25519_SIG_SZ];
+};
+typedef struct fd_blockstore_sig_idx_ent fd_blockstore_sig_idx_ent_t;
+
+struct fd_blockstore_sig_idx_addr {
+  fd_pubkey_t addr;
+  ulong       next; /* reserved for use by fd_map_giant.c */
+  ulong       head; /* seq of the newest entry of the address */
+};
+typedef struct fd_blockstore_sig_idx_addr fd_blockstore_sig_idx_addr_t;
+
+/* clang-format off */
+#define MAP_NAME               fd_blockstore_sig_idx_addr_map
+#define MAP_T                  fd_blockstore_sig_idx_addr_t
+#define MAP_KEY                addr
+#define MAP_KEY_T              fd_pubkey_t
+#define MAP_KEY_EQ(k0,k1)      (!memcmp( (k0), (k1), sizeof(fd_pubkey_t) ))
+#define MAP_KEY_HASH(key,seed) fd_hash( (seed), (key), sizeof(fd_pubkey_t) )
+#define MAP_KEY_COPY(kd,ks)    fd_memcpy( (kd), (ks), sizeof(fd_pubkey_t) )
+#define MAP_MAGIC              (0xf17eda2ce75161a0UL) /* firedancer sig idx addrs version 0 */
+#define MAP_IMPL_STYLE         1
+#include "../../util/tmpl/fd_map_giant.c"
+/* clang-format on */
+
+struct __attribute__((aligned(FD_BLOCKSTORE_SIG_IDX_ALIGN))) fd_blockstore_sig_idx {
+  ulong magic;      /* ==FD_BLOCKSTORE_SIG_IDX_MAGIC */
+  ulong lg_ent_max; /* log2 of the ring capacity */
+  ulong seq;        /* seq of the next entry to append */
+  ulong slot_hi;    /* highest indexed slot, FD_SLOT_NULL if none */
+  ulong ent_off;    /* offset of the ring from the start of the index */
+  ulong addr_off;   /* offset of the addr map join from the start of the index */
+};
+typedef struct fd_blockstore_sig_idx fd_blockstore_sig_idx_t;
+
+/* A query result */
+
+struct fd_blockstore_sig_idx_res {
+  uchar sig[FD_ED25519_SIG_SZ];
+  ulong slot;
+};
+typedef struct fd_blockstore_sig_idx_res fd_blockstore_sig_idx_res_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* Constructors */
+
+FD_FN_CONST ulong
+fd_blockstore_sig_idx_align( void );
+
+FD_FN_CONST ulong
+fd_blockstore_sig_idx_footprint( ulong lg_ent_max );
+
+/* fd_blockstore_sig_idx_new formats shmem as an index holding the last
+   2^lg_ent_max (address,txn) pairs.  The usual new/join/leave/delete
+   semantics apply.  The index is position independent. */
+
+void *
+fd_blockstore_sig_idx_new( void * shmem,
+                           ulong  seed,
+                           ulong  lg_ent_max );
+
+fd_blockstore_sig_idx_t *
+fd_blockstore_sig_idx_join( void * shidx );
+
+void *
+fd_blockstore_sig_idx_leave( fd_blockstore_sig_idx_t * idx );
+
+void *
+fd_blockstore_sig_idx_delete( void * shidx );
+
+/* fd_blockstore_sig_idx_attach makes idx (which must be in the
+   blockstore wksp) the signature index of blockstore.  NULL detaches
+   the index.  Caller holds the blockstore write lock. */
+
+void
+fd_blockstore_sig_idx_attach( fd_blockstore_t *         blockstore,
+                              fd_blockstore_sig_idx_t * idx );
+
+/* fd_blockstore_sig_idx_query_attached returns the signature index of
+   blockstore in the caller's address space or NULL if none. */
+
+FD_FN_PURE static inline fd_blockstore_sig_idx_t *
+fd_blockstore_sig_idx_query_attached( fd_blockstore_t * blockstore ) {
+  ulong gaddr = FD_VOLATILE_CONST( blockstore->sig_idx_gaddr );
+  return gaddr ? (fd_blockstore_sig_idx_t *)fd_wksp_laddr_fast( fd_blockstore_wksp( blockstore ), gaddr ) : NULL;
+}
+
+/* Accessors */
+
+FD_FN_PURE static inline fd_blockstore_sig_idx_ent_t *
+fd_blockstore_sig_idx_ents( fd_blockstore_sig_idx_t * idx ) {
+  return (fd_blockstore_sig_idx_ent_t *)( (ulong)idx + idx->ent_off );
+}
+
+FD_FN_PURE static inline fd_blockstore_sig_idx_addr_t *
+fd_blockstore_sig_idx_addr_map( fd_blockstore_sig_idx_t * idx ) {
+  return (fd_blockstore_sig_idx_addr_t *)( (ulong)idx + idx->addr_off );
+}
+
+/* Writer API.  Caller holds the blockstore write lock. */
+
+/* fd_blockstore_sig_idx_append appends the (addr,sig) pair of a txn in
+   slot, evicting the oldest entry if the ring is full. */
+
+void
+fd_blockstore_sig_idx_append( fd_blockstore_sig_idx_t * idx,
+                              fd_pubkey_t const *       addr,
+                              uchar const               sig[static FD_ED25519_SIG_SZ],
+                              ulong                     slot );
+
+/* fd_blockstore_sig_idx_block_append appends every txn of the block of
+   block_map_entry (a no-op if the block has no data).  Returns the
+   number of entries appended. */
+
+ulong
+fd_blockstore_sig_idx_block_append( fd_blockstore_sig_idx_t * idx,
+                                    fd_blockstore_t *         blockstore,
+                                    fd_block_map_t const *    block_map_entry );
+
+/* fd_blockstore_sig_idx_slot_remove removes the entries of slot, which
+   must be the newest indexed slot (e.g. the previous root when publish
+   prunes it without archiving it).  Addresses whose history becomes
+   empty leave the addr map.  Returns the number of entries removed. */
+
+ulong
+fd_blockstore_sig_idx_slot_remove( fd_blockstore_sig_idx_t * idx,
+                                   ulong                     slot );
+
+/* Reader API */
+
+/* fd_blockstore_sig_idx_query_volatile copies up to res_max signatures
+   of txns that reference addr into res, newest first, and returns the
+   number copied.  If before is non-NULL, the walk starts after that
+   signature (and nothing is returned if the signature is not in the
+   history of addr).  If until is non-NULL, the walk stops before that
+   signature.  Safe to call concurrently with the writer. */
+
+ulong
+fd_blockstore_sig_idx_query_volatile( fd_blockstore_t *             blockstore,
+                                      fd_pubkey_t const *           addr,
+                                      uchar const *                 before,
+                                      uchar const *                 until,
+                                      fd_blockstore_sig_idx_res_t * res,
+                                      ulong                         res_max );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_flamenco_runtime_fd_blockstore_sig_idx_h */
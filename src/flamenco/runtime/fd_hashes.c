@@ -31,35 +31,241 @@ fd_pubkey_hash_pair_compare(fd_pubkey_hash_pair_t const * a, fd_pubkey_hash_pair
 #define SORT_BEFORE(a,b) fd_pubkey_hash_pair_compare(&a, &b)
 #include "../../util/tmpl/fd_sort.c"
 
+/* A fd_account_deltas_sort_ele_t is a pair along with the most
+   significant 8 bytes of its sort key, such that sorting a large number
+   of pairs rarely has to chase the pubkey pointers. */
+
+struct fd_account_deltas_sort_ele {
+  ulong                 key;
+  fd_pubkey_hash_pair_t pair;
+};
+typedef struct fd_account_deltas_sort_ele fd_account_deltas_sort_ele_t;
+
+#define SORT_NAME        sort_account_deltas_ele
+#define SORT_KEY_T       fd_account_deltas_sort_ele_t
+#define SORT_BEFORE(a,b) ( ((a).key<(b).key) || ( ((a).key==(b).key) && fd_pubkey_hash_pair_compare( &(a).pair, &(b).pair ) ) )
+#include "../../util/tmpl/fd_sort.c"
+
 #define FD_ACCOUNT_DELTAS_MERKLE_FANOUT (16UL)
-#define FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT (16UL)
 
-void
-fd_hash_account_deltas( fd_pubkey_hash_pair_t * pairs, ulong pairs_len, fd_hash_t * hash, fd_exec_slot_ctx_t * slot_ctx FD_PARAM_UNUSED ) {
-  fd_sha256_t shas[FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT];
-  uchar       num_hashes[FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT+1];
+/* Large numbers of pairs are sorted by partitioning them into buckets
+   on the first byte of the pubkey (the most significant byte of the
+   sort key) and then sorting each bucket independently.  When there
+   are enough pairs (pubkeys are effectively uniform random), the
+   partitioning and the bucket sorts are split over the tpool.  Likewise, each level of the
+   merkle tree is hashed FD_SHA256_BATCH_MAX nodes at a time and, when
+   the level is wide enough, split over the tpool. */
+
+#define FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT (256UL)
+#define FD_ACCOUNT_DELTAS_SORT_PARA_MIN   (8192UL) /* Min pairs per worker worth parallelizing the sort */
+#define FD_ACCOUNT_DELTAS_MERKLE_PARA_MIN (256UL)  /* Min nodes per worker worth parallelizing a merkle level */
+
+struct fd_account_deltas_sort_args {
+  fd_pubkey_hash_pair_t *        pairs;
+  fd_account_deltas_sort_ele_t * tmp;        /* Indexed [0,pairs_len) */
+  ulong *                        hist;       /* Indexed [0,worker_cnt*FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT) */
+  ulong *                        bucket_off; /* Indexed [0,FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT] */
+};
+typedef struct fd_account_deltas_sort_args fd_account_deltas_sort_args_t;
 
-  // Init the number of hashes
-  fd_memset( num_hashes, 0, sizeof(num_hashes) );
+struct fd_account_deltas_merkle_args {
+  fd_pubkey_hash_pair_t const * pairs;  /* Leaves of the tree if hashing the lowest level, NULL otherwise */
+  fd_hash_t const *             in;     /* Nodes of the level below if not hashing the lowest level */
+  ulong                         in_cnt;
+  fd_hash_t *                   out;    /* Indexed [0,ceil(in_cnt/FANOUT)) */
+};
+typedef struct fd_account_deltas_merkle_args fd_account_deltas_merkle_args_t;
 
-  // FD_LOG_DEBUG(("sorting %d", pairs_len));
-  // long timer_sort = -fd_log_wallclock();
-  sort_pubkey_hash_pair_inplace( pairs, pairs_len );
-  // timer_sort += fd_log_wallclock();
-  // FD_LOG_DEBUG(("sorting done %6.3f ms", (double)timer_sort*(1e-6)));
+/* fd_account_deltas_exec runs task over tasks [0,task_cnt) blocked over
+   tpool workers [0,worker_cnt).  A worker_cnt of 1 runs task on the
+   caller (tpool can be NULL). */
+
+static void
+fd_account_deltas_exec( fd_tpool_t *    tpool,
+                        ulong           worker_cnt,
+                        fd_tpool_task_t task,
+                        void *          args,
+                        ulong           task_cnt ) {
+  if( worker_cnt>1UL ) fd_tpool_exec_all_batch( tpool, 0UL, worker_cnt, task, args, NULL, NULL, 1UL, 0UL, task_cnt );
+  else                 task( args, 0UL, 1UL, NULL, NULL, 1UL, 0UL, task_cnt, 0UL, task_cnt, 0UL, 1UL );
+}
+
+static ulong
+fd_account_deltas_worker_cnt( fd_tpool_t * tpool,
+                              ulong        max_workers,
+                              ulong        work_cnt,
+                              ulong        work_min ) {
+  if( !tpool ) return 1UL;
+  return fd_ulong_max( fd_ulong_min( work_cnt / work_min, max_workers ), 1UL );
+}
+
+/* Counts the pairs [m0,m1) per bucket into worker n0's histogram */
+
+static void
+fd_account_deltas_sort_hist_task( void * tpool,
+                                  ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
+                                  void *args FD_PARAM_UNUSED,
+                                  void *reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                                  ulong l0 FD_PARAM_UNUSED, ulong l1 FD_PARAM_UNUSED,
+                                  ulong m0, ulong m1,
+                                  ulong n0, ulong n1 FD_PARAM_UNUSED ) {
+  fd_account_deltas_sort_args_t * sort  = (fd_account_deltas_sort_args_t *)tpool;
+  fd_pubkey_hash_pair_t const *   pairs = sort->pairs;
+  ulong *                         hist  = sort->hist + n0*FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT;
+
+  memset( hist, 0, FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT*sizeof(ulong) );
+  for( ulong i=m0; i<m1; i++ ) hist[ pairs[i].pubkey->uc[0] ]++;
+}
+
+/* Scatters the pairs [m0,m1) into their buckets.  On entry, worker
+   n0's histogram holds where its first pair of each bucket goes. */
+
+static void
+fd_account_deltas_sort_scatter_task( void * tpool,
+                                     ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
+                                     void *args FD_PARAM_UNUSED,
+                                     void *reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                                     ulong l0 FD_PARAM_UNUSED, ulong l1 FD_PARAM_UNUSED,
+                                     ulong m0, ulong m1,
+                                     ulong n0, ulong n1 FD_PARAM_UNUSED ) {
+  fd_account_deltas_sort_args_t * sort  = (fd_account_deltas_sort_args_t *)tpool;
+  fd_pubkey_hash_pair_t const *   pairs = sort->pairs;
+  fd_account_deltas_sort_ele_t *  tmp   = sort->tmp;
+  ulong *                         next  = sort->hist + n0*FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT;
+
+  for( ulong i=m0; i<m1; i++ ) {
+    ulong key = __builtin_bswap64( pairs[i].pubkey->ul[0] ); /* See fd_pubkey_hash_pair_compare */
+    tmp[ next[ key>>56 ]++ ] = (fd_account_deltas_sort_ele_t){ .key = key, .pair = pairs[i] };
+  }
+}
+
+/* Sorts buckets [m0,m1) and copies them back to the pairs.  Pairs are
+   sorted with the cached key which settles nearly all comparisons. */
+
+static void
+fd_account_deltas_sort_bucket_task( void * tpool,
+                                    ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
+                                    void *args FD_PARAM_UNUSED,
+                                    void *reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                                    ulong l0 FD_PARAM_UNUSED, ulong l1 FD_PARAM_UNUSED,
+                                    ulong m0, ulong m1,
+                                    ulong n0 FD_PARAM_UNUSED, ulong n1 FD_PARAM_UNUSED ) {
+  fd_account_deltas_sort_args_t * sort       = (fd_account_deltas_sort_args_t *)tpool;
+  ulong const *                   bucket_off = sort->bucket_off;
+
+  for( ulong b=m0; b<m1; b++ ) sort_account_deltas_ele_inplace( sort->tmp + bucket_off[b], bucket_off[b+1UL] - bucket_off[b] );
+
+  for( ulong i=bucket_off[m0]; i<bucket_off[m1]; i++ ) sort->pairs[i] = sort->tmp[i].pair;
+}
+
+/* Hashes nodes [m0,m1) of the merkle level above args->in / args->pairs */
+
+static void
+fd_account_deltas_merkle_task( void * tpool,
+                               ulong t0 FD_PARAM_UNUSED, ulong t1 FD_PARAM_UNUSED,
+                               void *args FD_PARAM_UNUSED,
+                               void *reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                               ulong l0 FD_PARAM_UNUSED, ulong l1 FD_PARAM_UNUSED,
+                               ulong m0, ulong m1,
+                               ulong n0 FD_PARAM_UNUSED, ulong n1 FD_PARAM_UNUSED ) {
+  fd_account_deltas_merkle_args_t * merkle = (fd_account_deltas_merkle_args_t *)tpool;
+  fd_pubkey_hash_pair_t const *     pairs  = merkle->pairs;
+  ulong                             in_cnt = merkle->in_cnt;
+
+  uchar     _batch[ FD_SHA256_BATCH_FOOTPRINT ] __attribute__((aligned(FD_SHA256_BATCH_ALIGN)));
+  fd_hash_t leaves[ FD_SHA256_BATCH_MAX ][ FD_ACCOUNT_DELTAS_MERKLE_FANOUT ]; /* Leaves are not contiguous in memory */
+
+  for( ulong node0=m0; node0<m1; node0+=FD_SHA256_BATCH_MAX ) {
+    ulong node1 = fd_ulong_min( node0+FD_SHA256_BATCH_MAX, m1 );
+
+    fd_sha256_batch_t * sha = fd_sha256_batch_init( _batch );
+    for( ulong node=node0; node<node1; node++ ) {
+      ulong             child0    = node*FD_ACCOUNT_DELTAS_MERKLE_FANOUT;
+      ulong             child_cnt = fd_ulong_min( in_cnt-child0, FD_ACCOUNT_DELTAS_MERKLE_FANOUT );
+      fd_hash_t const * msg       = merkle->in + child0;
+      if( pairs ) {
+        fd_hash_t * gather = leaves[ node-node0 ];
+        for( ulong j=0UL; j<child_cnt; j++ ) gather[j] = *pairs[ child0+j ].hash;
+        msg = gather;
+      }
+      fd_sha256_batch_add( sha, msg, child_cnt*sizeof(fd_hash_t), merkle->out + node );
+    }
+    fd_sha256_batch_fini( sha );
+  }
+}
+
+static void
+fd_account_deltas_sort( fd_pubkey_hash_pair_t * pairs,
+                        ulong                   pairs_len,
+                        fd_valloc_t             valloc,
+                        fd_tpool_t *            tpool,
+                        ulong                   max_workers ) {
+  if( pairs_len<FD_ACCOUNT_DELTAS_SORT_PARA_MIN ) {
+    sort_pubkey_hash_pair_inplace( pairs, pairs_len );
+    return;
+  }
+
+  ulong worker_cnt = fd_account_deltas_worker_cnt( tpool, max_workers, pairs_len, FD_ACCOUNT_DELTAS_SORT_PARA_MIN );
+
+  fd_account_deltas_sort_args_t sort[1];
+  sort->pairs      = pairs;
+  sort->tmp        = fd_valloc_malloc( valloc, alignof(fd_account_deltas_sort_ele_t), pairs_len*sizeof(fd_account_deltas_sort_ele_t) );
+  sort->hist       = fd_valloc_malloc( valloc, alignof(ulong), (worker_cnt*FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT + FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT+1UL)*sizeof(ulong) );
+  if( FD_UNLIKELY( !sort->tmp || !sort->hist ) ) FD_LOG_ERR(( "failed to allocate account deltas sort scratch (%lu pairs)", pairs_len ));
+  sort->bucket_off = sort->hist + worker_cnt*FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT;
+
+  fd_account_deltas_exec( tpool, worker_cnt, fd_account_deltas_sort_hist_task, sort, pairs_len );
+
+  /* Turn the histograms into where each worker puts its first pair of
+     each bucket (workers scatter in the same order they counted, such
+     that the partitioning is deterministic) */
+
+  ulong off = 0UL;
+  for( ulong b=0UL; b<FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT; b++ ) {
+    sort->bucket_off[b] = off;
+    for( ulong t=0UL; t<worker_cnt; t++ ) {
+      ulong * cnt = sort->hist + t*FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT + b;
+      ulong   tmp = *cnt;
+      *cnt = off;
+      off += tmp;
+    }
+  }
+  sort->bucket_off[ FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT ] = off;
+
+  fd_account_deltas_exec( tpool, worker_cnt, fd_account_deltas_sort_scatter_task, sort, pairs_len                         );
+  fd_account_deltas_exec( tpool, worker_cnt, fd_account_deltas_sort_bucket_task,  sort, FD_ACCOUNT_DELTAS_SORT_BUCKET_CNT );
 
-  // FD_LOG_DEBUG(("fancy bmtree started"));
-  for( ulong j = 0; j < FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT; ++j ) {
-    fd_sha256_init( &shas[j] );
+  fd_valloc_free( valloc, sort->hist );
+  fd_valloc_free( valloc, sort->tmp  );
 }
 
+void
+fd_hash_account_deltas( fd_pubkey_hash_pair_t * pairs, ulong pairs_len, fd_hash_t * hash, fd_exec_slot_ctx_t * slot_ctx ) {
+  fd_hash_account_deltas_tpool( pairs, pairs_len, hash, slot_ctx, NULL, 1UL );
+}
+
+void
+fd_hash_account_deltas_tpool( fd_pubkey_hash_pair_t * pairs,
+                              ulong                   pairs_len,
+                              fd_hash_t *             hash,
+                              fd_exec_slot_ctx_t *    slot_ctx,
+                              fd_tpool_t *            tpool,
+                              ulong                   max_workers ) {
   if( pairs_len == 0 ) {
-    fd_sha256_fini( &shas[0], hash->hash );
+    fd_sha256_t sha;
+    fd_sha256_init( &sha );
+    fd_sha256_fini( &sha, hash->hash );
     return;
   }
 
-  for( ulong i = 0; i < pairs_len; ++i ) {
+  // FD_LOG_DEBUG(("sorting %d", pairs_len));
+  // long timer_sort = -fd_log_wallclock();
+  fd_account_deltas_sort( pairs, pairs_len, slot_ctx->valloc, tpool, max_workers );
+  // timer_sort += fd_log_wallclock();
+  // FD_LOG_DEBUG(("sorting done %6.3f ms", (double)timer_sort*(1e-6)));
+
 #ifdef VLOG
+  for( ulong i = 0; i < pairs_len; ++i ) {
     {
     //if ( slot_ctx->slot_bank.slot == 257040000 )
       FD_LOG_NOTICE(( "account delta hash X { \"key\":%ld, \"pubkey\":\"%32J\", \"hash\":\"%32J\" },", i, pairs[i].pubkey->key, pairs[i].hash->hash));
@@ -103,84 +309,41 @@ fd_hash_account_deltas( fd_pubkey_hash_pair_t * pairs, ulong pairs_len, fd_hash_
         fd_valloc_free(slot_ctx->valloc, acc_data_str);
       }
     }
-#endif
-
-    fd_sha256_append( &shas[0], pairs[i].hash->hash, sizeof( fd_hash_t ) );
-    num_hashes[0]++;
-
-    for( ulong j = 0; j < FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT; ++j ) {
-      if (num_hashes[j] == FD_ACCOUNT_DELTAS_MERKLE_FANOUT) {
-        num_hashes[j] = 0;
-        num_hashes[j+1]++;
-        fd_sha256_fini( &shas[j], hash->hash );
-        fd_sha256_init( &shas[j] );
-        fd_sha256_append( &shas[j+1], (uchar const *) hash->hash, sizeof( fd_hash_t ) );
-      } else {
-        break;
-      }
-    }
-  }
-
-  ulong tot_num_hashes = 0;
-  for (ulong k = 0; k < FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT; ++k ) {
-    tot_num_hashes += num_hashes[k];
-  }
-
-  if (tot_num_hashes == 1) {
-    return;
-  }
-
-  // TODO: use CZT on pairs_len
-  ulong height = 0;
-  for( long i = FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT-1; i >= 0; --i ) {
-    if( num_hashes[i] != 0 ) {
-      height = (ulong) i + 1;
-      break;
-    }
   }
+#endif
 
-
-  for( ulong i = 0; i < height; ++i ) {
-    if( num_hashes[i]==0 ) {
-      continue;
-    }
-    // At level i, finalize and append to i + 1
-    //fd_hash_t sub_hash;
-    fd_sha256_fini( &shas[i], hash );
-    num_hashes[i] = 0;
-    num_hashes[i+1]++;
-
-    ulong tot_num_hashes = 0;
-    for (ulong k = 0; k < FD_ACCOUNT_DELTAS_MAX_MERKLE_HEIGHT; ++k ) {
-      tot_num_hashes += num_hashes[k];
-    }
-    if (i == (height-1)) {
-      assert(tot_num_hashes == 1);
-      return;
-    }
-    fd_sha256_append( &shas[i+1], (uchar const *) hash->hash, sizeof( fd_hash_t ) );
-
-    // There is now one more hash at level i+1
-
-    // check, have we filled this level and ones above it.
-    for( ulong j = i+1; j < height; ++j ) {
-      // if the level is full, finalize and push into next level.
-      if (num_hashes[j] == FD_ACCOUNT_DELTAS_MERKLE_FANOUT) {
-        num_hashes[j] = 0;
-        num_hashes[j+1]++;
-        fd_hash_t sub_hash;
-        fd_sha256_fini( &shas[j], &sub_hash );
-        if (j != height - 1) {
-          fd_sha256_append( &shas[j+1], (uchar const *) sub_hash.hash, sizeof( fd_hash_t ) );
-        } else {
-          memcpy(hash->hash, sub_hash.hash, sizeof(fd_hash_t));
-          return;
-        }
-      }
-    }
+  /* Hash the tree level by level.  Each level is hashed from the one
+     below into alternating buffers (the lowest level is hashed straight
+     from the pairs), until a level has a single node (the root).  Like
+     Agave's compute_merkle_root_loop, the lowest level is always
+     hashed, so a single pair yields the hash of its lone leaf. */
+
+  ulong       node_cnt = (pairs_len + FD_ACCOUNT_DELTAS_MERKLE_FANOUT-1UL) / FD_ACCOUNT_DELTAS_MERKLE_FANOUT;
+  ulong       buf_cnt  = (node_cnt  + FD_ACCOUNT_DELTAS_MERKLE_FANOUT-1UL) / FD_ACCOUNT_DELTAS_MERKLE_FANOUT;
+  fd_hash_t * buf[2];
+  buf[0] = fd_valloc_malloc( slot_ctx->valloc, alignof(fd_hash_t), (node_cnt+buf_cnt)*sizeof(fd_hash_t) );
+  if( FD_UNLIKELY( !buf[0] ) ) FD_LOG_ERR(( "failed to allocate account deltas merkle scratch (%lu pairs)", pairs_len ));
+  buf[1] = buf[0] + node_cnt;
+
+  fd_account_deltas_merkle_args_t merkle[1];
+  merkle->pairs  = pairs;
+  merkle->in     = NULL;
+  merkle->in_cnt = pairs_len;
+
+  for( ulong level=0UL;; level++ ) {
+    merkle->out = buf[ level & 1UL ];
+    ulong worker_cnt = fd_account_deltas_worker_cnt( tpool, max_workers, node_cnt, FD_ACCOUNT_DELTAS_MERKLE_PARA_MIN );
+    fd_account_deltas_exec( tpool, worker_cnt, fd_account_deltas_merkle_task, merkle, node_cnt );
+    if( node_cnt==1UL ) break;
+
+    merkle->pairs  = NULL;
+    merkle->in     = merkle->out;
+    merkle->in_cnt = node_cnt;
+    node_cnt       = (node_cnt + FD_ACCOUNT_DELTAS_MERKLE_FANOUT-1UL) / FD_ACCOUNT_DELTAS_MERKLE_FANOUT;
   }
 
-  // If the level at the `height' was rolled into, do something about it
+  *hash = merkle->out[0];
+  fd_valloc_free( slot_ctx->valloc, buf[0] );
 }
 
 
@@ -278,11 +441,13 @@ fd_hash_bank( fd_exec_slot_ctx_t * slot_ctx,
               fd_capture_ctx_t * capture_ctx,
               fd_hash_t * hash,
               fd_pubkey_hash_pair_t * dirty_keys,
-              ulong dirty_key_cnt ) {
+              ulong dirty_key_cnt,
+              fd_tpool_t * tpool,
+              ulong max_workers ) {
   slot_ctx->prev_banks_hash = slot_ctx->slot_bank.banks_hash;
   slot_ctx->parent_signature_cnt = slot_ctx->signature_cnt;
 
-  fd_hash_account_deltas( dirty_keys, dirty_key_cnt, &slot_ctx->account_delta_hash, slot_ctx );
+  fd_hash_account_deltas_tpool( dirty_keys, dirty_key_cnt, &slot_ctx->account_delta_hash, slot_ctx, tpool, max_workers );
 
   fd_sha256_t sha;
   fd_sha256_init( &sha );
@@ -538,7 +703,7 @@ fd_update_hash_bank_tpool( fd_exec_slot_ctx_t * slot_ctx,
   // FD_LOG_DEBUG(("slot %ld, dirty %ld", slot_ctx->slot_bank.slot, dirty_key_cnt));
 
   slot_ctx->signature_cnt = signature_cnt;
-  fd_hash_bank( slot_ctx, capture_ctx, hash, dirty_keys, dirty_key_cnt);
+  fd_hash_bank( slot_ctx, capture_ctx, hash, dirty_keys, dirty_key_cnt, tpool, max_workers );
 
 #ifdef _ENABLE_LTHASH
   // Sanity-check LT Hash
@@ -803,7 +968,7 @@ fd_update_hash_bank( fd_exec_slot_ctx_t * slot_ctx,
   // FD_LOG_DEBUG(("slot %ld, dirty %ld", slot_ctx->slot_bank.slot, dirty_key_cnt));
 
   slot_ctx->signature_cnt = signature_cnt;
-  fd_hash_bank( slot_ctx, capture_ctx, hash, dirty_keys, dirty_key_cnt );
+  fd_hash_bank( slot_ctx, capture_ctx, hash, dirty_keys, dirty_key_cnt, NULL, 1UL );
 
 #ifdef _ENABLE_LTHASH
   // Sanity-check LT Hash
@@ -894,115 +1059,319 @@ fd_hash_account_current( uchar                      hash  [ static 32 ],
     return fd_hash_account_v0( hash, account, pubkey, data, slot_ctx->slot_bank.slot );
 }
 
-struct accounts_hash {
-  fd_funk_rec_t * key;
-  ulong  hash;
+/* Full state scans ***************************************************/
+
+/* The accounts hash and the lthash of the whole account database are
+   computed by scanning the funk rec map in parallel.  Workers claim
+   FD_ACCOUNTS_SCAN_CHUNK_SZ map slots at a time (records are not
+   uniformly spread over the map so static blocks would be poorly
+   balanced).  Each worker sums the lthash of the accounts it sees and
+   the per worker sums are reduced in worker order at the end.  Accounts
+   hash pairs are appended to a shared array in whatever order the
+   chunks complete and sorted before hashing.  As such, neither result
+   depends on the worker count or on which worker saw which record. */
+
+#define FD_ACCOUNTS_SCAN_CHUNK_SZ (4096UL)
+
+struct __attribute__((aligned(FD_LTHASH_ALIGN))) fd_accounts_scan_worker {
+  fd_lthash_value_t       lthash; /* Sum of the lthashes of the accounts seen by this worker */
+  fd_pubkey_hash_pair_t * pairs;  /* Indexed [0,FD_ACCOUNTS_SCAN_CHUNK_SZ), pairs of the current chunk */
+  fd_hash_t *             dead;   /* Indexed [0,FD_ACCOUNTS_SCAN_CHUNK_SZ), dead[i] is the hash of pairs[i] if dead */
+};
+typedef struct fd_accounts_scan_worker fd_accounts_scan_worker_t;
+
+struct fd_accounts_scan {
+  fd_exec_slot_ctx_t *        slot_ctx;
+  fd_funk_txn_t const *       txn;            /* See fd_accounts_scan_rec */
+  uint                        txn_cidx;
+  int                         visible;
+  ulong                       do_hash_verify; /* Accounts hash only */
+  int                         with_dead;      /* Accounts hash only */
+  ulong                       rec_next;       /* Next funk rec map slot to claim, atomic */
+  ulong                       pair_cnt;       /* Number of pairs appended so far, atomic */
+  fd_pubkey_hash_pair_t *     pairs;          /* Indexed [0,rec_cnt) */
+  fd_hash_t *                 dead;           /* Indexed [0,rec_cnt), hashes of dead accounts (if with_dead) */
+  fd_accounts_scan_worker_t * worker;         /* Indexed [0,worker_cnt) */
 };
-typedef struct accounts_hash accounts_hash_t;
+typedef struct fd_accounts_scan fd_accounts_scan_t;
+
+/* fd_accounts_scan_rec returns 1 if rec is an account record the scan
+   should include and 0 otherwise.  If visible is 0, these are the
+   account records of the transaction whose compressed index is
+   txn_cidx (FD_FUNK_TXN_IDX_NULL for the last published transaction).
+   Otherwise, these are the most recent versions of the accounts in txn
+   and its ancestors.  Erased records are never included. */
+
+static inline int
+fd_accounts_scan_rec( fd_accounts_scan_t const * scan,
+                      fd_funk_t *                funk,
+                      fd_funk_rec_t const *      rec ) {
+  if( fd_funk_rec_map_private_unbox_tag( rec->map_next ) ) return 0; /* Free map slot */
+  if( !fd_funk_key_is_acc( rec->pair.key )               ) return 0;
+  if( rec->flags & FD_FUNK_REC_FLAG_ERASE                ) return 0; /* No value */
+  if( !scan->visible ) return rec->txn_cidx==scan->txn_cidx;
+  return fd_funk_rec_query_global( funk, scan->txn, rec->pair.key )==rec;
+}
 
-#define MAP_NAME accounts_hash
-#define MAP_KEY_T fd_funk_rec_t *
-#define MAP_HASH_T ulong
-#define MAP_KEY_EQUAL(k0,k1) ((NULL != k0) && (NULL != k1) && fd_funk_rec_key_eq( k0->pair.key, k1->pair.key ))
-#define MAP_KEY_HASH(p) fd_funk_rec_key_hash( p->pair.key, 2887034UL )
-#define MAP_KEY_EQUAL_IS_SLOW 1
-#define MAP_KEY_NULL 0UL
-#define MAP_KEY_INVAL(k) (NULL == k)
+static void
+fd_accounts_hash_task( void * tpool,
+                       ulong  t0     FD_PARAM_UNUSED, ulong t1     FD_PARAM_UNUSED,
+                       void * args   FD_PARAM_UNUSED,
+                       void * reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                       ulong  l0     FD_PARAM_UNUSED, ulong l1     FD_PARAM_UNUSED,
+                       ulong  m0,                     ulong m1     FD_PARAM_UNUSED,
+                       ulong  n0     FD_PARAM_UNUSED, ulong n1     FD_PARAM_UNUSED ) {
+  fd_accounts_scan_t *        scan     = (fd_accounts_scan_t *)tpool;
+  fd_accounts_scan_worker_t * w        = scan->worker + m0;
+  fd_exec_slot_ctx_t *        slot_ctx = scan->slot_ctx;
+  fd_funk_t *                 funk     = slot_ctx->acc_mgr->funk;
+  fd_wksp_t *                 wksp     = fd_funk_wksp( funk );
+  fd_funk_rec_t const *       rec_map  = fd_funk_rec_map( funk, wksp );
+  ulong                       rec_max  = funk->rec_max;
+
+  for(;;) {
+    ulong rec_lo = FD_ATOMIC_FETCH_AND_ADD( &scan->rec_next, FD_ACCOUNTS_SCAN_CHUNK_SZ );
+    if( rec_lo>=rec_max ) break;
+    ulong rec_hi = fd_ulong_min( rec_lo+FD_ACCOUNTS_SCAN_CHUNK_SZ, rec_max );
+
+    ulong pair_cnt = 0UL;
+    for( ulong rec_idx=rec_lo; rec_idx<rec_hi; rec_idx++ ) {
+      fd_funk_rec_t const * rec = rec_map + rec_idx;
+      if( !fd_accounts_scan_rec( scan, funk, rec ) ) continue;
+
+      fd_pubkey_t const * pubkey   = (fd_pubkey_t const *)rec->pair.key->uc;
+      fd_account_meta_t * metadata = (fd_account_meta_t *)fd_funk_val_const( rec, wksp );
+
+      if( !metadata->info.lamports ) {
+        if( !scan->with_dead ) continue;
+        fd_hash_t * hash = w->dead + pair_cnt;
+        fd_blake3_t b3[1];
+        fd_blake3_init  ( b3 );
+        fd_blake3_append( b3, pubkey->uc, sizeof(fd_pubkey_t) );
+        fd_blake3_fini  ( b3, hash );
+        w->pairs[ pair_cnt++ ] = (fd_pubkey_hash_pair_t){ .pubkey = pubkey, .hash = hash };
+        continue;
+      }
 
-// #define MAP_KEY_COPY(kd,ks)   fd_funk_xid_key_pair_copy((kd),(ks))
+      fd_hash_t * h = (fd_hash_t *)metadata->hash;
+      if( (h->ul[0] | h->ul[1] | h->ul[2] | h->ul[3])==0 ) {
+        // By the time we fall into this case, we can assume the ignore_slot feature is enabled...
+        fd_hash_account_current( h->hash, metadata, pubkey->uc, fd_account_get_data( metadata ), slot_ctx );
+      } else if( scan->do_hash_verify ) {
+        /* Same as fd_hash_account_current at the slot the account was
+           last modified (slot_ctx is shared by the workers) */
+        fd_hash_t hash[1];
+        int ignore_slot = metadata->slot >= slot_ctx->epoch_ctx->features.account_hash_ignore_slot;
+        if( ignore_slot ) fd_hash_account_v1( hash->hash, metadata, pubkey->uc, fd_account_get_data( metadata ) );
+        else              fd_hash_account_v0( hash->hash, metadata, pubkey->uc, fd_account_get_data( metadata ), metadata->slot );
+        if( fd_acc_exists( metadata ) && memcmp( metadata->hash, hash, 32 )!=0 ) {
+          FD_LOG_WARNING(( "snapshot hash (%32J) doesn't match calculated hash (%32J)", metadata->hash, hash ));
+        }
+      }
 
-#define MAP_T    accounts_hash_t
-#include "../../util/tmpl/fd_map_dynamic.c"
+      if( (metadata->info.executable & ~1)!=0 ) continue;
 
-int
-fd_accounts_hash( fd_exec_slot_ctx_t * slot_ctx, fd_hash_t *accounts_hash, fd_funk_txn_t * child_txn, ulong do_hash_verify, int with_dead ) {
-  FD_LOG_NOTICE(("accounts_hash start for txn %p, do_hash_verify=%s, with_dead=%s", (void *)child_txn, do_hash_verify ? "true" : "false", with_dead ? "true": "false"));
+      w->pairs[ pair_cnt++ ] = (fd_pubkey_hash_pair_t){ .pubkey = pubkey, .hash = h };
+    }
 
-  fd_funk_t *     funk = slot_ctx->acc_mgr->funk;
-  fd_wksp_t *     wksp = fd_funk_wksp( funk );
-  fd_funk_rec_t * rec_map  = fd_funk_rec_map( funk, wksp );
+    /* Append the chunk's pairs, moving the hashes of dead accounts out
+       of worker local memory */
 
-  // How many total records are we dealing with?
-  ulong                   num_iter_accounts = fd_funk_rec_map_key_cnt( rec_map );
-  ulong                   num_pairs = 0;
-  fd_pubkey_hash_pair_t * pairs = fd_valloc_malloc( slot_ctx->valloc, FD_PUBKEY_HASH_PAIR_ALIGN, num_iter_accounts * sizeof(fd_pubkey_hash_pair_t) );
-  FD_TEST(NULL != pairs);
+    ulong off = FD_ATOMIC_FETCH_AND_ADD( &scan->pair_cnt, pair_cnt );
+    for( ulong i=0UL; i<pair_cnt; i++ ) {
+      fd_pubkey_hash_pair_t pair = w->pairs[ i ];
+      if( pair.hash==w->dead+i ) {
+        scan->dead[ off+i ] = w->dead[ i ];
+        pair.hash = scan->dead + off + i;
+      }
+      scan->pairs[ off+i ] = pair;
+    }
+  }
+}
 
-  fd_blake3_t *b3 = NULL;
-  fd_scratch_push();
+#ifdef _ENABLE_LTHASH
+static void
+fd_accounts_lthash_task( void * tpool,
+                         ulong  t0     FD_PARAM_UNUSED, ulong t1     FD_PARAM_UNUSED,
+                         void * args   FD_PARAM_UNUSED,
+                         void * reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                         ulong  l0     FD_PARAM_UNUSED, ulong l1     FD_PARAM_UNUSED,
+                         ulong  m0,                     ulong m1     FD_PARAM_UNUSED,
+                         ulong  n0     FD_PARAM_UNUSED, ulong n1     FD_PARAM_UNUSED ) {
+  fd_accounts_scan_t *        scan    = (fd_accounts_scan_t *)tpool;
+  fd_accounts_scan_worker_t * w       = scan->worker + m0;
+  fd_funk_t *                 funk    = scan->slot_ctx->acc_mgr->funk;
+  fd_wksp_t *                 wksp    = fd_funk_wksp( funk );
+  fd_funk_rec_t const *       rec_map = fd_funk_rec_map( funk, wksp );
+  ulong                       rec_max = funk->rec_max;
+
+  fd_lthash_zero( &w->lthash );
+
+  for(;;) {
+    ulong rec_lo = FD_ATOMIC_FETCH_AND_ADD( &scan->rec_next, FD_ACCOUNTS_SCAN_CHUNK_SZ );
+    if( rec_lo>=rec_max ) break;
+    ulong rec_hi = fd_ulong_min( rec_lo+FD_ACCOUNTS_SCAN_CHUNK_SZ, rec_max );
+
+    for( ulong rec_idx=rec_lo; rec_idx<rec_hi; rec_idx++ ) {
+      fd_funk_rec_t const * rec = rec_map + rec_idx;
+      if( !fd_accounts_scan_rec( scan, funk, rec ) ) continue;
+
+      fd_account_meta_t const * metadata = (fd_account_meta_t const *)fd_funk_val_const( rec, wksp );
+      FD_TEST( metadata->magic==FD_ACCOUNT_META_MAGIC );
+
+      // Create the lthash for this account, by hashing the account hash
+      fd_lthash_t       lthash;
+      fd_lthash_value_t lthash_val;
+      fd_lthash_init  ( &lthash );
+      fd_lthash_append( &lthash, metadata->hash, 32 );
+      fd_lthash_fini  ( &lthash, &lthash_val );
 
-  for (fd_funk_rec_t const *rec = fd_funk_txn_first_rec( funk, child_txn ); NULL != rec; rec = fd_funk_txn_next_rec(funk, rec)) {
-    if ( !fd_funk_key_is_acc( rec->pair.key ) )
-      continue;
+      fd_lthash_add( &w->lthash, &lthash_val );
+    }
+  }
+}
+#endif
 
-    fd_account_meta_t * metadata = (fd_account_meta_t *) fd_funk_val_const( rec, wksp );
-    int is_empty = (metadata->info.lamports == 0);
+/* fd_accounts_scan_exec runs task on tpool workers [0,worker_cnt) until
+   the rec map is exhausted.  The caller is worker 0. */
 
-    if (is_empty) {
-      if (with_dead) {
-        pairs[num_pairs].pubkey = (const fd_pubkey_t *)rec->pair.key->uc;
+static void
+fd_accounts_scan_exec( fd_accounts_scan_t * scan,
+                       fd_tpool_t *         tpool,
+                       ulong                worker_cnt,
+                       fd_tpool_task_t      task ) {
+  scan->rec_next = 0UL;
+  scan->pair_cnt = 0UL;
+  for( ulong i=1UL; i<worker_cnt; i++ )
+    fd_tpool_exec( tpool, i, task, scan, 0UL, 0UL, NULL, NULL, 0UL, 0UL, 0UL, i, i+1UL, 0UL, 0UL );
+  task( scan, 0UL, 0UL, NULL, NULL, 0UL, 0UL, 0UL, 0UL, 1UL, 0UL, 0UL );
+  for( ulong i=1UL; i<worker_cnt; i++ )
+    fd_tpool_wait( tpool, i );
+}
 
-        fd_hash_t *hash = fd_scratch_alloc(alignof(fd_hash_t), sizeof(fd_hash_t));
-        if (NULL == b3)
-          b3 = fd_scratch_alloc(alignof(fd_blake3_t), sizeof(fd_blake3_t));
-        fd_blake3_init  ( b3 );
-        fd_blake3_append( b3, rec->pair.key->uc,   sizeof( fd_pubkey_t ) );
-        fd_blake3_fini  ( b3, hash );
+#ifdef _ENABLE_LTHASH
+/* fd_accounts_lthash_scan returns the lthash of the accounts selected by
+   scan (see fd_accounts_scan_rec) in acc. */
 
-        pairs[num_pairs].hash = hash;
-        num_pairs++;
-        continue;
-      } else
-        continue;
-    } else {
-      fd_hash_t *h = (fd_hash_t *) metadata->hash;
-      if ((h->ul[0] | h->ul[1] | h->ul[2] | h->ul[3]) == 0) {
-        // By the time we fall into this case, we can assume the ignore_slot feature is enabled...
-        fd_hash_account_current( (uchar *) metadata->hash, metadata, rec->pair.key->uc, fd_account_get_data(metadata), slot_ctx );
-      } else if( do_hash_verify ) {
-        uchar hash[32];
-        ulong old_slot = slot_ctx->slot_bank.slot;
-        slot_ctx->slot_bank.slot = metadata->slot;
-        fd_hash_account_current( (uchar *) &hash, metadata, rec->pair.key->uc, fd_account_get_data(metadata), slot_ctx );
-        slot_ctx->slot_bank.slot = old_slot;
-        if ( fd_acc_exists( metadata ) && memcmp( metadata->hash, &hash, 32 ) != 0 ) {
-          FD_LOG_WARNING(( "snapshot hash (%32J) doesn't match calculated hash (%32J)", metadata->hash, &hash ));
-        }
-      }
-    }
+static void
+fd_accounts_lthash_scan( fd_accounts_scan_t * scan,
+                         fd_lthash_value_t *  acc,
+                         fd_tpool_t *         tpool,
+                         ulong                max_workers ) {
+  fd_valloc_t valloc     = scan->slot_ctx->valloc;
+  ulong       worker_cnt = fd_account_deltas_worker_cnt( tpool, max_workers, scan->slot_ctx->acc_mgr->funk->rec_max, FD_ACCOUNTS_SCAN_CHUNK_SZ );
 
-    if ((metadata->info.executable & ~1) != 0)
-      continue;
+  scan->worker = fd_valloc_malloc( valloc, alignof(fd_accounts_scan_worker_t), worker_cnt*sizeof(fd_accounts_scan_worker_t) );
+  FD_TEST( scan->worker );
+
+  fd_accounts_scan_exec( scan, tpool, worker_cnt, fd_accounts_lthash_task );
+
+  fd_lthash_zero( acc );
+  for( ulong i=0UL; i<worker_cnt; i++ ) fd_lthash_add( acc, &scan->worker[ i ].lthash );
+
+  fd_valloc_free( valloc, scan->worker );
+}
+#endif
 
-    // FD_LOG_DEBUG(( "including %s account %32J => %32J (modified at slot %lu)",
-    //                is_dead ? "dead" : "live",
-    //                rec->pair.key->uc,
-    //                metadata->hash,
-    //                metadata->slot ));
+int
+fd_accounts_hash( fd_exec_slot_ctx_t * slot_ctx, fd_hash_t *accounts_hash, fd_funk_txn_t * child_txn, ulong do_hash_verify, int with_dead ) {
+  return fd_accounts_hash_tpool( slot_ctx, accounts_hash, child_txn, do_hash_verify, with_dead, NULL, 1UL );
+}
+
+/* fd_accounts_hash_private hashes the accounts selected by
+   fd_accounts_scan_rec for the given txn and visible mode. */
+
+static int
+fd_accounts_hash_private( fd_exec_slot_ctx_t *  slot_ctx,
+                          fd_hash_t *           accounts_hash,
+                          fd_funk_txn_t const * child_txn,
+                          int                   visible,
+                          ulong                 do_hash_verify,
+                          int                   with_dead,
+                          fd_tpool_t *          tpool,
+                          ulong                 max_workers ) {
+  FD_LOG_NOTICE(("accounts_hash start for txn %p, visible=%s, do_hash_verify=%s, with_dead=%s", (void const *)child_txn, visible ? "true" : "false", do_hash_verify ? "true" : "false", with_dead ? "true": "false"));
+
+  fd_funk_t *     funk    = slot_ctx->acc_mgr->funk;
+  fd_wksp_t *     wksp    = fd_funk_wksp( funk );
+  fd_funk_rec_t * rec_map = fd_funk_rec_map( funk, wksp );
+  fd_funk_txn_t * txn_map = fd_funk_txn_map( funk, wksp );
+  fd_valloc_t     valloc  = slot_ctx->valloc;
 
-    pairs[num_pairs].pubkey = (const fd_pubkey_t *)rec->pair.key->uc;
-    pairs[num_pairs].hash = (const fd_hash_t *)metadata->hash;
-    num_pairs++;
+  // How many total records are we dealing with?
+  ulong rec_cnt    = fd_ulong_max( fd_funk_rec_map_key_cnt( rec_map ), 1UL );
+  ulong worker_cnt = fd_account_deltas_worker_cnt( tpool, max_workers, funk->rec_max, FD_ACCOUNTS_SCAN_CHUNK_SZ );
+
+  fd_accounts_scan_t scan[1] = {{
+    .slot_ctx       = slot_ctx,
+    .txn            = child_txn,
+    .txn_cidx       = fd_funk_txn_cidx( child_txn ? (ulong)(child_txn - txn_map) : FD_FUNK_TXN_IDX_NULL ),
+    .visible        = visible,
+    .do_hash_verify = do_hash_verify,
+    .with_dead      = with_dead,
+  }};
+
+  scan->pairs  = fd_valloc_malloc( valloc, FD_PUBKEY_HASH_PAIR_ALIGN, rec_cnt*sizeof(fd_pubkey_hash_pair_t) );
+  scan->dead   = with_dead ? fd_valloc_malloc( valloc, alignof(fd_hash_t), rec_cnt*sizeof(fd_hash_t) ) : NULL;
+  scan->worker = fd_valloc_malloc( valloc, alignof(fd_accounts_scan_worker_t), worker_cnt*sizeof(fd_accounts_scan_worker_t) );
+  fd_pubkey_hash_pair_t * worker_pairs = fd_valloc_malloc( valloc, FD_PUBKEY_HASH_PAIR_ALIGN, worker_cnt*FD_ACCOUNTS_SCAN_CHUNK_SZ*sizeof(fd_pubkey_hash_pair_t) );
+  fd_hash_t *             worker_dead  = fd_valloc_malloc( valloc, alignof(fd_hash_t),        worker_cnt*FD_ACCOUNTS_SCAN_CHUNK_SZ*sizeof(fd_hash_t)             );
+  FD_TEST( scan->pairs && ( scan->dead || !with_dead ) && scan->worker && worker_pairs && worker_dead );
+
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    scan->worker[ i ].pairs = worker_pairs + i*FD_ACCOUNTS_SCAN_CHUNK_SZ;
+    scan->worker[ i ].dead  = worker_dead  + i*FD_ACCOUNTS_SCAN_CHUNK_SZ;
   }
 
-  fd_hash_account_deltas( pairs, num_pairs, accounts_hash, slot_ctx );
+  fd_accounts_scan_exec( scan, tpool, worker_cnt, fd_accounts_hash_task );
+
+  fd_hash_account_deltas_tpool( scan->pairs, scan->pair_cnt, accounts_hash, slot_ctx, tpool, max_workers );
 
-  fd_valloc_free( slot_ctx->valloc, pairs );
-  fd_scratch_pop();
+  fd_valloc_free( valloc, worker_dead  );
+  fd_valloc_free( valloc, worker_pairs );
+  fd_valloc_free( valloc, scan->worker );
+  if( with_dead ) fd_valloc_free( valloc, scan->dead );
+  fd_valloc_free( valloc, scan->pairs );
 
   FD_LOG_INFO(("accounts_hash %32J", accounts_hash->hash));
 
   return 0;
 }
 
+int
+fd_accounts_hash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                        fd_hash_t *          accounts_hash,
+                        fd_funk_txn_t *      child_txn,
+                        ulong                do_hash_verify,
+                        int                  with_dead,
+                        fd_tpool_t *         tpool,
+                        ulong                max_workers ) {
+  return fd_accounts_hash_private( slot_ctx, accounts_hash, child_txn, 0, do_hash_verify, with_dead, tpool, max_workers );
+}
+
 int
 fd_snapshot_hash( fd_exec_slot_ctx_t * slot_ctx, fd_hash_t *accounts_hash, fd_funk_txn_t * child_txn, uint check_hash, int with_dead ) {
+  return fd_snapshot_hash_tpool( slot_ctx, accounts_hash, child_txn, check_hash, with_dead, NULL, 1UL );
+}
+
+/* fd_snapshot_hash_private is fd_accounts_hash_private with the epoch
+   accounts hash mixed in if the snapshot should include it. */
+
+static int
+fd_snapshot_hash_private( fd_exec_slot_ctx_t *  slot_ctx,
+                          fd_hash_t *           accounts_hash,
+                          fd_funk_txn_t const * child_txn,
+                          int                   visible,
+                          uint                  check_hash,
+                          int                   with_dead,
+                          fd_tpool_t *          tpool,
+                          ulong                 max_workers ) {
   if (FD_FEATURE_ACTIVE(slot_ctx, epoch_accounts_hash)) {
     if (fd_should_snapshot_include_epoch_accounts_hash (slot_ctx)) {
       FD_LOG_NOTICE(( "snapshot is including epoch account hash" ));
       fd_sha256_t h;
       fd_hash_t hash;
-      fd_accounts_hash(slot_ctx, &hash, child_txn, check_hash, with_dead);
+      fd_accounts_hash_private(slot_ctx, &hash, child_txn, visible, check_hash, with_dead, tpool, max_workers);
 
       fd_sha256_init( &h );
       fd_sha256_append( &h, (uchar const *) hash.hash, sizeof( fd_hash_t ) );
@@ -1012,125 +1381,76 @@ fd_snapshot_hash( fd_exec_slot_ctx_t * slot_ctx, fd_hash_t *accounts_hash, fd_fu
       return 0;
     }
   }
-  return fd_accounts_hash(slot_ctx, accounts_hash, child_txn, check_hash, with_dead );
+  return fd_accounts_hash_private(slot_ctx, accounts_hash, child_txn, visible, check_hash, with_dead, tpool, max_workers);
 }
 
-#ifdef _ENABLE_LTHASH
 int
-fd_accounts_init_lthash( fd_exec_slot_ctx_t * slot_ctx ) {
-  // Initialize the lhash value to zero
-  fd_lthash_value_t * acc_lthash = (fd_lthash_value_t *)fd_type_pun_const( slot_ctx->slot_bank.lthash );
-  fd_lthash_zero( acc_lthash );
-
-  // Iterate over all accounts in the database
-  fd_funk_t *     funk = slot_ctx->acc_mgr->funk;
-
-  for (
-    fd_funk_rec_t const *rec = fd_funk_txn_first_rec( funk, NULL); NULL != rec; rec = fd_funk_txn_next_rec(funk, rec))
-    {
-      if ( fd_funk_key_is_acc( rec->pair.key ) ) {
-        void const * data = fd_funk_val( rec, fd_funk_wksp(funk) );
-        fd_account_meta_t const * metadata = (fd_account_meta_t const *)fd_type_pun_const( data );
-        FD_TEST ( metadata->magic == FD_ACCOUNT_META_MAGIC );
-
-        // Create the lthash for this account, by hashing the account hash
-        fd_lthash_t lthash;
-        fd_lthash_init( &lthash );
-        fd_lthash_append( &lthash, metadata->hash, 32 );
-
-        fd_lthash_value_t lthash_val;
-        fd_lthash_fini( &lthash, &lthash_val );
+fd_snapshot_hash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                        fd_hash_t *          accounts_hash,
+                        fd_funk_txn_t *      child_txn,
+                        uint                 check_hash,
+                        int                  with_dead,
+                        fd_tpool_t *         tpool,
+                        ulong                max_workers ) {
+  return fd_snapshot_hash_private( slot_ctx, accounts_hash, child_txn, 0, check_hash, with_dead, tpool, max_workers );
+}
 
-        // Add this to the accumulator
-        fd_lthash_add( acc_lthash, &lthash_val );
-      } // if ( fd_funk_key_is_acc( rec->pair.key ) )
-    } // fd_funk_rec_t const *rec = fd_f
+int
+fd_snapshot_hash_visible_tpool( fd_exec_slot_ctx_t *  slot_ctx,
+                                fd_hash_t *           accounts_hash,
+                                fd_funk_txn_t const * txn,
+                                fd_tpool_t *          tpool,
+                                ulong                 max_workers ) {
+  return fd_snapshot_hash_private( slot_ctx, accounts_hash, txn, 1, 0U, 0, tpool, max_workers );
+}
 
-    return 0;
+#ifdef _ENABLE_LTHASH
+int
+fd_accounts_init_lthash( fd_exec_slot_ctx_t * slot_ctx ) {
+  return fd_accounts_init_lthash_tpool( slot_ctx, NULL, 1UL );
 }
 
-/* Re-computes the lthash from the current slot */
 void
 fd_accounts_check_lthash( fd_exec_slot_ctx_t * slot_ctx ) {
-  fd_funk_t *     funk = slot_ctx->acc_mgr->funk;
-  fd_wksp_t *     wksp = fd_funk_wksp( funk );
-  fd_funk_rec_t * rec_map  = fd_funk_rec_map( funk, wksp );
-  fd_funk_txn_t * txn_map  = fd_funk_txn_map( funk, wksp );
-
-  // How many txns are we dealing with?
-  ulong txn_cnt = 1;
-  fd_funk_txn_t * txn = slot_ctx->funk_txn;
-  while (NULL != txn) {
-    txn_cnt++;
-    txn = fd_funk_txn_parent( txn, txn_map );
-  }
+  fd_accounts_check_lthash_tpool( slot_ctx, NULL, 1UL );
+}
 
-  fd_funk_txn_t ** txns = fd_alloca_check(sizeof(fd_funk_txn_t *), sizeof(fd_funk_txn_t *) * txn_cnt);
-  if ( FD_UNLIKELY(NULL == txns))
-    FD_LOG_ERR(("Out of scratch space?"));
-
-  // Lay it flat to make it easier to walk backwards up the chain from
-  // the root
-  txn = slot_ctx->funk_txn;
-  ulong txn_idx = txn_cnt;
-  while (1) {
-    txns[--txn_idx] = txn;
-    if (NULL == txn)
-      break;
-    txn = fd_funk_txn_parent( txn, txn_map );
-  }
+int
+fd_accounts_init_lthash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                               fd_tpool_t *         tpool,
+                               ulong                max_workers ) {
+  // Sum the lthashes of all the accounts in the last published transaction
+  fd_accounts_scan_t scan[1] = {{
+    .slot_ctx = slot_ctx,
+    .txn      = NULL,
+    .txn_cidx = fd_funk_txn_cidx( FD_FUNK_TXN_IDX_NULL ),
+    .visible  = 0,
+  }};
+
+  fd_lthash_value_t * acc_lthash = (fd_lthash_value_t *)fd_type_pun( slot_ctx->slot_bank.lthash );
+  fd_accounts_lthash_scan( scan, acc_lthash, tpool, max_workers );
+  return 0;
+}
 
-  // How many total records are we dealing with?
-  ulong           num_iter_accounts = fd_funk_rec_map_key_cnt( rec_map );
-
-  int accounts_hash_slots = fd_ulong_find_msb(num_iter_accounts  ) + 1;
-
-  FD_LOG_WARNING(("allocating memory for hash.  num_iter_accounts: %d   slots: %d", num_iter_accounts, accounts_hash_slots));
-  void * hashmem = fd_valloc_malloc( slot_ctx->valloc, accounts_hash_align(), accounts_hash_footprint(accounts_hash_slots));
-  FD_LOG_WARNING(("initializing memory for hash"));
-  accounts_hash_t * hash_map = accounts_hash_join(accounts_hash_new(hashmem, accounts_hash_slots));
-
-  FD_LOG_WARNING(("copying in accounts"));
-
-  // walk up the transactions...
-  for (ulong idx = 0; idx < txn_cnt; idx++) {
-    FD_LOG_WARNING(("txn idx %d", idx));
-    for (fd_funk_rec_t const *rec = fd_funk_txn_first_rec( funk, txns[idx]);
-         NULL != rec;
-         rec = fd_funk_txn_next_rec(funk, rec)) {
-      if ( fd_funk_key_is_acc( rec->pair.key ) ) {
-        accounts_hash_t * q = accounts_hash_query(hash_map, (fd_funk_rec_t *) rec, NULL);
-        if (NULL != q)
-          accounts_hash_remove(hash_map, q);
-        if (!(rec->flags & FD_FUNK_REC_FLAG_ERASE))
-          accounts_hash_insert(hash_map, (fd_funk_rec_t *) rec);
-      }
-    }
-  }
+void
+fd_accounts_check_lthash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                                fd_tpool_t *         tpool,
+                                ulong                max_workers ) {
+  // Re-compute the lthash from the accounts visible from the current
+  // slot (published records are never erased and can't be shadowed)
+  fd_funk_txn_t const * txn = slot_ctx->funk_txn;
+  fd_accounts_scan_t scan[1] = {{
+    .slot_ctx = slot_ctx,
+    .txn      = txn,
+    .txn_cidx = fd_funk_txn_cidx( FD_FUNK_TXN_IDX_NULL ),
+    .visible  = !!txn,
+  }};
 
-  // Initialize the accumulator to zero
   fd_lthash_value_t acc_lthash;
-  fd_lthash_zero( &acc_lthash );
-
-  ulong slot_cnt = accounts_hash_slot_cnt(hash_map);;
-  for( ulong slot_idx=0UL; slot_idx<slot_cnt; slot_idx++ ) {
-    accounts_hash_t *slot = &hash_map[slot_idx];
-    if (FD_UNLIKELY (NULL != slot->key)) {
-      void const * data = fd_funk_val_const( slot->key, wksp );
-      fd_account_meta_t const * metadata = (fd_account_meta_t const *)fd_type_pun_const( data );
-
-      // Add the hash to the accumulator
-      fd_lthash_t lthash;
-      fd_lthash_init( &lthash );
-      fd_lthash_append( &lthash, metadata->hash, 32 );
-      fd_lthash_value_t lthash_val;
-      fd_lthash_fini( &lthash, &lthash_val );
-      fd_lthash_add( &acc_lthash, &lthash_val );
-    }
-  }
+  fd_accounts_lthash_scan( scan, &acc_lthash, tpool, max_workers );
 
   // Compare the accumulator to the slot
-  fd_lthash_value_t * acc = (fd_lthash_value_t *)fd_type_pun_const( slot_ctx->slot_bank.lthash );
+  fd_lthash_value_t const * acc = (fd_lthash_value_t const *)fd_type_pun_const( slot_ctx->slot_bank.lthash );
   FD_TEST( memcmp( acc, &acc_lthash, sizeof( fd_lthash_value_t ) ) == 0 );
 }
 #endif
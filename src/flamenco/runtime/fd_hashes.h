@@ -17,6 +17,20 @@ FD_PROTOTYPES_BEGIN
 
 void fd_hash_account_deltas( fd_pubkey_hash_pair_t * pairs, ulong pairs_len, fd_hash_t * hash, fd_exec_slot_ctx_t * slot_ctx );
 
+/* fd_hash_account_deltas_tpool is fd_hash_account_deltas with the sort
+   of the pairs and the hashing of the merkle tree split over tpool
+   workers [0,max_workers) when there are enough pairs.  The caller is
+   worker 0 and the other workers should be idle.  tpool NULL runs on
+   the caller.  Scratch memory is allocated from slot_ctx->valloc. */
+
+void
+fd_hash_account_deltas_tpool( fd_pubkey_hash_pair_t * pairs,
+                              ulong                   pairs_len,
+                              fd_hash_t *             hash,
+                              fd_exec_slot_ctx_t *    slot_ctx,
+                              fd_tpool_t *            tpool,
+                              ulong                   max_workers );
+
 int fd_update_hash_bank( fd_exec_slot_ctx_t * slot_ctx,
                          fd_capture_ctx_t * capture_ctx,
                          fd_hash_t * hash,
@@ -82,6 +96,21 @@ fd_accounts_hash( fd_exec_slot_ctx_t * slot_ctx,
                   ulong do_hash_verify,
                   int with_dead );
 
+/* fd_accounts_hash_tpool is fd_accounts_hash with the scan of the funk
+   rec map, the account hash verification and the hashing of the
+   resulting pairs split over tpool workers [0,max_workers).  The caller
+   is worker 0 and the other workers should be idle.  tpool NULL runs on
+   the caller.  The result does not depend on the number of workers. */
+
+int
+fd_accounts_hash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                        fd_hash_t *          accounts_hash,
+                        fd_funk_txn_t *      child_txn,
+                        ulong                do_hash_verify,
+                        int                  with_dead,
+                        fd_tpool_t *         tpool,
+                        ulong                max_workers );
+
 /* Generate a non-incremental hash of the entire account database. */
 int
 fd_snapshot_hash( fd_exec_slot_ctx_t * slot_ctx,
@@ -90,12 +119,53 @@ fd_snapshot_hash( fd_exec_slot_ctx_t * slot_ctx,
                   uint check_hash,
                   int with_dead );
 
+int
+fd_snapshot_hash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                        fd_hash_t *          accounts_hash,
+                        fd_funk_txn_t *      child_txn,
+                        uint                 check_hash,
+                        int                  with_dead,
+                        fd_tpool_t *         tpool,
+                        ulong                max_workers );
+
+/* fd_snapshot_hash_visible_tpool is fd_snapshot_hash_tpool over the
+   most recent versions of the accounts visible from txn (i.e. txn and
+   its ancestors, NULL for the last published txn) instead of the
+   records of a single txn.  This is the hash of a full snapshot
+   created at txn.  Dead accounts are excluded. */
+
+int
+fd_snapshot_hash_visible_tpool( fd_exec_slot_ctx_t *  slot_ctx,
+                                fd_hash_t *           accounts_hash,
+                                fd_funk_txn_t const * txn,
+                                fd_tpool_t *          tpool,
+                                ulong                 max_workers );
+
+#ifdef _ENABLE_LTHASH
 int
 fd_accounts_init_lthash( fd_exec_slot_ctx_t * slot_ctx );
 
 void
 fd_accounts_check_lthash( fd_exec_slot_ctx_t * slot_ctx );
 
+/* fd_accounts_{init,check}_lthash_tpool are fd_accounts_{init,check}_
+   lthash with the scan of the funk rec map split over tpool workers
+   like fd_accounts_hash_tpool.  init sets slot_bank.lthash to the sum
+   of the lthashes of the published accounts.  check recomputes it over
+   the accounts visible from slot_ctx->funk_txn and FD_TESTs that it
+   matches slot_bank.lthash. */
+
+int
+fd_accounts_init_lthash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                               fd_tpool_t *         tpool,
+                               ulong                max_workers );
+
+void
+fd_accounts_check_lthash_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                                fd_tpool_t *         tpool,
+                                ulong                max_workers );
+#endif
+
 void
 fd_calculate_epoch_accounts_hash_values(fd_exec_slot_ctx_t * slot_ctx);
 
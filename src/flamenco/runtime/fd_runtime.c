@@ -1227,7 +1227,7 @@ fd_runtime_finalize_txns_tpool( fd_exec_slot_ctx_t * slot_ctx,
         }
       }
       if( slot_ctx->status_cache ) {
-        results[num_cache_txns] = exec_txn_err == 0 ? 1 : 0;
+        results[num_cache_txns] = exec_txn_err == 0 ? 0 : 1; /* result discriminant, 0 is Ok */
         fd_txncache_insert_t * curr_insert = &status_insert[num_cache_txns];
         curr_insert->blockhash = ((uchar *)txn_ctx->_txn_raw->raw + txn_ctx->txn_descriptor->recent_blockhash_off);
         curr_insert->slot = slot_ctx->slot_bank.slot;
@@ -1632,6 +1632,269 @@ fd_runtime_execute_txns_in_waves_tpool( fd_exec_slot_ctx_t * slot_ctx,
   } FD_SCRATCH_SCOPE_END;
 }
 
+/* DAG scheduler *******************************************************
+
+   fd_runtime_execute_txns_in_dag_tpool is a replacement for the wave
+   scheduler above.  Instead of repeatedly partitioning the remaining
+   txns into conflict free waves and waiting for the slowest txn of each
+   wave to finish, it builds the account conflict DAG of the block once
+   and dispatches a txn to an idle tpool worker as soon as all of its
+   predecessors have been retired.
+
+   A txn T has an edge from txn P (P<T in block order) if:
+   - P is the last txn before T to write an account T reads or writes
+   - P reads an account T writes and no txn between P and T writes it
+
+   This is the same ordering the wave scheduler enforces (a txn that is
+   deferred out of a wave still blocks later conflicting txns).  Replay
+   parity and throughput against the wave scheduler are checked with
+   tests/run_ledger_scheduler_bench.sh; the wave scheduler remains the
+   default.
+
+   The caller (tpool worker 0) is the dispatcher.  It polls the tpool
+   workers and, as soon as one finishes, finalizes its txn, which
+   releases the txn's successors, and hands the next ready txn to the
+   first idle worker.  There is no barrier between txns: a long running
+   txn only holds back the txns that conflict with it.  Preparation (fee
+   collection / account loading) and finalization write to funk while
+   workers execute.  This is safe because funk records are only
+   inserted (concurrently with queries, see fd_funk_rec_insert_concur)
+   or updated in place for accounts of the txn being prepared or
+   retired, and the DAG guarantees no executing txn references those
+   accounts.  The program cache and the vote / stake caches are only
+   touched from the dispatcher. */
+
+struct fd_runtime_dag_acct {
+  fd_pubkey_t pubkey;
+  uint        hash;
+  ulong       writer;      /* Last txn to write this account, ULONG_MAX if none */
+  ulong       reader_head; /* Txns reading this account since writer, idx into link pool */
+};
+typedef struct fd_runtime_dag_acct fd_runtime_dag_acct_t;
+
+#define MAP_NAME                fd_runtime_dag_acct_map
+#define MAP_T                   fd_runtime_dag_acct_t
+#define MAP_KEY                 pubkey
+#define MAP_KEY_T               fd_pubkey_t
+#define MAP_KEY_NULL            pubkey_null
+#define MAP_KEY_INVAL( k )      !( memcmp( &k, &pubkey_null, sizeof( fd_pubkey_t ) ) )
+#define MAP_KEY_EQUAL( k0, k1 ) !( memcmp( ( &k0 ), ( &k1 ), sizeof( fd_pubkey_t ) ) )
+#define MAP_KEY_EQUAL_IS_SLOW   1
+#define MAP_KEY_HASH( key )     ( (uint)( fd_hash( 0UL, &key, sizeof( fd_pubkey_t ) ) ) )
+#define MAP_MEMOIZE             1
+#include "../../util/tmpl/fd_map_dynamic.c"
+
+struct fd_runtime_dag_link {
+  ulong idx;
+  ulong next;
+};
+typedef struct fd_runtime_dag_link fd_runtime_dag_link_t;
+
+struct fd_runtime_dag {
+  ulong *                 pred_cnt;  /* Per txn number of unretired predecessors */
+  ulong *                 succ_head; /* Per txn successor list, idx into link pool */
+  fd_runtime_dag_link_t * link;      /* Link pool shared by successor and reader lists */
+  ulong                   link_cnt;
+};
+typedef struct fd_runtime_dag fd_runtime_dag_t;
+
+static void
+fd_runtime_dag_add_edge( fd_runtime_dag_t * dag,
+                         ulong              pred,
+                         ulong              succ ) {
+  if( FD_UNLIKELY( pred==succ ) ) return;
+  /* Edges are added in increasing succ order so a duplicate edge can
+     only be at the head of the successor list of pred. */
+  ulong head = dag->succ_head[ pred ];
+  if( head!=ULONG_MAX && dag->link[ head ].idx==succ ) return;
+  ulong link_idx = dag->link_cnt++;
+  dag->link[ link_idx ].idx  = succ;
+  dag->link[ link_idx ].next = head;
+  dag->succ_head[ pred ]     = link_idx;
+  dag->pred_cnt[ succ ]++;
+}
+
+/* fd_runtime_dag_build populates dag (which has room for txn_cnt txns
+   and 3*acct_cnt links) from the account lists of task_infos.  Reads of
+   the same account do not conflict and each access contributes at most
+   one reader link and two successor links.  The null pubkey (the system
+   program) can never be write locked and is skipped. */
+
+static void
+fd_runtime_dag_build( fd_runtime_dag_t *           dag,
+                      fd_execute_txn_task_info_t * task_infos,
+                      ulong                        txn_cnt,
+                      ulong                        acct_cnt ) {
+  FD_SCRATCH_SCOPE_BEGIN {
+    int    lg_slot_cnt = fd_ulong_find_msb( fd_ulong_max( acct_cnt, 1UL ) ) + 2;
+    void * map_mem     = fd_scratch_alloc( fd_runtime_dag_acct_map_align(), fd_runtime_dag_acct_map_footprint( lg_slot_cnt ) );
+    fd_runtime_dag_acct_t * map = fd_runtime_dag_acct_map_join( fd_runtime_dag_acct_map_new( map_mem, lg_slot_cnt ) );
+
+    for( ulong txn_idx=0UL; txn_idx<txn_cnt; txn_idx++ ) {
+      dag->pred_cnt [ txn_idx ] = 0UL;
+      dag->succ_head[ txn_idx ] = ULONG_MAX;
+    }
+    dag->link_cnt = 0UL;
+
+    for( ulong txn_idx=0UL; txn_idx<txn_cnt; txn_idx++ ) {
+      fd_exec_txn_ctx_t * txn_ctx = task_infos[ txn_idx ].txn_ctx;
+      for( ulong j=0UL; j<txn_ctx->accounts_cnt; j++ ) {
+        fd_pubkey_t const * pubkey = &txn_ctx->accounts[ j ];
+        if( FD_UNLIKELY( fd_runtime_dag_acct_map_key_inval( *pubkey ) ) ) continue;
+
+        fd_runtime_dag_acct_t * acct = fd_runtime_dag_acct_map_query( map, *pubkey, NULL );
+        if( !acct ) {
+          acct = fd_runtime_dag_acct_map_insert( map, *pubkey );
+          acct->writer      = ULONG_MAX;
+          acct->reader_head = ULONG_MAX;
+        }
+
+        if( acct->writer!=ULONG_MAX ) fd_runtime_dag_add_edge( dag, acct->writer, txn_idx );
+
+        if( fd_txn_account_is_writable_idx( txn_ctx->txn_descriptor, txn_ctx->accounts, (int)j ) ) {
+          for( ulong l=acct->reader_head; l!=ULONG_MAX; l=dag->link[ l ].next ) {
+            fd_runtime_dag_add_edge( dag, dag->link[ l ].idx, txn_idx );
+          }
+          acct->writer      = txn_idx;
+          acct->reader_head = ULONG_MAX;
+        } else {
+          ulong link_idx = dag->link_cnt++;
+          dag->link[ link_idx ].idx  = txn_idx;
+          dag->link[ link_idx ].next = acct->reader_head;
+          acct->reader_head          = link_idx;
+        }
+      }
+    }
+  } FD_SCRATCH_SCOPE_END;
+}
+
+/* fd_runtime_dag_retire finalizes txn_idx and releases its successors
+   into the ready queue.  Returns the result of finalization. */
+
+static int
+fd_runtime_dag_retire( fd_exec_slot_ctx_t *         slot_ctx,
+                       fd_capture_ctx_t *           capture_ctx,
+                       fd_execute_txn_task_info_t * task_infos,
+                       fd_runtime_dag_t *           dag,
+                       ulong                        txn_idx,
+                       ulong *                      ready,
+                       ulong *                      ready_tail,
+                       fd_tpool_t *                 tpool ) {
+  int res = fd_runtime_finalize_txns_tpool( slot_ctx, capture_ctx, &task_infos[ txn_idx ], 1UL, tpool, 1UL );
+  for( ulong l=dag->succ_head[ txn_idx ]; l!=ULONG_MAX; l=dag->link[ l ].next ) {
+    ulong succ = dag->link[ l ].idx;
+    if( !--dag->pred_cnt[ succ ] ) ready[ (*ready_tail)++ ] = succ;
+  }
+  return res;
+}
+
+int
+fd_runtime_execute_txns_in_dag_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                                      fd_capture_ctx_t * capture_ctx,
+                                      fd_txn_p_t * txns,
+                                      ulong txn_cnt,
+                                      int ( * query_func )( ulong slot, void * ctx ),
+                                      void * query_arg,
+                                      fd_tpool_t * tpool,
+                                      ulong max_workers ) {
+  FD_SCRATCH_SCOPE_BEGIN {
+    fd_execute_txn_task_info_t * task_infos = fd_scratch_alloc( 8, txn_cnt * sizeof(fd_execute_txn_task_info_t));
+
+    for( ulong i = 0; i < txn_cnt; i++ ) {
+      txns[i].flags = FD_TXN_P_FLAGS_SANITIZE_SUCCESS;
+    }
+
+    int res = fd_runtime_prepare_txns_phase1( slot_ctx, task_infos, txns, txn_cnt );
+    if( res != 0 ) {
+      FD_LOG_WARNING(("Fail prep 1"));
+    }
+
+    ulong acct_cnt = 0;
+    for( ulong i = 0; i < txn_cnt; i++ ) {
+      acct_cnt += task_infos[i].txn_ctx->accounts_cnt;
+      task_infos[i].txn_ctx->capture_ctx = capture_ctx;
+    }
+
+    fd_runtime_dag_t dag[1];
+    dag->pred_cnt  = fd_scratch_alloc( 8UL, txn_cnt * sizeof(ulong) );
+    dag->succ_head = fd_scratch_alloc( 8UL, txn_cnt * sizeof(ulong) );
+    dag->link      = fd_scratch_alloc( 8UL, ( 3UL * acct_cnt + 1UL ) * sizeof(fd_runtime_dag_link_t) );
+    fd_runtime_dag_build( dag, task_infos, txn_cnt, acct_cnt );
+
+    /* Every txn enters the ready queue exactly once so a flat array
+       indexed by [ready_head,ready_tail) suffices. */
+    ulong * ready      = fd_scratch_alloc( 8UL, txn_cnt * sizeof(ulong) );
+    ulong   ready_head = 0UL;
+    ulong   ready_tail = 0UL;
+    for( ulong i = 0; i < txn_cnt; i++ ) {
+      if( !dag->pred_cnt[i] ) ready[ ready_tail++ ] = i;
+    }
+
+    /* running[w] is the txn executing on tpool worker w (ULONG_MAX if
+       none).  Worker 0 is the dispatcher and never executes txns unless
+       there are no other workers. */
+    ulong   worker_cnt  = fd_ulong_max( max_workers, 1UL );
+    ulong * running     = fd_scratch_alloc( 8UL, worker_cnt * sizeof(ulong) );
+    ulong   running_cnt = 0UL;
+    ulong   retired_cnt = 0UL;
+    for( ulong w = 0; w < worker_cnt; w++ ) running[w] = ULONG_MAX;
+
+    while( retired_cnt < txn_cnt ) {
+      int progress = 0;
+
+      /* Retire the txns of workers that have finished.  This releases
+         their successors into the ready queue immediately. */
+      for( ulong w = 1; w < worker_cnt; w++ ) {
+        ulong txn_idx = running[w];
+        if( txn_idx==ULONG_MAX || fd_tpool_worker_state( tpool, w )==FD_TPOOL_WORKER_STATE_EXEC ) continue;
+        FD_COMPILER_MFENCE();
+        running[w] = ULONG_MAX;
+        running_cnt--;
+        if( fd_runtime_dag_retire( slot_ctx, capture_ctx, task_infos, dag, txn_idx, ready, &ready_tail, tpool ) ) {
+          FD_LOG_ERR(("Fail finalize"));
+        }
+        retired_cnt++;
+        progress = 1;
+      }
+
+      /* Prepare ready txns and hand them to idle workers.  A txn that
+         failed to prepare (execution is a no-op) or that has no worker
+         to run on is executed and retired inline. */
+      ulong w = 1UL;
+      while( ready_head<ready_tail ) {
+        while( w<worker_cnt && running[w]!=ULONG_MAX ) w++;
+        if( worker_cnt>1UL && w==worker_cnt ) break;
+
+        ulong txn_idx = ready[ ready_head++ ];
+        res |= fd_runtime_prepare_txns_phase2_tpool( slot_ctx, &task_infos[ txn_idx ], 1UL, query_func, query_arg, tpool, 1UL );
+        res |= fd_runtime_prepare_txns_phase3( slot_ctx, &task_infos[ txn_idx ], 1UL );
+        progress = 1;
+
+        if( FD_LIKELY( w<worker_cnt && ( task_infos[ txn_idx ].txn->flags & FD_TXN_P_FLAGS_SANITIZE_SUCCESS ) ) ) {
+          running[w] = txn_idx;
+          running_cnt++;
+          fd_tpool_exec( tpool, w, fd_runtime_execute_txn_task, task_infos, 0UL, 0UL, NULL, NULL, 1UL, 0UL, 0UL, txn_idx, txn_idx + 1UL, 0UL, 0UL );
+        } else {
+          fd_runtime_execute_txn_task( task_infos, 0UL, 0UL, NULL, NULL, 1UL, 0UL, 0UL, txn_idx, txn_idx + 1UL, 0UL, 0UL );
+          if( fd_runtime_dag_retire( slot_ctx, capture_ctx, task_infos, dag, txn_idx, ready, &ready_tail, tpool ) ) {
+            FD_LOG_ERR(("Fail finalize"));
+          }
+          retired_cnt++;
+        }
+      }
+
+      if( !progress ) {
+        if( FD_UNLIKELY( !running_cnt ) ) FD_LOG_ERR(( "dag scheduler stalled with %lu unretired txns", txn_cnt - retired_cnt ));
+        FD_SPIN_PAUSE();
+      }
+    }
+
+    slot_ctx->slot_bank.transaction_count += txn_cnt;
+
+    return res;
+  } FD_SCRATCH_SCOPE_END;
+}
+
 int fd_runtime_microblock_batch_execute(fd_exec_slot_ctx_t * slot_ctx,
                                         fd_capture_ctx_t * capture_ctx FD_PARAM_UNUSED,
                                         fd_microblock_batch_info_t const * microblock_batch_info) {
@@ -1948,7 +2211,8 @@ int fd_runtime_block_execute_tpool_v2( fd_exec_slot_ctx_t * slot_ctx,
                                        fd_capture_ctx_t * capture_ctx,
                                        fd_block_info_t const * block_info,
                                        fd_tpool_t * tpool,
-                                       ulong max_workers ) {
+                                       ulong max_workers,
+                                       ulong scheduler ) {
   FD_SCRATCH_SCOPE_BEGIN {
     if ( capture_ctx != NULL && capture_ctx->capture ) {
       fd_solcap_writer_set_slot( capture_ctx->capture, slot_ctx->slot_bank.slot );
@@ -1966,7 +2230,11 @@ int fd_runtime_block_execute_tpool_v2( fd_exec_slot_ctx_t * slot_ctx,
 
     fd_runtime_block_collect_txns( block_info, txn_ptrs );
 
-    res = fd_runtime_execute_txns_in_waves_tpool( slot_ctx, capture_ctx, txn_ptrs, txn_cnt, NULL, NULL, tpool, max_workers );
+    if( scheduler==FD_RUNTIME_SCHEDULER_DAG ) {
+      res = fd_runtime_execute_txns_in_dag_tpool( slot_ctx, capture_ctx, txn_ptrs, txn_cnt, NULL, NULL, tpool, max_workers );
+    } else {
+      res = fd_runtime_execute_txns_in_waves_tpool( slot_ctx, capture_ctx, txn_ptrs, txn_cnt, NULL, NULL, tpool, max_workers );
+    }
     if( res != FD_RUNTIME_EXECUTE_SUCCESS ) {
       return res;
     }
@@ -2441,8 +2709,6 @@ fd_runtime_block_eval_tpool(fd_exec_slot_ctx_t *slot_ctx,
                                 ulong max_workers,
                                 ulong scheduler,
                                 ulong * txn_cnt ) {
-  (void)scheduler;
-
   int err = fd_runtime_publish_old_txns( slot_ctx, capture_ctx );
   if( err != 0 ) {
     return err;
@@ -2478,7 +2744,7 @@ fd_runtime_block_eval_tpool(fd_exec_slot_ctx_t *slot_ctx,
     ret = fd_runtime_block_verify_tpool(&block_info, &slot_ctx->slot_bank.poh, &slot_ctx->slot_bank.poh, slot_ctx->valloc, tpool, max_workers);
   }
   if( FD_RUNTIME_EXECUTE_SUCCESS == ret ) {
-    ret = fd_runtime_block_execute_tpool_v2(slot_ctx, capture_ctx, &block_info, tpool, max_workers);
+    ret = fd_runtime_block_execute_tpool_v2(slot_ctx, capture_ctx, &block_info, tpool, max_workers, scheduler);
   }
 
   fd_runtime_block_destroy( slot_ctx->valloc, &block_info );
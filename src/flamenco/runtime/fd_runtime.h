@@ -32,6 +32,15 @@
 
 #define FD_RUNTIME_NUM_ROOT_BLOCKS (32UL)
 
+/* FD_RUNTIME_SCHEDULER_* select how fd_runtime_block_eval_tpool
+   schedules the txns of a block onto the tpool.  WAVE executes
+   conflict free waves with a barrier between waves.  DAG hands each
+   txn to an idle worker as soon as its conflicting predecessors have
+   retired.  WAVE is the default. */
+
+#define FD_RUNTIME_SCHEDULER_WAVE (0UL)
+#define FD_RUNTIME_SCHEDULER_DAG  (1UL)
+
 #define FD_FEATURE_ACTIVE(_slot_ctx, _feature_name)  (_slot_ctx->slot_bank.slot >= _slot_ctx->epoch_ctx->features. _feature_name)
 
 #define FD_BLOCKHASH_QUEUE_MAX_ENTRIES       (300UL)
@@ -125,6 +134,24 @@ fd_runtime_execute_txns_in_waves_tpool( fd_exec_slot_ctx_t * slot_ctx,
                                         fd_tpool_t * tpool,
                                         ulong max_workers );
 
+/* fd_runtime_execute_txns_in_dag_tpool executes txns in the same
+   conflict order as fd_runtime_execute_txns_in_waves_tpool.  It builds
+   the account conflict DAG of txns once and dispatches each txn to an
+   idle tpool worker in [1,max_workers) as soon as its conflicting
+   predecessors have been finalized, with no barrier between txns.  The
+   caller is the dispatcher and prepares and finalizes txns serially
+   (it executes txns itself only if max_workers<=1). */
+
+int
+fd_runtime_execute_txns_in_dag_tpool( fd_exec_slot_ctx_t * slot_ctx,
+                                      fd_capture_ctx_t * capture_ctx,
+                                      fd_txn_p_t * txns,
+                                      ulong txn_cnt,
+                                      int ( * query_func )( ulong slot, void * ctx ),
+                                      void * query_arg,
+                                      fd_tpool_t * tpool,
+                                      ulong max_workers );
+
 void
 fd_runtime_calculate_fee ( fd_exec_txn_ctx_t * txn_ctx,
                            fd_txn_t const * txn_descriptor,
@@ -32,6 +32,7 @@ const fd_pubkey_t fd_solana_compute_budget_program_id         = { .uc = { COMPUT
 const fd_pubkey_t fd_solana_address_lookup_table_program_id   = { .uc = { ADDR_LUT_PROG_ID         } };
 const fd_pubkey_t fd_solana_spl_native_mint_id                = { .uc = { NATIVE_MINT_ID           } };
 const fd_pubkey_t fd_solana_spl_token_id                      = { .uc = { TOKEN_PROG_ID            } };
+const fd_pubkey_t fd_solana_spl_token_2022_id                 = { .uc = { TOKEN_2022_PROG_ID       } };
 const fd_pubkey_t fd_solana_zk_token_proof_program_id         = { .uc = { ZK_TOKEN_PROG_ID         } };
 const fd_pubkey_t fd_solana_zk_elgamal_proof_program_id       = { .uc = { ZK_EL_GAMAL_PROG_ID      } };
 
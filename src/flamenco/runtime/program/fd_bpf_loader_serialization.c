@@ -13,10 +13,13 @@
 */
 // 64-bit aligned
 uchar *
-fd_bpf_loader_input_serialize_aligned( fd_exec_instr_ctx_t ctx,
-                                       ulong *             sz,
-                                       ulong *             pre_lens ) {
+fd_bpf_loader_input_serialize_aligned( fd_exec_instr_ctx_t    ctx,
+                                       ulong *                sz,
+                                       ulong *                pre_lens,
+                                       fd_vm_input_region_t * opt_direct,
+                                       ulong *                opt_direct_cnt ) {
   ulong serialized_size = 0;
+  ulong direct_cnt      = 0UL;
   uchar const * instr_acc_idxs = ctx.instr->acct_txn_idxs;
   fd_pubkey_t * txn_accs = ctx.txn_ctx->accounts;
 
@@ -170,7 +173,22 @@ fd_bpf_loader_input_serialize_aligned( fd_exec_instr_ctx_t ctx,
       FD_STORE( ulong, serialized_params, data_len );
       serialized_params += sizeof(ulong);
 
-      fd_memcpy( serialized_params, acc_data, acc_data_len);
+      /* Accounts nobody in this transaction can write keep their data
+         in place, the vm copies it on demand (see
+         fd_vm_input_direct_map). */
+
+      int direct = opt_direct &&
+                   acc_data_len>=FD_BPF_LOADER_INPUT_DIRECT_MAP_MIN_SZ &&
+                   !fd_txn_account_is_writable_idx( ctx.txn_ctx->txn_descriptor, txn_accs, acc_idx );
+      if( direct ) {
+        opt_direct[ direct_cnt ].off       = (ulong)(serialized_params - serialized_params_start);
+        opt_direct[ direct_cnt ].sz        = acc_data_len;
+        opt_direct[ direct_cnt ].haddr     = acc_data;
+        opt_direct[ direct_cnt ].is_copied = 0;
+        direct_cnt++;
+      } else {
+        fd_memcpy( serialized_params, acc_data, acc_data_len);
+      }
       serialized_params += acc_data_len;
 
       fd_memset( serialized_params, 0, MAX_PERMITTED_DATA_INCREASE + alignment_padding_len);
@@ -196,18 +214,22 @@ fd_bpf_loader_input_serialize_aligned( fd_exec_instr_ctx_t ctx,
   FD_TEST( serialized_params == serialized_params_start + serialized_size );
 
   *sz = serialized_size;
+  if( opt_direct_cnt ) *opt_direct_cnt = direct_cnt;
 
   return serialized_params_start;
 }
 
 /* https://github.com/anza-xyz/agave/blob/b5f5c3cdd3f9a5859c49ebc27221dc27e143d760/programs/bpf_loader/src/serialization.rs#L500-L603 */
 int
-fd_bpf_loader_input_deserialize_aligned( fd_exec_instr_ctx_t ctx,
-                                         ulong const *       pre_lens,
-                                         uchar *             buffer,
-                                         ulong               buffer_sz ) {
+fd_bpf_loader_input_deserialize_aligned( fd_exec_instr_ctx_t          ctx,
+                                         ulong const *                pre_lens,
+                                         uchar *                      buffer,
+                                         ulong                        buffer_sz,
+                                         fd_vm_input_region_t const * direct,
+                                         ulong                        direct_cnt ) {
   /* https://github.com/anza-xyz/agave/blob/b5f5c3cdd3f9a5859c49ebc27221dc27e143d760/programs/bpf_loader/src/serialization.rs#L507 */
   ulong start = 0UL;
+  ulong direct_idx = 0UL;
 
   uchar acc_idx_seen[256] = {0};
 
@@ -266,7 +288,19 @@ fd_bpf_loader_input_deserialize_aligned( fd_exec_instr_ctx_t ctx,
         if( FD_UNLIKELY( start+post_len>buffer_sz ) ) {
           return FD_EXECUTOR_INSTR_ERR_INVALID_ARG;
         }
-        uchar * post_data = buffer+start;
+        uchar const * post_data = buffer+start;
+
+        /* A directly mapped data range that the vm never copied still
+           holds the account's data.  Only its length can have changed
+           (in the header), in which case the buffer needs the data. */
+
+        if( direct_idx<direct_cnt && direct[ direct_idx ].off==start ) {
+          fd_vm_input_region_t const * region = &direct[ direct_idx++ ];
+          if( !region->is_copied ) {
+            if( post_len==region->sz ) post_data = region->haddr;
+            else                       fd_memcpy( buffer+start, region->haddr, region->sz );
+          }
+        }
 
         fd_account_meta_t const * metadata_check = view_acc->const_meta;
         if ( FD_UNLIKELY( fd_ulong_sat_sub( post_len, metadata_check->dlen ) > MAX_PERMITTED_DATA_INCREASE || 
@@ -302,8 +336,8 @@ fd_bpf_loader_input_deserialize_aligned( fd_exec_instr_ctx_t ctx,
             return err;
           }
           fd_memcpy( acc_data, post_data, post_len );
-        } else if( view_acc->const_meta->dlen != post_len || 
-                   memcmp( view_acc->const_data, post_data, post_len ) ) {
+        } else if( view_acc->const_meta->dlen != post_len ||
+                   ( post_data!=view_acc->const_data && memcmp( view_acc->const_data, post_data, post_len ) ) ) {
           FD_LOG_DEBUG(("Data resize failed"));
           return err;
         }
@@ -2,17 +2,52 @@
 #define HEADER_fd_src_flamenco_runtime_program_fd_bpf_loader_serialization_h
 
 #include "../../fd_flamenco_base.h"
+#include "../../vm/fd_vm.h"
 
 #define MAX_PERMITTED_DATA_INCREASE (10240UL)
 #define FD_BPF_ALIGN_OF_U128        (8UL)
 
+/* FD_BPF_LOADER_INPUT_DIRECT_MAP_MIN_SZ is the min data size of an
+   account for it to be mapped directly into the vm input region
+   instead of being copied (see fd_bpf_loader_input_serialize_aligned).
+   Below that, copying is cheaper than taking the vm's slow input
+   translation path. */
+
+#define FD_BPF_LOADER_INPUT_DIRECT_MAP_MIN_SZ (16384UL)
+
 FD_PROTOTYPES_BEGIN
 
+/* fd_bpf_loader_input_serialize_aligned serializes the instruction's
+   accounts and data into a newly allocated (from ctx.valloc) input
+   buffer and returns it.  On return, *sz holds the buffer size and
+   pre_lens[i] the data length of instruction account i.
+
+   If opt_direct is non-NULL (indexed [0,256)), the data of accounts
+   that are read-only in the transaction and have at least
+   FD_BPF_LOADER_INPUT_DIRECT_MAP_MIN_SZ bytes of data is not copied.
+   Instead, their data ranges are described in opt_direct[0,
+   *opt_direct_cnt) for use with fd_vm_input_direct_map.  The buffer
+   bytes of these ranges are left uninitialized.
+
+   fd_bpf_loader_input_deserialize_aligned applies the changes the
+   program made to the input buffer to the instruction's accounts and
+   frees the buffer.  direct/direct_cnt are the ranges produced by the
+   serializer (NULL/0 if none). */
+
 uchar *
-fd_bpf_loader_input_serialize_aligned( fd_exec_instr_ctx_t ctx, ulong * sz, ulong * pre_lens );
+fd_bpf_loader_input_serialize_aligned( fd_exec_instr_ctx_t    ctx,
+                                       ulong *                sz,
+                                       ulong *                pre_lens,
+                                       fd_vm_input_region_t * opt_direct,
+                                       ulong *                opt_direct_cnt );
 
 int
-fd_bpf_loader_input_deserialize_aligned( fd_exec_instr_ctx_t ctx, ulong const * pre_lens, uchar * buffer, ulong buffer_sz );
+fd_bpf_loader_input_deserialize_aligned( fd_exec_instr_ctx_t          ctx,
+                                         ulong const *                pre_lens,
+                                         uchar *                      buffer,
+                                         ulong                        buffer_sz,
+                                         fd_vm_input_region_t const * direct,
+                                         ulong                        direct_cnt );
 
 uchar *
 fd_bpf_loader_input_serialize_unaligned( fd_exec_instr_ctx_t ctx, ulong * sz, ulong * pre_lens );
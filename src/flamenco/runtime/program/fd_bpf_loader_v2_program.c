@@ -85,12 +85,8 @@ fd_bpf_loader_v2_user_execute( fd_exec_instr_ctx_t ctx ) {
   fd_sbpf_program_t * prog = fd_sbpf_program_new( fd_valloc_malloc( ctx.valloc, prog_align, prog_footprint ), &elf_info, rodata );
   FD_TEST( prog );
 
-  /* Allocate syscalls */
+  fd_sbpf_syscalls_t * syscalls = fd_vm_syscall_table_all( 0 );
 
-  fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_new( fd_valloc_malloc( ctx.valloc, fd_sbpf_syscalls_align(), fd_sbpf_syscalls_footprint() ) );
-  FD_TEST( syscalls );
-
-  fd_vm_syscall_register_all( syscalls, 0 );
   /* Load program */
 
   if(  0!=fd_sbpf_program_load( prog, program_data, program_data_len, syscalls, false ) ) {
@@ -106,12 +102,11 @@ fd_bpf_loader_v2_user_execute( fd_exec_instr_ctx_t ctx ) {
   if (FD_UNLIKELY(memcmp(metadata->info.owner, fd_solana_bpf_loader_deprecated_program_id.key, sizeof(fd_pubkey_t)) == 0)) {
     input = fd_bpf_loader_input_serialize_unaligned(ctx, &input_sz, pre_lens);
   } else {
-    input = fd_bpf_loader_input_serialize_aligned(ctx, &input_sz, pre_lens);
+    input = fd_bpf_loader_input_serialize_aligned(ctx, &input_sz, pre_lens, NULL, NULL);
   }
 
   if( input==NULL ) {
     fd_valloc_free( ctx.valloc,  fd_sbpf_program_delete( prog ) );
-    fd_valloc_free( ctx.valloc,  fd_sbpf_syscalls_delete( syscalls ) );
     fd_valloc_free( ctx.valloc, rodata);
     return FD_EXECUTOR_INSTR_ERR_MISSING_ACC;
   }
@@ -194,7 +189,6 @@ if( FD_UNLIKELY( vm->trace ) ) {
   ctx.txn_ctx->compute_meter = vm->cu;
 
   fd_valloc_free( ctx.valloc, fd_sbpf_program_delete( prog ) );
-  fd_valloc_free( ctx.valloc, fd_sbpf_syscalls_delete( syscalls ) );
   fd_valloc_free( ctx.valloc, rodata );
 
 //FD_LOG_WARNING(( "fd_vm_exec: %i-%s, ic: %lu, pc: %lu, ep: %lu, r0: %lu, cu: %lu, frame_cnt: %lu",
@@ -215,7 +209,7 @@ if( FD_UNLIKELY( vm->trace ) ) {
     if(fd_bpf_loader_input_deserialize_unaligned(ctx, pre_lens, input, input_sz))
       return -1;
   } else {
-    if(fd_bpf_loader_input_deserialize_aligned(ctx, pre_lens, input, input_sz))
+    if(fd_bpf_loader_input_deserialize_aligned(ctx, pre_lens, input, input_sz, NULL, 0UL))
       return -1;
   }
 
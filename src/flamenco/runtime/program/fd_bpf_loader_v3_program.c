@@ -10,6 +10,7 @@
 #include "../sysvar/fd_sysvar_cache.h"
 #include "../../vm/syscall/fd_vm_syscall.h"
 #include "../../vm/fd_vm.h"
+#include "../../vm/fd_vm_jit.h"
 #include "fd_bpf_loader_serialization.h"
 #include "fd_bpf_program_util.h"
 #include "fd_native_cpi.h"
@@ -156,13 +157,7 @@ deploy_program( fd_exec_instr_ctx_t * instr_ctx,
                 uchar * const         programdata,
                 ulong                 programdata_size ) {
   bool deploy_mode = true;
-  fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_new( fd_scratch_alloc( fd_sbpf_syscalls_align(),
-                                                                          fd_sbpf_syscalls_footprint() ) );
-  if( FD_UNLIKELY( !syscalls ) ) {
-    FD_LOG_WARNING(( "Failed to register syscalls" ));
-    return FD_EXECUTOR_INSTR_ERR_PROGRAM_ENVIRONMENT_SETUP_FAILURE;
-  }
-  fd_vm_syscall_register_all( syscalls, 1 );
+  fd_sbpf_syscalls_t * syscalls = fd_vm_syscall_table_all( 1 );
 
   /* Load executable */
   fd_sbpf_elf_info_t  _elf_info[ 1UL ];
@@ -363,22 +358,21 @@ common_close_account( fd_pubkey_t * authority_address,
 
 
 /* https://github.com/anza-xyz/agave/blob/574bae8fefc0ed256b55340b9d87b7689bcdf222/programs/bpf_loader/src/lib.rs#L1332-L1501 */
-int
-execute( fd_exec_instr_ctx_t * instr_ctx, fd_sbpf_validated_program_t * prog ) {
+static int
+execute_vm( fd_exec_instr_ctx_t *         instr_ctx,
+            fd_sbpf_validated_program_t * prog,
+            fd_vm_t *                     vm ) {
   /* TODO: This will be updated once belt-sanding is merged in. I am not changing
      the existing VM setup/invocation. */
 
-  fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_new( fd_valloc_malloc( instr_ctx->valloc,
-                                                                          fd_sbpf_syscalls_align(),
-                                                                          fd_sbpf_syscalls_footprint() ) );
-  FD_TEST( syscalls );
-
-  fd_vm_syscall_register_all( syscalls, 0 );
+  fd_sbpf_syscalls_t * syscalls = fd_vm_syscall_table_all( 0 );
 
   /* https://github.com/anza-xyz/agave/blob/574bae8fefc0ed256b55340b9d87b7689bcdf222/programs/bpf_loader/src/lib.rs#L1362-L1368 */
   ulong input_sz = 0;
   ulong pre_lens[ 256UL ];
-  uchar * input = fd_bpf_loader_input_serialize_aligned( *instr_ctx, &input_sz, pre_lens );
+  fd_vm_input_region_t direct[ 256UL ];
+  ulong                direct_cnt = 0UL;
+  uchar * input = fd_bpf_loader_input_serialize_aligned( *instr_ctx, &input_sz, pre_lens, direct, &direct_cnt );
   if( FD_UNLIKELY( input==NULL ) ) {
     return FD_EXECUTOR_INSTR_ERR_MISSING_ACC;
   }
@@ -386,9 +380,6 @@ execute( fd_exec_instr_ctx_t * instr_ctx, fd_sbpf_validated_program_t * prog ) {
   fd_sha256_t _sha[1];
   fd_sha256_t * sha = fd_sha256_join( fd_sha256_new( _sha ) );
 
-  fd_vm_t _vm[1];
-  fd_vm_t * vm = fd_vm_join( fd_vm_new( _vm ) );
-
   ulong pre_insn_cus = instr_ctx->txn_ctx->compute_meter;
 
   /* TODO: (topointon): correctly set check_align and check_size in vm setup */
@@ -414,6 +405,13 @@ execute( fd_exec_instr_ctx_t * instr_ctx, fd_sbpf_validated_program_t * prog ) {
     FD_LOG_ERR(( "null vm" )); 
   }
 
+  if( FD_UNLIKELY( !fd_vm_input_direct_map( vm, direct, direct_cnt ) ) ) {
+    FD_LOG_ERR(( "fd_vm_input_direct_map failed" ));
+  }
+
+  fd_vm_seg_cost_set ( vm, fd_sbpf_validated_program_seg_cost  ( prog ) );
+  fd_vm_predecode_set( vm, fd_sbpf_validated_program_predecoded( prog ) );
+
 #ifdef FD_DEBUG_SBPF_TRACES
   uchar * signature = (uchar*)vm->instr_ctx->txn_ctx->_txn_raw->raw + vm->instr_ctx->txn_ctx->txn_descriptor->signature_off;
   uchar sig[64];
@@ -442,7 +440,7 @@ execute( fd_exec_instr_ctx_t * instr_ctx, fd_sbpf_validated_program_t * prog ) {
   }
   vm->cu -= heap_cost_result;
 
-  int exec_err = fd_vm_exec( vm );
+  int exec_err = fd_vm_exec_jit( vm, fd_sbpf_validated_program_jit( prog ) );
 
   if( FD_UNLIKELY( vm->trace ) ) {
     int err = fd_vm_trace_printf( vm->trace, vm->syscalls );
@@ -468,13 +466,36 @@ execute( fd_exec_instr_ctx_t * instr_ctx, fd_sbpf_validated_program_t * prog ) {
     return FD_EXECUTOR_INSTR_ERR_GENERIC_ERR;;
   }
 
-  if( FD_UNLIKELY( fd_bpf_loader_input_deserialize_aligned( *instr_ctx, pre_lens, input, input_sz )!=0 ) ) {
+  if( FD_UNLIKELY( fd_bpf_loader_input_deserialize_aligned( *instr_ctx, pre_lens, input, input_sz, direct, direct_cnt )!=0 ) ) {
     return FD_EXECUTOR_INSTR_ERR_INVALID_ARG;
   }
 
   return FD_EXECUTOR_INSTR_SUCCESS;
 }
 
+/* execute_vm_stack runs the program on a vm formatted on the caller's
+   stack.  Only used if the thread has no vm pool attached (see
+   fd_vm_pool_acquire).  Kept out of line so that the ~800 KB vm is not
+   part of execute's stack frame (execute nests for CPI). */
+
+static __attribute__((noinline)) int
+execute_vm_stack( fd_exec_instr_ctx_t *         instr_ctx,
+                  fd_sbpf_validated_program_t * prog ) {
+  fd_vm_t _vm[1];
+  fd_vm_t * vm = fd_vm_join( fd_vm_new( _vm ) );
+  return execute_vm( instr_ctx, prog, vm );
+}
+
+int
+execute( fd_exec_instr_ctx_t * instr_ctx, fd_sbpf_validated_program_t * prog ) {
+  fd_vm_t * vm = fd_vm_pool_acquire();
+  if( FD_UNLIKELY( !vm ) ) return execute_vm_stack( instr_ctx, prog );
+
+  int err = execute_vm( instr_ctx, prog, vm );
+  fd_vm_pool_release( vm );
+  return err;
+}
+
 /* https://github.com/anza-xyz/agave/blob/77daab497df191ef485a7ad36ed291c1874596e5/programs/bpf_loader/src/lib.rs#L566-L1444 */
 int
 process_loader_upgradeable_instruction( fd_exec_instr_ctx_t * instr_ctx ) {
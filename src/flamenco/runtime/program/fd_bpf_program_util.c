@@ -4,6 +4,7 @@
 #include "../fd_acc_mgr.h"
 #include "../context/fd_exec_slot_ctx.h"
 #include "../../vm/syscall/fd_vm_syscall.h"
+#include "../../vm/fd_vm_jit.h"
 
 #include <assert.h>
 
@@ -22,13 +23,29 @@ fd_sbpf_validated_program_align( void ) {
   return alignof(fd_sbpf_validated_program_t);
 }
 
-ulong
-fd_sbpf_validated_program_footprint( fd_sbpf_elf_info_t const * elf_info ) {
+static ulong
+fd_sbpf_validated_program_seg_cost_off( fd_sbpf_elf_info_t const * elf_info ) {
   ulong l = FD_LAYOUT_INIT;
   l = FD_LAYOUT_APPEND( l, alignof(fd_sbpf_validated_program_t), sizeof(fd_sbpf_validated_program_t) );
   assert( l==offsetof(fd_sbpf_validated_program_t, calldests) );
   l = FD_LAYOUT_APPEND( l, fd_sbpf_calldests_align(), fd_sbpf_calldests_footprint(elf_info->rodata_sz/8UL) );
   l = FD_LAYOUT_APPEND( l, 8UL, elf_info->rodata_footprint );
+  l = FD_LAYOUT_FINI( l, alignof(uint) );
+  return l;
+}
+
+static ulong
+fd_sbpf_validated_program_predecoded_off( fd_sbpf_elf_info_t const * elf_info ) {
+  ulong l = fd_sbpf_validated_program_seg_cost_off( elf_info );
+  l = FD_LAYOUT_APPEND( l, alignof(uint), fd_vm_seg_cost_footprint( elf_info->text_cnt ) );
+  l = FD_LAYOUT_FINI( l, alignof(fd_vm_predecoded_t) );
+  return l;
+}
+
+ulong
+fd_sbpf_validated_program_footprint( fd_sbpf_elf_info_t const * elf_info ) {
+  ulong l = fd_sbpf_validated_program_predecoded_off( elf_info );
+  l = FD_LAYOUT_APPEND( l, alignof(fd_vm_predecoded_t), fd_vm_predecode_footprint( elf_info->text_cnt ) );
   l = FD_LAYOUT_FINI( l, 128UL );
   return l;
 }
@@ -121,6 +138,45 @@ fd_acc_mgr_cache_key( fd_pubkey_t const * pubkey ) {
   return id;
 }
 
+/* fd_bpf_jit_cache_entry compiles the validated program in rec (value
+   truncated to jit_off bytes) and appends the result to the value.
+   Returns the size of the compiled program (0 if the program could not
+   be compiled, in which case the value is left as is).  Kills any
+   pointers into the value. */
+
+static ulong
+fd_bpf_jit_cache_entry( fd_funk_t *     funk,
+                        fd_funk_rec_t * rec,
+                        ulong           jit_off ) {
+  fd_wksp_t *  wksp  = fd_funk_wksp( funk );
+  fd_alloc_t * alloc = fd_funk_alloc( funk, wksp );
+
+  fd_sbpf_validated_program_t * prog = (fd_sbpf_validated_program_t *)fd_funk_val( rec, wksp );
+  if( FD_UNLIKELY( prog->text_cnt>FD_VM_JIT_TEXT_MAX ) ) return 0UL;
+
+  /* The first attempt uses an estimate, retrying with the exact size
+     if that was too small */
+
+  ulong jit_sz = fd_vm_jit_footprint_est( prog->text_cnt );
+  for( ulong attempt=0UL; attempt<2UL; attempt++ ) {
+    if( FD_UNLIKELY( !fd_funk_val_truncate( rec, jit_off+jit_sz, alloc, wksp, NULL ) ) ) break;
+
+    uchar * val = (uchar *)fd_funk_val( rec, wksp );
+    prog = (fd_sbpf_validated_program_t *)val;
+    ulong const * text = (ulong const *)(fd_sbpf_validated_program_rodata( prog ) + prog->text_off);
+    ulong req = fd_vm_jit_compile( val+jit_off, jit_sz, text, prog->text_cnt, prog->text_off, prog->entry_pc, prog->calldests );
+    if( FD_UNLIKELY( !req ) ) break;
+    if( FD_LIKELY( req<=jit_sz ) ) {
+      if( FD_UNLIKELY( !fd_funk_val_truncate( rec, jit_off+req, alloc, wksp, NULL ) ) ) break;
+      return req;
+    }
+    jit_sz = req;
+  }
+
+  fd_funk_val_truncate( rec, jit_off, alloc, wksp, NULL ); /* On failure, the value just keeps some unused space */
+  return 0UL;
+}
+
 int
 fd_bpf_create_bpf_program_cache_entry( fd_exec_slot_ctx_t * slot_ctx,
                                        fd_pubkey_t const *  program_pubkey ) {
@@ -149,14 +205,17 @@ fd_bpf_create_bpf_program_cache_entry( fd_exec_slot_ctx_t * slot_ctx,
       return FD_EXECUTOR_INSTR_ERR_INVALID_ACC_DATA;
     }
 
+    ulong val_sz = fd_sbpf_validated_program_footprint( &elf_info );
+
     int funk_err = FD_FUNK_SUCCESS;
-    fd_funk_rec_t * rec = fd_funk_rec_write_prepare( funk, funk_txn, &id, fd_sbpf_validated_program_footprint( &elf_info ), 1, NULL, &funk_err );
+    fd_funk_rec_t * rec = fd_funk_rec_write_prepare( funk, funk_txn, &id, val_sz, 1, NULL, &funk_err );
     if( rec == NULL || funk_err != FD_FUNK_SUCCESS ) {
       return -1;
     }
 
     uchar * val = fd_funk_val( rec, fd_funk_wksp( funk ) );
     fd_sbpf_validated_program_t * validated_prog = (fd_sbpf_validated_program_t *)val;
+    validated_prog->magic     = 0UL; /* Set once the entry is complete */
     validated_prog->rodata_sz = elf_info.rodata_sz;
     uchar * rodata = fd_sbpf_validated_program_rodata( validated_prog );
 
@@ -165,12 +224,7 @@ fd_bpf_create_bpf_program_cache_entry( fd_exec_slot_ctx_t * slot_ctx,
     fd_sbpf_program_t * prog = fd_sbpf_program_new(  fd_scratch_alloc( prog_align, prog_footprint ), &elf_info, rodata );
     FD_TEST( prog );
 
-    /* Allocate syscalls */
-
-    fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_new( fd_scratch_alloc( fd_sbpf_syscalls_align(), fd_sbpf_syscalls_footprint() ) );
-    FD_TEST( syscalls );
-
-    fd_vm_syscall_register_all( syscalls, 0 );
+    fd_sbpf_syscalls_t * syscalls = fd_vm_syscall_table_all( 0 );
 
     /* Load program */
 
@@ -188,6 +242,37 @@ fd_bpf_create_bpf_program_cache_entry( fd_exec_slot_ctx_t * slot_ctx,
     validated_prog->text_sz = prog->text_sz;
     validated_prog->rodata_sz = prog->rodata_sz;
 
+    /* Precompute the compute unit cost of every linear segment such
+       that the vm does not have to meter instructions individually */
+
+    validated_prog->seg_cost_off = fd_sbpf_validated_program_seg_cost_off( &elf_info );
+    if( FD_UNLIKELY( !fd_vm_seg_cost( (uint *)(val + validated_prog->seg_cost_off), prog->text, prog->text_cnt ) ) ) {
+      return -1;
+    }
+
+    /* Likewise, unpack the text and resolve local calls once here
+       instead of on every instruction executed */
+
+    validated_prog->predecoded_off = fd_sbpf_validated_program_predecoded_off( &elf_info );
+    if( FD_UNLIKELY( !fd_vm_predecode( (fd_vm_predecoded_t *)(val + validated_prog->predecoded_off),
+                                       prog->text, prog->text_cnt, prog->entry_pc, prog->calldests ) ) ) {
+      return -1;
+    }
+
+    validated_prog->jit_off = fd_ulong_align_up( val_sz, FD_VM_JIT_ALIGN );
+    validated_prog->jit_sz = 0UL;
+
+    /* Compile the program if this thread can execute it natively */
+
+    if( fd_vm_jit_cache_query() ) {
+      ulong jit_off = validated_prog->jit_off;
+      ulong jit_sz  = fd_bpf_jit_cache_entry( funk, rec, jit_off );
+      validated_prog = (fd_sbpf_validated_program_t *)fd_funk_val( rec, fd_funk_wksp( funk ) );
+      validated_prog->jit_sz = jit_sz;
+    }
+
+    validated_prog->magic = FD_SBPF_VALIDATED_PROGRAM_MAGIC;
+
     return 0;
   } FD_SCRATCH_SCOPE_END;
 }
@@ -382,7 +467,10 @@ fd_bpf_load_cache_entry( fd_exec_slot_ctx_t *           slot_ctx,
 
   void const * data = fd_funk_val_const( rec, fd_funk_wksp(funk) );
 
-  /* TODO: magic check */
+  if( FD_UNLIKELY( ((fd_sbpf_validated_program_t const *)data)->magic!=FD_SBPF_VALIDATED_PROGRAM_MAGIC ) ) {
+    FD_LOG_WARNING(( "program cache entry has bad magic (stale layout?)" ));
+    return -1;
+  }
 
   *valid_prog = (fd_sbpf_validated_program_t *)data;
 
@@ -4,9 +4,20 @@
 #include "../../fd_flamenco_base.h"
 #include "../../../ballet/sbpf/fd_sbpf_loader.h"
 #include "../../../funk/fd_funk_txn.h"
+#include "../../vm/fd_vm.h"
+
+/* FD_SBPF_VALIDATED_PROGRAM_MAGIC identifies a program cache entry.
+   The low byte is the layout version, which must be bumped whenever
+   the layout of the entry changes (e.g. the seg_cost, predecoded and
+   jit sections below) such that entries written by an older build
+   (e.g. in a funk checkpoint) are not misinterpreted.  Such entries are
+   rejected by fd_bpf_load_cache_entry and rebuilt by the program cache
+   scan at boot. */
+
+#define FD_SBPF_VALIDATED_PROGRAM_MAGIC (0xf17eda2ce7e5c003UL) /* Low byte is the version */
 
 struct fd_sbpf_validated_program {
-  ulong magic;
+  ulong magic; /* ==FD_SBPF_VALIDATED_PROGRAM_MAGIC once the entry is complete */
 
   ulong last_updated_slot;
   ulong entry_pc;
@@ -16,9 +27,30 @@ struct fd_sbpf_validated_program {
 
   ulong rodata_sz;
 
+  /* Linear segment cost table of the text (see fd_vm_seg_cost), stored
+     in the record value seg_cost_off bytes from the start of this
+     struct. */
+
+  ulong seg_cost_off;
+
+  /* Predecoded text (see fd_vm_predecode), stored in the record value
+     predecoded_off bytes from the start of this struct. */
+
+  ulong predecoded_off;
+
+  /* Native code compiled from the program (see fd_vm_jit.h), stored in
+     the record value jit_off bytes from the start of this struct.
+     jit_sz is 0 if the program was not compiled. */
+
+  ulong jit_off;
+  ulong jit_sz;
+
   fd_sbpf_calldests_t calldests[];
 
   // uchar rodata[];
+  // uint  seg_cost[];
+  // fd_vm_predecoded_t predecoded[];
+  // uchar jit[];
 };
 typedef struct fd_sbpf_validated_program fd_sbpf_validated_program_t;
 
@@ -37,6 +69,32 @@ fd_sbpf_validated_program_footprint( fd_sbpf_elf_info_t const * elf_info );
 uchar *
 fd_sbpf_validated_program_rodata( fd_sbpf_validated_program_t * prog );
 
+/* fd_sbpf_validated_program_seg_cost returns the segment cost table
+   of the program to pass to fd_vm_seg_cost_set. */
+
+static inline uint const *
+fd_sbpf_validated_program_seg_cost( fd_sbpf_validated_program_t const * prog ) {
+  return (uint const *)((ulong)prog + prog->seg_cost_off);
+}
+
+/* fd_sbpf_validated_program_predecoded returns the predecoded text of
+   the program to pass to fd_vm_predecode_set. */
+
+static inline fd_vm_predecoded_t const *
+fd_sbpf_validated_program_predecoded( fd_sbpf_validated_program_t const * prog ) {
+  return (fd_vm_predecoded_t const *)((ulong)prog + prog->predecoded_off);
+}
+
+/* fd_sbpf_validated_program_jit returns the compiled program to pass to
+   fd_vm_exec_jit, NULL if prog was not compiled.  Programs are compiled
+   when the cache entry is created by a thread with a jit code cache
+   attached (i.e. processes that execute programs with the jit). */
+
+static inline void const *
+fd_sbpf_validated_program_jit( fd_sbpf_validated_program_t const * prog ) {
+  return prog->jit_sz ? (void const *)((ulong)prog + prog->jit_off) : NULL;
+}
+
 /* FIXME: Implement this (or remove?) */
 ulong
 fd_sbpf_validated_program_from_sbpf_program( fd_sbpf_program_t const * prog,
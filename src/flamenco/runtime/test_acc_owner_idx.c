@@ -0,0 +1,182 @@
+#include "fd_acc_owner_idx.h"
+
+#define TEST_ACC_CNT (100UL)
+
+static fd_pubkey_t
+test_pubkey( ulong i ) {
+  fd_pubkey_t key; memset( &key, 0, sizeof(fd_pubkey_t) );
+  key.ul[0] = i+1UL;
+  key.ul[1] = 0x5678UL;
+  return key;
+}
+
+static fd_pubkey_t
+test_owner( ulong i ) {
+  fd_pubkey_t key; memset( &key, (int)( 0xa0UL+i ), sizeof(fd_pubkey_t) );
+  return key;
+}
+
+/* test_account_save saves account i with owner in txn through the
+   acc_mgr save path that maintains the owner index. */
+
+static void
+test_account_save( fd_acc_mgr_t *      acc_mgr,
+                   fd_funk_txn_t *     txn,
+                   ulong               i,
+                   fd_pubkey_t const * owner ) {
+  uchar buf[ sizeof(fd_account_meta_t)+16UL ] __attribute__((aligned(8UL)));
+  fd_account_meta_t * meta = (fd_account_meta_t *)buf;
+  fd_account_meta_init( meta );
+  meta->dlen          = 16UL;
+  meta->info.lamports = 1000UL+i;
+  memcpy( meta->info.owner, owner, sizeof(fd_pubkey_t) );
+  memset( buf+sizeof(fd_account_meta_t), (int)i, 16UL );
+
+  FD_BORROWED_ACCOUNT_DECL( acc );
+  *acc->pubkey    = test_pubkey( i );
+  acc->meta       = meta;
+  acc->const_meta = meta;
+  FD_TEST( fd_acc_mgr_save_non_tpool( acc_mgr, txn, acc )==FD_ACC_MGR_SUCCESS );
+}
+
+static int
+test_cb( fd_pubkey_t const *       acct,
+         fd_account_meta_t const * meta,
+         void *                    arg ) {
+  ulong i = acct->ul[0]-1UL;
+  FD_TEST( i<TEST_ACC_CNT+1UL );
+  FD_TEST( meta->info.lamports==1000UL+i );
+  ulong * cnt = (ulong *)arg;
+  (*cnt)++;
+  return 0;
+}
+
+static ulong
+test_query( fd_acc_owner_idx_t * idx,
+            fd_funk_t *          funk,
+            fd_funk_txn_t *      txn,
+            ulong                owner_i ) {
+  fd_pubkey_t owner = test_owner( owner_i );
+  ulong       cnt   = 0UL;
+  ulong       ret   = fd_acc_owner_idx_query( idx, funk, txn, &owner, test_cb, &cnt );
+  FD_TEST( ret==cnt );
+  return cnt;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "gigantic"      );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 1UL             );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-sz %s, --page-cnt %lu, --near-cpu %lu)", _page_sz, page_cnt, near_cpu ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  ulong       tag  = 1234UL;
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), tag ), tag, tag, 16UL, 1024UL ) );
+  FD_TEST( funk );
+  fd_acc_mgr_t * acc_mgr = fd_acc_mgr_new( fd_wksp_alloc_laddr( wksp, FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT, tag ), funk );
+  FD_TEST( acc_mgr );
+
+  FD_TEST( !fd_acc_owner_idx_footprint( 0UL, 16UL ) );
+  ulong                ele_max = 1024UL;
+  fd_acc_owner_idx_t * idx     = fd_acc_owner_idx_join( fd_acc_owner_idx_new(
+      fd_wksp_alloc_laddr( wksp, fd_acc_owner_idx_align(), fd_acc_owner_idx_footprint( ele_max, 16UL ), tag ), tag, ele_max, 16UL ) );
+  FD_TEST( idx );
+
+  /* Accounts loaded without the index (e.g. from a snapshot) are
+     picked up by a rebuild.  Even accounts are owned by owner 0, odd
+     ones by owner 1. */
+
+  fd_funk_start_write( funk );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) {
+    fd_pubkey_t owner = test_owner( i&1UL );
+    test_account_save( acc_mgr, NULL, i, &owner );
+  }
+  FD_TEST( fd_acc_owner_idx_ele_cnt( idx )==0UL );
+  FD_TEST( fd_acc_owner_idx_rebuild( idx, funk )==TEST_ACC_CNT );
+  FD_TEST( !fd_acc_owner_idx_verify( idx ) );
+  acc_mgr->owner_idx = idx;
+
+  FD_TEST( test_query( idx, funk, NULL, 0UL )==TEST_ACC_CNT/2UL );
+  FD_TEST( test_query( idx, funk, NULL, 1UL )==TEST_ACC_CNT/2UL );
+  FD_TEST( test_query( idx, funk, NULL, 2UL )==0UL );
+
+  /* Two competing forks: slot 10 reassigns account 0 to owner 2, slot
+     11 creates account TEST_ACC_CNT with owner 0. */
+
+  fd_funk_txn_xid_t xid; memset( &xid, 0, sizeof(xid) );
+  xid.ul[0] = 10UL; xid.ul[1] = 1UL;
+  fd_funk_txn_t * txn10 = fd_funk_txn_prepare( funk, NULL, &xid, 1 );
+  xid.ul[0] = 11UL;
+  fd_funk_txn_t * txn11 = fd_funk_txn_prepare( funk, NULL, &xid, 1 );
+  FD_TEST( txn10 && txn11 );
+
+  fd_pubkey_t owner0 = test_owner( 0UL );
+  fd_pubkey_t owner2 = test_owner( 2UL );
+  test_account_save( acc_mgr, txn10, 0UL,          &owner2 );
+  test_account_save( acc_mgr, txn11, TEST_ACC_CNT, &owner0 );
+  FD_TEST( fd_acc_owner_idx_ele_cnt( idx )==TEST_ACC_CNT+2UL );
+  FD_TEST( !fd_acc_owner_idx_verify( idx ) );
+
+  FD_TEST( test_query( idx, funk, NULL,  0UL )==TEST_ACC_CNT/2UL     );
+  FD_TEST( test_query( idx, funk, NULL,  2UL )==0UL                  );
+  FD_TEST( test_query( idx, funk, txn10, 0UL )==TEST_ACC_CNT/2UL-1UL );
+  FD_TEST( test_query( idx, funk, txn10, 2UL )==1UL                  );
+  FD_TEST( test_query( idx, funk, txn11, 0UL )==TEST_ACC_CNT/2UL+1UL );
+  FD_TEST( test_query( idx, funk, txn11, 2UL )==0UL                  );
+
+  /* Concurrent readers get the candidates (outside of the write lock) */
+
+  fd_funk_end_write( funk );
+  fd_pubkey_t accts[ 8 ];
+  FD_TEST( fd_acc_owner_idx_query_safe( idx, funk, &owner0, accts, 8UL )==TEST_ACC_CNT/2UL+1UL );
+  FD_TEST( fd_acc_owner_idx_query_safe( idx, funk, &owner2, accts, 8UL )==1UL );
+  FD_TEST( accts[0].ul[0]==1UL );
+  fd_funk_start_write( funk );
+
+  /* Rooting slot 10 makes the old owner of account 0 stale.  The
+     account of the cancelled fork is stale too but its entry is newer
+     than the root. */
+
+  FD_TEST( fd_funk_txn_publish( funk, txn10, 1 )==1UL );
+  FD_TEST( fd_acc_owner_idx_gc( idx, funk, 10UL, ULONG_MAX )==1UL );
+  FD_TEST( fd_acc_owner_idx_ele_cnt( idx )==TEST_ACC_CNT+1UL );
+  FD_TEST( !fd_acc_owner_idx_verify( idx ) );
+  FD_TEST( test_query( idx, funk, NULL, 0UL )==TEST_ACC_CNT/2UL-1UL );
+  FD_TEST( test_query( idx, funk, NULL, 2UL )==1UL );
+
+  ulong removed = 0UL;
+  for( ulong i=0UL; i<TEST_ACC_CNT+2UL; i++ ) removed += fd_acc_owner_idx_gc( idx, funk, 12UL, 1UL );
+  FD_TEST( removed==1UL );
+  FD_TEST( fd_acc_owner_idx_ele_cnt( idx )==TEST_ACC_CNT );
+  FD_TEST( !fd_acc_owner_idx_verify( idx ) );
+  fd_funk_end_write( funk );
+  FD_TEST( fd_acc_owner_idx_query_safe( idx, funk, &owner0, accts, 8UL )==TEST_ACC_CNT/2UL-1UL );
+
+  /* An index that is too small keeps what fits */
+
+  void * small_mem = fd_wksp_alloc_laddr( wksp, fd_acc_owner_idx_align(), fd_acc_owner_idx_footprint( 8UL, 2UL ), tag );
+  fd_acc_owner_idx_t * small = fd_acc_owner_idx_join( fd_acc_owner_idx_new( small_mem, tag, 8UL, 2UL ) );
+  FD_TEST( small );
+  fd_funk_start_write( funk );
+  FD_TEST( fd_acc_owner_idx_rebuild( small, funk )==8UL );
+  fd_funk_end_write( funk );
+  FD_TEST( small->full );
+  FD_TEST( !fd_acc_owner_idx_verify( small ) );
+  fd_wksp_free_laddr( fd_acc_owner_idx_delete( fd_acc_owner_idx_leave( small ) ) );
+
+  acc_mgr->owner_idx = NULL;
+  fd_wksp_free_laddr( fd_acc_owner_idx_delete( fd_acc_owner_idx_leave( idx ) ) );
+  fd_wksp_free_laddr( fd_acc_mgr_delete( acc_mgr ) );
+  fd_wksp_free_laddr( fd_funk_delete( fd_funk_leave( funk ) ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
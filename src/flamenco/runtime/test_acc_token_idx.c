@@ -0,0 +1,221 @@
+#include "fd_acc_token_idx.h"
+
+#define TEST_ACC_CNT (60UL)
+
+static fd_pubkey_t
+test_pubkey( ulong i ) {
+  fd_pubkey_t key; memset( &key, 0, sizeof(fd_pubkey_t) );
+  key.ul[0] = i+1UL;
+  key.ul[1] = 0x5678UL;
+  return key;
+}
+
+/* test_key returns owner, delegate or mint i */
+
+static fd_pubkey_t
+test_key( ulong kind, ulong i ) {
+  fd_pubkey_t key; memset( &key, (int)( 0xa0UL+0x10UL*kind+i ), sizeof(fd_pubkey_t) );
+  return key;
+}
+
+/* test_account_save saves account i in txn through the acc_mgr save
+   path that maintains the token index.  Token accounts are owned by
+   owner_i, have mint 0 and optionally delegate 0.  Accounts longer
+   than the base layout are Token-2022 accounts with extensions. */
+
+static void
+test_account_save( fd_acc_mgr_t *      acc_mgr,
+                   fd_funk_txn_t *     txn,
+                   ulong               i,
+                   fd_pubkey_t const * program,
+                   ulong               dlen,
+                   ulong               owner_i,
+                   int                 delegate ) {
+  uchar buf[ sizeof(fd_account_meta_t)+FD_TOKEN_ACCT_SZ+8UL ] __attribute__((aligned(8UL)));
+  fd_account_meta_t * meta = (fd_account_meta_t *)buf;
+  fd_account_meta_init( meta );
+  meta->dlen          = dlen;
+  meta->info.lamports = 1000UL+i;
+  memcpy( meta->info.owner, program, sizeof(fd_pubkey_t) );
+
+  uchar * data = buf+sizeof(fd_account_meta_t);
+  memset( data, 0, FD_TOKEN_ACCT_SZ+8UL );
+  fd_pubkey_t mint  = test_key( FD_ACC_TOKEN_IDX_KIND_MINT,     0UL     );
+  fd_pubkey_t owner = test_key( FD_ACC_TOKEN_IDX_KIND_OWNER,    owner_i );
+  fd_pubkey_t deleg = test_key( FD_ACC_TOKEN_IDX_KIND_DELEGATE, 0UL     );
+  memcpy( data+FD_TOKEN_ACCT_MINT_OFF,  &mint,  sizeof(fd_pubkey_t) );
+  memcpy( data+FD_TOKEN_ACCT_OWNER_OFF, &owner, sizeof(fd_pubkey_t) );
+  FD_STORE( ulong, data+FD_TOKEN_ACCT_AMOUNT_OFF, i );
+  if( delegate ) {
+    FD_STORE( uint, data+FD_TOKEN_ACCT_DELEGATE_TAG_OFF, 1U );
+    memcpy( data+FD_TOKEN_ACCT_DELEGATE_OFF, &deleg, sizeof(fd_pubkey_t) );
+  }
+  data[ FD_TOKEN_ACCT_STATE_OFF ] = 1; /* initialized */
+  if( dlen>FD_TOKEN_ACCT_SZ ) data[ FD_TOKEN_ACCT_TYPE_OFF ] = FD_TOKEN_ACCT_TYPE_ACCOUNT;
+
+  FD_BORROWED_ACCOUNT_DECL( acc );
+  *acc->pubkey    = test_pubkey( i );
+  acc->meta       = meta;
+  acc->const_meta = meta;
+  FD_TEST( fd_acc_mgr_save_non_tpool( acc_mgr, txn, acc )==FD_ACC_MGR_SUCCESS );
+}
+
+static void
+test_token_save( fd_acc_mgr_t *  acc_mgr,
+                 fd_funk_txn_t * txn,
+                 ulong           i,
+                 ulong           owner_i ) {
+  test_account_save( acc_mgr, txn, i, &fd_solana_spl_token_id, FD_TOKEN_ACCT_SZ, owner_i, !(i%3UL) );
+}
+
+static int
+test_cb( fd_pubkey_t const *       acct,
+         fd_account_meta_t const * meta,
+         void *                    arg ) {
+  ulong i = acct->ul[0]-1UL;
+  FD_TEST( i<TEST_ACC_CNT+1UL );
+  FD_TEST( meta->info.lamports==1000UL+i );
+  uchar const * data = fd_token_acct_data( meta );
+  FD_TEST( data );
+  FD_TEST( fd_token_acct_amount( data )==i );
+  ulong * cnt = (ulong *)arg;
+  (*cnt)++;
+  return 0;
+}
+
+static ulong
+test_query( fd_acc_token_idx_t * idx,
+            fd_funk_t *          funk,
+            fd_funk_txn_t *      txn,
+            ulong                kind,
+            ulong                key_i ) {
+  fd_pubkey_t key = test_key( kind, key_i );
+  ulong       cnt = 0UL;
+  ulong       ret = fd_acc_token_idx_query( idx, funk, txn, kind, &key, test_cb, &cnt );
+  FD_TEST( ret==cnt );
+  return cnt;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "gigantic"      );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 1UL             );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-sz %s, --page-cnt %lu, --near-cpu %lu)", _page_sz, page_cnt, near_cpu ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  ulong       tag  = 1234UL;
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), tag ), tag, tag, 16UL, 1024UL ) );
+  FD_TEST( funk );
+  fd_acc_mgr_t * acc_mgr = fd_acc_mgr_new( fd_wksp_alloc_laddr( wksp, FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT, tag ), funk );
+  FD_TEST( acc_mgr );
+
+  FD_TEST( !fd_acc_token_idx_footprint( 0UL, 16UL ) );
+  ulong                ele_max = 1024UL;
+  fd_acc_token_idx_t * idx     = fd_acc_token_idx_join( fd_acc_token_idx_new(
+      fd_wksp_alloc_laddr( wksp, fd_acc_token_idx_align(), fd_acc_token_idx_footprint( ele_max, 16UL ), tag ), tag, ele_max, 16UL ) );
+  FD_TEST( idx );
+
+  /* Accounts loaded without the index (e.g. from a snapshot) are
+     picked up by a rebuild.  Even accounts are owned by owner 0, odd
+     ones by owner 1, every third one has delegate 0.  Accounts that
+     are not token accounts are not indexed. */
+
+  fd_funk_start_write( funk );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) test_token_save( acc_mgr, NULL, i, i&1UL );
+  fd_pubkey_t other = test_key( FD_ACC_TOKEN_IDX_KIND_CNT, 0UL );
+  test_account_save( acc_mgr, NULL, TEST_ACC_CNT+1UL, &other,                  FD_TOKEN_ACCT_SZ, 0UL, 0 );
+  test_account_save( acc_mgr, NULL, TEST_ACC_CNT+2UL, &fd_solana_spl_token_id, FD_TOKEN_MINT_SZ, 0UL, 0 );
+  FD_TEST( fd_acc_token_idx_ele_cnt( idx )==0UL );
+  ulong ele_cnt = 2UL*TEST_ACC_CNT + TEST_ACC_CNT/3UL;
+  FD_TEST( fd_acc_token_idx_rebuild( idx, funk )==ele_cnt );
+  FD_TEST( !fd_acc_token_idx_verify( idx ) );
+  acc_mgr->token_idx = idx;
+
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_OWNER,    0UL )==TEST_ACC_CNT/2UL );
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_OWNER,    1UL )==TEST_ACC_CNT/2UL );
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_OWNER,    2UL )==0UL              );
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_DELEGATE, 0UL )==TEST_ACC_CNT/3UL );
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_MINT,     0UL )==TEST_ACC_CNT     );
+
+  /* Two competing forks: slot 10 turns account 0 into a Token-2022
+     account of owner 2, slot 11 creates account TEST_ACC_CNT with owner
+     0. */
+
+  fd_funk_txn_xid_t xid; memset( &xid, 0, sizeof(xid) );
+  xid.ul[0] = 10UL; xid.ul[1] = 1UL;
+  fd_funk_txn_t * txn10 = fd_funk_txn_prepare( funk, NULL, &xid, 1 );
+  xid.ul[0] = 11UL;
+  fd_funk_txn_t * txn11 = fd_funk_txn_prepare( funk, NULL, &xid, 1 );
+  FD_TEST( txn10 && txn11 );
+
+  test_account_save( acc_mgr, txn10, 0UL, &fd_solana_spl_token_2022_id, FD_TOKEN_ACCT_SZ+8UL, 2UL, 1 );
+  test_token_save( acc_mgr, txn11, TEST_ACC_CNT, 0UL );
+  FD_TEST( fd_acc_token_idx_ele_cnt( idx )==ele_cnt+1UL+3UL );
+  FD_TEST( !fd_acc_token_idx_verify( idx ) );
+
+  FD_TEST( test_query( idx, funk, NULL,  FD_ACC_TOKEN_IDX_KIND_OWNER, 0UL )==TEST_ACC_CNT/2UL     );
+  FD_TEST( test_query( idx, funk, NULL,  FD_ACC_TOKEN_IDX_KIND_OWNER, 2UL )==0UL                  );
+  FD_TEST( test_query( idx, funk, txn10, FD_ACC_TOKEN_IDX_KIND_OWNER, 0UL )==TEST_ACC_CNT/2UL-1UL );
+  FD_TEST( test_query( idx, funk, txn10, FD_ACC_TOKEN_IDX_KIND_OWNER, 2UL )==1UL                  );
+  FD_TEST( test_query( idx, funk, txn11, FD_ACC_TOKEN_IDX_KIND_OWNER, 0UL )==TEST_ACC_CNT/2UL+1UL );
+  FD_TEST( test_query( idx, funk, txn11, FD_ACC_TOKEN_IDX_KIND_MINT,  0UL )==TEST_ACC_CNT+1UL     );
+
+  /* Concurrent readers get the candidates (outside of the write lock) */
+
+  fd_funk_end_write( funk );
+  fd_pubkey_t owner0 = test_key( FD_ACC_TOKEN_IDX_KIND_OWNER, 0UL );
+  fd_pubkey_t owner2 = test_key( FD_ACC_TOKEN_IDX_KIND_OWNER, 2UL );
+  fd_pubkey_t accts[ 8 ];
+  FD_TEST( fd_acc_token_idx_query_safe( idx, funk, FD_ACC_TOKEN_IDX_KIND_OWNER, &owner0, accts, 8UL )==TEST_ACC_CNT/2UL+1UL );
+  FD_TEST( fd_acc_token_idx_query_safe( idx, funk, FD_ACC_TOKEN_IDX_KIND_OWNER, &owner2, accts, 8UL )==1UL );
+  FD_TEST( accts[0].ul[0]==1UL );
+  FD_TEST( !fd_acc_token_idx_query_safe( idx, funk, FD_ACC_TOKEN_IDX_KIND_DELEGATE, &owner0, accts, 8UL ) );
+  fd_funk_start_write( funk );
+
+  /* Rooting slot 10 makes the old owner of account 0 stale.  The
+     account of the cancelled fork is stale too but its entries are
+     newer than the root. */
+
+  FD_TEST( fd_funk_txn_publish( funk, txn10, 1 )==1UL );
+  FD_TEST( fd_acc_token_idx_gc( idx, funk, 10UL, ULONG_MAX )==1UL );
+  FD_TEST( fd_acc_token_idx_ele_cnt( idx )==ele_cnt+3UL );
+  FD_TEST( !fd_acc_token_idx_verify( idx ) );
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_OWNER, 0UL )==TEST_ACC_CNT/2UL-1UL );
+  FD_TEST( test_query( idx, funk, NULL, FD_ACC_TOKEN_IDX_KIND_OWNER, 2UL )==1UL );
+
+  ulong removed = 0UL;
+  for( ulong i=0UL; i<ele_cnt+3UL; i++ ) removed += fd_acc_token_idx_gc( idx, funk, 12UL, 1UL );
+  FD_TEST( removed==3UL );
+  FD_TEST( fd_acc_token_idx_ele_cnt( idx )==ele_cnt );
+  FD_TEST( !fd_acc_token_idx_verify( idx ) );
+  fd_funk_end_write( funk );
+  FD_TEST( fd_acc_token_idx_query_safe( idx, funk, FD_ACC_TOKEN_IDX_KIND_OWNER, &owner0, accts, 8UL )==TEST_ACC_CNT/2UL-1UL );
+
+  /* An index that is too small keeps what fits */
+
+  void * small_mem = fd_wksp_alloc_laddr( wksp, fd_acc_token_idx_align(), fd_acc_token_idx_footprint( 8UL, 2UL ), tag );
+  fd_acc_token_idx_t * small = fd_acc_token_idx_join( fd_acc_token_idx_new( small_mem, tag, 8UL, 2UL ) );
+  FD_TEST( small );
+  fd_funk_start_write( funk );
+  FD_TEST( fd_acc_token_idx_rebuild( small, funk )<=8UL );
+  fd_funk_end_write( funk );
+  FD_TEST( small->full );
+  FD_TEST( !fd_acc_token_idx_verify( small ) );
+  fd_wksp_free_laddr( fd_acc_token_idx_delete( fd_acc_token_idx_leave( small ) ) );
+
+  acc_mgr->token_idx = NULL;
+  fd_wksp_free_laddr( fd_acc_token_idx_delete( fd_acc_token_idx_leave( idx ) ) );
+  fd_wksp_free_laddr( fd_acc_mgr_delete( acc_mgr ) );
+  fd_wksp_free_laddr( fd_funk_delete( fd_funk_leave( funk ) ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
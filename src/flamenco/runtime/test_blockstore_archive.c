@@ -0,0 +1,247 @@
+#include "fd_blockstore_archive.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#define TEST_TXN_CNT (8UL)
+
+/* Insert a complete block for slot with TEST_TXN_CNT fake txns (the
+   blockstore and the archive do not parse the block data after the
+   block is assembled, they only use the txn refs).
+   Txn j of slot has signature bytes (slot,j,...). */
+
+static void
+test_block_insert( fd_blockstore_t * blockstore, ulong slot, ulong parent_slot ) {
+  fd_wksp_t *  wksp  = fd_blockstore_wksp( blockstore );
+  fd_alloc_t * alloc = fd_blockstore_alloc( blockstore );
+
+  fd_block_map_t * entry = fd_block_map_insert( fd_blockstore_block_map( blockstore ), &slot );
+  FD_TEST( entry );
+  entry->parent_slot = parent_slot;
+  memset( entry->child_slots, UCHAR_MAX, FD_BLOCKSTORE_CHILD_SLOT_MAX * sizeof( ulong ) );
+  entry->child_slot_cnt = 0;
+  entry->height         = slot - 100UL;
+  memset( entry->block_hash.uc, (int)slot, sizeof(fd_hash_t) );
+  memset( entry->bank_hash.uc, (int)~slot, sizeof(fd_hash_t) );
+  entry->flags          = fd_uchar_set_bit( fd_uchar_set_bit( 0, FD_BLOCK_FLAG_PROCESSED ), FD_BLOCK_FLAG_FINALIZED );
+  entry->ts             = (long)slot * 400000000L;
+  entry->complete_idx   = 31;
+
+  fd_block_map_t * parent = fd_blockstore_block_map_query( blockstore, parent_slot );
+  FD_TEST( parent );
+  parent->child_slots[ parent->child_slot_cnt++ ] = slot;
+
+  ulong   data_sz = TEST_TXN_CNT * 256UL;
+  uchar * data    = fd_alloc_malloc( alloc, 128UL, data_sz );
+  for( ulong i = 0; i < data_sz; i++ ) data[i] = (uchar)( slot * 31UL + i );
+
+  fd_block_txn_ref_t * txns = fd_alloc_malloc( alloc, alignof( fd_block_txn_ref_t ), TEST_TXN_CNT * sizeof( fd_block_txn_ref_t ) );
+  for( ulong j = 0; j < TEST_TXN_CNT; j++ ) {
+    txns[j].txn_off = j * 256UL;
+    txns[j].id_off  = j * 256UL + 1UL;
+    txns[j].sz      = 256UL;
+    data[ txns[j].txn_off ] = 1; /* signature count */
+    memset( data + txns[j].id_off, 0, FD_ED25519_SIG_SZ );
+    data[ txns[j].id_off     ] = (uchar)slot;
+    data[ txns[j].id_off + 1 ] = (uchar)j;
+
+    fd_blockstore_txn_key_t sig;
+    fd_memcpy( &sig, data + txns[j].id_off, sizeof( sig ) );
+    fd_blockstore_txn_map_t * elem = fd_blockstore_txn_map_insert( fd_blockstore_txn_map( blockstore ), &sig );
+    FD_TEST( elem );
+    elem->slot       = slot;
+    elem->offset     = txns[j].txn_off;
+    elem->sz         = txns[j].sz;
+    elem->meta_gaddr = 0;
+    elem->meta_sz    = 0;
+    elem->meta_owned = 0;
+  }
+
+  fd_block_t * block = fd_alloc_malloc( alloc, alignof( fd_block_t ), sizeof( fd_block_t ) );
+  memset( block, 0, sizeof( fd_block_t ) );
+  block->data_gaddr = fd_wksp_gaddr_fast( wksp, data );
+  block->data_sz    = data_sz;
+  block->txns_gaddr = fd_wksp_gaddr_fast( wksp, txns );
+  block->txns_cnt   = TEST_TXN_CNT;
+  entry->block_gaddr = fd_wksp_gaddr_fast( wksp, block );
+}
+
+static void
+test_sig( uchar sig[ FD_ED25519_SIG_SZ ], ulong slot, ulong j ) {
+  memset( sig, 0, FD_ED25519_SIG_SZ );
+  sig[0] = (uchar)slot;
+  sig[1] = (uchar)j;
+}
+
+/* Check the block and txns of slot are queryable with their content */
+
+static void
+test_slot_present( fd_blockstore_t * blockstore, ulong slot ) {
+  fd_block_map_t meta[1];
+  uchar *        data    = NULL;
+  ulong          data_sz = 0UL;
+  FD_TEST( fd_blockstore_block_map_query_volatile( blockstore, slot, meta )==FD_BLOCKSTORE_OK );
+  FD_TEST( meta->slot==slot && meta->height==slot-100UL && meta->ts==(long)slot * 400000000L );
+  FD_TEST( fd_blockstore_block_data_query_volatile( blockstore, slot, meta, fd_libc_alloc_virtual(), &data, &data_sz )==FD_BLOCKSTORE_OK );
+  FD_TEST( data_sz==TEST_TXN_CNT * 256UL );
+  FD_TEST( meta->block_hash.uc[0]==(uchar)slot );
+  FD_TEST( data[ 100 ]==(uchar)( slot * 31UL + 100UL ) );
+  free( data );
+
+  for( ulong j = 0; j < TEST_TXN_CNT; j++ ) {
+    uchar                   sig[ FD_ED25519_SIG_SZ ];
+    fd_blockstore_txn_map_t txn[1];
+    long                    ts;
+    uchar                   flags;
+    uchar                   txn_data[ FD_TXN_MTU ];
+    test_sig( sig, slot, j );
+    FD_TEST( fd_blockstore_txn_query_volatile( blockstore, sig, txn, &ts, &flags, txn_data )==FD_BLOCKSTORE_OK );
+    FD_TEST( txn->slot==slot && txn->offset==j * 256UL && txn->sz==256UL );
+    FD_TEST( ts==(long)slot * 400000000L );
+    FD_TEST( fd_uchar_extract_bit( flags, FD_BLOCK_FLAG_FINALIZED ) );
+    FD_TEST( !memcmp( txn_data + 1, sig, FD_ED25519_SIG_SZ ) );
+  }
+}
+
+static void
+test_slot_missing( fd_blockstore_t * blockstore, ulong slot ) {
+  fd_block_map_t          meta[1];
+  fd_blockstore_txn_map_t txn[1];
+  uchar                   sig[ FD_ED25519_SIG_SZ ];
+  test_sig( sig, slot, 0UL );
+  FD_TEST( fd_blockstore_block_map_query_volatile( blockstore, slot, meta )==FD_BLOCKSTORE_ERR_SLOT_MISSING );
+  FD_TEST( fd_blockstore_txn_query_volatile( blockstore, sig, txn, NULL, NULL, NULL )==FD_BLOCKSTORE_ERR_TXN_MISSING );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "gigantic"      );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 1UL             );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-sz %s, --page-cnt %lu, --near-cpu %lu)", _page_sz, page_cnt, near_cpu ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  void * mem = fd_wksp_alloc_laddr( wksp, fd_blockstore_align(), fd_blockstore_footprint(), 1UL );
+  FD_TEST( mem );
+  fd_blockstore_t * blockstore = fd_blockstore_join( fd_blockstore_new( mem, 1UL, 42UL, 1024UL, 1024UL, 12 ) );
+  FD_TEST( blockstore );
+
+  fd_slot_bank_t slot_bank[1];
+  memset( slot_bank, 0, sizeof(fd_slot_bank_t) );
+  slot_bank->slot      = 100UL;
+  slot_bank->prev_slot = 99UL;
+  FD_TEST( fd_blockstore_init( blockstore, slot_bank ) );
+
+  /* 100 <- 101 <- ... <- 120, with a fork 103 <- 130 */
+
+  for( ulong slot = 101UL; slot <= 120UL; slot++ ) test_block_insert( blockstore, slot, slot - 1UL );
+  test_block_insert( blockstore, 130UL, 103UL );
+
+  char path[] = "/tmp/test_blockstore_archive.XXXXXX";
+  int  tmp_fd = mkstemp( path );
+  FD_TEST( tmp_fd>=0 );
+  close( tmp_fd );
+
+  fd_blockstore_archive_t archive[1];
+  FD_TEST( fd_blockstore_archive_open( archive, path, 1, 8UL, 10UL, 1UL << 20 ) );
+  FD_TEST( !fd_blockstore_archive_attach( blockstore, archive ) );
+  FD_TEST( fd_blockstore_archive_attach( blockstore, archive ) ); /* already attached */
+
+  /* Publishing evicts the rooted blocks 100..109 (100 has no data)
+     and the fork */
+
+  fd_blockstore_start_write( blockstore );
+  FD_TEST( fd_blockstore_publish( blockstore, 110UL )==FD_BLOCKSTORE_OK );
+  fd_blockstore_end_write( blockstore );
+
+  FD_TEST( archive->hdr->slot_cnt==9UL );
+  FD_TEST( archive->hdr->txn_cnt==9UL * TEST_TXN_CNT );
+  FD_TEST( archive->hdr->slot_lo==101UL && archive->hdr->slot_hi==109UL );
+  FD_TEST( !fd_block_map_query( fd_blockstore_block_map( blockstore ), &(ulong){ 105UL }, NULL ) );
+
+  for( ulong slot = 101UL; slot <= 120UL; slot++ ) test_slot_present( blockstore, slot );
+  test_slot_missing( blockstore, 100UL );
+  test_slot_missing( blockstore, 130UL );
+
+  /* Publishing again appends to the archive */
+
+  fd_blockstore_start_write( blockstore );
+  FD_TEST( fd_blockstore_publish( blockstore, 115UL )==FD_BLOCKSTORE_OK );
+  fd_blockstore_end_write( blockstore );
+  FD_TEST( archive->hdr->slot_cnt==14UL );
+
+  /* Reopen read-only */
+
+  FD_TEST( !fd_blockstore_archive_detach( blockstore ) );
+  test_slot_missing( blockstore, 105UL );
+  fd_blockstore_archive_close( archive );
+
+  FD_TEST( fd_blockstore_archive_open( archive, path, 0, 0UL, 0UL, 0UL ) );
+  FD_TEST( !archive->writable );
+  FD_TEST( !fd_blockstore_archive_attach( blockstore, archive ) );
+  for( ulong slot = 101UL; slot <= 120UL; slot++ ) test_slot_present( blockstore, slot );
+  FD_TEST( !fd_blockstore_archive_detach( blockstore ) );
+  fd_blockstore_archive_close( archive );
+
+  /* The writer crashed after indexing slot 114 but before publishing
+     its record, so the index entries of 114 refer past the published
+     data region.  After the restart, the next block is appended at the
+     same offset. */
+
+  FD_TEST( fd_blockstore_archive_open( archive, path, 1, 0UL, 0UL, 0UL ) );
+  fd_blockstore_archive_block_t const * blk = fd_blockstore_archive_block_query( archive, 114UL );
+  FD_TEST( blk );
+  archive->hdr->data_sz = (ulong)( (uchar const *)blk - archive->data );
+  FD_TEST( !fd_blockstore_archive_attach( blockstore, archive ) );
+  test_slot_missing( blockstore, 114UL );
+  test_slot_present( blockstore, 113UL );
+
+  fd_blockstore_start_write( blockstore );
+  FD_TEST( fd_blockstore_archive_write( archive, blockstore, fd_blockstore_block_map_query( blockstore, 116UL ) )==FD_BLOCKSTORE_OK );
+  fd_blockstore_end_write( blockstore );
+  FD_TEST( fd_blockstore_archive_block_query( archive, 116UL )==blk );
+  test_slot_missing( blockstore, 114UL );
+  test_slot_present( blockstore, 113UL );
+
+  do {
+    uchar                                 sig[ FD_ED25519_SIG_SZ ];
+    fd_blockstore_archive_block_t const * txn_blk = NULL;
+    test_sig( sig, 116UL, 3UL );
+    FD_TEST( fd_blockstore_archive_txn_query( archive, sig, &txn_blk ) && txn_blk==blk );
+    test_sig( sig, 114UL, 3UL );
+    FD_TEST( !fd_blockstore_archive_txn_query( archive, sig, NULL ) );
+  } while(0);
+
+  FD_TEST( !fd_blockstore_archive_detach( blockstore ) );
+  fd_blockstore_archive_close( archive );
+
+  /* Small archive runs out of space */
+
+  FD_TEST( !unlink( path ) );
+  FD_TEST( fd_blockstore_archive_open( archive, path, 1, 2UL, 10UL, 1UL << 20 ) );
+  FD_TEST( !fd_blockstore_archive_attach( blockstore, archive ) );
+  for( ulong slot = 121UL; slot <= 125UL; slot++ ) test_block_insert( blockstore, slot, slot - 1UL );
+  fd_blockstore_start_write( blockstore );
+  FD_TEST( fd_blockstore_publish( blockstore, 125UL )==FD_BLOCKSTORE_OK );
+  fd_blockstore_end_write( blockstore );
+  FD_TEST( archive->hdr->slot_cnt==3UL );
+  FD_TEST( archive->full );
+  test_slot_present( blockstore, 117UL );
+  test_slot_missing( blockstore, 118UL );
+  test_slot_present( blockstore, 125UL );
+  FD_TEST( !fd_blockstore_archive_detach( blockstore ) );
+  fd_blockstore_archive_close( archive );
+  FD_TEST( !unlink( path ) );
+
+  fd_wksp_free_laddr( fd_blockstore_delete( fd_blockstore_leave( blockstore ) ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -0,0 +1,268 @@
+#include "fd_blockstore_sig_idx.h"
+#include "fd_blockstore_archive.h"
+#include "../../ballet/txn/fd_txn.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#define TEST_TXN_CNT (2UL)
+#define TEST_TXN_SZ  (256UL)
+
+/* Every txn has 3 accounts: a fee payer unique to the txn, a common
+   address, and a common program. */
+
+static fd_pubkey_t
+test_payer( ulong slot, ulong j ) {
+  fd_pubkey_t key; memset( &key, 0, sizeof(fd_pubkey_t) );
+  key.ul[0] = slot; key.ul[1] = j; key.ul[2] = 0x1234UL;
+  return key;
+}
+
+static fd_pubkey_t
+test_common( ulong i ) {
+  fd_pubkey_t key; memset( &key, (int)( 0xc0UL+i ), sizeof(fd_pubkey_t) );
+  return key;
+}
+
+static void
+test_sig( uchar sig[ FD_ED25519_SIG_SZ ], ulong slot, ulong j ) {
+  memset( sig, 0, FD_ED25519_SIG_SZ );
+  sig[0] = (uchar)slot;
+  sig[1] = (uchar)j;
+}
+
+/* Write a minimal legacy txn (1 signature, 1 instruction) to out and
+   return its size */
+
+static ulong
+test_txn_write( uchar * out, ulong slot, ulong j ) {
+  uchar * p = out;
+  *p++ = 1; /* signature cnt */
+  test_sig( p, slot, j ); p += FD_ED25519_SIG_SZ;
+  *p++ = 1; /* signed */
+  *p++ = 0; /* readonly signed */
+  *p++ = 1; /* readonly unsigned */
+  *p++ = 3; /* account cnt */
+  fd_pubkey_t keys[3] = { test_payer( slot, j ), test_common( 0UL ), test_common( 1UL ) };
+  fd_memcpy( p, keys, sizeof(keys) ); p += sizeof(keys);
+  memset( p, 0x42, 32UL ); p += 32UL; /* recent blockhash */
+  *p++ = 1; /* instruction cnt */
+  *p++ = 2; /* program idx */
+  *p++ = 1; /* account idx cnt */
+  *p++ = 0;
+  *p++ = 0; /* data sz */
+  return (ulong)( p - out );
+}
+
+static void
+test_block_insert( fd_blockstore_t * blockstore, ulong slot, ulong parent_slot ) {
+  fd_wksp_t *  wksp  = fd_blockstore_wksp( blockstore );
+  fd_alloc_t * alloc = fd_blockstore_alloc( blockstore );
+
+  fd_block_map_t * entry = fd_block_map_insert( fd_blockstore_block_map( blockstore ), &slot );
+  FD_TEST( entry );
+  entry->parent_slot = parent_slot;
+  memset( entry->child_slots, UCHAR_MAX, FD_BLOCKSTORE_CHILD_SLOT_MAX * sizeof( ulong ) );
+  entry->child_slot_cnt = 0;
+  entry->flags          = fd_uchar_set_bit( 0, FD_BLOCK_FLAG_PROCESSED );
+  entry->ts             = (long)slot * 400000000L;
+
+  fd_block_map_t * parent = fd_blockstore_block_map_query( blockstore, parent_slot );
+  FD_TEST( parent );
+  parent->child_slots[ parent->child_slot_cnt++ ] = slot;
+
+  ulong   data_sz = TEST_TXN_CNT * TEST_TXN_SZ;
+  uchar * data    = fd_alloc_malloc( alloc, 128UL, data_sz );
+  memset( data, 0, data_sz );
+
+  fd_block_txn_ref_t * txns = fd_alloc_malloc( alloc, alignof( fd_block_txn_ref_t ), TEST_TXN_CNT * sizeof( fd_block_txn_ref_t ) );
+  for( ulong j = 0; j < TEST_TXN_CNT; j++ ) {
+    txns[j].txn_off = j * TEST_TXN_SZ;
+    txns[j].id_off  = j * TEST_TXN_SZ + 1UL;
+    txns[j].sz      = test_txn_write( data + txns[j].txn_off, slot, j );
+    uchar txn_out[FD_TXN_MAX_SZ];
+    FD_TEST( fd_txn_parse_core( data + txns[j].txn_off, txns[j].sz, txn_out, NULL, NULL, 0 ) );
+  }
+
+  fd_block_t * block = fd_alloc_malloc( alloc, alignof( fd_block_t ), sizeof( fd_block_t ) );
+  memset( block, 0, sizeof( fd_block_t ) );
+  block->data_gaddr = fd_wksp_gaddr_fast( wksp, data );
+  block->data_sz    = data_sz;
+  block->txns_gaddr = fd_wksp_gaddr_fast( wksp, txns );
+  block->txns_cnt   = TEST_TXN_CNT;
+  entry->block_gaddr = fd_wksp_gaddr_fast( wksp, block );
+}
+
+static void
+test_publish( fd_blockstore_t * blockstore, ulong root ) {
+  fd_blockstore_start_write( blockstore );
+  FD_TEST( fd_blockstore_publish( blockstore, root )==FD_BLOCKSTORE_OK );
+  fd_blockstore_end_write( blockstore );
+}
+
+/* Check res holds the txns of slot_hi down to slot_lo, newest first */
+
+static void
+test_res( fd_blockstore_sig_idx_res_t const * res, ulong res_cnt, ulong slot_hi ) {
+  for( ulong i = 0; i < res_cnt; i++ ) {
+    ulong slot = slot_hi - i / TEST_TXN_CNT;
+    ulong j    = TEST_TXN_CNT - 1UL - i % TEST_TXN_CNT;
+    uchar sig[ FD_ED25519_SIG_SZ ];
+    test_sig( sig, slot, j );
+    FD_TEST( res[i].slot==slot );
+    FD_TEST( !memcmp( res[i].sig, sig, FD_ED25519_SIG_SZ ) );
+  }
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "gigantic"      );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 1UL             );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-sz %s, --page-cnt %lu, --near-cpu %lu)", _page_sz, page_cnt, near_cpu ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  void * mem = fd_wksp_alloc_laddr( wksp, fd_blockstore_align(), fd_blockstore_footprint(), 1UL );
+  FD_TEST( mem );
+  fd_blockstore_t * blockstore = fd_blockstore_join( fd_blockstore_new( mem, 1UL, 42UL, 1024UL, 1024UL, 12 ) );
+  FD_TEST( blockstore );
+
+  fd_slot_bank_t slot_bank[1];
+  memset( slot_bank, 0, sizeof(fd_slot_bank_t) );
+  slot_bank->slot      = 100UL;
+  slot_bank->prev_slot = 99UL;
+  FD_TEST( fd_blockstore_init( blockstore, slot_bank ) );
+
+  FD_TEST( !fd_blockstore_sig_idx_footprint( 0UL ) );
+  ulong lg_ent_max = 6UL; /* 64 entries, 3 per txn */
+  void * idx_mem = fd_wksp_alloc_laddr( wksp, fd_blockstore_sig_idx_align(), fd_blockstore_sig_idx_footprint( lg_ent_max ), 1UL );
+  fd_blockstore_sig_idx_t * idx = fd_blockstore_sig_idx_join( fd_blockstore_sig_idx_new( idx_mem, 42UL, lg_ent_max ) );
+  FD_TEST( idx );
+  FD_TEST( !fd_blockstore_sig_idx_query_attached( blockstore ) );
+  fd_blockstore_sig_idx_attach( blockstore, idx );
+  FD_TEST( fd_blockstore_sig_idx_query_attached( blockstore )==idx );
+
+  /* 100 <- 101 <- ... <- 118, with a fork 103 <- 130 */
+
+  for( ulong slot = 101UL; slot <= 118UL; slot++ ) test_block_insert( blockstore, slot, slot - 1UL );
+  test_block_insert( blockstore, 130UL, 103UL );
+
+  /* Pruned slots stay indexed while they are archived */
+
+  char path[] = "/tmp/test_blockstore_sig_idx.XXXXXX";
+  int  tmp_fd = mkstemp( path );
+  FD_TEST( tmp_fd>=0 );
+  close( tmp_fd );
+
+  fd_blockstore_archive_t archive[1];
+  FD_TEST( fd_blockstore_archive_open( archive, path, 1, 8UL, 10UL, 1UL << 20 ) );
+  FD_TEST( !fd_blockstore_archive_attach( blockstore, archive ) );
+
+  fd_pubkey_t                 common = test_common( 0UL );
+  fd_blockstore_sig_idx_res_t res[ 64 ];
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 64UL ) );
+
+  /* Rooting 105 indexes 101..105, not the fork */
+
+  test_publish( blockstore, 105UL );
+  FD_TEST( idx->seq==5UL * TEST_TXN_CNT * 3UL );
+  FD_TEST( idx->slot_hi==105UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 64UL )==5UL * TEST_TXN_CNT );
+  test_res( res, 5UL * TEST_TXN_CNT, 105UL );
+
+  fd_pubkey_t payer = test_payer( 102UL, 1UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL )==1UL );
+  test_res( res, 1UL, 102UL );
+  payer = test_payer( 130UL, 0UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL ) );
+
+  /* Pagination */
+
+  uchar before[ FD_ED25519_SIG_SZ ];
+  uchar until [ FD_ED25519_SIG_SZ ];
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 3UL )==3UL );
+  test_res( res, 3UL, 105UL );
+  fd_memcpy( before, res[2].sig, FD_ED25519_SIG_SZ ); /* 104 txn 1 */
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, before, NULL, res, 3UL )==3UL );
+  FD_TEST( res[0].slot==104UL && res[1].slot==103UL && res[2].slot==103UL );
+  test_sig( until, 102UL, 1UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, before, until, res, 64UL )==3UL );
+  test_sig( until, 105UL, 1UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, until, res, 64UL ) );
+  test_sig( before, 130UL, 0UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &common, before, NULL, res, 64UL ) );
+
+  /* Rooting 115 indexes 30 more entries and evicts the 26 oldest
+     (slots 101..104 and the payer of 105 txn 0) */
+
+  test_publish( blockstore, 110UL );
+  test_publish( blockstore, 115UL );
+  FD_TEST( idx->seq==15UL * TEST_TXN_CNT * 3UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 64UL )==21UL );
+  test_res( res, 21UL, 115UL );
+  payer = test_payer( 102UL, 1UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL ) );
+  payer = test_payer( 105UL, 0UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL ) );
+  payer = test_payer( 105UL, 1UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL )==1UL );
+
+  /* Evicted addresses leave the addr map, live ones stay */
+
+  fd_blockstore_sig_idx_addr_t * addr_map = fd_blockstore_sig_idx_addr_map( idx );
+  FD_TEST( fd_blockstore_sig_idx_addr_map_key_cnt( addr_map )==2UL + 21UL );
+  FD_TEST( !fd_blockstore_sig_idx_addr_map_verify( addr_map ) );
+
+  /* Without the archive, rooting 118 prunes 115..117 unarchived: the
+     entries of the previous root 115 are removed and 116..117 are not
+     indexed */
+
+  FD_TEST( !fd_blockstore_archive_detach( blockstore ) );
+  fd_blockstore_archive_close( archive );
+  FD_TEST( !unlink( path ) );
+
+  test_publish( blockstore, 118UL );
+  FD_TEST( idx->seq==15UL * TEST_TXN_CNT * 3UL );
+  FD_TEST( idx->slot_hi==118UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 64UL )==21UL );
+  test_res( res, TEST_TXN_CNT, 118UL );
+  test_res( res + TEST_TXN_CNT, 21UL - TEST_TXN_CNT, 114UL );
+  payer = test_payer( 115UL, 0UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL ) );
+  payer = test_payer( 116UL, 0UL );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL ) );
+  payer = test_payer( 118UL, 1UL );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &payer, NULL, NULL, res, 64UL )==1UL );
+  FD_TEST( fd_blockstore_sig_idx_addr_map_key_cnt( addr_map )==2UL + 21UL );
+  FD_TEST( !fd_blockstore_sig_idx_addr_map_verify( addr_map ) );
+
+  /* Removing a slot that is not the newest indexed one is a no-op */
+
+  fd_blockstore_start_write( blockstore );
+  FD_TEST( !fd_blockstore_sig_idx_slot_remove( idx, 114UL ) );
+  FD_TEST( fd_blockstore_sig_idx_slot_remove( idx, 118UL )==TEST_TXN_CNT * 3UL );
+  FD_TEST( idx->slot_hi==114UL );
+  fd_blockstore_end_write( blockstore );
+  FD_TEST( fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 64UL )==21UL - TEST_TXN_CNT );
+  test_res( res, 21UL - TEST_TXN_CNT, 114UL );
+  FD_TEST( fd_blockstore_sig_idx_addr_map_key_cnt( addr_map )==2UL + 21UL - TEST_TXN_CNT );
+  FD_TEST( !fd_blockstore_sig_idx_addr_map_verify( addr_map ) );
+
+  fd_blockstore_start_write( blockstore );
+  fd_blockstore_sig_idx_attach( blockstore, NULL );
+  fd_blockstore_end_write( blockstore );
+  FD_TEST( !fd_blockstore_sig_idx_query_volatile( blockstore, &common, NULL, NULL, res, 64UL ) );
+
+  fd_wksp_free_laddr( fd_blockstore_sig_idx_delete( fd_blockstore_sig_idx_leave( idx ) ) );
+  fd_wksp_free_laddr( fd_blockstore_delete( fd_blockstore_leave( blockstore ) ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -0,0 +1,348 @@
+#include "fd_hashes.h"
+#include "fd_acc_mgr.h"
+#include "fd_account.h"
+#include "context/fd_exec_slot_ctx.h"
+#include "context/fd_exec_epoch_ctx.h"
+#include "../../ballet/blake3/fd_blake3.h"
+#include "../../ballet/lthash/fd_lthash.h"
+#include "../../ballet/sha256/fd_sha256.h"
+
+/* ref_hash_account_deltas is the serial streaming implementation of
+   the account delta hash that fd_hash_account_deltas replaced (the
+   pairs must already be sorted), except that a single pair is hashed
+   into its lone leaf like Agave does (the streaming implementation
+   left hash untouched). */
+
+static void
+ref_hash_account_deltas( fd_pubkey_hash_pair_t const * pairs,
+                         ulong                         pairs_len,
+                         fd_hash_t *                   hash ) {
+  fd_sha256_t shas[ 16 ];
+  ulong       num_hashes[ 17 ] = {0};
+  for( ulong j=0UL; j<16UL; j++ ) fd_sha256_init( &shas[j] );
+
+  if( !pairs_len ) {
+    fd_sha256_fini( &shas[0], hash->hash );
+    return;
+  }
+
+  for( ulong i=0UL; i<pairs_len; i++ ) {
+    fd_sha256_append( &shas[0], pairs[i].hash->hash, sizeof(fd_hash_t) );
+    num_hashes[0]++;
+    for( ulong j=0UL; j<16UL; j++ ) {
+      if( num_hashes[j]!=16UL ) break;
+      num_hashes[j] = 0UL;
+      num_hashes[j+1UL]++;
+      fd_sha256_fini( &shas[j], hash->hash );
+      fd_sha256_init( &shas[j] );
+      fd_sha256_append( &shas[j+1UL], hash->hash, sizeof(fd_hash_t) );
+    }
+  }
+
+  if( pairs_len==1UL ) {
+    fd_sha256_fini( &shas[0], hash->hash );
+    return;
+  }
+
+  ulong tot = 0UL;
+  for( ulong k=0UL; k<16UL; k++ ) tot += num_hashes[k];
+  if( tot==1UL ) return;
+
+  ulong height = 0UL;
+  for( ulong i=16UL; i; i-- ) if( num_hashes[i-1UL] ) { height = i; break; }
+
+  for( ulong i=0UL; i<height; i++ ) {
+    if( !num_hashes[i] ) continue;
+    fd_sha256_fini( &shas[i], hash->hash );
+    num_hashes[i] = 0UL;
+    num_hashes[i+1UL]++;
+    if( i==height-1UL ) return;
+    fd_sha256_append( &shas[i+1UL], hash->hash, sizeof(fd_hash_t) );
+    for( ulong j=i+1UL; j<height; j++ ) {
+      if( num_hashes[j]!=16UL ) continue;
+      num_hashes[j] = 0UL;
+      num_hashes[j+1UL]++;
+      fd_hash_t sub_hash;
+      fd_sha256_fini( &shas[j], sub_hash.hash );
+      if( j==height-1UL ) { *hash = sub_hash; return; }
+      fd_sha256_append( &shas[j+1UL], sub_hash.hash, sizeof(fd_hash_t) );
+    }
+  }
+}
+
+static int
+pair_lt( fd_pubkey_hash_pair_t const * a,
+         fd_pubkey_hash_pair_t const * b ) {
+  return memcmp( a->pubkey->uc, b->pubkey->uc, sizeof(fd_pubkey_t) )<0;
+}
+
+#define PAIR_MAX (300000UL)
+
+static fd_pubkey_t           pubkeys[ PAIR_MAX ];
+static fd_hash_t             hashes [ PAIR_MAX ];
+static fd_pubkey_hash_pair_t pairs  [ PAIR_MAX ];
+static fd_pubkey_hash_pair_t pairs2 [ PAIR_MAX ];
+static fd_exec_slot_ctx_t    slot_ctx[1];
+
+static uchar tpool_mem[ FD_TPOOL_FOOTPRINT(FD_TILE_MAX) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+
+/* Full state scans ***************************************************/
+
+#define TEST_ACC_CNT (20000UL)
+#define TEST_REC_MAX (65536UL)
+#define TEST_SLOT    (1234UL)
+
+static fd_pubkey_t
+test_pubkey( ulong i ) {
+  fd_pubkey_t key; memset( &key, 0, sizeof(fd_pubkey_t) );
+  key.ul[0] = fd_ulong_hash( i );
+  key.ul[1] = i+1UL;
+  return key;
+}
+
+/* test_account_set writes account i into txn.  Every 8th account gets a
+   zero hash (to be computed by the accounts hash), every 16th is an
+   executable with a bad flag (excluded from the accounts hash). */
+
+static void
+test_account_set( fd_exec_slot_ctx_t * slot_ctx,
+                  fd_funk_txn_t *      txn,
+                  ulong                i,
+                  ulong                lamports,
+                  fd_rng_t *           rng ) {
+  fd_pubkey_t key  = test_pubkey( i );
+  ulong       dlen = fd_rng_ulong_roll( rng, 200UL );
+  FD_BORROWED_ACCOUNT_DECL( acc );
+  FD_TEST( fd_acc_mgr_modify( slot_ctx->acc_mgr, txn, &key, 1, dlen, acc )==FD_ACC_MGR_SUCCESS );
+  acc->meta->dlen            = dlen;
+  acc->meta->info.lamports   = lamports;
+  acc->meta->info.executable = (uchar)( (i%16UL)==3UL ? 2 : (i%5UL)==0UL );
+  acc->meta->slot            = TEST_SLOT;
+  memset( acc->meta->info.owner, (int)i, 32UL );
+  for( ulong j=0UL; j<dlen; j++ ) acc->data[ j ] = fd_rng_uchar( rng );
+  if( (i%8UL)==1UL ) memset( acc->meta->hash, 0, 32UL );
+  else fd_hash_account_current( acc->meta->hash, acc->meta, key.uc, acc->data, slot_ctx );
+}
+
+/* ref_accounts_hash is the serial walk over the records of txn that
+   fd_accounts_hash used to do. */
+
+static void
+ref_accounts_hash( fd_exec_slot_ctx_t * slot_ctx,
+                   fd_funk_txn_t *      txn,
+                   int                  with_dead,
+                   fd_hash_t *          hash ) {
+  fd_funk_t * funk = slot_ctx->acc_mgr->funk;
+  fd_wksp_t * wksp = fd_funk_wksp( funk );
+  ulong       pair_cnt = 0UL;
+  ulong       dead_cnt = 0UL;
+  static fd_hash_t dead[ TEST_REC_MAX ];
+  for( fd_funk_rec_t const * rec = fd_funk_txn_first_rec( funk, txn ); rec; rec = fd_funk_txn_next_rec( funk, rec ) ) {
+    if( !fd_funk_key_is_acc( rec->pair.key ) ) continue;
+    if( rec->flags & FD_FUNK_REC_FLAG_ERASE  ) continue;
+    fd_account_meta_t * meta = (fd_account_meta_t *)fd_funk_val_const( rec, wksp );
+    fd_pubkey_t const * pubkey = (fd_pubkey_t const *)rec->pair.key->uc;
+    if( !meta->info.lamports ) {
+      if( !with_dead ) continue;
+      fd_blake3_t b3[1];
+      fd_blake3_init( b3 ); fd_blake3_append( b3, pubkey->uc, 32UL ); fd_blake3_fini( b3, dead + dead_cnt );
+      pairs[ pair_cnt++ ] = (fd_pubkey_hash_pair_t){ .pubkey = pubkey, .hash = dead + dead_cnt++ };
+      continue;
+    }
+    fd_hash_t * h = (fd_hash_t *)meta->hash;
+    if( !(h->ul[0] | h->ul[1] | h->ul[2] | h->ul[3]) )
+      fd_hash_account_current( h->hash, meta, pubkey->uc, fd_account_get_data( meta ), slot_ctx );
+    if( (meta->info.executable & ~1)!=0 ) continue;
+    pairs[ pair_cnt++ ] = (fd_pubkey_hash_pair_t){ .pubkey = pubkey, .hash = h };
+  }
+  fd_hash_account_deltas( pairs, pair_cnt, hash, slot_ctx );
+}
+
+#ifdef _ENABLE_LTHASH
+/* ref_lthash sums the lthashes of the live accounts visible from txn. */
+
+static void
+ref_lthash( fd_exec_slot_ctx_t * slot_ctx,
+            fd_funk_txn_t *      txn,
+            fd_lthash_value_t *  acc ) {
+  fd_funk_t *           funk    = slot_ctx->acc_mgr->funk;
+  fd_wksp_t *           wksp    = fd_funk_wksp( funk );
+  fd_funk_rec_t const * rec_map = fd_funk_rec_map( funk, wksp );
+  fd_lthash_zero( acc );
+  for( fd_funk_rec_map_iter_t iter = fd_funk_rec_map_iter_init( rec_map );
+       !fd_funk_rec_map_iter_done( rec_map, iter );
+       iter = fd_funk_rec_map_iter_next( rec_map, iter ) ) {
+    fd_funk_rec_t const * rec = fd_funk_rec_map_iter_ele_const( rec_map, iter );
+    if( !fd_funk_key_is_acc( rec->pair.key ) ) continue;
+    if( fd_funk_rec_query_global( funk, txn, rec->pair.key )!=rec ) continue;
+    if( rec->flags & FD_FUNK_REC_FLAG_ERASE ) continue;
+    fd_account_meta_t const * meta = fd_funk_val_const( rec, wksp );
+    fd_lthash_t       lthash[1];
+    fd_lthash_value_t val[1];
+    fd_lthash_init( lthash ); fd_lthash_append( lthash, meta->hash, 32UL ); fd_lthash_fini( lthash, val );
+    fd_lthash_add( acc, val );
+  }
+}
+#endif
+
+static void
+test_accounts_scan( fd_wksp_t *  wksp,
+                    fd_rng_t *   rng,
+                    fd_tpool_t * tpool,
+                    ulong        tpool_cnt ) {
+  fd_alloc_t * alloc = fd_alloc_join( fd_alloc_new( fd_wksp_alloc_laddr( wksp, fd_alloc_align(), fd_alloc_footprint(), 41UL ), 41UL ), 0UL );
+  FD_TEST( alloc );
+  fd_valloc_t valloc = fd_alloc_virtual( alloc );
+
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), 42UL ), 42UL, 1UL, 16UL, TEST_REC_MAX ) );
+  FD_TEST( funk );
+  fd_acc_mgr_t * acc_mgr = fd_acc_mgr_new( fd_wksp_alloc_laddr( wksp, FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT, 1UL ), funk );
+  FD_TEST( acc_mgr );
+
+  ulong vote_acc_max = 16UL;
+  void * epoch_ctx_mem = fd_wksp_alloc_laddr( wksp, fd_exec_epoch_ctx_align(), fd_exec_epoch_ctx_footprint( vote_acc_max ), 1UL );
+  void * slot_ctx_mem  = fd_wksp_alloc_laddr( wksp, FD_EXEC_SLOT_CTX_ALIGN, FD_EXEC_SLOT_CTX_FOOTPRINT, 1UL );
+  fd_exec_epoch_ctx_t * epoch_ctx = fd_exec_epoch_ctx_join( fd_exec_epoch_ctx_new( epoch_ctx_mem, vote_acc_max ) );
+  fd_exec_slot_ctx_t *  ctx       = fd_exec_slot_ctx_join ( fd_exec_slot_ctx_new ( slot_ctx_mem, valloc ) );
+  FD_TEST( epoch_ctx && ctx );
+  ctx->epoch_ctx      = epoch_ctx;
+  ctx->acc_mgr        = acc_mgr;
+  ctx->slot_bank.slot = TEST_SLOT;
+
+  /* Accounts in the root (every 10th is dead), some modified, deleted
+     or erased in a child txn */
+
+  fd_funk_start_write( funk );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) test_account_set( ctx, NULL, i, (i%10UL)==4UL ? 0UL : 1000UL+i, rng );
+  fd_funk_txn_xid_t xid[1] = {{ .ul = { TEST_SLOT } }};
+  fd_funk_txn_t * txn = fd_funk_txn_prepare( funk, NULL, xid, 1 );
+  FD_TEST( txn );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i+=3UL ) {
+    test_account_set( ctx, txn, i, (i%9UL)==0UL ? 0UL : 2000UL+i, rng );
+    if( (i%11UL)==0UL ) {
+      fd_pubkey_t key = test_pubkey( i );
+      fd_funk_rec_key_t rec_key = fd_acc_funk_key( &key );
+      fd_funk_rec_t * rec = fd_funk_rec_modify( funk, fd_funk_rec_query( funk, txn, &rec_key ) );
+      FD_TEST( rec );
+      FD_TEST( !fd_funk_rec_remove( funk, rec, 1 ) );
+    }
+  }
+  fd_funk_end_write( funk );
+
+  /* Accounts hashes of the root and of the child txn */
+
+  for( int with_dead=0; with_dead<2; with_dead++ ) {
+    fd_funk_txn_t * txns[2] = { NULL, txn };
+    for( ulong t=0UL; t<2UL; t++ ) {
+      fd_hash_t hash0, hash1, hash2;
+      long dt = -fd_log_wallclock();
+      FD_TEST( !fd_accounts_hash_tpool( ctx, &hash1, txns[t], (ulong)with_dead, with_dead, tpool, tpool_cnt ) );
+      dt += fd_log_wallclock();
+      FD_TEST( !fd_accounts_hash( ctx, &hash2, txns[t], 0UL, with_dead ) );
+      ref_accounts_hash( ctx, txns[t], with_dead, &hash0 );
+      FD_TEST( !memcmp( &hash0, &hash1, sizeof(fd_hash_t) ) );
+      FD_TEST( !memcmp( &hash0, &hash2, sizeof(fd_hash_t) ) );
+      FD_LOG_NOTICE(( "accounts hash (txn %lu, with_dead %d): tpool (%lu workers) %li ns", t, with_dead, tpool_cnt, dt ));
+    }
+  }
+
+#ifdef _ENABLE_LTHASH
+  /* Lthash of the root and of the accounts visible from the child */
+
+  fd_lthash_value_t ref[1];
+  ref_lthash( ctx, NULL, ref );
+  FD_TEST( !fd_accounts_init_lthash_tpool( ctx, tpool, tpool_cnt ) );
+  FD_TEST( !memcmp( ctx->slot_bank.lthash, ref, sizeof(fd_lthash_value_t) ) );
+  fd_memset( ctx->slot_bank.lthash, 0, sizeof(fd_lthash_value_t) );
+  FD_TEST( !fd_accounts_init_lthash_tpool( ctx, NULL, 1UL ) );
+  FD_TEST( !memcmp( ctx->slot_bank.lthash, ref, sizeof(fd_lthash_value_t) ) );
+  fd_accounts_check_lthash_tpool( ctx, tpool, tpool_cnt );
+
+  ctx->funk_txn = txn;
+  ref_lthash( ctx, txn, ref );
+  fd_memcpy( ctx->slot_bank.lthash, ref, sizeof(fd_lthash_value_t) );
+  fd_accounts_check_lthash_tpool( ctx, tpool, tpool_cnt );
+  fd_accounts_check_lthash_tpool( ctx, NULL, 1UL );
+#endif
+
+  fd_wksp_free_laddr( fd_exec_slot_ctx_delete ( fd_exec_slot_ctx_leave ( ctx       ) ) );
+  fd_wksp_free_laddr( fd_exec_epoch_ctx_delete( fd_exec_epoch_ctx_leave( epoch_ctx ) ) );
+  fd_wksp_free_laddr( acc_mgr );
+  fd_wksp_free_laddr( fd_funk_delete( fd_funk_leave( funk ) ) );
+  fd_wksp_free_laddr( fd_alloc_delete( fd_alloc_leave( alloc ) ) );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "normal"        );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 16384UL         );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  ulong        tpool_cnt = fd_tile_cnt();
+  fd_tpool_t * tpool     = fd_tpool_init( tpool_mem, tpool_cnt ); FD_TEST( tpool );
+  for( ulong i=1UL; i<tpool_cnt; i++ ) FD_TEST( fd_tpool_worker_push( tpool, i, NULL, 0UL ) );
+
+  slot_ctx->valloc = fd_libc_alloc_virtual();
+
+  for( ulong i=0UL; i<PAIR_MAX; i++ ) {
+    for( ulong j=0UL; j<4UL; j++ ) pubkeys[i].ul[j] = fd_rng_ulong( rng );
+    for( ulong j=0UL; j<4UL; j++ ) hashes [i].ul[j] = fd_rng_ulong( rng );
+    if( !fd_rng_uint_roll( rng, 8U ) ) pubkeys[i].uc[0] = 0x06; /* Uneven buckets (e.g. sysvars) */
+  }
+
+  static ulong const cnts[] = { 0UL, 1UL, 2UL, 15UL, 16UL, 17UL, 255UL, 256UL, 257UL, 4095UL, 4096UL, 4097UL,
+                                65537UL, 100000UL, PAIR_MAX };
+
+  for( ulong c=0UL; c<sizeof(cnts)/sizeof(cnts[0]); c++ ) {
+    ulong cnt = cnts[c];
+
+    for( ulong i=0UL; i<cnt; i++ ) pairs[i] = (fd_pubkey_hash_pair_t){ .pubkey = pubkeys + i, .hash = hashes + i };
+    memcpy( pairs2, pairs, cnt*sizeof(fd_pubkey_hash_pair_t) );
+
+    fd_hash_t hash0; memset( &hash0, 0, sizeof(fd_hash_t) );
+    fd_hash_t hash1 = hash0;
+    fd_hash_t hash2 = hash0;
+
+    long dt1 = -fd_log_wallclock();
+    fd_hash_account_deltas( pairs, cnt, &hash1, slot_ctx );
+    dt1 += fd_log_wallclock();
+
+    long dt2 = -fd_log_wallclock();
+    fd_hash_account_deltas_tpool( pairs2, cnt, &hash2, slot_ctx, tpool, tpool_cnt );
+    dt2 += fd_log_wallclock();
+
+    for( ulong i=1UL; i<cnt; i++ ) FD_TEST( pair_lt( pairs+i-1UL, pairs+i ) );
+    FD_TEST( !memcmp( pairs, pairs2, cnt*sizeof(fd_pubkey_hash_pair_t) ) );
+
+    ref_hash_account_deltas( pairs, cnt, &hash0 );
+    if( cnt==1UL ) {
+      fd_hash_t leaf[1];
+      fd_sha256_hash( pairs[0].hash->hash, sizeof(fd_hash_t), leaf->hash );
+      FD_TEST( !memcmp( &hash0, leaf, sizeof(fd_hash_t) ) );
+    }
+    FD_TEST( !memcmp( &hash0, &hash1, sizeof(fd_hash_t) ) );
+    FD_TEST( !memcmp( &hash0, &hash2, sizeof(fd_hash_t) ) );
+
+    FD_LOG_NOTICE(( "%6lu pairs: serial %9li ns, tpool (%lu workers) %9li ns", cnt, dt1, tpool_cnt, dt2 ));
+  }
+
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "test_hashes", 0UL );
+  FD_TEST( wksp );
+  test_accounts_scan( wksp, rng, tpool, tpool_cnt );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_TEST( fd_tpool_fini( tpool )==(void *)tpool_mem );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -0,0 +1,55 @@
+#!/bin/bash -f
+
+# Replays a ledger with the wave and the dag txn schedulers, fails if
+# any slot's bank hash differs between the two and reports the replay
+# throughput of each.  Takes the same options as run_ledger_test.sh
+# (except --scheduler), e.g.
+#
+#   run_ledger_scheduler_bench.sh -l v201-small -p 30 -y 16 -m 500000 -e 120 --tile-cpus 5-21
+
+echo_notice() {
+  echo -e "\033[34m$1\033[0m"
+}
+
+echo_error() {
+  echo -e "\033[31m$1$2\033[0m"
+}
+
+TESTS_DIR=$(dirname "${BASH_SOURCE[0]}")
+OUT="/tmp/ledger_scheduler_bench$$"
+mkdir -p $OUT
+
+for SCHEDULER in wave dag; do
+  "$TESTS_DIR"/run_ledger_test.sh "$@" --scheduler $SCHEDULER > $OUT/$SCHEDULER.out
+  status=$?
+  cat $OUT/$SCHEDULER.out
+  if [ $status -ne 0 ]; then
+    echo_error "ledger replay failed with scheduler $SCHEDULER: $*"
+    exit $status
+  fi
+
+  fd_log_file=$(sed -n 's/.*Log at "\(.*\)".*/\1/p' $OUT/$SCHEDULER.out | head -1)
+  if [ ! -f "$fd_log_file" ]; then
+    echo_error "no log file for scheduler $SCHEDULER"
+    exit 1
+  fi
+
+  sed -n 's/.*evaluated block successfully - slot: \([0-9]*\),.*bank_hash: \([^,]*\),.*/\1 \2/p' "$fd_log_file" > $OUT/$SCHEDULER.hashes
+  grep -o "replay completed.*" "$fd_log_file" > $OUT/$SCHEDULER.perf
+done
+
+if [ ! -s $OUT/wave.hashes ]; then
+  echo_error "no bank hashes recorded: $*"
+  exit 1
+fi
+
+if ! diff $OUT/wave.hashes $OUT/dag.hashes; then
+  echo_error "bank hash mismatch between the wave and dag schedulers: $*"
+  echo $OUT
+  exit 1
+fi
+
+echo_notice "bank hashes match over $(wc -l < $OUT/wave.hashes) slots"
+cat $OUT/wave.perf $OUT/dag.perf
+
+rm -r $OUT
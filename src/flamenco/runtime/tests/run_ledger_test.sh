@@ -22,6 +22,7 @@ TRASH_HASH=""
 LOG="/tmp/ledger_log$$"
 TILE_CPUS="--tile-cpus 5-21"
 CLUSTER_VERSION="--cluster-version 2000"
+SCHEDULER="--scheduler wave"
 DUMP_DIR=${DUMP_DIR:="./dump"}
 
 while [[ $# -gt 0 ]]; do
@@ -85,6 +86,11 @@ while [[ $# -gt 0 ]]; do
         shift
         shift
         ;;
+    --scheduler)
+        SCHEDULER="--scheduler $2"
+        shift
+        shift
+        ;;
     -*|--*)
        echo "unknown option $1"
        exit 1
@@ -152,6 +158,7 @@ set -x
     $FUNK_PAGES \
     $SNAPSHOT \
     --allocator wksp \
+    $SCHEDULER \
     $TILE_CPUS >& $LOG
 
 status=$?
@@ -1,5 +1,6 @@
 #include "fd_snapshot.h"
 #include "fd_snapshot_loader.h"
+#include "fd_snapshot_par.h"
 #include "fd_snapshot_restore.h"
 #include "../runtime/fd_acc_mgr.h"
 #include "../runtime/fd_hashes.h"
@@ -57,19 +58,89 @@ restore_status_cache( void *                 ctx,
   return (!!fd_exec_slot_ctx_recover_status_cache( ctx, slot_deltas ) ? 0 : EINVAL);
 }
 
+/* FIXME don't hardcode these params */
+static ulong const zstd_window_sz = 33554432UL;
+static ulong const par_out_sz     = 1UL<<26;
+static ulong const par_frame_max  = 65536UL;
+static ulong const par_accv_max   = 65536UL;
+
+/* load_one_snapshot_par loads the snapshot at the local file system
+   path with the multi-threaded loader.  Returns 1 on success.  Returns
+   0 if the snapshot should be loaded with the serial loader instead,
+   in which case nothing was restored yet.  Terminates the process on
+   any other failure, like load_one_snapshot. */
+
+static int
+load_one_snapshot_par( fd_exec_slot_ctx_t * slot_ctx,
+                       char const *         path,
+                       fd_tpool_t *         tpool,
+                       ulong                worker_cnt ) {
+
+  fd_valloc_t     valloc   = slot_ctx->valloc;
+  fd_acc_mgr_t *  acc_mgr  = slot_ctx->acc_mgr;
+  fd_funk_txn_t * funk_txn = slot_ctx->funk_txn;
+
+  ulong  par_footprint = fd_snapshot_par_footprint( worker_cnt, zstd_window_sz, par_out_sz, par_frame_max, par_accv_max );
+  void * restore_mem   = fd_valloc_malloc( valloc, fd_snapshot_restore_align(), fd_snapshot_restore_footprint() );
+  void * par_mem       = par_footprint ? fd_valloc_malloc( valloc, fd_snapshot_par_align(), par_footprint ) : NULL;
+
+  fd_snapshot_restore_t * restore = restore_mem ? fd_snapshot_restore_new( restore_mem, acc_mgr, funk_txn, valloc, slot_ctx, restore_manifest, restore_status_cache ) : NULL;
+  fd_snapshot_par_t *     par     = par_mem     ? fd_snapshot_par_new( par_mem, tpool, worker_cnt, zstd_window_sz, par_out_sz, par_frame_max, par_accv_max ) : NULL;
+
+  if( FD_UNLIKELY( !restore || !par ) ) {
+    FD_LOG_WARNING(( "Failed to create parallel snapshot loader with %lu workers (%lu bytes)", worker_cnt, par_footprint ));
+    if( par     ) fd_snapshot_par_delete( par );
+    if( restore ) fd_snapshot_restore_delete( restore );
+    fd_valloc_free( valloc, par_mem     );
+    fd_valloc_free( valloc, restore_mem );
+    return 0;
+  }
+
+  fd_snapshot_par_stats_t stats[1];
+  int err = fd_snapshot_par_load( par, restore, path, stats );
+
+  fd_valloc_free( valloc, fd_snapshot_par_delete    ( par     ) );
+  fd_valloc_free( valloc, fd_snapshot_restore_delete( restore ) );
+
+  if( FD_UNLIKELY( err ) ) {
+    if( (err==EFBIG) & (!stats->manifest_ns) ) {
+      FD_LOG_NOTICE(( "Snapshot %s does not decompress in parallel, using serial loader", path ));
+      return 0;
+    }
+    FD_LOG_ERR(( "Failed to load snapshot (%d-%s)", err, fd_io_strerror( err ) ));
+  }
+
+  FD_LOG_NOTICE(( "Loaded %lu accounts (%lu superseded) from %lu zstd frames with %lu workers in %.3f s",
+                  stats->acc_cnt, stats->acc_skip_cnt, stats->frame_cnt, worker_cnt, (double)stats->load_ns*1e-9 ));
+  return 1;
+}
+
 static void
 load_one_snapshot( fd_exec_slot_ctx_t * slot_ctx,
                    char *               source_cstr,
-                   fd_snapshot_name_t * name_out ) {
-
-  /* FIXME don't hardcode this param */
-  static ulong const zstd_window_sz = 33554432UL;
+                   fd_snapshot_name_t * name_out,
+                   fd_tpool_t *         tpool,
+                   ulong                max_workers ) {
 
   fd_snapshot_src_t src[1];
   if( FD_UNLIKELY( !fd_snapshot_src_parse( src, source_cstr ) ) ) {
     FD_LOG_ERR(( "Failed to load snapshot" ));
   }
 
+  /* Local snapshot files are loaded with the thread pool if possible.
+     Rent partitions are not maintained by the parallel loader. */
+
+  if( tpool && max_workers>1UL &&
+      src->type==FD_SNAPSHOT_SRC_FILE &&
+      !slot_ctx->acc_mgr->slots_per_epoch &&
+      fd_snapshot_name_from_cstr( name_out, src->file.path, slot_ctx->slot_bank.slot ) ) {
+    ulong worker_cnt = fd_ulong_min( max_workers, fd_tpool_worker_cnt( tpool ) );
+    if( load_one_snapshot_par( slot_ctx, src->file.path, tpool, worker_cnt ) ) {
+      FD_LOG_NOTICE(( "Finished reading snapshot %s", source_cstr ));
+      return;
+    }
+  }
+
   fd_valloc_t     valloc   = slot_ctx->valloc;
   fd_acc_mgr_t *  acc_mgr  = slot_ctx->acc_mgr;
   fd_funk_txn_t * funk_txn = slot_ctx->funk_txn;
@@ -115,6 +186,17 @@ fd_snapshot_load( const char *         snapshotfile,
                   uint                 verify_hash,
                   uint                 check_hash,
                   int                  snapshot_type ) {
+  fd_snapshot_load_tpool( snapshotfile, slot_ctx, verify_hash, check_hash, snapshot_type, NULL, 1UL );
+}
+
+void
+fd_snapshot_load_tpool( const char *         snapshotfile,
+                        fd_exec_slot_ctx_t * slot_ctx,
+                        uint                 verify_hash,
+                        uint                 check_hash,
+                        int                  snapshot_type,
+                        fd_tpool_t *         tpool,
+                        ulong                max_workers ) {
 
   switch (snapshot_type) {
   case FD_SNAPSHOT_TYPE_UNSPECIFIED:
@@ -144,7 +226,7 @@ fd_snapshot_load( const char *         snapshotfile,
   char * snapshot_cstr = fd_scratch_alloc( 1UL, slen + 1 );
   fd_cstr_fini( fd_cstr_append_text( fd_cstr_init( snapshot_cstr ), snapshotfile, slen ) );
   fd_snapshot_name_t name = {0};
-  load_one_snapshot( slot_ctx, snapshot_cstr, &name );
+  load_one_snapshot( slot_ctx, snapshot_cstr, &name, tpool, max_workers );
   fd_hash_t const * fhash = &name.fhash;
   fd_scratch_pop();
 
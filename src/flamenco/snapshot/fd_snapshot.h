@@ -6,6 +6,7 @@
 /* fd_snapshot.h provides high-level blocking APIs for Solana snapshots. */
 
 #include "fd_snapshot_base.h"
+#include "../../util/tpool/fd_tpool.h"
 
 FD_PROTOTYPES_BEGIN
 
@@ -33,6 +34,23 @@ fd_snapshot_load( const char *         source_cstr,
                   uint                 check_hash,
                   int                  snapshot_type );
 
+/* fd_snapshot_load_tpool is fd_snapshot_load with a thread pool.  If
+   max_workers>1, a snapshot in the local file system is loaded with
+   the multi-threaded loader (see fd_snapshot_par.h) using workers
+   [0,max_workers) of tpool, where worker 0 is the caller.  Falls back
+   to the serial loader for HTTP sources, for snapshots consisting of
+   frames that are too large to decompress in parallel, and if the
+   multi-threaded loader cannot be allocated from slot_ctx->valloc. */
+
+void
+fd_snapshot_load_tpool( const char *         source_cstr,
+                        fd_exec_slot_ctx_t * slot_ctx,
+                        uint                 verify_hash,
+                        uint                 check_hash,
+                        int                  snapshot_type,
+                        fd_tpool_t *         tpool,
+                        ulong                max_workers );
+
 FD_PROTOTYPES_END
 
 #endif /* FD_HAS_ZSTD */
@@ -0,0 +1,978 @@
+#include "fd_snapshot_create.h"
+#include "fd_snapshot_base.h"
+#include "../runtime/fd_acc_mgr.h"
+#include "../runtime/fd_hashes.h"
+#include "../runtime/context/fd_exec_epoch_ctx.h"
+#include "../runtime/sysvar/fd_sysvar_epoch_schedule.h"
+#include "../../ballet/base58/fd_base58.h"
+#include "../../ballet/zstd/fd_zstd.h"
+#include "../../util/archive/fd_tar.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define FD_SNAPSHOT_CREATE_MAGIC (0x5ea7c2ea7e5ea7c0UL) /* random */
+
+/* FD_SNAPSHOT_CREATE_CHUNK_SZ is the number of funk rec map slots a
+   worker claims at a time.  Small enough to balance load across
+   workers (records are not uniformly spread over the map), large
+   enough to make claim overhead negligible. */
+
+#define FD_SNAPSHOT_CREATE_CHUNK_SZ (4096UL)
+
+#define FD_SNAPSHOT_CREATE_PATH_MAX (4096UL)
+
+/* FD_SNAPSHOT_VERSION is the snapshot format version string written
+   to the "version" file. */
+
+#define FD_SNAPSHOT_VERSION "1.2.0"
+
+/* fd_snapshot_create_worker_t holds the state of one snapshot worker.
+   Each worker compresses into its own temporary file. */
+
+struct fd_snapshot_create_worker {
+  int                     fd;
+  int                     err;
+  char                    path[ FD_SNAPSHOT_CREATE_PATH_MAX ];
+
+  fd_zstd_cstream_t *     cstream;
+  uchar *                 buf;      /* compressed output buffer */
+  uchar *                 buf_cur;  /* next free byte in buf */
+
+  fd_funk_rec_t const **  batch;     /* accounts of the pending account vec */
+  ulong                   batch_cnt;
+  ulong                   batch_sz;  /* account vec size in bytes */
+
+  /* Bank hash stats */
+  ulong                   acc_cnt;
+  ulong                   lamports;
+  ulong                   data_len;
+  ulong                   exec_cnt;
+};
+
+typedef struct fd_snapshot_create_worker fd_snapshot_create_worker_t;
+
+struct __attribute__((aligned(FD_SNAPSHOT_CREATE_ALIGN))) fd_snapshot_create_private {
+  ulong                         magic;
+
+  fd_exec_slot_ctx_t *          slot_ctx;
+  fd_tpool_t *                  tpool;
+  ulong                         worker_cnt;
+  int                           compress_lvl;
+  ulong                         compress_bufsz;
+  ulong                         funk_rec_cnt;
+  ulong                         batch_acc_cnt;
+  ulong                         max_accv_sz;
+  ulong                         mtime;
+
+  ulong                         rec_next;  /* next funk rec map slot to claim, atomic */
+  ulong                         accv_cnt;  /* number of account vecs created, atomic */
+  fd_snapshot_acc_vec_t *       accv;      /* indexed [0,funk_rec_cnt) */
+
+  fd_snapshot_create_worker_t * worker;    /* indexed [0,worker_cnt) */
+
+  fd_hash_t                     accounts_hash;
+
+  char                          dir     [ FD_SNAPSHOT_CREATE_PATH_MAX ];
+  char                          path    [ FD_SNAPSHOT_CREATE_PATH_MAX ];  /* empty until a snapshot was written */
+  char                          tmp_path[ FD_SNAPSHOT_CREATE_PATH_MAX ];
+};
+
+static uchar const fd_snapshot_create_zeros[ 512 ] = {0};
+
+ulong
+fd_snapshot_create_align( void ) {
+  return FD_SNAPSHOT_CREATE_ALIGN;
+}
+
+ulong
+fd_snapshot_create_footprint( ulong worker_cnt,
+                              int   compress_lvl,
+                              ulong compress_bufsz,
+                              ulong funk_rec_cnt,
+                              ulong batch_acc_cnt ) {
+
+  if( FD_UNLIKELY( (!worker_cnt) | (worker_cnt>FD_TILE_MAX) |
+                   (!compress_bufsz) | (!funk_rec_cnt) | (!batch_acc_cnt) ) )
+    return 0UL;
+
+  ulong l = FD_LAYOUT_INIT;
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_create_t),        sizeof(fd_snapshot_create_t)                   );
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_create_worker_t), worker_cnt  *sizeof(fd_snapshot_create_worker_t) );
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_acc_vec_t),       funk_rec_cnt*sizeof(fd_snapshot_acc_vec_t)       );
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    l = FD_LAYOUT_APPEND( l, fd_zstd_cstream_align(),        fd_zstd_cstream_footprint( compress_lvl ) );
+    l = FD_LAYOUT_APPEND( l, 64UL,                           compress_bufsz                            );
+    l = FD_LAYOUT_APPEND( l, alignof(fd_funk_rec_t const *), batch_acc_cnt*sizeof(fd_funk_rec_t const *) );
+  }
+  return FD_LAYOUT_FINI( l, fd_snapshot_create_align() );
+}
+
+fd_snapshot_create_t *
+fd_snapshot_create_new( void *               mem,
+                        fd_exec_slot_ctx_t * slot_ctx,
+                        const char *         snap_dir,
+                        ulong                worker_cnt,
+                        int                  compress_lvl,
+                        ulong                compress_bufsz,
+                        ulong                funk_rec_cnt,
+                        ulong                batch_acc_cnt,
+                        ulong                max_accv_sz,
+                        fd_tpool_t *         tpool,
+                        fd_rng_t *           rng ) {
+
+  if( FD_UNLIKELY( !mem ) ) {
+    FD_LOG_WARNING(( "NULL mem" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)mem, fd_snapshot_create_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned mem" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( (!slot_ctx) | (!snap_dir) | (!rng) ) ) {
+    FD_LOG_WARNING(( "NULL slot_ctx, snap_dir or rng" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( !fd_snapshot_create_footprint( worker_cnt, compress_lvl, compress_bufsz, funk_rec_cnt, batch_acc_cnt ) ) ) {
+    FD_LOG_WARNING(( "invalid params (worker_cnt=%lu compress_bufsz=%lu funk_rec_cnt=%lu batch_acc_cnt=%lu)",
+                     worker_cnt, compress_bufsz, funk_rec_cnt, batch_acc_cnt ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( (worker_cnt>1UL) && ( !tpool || fd_tpool_worker_cnt( tpool )<worker_cnt ) ) ) {
+    FD_LOG_WARNING(( "worker_cnt %lu exceeds tpool worker cnt", worker_cnt ));
+    return NULL;
+  }
+  fd_funk_t * funk = slot_ctx->acc_mgr->funk;
+  if( FD_UNLIKELY( funk->rec_max > funk_rec_cnt ) ) {
+    FD_LOG_WARNING(( "funk_rec_cnt %lu smaller than funk rec_max %lu", funk_rec_cnt, funk->rec_max ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( strlen( snap_dir )+128UL > FD_SNAPSHOT_CREATE_PATH_MAX ) ) {
+    FD_LOG_WARNING(( "snap_dir too long" ));
+    return NULL;
+  }
+
+  FD_SCRATCH_ALLOC_INIT( l, mem );
+  fd_snapshot_create_t *        create = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_create_t),        sizeof(fd_snapshot_create_t)                     );
+  fd_snapshot_create_worker_t * worker = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_create_worker_t), worker_cnt  *sizeof(fd_snapshot_create_worker_t) );
+  fd_snapshot_acc_vec_t *       accv   = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_acc_vec_t),       funk_rec_cnt*sizeof(fd_snapshot_acc_vec_t)       );
+
+  memset( create, 0, sizeof(fd_snapshot_create_t) );
+  create->slot_ctx       = slot_ctx;
+  create->tpool          = tpool;
+  create->worker_cnt     = worker_cnt;
+  create->compress_lvl   = compress_lvl;
+  create->compress_bufsz = compress_bufsz;
+  create->funk_rec_cnt   = funk_rec_cnt;
+  create->batch_acc_cnt  = batch_acc_cnt;
+  create->max_accv_sz    = max_accv_sz;
+  create->accv           = accv;
+  create->worker         = worker;
+
+  /* The snapshot file name depends on the accounts hash, so temporary
+     files get a random suffix such that concurrent snapshot creates
+     don't collide */
+
+  ulong suffix = fd_rng_ulong( rng );
+  fd_cstr_fini( fd_cstr_append_cstr( fd_cstr_init( create->dir ), snap_dir ) );
+  snprintf( create->tmp_path, FD_SNAPSHOT_CREATE_PATH_MAX, "%s/snapshot.%016lx.tmp", snap_dir, suffix );
+
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    fd_snapshot_create_worker_t * w = worker + i;
+    memset( w, 0, sizeof(fd_snapshot_create_worker_t) );
+    w->fd = -1;
+    snprintf( w->path, FD_SNAPSHOT_CREATE_PATH_MAX, "%s/snapshot.%016lx.%lu.tmp", snap_dir, suffix, i );
+
+    void * cstream_mem = FD_SCRATCH_ALLOC_APPEND( l, fd_zstd_cstream_align(),        fd_zstd_cstream_footprint( compress_lvl ) );
+    w->buf             = FD_SCRATCH_ALLOC_APPEND( l, 64UL,                           compress_bufsz                            );
+    w->batch           = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_funk_rec_t const *), batch_acc_cnt*sizeof(fd_funk_rec_t const *) );
+    w->buf_cur         = w->buf;
+
+    w->cstream = fd_zstd_cstream_new( cstream_mem, compress_lvl );
+    if( FD_UNLIKELY( !w->cstream ) ) {
+      FD_LOG_WARNING(( "fd_zstd_cstream_new failed" ));
+      return NULL;
+    }
+  }
+  FD_SCRATCH_ALLOC_FINI( l, fd_snapshot_create_align() );
+
+  FD_COMPILER_MFENCE();
+  create->magic = FD_SNAPSHOT_CREATE_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return create;
+}
+
+/* fd_snapshot_create_cleanup closes and removes all temporary files. */
+
+static void
+fd_snapshot_create_cleanup( fd_snapshot_create_t * create ) {
+  for( ulong i=0UL; i<create->worker_cnt; i++ ) {
+    fd_snapshot_create_worker_t * w = create->worker + i;
+    if( w->fd>=0 ) {
+      close( w->fd );
+      unlink( w->path );
+      w->fd = -1;
+    }
+  }
+}
+
+void *
+fd_snapshot_create_delete( fd_snapshot_create_t * create ) {
+
+  if( FD_UNLIKELY( !create ) ) return NULL;
+  if( FD_UNLIKELY( create->magic!=FD_SNAPSHOT_CREATE_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  fd_snapshot_create_cleanup( create );
+  for( ulong i=0UL; i<create->worker_cnt; i++ )
+    fd_zstd_cstream_delete( create->worker[i].cstream );
+
+  FD_COMPILER_MFENCE();
+  create->magic = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return create;
+}
+
+/* Compressed output **************************************************/
+
+/* fd_snapshot_create_flush writes out the worker's compressed output
+   buffer.  Returns 0 on success or an errno-compatible error code. */
+
+static int
+fd_snapshot_create_flush( fd_snapshot_create_worker_t * w ) {
+  ulong sz = (ulong)( w->buf_cur - w->buf );
+  w->buf_cur = w->buf;
+  if( !sz ) return 0;
+  ulong wsz;
+  int err = fd_io_write( w->fd, w->buf, sz, sz, &wsz );
+  if( FD_UNLIKELY( err ) ) FD_LOG_WARNING(( "write to %s failed (%d-%s)", w->path, err, fd_io_strerror( err ) ));
+  return err;
+}
+
+/* fd_snapshot_create_write appends data to the worker's current
+   Zstandard frame. */
+
+static int
+fd_snapshot_create_write( fd_snapshot_create_t *        create,
+                          fd_snapshot_create_worker_t * w,
+                          void const *                  data,
+                          ulong                         sz ) {
+  uchar const * in     = data;
+  uchar const * in_end = in + sz;
+  uchar *       end    = w->buf + create->compress_bufsz;
+  while( in<in_end ) {
+    if( w->buf_cur==end ) {
+      int err = fd_snapshot_create_flush( w );
+      if( FD_UNLIKELY( err ) ) return err;
+    }
+    int err = fd_zstd_cstream_compress( w->cstream, &in, in_end, &w->buf_cur, end, NULL );
+    if( FD_UNLIKELY( err ) ) return err;
+  }
+  return 0;
+}
+
+/* fd_snapshot_create_frame_end ends the worker's current Zstandard
+   frame.  Every TAR entry lives in its own frame. */
+
+static int
+fd_snapshot_create_frame_end( fd_snapshot_create_t *        create,
+                              fd_snapshot_create_worker_t * w ) {
+  uchar * end = w->buf + create->compress_bufsz;
+  for(;;) {
+    if( w->buf_cur==end ) {
+      int err = fd_snapshot_create_flush( w );
+      if( FD_UNLIKELY( err ) ) return err;
+    }
+    int rc = fd_zstd_cstream_end( w->cstream, &w->buf_cur, end, NULL );
+    if( rc==-1 ) return 0;
+    if( FD_UNLIKELY( rc>0 ) ) return rc;
+  }
+}
+
+/* fd_snapshot_create_tar_hdr writes the TAR header of a regular file
+   with the given name and size into the current frame. */
+
+static int
+fd_snapshot_create_tar_hdr( fd_snapshot_create_t *        create,
+                            fd_snapshot_create_worker_t * w,
+                            char const *                  name,
+                            ulong                         sz ) {
+
+  fd_tar_meta_t meta[1];
+  memset( meta, 0, sizeof(fd_tar_meta_t) );
+
+  if( FD_UNLIKELY( strlen( name )>=FD_TAR_NAME_SZ ) ) return ENAMETOOLONG;
+  strcpy( meta->name, name );
+  memcpy( meta->mode, "0000644", 8UL );
+  memcpy( meta->uid,  "0000000", 8UL );
+  memcpy( meta->gid,  "0000000", 8UL );
+  if( FD_UNLIKELY( !fd_tar_meta_set_size( meta, sz ) ) ) return EFBIG;
+  fd_tar_meta_set_mtime( meta, create->mtime );
+  meta->typeflag = FD_TAR_TYPE_REGULAR;
+  memcpy( meta->magic,   FD_TAR_MAGIC, 6UL );
+  memcpy( meta->version, "00",         2UL );
+
+  /* Checksum is computed with the checksum field set to spaces */
+
+  memset( meta->chksum, ' ', sizeof(meta->chksum) );
+  uint chksum = 0U;
+  uchar const * b = (uchar const *)meta;
+  for( ulong i=0UL; i<sizeof(fd_tar_meta_t); i++ ) chksum += b[i];
+  snprintf( meta->chksum, sizeof(meta->chksum), "%06o", chksum );
+  meta->chksum[7] = ' ';
+
+  return fd_snapshot_create_write( create, w, meta, sizeof(fd_tar_meta_t) );
+}
+
+/* fd_snapshot_create_tar_pad pads a TAR entry of the given size to the
+   TAR block size. */
+
+static int
+fd_snapshot_create_tar_pad( fd_snapshot_create_t *        create,
+                            fd_snapshot_create_worker_t * w,
+                            ulong                         sz ) {
+  ulong pad = fd_ulong_align_up( sz, 512UL ) - sz;
+  return fd_snapshot_create_write( create, w, fd_snapshot_create_zeros, pad );
+}
+
+/* fd_snapshot_create_file writes a complete file held in memory as
+   one TAR entry in its own frame. */
+
+static int
+fd_snapshot_create_file( fd_snapshot_create_t *        create,
+                         fd_snapshot_create_worker_t * w,
+                         char const *                  name,
+                         void const *                  data,
+                         ulong                         sz ) {
+  int err;
+  if( FD_UNLIKELY( err = fd_snapshot_create_tar_hdr( create, w, name, sz  ) ) ) return err;
+  if( FD_UNLIKELY( err = fd_snapshot_create_write  ( create, w, data, sz  ) ) ) return err;
+  if( FD_UNLIKELY( err = fd_snapshot_create_tar_pad( create, w, sz        ) ) ) return err;
+  return fd_snapshot_create_frame_end( create, w );
+}
+
+/* Account vecs *******************************************************/
+
+/* fd_snapshot_create_accv writes out the worker's pending batch of
+   accounts as an account vec. */
+
+static int
+fd_snapshot_create_accv( fd_snapshot_create_t *        create,
+                         fd_snapshot_create_worker_t * w ) {
+
+  fd_funk_t * funk = create->slot_ctx->acc_mgr->funk;
+  fd_wksp_t * wksp = fd_funk_wksp( funk );
+  ulong       slot = create->slot_ctx->slot_bank.slot;
+
+  /* Each account vec holds at least one distinct record, so there are
+     never more account vecs than funk_rec_cnt */
+
+  ulong accv_idx = FD_ATOMIC_FETCH_AND_ADD( &create->accv_cnt, 1UL );
+  ulong accv_id  = accv_idx+1UL; /* (slot,id)==(0,0) is reserved by the restore index */
+  create->accv[ accv_idx ].id      = accv_id;
+  create->accv[ accv_idx ].file_sz = w->batch_sz;
+
+  char name[ FD_TAR_NAME_SZ ];
+  snprintf( name, sizeof(name), "accounts/%lu.%lu", slot, accv_id );
+
+  int err = fd_snapshot_create_tar_hdr( create, w, name, w->batch_sz );
+  if( FD_UNLIKELY( err ) ) return err;
+
+  for( ulong i=0UL; i<w->batch_cnt; i++ ) {
+    fd_funk_rec_t const *     rec  = w->batch[i];
+    fd_account_meta_t const * meta = fd_funk_val_const( rec, wksp );
+    uchar const *             data = (uchar const *)meta + meta->hlen;
+
+    fd_solana_account_hdr_t hdr[1];
+    memset( hdr, 0, sizeof(fd_solana_account_hdr_t) );
+    hdr->meta.data_len = meta->dlen;
+    memcpy( hdr->meta.pubkey, fd_funk_key_to_acc( rec->pair.key ), sizeof(fd_pubkey_t) );
+    memcpy( &hdr->info, &meta->info, sizeof(fd_solana_account_meta_t) );
+    memcpy( hdr->hash.uc, meta->hash, sizeof(fd_hash_t) );
+
+    if( FD_UNLIKELY( err = fd_snapshot_create_write( create, w, hdr,  sizeof(fd_solana_account_hdr_t) ) ) ) return err;
+    if( FD_UNLIKELY( err = fd_snapshot_create_write( create, w, data, meta->dlen                      ) ) ) return err;
+    ulong pad = fd_ulong_align_up( meta->dlen, FD_SNAPSHOT_ACC_ALIGN ) - meta->dlen;
+    if( FD_UNLIKELY( err = fd_snapshot_create_write( create, w, fd_snapshot_create_zeros, pad ) ) ) return err;
+
+    w->acc_cnt++;
+    w->lamports += meta->info.lamports;
+    w->data_len += meta->dlen;
+    w->exec_cnt += !!meta->info.executable;
+  }
+
+  if( FD_UNLIKELY( err = fd_snapshot_create_tar_pad( create, w, w->batch_sz ) ) ) return err;
+
+  w->batch_cnt = 0UL;
+  w->batch_sz  = 0UL;
+  return fd_snapshot_create_frame_end( create, w );
+}
+
+/* fd_snapshot_create_scan claims chunks of the funk rec map and batches
+   up the accounts visible to the slot ctx funk txn. */
+
+static int
+fd_snapshot_create_scan( fd_snapshot_create_t *        create,
+                         fd_snapshot_create_worker_t * w ) {
+
+  fd_funk_t *           funk    = create->slot_ctx->acc_mgr->funk;
+  fd_funk_txn_t const * txn     = create->slot_ctx->funk_txn;
+  fd_wksp_t *           wksp    = fd_funk_wksp( funk );
+  fd_funk_rec_t const * rec_map = fd_funk_rec_map( funk, wksp );
+  ulong                 rec_max = funk->rec_max;
+
+  for(;;) {
+    ulong rec_lo = FD_ATOMIC_FETCH_AND_ADD( &create->rec_next, FD_SNAPSHOT_CREATE_CHUNK_SZ );
+    if( rec_lo>=rec_max ) break;
+    ulong rec_hi = fd_ulong_min( rec_lo+FD_SNAPSHOT_CREATE_CHUNK_SZ, rec_max );
+
+    for( ulong rec_idx=rec_lo; rec_idx<rec_hi; rec_idx++ ) {
+      fd_funk_rec_t const * rec = rec_map + rec_idx;
+
+      /* Skip free map slots, non-account records, deleted accounts and
+         records shadowed by a newer version in a descendant txn */
+      if( fd_funk_rec_map_private_unbox_tag( rec->map_next ) ) continue;
+      if( !fd_funk_key_is_acc( rec->pair.key )               ) continue;
+      if( rec->flags & FD_FUNK_REC_FLAG_ERASE                ) continue;
+      if( fd_funk_rec_query_global( funk, txn, rec->pair.key )!=rec ) continue;
+
+      fd_account_meta_t const * meta = fd_funk_val_const( rec, wksp );
+      if( FD_UNLIKELY( !meta || fd_funk_val_sz( rec )<sizeof(fd_account_meta_t) ) ) continue;
+      if( FD_UNLIKELY( meta->magic!=FD_ACCOUNT_META_MAGIC                        ) ) continue;
+      if( !meta->info.lamports ) continue;
+
+      ulong acc_sz = sizeof(fd_solana_account_hdr_t) + fd_ulong_align_up( meta->dlen, FD_SNAPSHOT_ACC_ALIGN );
+      if( w->batch_cnt && ( w->batch_cnt==create->batch_acc_cnt || w->batch_sz+acc_sz>create->max_accv_sz ) ) {
+        int err = fd_snapshot_create_accv( create, w );
+        if( FD_UNLIKELY( err ) ) return err;
+      }
+      w->batch[ w->batch_cnt++ ] = rec;
+      w->batch_sz += acc_sz;
+    }
+  }
+
+  if( w->batch_cnt ) {
+    int err = fd_snapshot_create_accv( create, w );
+    if( FD_UNLIKELY( err ) ) return err;
+  }
+  return fd_snapshot_create_flush( w );
+}
+
+static void
+fd_snapshot_create_task( void * tpool,
+                         ulong  t0     FD_PARAM_UNUSED, ulong t1     FD_PARAM_UNUSED,
+                         void * args   FD_PARAM_UNUSED,
+                         void * reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                         ulong  l0     FD_PARAM_UNUSED, ulong l1     FD_PARAM_UNUSED,
+                         ulong  m0,                     ulong m1     FD_PARAM_UNUSED,
+                         ulong  n0     FD_PARAM_UNUSED, ulong n1     FD_PARAM_UNUSED ) {
+  fd_snapshot_create_t *        create = (fd_snapshot_create_t *)tpool;
+  fd_snapshot_create_worker_t * w      = create->worker + m0;
+  w->err = fd_snapshot_create_scan( create, w );
+}
+
+/* Status cache *******************************************************/
+
+#define SORT_NAME        fd_snapshot_create_scache_sort
+#define SORT_KEY_T       fd_txncache_snapshot_entry_t
+#define SORT_BEFORE(a,b) ( (a).slot<(b).slot || ( (a).slot==(b).slot && memcmp( (a).blockhash, (b).blockhash, 32UL )<0 ) )
+#include "../../util/tmpl/fd_sort.c"
+
+/* fd_snapshot_create_scache_t gathers the txn cache entries streamed
+   out by fd_txncache_snapshot. */
+
+struct fd_snapshot_create_scache {
+  fd_valloc_t                    valloc;
+  fd_txncache_snapshot_entry_t * entry;
+  ulong                          entry_cnt;
+  ulong                          entry_max;
+};
+
+typedef struct fd_snapshot_create_scache fd_snapshot_create_scache_t;
+
+static int
+fd_snapshot_create_scache_append( uchar const * data,
+                                  ulong         data_sz,
+                                  void *        ctx ) {
+  fd_snapshot_create_scache_t * scache = ctx;
+  if( FD_UNLIKELY( data_sz!=sizeof(fd_txncache_snapshot_entry_t) ) ) return -1;
+  if( scache->entry_cnt==scache->entry_max ) {
+    ulong max = fd_ulong_max( 2UL*scache->entry_max, 1024UL );
+    fd_txncache_snapshot_entry_t * entry = fd_valloc_malloc( scache->valloc, alignof(fd_txncache_snapshot_entry_t), max*sizeof(fd_txncache_snapshot_entry_t) );
+    if( FD_UNLIKELY( !entry ) ) return -1;
+    if( scache->entry ) {
+      fd_memcpy( entry, scache->entry, scache->entry_cnt*sizeof(fd_txncache_snapshot_entry_t) );
+      fd_valloc_free( scache->valloc, scache->entry );
+    }
+    scache->entry     = entry;
+    scache->entry_max = max;
+  }
+  fd_memcpy( scache->entry + scache->entry_cnt, data, sizeof(fd_txncache_snapshot_entry_t) );
+  scache->entry_cnt++;
+  return 0;
+}
+
+/* fd_snapshot_create_status_cache serializes the rooted slots of the
+   slot ctx txn cache as bank slot deltas.  This is the reverse of
+   fd_exec_slot_ctx_recover_status_cache.  The txn cache only keeps the
+   discriminant of each txn result, so failed txns are exported with a
+   default error.  Without a txn cache, the status cache is empty.  The
+   encoded status cache is allocated from the slot ctx valloc and
+   returned in *out (size *out_sz).  Returns 0 on success. */
+
+static int
+fd_snapshot_create_status_cache( fd_snapshot_create_t * create,
+                                 uchar **               out,
+                                 ulong *                out_sz ) {
+
+  fd_exec_slot_ctx_t * slot_ctx = create->slot_ctx;
+  fd_valloc_t          valloc   = slot_ctx->valloc;
+
+  fd_snapshot_create_scache_t scache[1] = {{ .valloc = valloc }};
+  if( slot_ctx->status_cache ) {
+    if( FD_UNLIKELY( fd_txncache_snapshot( slot_ctx->status_cache, scache, fd_snapshot_create_scache_append ) ) ) {
+      FD_LOG_WARNING(( "fd_txncache_snapshot failed" ));
+      if( scache->entry ) fd_valloc_free( valloc, scache->entry );
+      return ENOMEM;
+    }
+  }
+  fd_txncache_snapshot_entry_t * entry     = scache->entry;
+  ulong                          entry_cnt = scache->entry_cnt;
+  fd_snapshot_create_scache_sort_inplace( entry, entry_cnt );
+
+  /* Group entries by slot, then by blockhash */
+
+  ulong slot_cnt = 0UL;
+  ulong pair_cnt = 0UL;
+  for( ulong i=0UL; i<entry_cnt; i++ ) {
+    int new_slot = !i || entry[i].slot!=entry[i-1UL].slot;
+    slot_cnt += (ulong)new_slot;
+    pair_cnt += (ulong)( new_slot || memcmp( entry[i].blockhash, entry[i-1UL].blockhash, 32UL ) );
+  }
+
+  fd_slot_delta_t *   slot_deltas = fd_valloc_malloc( valloc, FD_SLOT_DELTA_ALIGN,   fd_ulong_max( slot_cnt,  1UL )*sizeof(fd_slot_delta_t)   );
+  fd_status_pair_t *  pairs       = fd_valloc_malloc( valloc, FD_STATUS_PAIR_ALIGN,  fd_ulong_max( pair_cnt,  1UL )*sizeof(fd_status_pair_t)  );
+  fd_cache_status_t * statuses    = fd_valloc_malloc( valloc, FD_CACHE_STATUS_ALIGN, fd_ulong_max( entry_cnt, 1UL )*sizeof(fd_cache_status_t) );
+
+  int err = 0;
+  if( FD_UNLIKELY( !slot_deltas || !pairs || !statuses ) ) err = ENOMEM;
+
+  fd_slot_delta_t *  slot_delta = NULL;
+  fd_status_pair_t * pair       = NULL;
+  for( ulong i=0UL; (i<entry_cnt) & (!err); i++ ) {
+    int new_slot = !i || entry[i].slot!=entry[i-1UL].slot;
+    if( new_slot ) {
+      slot_delta = slot_delta ? slot_delta+1 : slot_deltas;
+      *slot_delta = (fd_slot_delta_t){ .slot = entry[i].slot, .is_root = 1, .slot_delta_vec = pair ? pair+1 : pairs };
+    }
+    if( new_slot || memcmp( entry[i].blockhash, entry[i-1UL].blockhash, 32UL ) ) {
+      pair = pair ? pair+1 : pairs;
+      memset( pair, 0, sizeof(fd_status_pair_t) );
+      memcpy( pair->hash.uc, entry[i].blockhash, 32UL );
+      pair->value.txn_idx  = entry[i].txn_idx;
+      pair->value.statuses = statuses + i;
+      slot_delta->slot_delta_vec_len++;
+    }
+    fd_cache_status_t * status = statuses + i;
+    memset( status, 0, sizeof(fd_cache_status_t) );
+    memcpy( status->key_slice, entry[i].txnhash, 20UL );
+    status->result.discriminant = entry[i].result;
+    pair->value.statuses_len++;
+  }
+
+  uchar * buf = NULL;
+  ulong   sz  = 0UL;
+  if( FD_LIKELY( !err ) ) {
+    fd_bank_slot_deltas_t cache = { .slot_deltas_len = slot_cnt, .slot_deltas = slot_deltas };
+    sz  = fd_bank_slot_deltas_size( &cache );
+    buf = fd_valloc_malloc( valloc, 8UL, sz );
+    if( FD_UNLIKELY( !buf ) ) err = ENOMEM;
+    if( FD_LIKELY( !err ) ) {
+      fd_bincode_encode_ctx_t encode = { .data = buf, .dataend = buf+sz };
+      int encode_err = fd_bank_slot_deltas_encode( &cache, &encode );
+      if( FD_UNLIKELY( encode_err!=FD_BINCODE_SUCCESS ) ) {
+        FD_LOG_WARNING(( "fd_bank_slot_deltas_encode failed (%d)", encode_err ));
+        fd_valloc_free( valloc, buf );
+        err = EINVAL;
+      }
+    }
+  }
+
+  if( statuses    ) fd_valloc_free( valloc, statuses    );
+  if( pairs       ) fd_valloc_free( valloc, pairs       );
+  if( slot_deltas ) fd_valloc_free( valloc, slot_deltas );
+  if( entry       ) fd_valloc_free( valloc, entry       );
+  if( FD_UNLIKELY( err ) ) return err;
+
+  FD_LOG_INFO(( "exported %lu txn statuses of %lu slots", entry_cnt, slot_cnt ));
+  *out    = buf;
+  *out_sz = sz;
+  return 0;
+}
+
+/* Manifest ***********************************************************/
+
+static ulong
+fd_snapshot_create_total_stake( fd_vote_accounts_t const * vote_accounts ) {
+  ulong total = 0UL;
+  for( fd_vote_accounts_pair_t_mapnode_t const * n = fd_vote_accounts_pair_t_map_minimum_const( vote_accounts->vote_accounts_pool, vote_accounts->vote_accounts_root );
+       n;
+       n = fd_vote_accounts_pair_t_map_successor_const( vote_accounts->vote_accounts_pool, n ) ) {
+    total += n->elem.stake;
+  }
+  return total;
+}
+
+/* fd_snapshot_create_manifest serializes the snapshot manifest of the
+   slot ctx.  This is the reverse of fd_exec_slot_ctx_recover.  Bank
+   data structures are borrowed (not copied) from the slot and epoch
+   banks.  The encoded manifest is allocated from the slot ctx valloc
+   and returned in *out (size *out_sz).  Returns 0 on success. */
+
+static int
+fd_snapshot_create_manifest( fd_snapshot_create_t * create,
+                             uchar **               out,
+                             ulong *                out_sz ) {
+
+  fd_exec_slot_ctx_t *  slot_ctx   = create->slot_ctx;
+  fd_slot_bank_t *      slot_bank  = &slot_ctx->slot_bank;
+  fd_epoch_bank_t *     epoch_bank = fd_exec_epoch_ctx_epoch_bank( slot_ctx->epoch_ctx );
+  fd_valloc_t           valloc     = slot_ctx->valloc;
+
+  ulong slot  = slot_bank->slot;
+  ulong epoch = fd_slot_to_epoch( &epoch_bank->epoch_schedule, slot, NULL );
+
+  fd_solana_manifest_t manifest[1];
+  memset( manifest, 0, sizeof(fd_solana_manifest_t) );
+
+  fd_deserializable_versioned_bank_t * bank = &manifest->bank;
+
+  /* Blockhash queue */
+
+  fd_block_hash_queue_t const * bhq = &slot_bank->block_hash_queue;
+  ulong ages_cnt = 0UL;
+  for( fd_hash_hash_age_pair_t_mapnode_t const * n = fd_hash_hash_age_pair_t_map_minimum_const( bhq->ages_pool, bhq->ages_root );
+       n;
+       n = fd_hash_hash_age_pair_t_map_successor_const( bhq->ages_pool, n ) ) {
+    ages_cnt++;
+  }
+  fd_hash_hash_age_pair_t * ages = fd_valloc_malloc( valloc, FD_HASH_HASH_AGE_PAIR_ALIGN, fd_ulong_max( ages_cnt, 1UL )*sizeof(fd_hash_hash_age_pair_t) );
+  ulong age_idx = 0UL;
+  for( fd_hash_hash_age_pair_t_mapnode_t const * n = fd_hash_hash_age_pair_t_map_minimum_const( bhq->ages_pool, bhq->ages_root );
+       n;
+       n = fd_hash_hash_age_pair_t_map_successor_const( bhq->ages_pool, n ) ) {
+    ages[ age_idx++ ] = n->elem;
+  }
+  bank->blockhash_queue.last_hash_index = bhq->last_hash_index;
+  bank->blockhash_queue.last_hash       = bhq->last_hash;
+  bank->blockhash_queue.ages_len        = age_idx;
+  bank->blockhash_queue.ages            = ages;
+  bank->blockhash_queue.max_age         = bhq->max_age;
+
+  fd_slot_pair_t ancestors[1] = {{ .slot = slot, .val = 0UL }};
+  bank->ancestors_len = 1UL;
+  bank->ancestors     = ancestors;
+
+  fd_slot_pair_t hard_forks[1] = {{ .slot = slot_bank->last_restart_slot.slot, .val = 1UL }};
+  bank->hard_forks.hard_forks_len = !!slot_bank->last_restart_slot.slot;
+  bank->hard_forks.hard_forks     = hard_forks;
+
+  bank->hash                  = slot_bank->banks_hash;
+  bank->parent_hash           = slot_ctx->prev_banks_hash;
+  bank->parent_slot           = slot_bank->prev_slot;
+  bank->transaction_count     = slot_bank->transaction_count;
+  bank->tick_height           = slot_bank->max_tick_height;
+  bank->signature_count       = slot_ctx->signature_cnt;
+  bank->capitalization        = slot_bank->capitalization;
+  bank->max_tick_height       = slot_bank->max_tick_height;
+  bank->hashes_per_tick       = &epoch_bank->hashes_per_tick;
+  bank->ticks_per_slot        = epoch_bank->ticks_per_slot;
+  bank->ns_per_slot           = epoch_bank->ns_per_slot;
+  bank->genesis_creation_time = epoch_bank->genesis_creation_time;
+  bank->slots_per_year        = epoch_bank->slots_per_year;
+  bank->slot                  = slot;
+  bank->epoch                 = epoch;
+  bank->block_height          = slot_bank->block_height;
+  if( slot_ctx->leader ) bank->collector_id = *slot_ctx->leader;
+  bank->collector_fees        = slot_bank->collected_execution_fees;
+  bank->fee_calculator.lamports_per_signature = slot_bank->lamports_per_signature;
+  bank->fee_rate_governor     = slot_bank->fee_rate_governor;
+  bank->collected_rent        = slot_bank->collected_rent;
+
+  bank->rent_collector.epoch          = epoch;
+  bank->rent_collector.epoch_schedule = epoch_bank->epoch_schedule;
+  bank->rent_collector.slots_per_year = epoch_bank->slots_per_year;
+  bank->rent_collector.rent           = epoch_bank->rent;
+
+  bank->epoch_schedule = epoch_bank->epoch_schedule;
+  bank->inflation      = epoch_bank->inflation;
+  bank->stakes         = epoch_bank->stakes;
+
+  /* EpochStakes of the current and next epoch */
+
+  fd_epoch_epoch_stakes_pair_t epoch_stakes[2];
+  for( ulong i=0UL; i<2UL; i++ ) {
+    fd_epoch_stakes_new( &epoch_stakes[i].value );
+    epoch_stakes[i].key = epoch+i;
+    epoch_stakes[i].value.stakes.epoch = epoch+i;
+  }
+  epoch_stakes[0].value.stakes.vote_accounts = slot_bank->epoch_stakes;
+  epoch_stakes[1].value.stakes.vote_accounts = epoch_bank->next_epoch_stakes;
+  epoch_stakes[0].value.total_stake = fd_snapshot_create_total_stake( &slot_bank->epoch_stakes         );
+  epoch_stakes[1].value.total_stake = fd_snapshot_create_total_stake( &epoch_bank->next_epoch_stakes   );
+  bank->epoch_stakes_len = 2UL;
+  bank->epoch_stakes     = epoch_stakes;
+
+  /* Accounts DB */
+
+  fd_snapshot_slot_acc_vecs_t storage[1] = {{
+    .slot             = slot,
+    .account_vecs_len = create->accv_cnt,
+    .account_vecs     = create->accv
+  }};
+
+  fd_solana_accounts_db_fields_t * accounts_db = &manifest->accounts_db;
+  accounts_db->storages_len = 1UL;
+  accounts_db->storages     = storage;
+  accounts_db->version      = 1UL;
+  accounts_db->slot         = slot;
+  accounts_db->bank_hash_info.hash          = slot_ctx->account_delta_hash;
+  accounts_db->bank_hash_info.snapshot_hash = create->accounts_hash;
+  for( ulong i=0UL; i<create->worker_cnt; i++ ) {
+    fd_snapshot_create_worker_t const * w = create->worker + i;
+    accounts_db->bank_hash_info.stats.num_updated_accounts    += w->acc_cnt;
+    accounts_db->bank_hash_info.stats.num_lamports_stored     += w->lamports;
+    accounts_db->bank_hash_info.stats.total_data_len          += w->data_len;
+    accounts_db->bank_hash_info.stats.num_executable_accounts += w->exec_cnt;
+  }
+
+  manifest->lamports_per_signature = slot_bank->lamports_per_signature;
+  fd_hash_t eah = slot_bank->epoch_account_hash;
+  if( !fd_hash_check_zero( &eah ) ) manifest->epoch_account_hash = &eah;
+
+  /* Serialize */
+
+  ulong   sz  = fd_solana_manifest_size( manifest );
+  uchar * buf = fd_valloc_malloc( valloc, 8UL, sz );
+  fd_bincode_encode_ctx_t encode = { .data = buf, .dataend = buf+sz };
+  int err = fd_solana_manifest_encode( manifest, &encode );
+  fd_valloc_free( valloc, ages );
+  if( FD_UNLIKELY( err!=FD_BINCODE_SUCCESS ) ) {
+    FD_LOG_WARNING(( "fd_solana_manifest_encode failed (%d)", err ));
+    fd_valloc_free( valloc, buf );
+    return EINVAL;
+  }
+
+  *out    = buf;
+  *out_sz = sz;
+  return 0;
+}
+
+/* Assembly ***********************************************************/
+
+/* fd_snapshot_create_append appends the content of a worker's
+   temporary file to fd.  Uses the given buffer for copying. */
+
+static int
+fd_snapshot_create_append( int                                 fd,
+                           fd_snapshot_create_worker_t const * src,
+                           uchar *                             buf,
+                           ulong                               buf_sz ) {
+  if( FD_UNLIKELY( lseek( src->fd, 0L, SEEK_SET )<0L ) ) {
+    FD_LOG_WARNING(( "lseek(%s) failed (%d-%s)", src->path, errno, fd_io_strerror( errno ) ));
+    return errno;
+  }
+  for(;;) {
+    ulong rsz;
+    int err = fd_io_read( src->fd, buf, 1UL, buf_sz, &rsz );
+    if( err<0 ) return 0; /* EOF */
+    if( FD_UNLIKELY( err ) ) {
+      FD_LOG_WARNING(( "read from %s failed (%d-%s)", src->path, err, fd_io_strerror( err ) ));
+      return err;
+    }
+    ulong wsz;
+    err = fd_io_write( fd, buf, rsz, rsz, &wsz );
+    if( FD_UNLIKELY( err ) ) {
+      FD_LOG_WARNING(( "write failed (%d-%s)", err, fd_io_strerror( err ) ));
+      return err;
+    }
+  }
+}
+
+static int
+fd_snapshot_create_( fd_snapshot_create_t * create ) {
+
+  fd_exec_slot_ctx_t * slot_ctx = create->slot_ctx;
+  ulong                slot     = slot_ctx->slot_bank.slot;
+  ulong                worker_cnt = create->worker_cnt;
+
+  create->rec_next = 0UL;
+  create->accv_cnt = 0UL;
+  create->mtime    = (ulong)( fd_log_wallclock() / (long)1e9 );
+  create->path[0]  = '\0';
+
+  /* Accounts hash of the snapshot, which also fills in missing account
+     hashes before they are written out.  Named like Labs snapshots
+     such that loaders can verify the accounts against it. */
+
+  long dt = -fd_log_wallclock();
+  fd_snapshot_hash_visible_tpool( slot_ctx, &create->accounts_hash, slot_ctx->funk_txn, create->tpool, worker_cnt );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "accounts hash %32J in %.3f s", create->accounts_hash.hash, (double)dt*1e-9 ));
+
+  char hash_cstr[ FD_BASE58_ENCODED_32_SZ ];
+  fd_base58_encode_32( create->accounts_hash.uc, NULL, hash_cstr );
+  char path[ FD_SNAPSHOT_CREATE_PATH_MAX ];
+  if( FD_UNLIKELY( !fd_cstr_printf_check( path, sizeof(path), NULL, "%s/snapshot-%lu-%s.tar.zst", create->dir, slot, hash_cstr ) ) ) {
+    FD_LOG_WARNING(( "snapshot path too long" ));
+    return ENAMETOOLONG;
+  }
+
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    fd_snapshot_create_worker_t * w = create->worker + i;
+    w->fd = open( w->path, O_RDWR|O_CREAT|O_TRUNC, 0644 );
+    if( FD_UNLIKELY( w->fd<0 ) ) {
+      FD_LOG_WARNING(( "open(%s) failed (%d-%s)", w->path, errno, fd_io_strerror( errno ) ));
+      return errno;
+    }
+    w->err       = 0;
+    w->buf_cur   = w->buf;
+    w->batch_cnt = 0UL;
+    w->batch_sz  = 0UL;
+    w->acc_cnt   = 0UL;
+    w->lamports  = 0UL;
+    w->data_len  = 0UL;
+    w->exec_cnt  = 0UL;
+    fd_zstd_cstream_reset( w->cstream );
+  }
+
+  /* Write account vecs in parallel */
+
+  dt = -fd_log_wallclock();
+
+  for( ulong i=1UL; i<worker_cnt; i++ )
+    fd_tpool_exec( create->tpool, i, fd_snapshot_create_task, create, 0UL, 0UL, NULL, NULL, 0UL, 0UL, 0UL, i, i+1UL, 0UL, 0UL );
+  fd_snapshot_create_task( create, 0UL, 0UL, NULL, NULL, 0UL, 0UL, 0UL, 0UL, 1UL, 0UL, 0UL );
+  for( ulong i=1UL; i<worker_cnt; i++ )
+    fd_tpool_wait( create->tpool, i );
+
+  dt += fd_log_wallclock();
+
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    if( FD_UNLIKELY( create->worker[i].err ) ) {
+      FD_LOG_WARNING(( "snapshot worker %lu failed (%d)", i, create->worker[i].err ));
+      return create->worker[i].err;
+    }
+  }
+
+  ulong acc_cnt = 0UL;
+  for( ulong i=0UL; i<worker_cnt; i++ ) acc_cnt += create->worker[i].acc_cnt;
+  FD_LOG_NOTICE(( "wrote %lu accounts in %lu account vecs with %lu workers in %.3f s",
+                  acc_cnt, create->accv_cnt, worker_cnt, (double)dt*1e-9 ));
+
+  /* Assemble the final stream using the worker 0 compressor:
+     version, status cache, manifest, account vecs, EOF */
+
+  int fd = open( create->tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644 );
+  if( FD_UNLIKELY( fd<0 ) ) {
+    FD_LOG_WARNING(( "open(%s) failed (%d-%s)", create->tmp_path, errno, fd_io_strerror( errno ) ));
+    return errno;
+  }
+
+  fd_snapshot_create_worker_t * w0 = create->worker;
+  int w0_fd = w0->fd;
+  w0->fd = fd;
+
+  int err = fd_snapshot_create_file( create, w0, "version", FD_SNAPSHOT_VERSION, strlen( FD_SNAPSHOT_VERSION ) );
+
+  if( FD_LIKELY( !err ) ) {
+    uchar * status_cache;
+    ulong   status_cache_sz;
+    err = fd_snapshot_create_status_cache( create, &status_cache, &status_cache_sz );
+    if( FD_LIKELY( !err ) ) {
+      err = fd_snapshot_create_file( create, w0, "snapshots/status_cache", status_cache, status_cache_sz );
+      fd_valloc_free( slot_ctx->valloc, status_cache );
+    }
+  }
+
+  if( FD_LIKELY( !err ) ) {
+    uchar * manifest;
+    ulong   manifest_sz;
+    err = fd_snapshot_create_manifest( create, &manifest, &manifest_sz );
+    if( FD_LIKELY( !err ) ) {
+      char name[ FD_TAR_NAME_SZ ];
+      snprintf( name, sizeof(name), "snapshots/%lu/%lu", slot, slot );
+      err = fd_snapshot_create_file( create, w0, name, manifest, manifest_sz );
+      fd_valloc_free( slot_ctx->valloc, manifest );
+    }
+  }
+
+  if( FD_LIKELY( !err ) ) err = fd_snapshot_create_flush( w0 );
+
+  for( ulong i=0UL; (i<worker_cnt) & (!err); i++ ) {
+    fd_snapshot_create_worker_t tmp = create->worker[i];
+    if( i==0UL ) tmp.fd = w0_fd;
+    err = fd_snapshot_create_append( fd, &tmp, w0->buf, create->compress_bufsz );
+  }
+
+  /* End of archive: two empty TAR blocks */
+
+  if( FD_LIKELY( !err ) ) err = fd_snapshot_create_write( create, w0, fd_snapshot_create_zeros, 512UL );
+  if( FD_LIKELY( !err ) ) err = fd_snapshot_create_write( create, w0, fd_snapshot_create_zeros, 512UL );
+  if( FD_LIKELY( !err ) ) err = fd_snapshot_create_frame_end( create, w0 );
+  if( FD_LIKELY( !err ) ) err = fd_snapshot_create_flush( w0 );
+
+  w0->fd = w0_fd;
+
+  if( FD_UNLIKELY( close( fd ) ) ) {
+    FD_LOG_WARNING(( "close(%s) failed (%d-%s)", create->tmp_path, errno, fd_io_strerror( errno ) ));
+    if( !err ) err = errno;
+  }
+  if( FD_UNLIKELY( err ) ) {
+    unlink( create->tmp_path );
+    return err;
+  }
+
+  if( FD_UNLIKELY( rename( create->tmp_path, path ) ) ) {
+    FD_LOG_WARNING(( "rename(%s,%s) failed (%d-%s)", create->tmp_path, path, errno, fd_io_strerror( errno ) ));
+    unlink( create->tmp_path );
+    return errno;
+  }
+  fd_cstr_fini( fd_cstr_append_cstr( fd_cstr_init( create->path ), path ) );
+  return 0;
+}
+
+int
+fd_snapshot_create( fd_snapshot_create_t * create,
+                    fd_exec_slot_ctx_t *   slot_ctx ) {
+
+  if( FD_UNLIKELY( !create || create->magic!=FD_SNAPSHOT_CREATE_MAGIC ) ) {
+    FD_LOG_WARNING(( "invalid create object" ));
+    return 0;
+  }
+  if( FD_UNLIKELY( slot_ctx!=create->slot_ctx ) ) {
+    FD_LOG_WARNING(( "slot_ctx does not match the one given to fd_snapshot_create_new" ));
+    return 0;
+  }
+
+  int err = fd_snapshot_create_( create );
+  fd_snapshot_create_cleanup( create );
+  if( FD_UNLIKELY( err ) ) {
+    FD_LOG_WARNING(( "snapshot create at slot %lu failed (%d)", slot_ctx->slot_bank.slot, err ));
+    return 0;
+  }
+
+  FD_LOG_NOTICE(( "wrote snapshot %s at slot %lu", create->path, slot_ctx->slot_bank.slot ));
+  return 1;
+}
+
+char const *
+fd_snapshot_create_path( fd_snapshot_create_t const * create ) {
+  return create->path;
+}
@@ -2,10 +2,21 @@
 #define HEADER_fd_src_flamenco_snapshot_fd_snapshot_create_h
 
 /* fd_snapshot_create.h provides APIs for creating a Labs-compatible
-   snapshot from a slot execution context. */
+   snapshot from a slot execution context.
+
+   Snapshot creation is split across worker_cnt workers.  Each worker
+   claims chunks of the funk record map, gathers the accounts visible
+   to the slot context's funk txn into account vecs ("AppendVecs") of
+   up to batch_acc_cnt accounts / max_accv_sz bytes, and compresses
+   each account vec (including its TAR header) into an independent
+   Zstandard frame written to a per-worker temporary file.  Since
+   Zstandard frames and TAR entries both concatenate, the final
+   .tar.zst is assembled by writing the version, status cache and
+   manifest frames followed by the contents of each worker file. */
 
 #include "../fd_flamenco_base.h"
 #include "../runtime/context/fd_exec_slot_ctx.h"
+#include "../../util/tpool/fd_tpool.h"
 
 struct fd_snapshot_create_private;
 typedef struct fd_snapshot_create_private fd_snapshot_create_t;
@@ -16,7 +27,7 @@ FD_PROTOTYPES_BEGIN
    parameters for the fd_snapshot_create_t object.
 
    worker_cnt is the number of workers for parallel snapshot create
-   (treated as 1UL parallel mode not available). compress_lvl is the
+   (worker 0 is the caller, see fd_snapshot_create_new). compress_lvl is the
    Zstandard compression level.  compress_bufsz is the in-memory buffer
    for writes (larger buffers results in less frequent but larger write
    ops).  funk_rec_cnt is the number of slots in the funk rec hashmap.
@@ -39,41 +50,63 @@ fd_snapshot_create_footprint( ulong worker_cnt,
 /* fd_snapshot_create_new creates a new snapshot create object in the
    given mem region, which adheres to above alignment/footprint
    requirements.  Returns qualified handle to object given create object
-   on success.  Serializes data from given slot context.  snap_path is
-   the final snapshot path.  May create temporary files adject to
-   snap_path.  {worker_cnt,compress_lvl,compress_bufsz,funk_rec_cnt,
+   on success.  Serializes data from given slot context.  snap_dir is
+   the directory snapshots are written to.  May create temporary files
+   in snap_dir.  {worker_cnt,compress_lvl,compress_bufsz,funk_rec_cnt,
    batch_acc_cnt} must match arguments to footprint when mem was
-   created.  On failure, returns NULL. Reasons for failure include
-   invalid memory region or invalid file descriptor.  Logs reasons for
-   failure. */
+   created.  funk_rec_cnt must be at least the rec_max of the funk
+   instance of slot_ctx.  max_accv_sz bounds the byte size of each
+   account vec (an account vec always holds at least one account).
+   tpool provides workers [1,worker_cnt) (may be NULL if
+   worker_cnt==1).  rng is used to pick unique temporary file names.
+   On failure, returns NULL. Reasons for failure include invalid
+   memory region, invalid params or failure to create temporary files.
+   Logs reasons for failure. */
 
 fd_snapshot_create_t *
 fd_snapshot_create_new( void *               mem,
                         fd_exec_slot_ctx_t * slot_ctx,
-                        const char *         snap_path,
+                        const char *         snap_dir,
                         ulong                worker_cnt,
                         int                  compress_lvl,
                         ulong                compress_bufsz,
                         ulong                funk_rec_cnt,
                         ulong                batch_acc_cnt,
                         ulong                max_accv_sz,
+                        fd_tpool_t *         tpool,
                         fd_rng_t *           rng );
 
 /* fd_snapshot_create_delete destroys the given snapshot create object
-   and frees any resources.  Returns memory region and fd back to caller. */
+   and frees any resources (removes leftover temporary files).  Returns
+   memory region back to caller. */
 
 void *
 fd_snapshot_create_delete( fd_snapshot_create_t * create );
 
-/* fd_snapshot_create exports the 'snapshot manifest' and a copy of all
+/* fd_snapshot_create exports the 'snapshot manifest', the status cache
+   (rooted slots of slot_ctx->status_cache, if any) and a copy of all
    accounts from the slot ctx that the create object is attached to.
-   Writes a .tar.zst stream out to the fd.  Returns 1 on success, and
-   0 on failure.  Reason for failure is logged. */
+   Writes a .tar.zst stream out to snap_dir/snapshot-<slot>-<hash>.tar.zst
+   where hash is the base58 accounts hash of the snapshot (atomically
+   replaced via rename once complete).  The manifest carries the
+   accounts delta hash of the slot and the accounts hash.  Accounts with
+   zero lamports are omitted.
+   The funk records visible to slot_ctx->funk_txn must not be modified
+   while this runs (e.g. create from a frozen or published txn while
+   replay continues on its children).  Returns 1 on success, and 0 on
+   failure.  Reason for failure is logged. */
 
 int
 fd_snapshot_create( fd_snapshot_create_t * create,
                     fd_exec_slot_ctx_t *   slot_ctx );
 
+/* fd_snapshot_create_path returns the path of the snapshot written by
+   the last successful fd_snapshot_create call (empty cstr if none).
+   The returned pointer is valid for the lifetime of create. */
+
+FD_FN_PURE char const *
+fd_snapshot_create_path( fd_snapshot_create_t const * create );
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_flamenco_snapshot_fd_snapshot_create_h */
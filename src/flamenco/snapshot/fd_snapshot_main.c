@@ -1,5 +1,6 @@
 #define FD_SCRATCH_USE_HANDHOLDING 1
 #include "fd_snapshot_loader.h"
+#include "fd_snapshot_par.h"
 #include "fd_snapshot_http.h"
 #include "fd_snapshot_restore_private.h"
 #include "../runtime/fd_acc_mgr.h"
@@ -19,6 +20,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/random.h>
+#include <sys/stat.h>
 
 /* Snapshot restore ***************************************************/
 
@@ -470,6 +472,198 @@ cmd_dump( int     argc,
   return rc;
 }
 
+/* Snapshot load benchmark ********************************************/
+
+/* fd_snapshot_bench_args_t contains the command-line arguments for the
+   bench command. */
+
+struct fd_snapshot_bench_args {
+  char const * _page_sz;
+  ulong        page_cnt;
+  ulong        near_cpu;
+  ulong        zstd_window_sz;
+  char *       snapshot;
+  ulong        rec_max;
+  ulong        out_sz;
+  ulong        frame_max;
+  ulong        accv_max;
+  int          serial;
+};
+
+typedef struct fd_snapshot_bench_args fd_snapshot_bench_args_t;
+
+static int
+fd_snapshot_bench_on_manifest( void *                 ctx,
+                               fd_solana_manifest_t * manifest ) {
+  fd_valloc_t * valloc = ctx;
+  FD_LOG_NOTICE(( "Snapshot manifest at slot %lu", manifest->bank.slot ));
+  fd_bincode_destroy_ctx_t destroy = { .valloc = *valloc };
+  fd_solana_manifest_destroy( manifest, &destroy );
+  return 0;
+}
+
+/* bench_serial loads the snapshot with the single-threaded
+   fd_snapshot_loader.  Returns the wallclock duration until the
+   manifest was restored in *manifest_ns. */
+
+static int
+bench_serial( fd_snapshot_bench_args_t * args,
+              fd_snapshot_restore_t *    restore,
+              long *                     manifest_ns ) {
+
+  fd_snapshot_src_t src[1];
+  if( FD_UNLIKELY( !fd_snapshot_src_parse( src, args->snapshot ) ) ) return EINVAL;
+
+  void * loader_mem = fd_scratch_alloc( fd_snapshot_loader_align(), fd_snapshot_loader_footprint( args->zstd_window_sz ) );
+  fd_snapshot_loader_t * loader = fd_snapshot_loader_new( loader_mem, args->zstd_window_sz );
+  if( FD_UNLIKELY( !loader ) ) return ENOMEM;
+
+  long t0 = fd_log_wallclock();
+  if( FD_UNLIKELY( !fd_snapshot_loader_init( loader, restore, src, 0UL ) ) ) {
+    fd_snapshot_loader_delete( loader );
+    return EINVAL;
+  }
+
+  int err;
+  for(;;) {
+    err = fd_snapshot_loader_advance( loader );
+    if( !*manifest_ns && restore->manifest_done ) *manifest_ns = fd_log_wallclock() - t0;
+    if( err ) break;
+  }
+  fd_snapshot_loader_delete( loader );
+  return err<0 ? 0 : err;
+}
+
+static int
+do_bench( fd_snapshot_bench_args_t * args,
+          fd_wksp_t *                wksp ) {
+
+  struct stat st;
+  if( FD_UNLIKELY( 0!=stat( args->snapshot, &st ) ) ) {
+    FD_LOG_WARNING(( "stat(%s) failed (%d-%s)", args->snapshot, errno, fd_io_strerror( errno ) ));
+    return EXIT_FAILURE;
+  }
+
+  ulong const fd_alloc_tag = 41UL;
+  fd_alloc_t * alloc = fd_alloc_join( fd_alloc_new( fd_wksp_alloc_laddr( wksp, fd_alloc_align(), fd_alloc_footprint(), fd_alloc_tag ), fd_alloc_tag ), 0UL );
+  if( FD_UNLIKELY( !alloc ) ) { FD_LOG_WARNING(( "fd_alloc_join() failed" )); return EXIT_FAILURE; }
+  fd_valloc_t valloc = fd_alloc_virtual( alloc );
+
+  ulong funk_seed;
+  if( FD_UNLIKELY( sizeof(ulong)!=getrandom( &funk_seed, sizeof(ulong), 0 ) ) )
+    { FD_LOG_WARNING(( "getrandom() failed (%d-%s)", errno, fd_io_strerror( errno ) )); return EXIT_FAILURE; }
+
+  ulong funk_tag = 42UL;
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), funk_tag ), funk_tag, funk_seed, 16UL, args->rec_max ) );
+  if( FD_UNLIKELY( !funk ) ) { FD_LOG_WARNING(( "Failed to create fd_funk_t" )); return EXIT_FAILURE; }
+
+  fd_acc_mgr_t * acc_mgr = fd_acc_mgr_new( fd_scratch_alloc( FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT ), funk );
+  fd_snapshot_restore_t * restore = fd_snapshot_restore_new(
+      fd_scratch_alloc( fd_snapshot_restore_align(), fd_snapshot_restore_footprint() ),
+      acc_mgr, NULL, valloc, &valloc, fd_snapshot_bench_on_manifest, NULL );
+  if( FD_UNLIKELY( !acc_mgr || !restore ) ) { FD_LOG_WARNING(( "Failed to create fd_snapshot_restore_t" )); return EXIT_FAILURE; }
+
+  ulong worker_cnt = args->serial ? 1UL : fd_tile_cnt();
+  FD_LOG_NOTICE(( "Loading %s (%.3f GB) with %lu %s",
+                  args->snapshot, (double)st.st_size*1e-9, worker_cnt, args->serial ? "thread (fd_snapshot_loader)" : "workers (fd_snapshot_par)" ));
+
+  fd_snapshot_par_stats_t stats[1] = {0};
+  int err;
+  fd_funk_start_write( funk );
+  if( args->serial ) {
+    long dt = -fd_log_wallclock();
+    err = bench_serial( args, restore, &stats->manifest_ns );
+    dt += fd_log_wallclock();
+    stats->load_ns = dt;
+    stats->in_sz   = (ulong)st.st_size;
+  } else {
+    static uchar tpool_mem[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+    fd_tpool_t * tpool = NULL;
+    if( worker_cnt>1UL ) {
+      tpool = fd_tpool_init( tpool_mem, worker_cnt );
+      if( FD_UNLIKELY( !tpool ) ) FD_LOG_ERR(( "fd_tpool_init() failed" ));
+      for( ulong i=1UL; i<worker_cnt; i++ )
+        if( FD_UNLIKELY( !fd_tpool_worker_push( tpool, i, NULL, 0UL ) ) ) FD_LOG_ERR(( "fd_tpool_worker_push() failed" ));
+    }
+
+    ulong footprint = fd_snapshot_par_footprint( worker_cnt, args->zstd_window_sz, args->out_sz, args->frame_max, args->accv_max );
+    if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "Invalid --out-sz, --frame-max, or --accv-max" ));
+    void * par_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_par_align(), footprint, 1UL );
+    if( FD_UNLIKELY( !par_mem ) ) FD_LOG_ERR(( "Failed to allocate %lu bytes for fd_snapshot_par_t", footprint ));
+    fd_snapshot_par_t * par = fd_snapshot_par_new( par_mem, tpool, worker_cnt, args->zstd_window_sz, args->out_sz, args->frame_max, args->accv_max );
+    if( FD_UNLIKELY( !par ) ) FD_LOG_ERR(( "fd_snapshot_par_new() failed" ));
+
+    err = fd_snapshot_par_load( par, restore, args->snapshot, stats );
+
+    fd_wksp_free_laddr( fd_snapshot_par_delete( par ) );
+    if( tpool ) fd_tpool_fini( tpool );
+  }
+  fd_funk_end_write( funk );
+
+  if( FD_UNLIKELY( err ) ) {
+    FD_LOG_WARNING(( "Failed to load snapshot (%d-%s)", err, fd_io_strerror( err ) ));
+    return EXIT_FAILURE;
+  }
+
+  double load_s = (double)stats->load_ns*1e-9;
+  FD_LOG_NOTICE(( "Loaded %lu records in %.3f s", fd_funk_rec_cnt( fd_funk_rec_map( funk, wksp ) ), load_s ));
+  FD_LOG_NOTICE(( "time-to-manifest      %10.3f s", (double)stats->manifest_ns*1e-9 ));
+  FD_LOG_NOTICE(( "time-to-first-replay  %10.3f s", load_s ));
+  FD_LOG_NOTICE(( "compressed            %10.3f GB/s", (double)stats->in_sz /(double)stats->load_ns ));
+  if( !args->serial ) {
+    FD_LOG_NOTICE(( "decompressed          %10.3f GB/s", (double)stats->out_sz/(double)stats->load_ns ));
+    FD_LOG_NOTICE(( "%lu frames in %lu batches, %lu account vecs (%.3f GB gathered), %lu accounts written, %lu skipped",
+                    stats->frame_cnt, stats->batch_cnt, stats->accv_cnt, (double)stats->gather_sz*1e-9, stats->acc_cnt, stats->acc_skip_cnt ));
+  }
+
+  fd_snapshot_restore_delete( restore );
+  fd_acc_mgr_delete( acc_mgr );
+  fd_wksp_free_laddr( fd_funk_delete( fd_funk_leave( funk ) ) );
+  fd_wksp_free_laddr( fd_alloc_delete( fd_alloc_leave( alloc ) ) );
+  return EXIT_SUCCESS;
+}
+
+int
+cmd_bench( int     argc,
+           char ** argv ) {
+
+  fd_snapshot_bench_args_t args[1] = {{0}};
+  args->_page_sz       = fd_env_strip_cmdline_cstr  ( &argc, &argv, "--page-sz",        NULL,      "gigantic" );
+  args->page_cnt       = fd_env_strip_cmdline_ulong ( &argc, &argv, "--page-cnt",       NULL,           128UL );
+  args->near_cpu       = fd_env_strip_cmdline_ulong ( &argc, &argv, "--near-cpu",       NULL, fd_log_cpu_id() );
+  args->zstd_window_sz = fd_env_strip_cmdline_ulong ( &argc, &argv, "--zstd-window-sz", NULL,      33554432UL );
+  args->snapshot       = (char *)fd_env_strip_cmdline_cstr( &argc, &argv, "--snapshot", NULL, NULL );
+  args->rec_max        = fd_env_strip_cmdline_ulong ( &argc, &argv, "--rec-max",        NULL,       1UL<<28   );
+  args->out_sz         = fd_env_strip_cmdline_ulong ( &argc, &argv, "--out-sz",         NULL,       1UL<<26   );
+  args->frame_max      = fd_env_strip_cmdline_ulong ( &argc, &argv, "--frame-max",      NULL,         65536UL );
+  args->accv_max       = fd_env_strip_cmdline_ulong ( &argc, &argv, "--accv-max",       NULL,         65536UL );
+  args->serial         = fd_env_strip_cmdline_int   ( &argc, &argv, "--serial",         NULL,               0 );
+
+  if( FD_UNLIKELY( argc!=1 ) )
+    FD_LOG_ERR(( "Unexpected command-line arguments" ));
+  if( FD_UNLIKELY( !args->snapshot ) )
+    FD_LOG_ERR(( "Missing --snapshot argument" ));
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-cnt %lu, --page-sz %s)", args->page_cnt, args->_page_sz ));
+
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( args->_page_sz ), args->page_cnt, args->near_cpu, "wksp", 0UL );
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_new_anonymous() failed" ));
+
+  ulong smax = args->zstd_window_sz + (1<<29);  /* manifest plus 512 MiB headroom */
+  uchar * smem = fd_wksp_alloc_laddr( wksp, FD_SCRATCH_SMEM_ALIGN, smax, 1UL );
+  if( FD_UNLIKELY( !smem ) ) FD_LOG_ERR(( "fd_wksp_alloc_laddr for scratch region of size %lu failed", smax ));
+  ulong fmem[16];
+  fd_scratch_attach( smem, fmem, smax, 16UL );
+  fd_scratch_push();
+
+  int rc = do_bench( args, wksp );
+
+  fd_scratch_pop();
+  fd_scratch_detach( NULL );
+  fd_wksp_delete_anonymous( wksp );
+  return rc;
+}
+
 FD_IMPORT_CSTR( _help, "src/flamenco/snapshot/fd_snapshot_help.txt" );
 
 __attribute__((noreturn)) static int
@@ -495,6 +689,8 @@ main( int     argc,
 
   if( 0==strcmp( cmd, "dump" ) ) {
     return cmd_dump( argc, argv );
+  } else if( 0==strcmp( cmd, "bench" ) ) {
+    return cmd_bench( argc, argv );
   } else {
     fprintf( stderr, "Unknown command: %s\n", cmd );
     return usage(1);
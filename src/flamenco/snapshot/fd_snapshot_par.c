@@ -0,0 +1,875 @@
+#include "fd_snapshot_par.h"
+#include "fd_snapshot_restore_private.h"
+#include "../runtime/fd_acc_mgr.h"
+#include "../../ballet/zstd/fd_zstd.h"
+#include "../../util/archive/fd_tar.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>     /* sscanf */
+#include <string.h>    /* strncmp */
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FD_SNAPSHOT_PAR_MAGIC (0x5ea7ba7a110ad000UL) /* random */
+
+/* FRAME_{...} are the decompression states of a Zstandard frame. */
+
+#define FRAME_PENDING  (0)
+#define FRAME_DONE     (1)  /* decompressed into a worker buffer */
+#define FRAME_OVERFLOW (2)  /* worker buffer full, retry next batch */
+#define FRAME_TOO_BIG  (3)  /* does not fit an empty worker buffer */
+#define FRAME_ERR      (4)  /* corrupt frame */
+
+/* FILE_{...} control what happens with the content of the current TAR
+   file. */
+
+#define FILE_IGNORE  (0)
+#define FILE_RESTORE (1)  /* forward to fd_snapshot_restore */
+#define FILE_ACCV    (2)  /* account vec */
+
+/* PHASE_{...} select the job run by the workers. */
+
+#define PHASE_DECOMPRESS (0)
+#define PHASE_COUNT      (1)
+#define PHASE_SCATTER    (2)
+#define PHASE_INSERT     (3)
+#define PHASE_PIPELINE   (4)  /* insert, then decompress the next batch */
+
+struct fd_snapshot_par_frame {
+  uchar const * in;
+  ulong         in_sz;
+  uchar const * out;
+  ulong         out_sz;
+  int           state;
+};
+
+typedef struct fd_snapshot_par_frame fd_snapshot_par_frame_t;
+
+/* fd_snapshot_par_accv_t is a complete account vec.  data points
+   either into a worker's frame buffer or to gather (heap). */
+
+struct fd_snapshot_par_accv {
+  uchar const * data;
+  ulong         sz;
+  ulong         slot;
+  uchar *       gather;
+};
+
+typedef struct fd_snapshot_par_accv fd_snapshot_par_accv_t;
+
+struct fd_snapshot_par_acc {
+  fd_solana_account_hdr_t const * hdr;
+  ulong                           slot;
+};
+
+typedef struct fd_snapshot_par_acc fd_snapshot_par_acc_t;
+
+struct fd_snapshot_par_worker {
+  fd_zstd_dstream_t * dstream;
+  uchar *             buf[2];   /* decompressed frame buffers, alternating per batch */
+  uchar *             out;      /* buffer of the batch being decompressed */
+  uchar *             out_cur;  /* next free byte in out */
+
+  ulong               accv0;    /* account vecs [accv0,accv1) are indexed by this worker */
+  ulong               accv1;
+  ulong *             cnt;      /* cnt[d] is the number of accounts destined for worker d */
+  ulong *             off;      /* off[d] is the scatter cursor for worker d */
+
+  int                 err;
+  ulong               acc_cnt;
+  ulong               acc_skip_cnt;
+};
+
+typedef struct fd_snapshot_par_worker fd_snapshot_par_worker_t;
+
+struct __attribute__((aligned(FD_SNAPSHOT_PAR_ALIGN))) fd_snapshot_par {
+  ulong                      magic;
+
+  fd_tpool_t *               tpool;
+  ulong                      worker_cnt;
+  ulong                      out_sz;
+  ulong                      frame_max;
+  ulong                      accv_max;
+  int                        phase;
+  ulong                      buf_idx;     /* frame buffer of the batch being decompressed */
+  long                       t0;          /* wallclock at start of load */
+
+  /* Memory mapped snapshot */
+
+  uchar const *              in;
+  ulong                      in_sz;
+  ulong                      in_off;      /* offset of first unconsumed frame */
+
+  /* Frames of the current batch */
+
+  fd_snapshot_par_frame_t *  frame;       /* indexed [0,frame_max) */
+  ulong                      frame_cnt;
+  ulong                      frame_next;  /* next frame to claim, atomic */
+  ulong                      frame_stop;  /* don't claim frames at or past this idx, atomic */
+
+  /* TAR stream */
+
+  fd_snapshot_restore_t *    restore;
+  fd_tar_reader_t            tar[1];
+  int                        tar_eof;
+  int                        file_state;
+  fd_snapshot_par_accv_t     accv_cur;    /* account vec being read */
+  ulong                      accv_got;    /* bytes of accv_cur gathered */
+
+  /* Account vecs pending insert */
+
+  fd_snapshot_par_accv_t *   accv;        /* indexed [0,accv_max) */
+  ulong                      accv_cnt;
+  fd_snapshot_par_acc_t *    acc;         /* heap, bucketed by destination worker */
+  ulong *                    acc_start;   /* indexed [0,worker_cnt], bucket bounds */
+
+  fd_snapshot_par_worker_t * worker;      /* indexed [0,worker_cnt) */
+
+  fd_snapshot_par_stats_t    stats;
+};
+
+ulong
+fd_snapshot_par_align( void ) {
+  return FD_SNAPSHOT_PAR_ALIGN;
+}
+
+ulong
+fd_snapshot_par_footprint( ulong worker_cnt,
+                           ulong zstd_window_sz,
+                           ulong out_sz,
+                           ulong frame_max,
+                           ulong accv_max ) {
+
+  if( FD_UNLIKELY( (!worker_cnt) | (worker_cnt>FD_TILE_MAX) | (!zstd_window_sz) |
+                   (!out_sz) | (!frame_max) | (!accv_max) ) )
+    return 0UL;
+
+  ulong l = FD_LAYOUT_INIT;
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_par_t),        sizeof(fd_snapshot_par_t)                   );
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_par_worker_t), worker_cnt*sizeof(fd_snapshot_par_worker_t) );
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_par_frame_t),  frame_max *sizeof(fd_snapshot_par_frame_t)  );
+  l = FD_LAYOUT_APPEND( l, alignof(fd_snapshot_par_accv_t),   accv_max  *sizeof(fd_snapshot_par_accv_t)   );
+  l = FD_LAYOUT_APPEND( l, alignof(ulong),                    (worker_cnt+1UL)*sizeof(ulong)              );
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    l = FD_LAYOUT_APPEND( l, fd_zstd_dstream_align(), fd_zstd_dstream_footprint( zstd_window_sz ) );
+    l = FD_LAYOUT_APPEND( l, 64UL,                    out_sz                                      );
+    l = FD_LAYOUT_APPEND( l, 64UL,                    out_sz                                      );
+    l = FD_LAYOUT_APPEND( l, alignof(ulong),          2UL*worker_cnt*sizeof(ulong)                );
+  }
+  return FD_LAYOUT_FINI( l, fd_snapshot_par_align() );
+}
+
+fd_snapshot_par_t *
+fd_snapshot_par_new( void *       mem,
+                     fd_tpool_t * tpool,
+                     ulong        worker_cnt,
+                     ulong        zstd_window_sz,
+                     ulong        out_sz,
+                     ulong        frame_max,
+                     ulong        accv_max ) {
+
+  if( FD_UNLIKELY( !mem ) ) {
+    FD_LOG_WARNING(( "NULL mem" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)mem, fd_snapshot_par_align() ) ) ) {
+    FD_LOG_WARNING(( "unaligned mem" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( !fd_snapshot_par_footprint( worker_cnt, zstd_window_sz, out_sz, frame_max, accv_max ) ) ) {
+    FD_LOG_WARNING(( "invalid params" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( (worker_cnt>1UL) && ( !tpool || fd_tpool_worker_cnt( tpool )<worker_cnt ) ) ) {
+    FD_LOG_WARNING(( "worker_cnt %lu exceeds tpool worker cnt", worker_cnt ));
+    return NULL;
+  }
+
+  FD_SCRATCH_ALLOC_INIT( l, mem );
+  fd_snapshot_par_t *        par    = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_par_t),        sizeof(fd_snapshot_par_t)                   );
+  fd_snapshot_par_worker_t * worker = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_par_worker_t), worker_cnt*sizeof(fd_snapshot_par_worker_t) );
+  fd_snapshot_par_frame_t *  frame  = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_par_frame_t),  frame_max *sizeof(fd_snapshot_par_frame_t)  );
+  fd_snapshot_par_accv_t *   accv   = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_snapshot_par_accv_t),   accv_max  *sizeof(fd_snapshot_par_accv_t)   );
+  ulong *                    start  = FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong),                    (worker_cnt+1UL)*sizeof(ulong)              );
+
+  memset( par, 0, sizeof(fd_snapshot_par_t) );
+  par->tpool      = tpool;
+  par->worker_cnt = worker_cnt;
+  par->out_sz     = out_sz;
+  par->frame_max  = frame_max;
+  par->accv_max   = accv_max;
+  par->frame      = frame;
+  par->accv       = accv;
+  par->acc_start  = start;
+  par->worker     = worker;
+
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    fd_snapshot_par_worker_t * w = worker + i;
+    memset( w, 0, sizeof(fd_snapshot_par_worker_t) );
+    void * dstream_mem = FD_SCRATCH_ALLOC_APPEND( l, fd_zstd_dstream_align(), fd_zstd_dstream_footprint( zstd_window_sz ) );
+    w->buf[0]          = FD_SCRATCH_ALLOC_APPEND( l, 64UL,                    out_sz                                      );
+    w->buf[1]          = FD_SCRATCH_ALLOC_APPEND( l, 64UL,                    out_sz                                      );
+    w->cnt             = FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong),          2UL*worker_cnt*sizeof(ulong)                );
+    w->off             = w->cnt + worker_cnt;
+    w->out             = w->buf[0];
+    w->out_cur         = w->out;
+    w->dstream         = fd_zstd_dstream_new( dstream_mem, zstd_window_sz );
+    if( FD_UNLIKELY( !w->dstream ) ) return NULL;
+  }
+  FD_SCRATCH_ALLOC_FINI( l, fd_snapshot_par_align() );
+
+  FD_COMPILER_MFENCE();
+  par->magic = FD_SNAPSHOT_PAR_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return par;
+}
+
+void *
+fd_snapshot_par_delete( fd_snapshot_par_t * par ) {
+
+  if( FD_UNLIKELY( !par ) ) return NULL;
+
+  if( FD_UNLIKELY( par->magic!=FD_SNAPSHOT_PAR_MAGIC ) ) {
+    FD_LOG_WARNING(( "invalid magic" ));
+    return NULL;
+  }
+
+  for( ulong i=0UL; i<par->worker_cnt; i++ )
+    fd_zstd_dstream_delete( par->worker[i].dstream );
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( par->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return (void *)par;
+}
+
+/* Decompress *********************************************************/
+
+/* fd_snapshot_par_decompress claims frames of the current batch in
+   stream order and decompresses them into the worker's buffer until
+   the buffer is full.  If a frame does not fit, the batch is cut off
+   at that frame (frame_stop) and the frame is retried in the next
+   batch.  Frames past frame_stop decompressed by other workers in the
+   meantime are discarded. */
+
+static void
+fd_snapshot_par_decompress( fd_snapshot_par_t *        par,
+                            fd_snapshot_par_worker_t * w ) {
+
+  uchar * out_end = w->out + par->out_sz;
+
+  for(;;) {
+    ulong idx = FD_ATOMIC_FETCH_AND_ADD( &par->frame_next, 1UL );
+    if( (idx>=par->frame_cnt) | (idx>=FD_VOLATILE_CONST( par->frame_stop )) ) break;
+
+    fd_snapshot_par_frame_t * frame = par->frame + idx;
+
+    uchar *       out0    = (uchar *)fd_ulong_min( fd_ulong_align_up( (ulong)w->out_cur, 64UL ), (ulong)out_end );
+    uchar *       out_cur = out0;
+    uchar const * in_cur  = frame->in;
+    uchar const * in_end  = frame->in + frame->in_sz;
+
+    fd_zstd_dstream_reset( w->dstream );
+    int state = FRAME_DONE;
+    for(;;) {
+      uchar const * in_prev  = in_cur;
+      uchar *       out_prev = out_cur;
+      int rc = fd_zstd_dstream_read( w->dstream, &in_cur, in_end, &out_cur, out_end, NULL );
+      if( rc==-1 ) break;
+      if( FD_UNLIKELY( rc ) ) { state = FRAME_ERR; break; }
+      if( (in_cur==in_prev) & (out_cur==out_prev) ) {
+        if( out_cur==out_end ) state = (out0==w->out) ? FRAME_TOO_BIG : FRAME_OVERFLOW;
+        else                   state = FRAME_ERR;  /* truncated */
+        break;
+      }
+    }
+    if( FD_UNLIKELY( (state==FRAME_DONE) & (in_cur!=in_end) ) ) state = FRAME_ERR;
+
+    frame->state = state;
+    if( FD_UNLIKELY( state!=FRAME_DONE ) ) {
+      ulong stop = FD_VOLATILE_CONST( par->frame_stop );
+      while( idx<stop ) {
+        ulong prev = FD_ATOMIC_CAS( &par->frame_stop, stop, idx );
+        if( prev==stop ) break;
+        stop = prev;
+      }
+      break;
+    }
+
+    frame->out    = out0;
+    frame->out_sz = (ulong)( out_cur-out0 );
+    w->out_cur    = out_cur;
+  }
+}
+
+/* Index and insert ***************************************************/
+
+static inline ulong
+fd_snapshot_par_acc_dst( fd_solana_account_hdr_t const * hdr,
+                         ulong                           worker_cnt ) {
+  return fd_ulong_hash( FD_LOAD( ulong, hdr->meta.pubkey ) ) % worker_cnt;
+}
+
+/* fd_snapshot_par_accv_walk walks the account headers of the worker's
+   account vecs.  Counts accounts per destination worker (scatter==0)
+   or writes them to their destination buckets (scatter==1).  Follows
+   the validation rules of the serial restore. */
+
+static int
+fd_snapshot_par_accv_walk( fd_snapshot_par_t *        par,
+                           fd_snapshot_par_worker_t * w,
+                           int                        scatter ) {
+
+  ulong worker_cnt = par->worker_cnt;
+
+  for( ulong j=w->accv0; j<w->accv1; j++ ) {
+    fd_snapshot_par_accv_t const * accv = par->accv + j;
+    ulong off = 0UL;
+    while( off<accv->sz ) {
+      if( FD_UNLIKELY( accv->sz-off < sizeof(fd_solana_account_hdr_t) ) ) {
+        FD_LOG_WARNING(( "encountered unexpected EOF while reading account header" ));
+        return EINVAL;
+      }
+      fd_solana_account_hdr_t const * hdr = fd_type_pun_const( accv->data + off );
+      ulong data_sz = hdr->meta.data_len;
+      if( FD_UNLIKELY( data_sz > FD_ACC_SZ_MAX ) ) {
+        FD_LOG_WARNING(( "accounts/%lu: account too large: data_len=%lu", accv->slot, data_sz ));
+        return EINVAL;
+      }
+      off += sizeof(fd_solana_account_hdr_t);
+      if( FD_UNLIKELY( data_sz > accv->sz-off ) ) {
+        FD_LOG_WARNING(( "accounts/%lu: account data exceeds past end of account vec (acc_sz=%lu accv_sz=%lu)",
+                         accv->slot, data_sz, accv->sz-off ));
+        return EINVAL;
+      }
+      off += data_sz;
+      off += fd_ulong_min( fd_ulong_align_up( data_sz, FD_SNAPSHOT_ACC_ALIGN ) - data_sz, accv->sz-off );
+
+      ulong d = fd_snapshot_par_acc_dst( hdr, worker_cnt );
+      if( scatter ) par->acc[ w->off[ d ]++ ] = (fd_snapshot_par_acc_t){ .hdr = hdr, .slot = accv->slot };
+      else          w->cnt[ d ]++;
+    }
+  }
+  return 0;
+}
+
+/* fd_snapshot_par_insert writes the accounts of the worker's bucket
+   into funk.  Mirrors fd_snapshot_restore_account_hdr. */
+
+static int
+fd_snapshot_par_insert( fd_snapshot_par_t *        par,
+                        fd_snapshot_par_worker_t * w,
+                        ulong                      worker_idx ) {
+
+  fd_acc_mgr_t *  acc_mgr  = par->restore->acc_mgr;
+  fd_funk_txn_t * funk_txn = par->restore->funk_txn;
+  fd_funk_t *     funk     = acc_mgr->funk;
+  fd_wksp_t *     wksp     = fd_funk_wksp( funk );
+
+  ulong acc1 = par->acc_start[ worker_idx+1UL ];
+  for( ulong i=par->acc_start[ worker_idx ]; i<acc1; i++ ) {
+    fd_solana_account_hdr_t const * hdr  = par->acc[ i ].hdr;
+    ulong                           slot = par->acc[ i ].slot;
+    fd_pubkey_t const *             key  = fd_type_pun_const( hdr->meta.pubkey );
+
+    fd_funk_rec_t const *     irec = NULL;
+    fd_account_meta_t const * prev = fd_acc_mgr_view_raw( acc_mgr, funk_txn, key, &irec, NULL );
+    if( prev && prev->slot > slot ) {
+      w->acc_skip_cnt++;
+      continue;
+    }
+
+    ulong             data_sz = hdr->meta.data_len;
+    fd_funk_rec_key_t id      = fd_acc_funk_key( key );
+    int               funk_err;
+    fd_funk_rec_t *   rec     = fd_funk_rec_write_prepare_concur( funk, funk_txn, &id, sizeof(fd_account_meta_t)+data_sz, 1, irec, &funk_err );
+    if( FD_UNLIKELY( !rec ) ) {
+      FD_LOG_WARNING(( "fd_funk_rec_write_prepare_concur failed (%i-%s)", funk_err, fd_funk_strerror( funk_err ) ));
+      return ENOMEM;
+    }
+
+    fd_account_meta_t * meta = fd_funk_val( rec, wksp );
+    if( !meta->magic ) fd_account_meta_init( meta );
+    if( FD_UNLIKELY( meta->magic!=FD_ACCOUNT_META_MAGIC ) ) {
+      FD_LOG_WARNING(( "bad account meta magic" ));
+      return EINVAL;
+    }
+    meta->dlen = data_sz;
+    meta->slot = slot;
+    memcpy( &meta->hash, hdr->hash.uc, 32UL );
+    memcpy( &meta->info, &hdr->info, sizeof(fd_solana_account_meta_t) );
+    fd_memcpy( (uchar *)meta + meta->hlen, hdr+1, data_sz );
+    w->acc_cnt++;
+  }
+  return 0;
+}
+
+static void
+fd_snapshot_par_task( void * tpool,
+                      ulong  t0     FD_PARAM_UNUSED, ulong t1     FD_PARAM_UNUSED,
+                      void * args   FD_PARAM_UNUSED,
+                      void * reduce FD_PARAM_UNUSED, ulong stride FD_PARAM_UNUSED,
+                      ulong  l0     FD_PARAM_UNUSED, ulong l1     FD_PARAM_UNUSED,
+                      ulong  m0,                     ulong m1     FD_PARAM_UNUSED,
+                      ulong  n0     FD_PARAM_UNUSED, ulong n1     FD_PARAM_UNUSED ) {
+  fd_snapshot_par_t *        par = (fd_snapshot_par_t *)tpool;
+  fd_snapshot_par_worker_t * w   = par->worker + m0;
+  switch( par->phase ) {
+  case PHASE_DECOMPRESS: fd_snapshot_par_decompress( par, w );                   break;
+  case PHASE_COUNT:      w->err = fd_snapshot_par_accv_walk( par, w, 0 );        break;
+  case PHASE_SCATTER:    w->err = fd_snapshot_par_accv_walk( par, w, 1 );        break;
+  case PHASE_INSERT:     w->err = fd_snapshot_par_insert( par, w, m0 );          break;
+  case PHASE_PIPELINE:
+    w->err = fd_snapshot_par_insert( par, w, m0 );
+    fd_snapshot_par_decompress( par, w );
+    break;
+  default:               __builtin_unreachable();
+  }
+}
+
+/* fd_snapshot_par_exec runs the given phase on all workers and waits
+   for completion.  Returns the first worker error. */
+
+static int
+fd_snapshot_par_exec( fd_snapshot_par_t * par,
+                      int                 phase ) {
+  ulong worker_cnt = par->worker_cnt;
+  par->phase = phase;
+  for( ulong i=0UL; i<worker_cnt; i++ ) par->worker[i].err = 0;
+
+  for( ulong i=1UL; i<worker_cnt; i++ )
+    fd_tpool_exec( par->tpool, i, fd_snapshot_par_task, par, 0UL, 0UL, NULL, NULL, 0UL, 0UL, 0UL, i, i+1UL, 0UL, 0UL );
+  fd_snapshot_par_task( par, 0UL, 0UL, NULL, NULL, 0UL, 0UL, 0UL, 0UL, 1UL, 0UL, 0UL );
+  for( ulong i=1UL; i<worker_cnt; i++ )
+    fd_tpool_wait( par->tpool, i );
+
+  for( ulong i=0UL; i<worker_cnt; i++ )
+    if( FD_UNLIKELY( par->worker[i].err ) ) return par->worker[i].err;
+  return 0;
+}
+
+/* fd_snapshot_par_release frees the gather buffers of all pending
+   account vecs. */
+
+static void
+fd_snapshot_par_release( fd_snapshot_par_t * par ) {
+  fd_valloc_t valloc = par->restore->valloc;
+  for( ulong j=0UL; j<par->accv_cnt; j++ ) fd_valloc_free( valloc, par->accv[ j ].gather );
+  par->accv_cnt = 0UL;
+}
+
+/* fd_snapshot_par_index buckets the accounts of all pending account
+   vecs by destination worker.  On success, the accounts are ready for
+   PHASE_INSERT.  fd_snapshot_par_retire frees the index. */
+
+static int
+fd_snapshot_par_index( fd_snapshot_par_t * par ) {
+
+  ulong accv_cnt   = par->accv_cnt;
+  ulong worker_cnt = par->worker_cnt;
+  if( !accv_cnt ) {
+    memset( par->acc_start, 0, (worker_cnt+1UL)*sizeof(ulong) );
+    return 0;
+  }
+
+  /* Split account vecs into contiguous ranges of similar byte size */
+
+  ulong tot_sz = 0UL;
+  for( ulong j=0UL; j<accv_cnt; j++ ) tot_sz += par->accv[ j ].sz;
+
+  ulong j = 0UL, cum_sz = 0UL;
+  for( ulong i=0UL; i<worker_cnt; i++ ) {
+    fd_snapshot_par_worker_t * w = par->worker + i;
+    ulong target = (i+1UL==worker_cnt) ? ULONG_MAX : (tot_sz/worker_cnt)*(i+1UL);
+    w->accv0 = j;
+    while( (j<accv_cnt) && (cum_sz<target) ) cum_sz += par->accv[ j++ ].sz;
+    w->accv1 = j;
+    memset( w->cnt, 0, worker_cnt*sizeof(ulong) );
+  }
+
+  int err = fd_snapshot_par_exec( par, PHASE_COUNT );
+  if( FD_UNLIKELY( err ) ) return err;
+
+  /* Lay out buckets by destination worker, sources in stream order */
+
+  ulong acc_cnt = 0UL;
+  for( ulong d=0UL; d<worker_cnt; d++ ) {
+    par->acc_start[ d ] = acc_cnt;
+    for( ulong i=0UL; i<worker_cnt; i++ ) {
+      par->worker[ i ].off[ d ] = acc_cnt;
+      acc_cnt += par->worker[ i ].cnt[ d ];
+    }
+  }
+  par->acc_start[ worker_cnt ] = acc_cnt;
+  if( !acc_cnt ) return 0;
+
+  par->acc = fd_valloc_malloc( par->restore->valloc, alignof(fd_snapshot_par_acc_t), acc_cnt*sizeof(fd_snapshot_par_acc_t) );
+  if( FD_UNLIKELY( !par->acc ) ) {
+    FD_LOG_WARNING(( "failed to allocate index for %lu accounts", acc_cnt ));
+    return ENOMEM;
+  }
+  return fd_snapshot_par_exec( par, PHASE_SCATTER );
+}
+
+/* fd_snapshot_par_retire frees the account index and the pending
+   account vecs once they were inserted (or on failure). */
+
+static void
+fd_snapshot_par_retire( fd_snapshot_par_t * par ) {
+  fd_valloc_free( par->restore->valloc, par->acc );
+  par->acc             = NULL;
+  par->stats.accv_cnt += par->accv_cnt;
+  fd_snapshot_par_release( par );
+}
+
+/* fd_snapshot_par_flush inserts all pending account vecs into funk. */
+
+static int
+fd_snapshot_par_flush( fd_snapshot_par_t * par ) {
+  int err = fd_snapshot_par_index( par );
+  if( FD_LIKELY( !err ) ) err = fd_snapshot_par_exec( par, PHASE_INSERT );
+  fd_snapshot_par_retire( par );
+  return err;
+}
+
+/* TAR callbacks ******************************************************/
+
+static int
+fd_snapshot_par_accv_push( fd_snapshot_par_t * par ) {
+  par->accv[ par->accv_cnt++ ] = par->accv_cur;
+  memset( &par->accv_cur, 0, sizeof(fd_snapshot_par_accv_t) );
+  par->accv_got   = 0UL;
+  par->file_state = FILE_IGNORE;
+  return 0;
+}
+
+static int
+fd_snapshot_par_file( void *                par_,
+                      fd_tar_meta_t const * meta,
+                      ulong                 sz ) {
+
+  fd_snapshot_par_t *     par     = par_;
+  fd_snapshot_restore_t * restore = par->restore;
+
+  par->file_state = FILE_IGNORE;
+  fd_valloc_free( restore->valloc, par->accv_cur.gather );  /* truncated account vec */
+  memset( &par->accv_cur, 0, sizeof(fd_snapshot_par_accv_t) );
+  par->accv_got = 0UL;
+
+  if( 0!=strncmp( meta->name, "accounts/", sizeof("accounts/")-1 ) ) {
+    par->file_state = FILE_RESTORE;
+    return fd_snapshot_restore_file( restore, meta, sz );
+  }
+
+  if( (sz==0UL) | (!fd_tar_meta_is_reg( meta )) ) return 0;
+
+  if( FD_UNLIKELY( !restore->manifest_done ) ) {
+    FD_LOG_WARNING(( "Unsupported snapshot: encountered AppendVec before manifest" ));
+    return EINVAL;
+  }
+
+  ulong id, slot;
+  if( FD_UNLIKELY( sscanf( meta->name, "accounts/%lu.%lu", &slot, &id )!=2 ) ) return 0;
+
+  if( FD_UNLIKELY( slot > restore->slot ) ) {
+    FD_LOG_WARNING(( "%s has slot number %lu, which exceeds bank slot number %lu",
+                     meta->name, slot, restore->slot ));
+    return EINVAL;
+  }
+
+  fd_snapshot_accv_key_t key = { .slot = slot, .id = id };
+  fd_snapshot_accv_map_t * rec = fd_snapshot_accv_map_query( restore->accv_map, key, NULL );
+  if( FD_UNLIKELY( !rec ) ) {
+    FD_LOG_DEBUG(( "Ignoring %s (sz %lu)", meta->name, sz ));
+    return 0;
+  }
+  if( FD_UNLIKELY( rec->sz > sz ) ) {
+    FD_LOG_WARNING(( "AppendVec %lu.%lu is %lu bytes long according to manifest, but actually only %lu bytes",
+                     slot, id, rec->sz, sz ));
+    return EINVAL;
+  }
+  if( !rec->sz ) return 0;
+
+  if( par->accv_cnt==par->accv_max ) {
+    int err = fd_snapshot_par_flush( par );
+    if( FD_UNLIKELY( err ) ) return err;
+  }
+
+  par->accv_cur.slot = slot;
+  par->accv_cur.sz   = rec->sz;
+  par->file_state    = FILE_ACCV;
+  return 0;
+}
+
+static int
+fd_snapshot_par_read( void *       par_,
+                      void const * buf,
+                      ulong        bufsz ) {
+
+  fd_snapshot_par_t * par = par_;
+
+  switch( par->file_state ) {
+  case FILE_IGNORE:
+    return 0;
+  case FILE_RESTORE: {
+    int err = fd_snapshot_restore_chunk( par->restore, buf, bufsz );
+    if( (!par->stats.manifest_ns) & par->restore->manifest_done )
+      par->stats.manifest_ns = fd_log_wallclock() - par->t0;
+    return err;
+  }
+  case FILE_ACCV:
+    break;
+  default:
+    __builtin_unreachable();
+  }
+
+  fd_snapshot_par_accv_t * accv = &par->accv_cur;
+
+  /* Account vec contained in this chunk.  fd_tar_read passes chunks
+     that point into the frame buffer, which outlives the account vec
+     (pending account vecs are inserted before the buffer is reused two
+     batches later). */
+
+  if( (!par->accv_got) & (bufsz>=accv->sz) ) {
+    accv->data = buf;
+    return fd_snapshot_par_accv_push( par );
+  }
+
+  /* Account vec spans multiple chunks */
+
+  if( !accv->gather ) {
+    accv->gather = fd_valloc_malloc( par->restore->valloc, FD_SNAPSHOT_ACC_ALIGN, accv->sz );
+    if( FD_UNLIKELY( !accv->gather ) ) {
+      FD_LOG_WARNING(( "failed to allocate %lu bytes for account vec", accv->sz ));
+      return ENOMEM;
+    }
+  }
+
+  ulong chunk_sz = fd_ulong_min( bufsz, accv->sz - par->accv_got );
+  fd_memcpy( accv->gather + par->accv_got, buf, chunk_sz );
+  par->accv_got        += chunk_sz;
+  par->stats.gather_sz += chunk_sz;
+
+  if( par->accv_got==accv->sz ) {
+    accv->data = accv->gather;
+    return fd_snapshot_par_accv_push( par );
+  }
+  return 0;
+}
+
+static fd_tar_read_vtable_t const fd_snapshot_par_tar_vt =
+  { .file = fd_snapshot_par_file,
+    .read = fd_snapshot_par_read };
+
+/* Main loop **********************************************************/
+
+/* fd_snapshot_par_scan splits the unconsumed part of the snapshot into
+   the frames of the next batch.  Stops once the batch could decompress
+   to more than the worker buffers can hold (assuming at least 1:1
+   compression ratio).
+
+   The search for the end of a frame is bounded by the worst case
+   compressed size of out_sz bytes (ZSTD_COMPRESSBOUND plus headroom).
+   A frame that is not found within that bound cannot fit a worker
+   buffer, which is detected without walking the whole frame.  (A
+   snapshot consisting of a single huge frame would otherwise have to
+   be paged in entirely just to find out it cannot be loaded.) */
+
+static int
+fd_snapshot_par_scan( fd_snapshot_par_t * par ) {
+
+  ulong off       = par->in_off;
+  ulong in_max    = par->worker_cnt * par->out_sz;
+  ulong in_cum    = 0UL;
+  ulong frame_max = par->out_sz + (par->out_sz>>8) + 65536UL;
+
+  par->frame_cnt = 0UL;
+  while( (par->frame_cnt<par->frame_max) & (off<par->in_sz) & (in_cum<in_max) ) {
+    ulong search_sz = fd_ulong_min( par->in_sz - off, frame_max );
+    ulong sz        = fd_zstd_frame_sz( par->in + off, search_sz );
+    if( FD_UNLIKELY( !sz ) ) {
+      if( par->frame_cnt ) break;  /* report error once reached */
+      if( search_sz < par->in_sz - off ) {
+        FD_LOG_WARNING(( "zstd frame at offset %lu is corrupt or decompresses to more than %lu bytes", off, par->out_sz ));
+        return EFBIG;
+      }
+      FD_LOG_WARNING(( "corrupt zstd frame at offset %lu", off ));
+      return EPROTO;
+    }
+    par->frame[ par->frame_cnt++ ] = (fd_snapshot_par_frame_t){ .in = par->in + off, .in_sz = sz, .state = FRAME_PENDING };
+    off    += sz;
+    in_cum += sz;
+  }
+  return 0;
+}
+
+/* fd_snapshot_par_prepare switches the workers to the other frame
+   buffer before the frames found by fd_snapshot_par_scan are
+   decompressed.  The previous buffer stays valid until the accounts
+   of the previous batch are inserted. */
+
+static void
+fd_snapshot_par_prepare( fd_snapshot_par_t * par ) {
+  par->buf_idx ^= 1UL;
+  for( ulong i=0UL; i<par->worker_cnt; i++ ) {
+    fd_snapshot_par_worker_t * w = par->worker + i;
+    w->out     = w->buf[ par->buf_idx ];
+    w->out_cur = w->out;
+  }
+  par->frame_next = 0UL;
+  par->frame_stop = par->frame_cnt;
+}
+
+/* fd_snapshot_par_untar feeds the decompressed frames of the current
+   batch through the TAR reader. */
+
+static int
+fd_snapshot_par_untar( fd_snapshot_par_t * par ) {
+
+  ulong done_cnt = 0UL;
+  while( (done_cnt<par->frame_cnt) && (par->frame[ done_cnt ].state==FRAME_DONE) ) done_cnt++;
+
+  if( FD_UNLIKELY( !done_cnt ) ) {
+    fd_snapshot_par_frame_t const * frame = par->frame;
+    if( frame->state==FRAME_TOO_BIG ) {
+      FD_LOG_WARNING(( "zstd frame at offset %lu decompresses to more than %lu bytes",
+                       (ulong)( frame->in - par->in ), par->out_sz ));
+      return EFBIG;
+    }
+    FD_LOG_WARNING(( "corrupt zstd frame at offset %lu", (ulong)( frame->in - par->in ) ));
+    return EPROTO;
+  }
+
+  par->stats.batch_cnt++;
+
+  for( ulong i=0UL; i<done_cnt; i++ ) {
+    fd_snapshot_par_frame_t const * frame = par->frame + i;
+    par->in_off          += frame->in_sz;
+    par->stats.in_sz     += frame->in_sz;
+    par->stats.out_sz    += frame->out_sz;
+    par->stats.frame_cnt += 1UL;
+    if( !frame->out_sz ) continue;
+
+    int err = fd_tar_read( par->tar, frame->out, frame->out_sz );
+    if( err==-1 ) { par->tar_eof = 1; break; }
+    if( FD_UNLIKELY( err ) ) return err;
+  }
+  return 0;
+}
+
+int
+fd_snapshot_par_load( fd_snapshot_par_t *       par,
+                      fd_snapshot_restore_t *   restore,
+                      char const *              path,
+                      fd_snapshot_par_stats_t * opt_stats ) {
+
+  if( opt_stats ) memset( opt_stats, 0, sizeof(fd_snapshot_par_stats_t) );
+
+  if( FD_UNLIKELY( restore->acc_mgr->slots_per_epoch ) ) {
+    /* Rent partitions are not maintained by concurrent inserts */
+    FD_LOG_WARNING(( "fd_snapshot_par_load requires an account manager without rent partitions" ));
+    return EINVAL;
+  }
+
+  long t0 = fd_log_wallclock();
+
+  int fd = open( path, O_RDONLY );
+  if( FD_UNLIKELY( fd<0 ) ) {
+    FD_LOG_WARNING(( "open(%s) failed (%d-%s)", path, errno, fd_io_strerror( errno ) ));
+    return errno;
+  }
+  struct stat st;
+  if( FD_UNLIKELY( 0!=fstat( fd, &st ) ) ) {
+    int err = errno;
+    FD_LOG_WARNING(( "fstat(%s) failed (%d-%s)", path, err, fd_io_strerror( err ) ));
+    close( fd );
+    return err;
+  }
+  if( FD_UNLIKELY( !st.st_size ) ) {
+    FD_LOG_WARNING(( "%s is empty", path ));
+    close( fd );
+    return EINVAL;
+  }
+  void * in = mmap( NULL, (ulong)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if( FD_UNLIKELY( in==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(%s) failed (%d-%s)", path, errno, fd_io_strerror( errno ) ));
+    return errno;
+  }
+  posix_madvise( in, (ulong)st.st_size, POSIX_MADV_SEQUENTIAL );
+
+  par->t0         = t0;
+  par->restore    = restore;
+  par->in         = in;
+  par->in_sz      = (ulong)st.st_size;
+  par->in_off     = 0UL;
+  par->tar_eof    = 0;
+  par->file_state = FILE_IGNORE;
+  par->accv_cnt   = 0UL;
+  par->accv_got   = 0UL;
+  memset( &par->accv_cur, 0, sizeof(fd_snapshot_par_accv_t) );
+  memset( &par->stats,    0, sizeof(fd_snapshot_par_stats_t) );
+  fd_tar_reader_new( par->tar, &fd_snapshot_par_tar_vt, par );
+
+  /* Decompression of the next batch overlaps with the insertion of the
+     accounts of the current one (PHASE_PIPELINE).  Workers that finish
+     their bucket early move on to decompress.  Untar and the account
+     index remain serialized between batches. */
+
+  int err = fd_snapshot_par_scan( par );
+  if( FD_LIKELY( !err ) ) {
+    fd_snapshot_par_prepare( par );
+    err = fd_snapshot_par_exec( par, PHASE_DECOMPRESS );
+  }
+  while( !err ) {
+    err = fd_snapshot_par_untar( par );
+    if( FD_UNLIKELY( err ) ) break;
+    err = fd_snapshot_par_index( par );
+    if( FD_UNLIKELY( err ) ) break;
+
+    int more = (!par->tar_eof) & (par->in_off<par->in_sz);
+    if( more ) {
+      err = fd_snapshot_par_scan( par );
+      if( FD_UNLIKELY( err ) ) break;
+      fd_snapshot_par_prepare( par );
+    }
+    err = fd_snapshot_par_exec( par, more ? PHASE_PIPELINE : PHASE_INSERT );
+    fd_snapshot_par_retire( par );
+    if( !more ) break;
+  }
+
+  fd_snapshot_par_retire( par );
+  fd_valloc_free( restore->valloc, par->accv_cur.gather );
+  memset( &par->accv_cur, 0, sizeof(fd_snapshot_par_accv_t) );
+  fd_tar_reader_delete( par->tar );
+  munmap( in, par->in_sz );
+  par->in      = NULL;
+  par->restore = NULL;
+
+  if( FD_LIKELY( !err ) ) {
+    for( ulong i=0UL; i<par->worker_cnt; i++ ) {
+      par->stats.acc_cnt      += par->worker[ i ].acc_cnt;
+      par->stats.acc_skip_cnt += par->worker[ i ].acc_skip_cnt;
+    }
+  }
+  for( ulong i=0UL; i<par->worker_cnt; i++ ) {
+    par->worker[ i ].acc_cnt      = 0UL;
+    par->worker[ i ].acc_skip_cnt = 0UL;
+  }
+  par->stats.load_ns = fd_log_wallclock() - t0;
+  if( opt_stats ) *opt_stats = par->stats;
+
+  if( FD_UNLIKELY( err ) ) {
+    FD_LOG_WARNING(( "failed to load snapshot %s (%d-%s)", path, err, fd_io_strerror( err ) ));
+    return err;
+  }
+  if( FD_UNLIKELY( !restore->manifest_done ) ) {
+    FD_LOG_WARNING(( "snapshot %s has no manifest", path ));
+    return EPROTO;
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+#ifndef HEADER_fd_src_flamenco_snapshot_fd_snapshot_par_h
+#define HEADER_fd_src_flamenco_snapshot_fd_snapshot_par_h
+
+/* fd_snapshot_par.h provides a multi-threaded alternative to the
+   upstream part of the snapshot loading pipeline (fd_snapshot_loader).
+
+     read => unzstd => untar => restore
+     ^^^^^^^^^^^^^^^^^^^^^^^    ^^^^^^^ (accounts only)
+
+   The snapshot is processed in batches.  Each batch goes through the
+   following stages:
+
+   - Decompress (parallel): The (memory mapped) .tar.zst file is split
+     into Zstandard frames.  Workers claim frames in stream order and
+     decompress each into their own output buffer.
+
+   - Untar (serial): The decompressed frames are fed through a TAR
+     reader in stream order.  Non-account files (manifest, status cache,
+     ...) are forwarded to fd_snapshot_restore.  Account vecs are not
+     copied if they are entirely contained in a single frame (otherwise
+     they are gathered into a heap buffer).
+
+   - Index (parallel): Workers walk the account headers of disjoint
+     ranges of account vecs and bucket the accounts by pubkey.
+
+   - Insert (parallel): Each worker inserts the accounts of its bucket
+     into funk with fd_funk_rec_write_prepare_concur.  As in the serial
+     loader, the account revision with the highest slot number wins.
+     All revisions of an account are handled by the same worker in
+     snapshot order, so the result is identical to a serial load.
+
+   Each worker has two frame buffers used by alternating batches.  A
+   worker that finished inserting its bucket of one batch immediately
+   starts decompressing frames of the next batch into its other buffer,
+   so decompression overlaps with insertion.
+
+   Parallel decompression requires a snapshot consisting of multiple
+   Zstandard frames (see README.md).  A snapshot that consists of a
+   single huge frame does not decompress in parallel and fails to load
+   (EFBIG) if the frame does not fit into one worker's output buffer.
+   This is detected early without decompressing the frame.  Use
+   fd_snapshot_loader for such snapshots (fd_snapshot_load falls back
+   to it automatically). */
+
+#include "fd_snapshot_restore.h"
+#include "../../util/tpool/fd_tpool.h"
+
+#if FD_HAS_ZSTD
+
+/* fd_snapshot_par_t is an opaque handle to a parallel snapshot loader.
+   It owns a Zstandard decompressor and an output buffer for each
+   worker. */
+
+struct fd_snapshot_par;
+typedef struct fd_snapshot_par fd_snapshot_par_t;
+
+#define FD_SNAPSHOT_PAR_ALIGN (128UL)
+
+/* fd_snapshot_par_stats_t reports progress of a parallel snapshot
+   load. */
+
+struct fd_snapshot_par_stats {
+  ulong in_sz;        /* compressed bytes consumed */
+  ulong out_sz;       /* decompressed bytes consumed */
+  ulong frame_cnt;    /* Zstandard frames consumed */
+  ulong batch_cnt;    /* decompress batches */
+  ulong accv_cnt;     /* account vecs loaded */
+  ulong gather_sz;    /* account vec bytes gathered across frames */
+  ulong acc_cnt;      /* account revisions written */
+  ulong acc_skip_cnt; /* account revisions ignored (newer exists) */
+  long  manifest_ns;  /* wallclock duration until manifest restored, 0 if not restored */
+  long  load_ns;      /* wallclock duration of the whole load */
+};
+
+typedef struct fd_snapshot_par_stats fd_snapshot_par_stats_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_snapshot_par_{align,footprint} return the required alignment and
+   footprint of the memory region backing a fd_snapshot_par_t.
+   worker_cnt is the number of workers (including the caller thread).
+   zstd_window_sz is the max Zstandard window size supported.  out_sz is
+   the size of each of the two decompressed frame buffers of a worker.
+   It bounds the decompressed size of a Zstandard frame.  frame_max is the max number
+   of frames in flight per batch.  accv_max is the max number of
+   account vecs buffered before they are inserted.  Returns 0 if any
+   parameter is invalid. */
+
+FD_FN_CONST ulong
+fd_snapshot_par_align( void );
+
+FD_FN_CONST ulong
+fd_snapshot_par_footprint( ulong worker_cnt,
+                           ulong zstd_window_sz,
+                           ulong out_sz,
+                           ulong frame_max,
+                           ulong accv_max );
+
+/* fd_snapshot_par_new formats the memory region at mem for use as a
+   parallel snapshot loader.  If worker_cnt>1, tpool is a thread pool
+   with at least worker_cnt workers (worker 0 is the caller) that the
+   loader may use while fd_snapshot_par_load is running.  Returns a
+   handle on success.  On failure, logs reason and returns NULL. */
+
+fd_snapshot_par_t *
+fd_snapshot_par_new( void *       mem,
+                     fd_tpool_t * tpool,
+                     ulong        worker_cnt,
+                     ulong        zstd_window_sz,
+                     ulong        out_sz,
+                     ulong        frame_max,
+                     ulong        accv_max );
+
+/* fd_snapshot_par_delete destroys the given loader and returns the
+   underlying memory region to the caller. */
+
+void *
+fd_snapshot_par_delete( fd_snapshot_par_t * par );
+
+/* fd_snapshot_par_load does a blocking load of the .tar.zst snapshot
+   at the local file system path into restore.  Manifest and status
+   cache are delivered through the restore object's callbacks from the
+   caller thread.  Accounts are written into the restore object's funk
+   transaction concurrently by all workers.  The caller must hold the
+   funk write lock for the duration of the call, and funk must not be
+   in speed load mode (see fd_funk_rec_write_prepare_concur).
+   restore->valloc is only used from the caller thread.
+
+   If opt_stats is non-NULL, it is populated with load statistics.
+
+   Returns 0 on success.  On failure, logs reason and returns an
+   errno-compatible error code.  The funk transaction may contain a
+   partially loaded set of accounts on failure.  If the failure
+   happened before the manifest was restored (opt_stats->manifest_ns
+   is 0), no accounts were loaded yet.  In particular, a snapshot
+   whose leading frames are too large for the worker buffers fails
+   with EFBIG before anything was restored, and can be loaded with
+   fd_snapshot_loader instead. */
+
+int
+fd_snapshot_par_load( fd_snapshot_par_t *       par,
+                      fd_snapshot_restore_t *   restore,
+                      char const *              path,
+                      fd_snapshot_par_stats_t * opt_stats );
+
+FD_PROTOTYPES_END
+
+#endif /* FD_HAS_ZSTD */
+
+#endif /* HEADER_fd_src_flamenco_snapshot_fd_snapshot_par_h */
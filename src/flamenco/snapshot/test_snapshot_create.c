@@ -0,0 +1,390 @@
+#include "fd_snapshot_base.h"
+#include "fd_snapshot_create.h"
+#include "fd_snapshot_restore.h"
+#include "../runtime/fd_acc_mgr.h"
+#include "../runtime/fd_hashes.h"
+#include "../runtime/context/fd_exec_epoch_ctx.h"
+#include "../../ballet/zstd/fd_zstd.h"
+#include "../../util/archive/fd_tar.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Round trip test: populate funk with accounts and the txn cache with
+   txn statuses, create a snapshot, then restore the snapshot into a
+   fresh funk instance, verify the accounts hash and compare. */
+
+#define TEST_ACC_CNT (1000UL)
+#define TEST_SLOT    (1234UL)
+
+static fd_pubkey_t
+test_pubkey( ulong i ) {
+  fd_pubkey_t key; memset( &key, 0, sizeof(fd_pubkey_t) );
+  key.ul[0] = i+1UL;
+  key.ul[1] = 0x1234UL;
+  return key;
+}
+
+static ulong test_lamports( ulong i ) { return (i%10UL==4UL) ? 0UL : 1000UL+i; } /* every 10th account is deleted */
+static ulong test_dlen    ( ulong i ) { return (i*37UL)%301UL; }
+
+static void
+test_account_set( fd_acc_mgr_t *  acc_mgr,
+                  fd_funk_txn_t * txn,
+                  ulong           i,
+                  ulong           lamports,
+                  uchar           fill ) {
+  fd_pubkey_t key  = test_pubkey( i );
+  ulong       dlen = test_dlen( i );
+  FD_BORROWED_ACCOUNT_DECL( acc );
+  FD_TEST( fd_acc_mgr_modify( acc_mgr, txn, &key, 1, dlen, acc )==FD_ACC_MGR_SUCCESS );
+  acc->meta->dlen          = dlen;
+  acc->meta->info.lamports = lamports;
+  acc->meta->info.executable = (uchar)( (i%7UL)==0UL );
+  acc->meta->slot          = TEST_SLOT;
+  memset( acc->meta->info.owner, (int)i, 32UL );
+  memset( acc->data, fill, dlen );
+}
+
+/* test_status_insert inserts txn txn_id with blockhash block_id into
+   the txn cache at slot. */
+
+static void
+test_status_insert( fd_txncache_t * tc,
+                    ulong           slot,
+                    ulong           block_id,
+                    ulong           txn_id,
+                    uchar           result ) {
+  uchar blockhash[ 32 ] = {0};
+  uchar txnhash  [ 32 ] = {0};
+  FD_STORE( ulong, blockhash, block_id );
+  FD_STORE( ulong, txnhash,   txn_id   );
+  fd_txncache_insert_t insert = {
+    .blockhash = blockhash,
+    .txnhash   = txnhash,
+    .slot      = slot,
+    .result    = &result
+  };
+  FD_TEST( fd_txncache_insert_batch( tc, &insert, 1UL ) );
+}
+
+static ulong _cb_slot       = 0UL;
+static ulong _cb_status_cnt = 0UL;
+
+static int
+cb_manifest( void *                 ctx,
+             fd_solana_manifest_t * manifest ) {
+  fd_valloc_t * valloc = ctx;
+  _cb_slot = manifest->bank.slot;
+  FD_TEST( manifest->bank.epoch_stakes_len==2UL );
+  fd_bincode_destroy_ctx_t destroy = { .valloc = *valloc };
+  fd_solana_manifest_destroy( manifest, &destroy );
+  return 0;
+}
+
+/* cb_status_cache checks the slot deltas of the statuses inserted in
+   main: only the rooted slots TEST_SLOT-2 (blockhash 1: txns 1,2,
+   blockhash 2: txn 3) and TEST_SLOT-1 (blockhash 1: txn 4). */
+
+static int
+cb_status_cache( void *                  ctx,
+                 fd_bank_slot_deltas_t * cache ) {
+  (void)ctx;
+  FD_TEST( cache->slot_deltas_len==2UL );
+  for( ulong i=0UL; i<cache->slot_deltas_len; i++ ) {
+    fd_slot_delta_t const * delta = cache->slot_deltas + i;
+    FD_TEST( delta->slot==TEST_SLOT-2UL+i );
+    FD_TEST( delta->is_root );
+    FD_TEST( delta->slot_delta_vec_len==2UL-i );
+    for( ulong j=0UL; j<delta->slot_delta_vec_len; j++ ) {
+      fd_status_pair_t const * pair = delta->slot_delta_vec + j;
+      FD_TEST( FD_LOAD( ulong, pair->hash.uc )==j+1UL );
+      FD_TEST( pair->value.txn_idx==0UL );
+      for( ulong k=0UL; k<pair->value.statuses_len; k++ ) {
+        fd_cache_status_t const * status = pair->value.statuses + k;
+        ulong txn_id = FD_LOAD( ulong, status->key_slice );
+        FD_TEST( txn_id>=1UL && txn_id<=4UL );
+        FD_TEST( status->result.discriminant==(uint)( txn_id==2UL ) );
+        _cb_status_cnt++;
+      }
+    }
+  }
+  return 0;
+}
+
+/* The restore drops the accounts DB fields of the manifest before the
+   manifest callback, so test_restore keeps a copy of the raw manifest
+   by wrapping the restore TAR callbacks. */
+
+static uchar _manifest[ 1UL<<20 ];
+static ulong _manifest_sz = 0UL;
+static int   _in_manifest = 0;
+
+static int
+test_tee_file( void *                cb_arg,
+               fd_tar_meta_t const * meta,
+               ulong                 sz ) {
+  _in_manifest = 0==strncmp( meta->name, "snapshots/", 10UL ) && 0!=strcmp( meta->name, "snapshots/status_cache" );
+  if( _in_manifest ) FD_TEST( sz<=sizeof(_manifest) );
+  return fd_snapshot_restore_tar_vt.file( cb_arg, meta, sz );
+}
+
+static int
+test_tee_read( void *       cb_arg,
+               void const * buf,
+               ulong        bufsz ) {
+  if( _in_manifest ) {
+    FD_TEST( _manifest_sz+bufsz<=sizeof(_manifest) );
+    fd_memcpy( _manifest+_manifest_sz, buf, bufsz );
+    _manifest_sz += bufsz;
+  }
+  return fd_snapshot_restore_tar_vt.read( cb_arg, buf, bufsz );
+}
+
+static fd_tar_read_vtable_t const test_tee_vt = { .file = test_tee_file, .read = test_tee_read };
+
+/* test_restore decompresses the snapshot at path and restores it into
+   acc_mgr. */
+
+static void
+test_restore( char const *   path,
+              fd_wksp_t *    wksp,
+              fd_acc_mgr_t * acc_mgr,
+              fd_valloc_t    valloc ) {
+
+  ulong window_sz = 1UL<<23;
+  void * dstream_mem = fd_wksp_alloc_laddr( wksp, fd_zstd_dstream_align(), fd_zstd_dstream_footprint( window_sz ), 1UL );
+  fd_zstd_dstream_t * dstream = fd_zstd_dstream_new( dstream_mem, window_sz );
+  FD_TEST( dstream );
+
+  void * restore_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_restore_align(), fd_snapshot_restore_footprint(), 1UL );
+  fd_snapshot_restore_t * restore = fd_snapshot_restore_new( restore_mem, acc_mgr, NULL, valloc, &valloc, cb_manifest, cb_status_cache );
+  FD_TEST( restore );
+
+  fd_tar_reader_t reader_[1];
+  fd_tar_reader_t * reader = fd_tar_reader_new( reader_, &test_tee_vt, restore );
+  FD_TEST( reader );
+
+  int fd = open( path, O_RDONLY );
+  FD_TEST( fd>=0 );
+
+  static uchar in [ 1UL<<16 ];
+  static uchar out[ 1UL<<16 ];
+  int eof = 0;
+  while( !eof ) {
+    ulong in_sz;
+    FD_TEST( !fd_io_read( fd, in, 1UL, sizeof(in), &in_sz ) );
+    uchar const * in_cur = in;
+    while( in_cur<in+in_sz ) {
+      uchar * out_cur = out;
+      int rc = fd_zstd_dstream_read( dstream, &in_cur, in+in_sz, &out_cur, out+sizeof(out), NULL );
+      FD_TEST( rc<=0 );
+      if( out_cur==out ) continue;
+      int tar_err = fd_tar_read( reader, out, (ulong)(out_cur-out) );
+      if( tar_err<0 ) { eof = 1; break; }
+      FD_TEST( !tar_err );
+    }
+  }
+  FD_TEST( eof );
+  close( fd );
+
+  fd_tar_reader_delete( reader );
+  fd_snapshot_restore_delete( restore );
+  fd_wksp_free_laddr( restore_mem );
+  fd_wksp_free_laddr( fd_zstd_dstream_delete( dstream ) );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",    NULL,                      "gigantic" );
+  ulong        page_cnt   = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt",   NULL,                             1UL );
+  ulong        near_cpu   = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu",   NULL,                 fd_log_cpu_id() );
+  char const * dir        = fd_env_strip_cmdline_cstr ( &argc, &argv, "--dir",        NULL,                          "/tmp" );
+  ulong        worker_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--worker-cnt", NULL,                   fd_tile_cnt() );
+
+  FD_TEST( worker_cnt>=1UL && worker_cnt<=fd_tile_cnt() );
+
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  fd_alloc_t * alloc = fd_alloc_join( fd_alloc_new( fd_wksp_alloc_laddr( wksp, fd_alloc_align(), fd_alloc_footprint(), 41UL ), 41UL ), 0UL );
+  FD_TEST( alloc );
+  fd_valloc_t valloc = fd_alloc_virtual( alloc );
+
+  ulong const txn_max = 16UL;
+  ulong const rec_max = 4096UL;
+
+  /* Source funk: accounts in the root, some overridden in a child txn */
+
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), 42UL ), 42UL, 1UL, txn_max, rec_max ) );
+  FD_TEST( funk );
+  fd_acc_mgr_t * acc_mgr = fd_acc_mgr_new( fd_wksp_alloc_laddr( wksp, FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT, 1UL ), funk );
+  FD_TEST( acc_mgr );
+
+  fd_funk_start_write( funk );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) test_account_set( acc_mgr, NULL, i, (i%10UL==4UL) ? 1UL : 7UL, 0xAA );
+  fd_funk_txn_xid_t xid[1] = {{ .ul = { TEST_SLOT } }};
+  fd_funk_txn_t * txn = fd_funk_txn_prepare( funk, NULL, xid, 1 );
+  FD_TEST( txn );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) {
+    if( i%2UL ) continue; /* odd accounts keep their root version */
+    test_account_set( acc_mgr, txn, i, test_lamports( i ), (uchar)i );
+  }
+  fd_funk_end_write( funk );
+
+  /* Slot context */
+
+  ulong vote_acc_max = 16UL;
+  void * epoch_ctx_mem = fd_wksp_alloc_laddr( wksp, fd_exec_epoch_ctx_align(), fd_exec_epoch_ctx_footprint( vote_acc_max ), 1UL );
+  void * slot_ctx_mem  = fd_wksp_alloc_laddr( wksp, FD_EXEC_SLOT_CTX_ALIGN, FD_EXEC_SLOT_CTX_FOOTPRINT, 1UL );
+  fd_exec_epoch_ctx_t * epoch_ctx = fd_exec_epoch_ctx_join( fd_exec_epoch_ctx_new( epoch_ctx_mem, vote_acc_max ) );
+  fd_exec_slot_ctx_t *  slot_ctx  = fd_exec_slot_ctx_join ( fd_exec_slot_ctx_new ( slot_ctx_mem, valloc ) );
+  FD_TEST( epoch_ctx && slot_ctx );
+
+  fd_epoch_bank_t * epoch_bank = fd_exec_epoch_ctx_epoch_bank( epoch_ctx );
+  epoch_bank->epoch_schedule.slots_per_epoch             = 8192UL;
+  epoch_bank->epoch_schedule.leader_schedule_slot_offset = 8192UL;
+
+  slot_ctx->epoch_ctx           = epoch_ctx;
+  slot_ctx->acc_mgr             = acc_mgr;
+  slot_ctx->funk_txn            = txn;
+  slot_ctx->slot_bank.slot      = TEST_SLOT;
+  slot_ctx->slot_bank.prev_slot = TEST_SLOT-1UL;
+  memset( slot_ctx->account_delta_hash.uc, 0xD1, sizeof(fd_hash_t) );
+
+  /* Txn cache: statuses of two rooted slots and the current slot
+     (not rooted yet, so not exported) */
+
+  ulong tc_footprint = fd_txncache_footprint( 4UL, 8UL, 16UL );
+  FD_TEST( tc_footprint );
+  fd_txncache_t * tc = fd_txncache_join( fd_txncache_new( fd_wksp_alloc_laddr( wksp, fd_txncache_align(), tc_footprint, 1UL ), 4UL, 8UL, 16UL ) );
+  FD_TEST( tc );
+  test_status_insert( tc, TEST_SLOT-2UL, 1UL, 1UL, 0 );
+  test_status_insert( tc, TEST_SLOT-2UL, 1UL, 2UL, 1 );
+  test_status_insert( tc, TEST_SLOT-2UL, 2UL, 3UL, 0 );
+  test_status_insert( tc, TEST_SLOT-1UL, 1UL, 4UL, 0 );
+  test_status_insert( tc, TEST_SLOT,     1UL, 5UL, 0 );
+  fd_txncache_register_root_slot( tc, TEST_SLOT-2UL );
+  fd_txncache_register_root_slot( tc, TEST_SLOT-1UL );
+  slot_ctx->status_cache = tc;
+
+  /* Thread pool */
+
+  static uchar tpool_mem[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+  fd_tpool_t * tpool = NULL;
+  if( worker_cnt>1UL ) {
+    tpool = fd_tpool_init( tpool_mem, worker_cnt );
+    FD_TEST( tpool );
+    for( ulong i=1UL; i<worker_cnt; i++ ) FD_TEST( fd_tpool_worker_push( tpool, i, NULL, 0UL ) );
+  }
+
+  /* Create snapshot.  Tiny account vecs to exercise many frames. */
+
+  int   compress_lvl   = 3;
+  ulong compress_bufsz = 4096UL;
+  ulong batch_acc_cnt  = 7UL;
+  ulong max_accv_sz    = 2048UL;
+
+  FD_TEST( !fd_snapshot_create_footprint( 0UL, compress_lvl, compress_bufsz, rec_max, batch_acc_cnt ) );
+  ulong footprint = fd_snapshot_create_footprint( worker_cnt, compress_lvl, compress_bufsz, rec_max, batch_acc_cnt );
+  FD_TEST( footprint );
+  void * create_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_create_align(), footprint, 1UL );
+  FD_TEST( create_mem );
+
+  fd_rng_t rng_[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( rng_, 1U, 0UL ) );
+
+  FD_TEST( !fd_snapshot_create_new( create_mem, slot_ctx, dir, worker_cnt, compress_lvl, compress_bufsz, rec_max-1UL, batch_acc_cnt, max_accv_sz, tpool, rng ) );
+  fd_snapshot_create_t * create = fd_snapshot_create_new( create_mem, slot_ctx, dir, worker_cnt, compress_lvl, compress_bufsz, rec_max, batch_acc_cnt, max_accv_sz, tpool, rng );
+  FD_TEST( create );
+  FD_TEST( !fd_snapshot_create_path( create )[0] );
+
+  FD_TEST( fd_snapshot_create( create, slot_ctx )==1 );
+  char path[ 4096 ];
+  fd_cstr_fini( fd_cstr_append_cstr( fd_cstr_init( path ), fd_snapshot_create_path( create ) ) );
+  FD_TEST( fd_snapshot_create_delete( create )==create_mem );
+  FD_LOG_NOTICE(( "created %s", path ));
+
+  fd_snapshot_name_t name[1];
+  FD_TEST( fd_snapshot_name_from_cstr( name, path, 0UL ) );
+  FD_TEST( name->type==FD_SNAPSHOT_TYPE_FULL );
+  FD_TEST( name->slot==TEST_SLOT );
+  FD_TEST( 0==strcmp( name->file_ext, ".tar.zst" ) );
+
+  /* Restore into a fresh funk instance and compare */
+
+  fd_funk_t * funk2 = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), 43UL ), 43UL, 2UL, txn_max, rec_max ) );
+  FD_TEST( funk2 );
+  fd_acc_mgr_t * acc_mgr2 = fd_acc_mgr_new( fd_wksp_alloc_laddr( wksp, FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT, 1UL ), funk2 );
+  FD_TEST( acc_mgr2 );
+
+  fd_funk_start_write( funk2 );
+  test_restore( path, wksp, acc_mgr2, valloc );
+  FD_TEST( _cb_slot==TEST_SLOT );
+  FD_TEST( _cb_status_cnt==4UL );
+
+  do {
+    fd_solana_manifest_t manifest[1];
+    fd_bincode_decode_ctx_t decode = { .data = _manifest, .dataend = _manifest+_manifest_sz, .valloc = valloc };
+    FD_TEST( fd_solana_manifest_decode( manifest, &decode )==FD_BINCODE_SUCCESS );
+    fd_bank_hash_info_t const * info = &manifest->accounts_db.bank_hash_info;
+    FD_TEST( 0==memcmp( &info->hash,          &slot_ctx->account_delta_hash, sizeof(fd_hash_t) ) );
+    FD_TEST( 0==memcmp( &info->snapshot_hash, &name->fhash,                  sizeof(fd_hash_t) ) );
+    fd_bincode_destroy_ctx_t destroy = { .valloc = valloc };
+    fd_solana_manifest_destroy( manifest, &destroy );
+  } while(0);
+
+  /* Verify the accounts hash of the restored accounts against the
+     snapshot name, like fd_snapshot_load with hash verification */
+
+  void * slot_ctx2_mem = fd_wksp_alloc_laddr( wksp, FD_EXEC_SLOT_CTX_ALIGN, FD_EXEC_SLOT_CTX_FOOTPRINT, 1UL );
+  fd_exec_slot_ctx_t * slot_ctx2 = fd_exec_slot_ctx_join( fd_exec_slot_ctx_new( slot_ctx2_mem, valloc ) );
+  FD_TEST( slot_ctx2 );
+  slot_ctx2->epoch_ctx      = epoch_ctx;
+  slot_ctx2->acc_mgr        = acc_mgr2;
+  slot_ctx2->funk_txn       = NULL;
+  slot_ctx2->slot_bank.slot = TEST_SLOT;
+
+  fd_hash_t accounts_hash;
+  fd_snapshot_hash( slot_ctx2, &accounts_hash, NULL, 1U, 0 );
+  FD_TEST( 0==memcmp( &accounts_hash, &name->fhash, sizeof(fd_hash_t) ) );
+  fd_funk_end_write( funk2 );
+
+  ulong acc_cnt = 0UL;
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) {
+    fd_pubkey_t key = test_pubkey( i );
+    FD_BORROWED_ACCOUNT_DECL( exp );
+    FD_BORROWED_ACCOUNT_DECL( act );
+    FD_TEST( fd_acc_mgr_view( acc_mgr, txn, &key, exp )==FD_ACC_MGR_SUCCESS );
+    int err = fd_acc_mgr_view( acc_mgr2, NULL, &key, act );
+    if( !exp->const_meta->info.lamports ) {
+      FD_TEST( err!=FD_ACC_MGR_SUCCESS );
+      continue;
+    }
+    FD_TEST( err==FD_ACC_MGR_SUCCESS );
+    FD_TEST( act->const_meta->info.lamports  ==exp->const_meta->info.lamports   );
+    FD_TEST( act->const_meta->info.executable==exp->const_meta->info.executable );
+    FD_TEST( act->const_meta->dlen           ==exp->const_meta->dlen            );
+    FD_TEST( 0==memcmp( act->const_meta->info.owner, exp->const_meta->info.owner, 32UL ) );
+    FD_TEST( 0==memcmp( act->const_data, exp->const_data, exp->const_meta->dlen ) );
+    fd_hash_t hash;
+    fd_hash_account_current( hash.hash, act->const_meta, key.uc, act->const_data, slot_ctx2 );
+    FD_TEST( 0==memcmp( act->const_meta->hash, hash.hash, sizeof(fd_hash_t) ) );
+    acc_cnt++;
+  }
+  FD_TEST( fd_funk_rec_cnt( fd_funk_rec_map( funk2, wksp ) )==acc_cnt );
+  FD_LOG_NOTICE(( "restored %lu accounts", acc_cnt ));
+
+  unlink( path );
+
+  fd_wksp_free_laddr( fd_txncache_delete( fd_txncache_leave( tc ) ) );
+  if( tpool ) fd_tpool_fini( tpool );
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -0,0 +1,415 @@
+#include "fd_snapshot_par.h"
+#include "fd_snapshot_create.h"
+#include "../runtime/fd_acc_mgr.h"
+#include "../runtime/context/fd_exec_epoch_ctx.h"
+#include "../../ballet/zstd/fd_zstd.h"
+#include "../../util/archive/fd_tar.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+
+/* Creates a snapshot with fd_snapshot_create, then loads it with the
+   serial restore and with the parallel loader (in various
+   configurations) and checks that both produce the same funk
+   content. */
+
+#define TEST_ACC_CNT (1000UL)
+#define TEST_SLOT    (1234UL)
+
+static fd_pubkey_t
+test_pubkey( ulong i ) {
+  fd_pubkey_t key; memset( &key, 0, sizeof(fd_pubkey_t) );
+  key.ul[0] = i+1UL;
+  key.ul[1] = 0x5678UL;
+  return key;
+}
+
+static void
+test_account_set( fd_acc_mgr_t * acc_mgr,
+                  ulong          i ) {
+  fd_pubkey_t key  = test_pubkey( i );
+  ulong       dlen = (i*53UL)%1501UL;
+  FD_BORROWED_ACCOUNT_DECL( acc );
+  FD_TEST( fd_acc_mgr_modify( acc_mgr, NULL, &key, 1, dlen, acc )==FD_ACC_MGR_SUCCESS );
+  acc->meta->dlen            = dlen;
+  acc->meta->info.lamports   = 1000UL+i;
+  acc->meta->info.executable = (uchar)( (i%7UL)==0UL );
+  acc->meta->slot            = TEST_SLOT;
+  memset( acc->meta->info.owner, (int)i, 32UL );
+  memset( acc->data, (int)(i*3UL), dlen );
+}
+
+static int
+cb_manifest( void *                 ctx,
+             fd_solana_manifest_t * manifest ) {
+  fd_valloc_t * valloc = ctx;
+  FD_TEST( manifest->bank.slot==TEST_SLOT );
+  fd_bincode_destroy_ctx_t destroy = { .valloc = *valloc };
+  fd_solana_manifest_destroy( manifest, &destroy );
+  return 0;
+}
+
+static int
+cb_status_cache( void *                  ctx,
+                 fd_bank_slot_deltas_t * cache ) {
+  (void)ctx; (void)cache;
+  return 0;
+}
+
+/* test_funk_new creates an empty funk with an account manager. */
+
+static fd_acc_mgr_t *
+test_funk_new( fd_wksp_t * wksp,
+               ulong       tag,
+               ulong       rec_max ) {
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), tag ), tag, tag, 16UL, rec_max ) );
+  FD_TEST( funk );
+  fd_acc_mgr_t * acc_mgr = fd_acc_mgr_new( fd_wksp_alloc_laddr( wksp, FD_ACC_MGR_ALIGN, FD_ACC_MGR_FOOTPRINT, tag ), funk );
+  FD_TEST( acc_mgr );
+  return acc_mgr;
+}
+
+static void
+test_funk_delete( fd_acc_mgr_t * acc_mgr ) {
+  fd_funk_t * funk = acc_mgr->funk;
+  fd_wksp_free_laddr( fd_acc_mgr_delete( acc_mgr ) );
+  fd_wksp_free_laddr( fd_funk_delete( fd_funk_leave( funk ) ) );
+}
+
+/* test_restore_serial restores the snapshot at path into acc_mgr with
+   the serial restore. */
+
+static void
+test_restore_serial( char const *   path,
+                     fd_wksp_t *    wksp,
+                     fd_acc_mgr_t * acc_mgr,
+                     fd_valloc_t    valloc ) {
+
+  ulong window_sz = 1UL<<23;
+  void * dstream_mem = fd_wksp_alloc_laddr( wksp, fd_zstd_dstream_align(), fd_zstd_dstream_footprint( window_sz ), 1UL );
+  fd_zstd_dstream_t * dstream = fd_zstd_dstream_new( dstream_mem, window_sz );
+  FD_TEST( dstream );
+
+  void * restore_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_restore_align(), fd_snapshot_restore_footprint(), 1UL );
+  fd_snapshot_restore_t * restore = fd_snapshot_restore_new( restore_mem, acc_mgr, NULL, valloc, &valloc, cb_manifest, cb_status_cache );
+  FD_TEST( restore );
+
+  fd_tar_reader_t reader_[1];
+  fd_tar_reader_t * reader = fd_tar_reader_new( reader_, &fd_snapshot_restore_tar_vt, restore );
+  FD_TEST( reader );
+
+  int fd = open( path, O_RDONLY );
+  FD_TEST( fd>=0 );
+
+  static uchar in [ 1UL<<16 ];
+  static uchar out[ 1UL<<16 ];
+  int eof = 0;
+  while( !eof ) {
+    ulong in_sz;
+    FD_TEST( !fd_io_read( fd, in, 1UL, sizeof(in), &in_sz ) );
+    uchar const * in_cur = in;
+    while( in_cur<in+in_sz ) {
+      uchar * out_cur = out;
+      int rc = fd_zstd_dstream_read( dstream, &in_cur, in+in_sz, &out_cur, out+sizeof(out), NULL );
+      FD_TEST( rc<=0 );
+      if( out_cur==out ) continue;
+      int tar_err = fd_tar_read( reader, out, (ulong)(out_cur-out) );
+      if( tar_err<0 ) { eof = 1; break; }
+      FD_TEST( !tar_err );
+    }
+  }
+  close( fd );
+
+  fd_tar_reader_delete( reader );
+  fd_wksp_free_laddr( fd_snapshot_restore_delete( restore ) );
+  fd_wksp_free_laddr( fd_zstd_dstream_delete( dstream ) );
+}
+
+/* test_restore_par loads the snapshot at path into acc_mgr with the
+   parallel loader.  Returns the loader's error code. */
+
+static int
+test_restore_par( char const *              path,
+                  fd_wksp_t *               wksp,
+                  fd_acc_mgr_t *            acc_mgr,
+                  fd_valloc_t               valloc,
+                  fd_tpool_t *              tpool,
+                  ulong                     worker_cnt,
+                  ulong                     out_sz,
+                  ulong                     frame_max,
+                  ulong                     accv_max,
+                  fd_snapshot_par_stats_t * stats ) {
+
+  ulong window_sz = 1UL<<23;
+  ulong footprint = fd_snapshot_par_footprint( worker_cnt, window_sz, out_sz, frame_max, accv_max );
+  FD_TEST( footprint );
+  void * par_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_par_align(), footprint, 1UL );
+  FD_TEST( par_mem );
+  fd_snapshot_par_t * par = fd_snapshot_par_new( par_mem, tpool, worker_cnt, window_sz, out_sz, frame_max, accv_max );
+  FD_TEST( par );
+
+  void * restore_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_restore_align(), fd_snapshot_restore_footprint(), 1UL );
+  fd_snapshot_restore_t * restore = fd_snapshot_restore_new( restore_mem, acc_mgr, NULL, valloc, &valloc, cb_manifest, cb_status_cache );
+  FD_TEST( restore );
+
+  fd_funk_start_write( acc_mgr->funk );
+  int err = fd_snapshot_par_load( par, restore, path, stats );
+  fd_funk_end_write( acc_mgr->funk );
+
+  fd_wksp_free_laddr( fd_snapshot_restore_delete( restore ) );
+  FD_TEST( fd_snapshot_par_delete( par )==par_mem );
+  fd_wksp_free_laddr( par_mem );
+  return err;
+}
+
+/* test_reframe recompresses the snapshot at src_path into dst_path
+   with frames of frame_sz uncompressed bytes each, regardless of TAR
+   file boundaries (as done by other snapshot producers). */
+
+static void
+test_reframe( char const * src_path,
+              char const * dst_path,
+              fd_wksp_t *  wksp,
+              ulong        frame_sz ) {
+
+  ulong buf_max = 1UL<<24;
+  uchar * raw = fd_wksp_alloc_laddr( wksp, 1UL, buf_max, 1UL );
+  uchar * zst = fd_wksp_alloc_laddr( wksp, 1UL, buf_max, 1UL );
+  FD_TEST( raw && zst );
+
+  ulong window_sz = 1UL<<23;
+  fd_zstd_dstream_t * dstream = fd_zstd_dstream_new( fd_wksp_alloc_laddr( wksp, fd_zstd_dstream_align(), fd_zstd_dstream_footprint( window_sz ), 1UL ), window_sz );
+  fd_zstd_cstream_t * cstream = fd_zstd_cstream_new( fd_wksp_alloc_laddr( wksp, fd_zstd_cstream_align(), fd_zstd_cstream_footprint( 1 ), 1UL ), 1 );
+  FD_TEST( dstream && cstream );
+
+  int fd = open( src_path, O_RDONLY );
+  FD_TEST( fd>=0 );
+  ulong zst_sz;
+  FD_TEST( !fd_io_read( fd, zst, 1UL, buf_max, &zst_sz ) );
+  FD_TEST( zst_sz<buf_max );
+  close( fd );
+
+  uchar const * in_cur  = zst;
+  uchar *       raw_cur = raw;
+  while( in_cur<zst+zst_sz ) {
+    FD_TEST( fd_zstd_dstream_read( dstream, &in_cur, zst+zst_sz, &raw_cur, raw+buf_max, NULL )<=0 );
+    FD_TEST( raw_cur<raw+buf_max );
+  }
+
+  uchar * out_cur = zst;
+  for( uchar const * raw_in=raw; raw_in<raw_cur; ) {
+    uchar const * chunk_end = raw_in + fd_ulong_min( frame_sz, (ulong)( raw_cur-raw_in ) );
+    FD_TEST( !fd_zstd_cstream_compress( cstream, &raw_in, chunk_end, &out_cur, zst+buf_max, NULL ) );
+    FD_TEST( raw_in==chunk_end );
+    FD_TEST( fd_zstd_cstream_end( cstream, &out_cur, zst+buf_max, NULL )==-1 );
+  }
+
+  fd = open( dst_path, O_WRONLY|O_CREAT|O_TRUNC, 0644 );
+  FD_TEST( fd>=0 );
+  ulong wsz;
+  FD_TEST( !fd_io_write( fd, zst, (ulong)( out_cur-zst ), (ulong)( out_cur-zst ), &wsz ) );
+  close( fd );
+
+  fd_wksp_free_laddr( fd_zstd_cstream_delete( cstream ) );
+  fd_wksp_free_laddr( fd_zstd_dstream_delete( dstream ) );
+  fd_wksp_free_laddr( zst );
+  fd_wksp_free_laddr( raw );
+}
+
+/* test_compare checks that both account managers hold the same
+   accounts. */
+
+static void
+test_compare( fd_acc_mgr_t * exp_mgr,
+              fd_acc_mgr_t * act_mgr ) {
+  fd_wksp_t * wksp = fd_funk_wksp( exp_mgr->funk );
+  FD_TEST( !fd_funk_verify( act_mgr->funk ) );
+  FD_TEST( fd_funk_rec_cnt( fd_funk_rec_map( act_mgr->funk, wksp ) )==
+           fd_funk_rec_cnt( fd_funk_rec_map( exp_mgr->funk, wksp ) ) );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) {
+    fd_pubkey_t key = test_pubkey( i );
+    FD_BORROWED_ACCOUNT_DECL( exp );
+    FD_BORROWED_ACCOUNT_DECL( act );
+    FD_TEST( fd_acc_mgr_view( exp_mgr, NULL, &key, exp )==FD_ACC_MGR_SUCCESS );
+    FD_TEST( fd_acc_mgr_view( act_mgr, NULL, &key, act )==FD_ACC_MGR_SUCCESS );
+    FD_TEST( act->const_meta->slot==exp->const_meta->slot );
+    FD_TEST( act->const_meta->dlen==exp->const_meta->dlen );
+    FD_TEST( 0==memcmp( &act->const_meta->info, &exp->const_meta->info, sizeof(fd_solana_account_meta_t) ) );
+    FD_TEST( 0==memcmp( act->const_meta->hash,  exp->const_meta->hash,  32UL ) );
+    FD_TEST( 0==memcmp( act->const_data, exp->const_data, exp->const_meta->dlen ) );
+  }
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",    NULL,                   "gigantic" );
+  ulong        page_cnt   = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt",   NULL,                          1UL );
+  ulong        near_cpu   = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu",   NULL,              fd_log_cpu_id() );
+  char const * dir        = fd_env_strip_cmdline_cstr ( &argc, &argv, "--dir",        NULL,                       "/tmp" );
+  ulong        worker_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--worker-cnt", NULL,                fd_tile_cnt() );
+
+  FD_TEST( worker_cnt>=1UL && worker_cnt<=fd_tile_cnt() );
+
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  FD_TEST( wksp );
+
+  fd_alloc_t * alloc = fd_alloc_join( fd_alloc_new( fd_wksp_alloc_laddr( wksp, fd_alloc_align(), fd_alloc_footprint(), 41UL ), 41UL ), 0UL );
+  FD_TEST( alloc );
+  fd_valloc_t valloc = fd_alloc_virtual( alloc );
+
+  ulong const rec_max = 4096UL;
+
+  /* Source funk */
+
+  fd_acc_mgr_t * acc_mgr = test_funk_new( wksp, 42UL, rec_max );
+  fd_funk_start_write( acc_mgr->funk );
+  for( ulong i=0UL; i<TEST_ACC_CNT; i++ ) test_account_set( acc_mgr, i );
+  fd_funk_end_write( acc_mgr->funk );
+
+  ulong vote_acc_max = 16UL;
+  void * epoch_ctx_mem = fd_wksp_alloc_laddr( wksp, fd_exec_epoch_ctx_align(), fd_exec_epoch_ctx_footprint( vote_acc_max ), 1UL );
+  void * slot_ctx_mem  = fd_wksp_alloc_laddr( wksp, FD_EXEC_SLOT_CTX_ALIGN, FD_EXEC_SLOT_CTX_FOOTPRINT, 1UL );
+  fd_exec_epoch_ctx_t * epoch_ctx = fd_exec_epoch_ctx_join( fd_exec_epoch_ctx_new( epoch_ctx_mem, vote_acc_max ) );
+  fd_exec_slot_ctx_t *  slot_ctx  = fd_exec_slot_ctx_join ( fd_exec_slot_ctx_new ( slot_ctx_mem, valloc ) );
+  FD_TEST( epoch_ctx && slot_ctx );
+
+  fd_epoch_bank_t * epoch_bank = fd_exec_epoch_ctx_epoch_bank( epoch_ctx );
+  epoch_bank->epoch_schedule.slots_per_epoch             = 8192UL;
+  epoch_bank->epoch_schedule.leader_schedule_slot_offset = 8192UL;
+
+  slot_ctx->epoch_ctx           = epoch_ctx;
+  slot_ctx->acc_mgr             = acc_mgr;
+  slot_ctx->funk_txn            = NULL;
+  slot_ctx->slot_bank.slot      = TEST_SLOT;
+  slot_ctx->slot_bank.prev_slot = TEST_SLOT-1UL;
+
+  static uchar tpool_mem[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+  fd_tpool_t * tpool = NULL;
+  if( worker_cnt>1UL ) {
+    tpool = fd_tpool_init( tpool_mem, worker_cnt );
+    FD_TEST( tpool );
+    for( ulong i=1UL; i<worker_cnt; i++ ) FD_TEST( fd_tpool_worker_push( tpool, i, NULL, 0UL ) );
+  }
+
+  /* Create a snapshot with many small frames */
+
+  int   compress_lvl   = 3;
+  ulong compress_bufsz = 4096UL;
+  ulong batch_acc_cnt  = 16UL;
+  ulong max_accv_sz    = 8192UL;
+
+  fd_rng_t rng_[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( rng_, 2U, 0UL ) );
+  void * create_mem = fd_wksp_alloc_laddr( wksp, fd_snapshot_create_align(), fd_snapshot_create_footprint( worker_cnt, compress_lvl, compress_bufsz, rec_max, batch_acc_cnt ), 1UL );
+  fd_snapshot_create_t * create = fd_snapshot_create_new( create_mem, slot_ctx, dir, worker_cnt, compress_lvl, compress_bufsz, rec_max, batch_acc_cnt, max_accv_sz, tpool, rng );
+  FD_TEST( create );
+  FD_TEST( fd_snapshot_create( create, slot_ctx )==1 );
+  char path[ PATH_MAX ];
+  fd_cstr_fini( fd_cstr_append_cstr( fd_cstr_init( path ), fd_snapshot_create_path( create ) ) );
+  fd_wksp_free_laddr( fd_snapshot_create_delete( create ) );
+
+  /* Reference: serial restore */
+
+  fd_acc_mgr_t * exp_mgr = test_funk_new( wksp, 43UL, rec_max );
+  fd_funk_start_write( exp_mgr->funk );
+  test_restore_serial( path, wksp, exp_mgr, valloc );
+  fd_funk_end_write( exp_mgr->funk );
+
+  /* Invalid params */
+
+  FD_TEST( !fd_snapshot_par_footprint( 0UL, 1UL<<23, 1UL<<20, 16UL, 16UL ) );
+  FD_TEST( !fd_snapshot_par_footprint( 1UL, 1UL<<23,     0UL, 16UL, 16UL ) );
+  FD_TEST( !fd_snapshot_par_footprint( 1UL, 1UL<<23, 1UL<<20,  0UL, 16UL ) );
+  FD_TEST( !fd_snapshot_par_footprint( 1UL, 1UL<<23, 1UL<<20, 16UL,  0UL ) );
+
+  /* Parallel load: (out_sz, frame_max, accv_max) */
+
+  static ulong const cfg[][3] = {
+    { 1UL<<20, 64UL, 256UL },  /* whole snapshot in few batches */
+    { 1UL<<16,  3UL,   2UL },  /* many batches, frequent flushes */
+    {   16384,  1UL,   1UL },  /* one frame per batch, buffer overflows */
+  };
+
+  for( ulong j=0UL; j<sizeof(cfg)/sizeof(cfg[0]); j++ ) {
+    fd_acc_mgr_t * act_mgr = test_funk_new( wksp, 44UL, rec_max );
+    fd_snapshot_par_stats_t stats[1];
+    int err = test_restore_par( path, wksp, act_mgr, valloc, tpool, worker_cnt, cfg[j][0], cfg[j][1], cfg[j][2], stats );
+    FD_TEST( !err );
+    FD_LOG_NOTICE(( "out_sz %lu frame_max %lu accv_max %lu: %lu frames, %lu batches, %lu accvs, %lu accounts, %lu bytes gathered",
+                    cfg[j][0], cfg[j][1], cfg[j][2], stats->frame_cnt, stats->batch_cnt, stats->accv_cnt, stats->acc_cnt, stats->gather_sz ));
+    FD_TEST( stats->frame_cnt>1UL );
+    FD_TEST( stats->acc_cnt==TEST_ACC_CNT );
+    FD_TEST( stats->manifest_ns>0L && stats->manifest_ns<=stats->load_ns );
+    test_compare( exp_mgr, act_mgr );
+    test_funk_delete( act_mgr );
+  }
+
+  /* Account vecs spanning frames */
+
+  do {
+    char path2[ PATH_MAX ];
+    FD_TEST( fd_cstr_printf_check( path2, sizeof(path2), NULL, "%s.reframe", path ) );
+    test_reframe( path, path2, wksp, 3000UL );
+
+    fd_acc_mgr_t * act_mgr = test_funk_new( wksp, 44UL, rec_max );
+    fd_snapshot_par_stats_t stats[1];
+    FD_TEST( !test_restore_par( path2, wksp, act_mgr, valloc, tpool, worker_cnt, 1UL<<16, 8UL, 4UL, stats ) );
+    FD_LOG_NOTICE(( "reframed: %lu frames, %lu batches, %lu accvs, %lu accounts, %lu bytes gathered",
+                    stats->frame_cnt, stats->batch_cnt, stats->accv_cnt, stats->acc_cnt, stats->gather_sz ));
+    FD_TEST( stats->gather_sz>0UL );
+    FD_TEST( stats->acc_cnt==TEST_ACC_CNT );
+    test_compare( exp_mgr, act_mgr );
+    test_funk_delete( act_mgr );
+    unlink( path2 );
+  } while(0);
+
+  /* Frame larger than a worker buffer */
+
+  do {
+    fd_acc_mgr_t * act_mgr = test_funk_new( wksp, 44UL, rec_max );
+    fd_snapshot_par_stats_t stats[1];
+    FD_TEST( test_restore_par( path, wksp, act_mgr, valloc, tpool, worker_cnt, 256UL, 4UL, 4UL, stats )==EFBIG );
+    FD_TEST( !stats->manifest_ns );
+    test_funk_delete( act_mgr );
+  } while(0);
+
+  /* Single frame snapshot, rejected before anything is restored so
+     that fd_snapshot_load can fall back to the serial loader */
+
+  do {
+    char path2[ PATH_MAX ];
+    FD_TEST( fd_cstr_printf_check( path2, sizeof(path2), NULL, "%s.single", path ) );
+    test_reframe( path, path2, wksp, ULONG_MAX );
+
+    fd_acc_mgr_t * act_mgr = test_funk_new( wksp, 44UL, rec_max );
+    fd_snapshot_par_stats_t stats[1];
+    FD_TEST( test_restore_par( path2, wksp, act_mgr, valloc, tpool, worker_cnt, 4096UL, 4UL, 4UL, stats )==EFBIG );
+    FD_TEST( !stats->manifest_ns );
+    FD_TEST( !stats->frame_cnt );
+    FD_TEST( !fd_funk_rec_cnt( fd_funk_rec_map( act_mgr->funk, wksp ) ) );
+    test_funk_delete( act_mgr );
+    unlink( path2 );
+  } while(0);
+
+  /* Missing file */
+
+  do {
+    fd_acc_mgr_t * act_mgr = test_funk_new( wksp, 44UL, rec_max );
+    FD_TEST( test_restore_par( "/nonexistent.tar.zst", wksp, act_mgr, valloc, tpool, worker_cnt, 1UL<<16, 4UL, 4UL, NULL )==ENOENT );
+    test_funk_delete( act_mgr );
+  } while(0);
+
+  unlink( path );
+
+  if( tpool ) fd_tpool_fini( tpool );
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -344,6 +344,101 @@ fd_vm_delete( void * shmem ) {
   return (void *)vm;
 }
 
+/* fd_vm_mem_st_mark and fd_vm_pool_release treat the stack and heap as
+   one contiguous range. */
+
+FD_STATIC_ASSERT( offsetof( fd_vm_t, heap )==offsetof( fd_vm_t, stack )+FD_VM_STACK_MAX, layout );
+
+static FD_TL fd_vm_t * fd_vm_pool_private_mem = NULL;
+static FD_TL ulong     fd_vm_pool_private_max = 0UL;
+static FD_TL ulong     fd_vm_pool_private_cnt = 0UL; /* Number of vms available, vms [0,cnt) are free */
+static FD_TL fd_vm_t * fd_vm_pool_private_free[ FD_VM_POOL_VM_MAX ];
+
+void
+fd_vm_pool_attach( void * mem,
+                   ulong  vm_max ) {
+
+  if( FD_UNLIKELY( fd_vm_pool_private_mem ) ) FD_LOG_ERR(( "already attached" ));
+  if( FD_UNLIKELY( !mem ) ) FD_LOG_ERR(( "NULL mem" ));
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)mem, fd_vm_pool_align() ) ) ) FD_LOG_ERR(( "misaligned mem" ));
+  if( FD_UNLIKELY( (!vm_max) | (vm_max>FD_VM_POOL_VM_MAX) ) ) FD_LOG_ERR(( "bad vm_max (%lu)", vm_max ));
+
+  fd_vm_t * vms = (fd_vm_t *)mem;
+  for( ulong i=0UL; i<vm_max; i++ ) {
+    fd_vm_t * vm = fd_vm_join( fd_vm_new( vms+i ) );
+    if( FD_UNLIKELY( !vm ) ) FD_LOG_ERR(( "fd_vm_new failed" ));
+    fd_vm_pool_private_free[ vm_max-1UL-i ] = vm;
+  }
+
+  fd_vm_pool_private_mem = vms;
+  fd_vm_pool_private_max = vm_max;
+  fd_vm_pool_private_cnt = vm_max;
+}
+
+void *
+fd_vm_pool_detach( void ) {
+
+  fd_vm_t * vms = fd_vm_pool_private_mem;
+  if( FD_UNLIKELY( !vms ) ) {
+    FD_LOG_WARNING(( "not attached" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( fd_vm_pool_private_cnt!=fd_vm_pool_private_max ) ) FD_LOG_ERR(( "vms still in use" ));
+
+  for( ulong i=0UL; i<fd_vm_pool_private_max; i++ ) fd_vm_delete( fd_vm_leave( vms+i ) );
+
+  fd_vm_pool_private_mem = NULL;
+  fd_vm_pool_private_max = 0UL;
+  fd_vm_pool_private_cnt = 0UL;
+  return vms;
+}
+
+fd_vm_t *
+fd_vm_pool_acquire( void ) {
+  if( FD_UNLIKELY( !fd_vm_pool_private_cnt ) ) return NULL; /* not attached or exhausted */
+  return fd_vm_pool_private_free[ --fd_vm_pool_private_cnt ];
+}
+
+void
+fd_vm_pool_release( fd_vm_t * vm ) {
+
+  ulong idx = (ulong)(vm - fd_vm_pool_private_mem);
+  if( FD_UNLIKELY( (!fd_vm_pool_private_mem) | (idx>=fd_vm_pool_private_max) |
+                   (fd_vm_pool_private_cnt>=fd_vm_pool_private_max) ) ) {
+    FD_LOG_CRIT(( "vm %p not acquired from this thread's pool", (void *)vm ));
+  }
+
+  /* Programs (and syscalls on their behalf) can store anywhere in the
+     stack region and [0,heap_max) of the heap but typically only touch
+     a few stack frames and heap pages.  Every such store marks its
+     pages in st_dirty, so only those get cleared.  Runs of dirty pages
+     are cleared with a single memset. */
+
+  uchar * mem = (uchar *)vm + offsetof( fd_vm_t, stack ); /* Heap immediately follows the stack */
+  for( ulong w=0UL; w<FD_VM_ST_DIRTY_WORD_CNT; w++ ) {
+    ulong m = vm->st_dirty[ w ];
+    while( m ) {
+      ulong pg0 = (ulong)fd_ulong_find_lsb( m );
+      ulong run = (ulong)fd_ulong_find_lsb_w_default( ~(m>>pg0), (int)(64UL-pg0) );
+      fd_memset( mem + ((w*64UL+pg0)<<FD_VM_ST_DIRTY_LG_PAGE_SZ), 0, run<<FD_VM_ST_DIRTY_LG_PAGE_SZ );
+      m &= ~( fd_ulong_mask_lsb( (int)run ) << pg0 );
+    }
+    vm->st_dirty[ w ] = 0UL;
+  }
+
+  vm->instr_ctx        = NULL;
+  vm->check_align      = 0;
+  vm->check_size       = 0;
+  vm->input            = NULL;
+  vm->input_sz         = 0UL;
+  vm->input_region     = NULL;
+  vm->input_region_cnt = 0UL;
+  vm->trace            = NULL;
+  vm->sha              = NULL;
+
+  fd_vm_pool_private_free[ fd_vm_pool_private_cnt++ ] = vm;
+}
+
 fd_vm_t *
 fd_vm_init(
    fd_vm_t * vm,
@@ -391,9 +486,13 @@ fd_vm_init(
   vm->text_sz = text_sz;
   vm->entry_pc = entry_pc;
   vm->calldests = calldests;
+  vm->seg_cost = NULL;
+  vm->predecoded = NULL;
   vm->syscalls = syscalls;
   vm->input = input;
   vm->input_sz = input_sz;
+  vm->input_region = NULL;
+  vm->input_region_cnt = 0UL;
   vm->trace = trace;
   vm->sha = sha;
 
@@ -406,6 +505,192 @@ fd_vm_init(
   return vm;
 }
 
+uint *
+fd_vm_seg_cost( uint *        cost,
+                ulong const * text,
+                ulong         text_cnt ) {
+
+  if( FD_UNLIKELY( !cost ) ) {
+    FD_LOG_WARNING(( "NULL cost" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !text && text_cnt ) ) {
+    FD_LOG_WARNING(( "NULL text" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( text_cnt>=(ulong)UINT_MAX ) ) {
+    FD_LOG_WARNING(( "text_cnt too large" ));
+    return NULL;
+  }
+
+  /* Walking backward, a branch ends its segment and anything else
+     continues into the segment of the next instruction the interpreter
+     would decode (an LDQ consumes two words and one at the last word
+     sigsplits, which is the end of the text). */
+
+  cost[ text_cnt ] = 0U;
+  for( ulong pc=text_cnt; pc; pc-- ) {
+    ulong opcode = fd_vm_instr_opcode( text[ pc-1UL ] );
+    ulong next   = fd_ulong_min( pc + (ulong)(opcode==0x18UL), text_cnt ); /* FD_SBPF_OP_LDQ */
+    cost[ pc-1UL ] = 1U + ( fd_vm_instr_is_branch( opcode ) ? 0U : cost[ next ] );
+  }
+
+  return cost;
+}
+
+fd_vm_predecoded_t *
+fd_vm_predecode( fd_vm_predecoded_t * out,
+                 ulong const *        text,
+                 ulong                text_cnt,
+                 ulong                entry_pc,
+                 ulong const *        calldests ) {
+
+  if( FD_UNLIKELY( !out ) ) {
+    FD_LOG_WARNING(( "NULL out" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !text && text_cnt ) ) {
+    FD_LOG_WARNING(( "NULL text" ));
+    return NULL;
+  }
+
+  for( ulong pc=0UL; pc<text_cnt; pc++ ) {
+    ulong instr  = text[ pc ];
+    ulong opcode = fd_vm_instr_opcode( instr );
+    uint  imm    = fd_vm_instr_imm   ( instr );
+
+    ulong operand;
+    switch( opcode ) {
+
+    case 0x18UL: /* FD_SBPF_OP_LDQ (at the last word, the interpreter sigsplits) */
+      operand = pc+1UL<text_cnt ? ((ulong)imm | ((ulong)fd_vm_instr_imm( text[ pc+1UL ] ) << 32)) : 0UL;
+      break;
+
+    case 0x85UL: /* FD_SBPF_OP_CALL_IMM (if imm is not a syscall, see the interpreter) */
+      if( imm==0x71e3cf81U ) operand = entry_pc; /* FIXME: MAGIC NUMBER */
+      else {
+        operand = (ulong)fd_pchash_inverse( imm );
+        if( (operand>=text_cnt) || !calldests || !fd_sbpf_calldests_test( calldests, operand ) ) operand = FD_VM_PREDECODED_SIGCALL;
+      }
+      break;
+
+    default:
+      operand = (ulong)(long)fd_vm_instr_offset( instr );
+      break;
+    }
+
+    out[ pc ] = (fd_vm_predecoded_t){
+      .opcode  = (uchar)opcode,
+      .dst     = (uchar)fd_vm_instr_dst( instr ),
+      .src     = (uchar)fd_vm_instr_src( instr ),
+      .imm     = imm,
+      .operand = operand
+    };
+  }
+
+  return out;
+}
+
+fd_vm_t *
+fd_vm_input_direct_map( fd_vm_t *              vm,
+                        fd_vm_input_region_t * region,
+                        ulong                  region_cnt ) {
+
+  if( FD_UNLIKELY( !vm ) ) {
+    FD_LOG_WARNING(( "NULL vm" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( region_cnt && !region ) ) {
+    FD_LOG_WARNING(( "NULL region" ));
+    return NULL;
+  }
+
+  ulong next_off = 0UL;
+  for( ulong i=0UL; i<region_cnt; i++ ) {
+    ulong off = region[i].off;
+    ulong sz  = region[i].sz;
+    if( FD_UNLIKELY( (off<next_off) | (!sz) | (sz>vm->input_sz) | (off>vm->input_sz-sz) | (!region[i].haddr) ) ) {
+      FD_LOG_WARNING(( "bad region %lu (off %lu, sz %lu, input_sz %lu)", i, off, sz, vm->input_sz ));
+      return NULL;
+    }
+    region[i].is_copied = 0;
+    next_off = off + sz;
+  }
+
+  vm->input_region     = region;
+  vm->input_region_cnt = region_cnt;
+  vm->input_win_off    = 0UL;
+  vm->input_win_sz     = 0UL;
+  vm->input_win_haddr  = 0UL;
+  vm->input_win_st     = 0;
+  fd_vm_mem_cfg( vm );
+  return vm;
+}
+
+ulong
+fd_vm_mem_haddr_input_slow( fd_vm_t * vm,
+                            ulong     offset,
+                            ulong     sz,
+                            uchar     write ) {
+
+  /* Note: offset<2^32 and sz is bounded by the caller */
+
+  if( FD_UNLIKELY( (sz>vm->input_sz) || (offset>vm->input_sz-sz) ) ) return 0UL;
+
+  fd_vm_input_region_t * region     = vm->input_region;
+  ulong                  region_cnt = vm->input_region_cnt;
+
+  /* Find the first range that ends after offset */
+
+  ulong lo = 0UL;
+  ulong hi = region_cnt;
+  while( lo<hi ) {
+    ulong mid = (lo+hi)>>1;
+    if( region[mid].off+region[mid].sz<=offset ) lo = mid+1UL;
+    else                                         hi = mid;
+  }
+
+  ulong end = offset + sz;
+
+  if( FD_LIKELY( lo<region_cnt && !write && !region[lo].is_copied &&
+                 region[lo].off<=offset && end<=region[lo].off+region[lo].sz ) ) {
+    vm->input_win_off   = region[lo].off;
+    vm->input_win_sz    = region[lo].sz;
+    vm->input_win_haddr = (ulong)region[lo].haddr;
+    vm->input_win_st    = 0;
+    return (ulong)region[lo].haddr + (offset - region[lo].off);
+  }
+
+  ulong i = lo;
+  for( ; i<region_cnt && region[i].off<end; i++ ) {
+    if( region[i].is_copied ) continue;
+    fd_memcpy( vm->input + region[i].off, region[i].haddr, region[i].sz );
+    region[i].is_copied = 1;
+  }
+
+  /* The access is now backed by the input buffer, which is populated
+     between the nearest ranges that were not copied yet. */
+
+  ulong win_lo = 0UL;
+  for( ulong j=lo; j; j-- ) {
+    if( !region[j-1UL].is_copied ) { win_lo = region[j-1UL].off + region[j-1UL].sz; break; }
+  }
+  ulong win_hi = vm->input_sz;
+  for( ; i<region_cnt; i++ ) {
+    if( !region[i].is_copied ) { win_hi = region[i].off; break; }
+  }
+
+  vm->input_win_off   = win_lo;
+  vm->input_win_sz    = win_hi - win_lo;
+  vm->input_win_haddr = (ulong)vm->input + win_lo;
+  vm->input_win_st    = 1;
+  return (ulong)vm->input + offset;
+}
+
 int
 fd_vm_setup_state_for_execution( fd_vm_t * vm ) {
 
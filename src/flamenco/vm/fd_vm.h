@@ -18,6 +18,48 @@ typedef struct fd_vm fd_vm_t;
 struct fd_vm_shadow { ulong r6; ulong r7; ulong r8; ulong r9; ulong pc; };
 typedef struct fd_vm_shadow fd_vm_shadow_t;
 
+/* A fd_vm_input_region_t describes a range of the input region that is
+   mapped directly to read-only host memory (e.g. the data of an account
+   in funk) instead of being copied into the input buffer.  See
+   fd_vm_input_direct_map. */
+
+struct fd_vm_input_region {
+  ulong         off;       /* Offset of the first byte in the input region */
+  ulong         sz;        /* Size in bytes, positive */
+  uchar const * haddr;     /* Read-only host memory holding the sz bytes */
+  int           is_copied; /* 1 once the bytes have been copied into input (after a write or an access spanning other memory) */
+};
+
+typedef struct fd_vm_input_region fd_vm_input_region_t;
+
+/* FD_VM_ST_DIRTY_* size the bit vector a vm uses to track which 4 KiB
+   pages of its stack and heap (adjacent in the fd_vm_t) a program
+   could have stored to (see fd_vm_mem_st_mark). */
+
+#define FD_VM_ST_DIRTY_LG_PAGE_SZ (12)
+#define FD_VM_ST_DIRTY_PAGE_CNT   ((FD_VM_STACK_MAX+FD_VM_HEAP_MAX)>>FD_VM_ST_DIRTY_LG_PAGE_SZ)
+#define FD_VM_ST_DIRTY_WORD_CNT   ((FD_VM_ST_DIRTY_PAGE_CNT+63UL)>>6)
+
+/* A fd_vm_predecoded_t is a text word with its fields unpacked and its
+   operand resolved ahead of time (see fd_vm_predecode).  16 bytes, such
+   that an instruction never straddles a cache line boundary when the
+   stream is 16 aligned. */
+
+struct fd_vm_predecoded {
+  uchar opcode;
+  uchar dst;    /* In [0,16) */
+  uchar src;    /* In [0,16) */
+  uchar _pad;
+  uint  imm;
+  ulong operand; /* LDQ: the 64-bit value loaded (0 for a LDQ at the last word)
+                    CALL_IMM: the local call target, FD_VM_PREDECODED_SIGCALL if not a valid calldest
+                    Otherwise: the sign extended offset */
+};
+
+typedef struct fd_vm_predecoded fd_vm_predecoded_t;
+
+#define FD_VM_PREDECODED_SIGCALL (~0UL)
+
 struct fd_vm {
 
   /* VM configuration */
@@ -52,6 +94,8 @@ struct fd_vm {
   ulong         entry_pc;  /* Initial program counter, in [0,text_cnt)
                               FIXME: MAKE SURE NOT INTO MW INSTRUCTION, MAKE SURE VALID CALLDEST? */
   ulong const * calldests; /* Bit vector of local functions that can be called into, bit indexed in [0,text_cnt) */
+  uint  const * seg_cost;  /* Linear segment costs, indexed [0,text_cnt], NULL if not precomputed (see fd_vm_seg_cost) */
+  fd_vm_predecoded_t const * predecoded; /* Predecoded text, indexed [0,text_cnt), NULL if not predecoded (see fd_vm_predecode) */
   /* FIXME: ADD BIT VECTOR OF FORBIDDEN BRANCH TARGETS (E.G.
      INTO THE MIDDLE OF A MULTIWORD INSTRUCTION) */
 
@@ -60,6 +104,13 @@ struct fd_vm {
   uchar * input;    /* Program input memory, indexed [0,input_sz) FIXME: ALIGN? */
   ulong   input_sz; /* Program input memory size in bytes, FIXME: BOUNDS? */
 
+  fd_vm_input_region_t * input_region;     /* Directly mapped ranges of input, indexed [0,input_region_cnt), sorted by off */
+  ulong                  input_region_cnt; /* 0 if input is fully populated */
+  ulong                  input_win_off;    /* Input bytes [win_off,win_off+win_sz) are mapped to host memory at win_haddr */
+  ulong                  input_win_sz;     /* (stores allowed if win_st).  Caches the translation of the last input access */
+  ulong                  input_win_haddr;  /* that took the slow path, such that repeated accesses nearby stay inline */
+  int                    input_win_st;
+
   fd_vm_trace_t * trace; /* Location to stream traces (no tracing if NULL) */
 
   /* VM execution and syscall state */
@@ -124,7 +175,12 @@ struct fd_vm {
 
      region_st_sz[1] is also zero such that requests to store data to
      any positive sz range in this region will fail, making region 1
-     unwriteable. */
+     unwriteable.
+
+     If the input region has directly mapped ranges, region_{ld,st}_sz[4]
+     only cover the input bytes below the first such range.  Accesses
+     beyond that fail the tlb lookup and are retried with
+     fd_vm_mem_haddr_input. */
 
    /* FIXME: If accessing memory beyond the end of the current heap
       region is not allowed, sol_alloc_free will need to update the tlb
@@ -136,6 +192,9 @@ struct fd_vm {
   uint  region_ld_sz[6];
   uint  region_st_sz[6];
 
+  ulong st_dirty[ FD_VM_ST_DIRTY_WORD_CNT ]; /* Bit i set if stack/heap page i may have been stored to since the vm was
+                                                formatted or last released to a pool */
+
   ulong          reg   [ FD_VM_REG_MAX         ]; /* registers, indexed [0,FD_VM_REG_CNT).  Note that FD_VM_REG_MAX>FD_VM_REG_CNT.
                                                      As such, malformed instructions, which can have src/dst reg index in
                                                      [0,FD_VM_REG_MAX), cannot access info outside reg.  Aligned 8. */
@@ -166,7 +225,7 @@ FD_PROTOTYPES_BEGIN
    for a memory region to hold a fd_vm_t.  ALIGN is a positive
    integer power of 2.  FOOTPRINT is a multiple of align. These are provided to facilitate compile time declarations. */
 #define FD_VM_ALIGN     (8UL)
-#define FD_VM_FOOTPRINT (799536UL)
+#define FD_VM_FOOTPRINT (799624UL)
 
 /* fd_vm_{align,footprint} give the needed alignment and footprint
    of a memory region suitable to hold an fd_vm_t.
@@ -227,6 +286,115 @@ fd_vm_init(
    fd_vm_trace_t * trace,
    fd_sha256_t * sha );
 
+/* fd_vm_input_direct_map configures an initialized vm to map the
+   region_cnt ranges described by region directly instead of from its
+   input buffer.  This avoids copying large read-only data (e.g.
+   account data) into the input buffer when a program never writes it.
+
+   The input buffer must still be input_sz bytes large and all bytes
+   outside the given ranges must be populated.  Bytes inside the ranges
+   need not be populated.  Program loads that fall entirely within a
+   range that was not copied are served from region haddr.  Any other
+   access touching a range (a store, or a load spanning the range
+   boundary) first copies the range into the input buffer at off and
+   marks the range as copied, such that the program always observes
+   the same memory as if the input buffer was fully populated.
+
+   region must be sorted by off, non-overlapping, within [0,input_sz)
+   and have a lifetime of at least the vm execution.  The host memory
+   behind the ranges must not change during execution.  Call after
+   fd_vm_init (which clears any previous mapping) and before
+   fd_vm_exec.  Returns vm on success and NULL on failure (logs
+   details). */
+
+fd_vm_t *
+fd_vm_input_direct_map( fd_vm_t *              vm,
+                        fd_vm_input_region_t * region,
+                        ulong                  region_cnt );
+
+/* fd_vm_seg_cost computes the linear segment cost table of the
+   text_cnt word program text into the fd_vm_seg_cost_footprint(
+   text_cnt ) byte region at cost (aligned alignof(uint)).  cost[pc] is
+   the number of instructions the vm executes when it starts at pc and
+   runs until the next branch (inclusive) or the end of the text, with
+   every word decoded as the interpreter would decode it if execution
+   reached it.  cost[text_cnt] is 0.  Returns cost on success and NULL
+   on failure (text_cnt too large, logs details).
+
+   The table depends only on the text, so it is meant to be computed
+   once when a program is loaded (e.g. in the program cache) instead of
+   on every execution.
+
+   fd_vm_seg_cost_set configures an initialized vm to meter compute
+   units with the table: the vm debits a whole segment when it enters
+   it and only falls back to tracking instructions individually when
+   the segment would exceed the remaining budget.  The results (pc, ic,
+   cu, faults and in particular sigcost) are exactly the same as without
+   a table (fd_vm_exec_trace and budgets above LONG_MAX ignore the
+   table).  cost must have been computed for the vm's text and have a
+   lifetime of at least the vm execution.  Call after fd_vm_init (which
+   clears any previous table).  Returns vm. */
+
+FD_FN_CONST static inline ulong
+fd_vm_seg_cost_footprint( ulong text_cnt ) {
+  return (text_cnt+1UL)*sizeof(uint);
+}
+
+uint *
+fd_vm_seg_cost( uint *        cost,
+                ulong const * text,
+                ulong         text_cnt );
+
+static inline fd_vm_t *
+fd_vm_seg_cost_set( fd_vm_t *    vm,
+                    uint const * cost ) {
+  vm->seg_cost = cost;
+  return vm;
+}
+
+/* fd_vm_predecode unpacks the text_cnt word program text into the
+   fd_vm_predecode_footprint( text_cnt ) byte region at out (aligned
+   alignof(fd_vm_predecoded_t), ideally 16) such that the interpreter
+   does not have to extract fields, fuse LDQ words or validate local
+   calls on every instruction.  Every word is predecoded as the
+   interpreter would decode it if execution reached it (including the
+   second word of a LDQ).  entry_pc and calldests are as would be given
+   to fd_vm_init (calldests NULL means no local call is valid).
+   Returns out.
+
+   Syscalls are not resolved: the syscalls enabled for a program depend
+   on the vm (they are feature gated) and a predecoded stream lives in
+   shared memory that outlives the process (the program cache), where
+   function pointers would be meaningless.  The interpreter still looks
+   them up in vm->syscalls when it makes the call.
+
+   fd_vm_predecode_set configures an initialized vm to dispatch on the
+   given stream instead of the text.  The stream must have been
+   predecoded from the vm's text, entry_pc and calldests and have a
+   lifetime of at least the vm execution.  It is only used along with a
+   segment cost table (see fd_vm_seg_cost_set) and gives exactly the
+   same results as running from the text.  Call after fd_vm_init (which
+   clears any previous stream).  Returns vm. */
+
+FD_FN_CONST static inline ulong
+fd_vm_predecode_footprint( ulong text_cnt ) {
+  return text_cnt*sizeof(fd_vm_predecoded_t);
+}
+
+fd_vm_predecoded_t *
+fd_vm_predecode( fd_vm_predecoded_t * out,
+                 ulong const *        text,
+                 ulong                text_cnt,
+                 ulong                entry_pc,
+                 ulong const *        calldests );
+
+static inline fd_vm_t *
+fd_vm_predecode_set( fd_vm_t *                  vm,
+                     fd_vm_predecoded_t const * predecoded ) {
+  vm->predecoded = predecoded;
+  return vm;
+}
+
 /* fd_vm_leave leaves the caller's current local join to a vm.
    Returns a pointer to the memory region holding the vm on success
    (this is not necessarily a simple cast of the
@@ -244,6 +412,67 @@ fd_vm_leave( fd_vm_t * vm );
 void *
 fd_vm_delete( void * shmem );
 
+/* fd_vm_pool API ******************************************************/
+
+/* The vm pool is a small per-thread stack of pre-formatted vms.  A
+   fd_vm_t is ~800 KB, most of it stack and heap memory.  Formatting a
+   fresh vm for every program invocation (fd_vm_new clears the whole
+   footprint) and placing it on the thread's stack is expensive,
+   especially for CPI-heavy transactions that nest invocations.  A
+   pooled vm instead only gets the parts that a program could have
+   dirtied cleared when it is released.
+
+   Like fd_scratch, the pool is thread local and must be attached by
+   each thread that wants to use it.  Threads without an attached pool
+   get NULL from fd_vm_pool_acquire and should fall back to formatting
+   a vm themselves. */
+
+/* FD_VM_POOL_VM_MAX is the recommended number of vms in a pool.  Covers
+   the max instruction stack depth (top level + nested CPI) of a
+   transaction. */
+
+#define FD_VM_POOL_VM_MAX (6UL)
+
+/* fd_vm_pool_{align,footprint} give the alignment and footprint of a
+   memory region suitable to back a pool of vm_max vms. */
+
+FD_FN_CONST static inline ulong fd_vm_pool_align    ( void )         { return FD_VM_ALIGN; }
+FD_FN_CONST static inline ulong fd_vm_pool_footprint( ulong vm_max ) { return vm_max*FD_VM_FOOTPRINT; }
+
+/* fd_vm_pool_attach attaches the caller's thread to the vm pool backed
+   by the memory region mem, formatting vm_max vms in it.  vm_max is in
+   [1,FD_VM_POOL_VM_MAX].  The caller's thread must not already be
+   attached.  The thread has ownership of the region until detached.
+
+   fd_vm_pool_detach detaches the caller's thread from its pool.  All
+   vms must have been released.  Returns the memory region, NULL if
+   the thread was not attached. */
+
+void
+fd_vm_pool_attach( void * mem,
+                   ulong  vm_max );
+
+void *
+fd_vm_pool_detach( void );
+
+/* fd_vm_pool_acquire returns a vm from the caller thread's pool,
+   ready to be initialized with fd_vm_init.  All program visible vm
+   memory (stack and heap) is zero, as for a freshly formatted vm.
+   Returns NULL if the thread has no pool attached or all of its vms
+   are in use.
+
+   fd_vm_pool_release returns a vm acquired from the caller thread's
+   pool.  Clears the stack and heap pages stores were made to since the
+   vm was acquired (tracked by st_dirty).  The log and shadow stack are not cleared as
+   they are only ever read in [0,log_sz) and [0,frame_cnt), which
+   fd_vm_init resets. */
+
+fd_vm_t *
+fd_vm_pool_acquire( void );
+
+void
+fd_vm_pool_release( fd_vm_t * vm );
+
 /* fd_vm_validate validates the sBPF program in the given vm.  Returns
    success or an error code.  Called before executing a sBPF program.
    FIXME: DOCUMENT BETTER */
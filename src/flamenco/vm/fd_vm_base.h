@@ -656,6 +656,15 @@ fd_vm_syscall_register_all( fd_sbpf_syscalls_t * syscalls, uchar is_deploy ) {
   return fd_vm_syscall_register_slot( syscalls, NULL, is_deploy );
 }
 
+/* fd_vm_syscall_table_all returns a process wide syscall map populated
+   as by fd_vm_syscall_register_all( syscalls, is_deploy ).  The map is
+   built on first use (thread safe) and has an infinite lifetime.  It
+   is shared by all callers and must be treated as read-only.  This
+   avoids rebuilding the map on every program invocation. */
+
+fd_sbpf_syscalls_t *
+fd_vm_syscall_table_all( uchar is_deploy );
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_flamenco_vm_fd_vm_base_h */
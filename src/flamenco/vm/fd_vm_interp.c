@@ -4,6 +4,88 @@
 /* FIXME: MAKE DIFFERENT VERSIONS FOR EACH COMBO OF CHECK_ALIGN/TRACE? */
 /* TODO: factor out common unpacking code */
 
+/* fd_vm_exec_seg_cost is fd_vm_exec_notrace for a vm with a segment
+   cost table (see fd_vm_seg_cost_set). */
+
+static int
+fd_vm_exec_seg_cost( fd_vm_t * vm ) {
+
+# undef FD_VM_INTERP_EXE_TRACING_ENABLED
+# undef FD_VM_INTERP_MEM_TRACING_ENABLED
+# define FD_VM_INTERP_SEG_COST_ENABLED 1
+
+  /* Pull out variables needed for the fd_vm_interp_core template */
+  int   check_align = vm->check_align;
+  ulong frame_max   = FD_VM_STACK_FRAME_MAX; /* FIXME: vm->frame_max to make this run-time configured */
+
+  ulong const * FD_RESTRICT text          = vm->text;
+  ulong                     text_cnt      = vm->text_cnt;
+  ulong                     text_word_off = vm->text_off / 8UL;
+  ulong                     entry_pc      = vm->entry_pc;
+  ulong const * FD_RESTRICT calldests     = vm->calldests;
+  uint  const * FD_RESTRICT seg_cost      = vm->seg_cost;
+
+  fd_sbpf_syscalls_t const * FD_RESTRICT syscalls = vm->syscalls;
+
+  ulong const * FD_RESTRICT region_haddr = vm->region_haddr;
+  uint  const * FD_RESTRICT region_ld_sz = vm->region_ld_sz;
+  uint  const * FD_RESTRICT region_st_sz = vm->region_st_sz;
+
+  ulong * FD_RESTRICT reg = vm->reg;
+
+  fd_vm_shadow_t * FD_RESTRICT shadow = vm->shadow;
+
+  int err = FD_VM_SUCCESS;
+
+  /* Run the VM */
+# include "fd_vm_interp_core.c"
+
+# undef FD_VM_INTERP_SEG_COST_ENABLED
+
+  return err;
+}
+
+/* fd_vm_exec_predecoded is fd_vm_exec_seg_cost for a vm that also
+   has a predecoded text (see fd_vm_predecode_set). */
+
+static int
+fd_vm_exec_predecoded( fd_vm_t * vm ) {
+
+# undef FD_VM_INTERP_EXE_TRACING_ENABLED
+# undef FD_VM_INTERP_MEM_TRACING_ENABLED
+# define FD_VM_INTERP_SEG_COST_ENABLED   1
+# define FD_VM_INTERP_PREDECODED_ENABLED 1
+
+  /* Pull out variables needed for the fd_vm_interp_core template */
+  int   check_align = vm->check_align;
+  ulong frame_max   = FD_VM_STACK_FRAME_MAX; /* FIXME: vm->frame_max to make this run-time configured */
+
+  ulong                                  text_cnt      = vm->text_cnt;
+  ulong                                  text_word_off = vm->text_off / 8UL;
+  fd_vm_predecoded_t const * FD_RESTRICT predecoded    = vm->predecoded;
+  uint  const *              FD_RESTRICT seg_cost      = vm->seg_cost;
+
+  fd_sbpf_syscalls_t const * FD_RESTRICT syscalls = vm->syscalls;
+
+  ulong const * FD_RESTRICT region_haddr = vm->region_haddr;
+  uint  const * FD_RESTRICT region_ld_sz = vm->region_ld_sz;
+  uint  const * FD_RESTRICT region_st_sz = vm->region_st_sz;
+
+  ulong * FD_RESTRICT reg = vm->reg;
+
+  fd_vm_shadow_t * FD_RESTRICT shadow = vm->shadow;
+
+  int err = FD_VM_SUCCESS;
+
+  /* Run the VM */
+# include "fd_vm_interp_core.c"
+
+# undef FD_VM_INTERP_PREDECODED_ENABLED
+# undef FD_VM_INTERP_SEG_COST_ENABLED
+
+  return err;
+}
+
 int
 fd_vm_exec_notrace( fd_vm_t * vm ) {
 
@@ -12,6 +94,9 @@ fd_vm_exec_notrace( fd_vm_t * vm ) {
 
   if( FD_UNLIKELY( !vm ) ) return FD_VM_ERR_INVAL;
 
+  if( FD_LIKELY( vm->seg_cost && vm->cu<=(ulong)LONG_MAX ) )
+    return FD_LIKELY( vm->predecoded ) ? fd_vm_exec_predecoded( vm ) : fd_vm_exec_seg_cost( vm );
+
   /* Pull out variables needed for the fd_vm_interp_core template */
   int   check_align = vm->check_align;
   ulong frame_max   = FD_VM_STACK_FRAME_MAX; /* FIXME: vm->frame_max to make this run-time configured */
@@ -38,15 +38,18 @@
      instruction.  After a normal halt, this will branch to interp_halt.
      Otherwise, it will branch to the appropriate normal termination. */
 
-  ulong instr;
   ulong opcode;
   ulong dst;
   ulong src;
-  short offset;
   uint  imm;
   ulong reg_dst;
   ulong reg_src;
 
+# ifndef FD_VM_INTERP_PREDECODED_ENABLED
+
+  ulong instr;
+  short offset;
+
 # define FD_VM_INTERP_INSTR_EXEC                                                                 \
   if( FD_UNLIKELY( pc>=text_cnt ) ) goto sigtext; /* Note: untaken branches don't consume BTB */ \
   instr   = text[ pc ];                  /* Guaranteed in-bounds */                              \
@@ -59,6 +62,35 @@
   reg_src = reg[ src ];                  /* Guaranteed in-bounds */                              \
   goto *interp_jump_table[ opcode ]      /* Guaranteed in-bounds */
 
+# else /* FD_VM_INTERP_PREDECODED_ENABLED */
+
+  /* Same but with the fields already unpacked (see fd_vm_predecode).
+     offset holds the predecoded operand: the sign extended offset for
+     most instructions (such that the (ulong)(long)offset casts below
+     are no-ops), the fused value for LDQ and the resolved target for a
+     local CALL_IMM. */
+
+# ifndef FD_VM_INTERP_SEG_COST_ENABLED
+# error "FD_VM_INTERP_PREDECODED_ENABLED requires FD_VM_INTERP_SEG_COST_ENABLED"
+# endif
+
+  fd_vm_predecoded_t const * instr;
+  ulong                      offset;
+
+# define FD_VM_INTERP_INSTR_EXEC                                                                 \
+  if( FD_UNLIKELY( pc>=text_cnt ) ) goto sigtext; /* Note: untaken branches don't consume BTB */ \
+  instr   = predecoded + pc;             /* Guaranteed in-bounds */                              \
+  opcode  = (ulong)instr->opcode;                                                                \
+  dst     = (ulong)instr->dst;                                                                   \
+  src     = (ulong)instr->src;                                                                   \
+  offset  = instr->operand;                                                                      \
+  imm     = instr->imm;                                                                          \
+  reg_dst = reg[ dst ];                  /* Guaranteed in-bounds */                              \
+  reg_src = reg[ src ];                  /* Guaranteed in-bounds */                              \
+  goto *interp_jump_table[ opcode ]      /* Guaranteed in-bounds */
+
+# endif /* FD_VM_INTERP_PREDECODED_ENABLED */
+
   /* FD_VM_INTERP_INSTR_BEGIN / FD_VM_INTERP_INSTR_END bracket opcode's
      implementation for an opcode that does not branch.  On entry, the
      instruction word has been unpacked into dst / src / offset / imm
@@ -101,7 +133,22 @@
      such instructions are cheap 1 cu instructions and processed fast
      and text max is limited in size, this should be acceptable in
      practice.  FIXME: DOUBLE CHECK THE MATH ABOVE AGAINST PROTOCOL
-     LIMITS. */
+     LIMITS.
+
+     When the caller provides the segment cost table seg_cost (see
+     fd_vm_seg_cost), the cost of a segment is known when it is entered
+     (as every instruction in it but the last one is a non-branch).  We
+     then bill the whole segment to ic and cu up front, letting cu go
+     negative (as a long) if it cannot cover it.  The branch at the end
+     of the segment only needs to check the sign of cu and a fault in
+     the middle of the segment refunds the part that did not execute
+     (seg_cost at the faulting pc) before checking it.  This gives
+     exactly the same ic, cu and sigcost semantics as the accounting
+     above (which is used when tracing as the trace needs the
+     pre-instruction ic and cu) provided cu starts at most LONG_MAX
+     (segment costs are less than 2^32). */
+
+# ifndef FD_VM_INTERP_SEG_COST_ENABLED
 
   ulong pc0           = pc;
   ulong ic_correction = 0UL;
@@ -132,6 +179,34 @@
     goto interp_exec
 # endif
 
+# else /* FD_VM_INTERP_SEG_COST_ENABLED */
+
+# ifdef FD_VM_INTERP_EXE_TRACING_ENABLED
+# error "seg cost metering does not support tracing"
+# endif
+
+  ulong seg;
+
+# define FD_VM_INTERP_SEG_DEBIT                          \
+  seg = (ulong)seg_cost[ fd_ulong_min( pc, text_cnt ) ]; \
+  ic += seg;                                             \
+  cu -= seg
+
+  FD_VM_INTERP_SEG_DEBIT;
+
+# define FD_VM_INTERP_BRANCH_BEGIN(opcode)                                                              \
+  interp_##opcode:                                                                                      \
+    /* The segment ending at this branch was billed when it was entered */                              \
+    if( FD_UNLIKELY( (long)cu<0L ) ) goto sigcost; /* Note: untaken branches don't consume BTB */       \
+    /* At this point, cu>=0 */
+
+# define FD_VM_INTERP_BRANCH_END                            \
+    pc++;                                                   \
+    FD_VM_INTERP_SEG_DEBIT; /* Start a new linear segment */ \
+    FD_VM_INTERP_INSTR_EXEC
+
+# endif /* FD_VM_INTERP_SEG_COST_ENABLED */
+
   /* FD_VM_INTERP_STACK_PUSH pushes reg[6:9] onto the shadow stack and
      advances reg[10] to a new user stack frame.  If there are no more
      stack frames available, will do a SIGSTACK. */
@@ -222,9 +297,15 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
 
   FD_VM_INTERP_INSTR_BEGIN(0x18) /* FD_SBPF_OP_LDQ */ /* FIXME: MORE THINKING AROUND LDQ HANDLING HERE */
     pc++;
+#   ifndef FD_VM_INTERP_SEG_COST_ENABLED
     ic_correction++;
+#   endif
     if( FD_UNLIKELY( pc>=text_cnt ) ) goto sigsplit; /* Note: untaken branches don't consume BTB */
+#   ifndef FD_VM_INTERP_PREDECODED_ENABLED
     reg[ dst ] = (ulong)((ulong)imm | ((ulong)fd_vm_instr_imm( text[ pc ] ) << 32));
+#   else
+    reg[ dst ] = offset; /* Fused at predecode */
+#   endif
   FD_VM_INTERP_INSTR_END;
 
   FD_VM_INTERP_INSTR_BEGIN(0x1c) /* FD_SBPF_OP_SUB_REG */
@@ -356,6 +437,7 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x61) { /* FD_SBPF_OP_LDXW */
     ulong vaddr   = reg_src + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(uint), region_haddr, region_ld_sz, 0, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(uint), 0 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(uint) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus */
@@ -366,9 +448,11 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x62) { /* FD_SBPF_OP_STW */
     ulong vaddr   = reg_dst + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(uint), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(uint), 1 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(uint) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(uint) );
     fd_vm_mem_st_4( haddr, imm );
   }
   FD_VM_INTERP_INSTR_END;
@@ -376,9 +460,11 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x63) { /* FD_SBPF_OP_STXW */
     ulong vaddr   = reg_dst + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(uint), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(uint), 1 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(uint) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus/rdonly */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(uint) );
     fd_vm_mem_st_4( haddr, (uint)reg_src );
   }
   FD_VM_INTERP_INSTR_END;
@@ -397,7 +483,8 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
 
   FD_VM_INTERP_INSTR_BEGIN(0x69) { /* FD_SBPF_OP_LDXH */
     ulong vaddr   = reg_src + (ulong)(long)offset;
-    ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ushort), region_haddr, region_ld_sz, 1, 0UL );
+    ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ushort), region_haddr, region_ld_sz, 0, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(ushort), 0 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(ushort) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus */
@@ -408,9 +495,11 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x6a) { /* FD_SBPF_OP_STH */
     ulong vaddr   = reg_dst + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ushort), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(ushort), 1 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(ushort) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(ushort) );
     fd_vm_mem_st_2( haddr, (ushort)imm );
   }
   FD_VM_INTERP_INSTR_END;
@@ -418,9 +507,11 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x6b) { /* FD_SBPF_OP_STXH */
     ulong vaddr   = reg_dst + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ushort), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(ushort), 1 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(ushort) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus/rdonly */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(ushort) );
     fd_vm_mem_st_2( haddr, (ushort)reg_src );
   }
   FD_VM_INTERP_INSTR_END;
@@ -442,6 +533,7 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x71) { /* FD_SBPF_OP_LDXB */
     ulong vaddr = reg_src + (ulong)(long)offset;
     ulong haddr = fd_vm_mem_haddr( vm, vaddr, sizeof(uchar), region_haddr, region_ld_sz, 0, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(uchar), 0 ); /* Directly mapped input */
     if( FD_UNLIKELY( !haddr ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */
     reg[ dst ] = fd_vm_mem_ld_1( haddr );
   }
@@ -450,7 +542,9 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x72) { /* FD_SBPF_OP_STB */
     ulong vaddr = reg_dst + (ulong)(long)offset;
     ulong haddr = fd_vm_mem_haddr( vm, vaddr, sizeof(uchar), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(uchar), 1 ); /* Directly mapped input */
     if( FD_UNLIKELY( !haddr ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(uchar) );
     fd_vm_mem_st_1( haddr, (uchar)imm );
   }
   FD_VM_INTERP_INSTR_END;
@@ -458,7 +552,9 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x73) { /* FD_SBPF_OP_STXB */
     ulong vaddr = reg_dst + (ulong)(long)offset;
     ulong haddr = fd_vm_mem_haddr( vm, vaddr, sizeof(uchar), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(uchar), 1 ); /* Directly mapped input */
     if( FD_UNLIKELY( !haddr ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigrdonly */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(uchar) );
     fd_vm_mem_st_1( haddr, (uchar)reg_src );
   }
   FD_VM_INTERP_INSTR_END;
@@ -478,6 +574,7 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x79) { /* FD_SBPF_OP_LDXQ */
     ulong vaddr   = reg_src + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ulong), region_haddr, region_ld_sz, 0, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(ulong), 0 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(ulong) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus */
@@ -488,9 +585,11 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x7a) { /* FD_SBPF_OP_STQ */
     ulong vaddr   = reg_dst + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ulong), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(ulong), 1 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(ulong) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(ulong) );
     fd_vm_mem_st_8( haddr, (ulong)imm );
   }
   FD_VM_INTERP_INSTR_END;
@@ -498,9 +597,11 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_INSTR_BEGIN(0x7b) { /* FD_SBPF_OP_STXQ */
     ulong vaddr   = reg_dst + (ulong)(long)offset;
     ulong haddr   = fd_vm_mem_haddr( vm, vaddr, sizeof(ulong), region_haddr, region_st_sz, 1, 0UL );
+    if( FD_UNLIKELY( !haddr ) ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sizeof(ulong), 1 ); /* Directly mapped input */
     int   sigsegv = !haddr;
     int   sigbus  = check_align & !fd_ulong_is_aligned( vaddr, sizeof(ulong) );
     if( FD_UNLIKELY( sigsegv | sigbus ) ) goto sigsegv; /* Note: untaken branches don't consume BTB */ /* FIXME: sigbus/rdonly */
+    fd_vm_mem_st_mark( vm, haddr, sizeof(ulong) );
     fd_vm_mem_st_8( haddr, reg_src );
   }
   FD_VM_INTERP_INSTR_END;
@@ -542,11 +643,16 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
 
       FD_VM_INTERP_STACK_PUSH;
 
+#     ifndef FD_VM_INTERP_PREDECODED_ENABLED
       if( FD_UNLIKELY( imm==0x71e3cf81U ) ) pc = entry_pc; /* FIXME: MAGIC NUMBER */
       else {
         pc = (ulong)fd_pchash_inverse( imm );
         if( FD_UNLIKELY( pc>=text_cnt ) || FD_UNLIKELY( !fd_sbpf_calldests_test( calldests, pc ) ) ) goto sigcall;
       }
+#     else /* Target (including the entry magic) resolved and validated at predecode */
+      pc = offset;
+      if( FD_UNLIKELY( pc==FD_VM_PREDECODED_SIGCALL ) ) { pc = (ulong)fd_pchash_inverse( imm ); goto sigcall; }
+#     endif
       pc--;
 
     } else {
@@ -653,7 +759,9 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   FD_VM_INTERP_BRANCH_BEGIN(0x95) /* FD_SBPF_OP_EXIT */
     if( FD_UNLIKELY( !frame_cnt ) ) {
         pc++;
+#       ifndef FD_VM_INTERP_SEG_COST_ENABLED
         pc0 = pc; /* Start a new linear segment */
+#       endif
         goto sigexit; /* Exit program */
     }
     frame_cnt--;
@@ -809,7 +917,17 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
      such that the below does not change the already current values in
      ic and cu.  Thus it also "does the right thing" in both the
      non-branching and branching cases for sigtext.  The same applies to
-     sigsplit. */
+     sigsplit.
+
+     With seg_cost, FD_VM_INTERP_FAULT_REFUND instead gives back the
+     refund instructions of the current segment that were billed but
+     did not execute (those from pc on, none for a sigtext caused by a
+     branch as the segment entered there costs nothing).  If cu is
+     still negative, the instructions that did execute were not covered.
+     A sigsplit is at the LDQ at text_cnt-1 (pc was advanced past it)
+     and a sigexit ends its segment normally. */
+
+# ifndef FD_VM_INTERP_SEG_COST_ENABLED
 
 #define FD_VM_INTERP_FAULT                                          \
   ic_correction = pc - pc0 - ic_correction;                         \
@@ -817,8 +935,26 @@ interp_0x00: // FD_SBPF_OP_ADDL_IMM
   if ( FD_UNLIKELY( ic_correction > cu ) ) err = FD_VM_ERR_SIGCOST; \
   cu -= fd_ulong_min( ic_correction, cu )
 
+#define FD_VM_INTERP_FAULT_SPLIT FD_VM_INTERP_FAULT
+#define FD_VM_INTERP_FAULT_EXIT  FD_VM_INTERP_FAULT
+
+# else /* FD_VM_INTERP_SEG_COST_ENABLED */
+
+#define FD_VM_INTERP_FAULT_REFUND(refund)                      \
+  seg = (ulong)(refund);                                       \
+  ic -= seg;                                                   \
+  cu += seg;                                                   \
+  if( FD_UNLIKELY( (long)cu<0L ) ) err = FD_VM_ERR_SIGCOST;    \
+  cu = fd_ulong_if( (long)cu<0L, 0UL, cu )
+
+#define FD_VM_INTERP_FAULT       FD_VM_INTERP_FAULT_REFUND( seg_cost[ fd_ulong_min( pc, text_cnt ) ] )
+#define FD_VM_INTERP_FAULT_SPLIT FD_VM_INTERP_FAULT_REFUND( seg_cost[ pc-1UL ] )
+#define FD_VM_INTERP_FAULT_EXIT  /* segment billed */
+
+# endif /* FD_VM_INTERP_SEG_COST_ENABLED */
+
 sigtext:     FD_VM_INTERP_FAULT;                  err = FD_VM_ERR_SIGTEXT;   goto interp_halt;
-sigsplit:    FD_VM_INTERP_FAULT;                  err = FD_VM_ERR_SIGSPLIT;  goto interp_halt;
+sigsplit:    FD_VM_INTERP_FAULT_SPLIT;            err = FD_VM_ERR_SIGSPLIT;  goto interp_halt;
 sigcall:     /* ic current */    /* cu current */ err = FD_VM_ERR_SIGCALL;   goto interp_halt;
 sigstack:    /* ic current */    /* cu current */ err = FD_VM_ERR_SIGSTACK;  goto interp_halt;
 sigill:      FD_VM_INTERP_FAULT;                  err = FD_VM_ERR_SIGILL;    goto interp_halt;
@@ -828,9 +964,12 @@ sigsegv:     FD_VM_INTERP_FAULT;                  err = FD_VM_ERR_SIGSEGV;   got
 sigcost:     /* ic current */    cu = 0UL;        err = FD_VM_ERR_SIGCOST;   goto interp_halt;
 sigsyscall:  /* ic current */    /* cu current */ /* err current */          goto interp_halt;
 sigfpe:      FD_VM_INTERP_FAULT;                  err = FD_VM_ERR_SIGFPE;    goto interp_halt;
-sigexit:     FD_VM_INTERP_FAULT; /* cu current */ /* err current */         goto interp_halt;
+sigexit:     FD_VM_INTERP_FAULT_EXIT; /* cu current */ /* err current */    goto interp_halt;
 
+#undef FD_VM_INTERP_FAULT_EXIT
+#undef FD_VM_INTERP_FAULT_SPLIT
 #undef FD_VM_INTERP_FAULT
+#undef FD_VM_INTERP_FAULT_REFUND
 
 interp_halt:
 
@@ -846,6 +985,7 @@ interp_halt:
 
 # undef FD_VM_INTERP_BRANCH_END
 # undef FD_VM_INTERP_BRANCH_BEGIN
+# undef FD_VM_INTERP_SEG_DEBIT
 
 # undef FD_VM_INTERP_INSTR_END
 # undef FD_VM_INTERP_INSTR_BEGIN
@@ -0,0 +1,1484 @@
+#define _GNU_SOURCE
+#include "fd_vm_jit.h"
+#include "fd_vm_private.h"
+#include "../../ballet/sha256/fd_sha256.h"
+
+#if FD_HAS_X86
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* A compiled blob is a header, followed by the image (the part that
+   gets copied into a code cache), followed by the list of immediates
+   of the call instructions resolved at compile time.
+
+   The image starts with a table indexed by text word.  ptab[pc].body
+   gives the image offset of the machine code of the instruction
+   starting at pc (0 if no instruction starts at pc) and ptab[pc].cost
+   gives the number of instructions from pc to the end of its linear
+   segment.  This is used by the dispatcher ("dyn") that handles
+   control transfers whose target is only known at run time (returns,
+   indirect calls, calls resolved at run time, resuming after a
+   syscall).  Then comes the machine code: the common code (prologue,
+   dyn, exits), the code of the instructions in text order (the "main"
+   stream) and the rarely executed paths (slow memory accesses, faults,
+   out of range jump targets ... the "cold" stream).  The image ends
+   with two slots that the cache fills with the addresses of the out of
+   line helpers. */
+
+#define FD_VM_JIT_MAGIC (0xf17eda2c3b170101UL) /* Low byte is the version */
+
+#define FD_VM_JIT_HDR_SZ (128UL)
+
+struct fd_vm_jit_hdr {
+  ulong magic;     /* ==FD_VM_JIT_MAGIC */
+  ulong layout;    /* ==FD_VM_JIT_LAYOUT of the build that compiled it */
+  uchar id[ 32 ];  /* SHA-256 of the image and the call immediates */
+  ulong text_cnt;  /* Program the blob was compiled for */
+  ulong text_off;
+  ulong entry_pc;
+  ulong image_off; /* ==FD_VM_JIT_HDR_SZ */
+  ulong image_sz;
+  ulong entry_off; /* Image offset of the native entry point */
+  ulong slot_off;  /* Image offset of the helper slots */
+  ulong imm_off;   /* Blob offset of the resolved call immediates (uint) */
+  ulong imm_cnt;
+};
+
+typedef struct fd_vm_jit_hdr fd_vm_jit_hdr_t;
+
+FD_STATIC_ASSERT( sizeof(fd_vm_jit_hdr_t)<=FD_VM_JIT_HDR_SZ, layout );
+
+struct fd_vm_jit_ptab {
+  uint body;
+  uint cost;
+};
+
+typedef struct fd_vm_jit_ptab fd_vm_jit_ptab_t;
+
+/* Native code addresses the fd_vm_t through rbx, which points
+   FD_VM_JIT_BIAS bytes into it such that all the fields used by the
+   generated code are within a signed byte displacement (or close). */
+
+#define FD_VM_JIT_BIAS    ((int)offsetof( fd_vm_t, region_haddr ) + 64)
+#define FD_VM_JIT_DISP(f) ((int)offsetof( fd_vm_t, f ) - FD_VM_JIT_BIAS)
+
+#define FD_VM_JIT_LAYOUT ( ((ulong)offsetof( fd_vm_t, pc           )     ) | \
+                           ((ulong)offsetof( fd_vm_t, region_haddr )<<16 ) | \
+                           ((ulong)offsetof( fd_vm_t, reg          )<<32 ) | \
+                           ((ulong)offsetof( fd_vm_t, shadow       )<<48 ) )
+
+FD_STATIC_ASSERT( offsetof( fd_vm_t, shadow )<65536UL, layout );
+FD_STATIC_ASSERT( sizeof(fd_vm_shadow_t)==40UL,        layout );
+
+/* Return codes of native code (other than FD_VM_SUCCESS and
+   FD_VM_ERR_*).  DEOPT indicates the interpreter should resume at
+   vm->pc and SYSCALL that a syscall failed (the error is in
+   fd_vm_jit_private_syscall_err). */
+
+#define FD_VM_JIT_RC_DEOPT   (1)
+#define FD_VM_JIT_RC_SYSCALL (2)
+
+#define FD_VM_JIT_COST_ENTRY (1U<<31) /* ptab cost flag, compile time only */
+
+#define FD_VM_JIT_SLOT_MEM  (0)
+#define FD_VM_JIT_SLOT_CALL (1)
+#define FD_VM_JIT_SLOT_CNT  (2UL)
+
+/* x86-64 registers */
+
+#define RAX (0)
+#define RCX (1)
+#define RDX (2)
+#define RBX (3)
+#define RSP (4)
+#define RBP (5)
+#define RSI (6)
+#define RDI (7)
+#define R8  (8)
+#define R9  (9)
+#define R10 (10)
+#define R11 (11)
+#define R12 (12)
+#define R13 (13)
+#define R14 (14)
+#define R15 (15)
+
+/* x86-64 condition codes */
+
+#define CC_B  (0x2)
+#define CC_AE (0x3)
+#define CC_E  (0x4)
+#define CC_NE (0x5)
+#define CC_BE (0x6)
+#define CC_A  (0x7)
+#define CC_L  (0xc)
+#define CC_GE (0xd)
+#define CC_LE (0xe)
+#define CC_G  (0xf)
+
+/* sBPF r0-r10 live in host registers while native code runs.  r6-r9
+   are in callee saved registers such that they survive helper calls
+   and are cheap to push on calls.  rax, rcx and rdx are scratch and
+   rbx holds vm+FD_VM_JIT_BIAS. */
+
+static int const fd_vm_jit_reg[ 11 ] = { RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15, RBP };
+
+/* fd_vm_jit_asm_t is the state of the assembler.  Code is generated
+   twice: the first pass (img NULL) measures the code and records the
+   location of each instruction in ptab and the second pass writes it.
+   Both passes must emit exactly the same instruction lengths. */
+
+#define JIT_LBL_SIGTEXT  (0)
+#define JIT_LBL_DEOPT    (1)
+#define JIT_LBL_SIGCALL  (2)
+#define JIT_LBL_HALT     (3)
+#define JIT_LBL_FAULT    (4)
+#define JIT_LBL_EPILOGUE (5)
+#define JIT_LBL_ENTRY    (6)
+#define JIT_LBL_DYN      (7)
+#define JIT_LBL_CNT      (8)
+
+struct fd_vm_jit_asm {
+  uchar *            img;      /* NULL when measuring */
+  ulong              off[2];   /* Emit offset of the main / cold stream */
+  int                s;        /* Current stream */
+  fd_vm_jit_ptab_t * ptab;
+  ulong const *      text;
+  ulong              text_cnt;
+  ulong              text_word_off;
+  ulong              entry_pc;
+  ulong const *      calldests;
+  ulong              slot_off;
+  uint *             imm;      /* NULL when measuring */
+  ulong              imm_cnt;
+  ulong              lbl[ JIT_LBL_CNT ];
+};
+
+typedef struct fd_vm_jit_asm fd_vm_jit_asm_t;
+
+static inline ulong jit_here( fd_vm_jit_asm_t const * a ) { return a->off[ a->s ]; }
+
+static inline void jit_cold_begin( fd_vm_jit_asm_t * a ) { a->s = 1; }
+static inline void jit_cold_end  ( fd_vm_jit_asm_t * a ) { a->s = 0; }
+
+static inline void
+jit_u8( fd_vm_jit_asm_t * a,
+        ulong             x ) {
+  ulong off = a->off[ a->s ]++;
+  if( a->img ) a->img[ off ] = (uchar)x;
+}
+
+static inline void
+jit_u32( fd_vm_jit_asm_t * a,
+         ulong             x ) {
+  for( ulong i=0UL; i<4UL; i++ ) jit_u8( a, x>>(8UL*i) );
+}
+
+static inline void
+jit_u64( fd_vm_jit_asm_t * a,
+         ulong             x ) {
+  for( ulong i=0UL; i<8UL; i++ ) jit_u8( a, x>>(8UL*i) );
+}
+
+/* jit_rel32 emits the rel32 of an instruction that ends right after it
+   and transfers control to image offset tgt.  jit_patch rewrites the
+   rel32 at image offset at to transfer control to tgt. */
+
+static inline void
+jit_rel32( fd_vm_jit_asm_t * a,
+           ulong             tgt ) {
+  jit_u32( a, (ulong)(uint)(tgt - (jit_here( a ) + 4UL)) );
+}
+
+static inline void
+jit_patch( fd_vm_jit_asm_t * a,
+           ulong             at,
+           ulong             tgt ) {
+  if( !a->img ) return;
+  uint rel = (uint)(tgt - (at + 4UL));
+  memcpy( a->img + at, &rel, 4UL );
+}
+
+/* jit_op emits an instruction with legacy prefix pfx (0 for none),
+   REX.W w, opcode op (0x0fxx for two byte opcodes) and ModRM reg field
+   r (a register or an opcode extension).  If mem is zero, the r/m
+   operand is the register m.  Otherwise, it is the memory operand
+   [m+idx*2^scale+disp] (idx negative for none).  byte forces a REX
+   prefix such that byte operands in registers 4-7 are sil / dil (and
+   not ah / bh). */
+
+static void
+jit_op( fd_vm_jit_asm_t * a,
+        uint              pfx,
+        int               w,
+        int               byte,
+        uint              op,
+        int               r,
+        int               m,
+        int               mem,
+        int               idx,
+        int               scale,
+        int               disp ) {
+  if( pfx ) jit_u8( a, pfx );
+  uint rex = 0x40U | ((uint)w<<3) | ((uint)(r>>3)<<2) | ((idx>=0 ? (uint)(idx>>3) : 0U)<<1) | (uint)(m>>3);
+  if( (rex!=0x40U) | byte ) jit_u8( a, rex );
+  if( op>0xffU ) jit_u8( a, op>>8 );
+  jit_u8( a, op & 0xffU );
+
+  if( !mem ) {
+    jit_u8( a, 0xc0U | ((uint)(r&7)<<3) | (uint)(m&7) );
+    return;
+  }
+
+  uint mod = ( (!disp) & ((m&7)!=RBP) ) ? 0U : ( (disp==(int)(schar)disp) ? 1U : 2U );
+  if( (idx>=0) | ((m&7)==RSP) ) {
+    jit_u8( a, (mod<<6) | ((uint)(r&7)<<3) | 4U );
+    jit_u8( a, ((uint)scale<<6) | ((idx>=0 ? (uint)(idx&7) : 4U)<<3) | (uint)(m&7) );
+  } else {
+    jit_u8( a, (mod<<6) | ((uint)(r&7)<<3) | (uint)(m&7) );
+  }
+  if(      mod==1U ) jit_u8 ( a, (ulong)(uint)disp );
+  else if( mod==2U ) jit_u32( a, (ulong)(uint)disp );
+}
+
+/* op r, m (register direct) */
+
+static inline void
+jit_rr( fd_vm_jit_asm_t * a,
+        int               w,
+        uint              op,
+        int               r,
+        int               m ) {
+  jit_op( a, 0U, w, 0, op, r, m, 0, -1, 0, 0 );
+}
+
+/* op r, [b+disp] */
+
+static inline void
+jit_rm( fd_vm_jit_asm_t * a,
+        int               w,
+        uint              op,
+        int               r,
+        int               b,
+        int               disp ) {
+  jit_op( a, 0U, w, 0, op, r, b, 1, -1, 0, disp );
+}
+
+/* op r, [b+idx*2^scale+disp] */
+
+static inline void
+jit_rx( fd_vm_jit_asm_t * a,
+        int               w,
+        uint              op,
+        int               r,
+        int               b,
+        int               idx,
+        int               scale,
+        int               disp ) {
+  jit_op( a, 0U, w, 0, op, r, b, 1, idx, scale, disp );
+}
+
+/* op/n m, imm (0x83 / 0x81 group: n is 0 add, 1 or, 4 and, 5 sub, 6
+   xor, 7 cmp).  imm is sign extended. */
+
+static inline void
+jit_alu_ri( fd_vm_jit_asm_t * a,
+            int               w,
+            int               n,
+            int               m,
+            int               imm ) {
+  if( imm==(int)(schar)imm ) { jit_rr( a, w, 0x83U, n, m ); jit_u8 ( a, (ulong)(uint)imm ); }
+  else                       { jit_rr( a, w, 0x81U, n, m ); jit_u32( a, (ulong)(uint)imm ); }
+}
+
+/* mov r32, imm32 (zero extends) */
+
+static inline void
+jit_mov_ri32( fd_vm_jit_asm_t * a,
+              int               r,
+              uint              imm ) {
+  if( r>7 ) jit_u8( a, 0x41U );
+  jit_u8 ( a, 0xb8U + (uint)(r&7) );
+  jit_u32( a, imm );
+}
+
+/* mov r64, imm64 using the shortest encoding */
+
+static inline void
+jit_mov_ri64( fd_vm_jit_asm_t * a,
+              int               r,
+              ulong             imm ) {
+  if( imm==(ulong)(uint)imm ) {
+    jit_mov_ri32( a, r, (uint)imm );
+  } else if( imm==(ulong)(long)(int)imm ) {
+    jit_rr( a, 1, 0xc7U, 0, r );
+    jit_u32( a, imm );
+  } else {
+    jit_u8 ( a, 0x48U | (uint)(r>>3) );
+    jit_u8 ( a, 0xb8U + (uint)(r&7) );
+    jit_u64( a, imm );
+  }
+}
+
+static inline void
+jit_push( fd_vm_jit_asm_t * a,
+          int               r ) {
+  if( r>7 ) jit_u8( a, 0x41U );
+  jit_u8( a, 0x50U + (uint)(r&7) );
+}
+
+static inline void
+jit_pop( fd_vm_jit_asm_t * a,
+         int               r ) {
+  if( r>7 ) jit_u8( a, 0x41U );
+  jit_u8( a, 0x58U + (uint)(r&7) );
+}
+
+static inline void
+jit_bswap( fd_vm_jit_asm_t * a,
+           int               w,
+           int               r ) {
+  if( w | (r>7) ) jit_u8( a, 0x40U | ((uint)w<<3) | (uint)(r>>3) );
+  jit_u8( a, 0x0fU );
+  jit_u8( a, 0xc8U + (uint)(r&7) );
+}
+
+static inline void
+jit_jmp( fd_vm_jit_asm_t * a,
+         ulong             tgt ) {
+  jit_u8( a, 0xe9U );
+  jit_rel32( a, tgt );
+}
+
+static inline void
+jit_jcc( fd_vm_jit_asm_t * a,
+         uint              cc,
+         ulong             tgt ) {
+  jit_u8( a, 0x0fU );
+  jit_u8( a, 0x80U | cc );
+  jit_rel32( a, tgt );
+}
+
+/* jit_jcc_fwd emits a jcc (cc ~0U for jmp) to a location not known
+   yet and returns where the rel32 should be patched. */
+
+static inline ulong
+jit_jcc_fwd( fd_vm_jit_asm_t * a,
+             uint              cc ) {
+  if( cc==~0U ) jit_u8( a, 0xe9U );
+  else        { jit_u8( a, 0x0fU ); jit_u8( a, 0x80U | cc ); }
+  ulong at = jit_here( a );
+  jit_u32( a, 0UL );
+  return at;
+}
+
+/* call [rip+slot] */
+
+static inline void
+jit_call_slot( fd_vm_jit_asm_t * a,
+               ulong             slot ) {
+  jit_u8( a, 0xffU );
+  jit_u8( a, 0x15U );
+  jit_rel32( a, a->slot_off + 8UL*slot );
+}
+
+/* jit_{spill,reload} store / load the sBPF registers to / from vm->reg */
+
+static void
+jit_spill( fd_vm_jit_asm_t * a ) {
+  for( int i=0; i<11; i++ ) jit_rm( a, 1, 0x89U, fd_vm_jit_reg[ i ], RBX, FD_VM_JIT_DISP( reg ) + 8*i );
+}
+
+static void
+jit_reload( fd_vm_jit_asm_t * a ) {
+  for( int i=0; i<11; i++ ) jit_rm( a, 1, 0x8bU, fd_vm_jit_reg[ i ], RBX, FD_VM_JIT_DISP( reg ) + 8*i );
+}
+
+/* jit_fault emits code that halts with err at pc and refunds refund
+   cu of the current linear segment.  jit_jcc_fault does so if cc holds
+   (the fault code goes to the cold stream). */
+
+static void
+jit_fault( fd_vm_jit_asm_t * a,
+           int               err,
+           ulong             pc,
+           ulong             refund ) {
+  if( err ) jit_mov_ri32( a, RAX, (uint)err );
+  else      jit_rr( a, 0, 0x31U, RAX, RAX );
+  jit_mov_ri32( a, RCX, (uint)pc );
+  if( refund ) jit_mov_ri32( a, RDX, (uint)refund );
+  else         jit_rr( a, 0, 0x31U, RDX, RDX );
+  jit_jmp( a, a->lbl[ JIT_LBL_FAULT ] );
+}
+
+static void
+jit_jcc_fault( fd_vm_jit_asm_t * a,
+               uint              cc,
+               int               err,
+               ulong             pc,
+               ulong             refund ) {
+  ulong at = jit_jcc_fwd( a, cc );
+  jit_cold_begin( a );
+  jit_patch( a, at, jit_here( a ) );
+  jit_fault( a, err, pc, refund );
+  jit_cold_end( a );
+}
+
+static inline int
+jit_is_start( fd_vm_jit_asm_t const * a,
+              ulong                   pc ) {
+  return (pc<a->text_cnt) && a->ptab[ pc ].body;
+}
+
+static inline ulong
+jit_refund( fd_vm_jit_asm_t const * a,
+            ulong                   pc ) {
+  return (ulong)(a->ptab[ pc ].cost & ~FD_VM_JIT_COST_ENTRY);
+}
+
+/* jit_target returns the image offset to transfer control to in order
+   to start a new linear segment at pc.  If pc is not the start of an
+   instruction, this is a stub that goes through dyn (which will fault
+   or deopt as appropriate). */
+
+static ulong
+jit_target( fd_vm_jit_asm_t * a,
+            ulong             pc ) {
+  if( jit_is_start( a, pc ) ) return (ulong)a->ptab[ pc ].body - 8UL;
+  jit_cold_begin( a );
+  ulong stub = jit_here( a );
+  jit_mov_ri64( a, RAX, pc );
+  jit_jmp( a, a->lbl[ JIT_LBL_DYN ] );
+  jit_cold_end( a );
+  return stub;
+}
+
+/* jit_push_frame emits FD_VM_INTERP_STACK_PUSH for a call at pc. */
+
+static void
+jit_push_frame( fd_vm_jit_asm_t * a,
+                ulong             pc ) {
+  int sh = FD_VM_JIT_DISP( shadow );
+  jit_rm( a, 1, 0x83U, 7, RBX, FD_VM_JIT_DISP( frame_cnt ) ); jit_u8( a, FD_VM_STACK_FRAME_MAX ); /* cmp [frame_cnt], max */
+  jit_jcc_fault( a, CC_AE, FD_VM_ERR_SIGSTACK, pc, 0UL );
+  jit_rm( a, 1, 0x8bU, RAX, RBX, FD_VM_JIT_DISP( frame_cnt ) );                                    /* mov rax, [frame_cnt] */
+  jit_rx( a, 1, 0x8dU, RCX, RAX, RAX, 2, 0 );                                                      /* lea rcx, [rax+rax*4] */
+  jit_rx( a, 1, 0x89U, R12, RBX, RCX, 3, sh      );                                                /* shadow[frame_cnt].r6 */
+  jit_rx( a, 1, 0x89U, R13, RBX, RCX, 3, sh +  8 );
+  jit_rx( a, 1, 0x89U, R14, RBX, RCX, 3, sh + 16 );
+  jit_rx( a, 1, 0x89U, R15, RBX, RCX, 3, sh + 24 );
+  jit_rx( a, 1, 0xc7U, 0,   RBX, RCX, 3, sh + 32 ); jit_u32( a, pc );                              /* shadow[frame_cnt].pc */
+  jit_rm( a, 1, 0x83U, 0, RBX, FD_VM_JIT_DISP( frame_cnt ) ); jit_u8( a, 1UL );                    /* add [frame_cnt], 1 */
+  jit_alu_ri( a, 1, 0, RBP, (int)(FD_VM_STACK_FRAME_SZ + FD_VM_STACK_GUARD_SZ) );                  /* add rbp, frame+guard */
+}
+
+/* jit_call_target returns the pc of the instruction a CALL_IMM with
+   the given imm calls if it can be resolved at compile time and ~0UL
+   otherwise (including if it might be a syscall, which is only known
+   at run time). */
+
+static ulong
+jit_call_target( ulong         imm,
+                 ulong         text_cnt,
+                 ulong         entry_pc,
+                 ulong const * calldests ) {
+  if( imm==0x71e3cf81UL ) return entry_pc; /* FIXME: MAGIC NUMBER (see fd_vm_interp_core.c) */
+  if( !calldests ) return ~0UL;
+  ulong pc = (ulong)fd_pchash_inverse( (uint)imm );
+  if( (pc>=text_cnt) || !fd_sbpf_calldests_test( calldests, pc ) ) return ~0UL;
+  return pc;
+}
+
+/* jit_mem emits a load (st==0) or store of sz bytes at vaddr
+   reg[b]+offset.  The inline path covers accesses fully inside the
+   tlb of regions 1-4 (with the stack gaps) and everything else
+   (misaligned, input region slow path, faults) goes through
+   fd_vm_jit_mem.  On resume, rcx holds the host address. */
+
+static void
+jit_mem( fd_vm_jit_asm_t * a,
+         ulong             pc,
+         ulong             instr,
+         int               b,
+         ulong             sz,
+         int               write,
+         int               st ) {
+  ulong slow[6]; ulong slow_cnt = 0UL;
+  int   tbl = st ? FD_VM_JIT_DISP( region_st_sz ) : FD_VM_JIT_DISP( region_ld_sz );
+
+  jit_rm( a, 1, 0x8dU, RAX, b, (int)fd_vm_instr_offset( instr ) ); /* lea rax, [b+offset] */
+  jit_rr( a, 1, 0x89U, RAX, RDX );                                  /* mov rdx, rax */
+  jit_rr( a, 1, 0xc1U, 5, RDX ); jit_u8( a, 32UL );                 /* shr rdx, 32 */
+  jit_rm( a, 0, 0x8dU, RCX, RDX, -1 );                              /* lea ecx, [rdx-1] */
+  jit_alu_ri( a, 0, 7, RCX, 3 );                                    /* cmp ecx, 3 */
+  slow[ slow_cnt++ ] = jit_jcc_fwd( a, CC_A );
+  if( sz>1UL ) {
+    jit_u8( a, 0xa8U ); jit_u8( a, sz-1UL );                        /* test al, sz-1 */
+    slow[ slow_cnt++ ] = jit_jcc_fwd( a, CC_NE );
+  }
+  jit_alu_ri( a, 0, 7, RDX, 2 );                                    /* cmp edx, 2 */
+  ulong not_stack = jit_jcc_fwd( a, CC_NE );
+  jit_u8( a, 0xa9U ); jit_u32( a, 0x1000UL );                       /* test eax, 0x1000 */
+  slow[ slow_cnt++ ] = jit_jcc_fwd( a, CC_NE );
+  jit_patch( a, not_stack, jit_here( a ) );
+  jit_rx( a, 0, 0x8bU, RCX, RBX, RDX, 2, tbl );                     /* mov ecx, [region_sz+rdx*4] */
+  jit_alu_ri( a, 1, 5, RCX, (int)sz );                              /* sub rcx, sz */
+  slow[ slow_cnt++ ] = jit_jcc_fwd( a, CC_B );
+  jit_rr( a, 0, 0x39U, RCX, RAX );                                  /* cmp eax, ecx */
+  slow[ slow_cnt++ ] = jit_jcc_fwd( a, CC_A );
+  jit_rr( a, 0, 0x89U, RAX, RCX );                                  /* mov ecx, eax */
+  jit_rx( a, 1, 0x03U, RCX, RBX, RDX, 3, FD_VM_JIT_DISP( region_haddr ) ); /* add rcx, [region_haddr+rdx*8] */
+  if( st ) { /* fd_vm_mem_st_mark (inline accesses are aligned so never span two pages) */
+    jit_rr( a, 1, 0x89U, RCX, RDX );                                /* mov rdx, rcx */
+    jit_rr( a, 1, 0x29U, RBX, RDX );                                /* sub rdx, rbx */
+    jit_alu_ri( a, 1, 5, RDX, FD_VM_JIT_DISP( stack ) );            /* sub rdx, stack */
+    jit_alu_ri( a, 1, 7, RDX, (int)(FD_VM_STACK_MAX+FD_VM_HEAP_MAX) ); /* cmp rdx, stack_sz+heap_sz */
+    ulong skip = jit_jcc_fwd( a, CC_AE );
+    jit_rr( a, 1, 0xc1U, 5, RDX ); jit_u8( a, FD_VM_ST_DIRTY_LG_PAGE_SZ ); /* shr rdx, lg_page_sz */
+    jit_rm( a, 1, 0x0fabU, RDX, RBX, FD_VM_JIT_DISP( st_dirty ) );  /* bts [st_dirty], rdx */
+    jit_patch( a, skip, jit_here( a ) );
+  }
+  ulong resume = jit_here( a );
+
+  jit_cold_begin( a );
+  for( ulong i=0UL; i<slow_cnt; i++ ) jit_patch( a, slow[ i ], jit_here( a ) );
+  for( int i=0; i<6; i++ ) jit_push( a, fd_vm_jit_reg[ i ] );
+  jit_rm( a, 1, 0x8dU, RDI, RBX, -FD_VM_JIT_BIAS );                 /* lea rdi, [vm] */
+  jit_rr( a, 1, 0x89U, RAX, RSI );                                  /* mov rsi, rax */
+  jit_mov_ri32( a, RDX, (uint)(sz | ((ulong)write<<8) | ((ulong)st<<9)) );
+  jit_call_slot( a, FD_VM_JIT_SLOT_MEM );
+  for( int i=5; i>=0; i-- ) jit_pop( a, fd_vm_jit_reg[ i ] );
+  jit_rr( a, 1, 0x89U, RAX, RCX );                                  /* mov rcx, rax */
+  jit_rr( a, 1, 0x85U, RAX, RAX );                                  /* test rax, rax */
+  jit_jcc( a, CC_NE, resume );
+  jit_fault( a, FD_VM_ERR_SIGSEGV, pc, jit_refund( a, pc ) );
+  jit_cold_end( a );
+}
+
+/* jit_instr emits the code for the instruction at pc.  This must
+   match fd_vm_interp_core.c exactly. */
+
+static void
+jit_instr( fd_vm_jit_asm_t * a,
+           ulong             pc ) {
+  ulong instr  = a->text[ pc ];
+  ulong opcode = fd_vm_instr_opcode( instr );
+  int   d      = fd_vm_jit_reg[ fd_vm_instr_dst( instr ) ]; /* Validated by the prepass */
+  int   s      = fd_vm_jit_reg[ fd_vm_instr_src( instr ) ];
+  uint  imm    = fd_vm_instr_imm( instr );
+  int   simm   = (int)imm;
+  ulong refund = jit_refund( a, pc );
+
+  if( fd_vm_instr_is_branch( opcode ) ) {
+    jit_rm( a, 1, 0x83U, 7, RBX, FD_VM_JIT_DISP( cu ) ); jit_u8( a, 0UL ); /* cmp [cu], 0 */
+    jit_jcc_fault( a, CC_L, FD_VM_ERR_SIGCOST, pc, 0UL );
+  }
+
+  ulong tgt = pc + 1UL + (ulong)(long)fd_vm_instr_offset( instr ); /* For jumps */
+  uint  cc  = 0U;
+
+  switch( opcode ) {
+
+  /* 32-bit ALU.  add, sub and mul sign extend their result, the
+     others zero extend it. */
+
+  case 0x00: /* FD_SBPF_OP_ADDL_IMM */
+  case 0x04: jit_alu_ri( a, 0, 0, d, simm ); goto sext;                         /* FD_SBPF_OP_ADD_IMM */
+  case 0x0c: jit_rr( a, 0, 0x01U, s, d );    goto sext;                         /* FD_SBPF_OP_ADD_REG */
+  case 0x14: jit_alu_ri( a, 0, 5, d, simm ); goto sext;                         /* FD_SBPF_OP_SUB_IMM */
+  case 0x1c: jit_rr( a, 0, 0x29U, s, d );    goto sext;                         /* FD_SBPF_OP_SUB_REG */
+  case 0x24: jit_rr( a, 0, 0x69U, d, d ); jit_u32( a, imm ); goto sext;         /* FD_SBPF_OP_MUL_IMM */
+  case 0x2c: jit_rr( a, 0, 0x0fafU, d, s );  goto sext;                         /* FD_SBPF_OP_MUL_REG */
+  sext:      jit_rr( a, 1, 0x63U, d, d );    break;                             /* movsxd d, d32 */
+
+  case 0x44: jit_alu_ri( a, 0, 1, d, simm ); break;                             /* FD_SBPF_OP_OR_IMM */
+  case 0x4c: jit_rr( a, 0, 0x09U, s, d );    break;                             /* FD_SBPF_OP_OR_REG */
+  case 0x54: jit_alu_ri( a, 0, 4, d, simm ); break;                             /* FD_SBPF_OP_AND_IMM */
+  case 0x5c: jit_rr( a, 0, 0x21U, s, d );    break;                             /* FD_SBPF_OP_AND_REG */
+  case 0xa4: jit_alu_ri( a, 0, 6, d, simm ); break;                             /* FD_SBPF_OP_XOR_IMM */
+  case 0xac: jit_rr( a, 0, 0x31U, s, d );    break;                             /* FD_SBPF_OP_XOR_REG */
+  case 0xb4: jit_mov_ri32( a, d, imm );      break;                             /* FD_SBPF_OP_MOV_IMM */
+  case 0xbc: jit_rr( a, 0, 0x89U, s, d );    break;                             /* FD_SBPF_OP_MOV_REG */
+  case 0x84: jit_rr( a, 0, 0xf7U, 3, d );    break;                             /* FD_SBPF_OP_NEG */
+
+  /* Shifts use the hardware count masking (as the interpreter
+     does).  The trailing mov makes sure the result is zero extended
+     even when the masked count is zero. */
+
+  case 0x64: jit_rr( a, 0, 0xc1U, 4, d ); jit_u8( a, imm & 31U ); goto zext32;  /* FD_SBPF_OP_LSH_IMM */
+  case 0x74: jit_rr( a, 0, 0xc1U, 5, d ); jit_u8( a, imm & 31U ); goto zext32;  /* FD_SBPF_OP_RSH_IMM */
+  case 0xc4: jit_rr( a, 0, 0xc1U, 7, d ); jit_u8( a, imm & 31U ); goto zext32;  /* FD_SBPF_OP_ARSH_IMM */
+  case 0x6c: jit_rr( a, 0, 0x89U, s, RCX ); jit_rr( a, 0, 0xd3U, 4, d ); goto zext32; /* FD_SBPF_OP_LSH_REG */
+  case 0x7c: jit_rr( a, 0, 0x89U, s, RCX ); jit_rr( a, 0, 0xd3U, 5, d ); goto zext32; /* FD_SBPF_OP_RSH_REG */
+  case 0xcc: jit_rr( a, 0, 0x89U, s, RCX ); jit_rr( a, 0, 0xd3U, 7, d ); goto zext32; /* FD_SBPF_OP_ARSH_REG */
+  zext32:    jit_rr( a, 0, 0x89U, d, d ); break;                                /* mov d32, d32 */
+
+  case 0x34: case 0x94: /* FD_SBPF_OP_{DIV,MOD}_IMM (imm!=0 validated by the prepass) */
+    jit_rr( a, 0, 0x89U, d, RAX );
+    jit_rr( a, 0, 0x31U, RDX, RDX );
+    jit_mov_ri32( a, RCX, imm );
+    jit_rr( a, 0, 0xf7U, 6, RCX );
+    jit_rr( a, 0, 0x89U, opcode==0x34 ? RAX : RDX, d );
+    break;
+
+  case 0x3c: case 0x9c: /* FD_SBPF_OP_{DIV,MOD}_REG */
+    jit_rr( a, 0, 0x89U, s, RCX );
+    jit_rr( a, 0, 0x85U, RCX, RCX );
+    jit_jcc_fault( a, CC_E, FD_VM_ERR_SIGFPE, pc, refund );
+    jit_rr( a, 0, 0x89U, d, RAX );
+    jit_rr( a, 0, 0x31U, RDX, RDX );
+    jit_rr( a, 0, 0xf7U, 6, RCX );
+    jit_rr( a, 0, 0x89U, opcode==0x3c ? RAX : RDX, d );
+    break;
+
+  /* 64-bit ALU.  Immediates are sign extended except for DIV64_IMM. */
+
+  case 0x07: jit_alu_ri( a, 1, 0, d, simm ); break;                             /* FD_SBPF_OP_ADD64_IMM */
+  case 0x0f: jit_rr( a, 1, 0x01U, s, d );    break;                             /* FD_SBPF_OP_ADD64_REG */
+  case 0x17: jit_alu_ri( a, 1, 5, d, simm ); break;                             /* FD_SBPF_OP_SUB64_IMM */
+  case 0x1f: jit_rr( a, 1, 0x29U, s, d );    break;                             /* FD_SBPF_OP_SUB64_REG */
+  case 0x27: jit_rr( a, 1, 0x69U, d, d ); jit_u32( a, imm ); break;             /* FD_SBPF_OP_MUL64_IMM */
+  case 0x2f: jit_rr( a, 1, 0x0fafU, d, s );  break;                             /* FD_SBPF_OP_MUL64_REG */
+  case 0x47: jit_alu_ri( a, 1, 1, d, simm ); break;                             /* FD_SBPF_OP_OR64_IMM */
+  case 0x4f: jit_rr( a, 1, 0x09U, s, d );    break;                             /* FD_SBPF_OP_OR64_REG */
+  case 0x57: jit_alu_ri( a, 1, 4, d, simm ); break;                             /* FD_SBPF_OP_AND64_IMM */
+  case 0x5f: jit_rr( a, 1, 0x21U, s, d );    break;                             /* FD_SBPF_OP_AND64_REG */
+  case 0xa7: jit_alu_ri( a, 1, 6, d, simm ); break;                             /* FD_SBPF_OP_XOR64_IMM */
+  case 0xaf: jit_rr( a, 1, 0x31U, s, d );    break;                             /* FD_SBPF_OP_XOR64_REG */
+  case 0xb7: jit_mov_ri64( a, d, (ulong)(long)simm ); break;                    /* FD_SBPF_OP_MOV64_IMM */
+  case 0xbf: jit_rr( a, 1, 0x89U, s, d );    break;                             /* FD_SBPF_OP_MOV64_REG */
+  case 0x87: jit_rr( a, 1, 0xf7U, 3, d );    break;                             /* FD_SBPF_OP_NEG64 */
+  case 0x67: jit_rr( a, 1, 0xc1U, 4, d ); jit_u8( a, imm & 63U ); break;        /* FD_SBPF_OP_LSH64_IMM */
+  case 0x77: jit_rr( a, 1, 0xc1U, 5, d ); jit_u8( a, imm & 63U ); break;        /* FD_SBPF_OP_RSH64_IMM */
+  case 0xc7: jit_rr( a, 1, 0xc1U, 7, d ); jit_u8( a, imm & 63U ); break;        /* FD_SBPF_OP_ARSH64_IMM */
+  case 0x6f: jit_rr( a, 0, 0x89U, s, RCX ); jit_rr( a, 1, 0xd3U, 4, d ); break; /* FD_SBPF_OP_LSH64_REG */
+  case 0x7f: jit_rr( a, 0, 0x89U, s, RCX ); jit_rr( a, 1, 0xd3U, 5, d ); break; /* FD_SBPF_OP_RSH64_REG */
+  case 0xcf: jit_rr( a, 0, 0x89U, s, RCX ); jit_rr( a, 1, 0xd3U, 7, d ); break; /* FD_SBPF_OP_ARSH64_REG */
+
+  case 0x37: case 0x97: /* FD_SBPF_OP_{DIV,MOD}64_IMM (imm!=0 validated by the prepass) */
+    jit_rr( a, 1, 0x89U, d, RAX );
+    jit_rr( a, 0, 0x31U, RDX, RDX );
+    jit_mov_ri64( a, RCX, opcode==0x37 ? (ulong)imm : (ulong)(long)simm );
+    jit_rr( a, 1, 0xf7U, 6, RCX );
+    jit_rr( a, 1, 0x89U, opcode==0x37 ? RAX : RDX, d );
+    break;
+
+  case 0x3f: case 0x9f: /* FD_SBPF_OP_{DIV,MOD}64_REG */
+    jit_rr( a, 1, 0x89U, s, RCX );
+    jit_rr( a, 1, 0x85U, RCX, RCX );
+    jit_jcc_fault( a, CC_E, FD_VM_ERR_SIGFPE, pc, refund );
+    jit_rr( a, 1, 0x89U, d, RAX );
+    jit_rr( a, 0, 0x31U, RDX, RDX );
+    jit_rr( a, 1, 0xf7U, 6, RCX );
+    jit_rr( a, 1, 0x89U, opcode==0x3f ? RAX : RDX, d );
+    break;
+
+  case 0xd4: /* FD_SBPF_OP_END_LE */
+    switch( imm ) {
+    case 16U: jit_rr( a, 0, 0x0fb7U, d, d ); break;                             /* movzx d32, d16 */
+    case 32U: jit_rr( a, 0, 0x89U, d, d );   break;                             /* mov d32, d32 */
+    case 64U:                                break;
+    default:  jit_fault( a, FD_VM_ERR_SIGILL, pc, refund ); break;
+    }
+    break;
+
+  case 0xdc: /* FD_SBPF_OP_END_BE */
+    switch( imm ) {
+    case 16U: jit_op( a, 0x66U, 0, 0, 0xc1U, 0, d, 0, -1, 0, 0 ); jit_u8( a, 8UL ); /* rol d16, 8 */
+              jit_rr( a, 0, 0x0fb7U, d, d ); break;                                 /* movzx d32, d16 */
+    case 32U: jit_bswap( a, 0, d ); break;
+    case 64U: jit_bswap( a, 1, d ); break;
+    default:  jit_fault( a, FD_VM_ERR_SIGILL, pc, refund ); break;
+    }
+    break;
+
+  case 0x18: /* FD_SBPF_OP_LDQ */
+    if( FD_UNLIKELY( pc+1UL>=a->text_cnt ) ) jit_fault( a, FD_VM_ERR_SIGSPLIT, a->text_cnt, refund );
+    else jit_mov_ri64( a, d, (ulong)imm | ((ulong)fd_vm_instr_imm( a->text[ pc+1UL ] )<<32) );
+    break;
+
+  /* Memory */
+
+  case 0x71: jit_mem( a, pc, instr, s, 1UL, 0, 0 ); jit_rm( a, 0, 0x0fb6U, d, RCX, 0 ); break; /* FD_SBPF_OP_LDXB */
+  case 0x69: jit_mem( a, pc, instr, s, 2UL, 1, 0 ); jit_rm( a, 0, 0x0fb7U, d, RCX, 0 ); break; /* FD_SBPF_OP_LDXH */
+  case 0x61: jit_mem( a, pc, instr, s, 4UL, 0, 0 ); jit_rm( a, 0, 0x8bU,   d, RCX, 0 ); break; /* FD_SBPF_OP_LDXW */
+  case 0x79: jit_mem( a, pc, instr, s, 8UL, 0, 0 ); jit_rm( a, 1, 0x8bU,   d, RCX, 0 ); break; /* FD_SBPF_OP_LDXQ */
+
+  case 0x72: /* FD_SBPF_OP_STB */
+    jit_mem( a, pc, instr, d, 1UL, 1, 1 );
+    jit_rm( a, 0, 0xc6U, 0, RCX, 0 ); jit_u8( a, imm );
+    break;
+  case 0x6a: /* FD_SBPF_OP_STH */
+    jit_mem( a, pc, instr, d, 2UL, 1, 1 );
+    jit_op( a, 0x66U, 0, 0, 0xc7U, 0, RCX, 1, -1, 0, 0 ); jit_u8( a, imm ); jit_u8( a, imm>>8 );
+    break;
+  case 0x62: /* FD_SBPF_OP_STW */
+    jit_mem( a, pc, instr, d, 4UL, 1, 1 );
+    jit_rm( a, 0, 0xc7U, 0, RCX, 0 ); jit_u32( a, imm );
+    break;
+  case 0x7a: /* FD_SBPF_OP_STQ (imm zero extended) */
+    jit_mem( a, pc, instr, d, 8UL, 1, 1 );
+    jit_mov_ri32( a, RAX, imm );
+    jit_rm( a, 1, 0x89U, RAX, RCX, 0 );
+    break;
+
+  case 0x73: jit_mem( a, pc, instr, d, 1UL, 1, 1 ); jit_op( a, 0U,    0, 1, 0x88U, s, RCX, 1, -1, 0, 0 ); break; /* FD_SBPF_OP_STXB */
+  case 0x6b: jit_mem( a, pc, instr, d, 2UL, 1, 1 ); jit_op( a, 0x66U, 0, 0, 0x89U, s, RCX, 1, -1, 0, 0 ); break; /* FD_SBPF_OP_STXH */
+  case 0x63: jit_mem( a, pc, instr, d, 4UL, 1, 1 ); jit_rm( a, 0, 0x89U, s, RCX, 0 ); break;                     /* FD_SBPF_OP_STXW */
+  case 0x7b: jit_mem( a, pc, instr, d, 8UL, 1, 1 ); jit_rm( a, 1, 0x89U, s, RCX, 0 ); break;                     /* FD_SBPF_OP_STXQ */
+
+  /* Jumps */
+
+  case 0x05: jit_jmp( a, jit_target( a, tgt ) ); break; /* FD_SBPF_OP_JA */
+
+  case 0x15: cc = CC_E;  goto jimm; /* FD_SBPF_OP_JEQ_IMM */
+  case 0x25: cc = CC_A;  goto jimm; /* FD_SBPF_OP_JGT_IMM */
+  case 0x35: cc = CC_AE; goto jimm; /* FD_SBPF_OP_JGE_IMM */
+  case 0x55: cc = CC_NE; goto jimm; /* FD_SBPF_OP_JNE_IMM */
+  case 0x65: cc = CC_G;  goto jimm; /* FD_SBPF_OP_JSGT_IMM */
+  case 0x75: cc = CC_GE; goto jimm; /* FD_SBPF_OP_JSGE_IMM */
+  case 0xa5: cc = CC_B;  goto jimm; /* FD_SBPF_OP_JLT_IMM */
+  case 0xb5: cc = CC_BE; goto jimm; /* FD_SBPF_OP_JLE_IMM */
+  case 0xc5: cc = CC_L;  goto jimm; /* FD_SBPF_OP_JSLT_IMM */
+  case 0xd5: cc = CC_LE; goto jimm; /* FD_SBPF_OP_JSLE_IMM */
+  jimm:
+    jit_alu_ri( a, 1, 7, d, simm );
+    jit_jcc( a, cc, jit_target( a, tgt ) );
+    break;
+  case 0x45: /* FD_SBPF_OP_JSET_IMM */
+    jit_rr( a, 1, 0xf7U, 0, d ); jit_u32( a, imm );
+    jit_jcc( a, CC_NE, jit_target( a, tgt ) );
+    break;
+
+  case 0x1d: cc = CC_E;  goto jreg; /* FD_SBPF_OP_JEQ_REG */
+  case 0x2d: cc = CC_A;  goto jreg; /* FD_SBPF_OP_JGT_REG */
+  case 0x3d: cc = CC_AE; goto jreg; /* FD_SBPF_OP_JGE_REG */
+  case 0x5d: cc = CC_NE; goto jreg; /* FD_SBPF_OP_JNE_REG */
+  case 0x6d: cc = CC_G;  goto jreg; /* FD_SBPF_OP_JSGT_REG */
+  case 0x7d: cc = CC_GE; goto jreg; /* FD_SBPF_OP_JSGE_REG */
+  case 0xad: cc = CC_B;  goto jreg; /* FD_SBPF_OP_JLT_REG */
+  case 0xbd: cc = CC_BE; goto jreg; /* FD_SBPF_OP_JLE_REG */
+  case 0xcd: cc = CC_L;  goto jreg; /* FD_SBPF_OP_JSLT_REG */
+  case 0xdd: cc = CC_LE; goto jreg; /* FD_SBPF_OP_JSLE_REG */
+  jreg:
+    jit_rr( a, 1, 0x39U, s, d );
+    jit_jcc( a, cc, jit_target( a, tgt ) );
+    break;
+  case 0x4d: /* FD_SBPF_OP_JSET_REG */
+    jit_rr( a, 1, 0x85U, s, d );
+    jit_jcc( a, CC_NE, jit_target( a, tgt ) );
+    break;
+
+  /* Calls */
+
+  case 0x85: { /* FD_SBPF_OP_CALL_IMM */
+    ulong call_pc = jit_call_target( (ulong)imm, a->text_cnt, a->entry_pc, a->calldests );
+    if( FD_LIKELY( jit_is_start( a, call_pc ) ) ) {
+      if( a->imm ) a->imm[ a->imm_cnt ] = imm;
+      a->imm_cnt++;
+      jit_push_frame( a, pc );
+      jit_jmp( a, jit_target( a, call_pc ) );
+      break;
+    }
+    /* Syscall or call resolved at run time */
+    jit_spill( a );
+    jit_rm( a, 1, 0x8dU, RDI, RBX, -FD_VM_JIT_BIAS ); /* lea rdi, [vm] */
+    jit_mov_ri32( a, RSI, (uint)pc );
+    jit_call_slot( a, FD_VM_JIT_SLOT_CALL );
+    jit_reload( a );
+    jit_rr( a, 1, 0x85U, RDX, RDX );
+    jit_jcc( a, CC_NE, a->lbl[ JIT_LBL_HALT ] );
+    jit_jmp( a, a->lbl[ JIT_LBL_DYN ] );
+    break;
+  }
+
+  case 0x8d: { /* FD_SBPF_OP_CALL_REG */
+    jit_push_frame( a, pc );
+    ulong k = (ulong)(imm & 15U);
+    if( k<11UL ) jit_rr( a, 1, 0x89U, fd_vm_jit_reg[ k ], RAX );
+    else         jit_rm( a, 1, 0x8bU, RAX, RBX, FD_VM_JIT_DISP( reg ) + 8*(int)k );
+    jit_rr( a, 0, 0x89U, RAX, RCX );                                   /* mov ecx, eax */
+    jit_rr( a, 0, 0xc1U, 5, RCX ); jit_u8( a, 3UL );                   /* shr ecx, 3 */
+    jit_alu_ri( a, 1, 5, RCX, (int)a->text_word_off );                 /* sub rcx, text_word_off */
+    jit_rr( a, 1, 0x89U, RAX, RDX );                                   /* mov rdx, rax */
+    jit_rr( a, 1, 0xc1U, 5, RDX ); jit_u8( a, 32UL );                  /* shr rdx, 32 */
+    jit_alu_ri( a, 1, 7, RDX, 1 );                                     /* cmp rdx, 1 */
+    jit_jcc( a, CC_NE, a->lbl[ JIT_LBL_SIGCALL ] );
+    jit_u8( a, 0xa8U ); jit_u8( a, 7UL );                              /* test al, 7 */
+    jit_jcc( a, CC_NE, a->lbl[ JIT_LBL_SIGCALL ] );
+    jit_rr( a, 1, 0x89U, RCX, RAX );                                   /* mov rax, rcx */
+    jit_jmp( a, a->lbl[ JIT_LBL_DYN ] );
+    break;
+  }
+
+  case 0x95: { /* FD_SBPF_OP_EXIT */
+    int sh = FD_VM_JIT_DISP( shadow );
+    jit_rm( a, 1, 0x8bU, RAX, RBX, FD_VM_JIT_DISP( frame_cnt ) );      /* mov rax, [frame_cnt] */
+    jit_rr( a, 1, 0x85U, RAX, RAX );
+    jit_jcc_fault( a, CC_E, FD_VM_SUCCESS, pc+1UL, 0UL );
+    jit_alu_ri( a, 1, 5, RAX, 1 );                                     /* sub rax, 1 */
+    jit_rm( a, 1, 0x89U, RAX, RBX, FD_VM_JIT_DISP( frame_cnt ) );      /* mov [frame_cnt], rax */
+    jit_rx( a, 1, 0x8dU, RCX, RAX, RAX, 2, 0 );                        /* lea rcx, [rax+rax*4] */
+    jit_rx( a, 1, 0x8bU, R12, RBX, RCX, 3, sh      );
+    jit_rx( a, 1, 0x8bU, R13, RBX, RCX, 3, sh +  8 );
+    jit_rx( a, 1, 0x8bU, R14, RBX, RCX, 3, sh + 16 );
+    jit_rx( a, 1, 0x8bU, R15, RBX, RCX, 3, sh + 24 );
+    jit_rx( a, 1, 0x8bU, RAX, RBX, RCX, 3, sh + 32 );
+    jit_alu_ri( a, 1, 5, RBP, (int)(FD_VM_STACK_FRAME_SZ + FD_VM_STACK_GUARD_SZ) );
+    jit_alu_ri( a, 1, 0, RAX, 1 );
+    jit_jmp( a, a->lbl[ JIT_LBL_DYN ] );
+    break;
+  }
+
+  default: /* Invalid opcode */
+    jit_fault( a, FD_VM_ERR_SIGILL, pc, refund );
+    break;
+  }
+}
+
+/* jit_common emits the code shared by all instructions of a program:
+   the exits, the prologue and the dispatcher. */
+
+static void
+jit_common( fd_vm_jit_asm_t * a ) {
+
+  /* sigtext / deopt: rax is pc */
+
+  a->lbl[ JIT_LBL_SIGTEXT ] = jit_here( a );
+  jit_rm( a, 1, 0x89U, RAX, RBX, FD_VM_JIT_DISP( pc ) );
+  jit_mov_ri32( a, RAX, (uint)FD_VM_ERR_SIGTEXT );
+  ulong j0 = jit_jcc_fwd( a, ~0U );
+
+  a->lbl[ JIT_LBL_DEOPT ] = jit_here( a );
+  jit_rm( a, 1, 0x89U, RAX, RBX, FD_VM_JIT_DISP( pc ) );
+  jit_mov_ri32( a, RAX, (uint)FD_VM_JIT_RC_DEOPT );
+  ulong j1 = jit_jcc_fwd( a, ~0U );
+
+  /* sigcall: rcx is pc */
+
+  a->lbl[ JIT_LBL_SIGCALL ] = jit_here( a );
+  jit_rm( a, 1, 0x89U, RCX, RBX, FD_VM_JIT_DISP( pc ) );
+  jit_mov_ri32( a, RAX, (uint)FD_VM_ERR_SIGCALL );
+  ulong j2 = jit_jcc_fwd( a, ~0U );
+
+  /* halt: edx is the return code (vm->pc already set) */
+
+  a->lbl[ JIT_LBL_HALT ] = jit_here( a );
+  jit_rr( a, 0, 0x89U, RDX, RAX );
+  ulong j3 = jit_jcc_fwd( a, ~0U );
+
+  /* fault: eax is the return code, rcx is pc, rdx is the refund */
+
+  a->lbl[ JIT_LBL_FAULT ] = jit_here( a );
+  jit_rm( a, 1, 0x89U, RCX, RBX, FD_VM_JIT_DISP( pc ) );
+  jit_rm( a, 1, 0x01U, RDX, RBX, FD_VM_JIT_DISP( cu ) );
+
+  a->lbl[ JIT_LBL_EPILOGUE ] = jit_here( a );
+  jit_patch( a, j0, jit_here( a ) );
+  jit_patch( a, j1, jit_here( a ) );
+  jit_patch( a, j2, jit_here( a ) );
+  jit_patch( a, j3, jit_here( a ) );
+  jit_spill( a );
+  jit_alu_ri( a, 1, 0, RSP, 8 );
+  jit_pop( a, R15 ); jit_pop( a, R14 ); jit_pop( a, R13 ); jit_pop( a, R12 ); jit_pop( a, RBP ); jit_pop( a, RBX );
+  jit_u8( a, 0xc3U ); /* ret */
+
+  /* Prologue: int entry( fd_vm_t * vm ) */
+
+  a->lbl[ JIT_LBL_ENTRY ] = jit_here( a );
+  jit_push( a, RBX ); jit_push( a, RBP ); jit_push( a, R12 ); jit_push( a, R13 ); jit_push( a, R14 ); jit_push( a, R15 );
+  jit_alu_ri( a, 1, 5, RSP, 8 ); /* Align the stack for helper calls */
+  jit_rm( a, 1, 0x8dU, RBX, RDI, FD_VM_JIT_BIAS );
+  jit_reload( a );
+  jit_rm( a, 1, 0x8bU, RAX, RBX, FD_VM_JIT_DISP( pc ) );
+
+  /* dyn: start a new linear segment at pc rax */
+
+  a->lbl[ JIT_LBL_DYN ] = jit_here( a );
+  jit_alu_ri( a, 1, 7, RAX, (int)a->text_cnt );
+  jit_jcc( a, CC_AE, a->lbl[ JIT_LBL_SIGTEXT ] );
+  jit_u8( a, 0x48U ); jit_u8( a, 0x8dU ); jit_u8( a, 0x0dU ); jit_rel32( a, 0UL ); /* lea rcx, [rip+image] */
+  jit_rx( a, 0, 0x8bU, RDX, RCX, RAX, 3, 0 );                                      /* mov edx, [rcx+rax*8] (body) */
+  jit_rr( a, 0, 0x85U, RDX, RDX );
+  jit_jcc( a, CC_E, a->lbl[ JIT_LBL_DEOPT ] );
+  jit_rx( a, 0, 0x8bU, RAX, RCX, RAX, 3, 4 );                                      /* mov eax, [rcx+rax*8+4] (cost) */
+  jit_rm( a, 1, 0x29U, RAX, RBX, FD_VM_JIT_DISP( cu ) );                           /* sub [cu], rax */
+  jit_rr( a, 1, 0x01U, RCX, RDX );                                                 /* add rdx, rcx */
+  jit_rr( a, 0, 0xffU, 4, RDX );                                                   /* jmp rdx */
+}
+
+FD_STATIC_ASSERT( FD_VM_JIT_DISP( cu )==(int)(schar)FD_VM_JIT_DISP( cu ), layout ); /* Entry charge is exactly 8 bytes */
+
+/* jit_emit runs one pass of code generation.  Returns 0 on success and
+   -1 if the second pass did not reproduce the first. */
+
+static int
+jit_emit( fd_vm_jit_asm_t * a ) {
+  jit_common( a );
+
+  int   prev_branch = 1;
+  ulong text_cnt    = a->text_cnt;
+  for( ulong pc=0UL; pc<text_cnt; pc++ ) {
+    if( !a->ptab[ pc ].body ) continue;
+
+    if( a->ptab[ pc ].cost & FD_VM_JIT_COST_ENTRY ) {
+      if( !prev_branch ) { jit_u8( a, 0xebU ); jit_u8( a, 8UL ); } /* Falling through doesn't start a new segment */
+      jit_rm( a, 1, 0x81U, 5, RBX, FD_VM_JIT_DISP( cu ) ); jit_u32( a, (ulong)jit_refund( a, pc ) ); /* sub [cu], cost */
+    }
+
+    ulong body = jit_here( a );
+    if( a->img ) { if( FD_UNLIKELY( a->ptab[ pc ].body!=(uint)body ) ) return -1; }
+    else         a->ptab[ pc ].body = (uint)body;
+
+    jit_instr( a, pc );
+
+    ulong opcode = fd_vm_instr_opcode( a->text[ pc ] );
+    prev_branch = fd_vm_instr_is_branch( opcode );
+  }
+
+  /* Falling off the end of the text */
+
+  jit_fault( a, FD_VM_ERR_SIGTEXT, text_cnt, 0UL );
+  return 0;
+}
+
+/* jit_prepass fills ptab (marks instruction starts, segment costs and
+   segment entries).  Returns 0 on success and -1 if the program is not
+   supported. */
+
+static int
+jit_prepass( fd_vm_jit_ptab_t * ptab,
+             ulong const *      text,
+             ulong              text_cnt,
+             ulong              entry_pc,
+             ulong const *      calldests ) {
+
+  memset( ptab, 0, text_cnt*sizeof(fd_vm_jit_ptab_t) );
+
+  ulong icnt = 0UL;
+  for( ulong pc=0UL; pc<text_cnt; ) {
+    ulong instr  = text[ pc ];
+    ulong opcode = fd_vm_instr_opcode( instr );
+    if( FD_UNLIKELY( (fd_vm_instr_dst( instr )>10UL) | (fd_vm_instr_src( instr )>10UL) ) ) return -1;
+    if( FD_UNLIKELY( ( (opcode==0x34) | (opcode==0x37) | (opcode==0x94) | (opcode==0x97) ) && !fd_vm_instr_imm( instr ) ) ) return -1;
+    ptab[ pc ].body = 1U;
+    ptab[ pc ].cost = (uint)icnt++;
+    pc += ( (opcode==0x18) & (pc+1UL<text_cnt) ) ? 2UL : 1UL;
+  }
+
+  ulong e = icnt;
+  for( ulong pc=text_cnt; pc; pc-- ) {
+    if( !ptab[ pc-1UL ].body ) continue;
+    ulong i = (ulong)ptab[ pc-1UL ].cost;
+    if( fd_vm_instr_is_branch( fd_vm_instr_opcode( text[ pc-1UL ] ) ) ) e = i+1UL;
+    ptab[ pc-1UL ].cost = (uint)(e-i);
+  }
+
+  for( ulong pc=0UL; pc<text_cnt; pc++ ) {
+    if( !ptab[ pc ].body ) continue;
+    ulong instr  = text[ pc ];
+    ulong opcode = fd_vm_instr_opcode( instr );
+    if( !fd_vm_instr_is_branch( opcode ) ) continue;
+    if( (pc+1UL<text_cnt) && ptab[ pc+1UL ].body ) ptab[ pc+1UL ].cost |= FD_VM_JIT_COST_ENTRY;
+    ulong tgt = ~0UL;
+    if(      opcode==0x85UL ) tgt = jit_call_target( (ulong)fd_vm_instr_imm( instr ), text_cnt, entry_pc, calldests );
+    else if( opcode!=0x8dUL && opcode!=0x95UL ) tgt = pc + 1UL + (ulong)(long)fd_vm_instr_offset( instr );
+    if( (tgt<text_cnt) && ptab[ tgt ].body ) ptab[ tgt ].cost |= FD_VM_JIT_COST_ENTRY;
+  }
+
+  return 0;
+}
+
+#define FD_VM_JIT_IMAGE_PER_INSTR (192UL)
+#define FD_VM_JIT_IMAGE_COMMON    (1024UL)
+
+static inline ulong
+fd_vm_jit_ptab_sz( ulong text_cnt ) {
+  return fd_ulong_align_up( text_cnt*sizeof(fd_vm_jit_ptab_t), 64UL );
+}
+
+FD_FN_CONST ulong
+fd_vm_jit_footprint_est( ulong text_cnt ) {
+  return FD_VM_JIT_HDR_SZ + fd_vm_jit_ptab_sz( text_cnt ) + FD_VM_JIT_IMAGE_COMMON + FD_VM_JIT_IMAGE_PER_INSTR*text_cnt
+       + FD_VM_JIT_SLOT_CNT*sizeof(ulong) + 64UL;
+}
+
+ulong
+fd_vm_jit_compile( void *        mem,
+                   ulong         mem_max,
+                   ulong const * text,
+                   ulong         text_cnt,
+                   ulong         text_off,
+                   ulong         entry_pc,
+                   ulong const * calldests ) {
+
+  if( FD_UNLIKELY( !mem ) ) {
+    FD_LOG_WARNING(( "NULL mem" ));
+    return 0UL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)mem, FD_VM_JIT_ALIGN ) ) ) {
+    FD_LOG_WARNING(( "misaligned mem" ));
+    return 0UL;
+  }
+
+  if( FD_UNLIKELY( !text ) ) {
+    FD_LOG_WARNING(( "NULL text" ));
+    return 0UL;
+  }
+
+  /* Unsupported programs are not an error, they just run on the
+     interpreter */
+
+  if( FD_UNLIKELY( (!text_cnt) | (text_cnt>FD_VM_JIT_TEXT_MAX) | (text_off/8UL>(ulong)INT_MAX) ) ) return 0UL;
+
+  ulong ptab_sz = fd_vm_jit_ptab_sz( text_cnt );
+  if( FD_UNLIKELY( mem_max<FD_VM_JIT_HDR_SZ+ptab_sz ) ) return fd_vm_jit_footprint_est( text_cnt );
+
+  uchar *            blob = (uchar *)mem;
+  uchar *            img  = blob + FD_VM_JIT_HDR_SZ;
+  fd_vm_jit_ptab_t * ptab = (fd_vm_jit_ptab_t *)img;
+
+  if( FD_UNLIKELY( jit_prepass( ptab, text, text_cnt, entry_pc, calldests ) ) ) return 0UL;
+
+  /* Measure */
+
+  fd_vm_jit_asm_t a[1];
+  memset( a, 0, sizeof(fd_vm_jit_asm_t) );
+  a->ptab          = ptab;
+  a->text          = text;
+  a->text_cnt      = text_cnt;
+  a->text_word_off = text_off/8UL;
+  a->entry_pc      = entry_pc;
+  a->calldests     = calldests;
+  a->off[0]        = ptab_sz;
+
+  jit_emit( a );
+
+  ulong main_end = a->off[0];
+  ulong cold_sz  = a->off[1];
+  ulong slot_off = fd_ulong_align_up( main_end + cold_sz, 8UL );
+  ulong image_sz = slot_off + FD_VM_JIT_SLOT_CNT*sizeof(ulong);
+  ulong imm_cnt  = a->imm_cnt;
+  ulong imm_off  = fd_ulong_align_up( FD_VM_JIT_HDR_SZ + image_sz, 8UL );
+  ulong blob_sz  = fd_ulong_align_up( imm_off + imm_cnt*sizeof(uint), FD_VM_JIT_ALIGN );
+
+  if( FD_UNLIKELY( image_sz>(ulong)UINT_MAX ) ) return 0UL;
+  if( FD_UNLIKELY( blob_sz>mem_max ) ) return blob_sz;
+
+  /* Generate */
+
+  ulong lbl[ JIT_LBL_CNT ];
+  memcpy( lbl, a->lbl, sizeof(lbl) );
+
+  a->img      = img;
+  a->off[0]   = ptab_sz;
+  a->off[1]   = main_end;
+  a->s        = 0;
+  a->slot_off = slot_off;
+  a->imm      = (uint *)(blob + imm_off);
+  a->imm_cnt  = 0UL;
+
+  if( FD_UNLIKELY( jit_emit( a ) || a->off[0]!=main_end || a->off[1]!=main_end+cold_sz || a->imm_cnt!=imm_cnt ||
+                   memcmp( lbl, a->lbl, sizeof(lbl) ) ) ) {
+    FD_LOG_WARNING(( "jit passes disagree (text_cnt %lu)", text_cnt ));
+    return 0UL;
+  }
+
+  memset( img + main_end + cold_sz, 0xcc, slot_off - (main_end + cold_sz) ); /* int3 padding */
+  memset( img + slot_off, 0, FD_VM_JIT_SLOT_CNT*sizeof(ulong) );
+  for( ulong pc=0UL; pc<text_cnt; pc++ ) ptab[ pc ].cost &= ~FD_VM_JIT_COST_ENTRY;
+  memset( img + text_cnt*sizeof(fd_vm_jit_ptab_t), 0, ptab_sz - text_cnt*sizeof(fd_vm_jit_ptab_t) );
+  memset( blob + FD_VM_JIT_HDR_SZ + image_sz, 0, imm_off - (FD_VM_JIT_HDR_SZ + image_sz) );
+  memset( blob + imm_off + imm_cnt*sizeof(uint), 0, blob_sz - (imm_off + imm_cnt*sizeof(uint)) );
+
+  fd_vm_jit_hdr_t * hdr = (fd_vm_jit_hdr_t *)blob;
+  memset( hdr, 0, FD_VM_JIT_HDR_SZ );
+  hdr->magic     = FD_VM_JIT_MAGIC;
+  hdr->layout    = FD_VM_JIT_LAYOUT;
+  hdr->text_cnt  = text_cnt;
+  hdr->text_off  = text_off;
+  hdr->entry_pc  = entry_pc;
+  hdr->image_off = FD_VM_JIT_HDR_SZ;
+  hdr->image_sz  = image_sz;
+  hdr->entry_off = lbl[ JIT_LBL_ENTRY ];
+  hdr->slot_off  = slot_off;
+  hdr->imm_off   = imm_off;
+  hdr->imm_cnt   = imm_cnt;
+
+  fd_sha256_t sha[1];
+  fd_sha256_init( fd_sha256_join( fd_sha256_new( sha ) ) );
+  fd_sha256_append( sha, img, image_sz );
+  fd_sha256_append( sha, blob + imm_off, imm_cnt*sizeof(uint) );
+  fd_sha256_fini( sha, hdr->id );
+  fd_sha256_delete( fd_sha256_leave( sha ) );
+
+  return blob_sz;
+}
+
+/* Out of line helpers called by native code */
+
+static FD_TL int fd_vm_jit_private_syscall_err = 0;
+
+static ulong
+fd_vm_jit_mem( fd_vm_t * vm,
+               ulong     vaddr,
+               ulong     flags ) {
+  ulong        sz        = flags & 255UL;
+  uchar        write     = (uchar)((flags>>8) & 1UL);
+  uint const * region_sz = ((flags>>9) & 1UL) ? vm->region_st_sz : vm->region_ld_sz;
+  ulong        haddr     = fd_vm_mem_haddr( vm, vaddr, sz, vm->region_haddr, region_sz, write, 0UL );
+  if( !haddr ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sz, write );
+  int          sigbus    = (sz>1UL) & vm->check_align & !fd_ulong_is_aligned( vaddr, sz );
+  if( ((flags>>9) & 1UL) & !!haddr & !sigbus ) fd_vm_mem_st_mark( vm, haddr, sz );
+  return fd_ulong_if( sigbus, 0UL, haddr );
+}
+
+struct fd_vm_jit_call_ret {
+  ulong pc; /* Where to continue if rc is zero */
+  ulong rc; /* 0 (continue), FD_VM_ERR_SIG{CALL,STACK} or FD_VM_JIT_RC_SYSCALL (vm->pc set) */
+};
+
+typedef struct fd_vm_jit_call_ret fd_vm_jit_call_ret_t;
+
+/* fd_vm_jit_call does the CALL_IMM at pc that could not be resolved at
+   compile time.  On entry, vm->reg is current and vm->ic / vm->cu are
+   biased (as described in fd_vm_exec_jit). */
+
+static fd_vm_jit_call_ret_t
+fd_vm_jit_call( fd_vm_t * vm,
+                ulong     pc ) {
+  uint imm = fd_vm_instr_imm( vm->text[ pc ] );
+
+  fd_sbpf_syscalls_t const * syscall = fd_sbpf_syscalls_query_const( vm->syscalls, imm, NULL );
+  if( FD_LIKELY( syscall ) ) {
+    ulong cu = vm->cu; /* Non-negative (checked at the branch) */
+    ulong ic = vm->ic - cu;
+
+    vm->pc = pc;
+    vm->ic = ic;
+    vm->cu = cu;
+
+    ulong ret[1];
+    int err = syscall->func( vm, vm->reg[1], vm->reg[2], vm->reg[3], vm->reg[4], vm->reg[5], ret );
+    vm->reg[0] = ret[0];
+
+    cu = fd_ulong_min( vm->cu, cu );
+    if( FD_UNLIKELY( err ) ) {
+      if( err==FD_VM_ERR_SIGCOST ) cu = 0UL;
+      fd_vm_jit_private_syscall_err = err;
+      vm->pc = pc;
+      vm->ic = ic + cu;
+      vm->cu = cu;
+      return (fd_vm_jit_call_ret_t){ .pc = pc, .rc = (ulong)FD_VM_JIT_RC_SYSCALL };
+    }
+
+    vm->ic = ic + cu;
+    vm->cu = cu;
+    return (fd_vm_jit_call_ret_t){ .pc = pc+1UL, .rc = 0UL };
+  }
+
+  ulong frame_cnt = vm->frame_cnt;
+  if( FD_UNLIKELY( frame_cnt>=FD_VM_STACK_FRAME_MAX ) ) {
+    vm->pc = pc;
+    return (fd_vm_jit_call_ret_t){ .pc = pc, .rc = (ulong)(uint)FD_VM_ERR_SIGSTACK };
+  }
+  vm->shadow[ frame_cnt ].r6 = vm->reg[6];
+  vm->shadow[ frame_cnt ].r7 = vm->reg[7];
+  vm->shadow[ frame_cnt ].r8 = vm->reg[8];
+  vm->shadow[ frame_cnt ].r9 = vm->reg[9];
+  vm->shadow[ frame_cnt ].pc = pc;
+  vm->frame_cnt = frame_cnt + 1UL;
+  vm->reg[10] += FD_VM_STACK_FRAME_SZ + FD_VM_STACK_GUARD_SZ;
+
+  ulong tgt;
+  if( FD_UNLIKELY( imm==0x71e3cf81U ) ) tgt = vm->entry_pc; /* FIXME: MAGIC NUMBER */
+  else {
+    tgt = (ulong)fd_pchash_inverse( imm );
+    if( FD_UNLIKELY( tgt>=vm->text_cnt ) || FD_UNLIKELY( !fd_sbpf_calldests_test( vm->calldests, tgt ) ) ) {
+      vm->pc = tgt;
+      return (fd_vm_jit_call_ret_t){ .pc = tgt, .rc = (ulong)(uint)FD_VM_ERR_SIGCALL };
+    }
+  }
+  return (fd_vm_jit_call_ret_t){ .pc = tgt, .rc = 0UL };
+}
+
+/* Code cache.  The memfd holds the cache header and entry map followed
+   (at code_off, page aligned) by the code region.  The whole thing is
+   mapped read-write and the code region is also mapped read-execute.
+   Images are appended to the code region and the cache is flushed when
+   full. */
+
+#define FD_VM_JIT_CACHE_MAGIC (0xf17eda2c3b17cac0UL)
+
+struct fd_vm_jit_cache_entry {
+  uchar        id[ 32 ];
+  ulong        entry;    /* Address of the native entry point (0 if the slot is free) */
+  void const * syscalls; /* Syscall map the call immediates were last checked against */
+  int          ok;       /* 1 if none of the call immediates is a syscall in that map */
+};
+
+typedef struct fd_vm_jit_cache_entry fd_vm_jit_cache_entry_t;
+
+struct fd_vm_jit_cache {
+  ulong                     magic;
+  ulong                     map_sz;    /* Size of the memfd */
+  ulong                     code_off;  /* Offset of the code region in the memfd */
+  ulong                     code_sz;
+  ulong                     code_used;
+  uchar *                   code_rw;
+  uchar const *             code_rx;
+  ulong                     entry_max; /* Power of 2 */
+  ulong                     entry_cnt;
+  fd_vm_jit_cache_entry_t * entry;
+};
+
+typedef struct fd_vm_jit_cache fd_vm_jit_cache_t;
+
+static FD_TL fd_vm_jit_cache_t * fd_vm_jit_private_cache = NULL;
+static FD_TL ulong               fd_vm_jit_private_depth = 0UL;
+
+void *
+fd_vm_jit_cache_new( ulong code_sz ) {
+
+  if( FD_UNLIKELY( !code_sz ) ) {
+    FD_LOG_WARNING(( "zero code_sz" ));
+    return NULL;
+  }
+
+  ulong page_sz   = (ulong)sysconf( _SC_PAGESIZE );
+  ulong entry_max = fd_ulong_pow2_up( fd_ulong_max( code_sz>>12, 256UL ) );
+  ulong code_off  = fd_ulong_align_up( sizeof(fd_vm_jit_cache_t) + entry_max*sizeof(fd_vm_jit_cache_entry_t), page_sz );
+  code_sz         = fd_ulong_align_up( code_sz, page_sz );
+  ulong map_sz    = code_off + code_sz;
+
+  int fd = memfd_create( "fd_vm_jit", MFD_CLOEXEC );
+  if( FD_UNLIKELY( fd<0 ) ) {
+    FD_LOG_WARNING(( "memfd_create failed (%i-%s)", errno, fd_io_strerror( errno ) ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( ftruncate( fd, (off_t)map_sz ) ) ) {
+    FD_LOG_WARNING(( "ftruncate(%lu) failed (%i-%s)", map_sz, errno, fd_io_strerror( errno ) ));
+    close( fd );
+    return NULL;
+  }
+
+  void * rw = mmap( NULL, map_sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  if( FD_UNLIKELY( rw==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(rw) failed (%i-%s)", errno, fd_io_strerror( errno ) ));
+    close( fd );
+    return NULL;
+  }
+
+  void * rx = mmap( NULL, code_sz, PROT_READ | PROT_EXEC, MAP_SHARED, fd, (off_t)code_off );
+  if( FD_UNLIKELY( rx==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(rx) failed (%i-%s)", errno, fd_io_strerror( errno ) ));
+    munmap( rw, map_sz );
+    close( fd );
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( close( fd ) ) ) FD_LOG_WARNING(( "close failed (%i-%s); attempting to continue", errno, fd_io_strerror( errno ) ));
+
+  fd_vm_jit_cache_t * cache = (fd_vm_jit_cache_t *)rw;
+  cache->map_sz    = map_sz;
+  cache->code_off  = code_off;
+  cache->code_sz   = code_sz;
+  cache->code_used = 0UL;
+  cache->code_rw   = (uchar *)rw + code_off;
+  cache->code_rx   = (uchar const *)rx;
+  cache->entry_max = entry_max;
+  cache->entry_cnt = 0UL;
+  cache->entry     = (fd_vm_jit_cache_entry_t *)(cache+1);
+  memset( cache->entry, 0, entry_max*sizeof(fd_vm_jit_cache_entry_t) );
+
+  FD_COMPILER_MFENCE();
+  cache->magic = FD_VM_JIT_CACHE_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return cache;
+}
+
+void
+fd_vm_jit_cache_delete( void * _cache ) {
+  fd_vm_jit_cache_t * cache = (fd_vm_jit_cache_t *)_cache;
+
+  if( FD_UNLIKELY( !cache ) ) {
+    FD_LOG_WARNING(( "NULL cache" ));
+    return;
+  }
+
+  if( FD_UNLIKELY( cache->magic!=FD_VM_JIT_CACHE_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return;
+  }
+
+  if( FD_UNLIKELY( cache==fd_vm_jit_private_cache ) ) FD_LOG_ERR(( "cache still attached" ));
+
+  cache->magic = 0UL;
+  if( FD_UNLIKELY( munmap( (void *)cache->code_rx, cache->code_sz ) ) )
+    FD_LOG_WARNING(( "munmap(rx) failed (%i-%s)", errno, fd_io_strerror( errno ) ));
+  if( FD_UNLIKELY( munmap( (void *)cache, cache->map_sz ) ) )
+    FD_LOG_WARNING(( "munmap(rw) failed (%i-%s)", errno, fd_io_strerror( errno ) ));
+}
+
+void
+fd_vm_jit_cache_attach( void * _cache ) {
+  fd_vm_jit_cache_t * cache = (fd_vm_jit_cache_t *)_cache;
+  if( FD_UNLIKELY( fd_vm_jit_private_cache ) ) FD_LOG_ERR(( "already attached" ));
+  if( FD_UNLIKELY( !cache ) ) FD_LOG_ERR(( "NULL cache" ));
+  if( FD_UNLIKELY( cache->magic!=FD_VM_JIT_CACHE_MAGIC ) ) FD_LOG_ERR(( "bad magic" ));
+  fd_vm_jit_private_cache = cache;
+}
+
+void *
+fd_vm_jit_cache_detach( void ) {
+  fd_vm_jit_cache_t * cache = fd_vm_jit_private_cache;
+  if( FD_UNLIKELY( fd_vm_jit_private_depth ) ) FD_LOG_ERR(( "cache in use" ));
+  fd_vm_jit_private_cache = NULL;
+  return cache;
+}
+
+void *
+fd_vm_jit_cache_query( void ) {
+  return fd_vm_jit_private_cache;
+}
+
+/* fd_vm_jit_cache_install returns the cache entry of the blob described
+   by hdr, copying it into the code region if needed.  Returns NULL if
+   the blob cannot be installed right now (too large or the cache is
+   full while native code is running on this thread). */
+
+static fd_vm_jit_cache_entry_t *
+fd_vm_jit_cache_install( fd_vm_jit_cache_t *     cache,
+                         fd_vm_jit_hdr_t const * hdr ) {
+  ulong mask = cache->entry_max - 1UL;
+  ulong hash = FD_LOAD( ulong, hdr->id );
+
+  for( ulong i=hash & mask;; i=(i+1UL) & mask ) {
+    fd_vm_jit_cache_entry_t * e = cache->entry + i;
+    if( !e->entry ) break;
+    if( FD_LIKELY( !memcmp( e->id, hdr->id, 32UL ) ) ) return e;
+  }
+
+  ulong image_sz = hdr->image_sz;
+  if( FD_UNLIKELY( image_sz>cache->code_sz ) ) return NULL;
+
+  ulong code_off = fd_ulong_align_up( cache->code_used, 64UL );
+  if( FD_UNLIKELY( (code_off+image_sz>cache->code_sz) | (2UL*(cache->entry_cnt+1UL)>cache->entry_max) ) ) {
+    if( FD_UNLIKELY( fd_vm_jit_private_depth ) ) return NULL; /* Native code from this cache is on the stack */
+    memset( cache->entry, 0, cache->entry_max*sizeof(fd_vm_jit_cache_entry_t) );
+    cache->entry_cnt = 0UL;
+    code_off         = 0UL;
+  }
+
+  uchar * dst = cache->code_rw + code_off;
+  fd_memcpy( dst, (uchar const *)hdr + hdr->image_off, image_sz );
+  ulong * slot = (ulong *)(dst + hdr->slot_off);
+  slot[ FD_VM_JIT_SLOT_MEM  ] = (ulong)fd_vm_jit_mem;
+  slot[ FD_VM_JIT_SLOT_CALL ] = (ulong)fd_vm_jit_call;
+  cache->code_used = code_off + image_sz;
+
+  fd_vm_jit_cache_entry_t * e;
+  for( ulong i=hash & mask;; i=(i+1UL) & mask ) {
+    e = cache->entry + i;
+    if( !e->entry ) break;
+  }
+  memcpy( e->id, hdr->id, 32UL );
+  e->entry    = (ulong)(cache->code_rx + code_off + hdr->entry_off);
+  e->syscalls = NULL;
+  e->ok       = 0;
+  cache->entry_cnt++;
+
+  FD_COMPILER_MFENCE();
+  return e;
+}
+
+typedef int (*fd_vm_jit_fn_t)( fd_vm_t * vm );
+
+int
+fd_vm_exec_jit( fd_vm_t *    vm,
+                void const * jit ) {
+
+  if( FD_UNLIKELY( !vm ) ) return FD_VM_ERR_INVAL;
+
+  fd_vm_jit_cache_t *     cache = fd_vm_jit_private_cache;
+  fd_vm_jit_hdr_t const * hdr   = (fd_vm_jit_hdr_t const *)jit;
+  if( FD_UNLIKELY( (!hdr) | (!cache) | (!!vm->trace) ) ) return fd_vm_exec( vm );
+
+  if( FD_UNLIKELY( (hdr->magic   !=FD_VM_JIT_MAGIC ) | (hdr->layout  !=FD_VM_JIT_LAYOUT) |
+                   (hdr->text_cnt!=vm->text_cnt    ) | (hdr->text_off!=vm->text_off    ) |
+                   (hdr->entry_pc!=vm->entry_pc    ) ) ) return fd_vm_exec( vm );
+
+  /* Native code tracks ic+cu instead of ic (see below), which must not
+     overflow */
+
+  if( FD_UNLIKELY( (vm->cu>(1UL<<62)) | (vm->ic>(1UL<<62)) ) ) return fd_vm_exec( vm );
+
+  fd_vm_jit_cache_entry_t * e = fd_vm_jit_cache_install( cache, hdr );
+  if( FD_UNLIKELY( !e ) ) return fd_vm_exec( vm );
+
+  /* Calls resolved at compile time assumed their immediate was not a
+     syscall.  Check this (once per syscall map). */
+
+  if( FD_UNLIKELY( e->syscalls!=(void const *)vm->syscalls ) ) {
+    uint const * imm = (uint const *)((uchar const *)hdr + hdr->imm_off);
+    int          ok  = 1;
+    if( vm->syscalls ) {
+      for( ulong i=0UL; i<hdr->imm_cnt; i++ ) ok &= !fd_sbpf_syscalls_query_const( vm->syscalls, imm[ i ], NULL );
+    }
+    e->syscalls = vm->syscalls;
+    e->ok       = ok;
+  }
+  if( FD_UNLIKELY( !e->ok ) ) return fd_vm_exec( vm );
+
+  /* While native code runs, vm->ic holds ic+cu and vm->cu is signed
+     (negative after a segment that exceeded the budget was charged).
+     Charging / refunding then only touches cu. */
+
+  vm->ic += vm->cu;
+  fd_vm_jit_private_depth++;
+  int rc = ((fd_vm_jit_fn_t)e->entry)( vm );
+  fd_vm_jit_private_depth--;
+  long cu = (long)vm->cu;
+  vm->ic -= (ulong)cu;
+  vm->cu  = (ulong)fd_long_max( cu, 0L );
+
+  if( FD_UNLIKELY( rc==FD_VM_JIT_RC_DEOPT   ) ) return fd_vm_exec_notrace( vm );
+  if( FD_UNLIKELY( rc==FD_VM_JIT_RC_SYSCALL ) ) return fd_vm_jit_private_syscall_err;
+  return rc;
+}
+
+#else /* Not an x86-64 host */
+
+FD_FN_CONST ulong fd_vm_jit_footprint_est( ulong text_cnt ) { (void)text_cnt; return FD_VM_JIT_ALIGN; }
+
+ulong
+fd_vm_jit_compile( void *        mem,
+                   ulong         mem_max,
+                   ulong const * text,
+                   ulong         text_cnt,
+                   ulong         text_off,
+                   ulong         entry_pc,
+                   ulong const * calldests ) {
+  (void)mem; (void)mem_max; (void)text; (void)text_cnt; (void)text_off; (void)entry_pc; (void)calldests;
+  return 0UL;
+}
+
+void * fd_vm_jit_cache_new   ( ulong  code_sz ) { (void)code_sz; return NULL; }
+void   fd_vm_jit_cache_delete( void * cache   ) { (void)cache; }
+void   fd_vm_jit_cache_attach( void * cache   ) { (void)cache; }
+void * fd_vm_jit_cache_detach( void           ) { return NULL; }
+void * fd_vm_jit_cache_query ( void           ) { return NULL; }
+
+int
+fd_vm_exec_jit( fd_vm_t *    vm,
+                void const * jit ) {
+  (void)jit;
+  return fd_vm_exec( vm );
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef HEADER_fd_src_flamenco_vm_fd_vm_jit_h
+#define HEADER_fd_src_flamenco_vm_fd_vm_jit_h
+
+/* fd_vm_jit is an ahead-of-time compiler from sBPF to x86-64 machine
+   code.  A program is compiled once when it is inserted into the
+   program cache and the resulting blob is stored next to the validated
+   program.  Executing a blob gives bit-for-bit the same results as
+   fd_vm_exec_notrace: same registers and memory, same pc / ic / cu /
+   frame_cnt and the same fault on every path (including faults in the
+   middle of a linear segment, sigsplit, sigcost at a branch and syscall
+   errors).
+
+   Compute units are metered per linear segment like the interpreter.
+   Entering a segment at pc debits the number of instructions from pc up
+   to and including the next branch (or to the end of the text).  Each
+   branch checks the budget and a non-branch fault refunds the part of
+   the segment that did not execute.  While native code runs, vm->ic
+   holds ic+cu such that the real ic can be recovered from the signed cu
+   at any exit.
+
+   Anything the compiler does not handle statically (a jump into the
+   middle of a multiword instruction, a call target that was not known
+   at compile time, ...) either goes through an exact out of line helper
+   or hands the vm state back to the interpreter ("deopt") at the
+   current pc.  As such, unusual programs are slower but never
+   different.
+
+   Blobs are position independent and are not executed in place (funk
+   memory is not executable).  Instead, each thread that runs programs
+   attaches a code cache (an executable mapping created before the
+   thread is sandboxed) and blobs are copied into it on first use.  The
+   cache is keyed by a hash of the machine code such that the same
+   program deployed in multiple accounts is installed once.
+
+   This is only available on x86-64 hosts.  Elsewhere, compile always
+   fails and fd_vm_exec_jit runs the interpreter. */
+
+#include "fd_vm.h"
+
+/* FD_VM_JIT_ALIGN gives the alignment of a compiled blob (such that a
+   blob can be stored in a funk record value). */
+
+#define FD_VM_JIT_ALIGN (8UL)
+
+/* FD_VM_JIT_TEXT_MAX is the largest text_cnt the compiler accepts.
+   Larger programs are run by the interpreter. */
+
+#define FD_VM_JIT_TEXT_MAX (1UL<<22)
+
+/* FD_VM_JIT_CACHE_SZ_DEFAULT is a reasonable code cache size for a
+   thread that executes transactions. */
+
+#define FD_VM_JIT_CACHE_SZ_DEFAULT (256UL<<20)
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_vm_jit_footprint_est returns a size that is usually enough to hold
+   the blob of a text_cnt word program.  Never less than the minimum
+   needed by fd_vm_jit_compile to make progress. */
+
+FD_FN_CONST ulong
+fd_vm_jit_footprint_est( ulong text_cnt );
+
+/* fd_vm_jit_compile compiles the sBPF program given by text / text_cnt
+   / text_off / entry_pc / calldests (as would be given to fd_vm_init)
+   into the mem_max byte region at mem (aligned FD_VM_JIT_ALIGN).
+   calldests can be NULL, in which case every internal call is resolved
+   at run time.
+
+   Returns the size of the blob.  If this is at most mem_max, the blob
+   was written to mem.  Otherwise, mem is clobbered and the caller
+   should retry with a region of at least the returned size (if mem_max
+   is too small to even measure the blob, this is an estimate and the
+   retry might ask for more or return a smaller size).  Returns 0
+   if the program cannot be compiled (unsupported host, program too
+   large, malformed register indices or division by a zero immediate);
+   such programs should be run with the interpreter.
+
+   The blob is only valid for the exact text it was compiled from and
+   the calldests passed here must be those the vm executing it is
+   initialized with. */
+
+ulong
+fd_vm_jit_compile( void *        mem,
+                   ulong         mem_max,
+                   ulong const * text,
+                   ulong         text_cnt,
+                   ulong         text_off,
+                   ulong         entry_pc,
+                   ulong const * calldests );
+
+/* fd_vm_jit_cache_new creates a code cache with room for code_sz bytes
+   of machine code.  The cache is backed by a memfd mapped twice, once
+   writable and once executable, so no page is ever both.  This makes
+   system calls and must be done before the calling thread is sandboxed.
+   Returns a handle on success and NULL on failure (logs details).
+
+   fd_vm_jit_cache_delete unmaps a cache.  It must not be attached to
+   any thread. */
+
+void *
+fd_vm_jit_cache_new( ulong code_sz );
+
+void
+fd_vm_jit_cache_delete( void * cache );
+
+/* fd_vm_jit_cache_{attach,detach} attach / detach the caller's thread
+   to / from the code cache.  Like the vm pool, the cache is thread
+   local and a cache must be attached to at most one thread at a time.
+   detach returns the cache previously attached (NULL if none).  query
+   returns the cache attached to the caller's thread (NULL if none). */
+
+void
+fd_vm_jit_cache_attach( void * cache );
+
+void *
+fd_vm_jit_cache_detach( void );
+
+void *
+fd_vm_jit_cache_query( void );
+
+/* fd_vm_exec_jit runs vm (as initialized by fd_vm_init) using the blob
+   jit compiled for the vm's program.  Returns the same as
+   fd_vm_exec_notrace.  Falls back to fd_vm_exec (and hence tracing)
+   when jit is NULL, the vm is attached to a trace, the caller's thread
+   has no code cache attached or the cache cannot take the blob right
+   now. */
+
+int
+fd_vm_exec_jit( fd_vm_t *    vm,
+                void const * jit );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_flamenco_vm_fd_vm_jit_h */
@@ -133,6 +133,22 @@ FD_FN_CONST static inline ulong fd_vm_instr_normal_opmode ( ulong instr ) { retu
 FD_FN_CONST static inline ulong fd_vm_instr_mem_opsize    ( ulong instr ) { return (instr>>3) &  3UL; } /* In [0,4)  */
 FD_FN_CONST static inline ulong fd_vm_instr_mem_opaddrmode( ulong instr ) { return (instr>>5) &  7UL; } /* In [0,16) */
 
+/* fd_vm_instr_is_branch returns 1 if the interpreter ends a linear
+   segment (bills compute units) at an instruction with the given
+   opcode and 0 otherwise.  These are the jumps, calls and exit. */
+
+FD_FN_CONST static inline int
+fd_vm_instr_is_branch( ulong opcode ) {
+  switch( opcode ) {
+  case 0x05: case 0x15: case 0x1d: case 0x25: case 0x2d: case 0x35: case 0x3d: case 0x45: case 0x4d:
+  case 0x55: case 0x5d: case 0x65: case 0x6d: case 0x75: case 0x7d: case 0x85: case 0x8d: case 0x95:
+  case 0xa5: case 0xad: case 0xb5: case 0xbd: case 0xc5: case 0xcd: case 0xd5: case 0xdd:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
 /* fd_vm_mem API ******************************************************/
 
 /* fd_vm_mem APIs support the fast mapping of virtual address ranges to
@@ -148,11 +164,12 @@ FD_FN_CONST static inline ulong fd_vm_instr_mem_opaddrmode( ulong instr ) { retu
 
 static inline fd_vm_t *
 fd_vm_mem_cfg( fd_vm_t * vm ) {
+  ulong input_tlb_sz = vm->input_region_cnt ? vm->input_region[0].off : vm->input_sz;
   vm->region_haddr[0] = 0UL;               vm->region_ld_sz[0] = (uint)0UL;             vm->region_st_sz[0] = (uint)0UL;
   vm->region_haddr[1] = (ulong)vm->rodata; vm->region_ld_sz[1] = (uint)vm->rodata_sz;   vm->region_st_sz[1] = (uint)0UL;
   vm->region_haddr[2] = (ulong)vm->stack;  vm->region_ld_sz[2] = (uint)FD_VM_STACK_MAX; vm->region_st_sz[2] = (uint)FD_VM_STACK_MAX;
   vm->region_haddr[3] = (ulong)vm->heap;   vm->region_ld_sz[3] = (uint)vm->heap_max;    vm->region_st_sz[3] = (uint)vm->heap_max;
-  vm->region_haddr[4] = (ulong)vm->input;  vm->region_ld_sz[4] = (uint)vm->input_sz;    vm->region_st_sz[4] = (uint)vm->input_sz;
+  vm->region_haddr[4] = (ulong)vm->input;  vm->region_ld_sz[4] = (uint)input_tlb_sz;    vm->region_st_sz[4] = (uint)input_tlb_sz;
   vm->region_haddr[5] = 0UL;               vm->region_ld_sz[5] = (uint)0UL;             vm->region_st_sz[5] = (uint)0UL;
   return vm;
 }
@@ -215,6 +232,43 @@ fd_vm_mem_haddr( FD_FN_UNUSED fd_vm_t const *  vm,
   return fd_ulong_if( sz<=sz_max, vm_region_haddr[ region ] + offset, sentinel );
 }
 
+/* fd_vm_mem_haddr_input retries a translation of [vaddr,vaddr+sz) for
+   which fd_vm_mem_haddr failed (with a zero sentinel) when the input
+   region has directly mapped ranges (see fd_vm_input_direct_map).  The
+   tlb then only covers the input bytes below the first such range, so
+   callers do this on their failure branch only and vms without directly
+   mapped ranges (and all other regions) pay nothing for them.  Returns
+   the haddr on success and 0 if the access really faults.
+
+   An access inside the vm's input window (the last translation that
+   took the slow path) resolves inline.  Otherwise
+   fd_vm_mem_haddr_input_slow looks up the ranges touched.  A write, or
+   an access that is not entirely inside a single directly mapped range
+   that was not copied yet, copies all touched ranges into the input
+   buffer first, such that stores never reach the (read only) directly
+   mapped memory.  The window is updated to the largest span around the
+   access that maps to contiguous host memory (stores only allowed if
+   that is the input buffer). */
+
+ulong
+fd_vm_mem_haddr_input_slow( fd_vm_t * vm,
+                            ulong     offset,
+                            ulong     sz,
+                            uchar     write );
+
+static inline ulong
+fd_vm_mem_haddr_input( fd_vm_t * vm,
+                       ulong     vaddr,
+                       ulong     sz,
+                       uchar     write ) {
+  if( FD_LIKELY( ((vaddr>>32)!=4UL) | (!vm->input_region_cnt) ) ) return 0UL;
+  ulong offset  = vaddr & 0xffffffffUL;
+  ulong win_rel = offset - vm->input_win_off;
+  ulong win_sz  = vm->input_win_sz;
+  if( FD_LIKELY( (win_rel<win_sz) & (sz<=win_sz-win_rel) & (vm->input_win_st | !write) ) ) return vm->input_win_haddr + win_rel;
+  return fd_vm_mem_haddr_input_slow( vm, offset, sz, write );
+}
+
 FD_FN_PURE static inline ulong
 fd_vm_mem_haddr_fast( ulong         vaddr,
                       ulong const * vm_region_haddr ) { /* indexed [0,6) */
@@ -240,6 +294,25 @@ static inline void fd_vm_mem_st_2( ulong haddr, ushort val ) { memcpy( (void *)h
 static inline void fd_vm_mem_st_4( ulong haddr, uint   val ) { memcpy( (void *)haddr, &val, sizeof(uint)   ); }
 static inline void fd_vm_mem_st_8( ulong haddr, ulong  val ) { memcpy( (void *)haddr, &val, sizeof(ulong)  ); }
 
+/* fd_vm_mem_st_mark records in vm->st_dirty that the host range
+   [haddr,haddr+sz) has been (or is about to be) stored to such that
+   fd_vm_pool_release only needs to clear the touched pages.  Every
+   store a program can make to the stack or heap (directly or through a
+   syscall) must be marked.  Ranges outside the stack and heap (e.g. the
+   input region) are ignored.  Translated stack and heap ranges never
+   start below vm->stack, so checking the first byte is sufficient. */
+
+static inline void
+fd_vm_mem_st_mark( fd_vm_t * vm,
+                   ulong     haddr,
+                   ulong     sz ) {
+  ulong off = haddr - (ulong)vm->stack;
+  if( (off>=FD_VM_STACK_MAX+FD_VM_HEAP_MAX) | (!sz) ) return;
+  ulong pg0 = off >> FD_VM_ST_DIRTY_LG_PAGE_SZ;
+  ulong pg1 = fd_ulong_min( off+sz-1UL, FD_VM_STACK_MAX+FD_VM_HEAP_MAX-1UL ) >> FD_VM_ST_DIRTY_LG_PAGE_SZ;
+  for( ulong pg=pg0; pg<=pg1; pg++ ) vm->st_dirty[ pg>>6 ] |= 1UL << (pg & 63UL);
+}
+
 /* FIXME: CONSIDER MOVING TO FD_VM_SYSCALL.H */
 /* FD_VM_MEM_HADDR_LD returns a read only pointer to the first byte
    in the host address space corresponding to vm's virtual address range
@@ -255,18 +328,23 @@ static inline void fd_vm_mem_st_8( ulong haddr, ulong  val ) { memcpy( (void *)h
    implementations and strictly conforms with the vm-syscall ABI
    interface.
 
-   FD_VM_MEM_HADDR_ST returns a read-write pointer but is otherwise
-   identical to FD_VM_MEM_HADDR_LD.
+   FD_VM_MEM_HADDR_ST returns a read-write pointer (and marks the range
+   as stored to, see fd_vm_mem_st_mark) but is otherwise identical to
+   FD_VM_MEM_HADDR_LD.
 
    FD_VM_MEM_HADDR_LD_FAST and FD_VM_HADDR_ST_FAST are for use when the
    corresponding vaddr region it known to correctly resolve (e.g.  a
-   syscall has already done preflight checks on them). */
+   syscall has already done preflight checks on them).  They do not
+   handle directly mapped input ranges and thus must not be used for
+   input region addresses.  FD_VM_MEM_HADDR_ST_FAST does not mark the
+   range as stored to. */
 
 #define FD_VM_MEM_HADDR_LD( vm, vaddr, align, sz ) (__extension__({                                       \
     fd_vm_t const * _vm     = (vm);                                                                       \
     ulong           _vaddr  = (vaddr);                                                                    \
     int             _sigbus = _vm->check_align & (!fd_ulong_is_aligned( _vaddr, (align) ));               \
     ulong           _haddr  = fd_vm_mem_haddr( vm, _vaddr, (sz), _vm->region_haddr, _vm->region_ld_sz, 0, 0UL ); \
+    if( FD_UNLIKELY( !_haddr ) ) _haddr = fd_vm_mem_haddr_input( (vm), _vaddr, (sz), 0 );                 \
     if( FD_UNLIKELY( (!_haddr) | _sigbus) ) return FD_VM_ERR_SIGSEGV;                                     \
     (void const *)_haddr;                                                                                 \
   }))
@@ -275,6 +353,7 @@ static inline void fd_vm_mem_st_8( ulong haddr, ulong  val ) { memcpy( (void *)h
     fd_vm_t const * _vm     = (vm);                                                                       \
     ulong           _vaddr  = (vaddr);                                                                    \
     ulong           _haddr  = fd_vm_mem_haddr( vm, _vaddr, (sz), _vm->region_haddr, _vm->region_ld_sz, 0, 0UL ); \
+    if( FD_UNLIKELY( !_haddr ) ) _haddr = fd_vm_mem_haddr_input( (vm), _vaddr, (sz), 0 );                 \
     (void const *)_haddr;                                                                                 \
   }))
 
@@ -283,7 +362,9 @@ static inline void fd_vm_mem_st_8( ulong haddr, ulong  val ) { memcpy( (void *)h
     ulong           _vaddr  = (vaddr);                                                                    \
     int             _sigbus = _vm->check_align & (!fd_ulong_is_aligned( _vaddr, (align) ));               \
     ulong           _haddr  = fd_vm_mem_haddr( vm, _vaddr, (sz), _vm->region_haddr, _vm->region_st_sz, 1, 0UL ); \
+    if( FD_UNLIKELY( !_haddr ) ) _haddr = fd_vm_mem_haddr_input( (vm), _vaddr, (sz), 1 );                 \
     if( FD_UNLIKELY( (!_haddr) | _sigbus) ) return FD_VM_ERR_SIGSEGV;                                     \
+    fd_vm_mem_st_mark( (vm), _haddr, (sz) );                                                              \
     (void *)_haddr;                                                                                       \
   }))
 
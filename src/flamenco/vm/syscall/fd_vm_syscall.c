@@ -137,3 +137,22 @@ fd_vm_syscall_register_slot( fd_sbpf_syscalls_t *       syscalls,
 
   return FD_VM_SUCCESS;
 }
+
+static fd_sbpf_syscalls_t fd_vm_syscall_table_all_exec  [ FD_SBPF_SYSCALLS_SLOT_CNT ];
+static fd_sbpf_syscalls_t fd_vm_syscall_table_all_deploy[ FD_SBPF_SYSCALLS_SLOT_CNT ];
+
+fd_sbpf_syscalls_t *
+fd_vm_syscall_table_all( uchar is_deploy ) {
+  if( is_deploy ) {
+    FD_ONCE_BEGIN {
+      fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_join( fd_sbpf_syscalls_new( fd_vm_syscall_table_all_deploy ) );
+      if( FD_UNLIKELY( fd_vm_syscall_register_all( syscalls, 1 ) ) ) FD_LOG_ERR(( "fd_vm_syscall_register_all failed" ));
+    } FD_ONCE_END;
+    return fd_vm_syscall_table_all_deploy;
+  }
+  FD_ONCE_BEGIN {
+    fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_join( fd_sbpf_syscalls_new( fd_vm_syscall_table_all_exec ) );
+    if( FD_UNLIKELY( fd_vm_syscall_register_all( syscalls, 0 ) ) ) FD_LOG_ERR(( "fd_vm_syscall_register_all failed" ));
+  } FD_ONCE_END;
+  return fd_vm_syscall_table_all_exec;
+}
@@ -247,9 +247,10 @@ fd_vm_syscall_sol_log_data( /**/            void *  _vm,
     ulong  msg_max = fd_vm_log_prepare_max( vm );
     ulong msg_len  = 0UL;
     if ( FD_LIKELY( slice[ slice_idx ].len > 0UL ) ) {
-      msg_len = fd_base64_encode( msg,
-                                       FD_VM_MEM_HADDR_LD_FAST( vm, slice[ slice_idx ].addr ),
-                                       fd_ulong_min( slice[ slice_idx ].len, (3UL*msg_max-11UL)/4UL ) );
+      /* Not _FAST: the slice might live in a directly mapped part of the
+         input region (see fd_vm_input_direct_map). */
+      ulong buf_sz = fd_ulong_min( slice[ slice_idx ].len, (3UL*msg_max-11UL)/4UL );
+      msg_len = fd_base64_encode( msg, FD_VM_MEM_SLICE_HADDR_LD( vm, slice[ slice_idx ].addr, 1UL, buf_sz ), buf_sz );
     }
     msg[ msg_len ] = ' ';
     msg_len += (ulong)( slice_idx < (slice_cnt-1UL) ); /* Note that slice cnt is at least 1 here */
@@ -113,6 +113,22 @@ FD_STATIC_ASSERT( FD_VM_TRACE_EVENT_TYPE_EXE   ==0, vm_trace );
 FD_STATIC_ASSERT( FD_VM_TRACE_EVENT_TYPE_READ  ==1, vm_trace );
 FD_STATIC_ASSERT( FD_VM_TRACE_EVENT_TYPE_WRITE ==2, vm_trace );
 
+static uchar vm_pool_mem[ 2UL*FD_VM_FOOTPRINT ] __attribute__((aligned(FD_VM_ALIGN)));
+
+/* test_haddr translates like the interpreter does, falling back to the
+   directly mapped input ranges when the tlb translation fails */
+
+static ulong
+test_haddr( fd_vm_t * vm,
+            ulong     vaddr,
+            ulong     sz,
+            uchar     write ) {
+  uint const * region_sz = write ? vm->region_st_sz : vm->region_ld_sz;
+  ulong haddr = fd_vm_mem_haddr( vm, vaddr, sz, vm->region_haddr, region_sz, write, 0UL );
+  if( !haddr ) haddr = fd_vm_mem_haddr_input( vm, vaddr, sz, write );
+  return haddr;
+}
+
 #if 0 /* FIXME: MOVE TESTING TO VM */
 static fd_vm_log_collector_t lc[1];
 static uchar lc_mirror[ FD_VM_LOG_MAX ];
@@ -335,6 +351,104 @@ vm_trace_done:
   FD_TEST( !fd_vm_trace_join  ( _trace ) ); /* not a trace */
   FD_TEST( !fd_vm_trace_delete( _trace ) ); /* not a trace */
 
+  /* Test shared syscall tables */
+
+  fd_sbpf_syscalls_t * syscalls_exec   = fd_vm_syscall_table_all( 0 );
+  fd_sbpf_syscalls_t * syscalls_deploy = fd_vm_syscall_table_all( 1 );
+  FD_TEST( syscalls_exec && syscalls_deploy && syscalls_exec!=syscalls_deploy );
+  FD_TEST( fd_vm_syscall_table_all( 0 )==syscalls_exec   );
+  FD_TEST( fd_vm_syscall_table_all( 1 )==syscalls_deploy );
+
+  uint sol_alloc_free_key = fd_murmur3_32( "sol_alloc_free_", 15UL, 0U );
+  FD_TEST(  fd_sbpf_syscalls_query( syscalls_exec,   sol_alloc_free_key, NULL ) );
+  FD_TEST( !fd_sbpf_syscalls_query( syscalls_deploy, sol_alloc_free_key, NULL ) );
+
+  /* Test vm pool */
+
+  FD_TEST( fd_vm_pool_footprint( 2UL )==sizeof(vm_pool_mem) );
+  FD_TEST( !fd_vm_pool_acquire() ); /* not attached */
+
+  fd_vm_pool_attach( vm_pool_mem, 2UL );
+
+  fd_vm_t * vm0 = fd_vm_pool_acquire(); FD_TEST( vm0 );
+  fd_vm_t * vm1 = fd_vm_pool_acquire(); FD_TEST( vm1 && vm1!=vm0 );
+  FD_TEST( !fd_vm_pool_acquire() ); /* exhausted */
+
+  /* Stores marked with fd_vm_mem_st_mark get cleared on release
+     (including ones spanning pages and the stack / heap boundary) and
+     unmarked memory is left alone. */
+
+  uchar * mem = (uchar *)vm0 + offsetof( fd_vm_t, stack ); /* Stack followed by heap */
+  ulong st_off[4] = { 0UL, 3UL*4096UL+4000UL, FD_VM_STACK_MAX-100UL, FD_VM_STACK_MAX+FD_VM_HEAP_MAX-8UL };
+  ulong st_sz [4] = { 8UL, 200UL,             300UL,                 8UL                                };
+  for( ulong j=0UL; j<4UL; j++ ) {
+    memset( mem + st_off[j], 0xa5, st_sz[j] );
+    fd_vm_mem_st_mark( vm0, (ulong)mem + st_off[j], st_sz[j] );
+  }
+  fd_vm_mem_st_mark( vm0, (ulong)vm0->log, 8UL ); /* Not stack or heap, ignored */
+  mem[ 2UL*4096UL ] = (uchar)0x5a;                /* Unmarked */
+  fd_vm_pool_release( vm0 );
+
+  FD_TEST( fd_vm_pool_acquire()==vm0 );
+  for( ulong j=0UL; j<FD_VM_ST_DIRTY_WORD_CNT; j++ ) FD_TEST( !vm0->st_dirty[j] );
+  for( ulong i=0UL; i<FD_VM_STACK_MAX+FD_VM_HEAP_MAX; i++ ) FD_TEST( mem[i]==( i==2UL*4096UL ? (uchar)0x5a : (uchar)0 ) );
+  mem[ 2UL*4096UL ] = (uchar)0;
+
+  fd_vm_pool_release( vm1 );
+  fd_vm_pool_release( vm0 );
+  FD_TEST( fd_vm_pool_detach()==vm_pool_mem );
+  FD_TEST( !fd_vm_pool_acquire() );
+
+  /* Test directly mapped input ranges */
+
+  do {
+    fd_vm_t * vm = fd_vm_join( fd_vm_new( vm_pool_mem ) ); FD_TEST( vm );
+
+    uchar input[ 64 ]; memset( input, 0x11, sizeof(input) );
+    uchar data0[ 16 ]; for( ulong i=0UL; i<16UL; i++ ) data0[i] = (uchar)(0x80+i);
+    uchar data1[  8 ]; for( ulong i=0UL; i< 8UL; i++ ) data1[i] = (uchar)(0xc0+i);
+    memset( input+16, 0, 16UL ); memset( input+40, 0, 8UL ); /* not populated */
+
+    fd_exec_instr_ctx_t * instr_ctx = (fd_exec_instr_ctx_t *)1UL; /* never dereferenced */
+    FD_TEST( fd_vm_init( vm, instr_ctx, 0UL, 0UL, NULL, 0UL, NULL, 0UL, 0UL, 0UL, 0UL, NULL, NULL, input, sizeof(input), NULL, NULL )==vm );
+
+    fd_vm_input_region_t bad[2] = { { .off=16UL, .sz=16UL, .haddr=data0 }, { .off=24UL, .sz=8UL, .haddr=data1 } };
+    FD_TEST( !fd_vm_input_direct_map( vm, bad, 2UL ) ); /* overlap */
+    bad[1].off = 60UL;
+    FD_TEST( !fd_vm_input_direct_map( vm, bad, 2UL ) ); /* out of bounds */
+
+    fd_vm_input_region_t region[2] = { { .off=16UL, .sz=16UL, .haddr=data0 }, { .off=40UL, .sz=8UL, .haddr=data1 } };
+    FD_TEST( fd_vm_input_direct_map( vm, region, 2UL )==vm );
+    FD_TEST( vm->region_ld_sz[4]==16U && vm->region_st_sz[4]==16U );
+
+    ulong base = FD_VM_MEM_MAP_INPUT_REGION_START;
+#   define LD( off, sz ) test_haddr( vm, base+(off), (sz), 0 )
+#   define ST( off, sz ) test_haddr( vm, base+(off), (sz), 1 )
+
+    FD_TEST( LD(  0UL, 8UL )==(ulong)input        );   /* tlb */
+    FD_TEST( LD( 16UL, 8UL )==(ulong)data0        );   /* direct */
+    FD_TEST( LD( 20UL, 8UL )==(ulong)(data0+4)    );   /* window */
+    FD_TEST( LD( 40UL, 8UL )==(ulong)data1        );
+    FD_TEST( !LD( 60UL, 8UL ) );                       /* out of bounds */
+    FD_TEST( !region[0].is_copied && !region[1].is_copied );
+
+    FD_TEST( LD( 12UL, 8UL )==(ulong)(input+12) );     /* spans range 0 */
+    FD_TEST( region[0].is_copied && !region[1].is_copied );
+    FD_TEST( !memcmp( input+16, data0, 16UL ) );
+    FD_TEST( LD( 32UL, 8UL )==(ulong)(input+32) );     /* window, [0,40) */
+    FD_TEST( ST( 36UL, 4UL )==(ulong)(input+36) );
+    FD_TEST( LD( 36UL, 8UL )==(ulong)(input+36) );     /* spans range 1 */
+    FD_TEST( region[1].is_copied );
+    FD_TEST( !memcmp( input+40, data1, 8UL ) );
+    FD_TEST( ST( 44UL, 4UL )==(ulong)(input+44) );
+    FD_TEST( !ST( 62UL, 4UL ) );
+
+#   undef ST
+#   undef LD
+
+    FD_TEST( fd_vm_delete( fd_vm_leave( vm ) )==(void *)vm_pool_mem );
+  } while(0);
+
   fd_rng_delete( fd_rng_leave( rng ) );
 
   FD_LOG_NOTICE(( "pass" ));
@@ -4,6 +4,7 @@
 #include "fd_vm.h"
 #include "fd_vm_base.h"
 #include "fd_vm_private.h"
+#include "fd_vm_jit.h"
 #include "test_vm_util.h"
 #include <assert.h>
 #include <ctype.h>
@@ -343,16 +344,28 @@ parse_next( test_parser_t *  p,
 
 /* Execution **********************************************************/
 
+static uchar jit_mem[ 1UL<<16 ] __attribute__((aligned(FD_VM_JIT_ALIGN)));
+
 static void
 run_input2( test_effects_t * out,
-            fd_vm_t *        vm ) {
+            fd_vm_t *        vm,
+            int              jit ) {
 
   if( fd_vm_validate( vm ) != FD_VM_SUCCESS ) {
     out->status = STATUS_VERIFY_FAIL;
     return;
   }
 
-  if( fd_vm_exec_notrace( vm ) != FD_VM_SUCCESS ) {
+  int err;
+  if( jit ) {
+    ulong jit_sz = fd_vm_jit_compile( jit_mem, sizeof(jit_mem), vm->text, vm->text_cnt, vm->text_off, vm->entry_pc, vm->calldests );
+    FD_TEST( jit_sz && jit_sz<=sizeof(jit_mem) );
+    err = fd_vm_exec_jit( vm, jit_mem );
+  } else {
+    err = fd_vm_exec_notrace( vm );
+  }
+
+  if( err != FD_VM_SUCCESS ) {
     out->status = STATUS_FAULT;
     return;
   }
@@ -370,7 +383,8 @@ run_input2( test_effects_t * out,
 static void
 run_input( test_input_t const * input,
            test_effects_t *     out,
-           fd_vm_t *            vm ) {
+           fd_vm_t *            vm,
+           int                  jit ) {
 
   /* Assemble instructions */
 
@@ -430,7 +444,7 @@ run_input( test_input_t const * input,
     vm->reg[i] = input->reg[i];
   }
 
-  run_input2( out, vm );
+  run_input2( out, vm, jit );
 
   /* Clean up */
   test_vm_exec_instr_ctx_delete( instr_ctx );
@@ -439,24 +453,26 @@ run_input( test_input_t const * input,
   free( input_copy );
 }
 
-/* run_fixture runs a test fixture.  Returns 1 if the local execution
-   result matches the expected result.  Otherwise logs details about the
-   mismatch and returns 0. */
+/* run_fixture runs a test fixture with the interpreter (jit 0) or the
+   jit (jit 1).  Returns 0 if the local execution result matches the
+   expected result.  Otherwise logs details about the mismatch and
+   returns 1. */
 
 static int
 run_fixture( test_fixture_t const * f,
              char const *           src_file,
-             fd_vm_t *              vm ) {
+             fd_vm_t *              vm,
+             int                    jit ) {
 
   int fail = 0;
 
   test_effects_t const * expected  = &f->effects;
   test_effects_t         actual[1] = {{0}};
-  run_input( &f->input, actual, vm );
+  run_input( &f->input, actual, vm, jit );
 
   if( expected->status != actual->status ) {
-    FD_LOG_WARNING(( "FAIL %s(%lu): Expected status %s, got %s",
-                     src_file, f->line,
+    FD_LOG_WARNING(( "FAIL %s(%lu)%s: Expected status %s, got %s",
+                     src_file, f->line, jit ? " (jit)" : "",
                      test_status_str( expected->status ),
                      test_status_str( actual  ->status ) ));
     fail = 1;
@@ -471,8 +487,8 @@ run_fixture( test_fixture_t const * f,
     ulong reg_expected = expected->reg[i];
     ulong reg_actual   = actual  ->reg[i];
     if( reg_expected != reg_actual ) {
-      FD_LOG_WARNING(( "FAIL %s(%lu): Expected r%u = %#lx, got %#lx",
-                       src_file, f->line, i, reg_expected, reg_actual ));
+      FD_LOG_WARNING(( "FAIL %s(%lu)%s: Expected r%u = %#lx, got %#lx",
+                       src_file, f->line, jit ? " (jit)" : "", i, reg_expected, reg_actual ));
       fail = 1;
     }
   }
@@ -518,7 +534,8 @@ handle_file( char const * file_path,
     test_fixture_t * f = NULL;
     f = parse_next( &parser, _f );
     if( !f ) break;
-    fail += run_fixture( f, file_path, vm );
+    fail += run_fixture( f, file_path, vm, 0 );
+    if( fd_vm_jit_cache_query() ) fail += run_fixture( f, file_path, vm, 1 );
   }
 
   if( FD_UNLIKELY( 0!=close( fd ) ) ) {
@@ -549,6 +566,11 @@ main( int     argc,
   static fd_vm_t _vm[1];
   fd_vm_t * vm = fd_vm_join( fd_vm_new( _vm ) );
 
+  /* Also run every test with the jit if available */
+
+  void * jit_cache = fd_vm_jit_cache_new( 1UL<<20 );
+  if( jit_cache ) fd_vm_jit_cache_attach( jit_cache );
+
   /* Execute all arguments that don't look like flags */
 
   int   fail = 0;
@@ -582,6 +604,8 @@ main( int     argc,
     }
   }
 
+  if( jit_cache ) fd_vm_jit_cache_delete( fd_vm_jit_cache_detach() );
+
   if( !fail ) FD_LOG_NOTICE(( "pass" ));
   else        FD_LOG_WARNING(( "fail cnt %d", fail ));
 
@@ -1,6 +1,7 @@
 #include "fd_vm.h"
 #include "fd_vm_base.h"
 #include "fd_vm_private.h"
+#include "fd_vm_jit.h"
 #include "test_vm_util.h"
 #include <stdlib.h>  /* malloc */
 
@@ -77,7 +78,81 @@ test_program_success( char *                test_case_name,
   }
 //FD_LOG_NOTICE(( "Instr counter: %lu", vm.ic ));
   FD_TEST( vm->reg[0]==expected_result );
-  FD_LOG_NOTICE(( "%-20s %11li ns", test_case_name, dt ));
+
+  /* Run the same program compiled and check the jit agrees exactly */
+
+  ulong  jit_sz = text_cnt<=FD_VM_JIT_TEXT_MAX ? fd_vm_jit_footprint_est( text_cnt ) : 0UL; /* Too large runs the interpreter */
+  void * jit    = NULL;
+  while( jit_sz ) {
+    jit = aligned_alloc( FD_VM_JIT_ALIGN, fd_ulong_align_up( jit_sz, FD_VM_JIT_ALIGN ) ); FD_TEST( jit );
+    ulong req = fd_vm_jit_compile( jit, jit_sz, text, text_cnt, 0UL, 0UL, NULL );
+    if( req<=jit_sz ) { jit_sz = req; break; }
+    free( jit );
+    jit_sz = req;
+  }
+
+  fd_vm_t _jit_vm[1];
+  fd_vm_t * jit_vm = fd_vm_join( fd_vm_new( _jit_vm ) );
+  FD_TEST( jit_vm );
+  FD_TEST( fd_vm_init( jit_vm, instr_ctx, FD_VM_HEAP_DEFAULT, FD_VM_COMPUTE_UNIT_LIMIT, (uchar *)text, 8UL*text_cnt, text, text_cnt,
+                       0UL, 8UL*text_cnt, 0UL, NULL, syscalls, NULL, 0UL, NULL, sha ) );
+
+  long jit_dt = -fd_log_wallclock();
+  int  jit_err = fd_vm_exec_jit( jit_vm, jit_sz ? jit : NULL );
+  jit_dt += fd_log_wallclock();
+
+  FD_TEST( jit_err==err );
+  FD_TEST( (jit_vm->pc==vm->pc) & (jit_vm->ic==vm->ic) & (jit_vm->cu==vm->cu) & (jit_vm->frame_cnt==vm->frame_cnt) );
+  FD_TEST( !memcmp( jit_vm->reg, vm->reg, FD_VM_REG_MAX*sizeof(ulong) ) );
+
+  fd_vm_delete( fd_vm_leave( jit_vm ) );
+  free( jit );
+
+  /* Run it again with the segment cost table and check the metering
+     agrees exactly */
+
+  uint * seg_cost = (uint *)malloc( fd_vm_seg_cost_footprint( text_cnt ) ); FD_TEST( seg_cost );
+  FD_TEST( fd_vm_seg_cost( seg_cost, text, text_cnt )==seg_cost );
+
+  fd_vm_t _seg_vm[1];
+  fd_vm_t * seg_vm = fd_vm_join( fd_vm_new( _seg_vm ) );
+  FD_TEST( seg_vm );
+  FD_TEST( fd_vm_init( seg_vm, instr_ctx, FD_VM_HEAP_DEFAULT, FD_VM_COMPUTE_UNIT_LIMIT, (uchar *)text, 8UL*text_cnt, text, text_cnt,
+                       0UL, 8UL*text_cnt, 0UL, NULL, syscalls, NULL, 0UL, NULL, sha ) );
+  FD_TEST( fd_vm_seg_cost_set( seg_vm, seg_cost )==seg_vm );
+
+  long seg_dt = -fd_log_wallclock();
+  int  seg_err = fd_vm_exec( seg_vm );
+  seg_dt += fd_log_wallclock();
+
+  FD_TEST( seg_err==err );
+  FD_TEST( (seg_vm->pc==vm->pc) & (seg_vm->ic==vm->ic) & (seg_vm->cu==vm->cu) & (seg_vm->frame_cnt==vm->frame_cnt) );
+  FD_TEST( !memcmp( seg_vm->reg, vm->reg, FD_VM_REG_MAX*sizeof(ulong) ) );
+
+  /* And with the predecoded text on top */
+
+  fd_vm_predecoded_t * predecoded = (fd_vm_predecoded_t *)aligned_alloc( 16UL, fd_ulong_align_up( fd_vm_predecode_footprint( text_cnt ), 16UL ) );
+  FD_TEST( predecoded );
+  FD_TEST( fd_vm_predecode( predecoded, text, text_cnt, 0UL, NULL )==predecoded );
+
+  FD_TEST( fd_vm_init( seg_vm, instr_ctx, FD_VM_HEAP_DEFAULT, FD_VM_COMPUTE_UNIT_LIMIT, (uchar *)text, 8UL*text_cnt, text, text_cnt,
+                       0UL, 8UL*text_cnt, 0UL, NULL, syscalls, NULL, 0UL, NULL, sha ) );
+  FD_TEST( fd_vm_seg_cost_set ( seg_vm, seg_cost   )==seg_vm );
+  FD_TEST( fd_vm_predecode_set( seg_vm, predecoded )==seg_vm );
+
+  long pre_dt = -fd_log_wallclock();
+  int  pre_err = fd_vm_exec( seg_vm );
+  pre_dt += fd_log_wallclock();
+
+  FD_TEST( pre_err==err );
+  FD_TEST( (seg_vm->pc==vm->pc) & (seg_vm->ic==vm->ic) & (seg_vm->cu==vm->cu) & (seg_vm->frame_cnt==vm->frame_cnt) );
+  FD_TEST( !memcmp( seg_vm->reg, vm->reg, FD_VM_REG_MAX*sizeof(ulong) ) );
+
+  fd_vm_delete( fd_vm_leave( seg_vm ) );
+  free( predecoded );
+  free( seg_cost );
+
+  FD_LOG_NOTICE(( "%-20s %11li ns (seg cost %11li ns, predecoded %11li ns, jit %11li ns)", test_case_name, dt, seg_dt, pre_dt, jit_dt ));
 //FD_LOG_NOTICE(( "Time/Instr: %f ns", (double)dt / (double)vm.ic ));
 //FD_LOG_NOTICE(( "Mega Instr/Sec: %f", 1000.0 * ((double)vm.ic / (double) dt)));
 }
@@ -279,6 +354,72 @@ test_0cu_exit( void ) {
   fd_sha256_delete( fd_sha256_leave( sha ) );
 }
 
+/* test_seg_cost runs the given program with every compute budget in
+   [0,cu_max] with and without a segment cost table (and predecoded
+   text) and checks the results (in particular the point at which the program runs out of
+   compute units) are identical. */
+
+static void
+test_seg_cost( char const *          test_case_name,
+               ulong const *         text,
+               ulong                 text_cnt,
+               ulong                 cu_max,
+               fd_sbpf_syscalls_t *  syscalls,
+               fd_exec_instr_ctx_t * instr_ctx ) {
+
+  fd_sha256_t _sha[1];
+  fd_sha256_t * sha = fd_sha256_join( fd_sha256_new( _sha ) );
+
+  uint seg_cost[ 64 ];
+  FD_TEST( fd_vm_seg_cost_footprint( text_cnt )<=sizeof(seg_cost) );
+  FD_TEST( fd_vm_seg_cost( seg_cost, text, text_cnt )==seg_cost );
+  FD_TEST( !seg_cost[ text_cnt ] );
+
+  fd_vm_predecoded_t predecoded[ 64 ];
+  FD_TEST( fd_vm_predecode_footprint( text_cnt )<=sizeof(predecoded) );
+  FD_TEST( fd_vm_predecode( predecoded, text, text_cnt, 0UL, NULL )==predecoded );
+
+  fd_vm_t _vm[3];
+  fd_vm_t * vm     = fd_vm_join( fd_vm_new( _vm+0 ) ); FD_TEST( vm     );
+  fd_vm_t * seg_vm = fd_vm_join( fd_vm_new( _vm+1 ) ); FD_TEST( seg_vm );
+  fd_vm_t * pre_vm = fd_vm_join( fd_vm_new( _vm+2 ) ); FD_TEST( pre_vm );
+
+  ulong short_cnt = 0UL;
+  for( ulong cu=0UL; cu<=cu_max; cu++ ) {
+    FD_TEST( fd_vm_init( vm,     instr_ctx, FD_VM_HEAP_DEFAULT, cu, (uchar *)text, 8UL*text_cnt, text, text_cnt,
+                         0UL, 8UL*text_cnt, 0UL, NULL, syscalls, NULL, 0UL, NULL, sha ) );
+    FD_TEST( fd_vm_init( seg_vm, instr_ctx, FD_VM_HEAP_DEFAULT, cu, (uchar *)text, 8UL*text_cnt, text, text_cnt,
+                         0UL, 8UL*text_cnt, 0UL, NULL, syscalls, NULL, 0UL, NULL, sha ) );
+    fd_vm_seg_cost_set( seg_vm, seg_cost );
+    FD_TEST( fd_vm_init( pre_vm, instr_ctx, FD_VM_HEAP_DEFAULT, cu, (uchar *)text, 8UL*text_cnt, text, text_cnt,
+                         0UL, 8UL*text_cnt, 0UL, NULL, syscalls, NULL, 0UL, NULL, sha ) );
+    fd_vm_seg_cost_set ( pre_vm, seg_cost   );
+    fd_vm_predecode_set( pre_vm, predecoded );
+
+    int err     = fd_vm_exec( vm     );
+    int seg_err = fd_vm_exec( seg_vm );
+    int pre_err = fd_vm_exec( pre_vm );
+
+    if( FD_UNLIKELY( (seg_err!=err) | (seg_vm->pc!=vm->pc) | (seg_vm->ic!=vm->ic) | (seg_vm->cu!=vm->cu) ) )
+      FD_LOG_ERR(( "%s (cu %lu): err %i pc %lu ic %lu cu %lu, with seg cost err %i pc %lu ic %lu cu %lu", test_case_name, cu,
+                   err, vm->pc, vm->ic, vm->cu, seg_err, seg_vm->pc, seg_vm->ic, seg_vm->cu ));
+    FD_TEST( seg_vm->frame_cnt==vm->frame_cnt );
+    FD_TEST( !memcmp( seg_vm->reg, vm->reg, FD_VM_REG_MAX*sizeof(ulong) ) );
+    if( FD_UNLIKELY( (pre_err!=err) | (pre_vm->pc!=vm->pc) | (pre_vm->ic!=vm->ic) | (pre_vm->cu!=vm->cu) ) )
+      FD_LOG_ERR(( "%s (cu %lu): err %i pc %lu ic %lu cu %lu, predecoded err %i pc %lu ic %lu cu %lu", test_case_name, cu,
+                   err, vm->pc, vm->ic, vm->cu, pre_err, pre_vm->pc, pre_vm->ic, pre_vm->cu ));
+    FD_TEST( pre_vm->frame_cnt==vm->frame_cnt );
+    FD_TEST( !memcmp( pre_vm->reg, vm->reg, FD_VM_REG_MAX*sizeof(ulong) ) );
+    short_cnt += (ulong)!vm->cu;
+  }
+  FD_TEST( short_cnt && short_cnt<=cu_max ); /* Both budgets that ran out and that did not were covered */
+
+  fd_vm_delete( fd_vm_leave( pre_vm ) );
+  fd_vm_delete( fd_vm_leave( seg_vm ) );
+  fd_vm_delete( fd_vm_leave( vm     ) );
+  fd_sha256_delete( fd_sha256_leave( sha ) );
+}
+
 static fd_sbpf_syscalls_t _syscalls[ FD_SBPF_SYSCALLS_SLOT_CNT ];
 
 int
@@ -294,6 +435,10 @@ main( int     argc,
 
   FD_TEST( fd_vm_syscall_register( syscalls, "accumulator", accumulator_syscall )==FD_VM_SUCCESS );
 
+  void * jit_cache = fd_vm_jit_cache_new( FD_VM_JIT_CACHE_SZ_DEFAULT );
+  if( jit_cache ) fd_vm_jit_cache_attach( jit_cache );
+  else            FD_LOG_WARNING(( "jit unavailable, testing the interpreter against itself" ));
+
 # define TEST_PROGRAM_SUCCESS( test_case_name, expected_result, text_cnt, ... ) do { \
     ulong _text[ text_cnt ] = { __VA_ARGS__ };                                       \
     test_program_success( (test_case_name), (expected_result), _text, (text_cnt), syscalls, instr_ctx ); \
@@ -942,8 +1087,76 @@ main( int     argc,
 
   test_0cu_exit();
 
+# define TEST_SEG_COST( test_case_name, cu_max, text_cnt, ... ) do {           \
+    ulong _text[ text_cnt ] = { __VA_ARGS__ };                                \
+    test_seg_cost( (test_case_name), _text, (text_cnt), (cu_max), syscalls, instr_ctx ); \
+  } while(0)
+
+  TEST_SEG_COST( "seg-loop", 64UL, 12,
+    FD_SBPF_INSTR( FD_SBPF_OP_MOV64_IMM, FD_SBPF_R1, 0,          0, 5   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_LDDW,      FD_SBPF_R2, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADDL_IMM,  0,          0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_REG, FD_SBPF_R0, FD_SBPF_R2, 0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_SUB64_IMM, FD_SBPF_R1, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_JNE_IMM,   FD_SBPF_R1, 0,         -5, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_MOV64_IMM, FD_SBPF_R1, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_MOV64_IMM, FD_SBPF_R2, 0,          0, 2   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_CALL_IMM,  0,          0,          0, fd_murmur3_32( "accumulator", 11UL, 0U ) ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_REG, FD_SBPF_R0, FD_SBPF_R1, 0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_JA,        0,          0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_EXIT,      0,          0,          0, 0   ),
+  );
+
+  TEST_SEG_COST( "seg-sigfpe", 16UL, 6,
+    FD_SBPF_INSTR( FD_SBPF_OP_MOV64_IMM, FD_SBPF_R2, 0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_LDDW,      FD_SBPF_R3, 0,          0, 7   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADDL_IMM,  0,          0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_DIV64_REG, FD_SBPF_R0, FD_SBPF_R2, 0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_EXIT,      0,          0,          0, 0   ),
+  );
+
+  TEST_SEG_COST( "seg-sigill", 16UL, 5,
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_LDDW,      FD_SBPF_R3, 0,          0, 7   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADDL_IMM,  0,          0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_END_LE,    FD_SBPF_R0, 0,          0, 13  ),
+    FD_SBPF_INSTR( FD_SBPF_OP_EXIT,      0,          0,          0, 0   ),
+  );
+
+  TEST_SEG_COST( "seg-sigsplit", 16UL, 4,
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_JA,        0,          0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_LDDW,      FD_SBPF_R3, 0,          0, 7   ),
+  );
+
+  TEST_SEG_COST( "seg-sigtext-branch", 8UL, 3,
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_JA,        0,          0,        100, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_EXIT,      0,          0,          0, 0   ),
+  );
+
+  TEST_SEG_COST( "seg-sigtext-end", 8UL, 4,
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_LDDW,      FD_SBPF_R3, 0,          0, 7   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADDL_IMM,  0,          0,          0, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+  );
+
+  TEST_SEG_COST( "seg-split-target", 16UL, 6,
+    FD_SBPF_INSTR( FD_SBPF_OP_JA,        0,          0,          1, 0   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_LDDW,      FD_SBPF_R3, 0,          0, 7   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_ADD64_IMM, FD_SBPF_R0, 0,          0, 1   ),
+    FD_SBPF_INSTR( FD_SBPF_OP_EXIT,      0,          0,          0, 0   ),
+  );
+
   free( text );
 
+  if( jit_cache ) fd_vm_jit_cache_delete( fd_vm_jit_cache_detach() );
+
   fd_sbpf_syscalls_delete( fd_sbpf_syscalls_leave( syscalls ) );
   test_vm_exec_instr_ctx_delete( instr_ctx );
 
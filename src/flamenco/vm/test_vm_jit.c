@@ -0,0 +1,503 @@
+#include "fd_vm_jit.h"
+#include "fd_vm_private.h"
+#include "test_vm_util.h"
+
+#if FD_HAS_X86
+
+/* Differential test of the jit against the interpreter.  Random
+   programs (biased toward the tricky cases: faults in the middle of
+   segments, tight cu budgets, jumps into multiword instructions, calls,
+   syscalls that fail or consume cu, ...) are run with both and the
+   resulting vm states must be identical.  The same programs also check
+   the interpreter gives identical results with a segment cost table
+   (fd_vm_seg_cost_set), with predecoded text (fd_vm_predecode_set) and
+   without. */
+
+#define TEXT_MAX   (1024UL)
+#define RODATA_OFF (8UL) /* In words, such that text_off is not zero */
+#define INPUT_SZ   (512UL)
+
+static fd_vm_t            vms[5];
+static ulong              rodata[ RODATA_OFF + TEXT_MAX ];
+static uchar              input[4][ INPUT_SZ ];
+static uint               seg_cost[ TEXT_MAX+1UL ];
+static fd_vm_predecoded_t predecoded[ TEXT_MAX ];
+static uchar              blob[ 1UL<<20 ] __attribute__((aligned(FD_VM_JIT_ALIGN)));
+static ulong              calldests_mem[ 1024 ];
+
+static fd_sbpf_syscalls_t _syscalls[ FD_SBPF_SYSCALLS_SLOT_CNT ];
+
+static fd_exec_instr_ctx_t * instr_ctx;
+static fd_sha256_t           _sha[1];
+
+/* Syscalls */
+
+static int
+syscall_accumulator( void *  _vm,
+                     ulong   arg0,
+                     ulong   arg1,
+                     ulong   arg2,
+                     ulong   arg3,
+                     ulong   arg4,
+                     ulong * ret ) {
+  (void)_vm;
+  *ret = arg0 + arg1 + arg2 + arg3 + arg4;
+  return 0;
+}
+
+static int
+syscall_consume( void *  _vm,
+                 ulong   arg0,
+                 ulong   arg1,
+                 ulong   arg2,
+                 ulong   arg3,
+                 ulong   arg4,
+                 ulong * ret ) {
+  (void)arg1; (void)arg2; (void)arg3; (void)arg4;
+  fd_vm_t * vm   = (fd_vm_t *)_vm;
+  ulong     cost = arg0 & 63UL;
+  *ret = vm->ic*3UL + vm->pc*5UL + vm->frame_cnt + vm->reg[6]; /* Sees the precise vm state */
+  if( cost>vm->cu ) { vm->cu = 0UL; return FD_VM_ERR_SIGCOST; }
+  vm->cu -= cost;
+  return 0;
+}
+
+static int
+syscall_fail( void *  _vm,
+              ulong   arg0,
+              ulong   arg1,
+              ulong   arg2,
+              ulong   arg3,
+              ulong   arg4,
+              ulong * ret ) {
+  (void)_vm; (void)arg1; (void)arg2; (void)arg3; (void)arg4;
+  *ret = arg0 ^ 0x5a5aUL;
+  return FD_VM_ERR_ABORT;
+}
+
+/* syscall_nest runs a small program on another vm (as a CPI would) */
+
+static ulong const nest_text[4] = {
+  0x00000001000000b7UL, /* mov64 r0, 1 */
+  0x000000000000200fUL, /* add64 r0, r2 (uninit regs are zero) */
+  0x0000000700000027UL, /* mul64 r0, 7 */
+  0x0000000000000095UL  /* exit */
+};
+
+static uchar nest_blob[ 4096 ] __attribute__((aligned(FD_VM_JIT_ALIGN)));
+
+static int
+syscall_nest( void *  _vm,
+              ulong   arg0,
+              ulong   arg1,
+              ulong   arg2,
+              ulong   arg3,
+              ulong   arg4,
+              ulong * ret ) {
+  (void)_vm; (void)arg1; (void)arg2; (void)arg3; (void)arg4;
+  fd_vm_t * vm = vms + 4;
+  FD_TEST( fd_vm_init( vm, instr_ctx, FD_VM_HEAP_DEFAULT, 100UL, (uchar const *)nest_text, 32UL, nest_text, 4UL, 0UL, 32UL,
+                       0UL, NULL, fd_sbpf_syscalls_join( _syscalls ), NULL, 0UL, NULL, _sha ) );
+  vm->reg[2] = arg0;
+  FD_TEST( !fd_vm_exec_jit( vm, nest_blob ) );
+  FD_TEST( vm->ic==4UL && vm->cu==96UL );
+  *ret = vm->reg[0];
+  return 0;
+}
+
+static uint imm_accumulator;
+static uint imm_consume;
+static uint imm_fail;
+static uint imm_nest;
+
+/* Program generator */
+
+static uchar const op_alu[] = {
+  0x00, 0x04, 0x0c, 0x14, 0x1c, 0x24, 0x2c, 0x34, 0x3c, 0x44, 0x4c, 0x54, 0x5c, 0x64, 0x6c, 0x74, 0x7c, 0x84,
+  0x94, 0x9c, 0xa4, 0xac, 0xb4, 0xbc, 0xc4, 0xcc, 0xd4, 0xdc,
+  0x07, 0x0f, 0x17, 0x1f, 0x27, 0x2f, 0x37, 0x3f, 0x47, 0x4f, 0x57, 0x5f, 0x67, 0x6f, 0x77, 0x7f, 0x87,
+  0x97, 0x9f, 0xa7, 0xaf, 0xb7, 0xbf, 0xc7, 0xcf
+};
+
+static uchar const op_mem[] = {
+  0x61, 0x69, 0x71, 0x79, 0x62, 0x6a, 0x72, 0x7a, 0x63, 0x6b, 0x73, 0x7b
+};
+
+static uchar const op_jmp[] = {
+  0x15, 0x1d, 0x25, 0x2d, 0x35, 0x3d, 0x45, 0x4d, 0x55, 0x5d, 0x65, 0x6d, 0x75, 0x7d,
+  0xa5, 0xad, 0xb5, 0xbd, 0xc5, 0xcd, 0xd5, 0xdd
+};
+
+static uchar const op_bad[] = {
+  0x01, 0x06, 0x0d, 0x10, 0x8c, 0x8f, 0x9d, 0xd7, 0xe5, 0xff
+};
+
+static uint
+rand_imm( fd_rng_t * rng ) {
+  switch( fd_rng_uint_roll( rng, 8U ) ) {
+  case 0:  return fd_rng_uint( rng );
+  case 1:  return 0x80000000U;
+  case 2:  return 0xffffffffU - fd_rng_uint_roll( rng, 4U );
+  case 3:  return fd_rng_uint_roll( rng, 70U );
+  case 4:  return 16U << fd_rng_uint_roll( rng, 3U );
+  default: return fd_rng_uint_roll( rng, 1024U );
+  }
+}
+
+static ulong
+rand_dst( fd_rng_t * rng ) {
+  return fd_rng_uint_roll( rng, 64U ) ? (ulong)fd_rng_uint_roll( rng, 10U ) : 10UL;
+}
+
+static ulong
+gen_program( fd_rng_t * rng,
+             ulong *    text,
+             ulong      text_cnt,
+             ulong *    calldests ) {
+  ulong text_off = RODATA_OFF*8UL;
+  ulong pc = 0UL;
+  while( pc<text_cnt-1UL ) {
+    uint  r   = fd_rng_uint_roll( rng, 100U );
+    ulong dst = rand_dst( rng );
+    ulong src = (ulong)fd_rng_uint_roll( rng, 11U );
+    uint  imm = rand_imm( rng );
+    short off = 0;
+
+    if( r<40U ) {
+      ulong op = op_alu[ fd_rng_uint_roll( rng, sizeof(op_alu) ) ];
+      if( (op==0x34) | (op==0x37) | (op==0x94) | (op==0x97) ) imm = fd_uint_max( imm, 1U );
+      text[ pc++ ] = fd_vm_instr( op, dst, src, 0, imm );
+    } else if( r<47U ) {
+      if( pc+2UL>text_cnt-1UL ) continue;
+      text[ pc++ ] = fd_vm_instr( 0x18, dst, 0, 0, imm );
+      text[ pc++ ] = fd_vm_instr( 0x00, 0, 0, 0, rand_imm( rng ) );
+    } else if( r<68U ) {
+      ulong op = op_mem[ fd_rng_uint_roll( rng, sizeof(op_mem) ) ];
+      ulong b;
+      uint  w = fd_rng_uint_roll( rng, 20U );
+      if(      w<12U ) { b = 10UL; off = (short)(-(int)fd_rng_uint_roll( rng, 0x1010U ) + 8); }
+      else if( w<17U ) { b = 1UL;  off = (short)((int)fd_rng_uint_roll( rng, INPUT_SZ+16UL ) - 8); }
+      else             { b = (ulong)fd_rng_uint_roll( rng, 11U ); off = (short)fd_rng_ushort( rng ); }
+      if( op & 0x2UL ) { text[ pc++ ] = fd_vm_instr( op, b, src, off, imm ); }   /* ST / STX: base is dst */
+      else             { text[ pc++ ] = fd_vm_instr( op, dst, b, off, imm ); }   /* LDX: base is src */
+    } else if( r<82U ) {
+      ulong op = op_jmp[ fd_rng_uint_roll( rng, sizeof(op_jmp) ) ];
+      uint  w  = fd_rng_uint_roll( rng, 16U );
+      if(      w<10U ) off = (short)(1 + (int)fd_rng_uint_roll( rng, 16U ));
+      else if( w<14U ) off = (short)(-(int)fd_rng_uint_roll( rng, 24U ) - 1);
+      else             off = (short)((int)fd_rng_uint_roll( rng, (uint)(2UL*text_cnt+8UL) ) - (int)text_cnt - 4);
+      if( !fd_rng_uint_roll( rng, 4U ) ) imm = fd_rng_uint_roll( rng, 4U );
+      text[ pc++ ] = fd_vm_instr( op, dst, src, off, imm );
+    } else if( r<85U ) {
+      off = (short)((int)fd_rng_uint_roll( rng, 40U ) - 12);
+      text[ pc++ ] = fd_vm_instr( 0x05, 0, 0, off, 0U );
+    } else if( r<91U ) {
+      uint w = fd_rng_uint_roll( rng, 16U );
+      if( w<6U ) {
+        ulong tgt = (ulong)fd_rng_uint_roll( rng, (uint)text_cnt );
+        fd_sbpf_calldests_insert( calldests, tgt );
+        imm = fd_pchash( (uint)tgt );
+      }
+      else if( w<7U  ) imm = 0x71e3cf81U;
+      else if( w<10U ) imm = imm_accumulator;
+      else if( w<12U ) imm = imm_consume;
+      else if( w<13U ) imm = imm_fail;
+      else if( w<14U ) imm = imm_nest;
+      else             imm = fd_pchash( fd_rng_uint_roll( rng, (uint)text_cnt ) ); /* Not a calldest */
+      text[ pc++ ] = fd_vm_instr( 0x85, 0, 0, 0, imm );
+    } else if( r<93U ) {
+      if( pc+3UL>text_cnt-1UL ) continue;
+      ulong k     = 1UL + (ulong)fd_rng_uint_roll( rng, 9U );
+      ulong vaddr = FD_VM_MEM_MAP_PROGRAM_REGION_START + text_off + 8UL*(ulong)fd_rng_uint_roll( rng, (uint)text_cnt+2U );
+      if( !fd_rng_uint_roll( rng, 8U ) ) vaddr += (ulong)fd_rng_uint_roll( rng, 8U );
+      if( !fd_rng_uint_roll( rng, 8U ) ) vaddr ^= 3UL<<32;
+      text[ pc++ ] = fd_vm_instr( 0x18, k, 0, 0, (uint)vaddr );
+      text[ pc++ ] = fd_vm_instr( 0x00, 0, 0, 0, (uint)(vaddr>>32) );
+      text[ pc++ ] = fd_vm_instr( 0x8d, 0, 0, 0, fd_rng_uint_roll( rng, 8U ) ? (uint)k : fd_rng_uint_roll( rng, 16U ) );
+    } else if( r<97U ) {
+      text[ pc++ ] = fd_vm_instr( 0x95, 0, 0, 0, 0U );
+    } else {
+      text[ pc++ ] = fd_vm_instr( op_bad[ fd_rng_uint_roll( rng, sizeof(op_bad) ) ], dst, src, 0, imm );
+    }
+  }
+  if( fd_rng_uint_roll( rng, 16U ) ) text[ pc++ ] = fd_vm_instr( 0x95, 0, 0, 0, 0U );
+  else                               text[ pc++ ] = fd_vm_instr( 0x18, 0, 0, 0, 0U ); /* Trailing lddw */
+  return pc;
+}
+
+/* vm_setup initializes vm to run the given program */
+
+static void
+vm_setup( fd_vm_t *     vm,
+          uchar *       in,
+          ulong const * text,
+          ulong         text_cnt,
+          ulong         entry_pc,
+          ulong *       calldests,
+          ulong         cu,
+          int           check_align,
+          ulong const * reg_init ) {
+  FD_TEST( fd_vm_init( vm, instr_ctx, FD_VM_HEAP_DEFAULT, cu, (uchar const *)rodata, 8UL*(RODATA_OFF+text_cnt), text, text_cnt,
+                       8UL*RODATA_OFF, 8UL*text_cnt, entry_pc, calldests, fd_sbpf_syscalls_join( _syscalls ), in, INPUT_SZ,
+                       NULL, _sha ) );
+  vm->check_align = check_align;
+  for( ulong i=2UL; i<10UL; i++ ) vm->reg[ i ] = reg_init[ i ];
+  fd_memset( vm->stack, 0, FD_VM_STACK_MAX );
+  fd_memset( vm->heap,  0, FD_VM_HEAP_DEFAULT );
+  fd_memset( vm->st_dirty, 0, sizeof(vm->st_dirty) );
+}
+
+static void
+vm_check( fd_vm_t const * ref,
+          int             ref_err,
+          fd_vm_t const * tst,
+          int             tst_err ) {
+  if( FD_UNLIKELY( (ref_err!=tst_err) | (ref->pc!=tst->pc) | (ref->ic!=tst->ic) | (ref->cu!=tst->cu) |
+                   (ref->frame_cnt!=tst->frame_cnt) ) ) {
+    FD_LOG_ERR(( "mismatch: ref err %i pc %lu ic %lu cu %lu frame_cnt %lu, got err %i pc %lu ic %lu cu %lu frame_cnt %lu",
+                 ref_err, ref->pc, ref->ic, ref->cu, ref->frame_cnt, tst_err, tst->pc, tst->ic, tst->cu, tst->frame_cnt ));
+  }
+  for( ulong i=0UL; i<FD_VM_REG_MAX; i++ ) {
+    if( FD_UNLIKELY( ref->reg[ i ]!=tst->reg[ i ] ) )
+      FD_LOG_ERR(( "mismatch: r%lu ref %016lx got %016lx (pc %lu)", i, ref->reg[ i ], tst->reg[ i ], ref->pc ));
+  }
+  FD_TEST( !memcmp( ref->shadow, tst->shadow, ref->frame_cnt*sizeof(fd_vm_shadow_t) ) );
+  FD_TEST( !memcmp( ref->stack,  tst->stack,  FD_VM_STACK_MAX    ) );
+  FD_TEST( !memcmp( ref->heap,   tst->heap,   FD_VM_HEAP_DEFAULT ) );
+  FD_TEST( !memcmp( ref->input,  tst->input,  INPUT_SZ           ) );
+
+  /* Every stack / heap page written to must be marked for clearing */
+  FD_TEST( !memcmp( ref->st_dirty, tst->st_dirty, sizeof(ref->st_dirty) ) );
+  uchar const * mem = (uchar const *)tst + offsetof( fd_vm_t, stack );
+  for( ulong pg=0UL; pg<(FD_VM_STACK_MAX+FD_VM_HEAP_DEFAULT)>>FD_VM_ST_DIRTY_LG_PAGE_SZ; pg++ ) {
+    if( fd_ulong_extract_bit( tst->st_dirty[ pg>>6 ], (int)(pg & 63UL) ) ) continue;
+    for( ulong i=0UL; i<(1UL<<FD_VM_ST_DIRTY_LG_PAGE_SZ); i++ ) FD_TEST( !mem[ (pg<<FD_VM_ST_DIRTY_LG_PAGE_SZ)+i ] );
+  }
+}
+
+/* test_diff runs the program in rodata with the interpreter, with the
+   interpreter using a segment cost table and with the jit and checks
+   that they agree */
+
+static void
+test_diff( fd_rng_t * rng,
+           ulong      text_cnt,
+           ulong      entry_pc,
+           ulong *    calldests,
+           int        jit_calldests ) {
+  ulong const * text = rodata + RODATA_OFF;
+
+  /* Compile like the program cache does (starting from a region that
+     is too small) */
+
+  ulong const * jit_calldests_ = jit_calldests ? calldests : NULL;
+  ulong sz = 256UL;
+  for(;;) {
+    ulong req = fd_vm_jit_compile( blob, sz, text, text_cnt, 8UL*RODATA_OFF, entry_pc, jit_calldests_ );
+    FD_TEST( req && req<=sizeof(blob) );
+    if( req<=sz ) { sz = req; break; }
+    sz = req;
+  }
+  FD_TEST( fd_vm_jit_compile( blob, sz, text, text_cnt, 8UL*RODATA_OFF, entry_pc, jit_calldests_ )==sz );
+
+  ulong reg_init[ 10 ];
+  for( ulong i=0UL; i<10UL; i++ ) reg_init[ i ] = fd_rng_uint_roll( rng, 4U ) ? fd_rng_ulong( rng ) : fd_rng_ulong_roll( rng, 64UL );
+
+  ulong cu;
+  switch( fd_rng_uint_roll( rng, 4U ) ) {
+  case 0:  cu = fd_rng_ulong_roll( rng, 64UL   ); break;
+  case 1:  cu = fd_rng_ulong_roll( rng, 1024UL ); break;
+  default: cu = 20000UL;                          break;
+  }
+  int check_align = (int)fd_rng_uint_roll( rng, 2U );
+
+  for( ulong i=0UL; i<INPUT_SZ; i++ ) input[0][ i ] = input[1][ i ] = input[2][ i ] = input[3][ i ] = fd_rng_uchar( rng );
+
+  FD_TEST( fd_vm_seg_cost( seg_cost, text, text_cnt )==seg_cost );
+  FD_TEST( fd_vm_predecode( predecoded, text, text_cnt, entry_pc, calldests )==predecoded );
+
+  vm_setup( vms+0, input[0], text, text_cnt, entry_pc, calldests, cu, check_align, reg_init );
+  vm_setup( vms+1, input[1], text, text_cnt, entry_pc, calldests, cu, check_align, reg_init );
+  vm_setup( vms+2, input[2], text, text_cnt, entry_pc, calldests, cu, check_align, reg_init );
+  vm_setup( vms+3, input[3], text, text_cnt, entry_pc, calldests, cu, check_align, reg_init );
+  switch( fd_rng_uint_roll( rng, 3U ) ) { /* Deopts resume with the table / predecoded text */
+  case 0:  break;
+  case 1:  fd_vm_seg_cost_set( vms+1, seg_cost ); break;
+  default: fd_vm_seg_cost_set( vms+1, seg_cost ); fd_vm_predecode_set( vms+1, predecoded ); break;
+  }
+  fd_vm_seg_cost_set ( vms+2, seg_cost   );
+  fd_vm_seg_cost_set ( vms+3, seg_cost   );
+  fd_vm_predecode_set( vms+3, predecoded );
+
+  int ref_err = fd_vm_exec_notrace( vms+0 );
+  int jit_err = fd_vm_exec_jit( vms+1, blob );
+  int seg_err = fd_vm_exec_notrace( vms+2 );
+  int pre_err = fd_vm_exec_notrace( vms+3 );
+  vm_check( vms+0, ref_err, vms+1, jit_err );
+  vm_check( vms+0, ref_err, vms+2, seg_err );
+  vm_check( vms+0, ref_err, vms+3, pre_err );
+}
+
+static void
+test_random( fd_rng_t * rng,
+             ulong      iter_cnt ) {
+  ulong * calldests = fd_sbpf_calldests_join( fd_sbpf_calldests_new( calldests_mem, TEXT_MAX ) );
+  FD_TEST( calldests );
+
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) {
+    fd_sbpf_calldests_null( calldests );
+    ulong text_cnt = 2UL + fd_rng_ulong_roll( rng, fd_rng_uint_roll( rng, 2U ) ? 64UL : TEXT_MAX-2UL );
+    text_cnt = gen_program( rng, rodata + RODATA_OFF, text_cnt, calldests );
+    ulong entry_pc = fd_rng_uint_roll( rng, 4U ) ? 0UL : fd_rng_ulong_roll( rng, text_cnt );
+    test_diff( rng, text_cnt, entry_pc, calldests, (int)fd_rng_uint_roll( rng, 4U ) );
+  }
+
+  fd_sbpf_calldests_delete( fd_sbpf_calldests_leave( calldests ) );
+}
+
+static void
+test_bench( fd_rng_t * rng ) {
+  /* A loop over an alu and stack memory heavy body */
+  ulong * text = rodata + RODATA_OFF;
+  ulong   pc   = 0UL;
+  text[ pc++ ] = fd_vm_instr( 0xb7, 9, 0, 0, 0U ); /* mov64 r9, 0 */
+  ulong top = pc;
+  for( ulong i=0UL; i<32UL; i++ ) {
+    ulong d = 1UL + (i % 8UL);
+    text[ pc++ ] = fd_vm_instr( 0x0f, d, 1UL + ((i+3UL) % 8UL), 0, 0U );
+    text[ pc++ ] = fd_vm_instr( 0x27, d, 0, 0, fd_rng_uint( rng ) | 1U );
+    text[ pc++ ] = fd_vm_instr( 0x7b, 10, d, (short)(-8*(int)(1UL+(i%16UL))), 0U );
+    text[ pc++ ] = fd_vm_instr( 0x79, d, 10, (short)(-8*(int)(1UL+((i+5UL)%16UL))), 0U );
+  }
+  text[ pc++ ] = fd_vm_instr( 0x07, 9, 0, 0, 1U );
+  text[ pc   ] = fd_vm_instr( 0xa5, 9, 0, (short)((long)top-(long)pc-1L), 10000U ); pc++; /* jlt r9, 10000, top */
+  text[ pc++ ] = fd_vm_instr( 0xbf, 0, 1, 0, 0U );
+  text[ pc++ ] = fd_vm_instr( 0x95, 0, 0, 0, 0U );
+
+  ulong sz = fd_vm_jit_compile( blob, sizeof(blob), text, pc, 8UL*RODATA_OFF, 0UL, NULL );
+  FD_TEST( sz && sz<=sizeof(blob) );
+
+  FD_TEST( fd_vm_seg_cost( seg_cost, text, pc )==seg_cost );
+  FD_TEST( fd_vm_predecode( predecoded, text, pc, 0UL, NULL )==predecoded );
+
+  ulong reg_init[ 10 ] = {0};
+  vm_setup( vms+0, input[0], text, pc, 0UL, NULL, 1UL<<32, 0, reg_init );
+  vm_setup( vms+1, input[1], text, pc, 0UL, NULL, 1UL<<32, 0, reg_init );
+  vm_setup( vms+2, input[2], text, pc, 0UL, NULL, 1UL<<32, 0, reg_init );
+  vm_setup( vms+3, input[3], text, pc, 0UL, NULL, 1UL<<32, 0, reg_init );
+  fd_vm_seg_cost_set ( vms+2, seg_cost   );
+  fd_vm_seg_cost_set ( vms+3, seg_cost   );
+  fd_vm_predecode_set( vms+3, predecoded );
+
+  long dt0 = -fd_log_wallclock(); int err0 = fd_vm_exec_notrace( vms+0 );    dt0 += fd_log_wallclock();
+  long dt1 = -fd_log_wallclock(); int err1 = fd_vm_exec_jit( vms+1, blob ); dt1 += fd_log_wallclock();
+  long dt2 = -fd_log_wallclock(); int err2 = fd_vm_exec_notrace( vms+2 );    dt2 += fd_log_wallclock();
+  long dt3 = -fd_log_wallclock(); int err3 = fd_vm_exec_notrace( vms+3 );    dt3 += fd_log_wallclock();
+  vm_check( vms+0, err0, vms+1, err1 );
+  vm_check( vms+0, err0, vms+2, err2 );
+  vm_check( vms+0, err0, vms+3, err3 );
+  FD_TEST( !err0 );
+  FD_LOG_NOTICE(( "bench: %lu instr, interp %.3f ns/instr, interp with seg cost %.3f ns/instr, predecoded %.3f ns/instr, jit %.3f ns/instr",
+                  vms[0].ic, (double)dt0/(double)vms[0].ic, (double)dt2/(double)vms[2].ic, (double)dt3/(double)vms[3].ic,
+                  (double)dt1/(double)vms[1].ic ));
+}
+
+static void
+test_misc( void ) {
+  ulong const * text = nest_text;
+
+  /* Bad args / unsupported programs */
+
+  FD_TEST( !fd_vm_jit_compile( NULL,      sizeof(blob), text, 4UL, 0UL, 0UL, NULL ) );
+  FD_TEST( !fd_vm_jit_compile( blob+1UL,  sizeof(blob), text, 4UL, 0UL, 0UL, NULL ) );
+  FD_TEST( !fd_vm_jit_compile( blob,      sizeof(blob), NULL, 4UL, 0UL, 0UL, NULL ) );
+  FD_TEST( !fd_vm_jit_compile( blob,      sizeof(blob), text, 0UL, 0UL, 0UL, NULL ) );
+  FD_TEST( !fd_vm_jit_compile( blob,      sizeof(blob), text, FD_VM_JIT_TEXT_MAX+1UL, 0UL, 0UL, NULL ) );
+  FD_TEST( fd_vm_jit_compile( blob, 0UL, text, 4UL, 0UL, 0UL, NULL )==fd_vm_jit_footprint_est( 4UL ) );
+
+  ulong bad[2] = { fd_vm_instr( 0xb7, 11, 0, 0, 0U ), fd_vm_instr( 0x95, 0, 0, 0, 0U ) };
+  FD_TEST( !fd_vm_jit_compile( blob, sizeof(blob), bad, 2UL, 0UL, 0UL, NULL ) );
+  bad[0] = fd_vm_instr( 0x37, 1, 0, 0, 0U );
+  FD_TEST( !fd_vm_jit_compile( blob, sizeof(blob), bad, 2UL, 0UL, 0UL, NULL ) );
+
+  /* Compilation is deterministic */
+
+  ulong sz = fd_vm_jit_compile( blob, sizeof(blob), text, 4UL, 0UL, 0UL, NULL );
+  FD_TEST( sz && sz<=sizeof(nest_blob) );
+  FD_TEST( !memcmp( blob, nest_blob, sz ) );
+
+  FD_TEST( fd_vm_exec_jit( NULL, blob )==FD_VM_ERR_INVAL );
+
+  /* Blobs for a different program or no blob run on the interpreter */
+
+  ulong reg_init[ 10 ] = {0};
+  memcpy( rodata + RODATA_OFF, nest_text, sizeof(nest_text) );
+  vm_setup( vms+0, input[0], rodata + RODATA_OFF, 4UL, 0UL, NULL, 100UL, 0, reg_init );
+  FD_TEST( !fd_vm_exec_jit( vms+0, NULL ) ); FD_TEST( vms[0].reg[0]==7UL );
+  vm_setup( vms+0, input[0], rodata + RODATA_OFF, 4UL, 0UL, NULL, 100UL, 0, reg_init );
+  FD_TEST( !fd_vm_exec_jit( vms+0, nest_blob ) ); FD_TEST( vms[0].reg[0]==7UL ); /* text_off mismatch */
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong iter_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--iter-cnt", NULL, 4096UL );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  for( ulong i=0UL; i<5UL; i++ ) FD_TEST( fd_vm_join( fd_vm_new( vms+i ) ) );
+  FD_TEST( fd_sha256_join( fd_sha256_new( _sha ) ) );
+  instr_ctx = test_vm_minimal_exec_instr_ctx( fd_libc_alloc_virtual(), false );
+
+  fd_sbpf_syscalls_t * syscalls = fd_sbpf_syscalls_join( fd_sbpf_syscalls_new( _syscalls ) ); FD_TEST( syscalls );
+  FD_TEST( !fd_vm_syscall_register( syscalls, "accumulator", syscall_accumulator ) );
+  FD_TEST( !fd_vm_syscall_register( syscalls, "consume",     syscall_consume     ) );
+  FD_TEST( !fd_vm_syscall_register( syscalls, "fail",        syscall_fail        ) );
+  FD_TEST( !fd_vm_syscall_register( syscalls, "nest",        syscall_nest        ) );
+  imm_accumulator = fd_murmur3_32( "accumulator", 11UL, 0U );
+  imm_consume     = fd_murmur3_32( "consume",      7UL, 0U );
+  imm_fail        = fd_murmur3_32( "fail",         4UL, 0U );
+  imm_nest        = fd_murmur3_32( "nest",         4UL, 0U );
+
+  FD_TEST( fd_vm_jit_compile( nest_blob, sizeof(nest_blob), nest_text, 4UL, 0UL, 0UL, NULL ) );
+
+  /* A small cache such that it gets flushed regularly */
+
+  void * cache = fd_vm_jit_cache_new( 1UL<<20 ); FD_TEST( cache );
+  FD_TEST( !fd_vm_jit_cache_detach() );
+  FD_TEST( !fd_vm_jit_cache_query()  );
+  fd_vm_jit_cache_attach( cache );
+  FD_TEST( fd_vm_jit_cache_query()==cache );
+
+  test_misc();
+  test_random( rng, iter_cnt );
+  test_bench( rng );
+
+  FD_TEST( fd_vm_jit_cache_detach()==cache );
+  fd_vm_jit_cache_delete( cache );
+
+  fd_sbpf_syscalls_delete( fd_sbpf_syscalls_leave( syscalls ) );
+  test_vm_exec_instr_ctx_delete( instr_ctx );
+  fd_sha256_delete( fd_sha256_leave( _sha ) );
+  for( ulong i=0UL; i<5UL; i++ ) fd_vm_delete( fd_vm_leave( vms+i ) );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_X86" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -22,3 +22,5 @@ $(call run-unit-test,test_funk)
 ifdef FD_HAS_HOSTED
 $(call make-unit-test,test_funk_concur,test_funk_concur,fd_funk fd_util)
 endif
+$(call make-unit-test,test_funk_rec_concur,test_funk_rec_concur,fd_funk fd_util)
+$(call run-unit-test,test_funk_rec_concur)
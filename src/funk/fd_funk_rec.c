@@ -395,6 +395,154 @@ fd_funk_rec_insert( fd_funk_t *               funk,
   return rec;
 }
 
+fd_funk_rec_t const *
+fd_funk_rec_insert_concur( fd_funk_t *               funk,
+                           fd_funk_txn_t *           txn,
+                           fd_funk_rec_key_t const * key,
+                           int *                     opt_err ) {
+
+  if( FD_UNLIKELY( (!funk) |     /* NULL funk */
+                   (!key ) ) ) { /* NULL key */
+    fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_INVAL );
+    return NULL;
+  }
+  fd_funk_check_write( funk );
+
+  fd_wksp_t * wksp = fd_funk_wksp( funk );
+
+  fd_funk_rec_t * rec_map = fd_funk_rec_map( funk, wksp );
+
+  ulong rec_max = funk->rec_max;
+
+  ulong                  txn_idx;
+  ulong *                _rec_head_idx;
+  ulong *                _rec_tail_idx;
+  fd_funk_xid_key_pair_t pair[1];
+
+  if( !txn ) { /* Modifying last published */
+
+    if( FD_UNLIKELY( fd_funk_last_publish_is_frozen( funk ) ) ) {
+      fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_FROZEN );
+      return NULL;
+    }
+
+    txn_idx       = FD_FUNK_TXN_IDX_NULL;
+    _rec_head_idx = &funk->rec_head_idx;
+    _rec_tail_idx = &funk->rec_tail_idx;
+
+    fd_funk_xid_key_pair_init( pair, fd_funk_root( funk ), key );
+
+  } else { /* Modifying in-prep */
+
+    fd_funk_txn_t * txn_map = fd_funk_txn_map( funk, wksp );
+
+    ulong txn_max = funk->txn_max;
+
+    txn_idx       = (ulong)(txn - txn_map);
+    _rec_head_idx = &txn->rec_head_idx;
+    _rec_tail_idx = &txn->rec_tail_idx;
+
+    if( FD_UNLIKELY( (txn_idx>=txn_max) /* Out of map (incl NULL) */ | (txn!=(txn_map+txn_idx)) /* Bad alignment */ ) ) {
+      fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_INVAL );
+      return NULL;
+    }
+
+    if( FD_UNLIKELY( !fd_funk_txn_map_query_const( txn_map, fd_funk_txn_xid( txn ), NULL ) ) ) {
+      fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_INVAL );
+      return NULL;
+    }
+
+    if( FD_UNLIKELY( fd_funk_txn_is_frozen( txn ) ) ) {
+      fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_FROZEN );
+      return NULL;
+    }
+
+    fd_funk_xid_key_pair_init( pair, fd_funk_txn_xid( txn ), key );
+
+  }
+
+  /* Keys are disjoint between concurrent callers so nobody else can
+     insert or modify the flags of this key under our feet.  Note that
+     the map chain can still be concurrently pushed to (query_const is
+     safe against this). */
+
+  fd_funk_rec_t * rec = (fd_funk_rec_t *)fd_funk_rec_map_query_const( rec_map, pair, NULL );
+  if( FD_UNLIKELY( rec ) ) { /* Already a record present, see fd_funk_rec_insert */
+    if( FD_UNLIKELY( txn && (rec->flags & FD_FUNK_REC_FLAG_ERASE) ) ) {
+      rec->flags &= ~FD_FUNK_REC_FLAG_ERASE;
+      return rec;
+    }
+    if( FD_UNLIKELY( rec->flags & FD_FUNK_REC_FLAG_ERASE ) ) FD_LOG_CRIT(( "memory corruption detected (bad flags)" ));
+    fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_KEY );
+    return NULL;
+  }
+
+  /* Reserve a map element.  Reserving first guarantees the free stack
+     has an element for us below. */
+
+  fd_funk_rec_map_private_t * map = fd_funk_rec_map_private( rec_map );
+
+  if( FD_UNLIKELY( FD_ATOMIC_FETCH_AND_ADD( &map->key_cnt, 1UL )>=map->key_max ) ) {
+    FD_ATOMIC_FETCH_AND_SUB( &map->key_cnt, 1UL );
+    fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_REC );
+    return NULL;
+  }
+
+  /* Pop the free stack.  As nothing is pushed onto the free stack
+     during a concurrent section (no removes), a successful CAS means
+     nobody else popped this element (no ABA). */
+
+  ulong rec_idx;
+  for(;;) {
+    ulong top = FD_VOLATILE_CONST( map->free_stack );
+    rec_idx   = fd_funk_rec_map_private_unbox_idx( top );
+    if( FD_UNLIKELY( rec_idx>=rec_max ) ) FD_LOG_CRIT(( "memory corruption detected (bad idx)" ));
+    ulong next = FD_VOLATILE_CONST( rec_map[ rec_idx ].map_next );
+    if( FD_LIKELY( FD_ATOMIC_CAS( &map->free_stack, top, next )==top ) ) break;
+    FD_SPIN_PAUSE();
+  }
+  rec = rec_map + rec_idx;
+
+  /* Initialize the record and publish it onto its map chain */
+
+  ulong hash = fd_funk_xid_key_pair_hash( pair, map->seed );
+  fd_funk_xid_key_pair_copy( &rec->pair, pair );
+  rec->map_hash = hash;
+  rec->next_idx = FD_FUNK_REC_IDX_NULL;
+  rec->txn_cidx = fd_funk_txn_cidx( txn_idx );
+  rec->tag      = 0U;
+  rec->flags    = 0UL;
+  fd_funk_val_init( rec );
+  fd_funk_part_init( rec );
+
+  ulong * head = fd_funk_rec_map_private_list( map ) + ( hash & (map->list_cnt-1UL) );
+  for(;;) {
+    ulong old = FD_VOLATILE_CONST( *head );
+    rec->map_next = fd_funk_rec_map_private_box_next( fd_funk_rec_map_private_unbox_idx( old ), 0 );
+    FD_COMPILER_MFENCE();
+    if( FD_LIKELY( FD_ATOMIC_CAS( head, old, fd_funk_rec_map_private_box_next( rec_idx, 0 ) )==old ) ) break;
+    FD_SPIN_PAUSE();
+  }
+
+  /* Append to the transaction's record list.  Exchanging the tail makes
+     us the unique successor of the previous tail.  Since our next_idx
+     was initialized before the exchange, a racing append after us can
+     safely link itself in. */
+
+  FD_COMPILER_MFENCE();
+  ulong rec_prev_idx = FD_ATOMIC_XCHG( _rec_tail_idx, rec_idx );
+  rec->prev_idx = rec_prev_idx;
+
+  if( fd_funk_rec_idx_is_null( rec_prev_idx ) ) *_rec_head_idx = rec_idx;
+  else {
+    if( FD_UNLIKELY( rec_prev_idx>=rec_max ) ) FD_LOG_CRIT(( "memory corruption detected (bad_idx)" ));
+    rec_map[ rec_prev_idx ].next_idx = rec_idx;
+  }
+
+  fd_int_store_if( !!opt_err, opt_err, FD_FUNK_SUCCESS );
+  return rec;
+}
+
 int
 fd_funk_rec_remove( fd_funk_t *     funk,
                     fd_funk_rec_t * rec,
@@ -575,17 +723,21 @@ fd_funk_rec_remove( fd_funk_t *     funk,
   return FD_FUNK_SUCCESS;
 }
 
-fd_funk_rec_t *
-fd_funk_rec_write_prepare( fd_funk_t *               funk,
-                           fd_funk_txn_t *           txn,
-                           fd_funk_rec_key_t const * key,
-                           ulong                     min_val_size,
-                           int                       do_create,
-                           fd_funk_rec_t const     * irec,
-                           int *                     opt_err ) {
+static fd_funk_rec_t *
+fd_funk_rec_write_prepare_private( fd_funk_t *               funk,
+                                   fd_funk_txn_t *           txn,
+                                   fd_funk_rec_key_t const * key,
+                                   ulong                     min_val_size,
+                                   int                       do_create,
+                                   fd_funk_rec_t const     * irec,
+                                   int *                     opt_err,
+                                   int                       concur ) {
 
   fd_wksp_t * wksp = fd_funk_wksp( funk );
 
+  fd_funk_rec_t const * (*insert)( fd_funk_t *, fd_funk_txn_t *, fd_funk_rec_key_t const *, int * ) =
+    concur ? fd_funk_rec_insert_concur : fd_funk_rec_insert;
+
   fd_funk_rec_t * rec = NULL;
   fd_funk_rec_t const * rec_con = NULL;
   if ( FD_LIKELY (NULL == irec ) )
@@ -605,7 +757,7 @@ fd_funk_rec_write_prepare( fd_funk_t *               funk,
 
     } else {
       /* Copy the record into the transaction */
-      rec = fd_funk_rec_modify( funk, fd_funk_rec_insert( funk, txn, key, opt_err ) );
+      rec = fd_funk_rec_modify( funk, insert( funk, txn, key, opt_err ) );
       if ( !rec )
         return NULL;
       rec = fd_funk_val_copy( rec, fd_funk_val_const(rec_con, wksp), fd_funk_val_sz(rec_con),
@@ -622,7 +774,7 @@ fd_funk_rec_write_prepare( fd_funk_t *               funk,
     }
 
     /* Create a new record */
-    rec = fd_funk_rec_modify( funk, fd_funk_rec_insert( funk, txn, key, opt_err ) );
+    rec = fd_funk_rec_modify( funk, insert( funk, txn, key, opt_err ) );
     if ( !rec )
       return NULL;
   }
@@ -639,6 +791,32 @@ fd_funk_rec_write_prepare( fd_funk_t *               funk,
   return rec;
 }
 
+fd_funk_rec_t *
+fd_funk_rec_write_prepare( fd_funk_t *               funk,
+                           fd_funk_txn_t *           txn,
+                           fd_funk_rec_key_t const * key,
+                           ulong                     min_val_size,
+                           int                       do_create,
+                           fd_funk_rec_t const     * irec,
+                           int *                     opt_err ) {
+  return fd_funk_rec_write_prepare_private( funk, txn, key, min_val_size, do_create, irec, opt_err, 0 );
+}
+
+fd_funk_rec_t *
+fd_funk_rec_write_prepare_concur( fd_funk_t *               funk,
+                                  fd_funk_txn_t *           txn,
+                                  fd_funk_rec_key_t const * key,
+                                  ulong                     min_val_size,
+                                  int                       do_create,
+                                  fd_funk_rec_t const     * irec,
+                                  int *                     opt_err ) {
+  if( FD_UNLIKELY( funk->speed_load ) ) {
+    fd_int_store_if( !!opt_err, opt_err, FD_FUNK_ERR_INVAL );
+    return NULL;
+  }
+  return fd_funk_rec_write_prepare_private( funk, txn, key, min_val_size, do_create, irec, opt_err, 1 );
+}
+
 int
 fd_funk_rec_verify( fd_funk_t * funk ) {
   fd_wksp_t *     wksp    = fd_funk_wksp( funk );          /* Previously verified */
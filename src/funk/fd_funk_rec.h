@@ -399,6 +399,35 @@ fd_funk_rec_insert( fd_funk_t *               funk,
                     fd_funk_rec_key_t const * key,
                     int *                     opt_err );
 
+/* fd_funk_rec_insert_concur is the same as fd_funk_rec_insert but can
+   be called by multiple threads at the same time.  This allows, for
+   example, the accounts modified by a block to be committed to its
+   in-preparation transaction by several threads in parallel.  Inserts
+   are lockfree: the record map free stack is popped and the record is
+   pushed onto its map chain with atomic compare-and-swaps and the
+   record is appended to its transaction's record list with an atomic
+   exchange.
+
+   In addition to the requirements of fd_funk_rec_insert, assumes a
+   single fd_funk_start_write / fd_funk_end_write pair brackets the
+   whole concurrent section, the only concurrent operations on funk are
+   fd_funk_rec_insert_concur, fd_funk_rec_write_prepare_concur, queries,
+   fd_funk_rec_modify and value operations on the returned records, and
+   concurrent callers use disjoint keys.  In particular, nothing is
+   removed from the record map and no transaction is prepared,
+   published or cancelled during the concurrent section.  Records
+   inserted concurrently are appended to the transaction's record list
+   in no particular order.
+
+   This is a fast O(1) (with a larger constant under heavy contention
+   on the same map chain or transaction). */
+
+fd_funk_rec_t const *
+fd_funk_rec_insert_concur( fd_funk_t *               funk,
+                           fd_funk_txn_t *           txn,
+                           fd_funk_rec_key_t const * key,
+                           int *                     opt_err );
+
 /* fd_funk_rec_remove removes the live record pointed to by rec from
    the funk.  Returns FD_FUNK_SUCCESS (0) on success and a FD_FUNK_ERR_*
    (negative) on failure.  Reasons for failure include:
@@ -503,6 +532,22 @@ fd_funk_rec_write_prepare( fd_funk_t *               funk,         /* Funky data
                            fd_funk_rec_t const *     irec,         /* Prior result of fd_funk_rec_query_global if known */
                            int *                     opt_err );    /* Optional error code return */
 
+/* fd_funk_rec_write_prepare_concur is the same as
+   fd_funk_rec_write_prepare but inserts with fd_funk_rec_insert_concur
+   and thus has the same concurrency model.  Record values are allocated
+   from the funk's fd_alloc, which is safe to use concurrently.  Fails
+   with FD_FUNK_ERR_INVAL if funk is in speed load mode (the speed load
+   bump allocator is not thread safe). */
+
+fd_funk_rec_t *
+fd_funk_rec_write_prepare_concur( fd_funk_t *               funk,
+                                  fd_funk_txn_t *           txn,
+                                  fd_funk_rec_key_t const * key,
+                                  ulong                     min_val_size,
+                                  int                       do_create,
+                                  fd_funk_rec_t const *     irec,
+                                  int *                     opt_err );
+
 /* Misc */
 
 /* fd_funk_rec_verify verifies the record map.  Returns FD_FUNK_SUCCESS
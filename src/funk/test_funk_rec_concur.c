@@ -0,0 +1,178 @@
+#include "fd_funk.h"
+
+#if FD_HAS_HOSTED
+
+/* Concurrent insert test: every tile inserts a disjoint range of keys
+   into the same transaction (first an in-prep transaction, then the
+   last published transaction) while the caller holds the funk write
+   lock. */
+
+static fd_funk_t *     test_funk;
+static fd_funk_txn_t * test_txn;
+static ulong           test_key_cnt;
+static ulong           test_val_sz;
+static ulong           test_phase;
+
+static void
+test_key( fd_funk_rec_key_t * key,
+          ulong               tile_idx,
+          ulong               i,
+          ulong               phase ) {
+  memset( key, 0, sizeof(fd_funk_rec_key_t) );
+  key->ul[0] = tile_idx;
+  key->ul[1] = i;
+  key->ul[2] = phase;
+}
+
+static int
+tile_main( int     argc,
+           char ** argv ) {
+  (void)argc; (void)argv;
+
+  fd_funk_t *     funk     = test_funk;
+  fd_funk_txn_t * txn      = test_txn;
+  ulong           tile_idx = fd_tile_idx();
+  fd_wksp_t *     wksp     = fd_funk_wksp( funk );
+
+  for( ulong i=0UL; i<test_key_cnt; i++ ) {
+    fd_funk_rec_key_t key[1]; test_key( key, tile_idx, i, test_phase );
+    int err;
+    if( i & 1UL ) {
+      fd_funk_rec_t * rec = fd_funk_rec_write_prepare_concur( funk, txn, key, test_val_sz, 1, NULL, &err );
+      FD_TEST( rec && !err );
+      FD_TEST( fd_funk_val_sz( rec )==test_val_sz );
+      *(ulong *)fd_funk_val( rec, wksp ) = i;
+    } else {
+      fd_funk_rec_t const * rec = fd_funk_rec_insert_concur( funk, txn, key, &err );
+      FD_TEST( rec && !err );
+      FD_TEST( !fd_funk_rec_insert_concur( funk, txn, key, &err ) && err==FD_FUNK_ERR_KEY );
+    }
+  }
+
+  return 0;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * name     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--wksp",      NULL,            NULL );
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",   NULL,      "gigantic" );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt",  NULL,             1UL );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu",  NULL, fd_log_cpu_id() );
+  ulong        wksp_tag = fd_env_strip_cmdline_ulong( &argc, &argv, "--wksp-tag",  NULL,          1234UL );
+  ulong        seed     = fd_env_strip_cmdline_ulong( &argc, &argv, "--seed",      NULL,          5678UL );
+  ulong        txn_max  = fd_env_strip_cmdline_ulong( &argc, &argv, "--txn-max",   NULL,            32UL );
+  ulong        rec_max  = fd_env_strip_cmdline_ulong( &argc, &argv, "--rec-max",   NULL,        262144UL );
+  ulong        key_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--key-cnt",   NULL,          4096UL );
+  ulong        val_sz   = fd_env_strip_cmdline_ulong( &argc, &argv, "--val-sz",    NULL,            64UL );
+
+  ulong tile_cnt = fd_tile_cnt();
+
+  fd_wksp_t * wksp;
+  if( name ) {
+    FD_LOG_NOTICE(( "Attaching to --wksp %s", name ));
+    wksp = fd_wksp_attach( name );
+  } else {
+    FD_LOG_NOTICE(( "--wksp not specified, using an anonymous local workspace, --page-sz %s, --page-cnt %lu, --near-cpu %lu",
+                    _page_sz, page_cnt, near_cpu ));
+    wksp = fd_wksp_new_anonymous( fd_cstr_to_shmem_page_sz( _page_sz ), page_cnt, near_cpu, "wksp", 0UL );
+  }
+
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "Unable to attach to wksp" ));
+
+  if( FD_UNLIKELY( 2UL*tile_cnt*key_cnt>rec_max ) ) {
+    FD_LOG_WARNING(( "skip: increase --rec-max or reduce --key-cnt to run this test" ));
+    if( name ) fd_wksp_detach( wksp ); else fd_wksp_delete_anonymous( wksp );
+    fd_halt();
+    return 0;
+  }
+
+  FD_LOG_NOTICE(( "Testing with --wksp-tag %lu --seed %lu --txn-max %lu --rec-max %lu --key-cnt %lu --val-sz %lu (%lu tiles)",
+                  wksp_tag, seed, txn_max, rec_max, key_cnt, val_sz, tile_cnt ));
+
+  fd_funk_t * funk = fd_funk_join( fd_funk_new( fd_wksp_alloc_laddr( wksp, fd_funk_align(), fd_funk_footprint(), wksp_tag ),
+                                                wksp_tag, seed, txn_max, rec_max ) );
+  if( FD_UNLIKELY( !funk ) ) FD_LOG_ERR(( "Unable to create funk" ));
+
+  fd_funk_txn_xid_t xid[1]; fd_funk_txn_xid_set_root( xid ); xid->ul[0] = 1UL;
+  fd_funk_start_write( funk );
+  fd_funk_txn_t * txn = fd_funk_txn_prepare( funk, NULL, xid, 0 );
+  fd_funk_end_write( funk );
+  FD_TEST( txn );
+
+  test_funk    = funk;
+  test_key_cnt = key_cnt;
+  test_val_sz  = val_sz;
+
+  for( ulong phase=0UL; phase<2UL; phase++ ) {
+    test_txn   = phase ? NULL : txn;
+    test_phase = phase;
+
+    fd_funk_start_write( funk );
+
+    long dt = -fd_log_wallclock();
+
+    fd_tile_exec_t * exec[ FD_TILE_MAX ];
+    for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) {
+      exec[ tile_idx ] = fd_tile_exec_new( tile_idx, tile_main, 0, NULL );
+      FD_TEST( exec[ tile_idx ] );
+    }
+    tile_main( 0, NULL );
+    for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) FD_TEST( !fd_tile_exec_delete( exec[ tile_idx ], NULL ) );
+
+    dt += fd_log_wallclock();
+
+    fd_funk_end_write( funk );
+
+    ulong ins_cnt = tile_cnt*key_cnt;
+    FD_LOG_NOTICE(( "phase %lu: %lu concurrent inserts in %.3f ms (%.3f Minsert/s)",
+                    phase, ins_cnt, 1e-6*(double)dt, 1e3*(double)ins_cnt/(double)dt ));
+
+    FD_TEST( fd_funk_rec_cnt( fd_funk_rec_map( funk, wksp ) )==(phase+1UL)*ins_cnt );
+    FD_TEST( !fd_funk_verify( funk ) );
+
+    for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ ) {
+      for( ulong i=0UL; i<key_cnt; i++ ) {
+        fd_funk_rec_key_t key[1]; test_key( key, tile_idx, i, phase );
+        fd_funk_rec_t const * rec = fd_funk_rec_query( funk, test_txn, key );
+        FD_TEST( rec );
+        if( i & 1UL ) {
+          FD_TEST( fd_funk_val_sz( rec )==val_sz );
+          FD_TEST( *(ulong const *)fd_funk_val_const( rec, wksp )==i );
+        } else {
+          FD_TEST( !fd_funk_val_sz( rec ) );
+        }
+      }
+    }
+
+    if( !phase ) {
+      fd_funk_start_write( funk );
+      FD_TEST( fd_funk_txn_publish( funk, txn, 0 )==1UL );
+      FD_TEST( !fd_funk_verify( funk ) );
+      fd_funk_end_write( funk );
+    }
+  }
+
+  fd_wksp_free_laddr( fd_funk_delete( fd_funk_leave( funk ) ) );
+  if( name ) fd_wksp_detach( wksp );
+  else       fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -116,8 +116,9 @@ typedef int
    success and non-zero if tar reader should stop.
 
    cb_arg is the callback context value.  buf points to the first byte
-   of the chunk.  bufsz is the byte count.  The lifetime of buf is until
-   the callback returns. */
+   of the chunk.  bufsz is the byte count.  buf points into the data
+   buffer passed to fd_tar_read, so buf is valid as long as that data
+   buffer is (at least until the callback returns). */
 
 typedef int
 (* fd_tar_read_fn_t)( void *       cb_arg,
@@ -145,16 +145,42 @@
            by the used workspace partitions.  No compression or
            hashing is done of the workspace partitions.
 
+     FRAME - the stream will have the same metadata as RAW followed by
+           the used workspace data, split at FD_WKSP_CHECKPT_FRAME_SZ
+           boundaries of the data region into independent fd_checkpt
+           frames (LZ4 compressed on targets with FD_HAS_LZ4) and an
+           index of the frames.  Frames can be written and restored in
+           parallel (see fd_wksp_checkpt_tpool) and each frame is
+           hashed such that an incremental checkpt only needs to write
+           the frames that changed since a base checkpt.
+
      DEFAULT - the style to use when not specified by user. */
 
 #define FD_WKSP_CHECKPT_STYLE_RAW     (1)
+#define FD_WKSP_CHECKPT_STYLE_FRAME   (2)
 #define FD_WKSP_CHECKPT_STYLE_DEFAULT FD_WKSP_CHECKPT_STYLE_RAW
 
+/* FD_WKSP_CHECKPT_FRAME_SZ is the byte size of the windows of the wksp
+   data region covered by a FRAME style checkpt frame.  This is the
+   granularity of parallelism and of change detection for incremental
+   checkpts.  FD_WKSP_CHECKPT_BASE_MAX is the max number of checkpts an
+   incremental checkpt can depend on (frames that would exceed this
+   depth are written again). */
+
+#define FD_WKSP_CHECKPT_FRAME_SZ (1UL<<20)
+#define FD_WKSP_CHECKPT_BASE_MAX (16UL)
+
 /* A fd_wksp_t * is an opaque handle of a workspace */
 
 struct fd_wksp_private;
 typedef struct fd_wksp_private fd_wksp_t;
 
+/* Forward declaration of fd_tpool_t for the parallel io APIs (see
+   tpool/fd_tpool.h) */
+
+struct fd_tpool_private;
+typedef struct fd_tpool_private fd_tpool_t;
+
 /* A fd_wksp_usage_t is used to return workspace usage stats. */
 
 struct fd_wksp_usage {
@@ -987,6 +1013,36 @@ fd_wksp_checkpt( fd_wksp_t *  wksp,
                  int          style,
                  char const * uinfo );
 
+/* fd_wksp_checkpt_tpool is fd_wksp_checkpt using tpool threads
+   [t0,t1) to build the checkpt.  The caller is assumed to be thread t0
+   and threads (t0,t1) are assumed to be idle (tpool NULL with t1==t0+1
+   is fine and is what fd_wksp_checkpt does).  Only FRAME style checkpts
+   are built in parallel, other styles are written by the caller.
+
+   If base is non-NULL, the checkpt will be incremental.  base is the
+   path to a FRAME style checkpt previously made of this wksp (full or
+   incremental) and frames whose allocations and data are unchanged
+   since base will not be written again but referenced from base (or
+   from the checkpts base depends on).  Restoring an incremental checkpt
+   requires all these checkpts to still exist, unmodified, at the
+   canonical paths (as given by realpath) they had when they were made.
+   base must be NULL for other styles.
+
+   IMPORTANT!  The data of the wksp allocations should not be modified
+   while a checkpt is in progress (as is the case for fd_wksp_checkpt,
+   only the wksp metadata is protected by the wksp lock). */
+
+int
+fd_wksp_checkpt_tpool( fd_tpool_t * tpool,
+                       ulong        t0,
+                       ulong        t1,
+                       fd_wksp_t *  wksp,
+                       char const * path,
+                       ulong        mode,
+                       int          style,
+                       char const * uinfo,
+                       char const * base );
+
 /* fd_wksp_restore will replace all allocations in the current workspace
    with the allocations from the checkpt at path.  The restored
    workspace will use the given seed.
@@ -1014,6 +1070,18 @@ fd_wksp_restore( fd_wksp_t *  wksp,
                  char const * path,
                  uint         seed );
 
+/* fd_wksp_restore_tpool is fd_wksp_restore using tpool threads [t0,t1)
+   to restore FRAME style checkpts.  Same thread assumptions as
+   fd_wksp_checkpt_tpool. */
+
+int
+fd_wksp_restore_tpool( fd_tpool_t * tpool,
+                       ulong        t0,
+                       ulong        t1,
+                       fd_wksp_t *  wksp,
+                       char const * path,
+                       uint         seed );
+
 /* fd_wksp_restore_preview extracts key parameters from a checkpoint
    file. These can be used with fd_funk_new for a correct restore. */
 int
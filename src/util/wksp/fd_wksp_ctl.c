@@ -162,7 +162,8 @@ fprintf_checkpt( FILE *       file,
 
   switch( style ) {
 
-  case FD_WKSP_CHECKPT_STYLE_RAW: {
+  case FD_WKSP_CHECKPT_STYLE_RAW:
+  case FD_WKSP_CHECKPT_STYLE_FRAME: {
 
     /* Print out checkpt metadata */
 
@@ -225,6 +226,11 @@ fprintf_checkpt( FILE *       file,
 
       if( verbose>1 ) TRAP( fprintf( file, "\tgaddr          [0x%016lx,0x%016lx)\n", data_lo, data_hi ) );
 
+      /* Partitions of FRAME style checkpts are in the frame index at
+         the end of the checkpt (not scanned here) */
+
+      if( style==FD_WKSP_CHECKPT_STYLE_FRAME ) break;
+
       ulong alloc_tot = 0UL;
       ulong alloc_cnt = 0UL;
       ulong alloc_big = 0UL;
@@ -283,7 +289,7 @@ fprintf_checkpt( FILE *       file,
     }
 
     break;
-  } /* FD_WKSP_CHECKPT_STYLE_RAW */
+  } /* FD_WKSP_CHECKPT_STYLE_RAW / FD_WKSP_CHECKPT_STYLE_FRAME */
 
   default:
     err_info = "unsupported style";
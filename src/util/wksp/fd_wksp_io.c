@@ -10,7 +10,20 @@ fd_wksp_checkpt( fd_wksp_t *  wksp,
                  char const * path,
                  ulong        mode,
                  int          style,
-                 char const * uinfo ) { /* TODO: CONSIDER ALLOWING SUBSET OF TAGS */
+                 char const * uinfo ) {
+  return fd_wksp_checkpt_tpool( NULL, 0UL, 1UL, wksp, path, mode, style, uinfo, NULL );
+}
+
+int
+fd_wksp_checkpt_tpool( fd_tpool_t * tpool,
+                       ulong        t0,
+                       ulong        t1,
+                       fd_wksp_t *  wksp,
+                       char const * path,
+                       ulong        mode,
+                       int          style,
+                       char const * uinfo,
+                       char const * base ) { /* TODO: CONSIDER ALLOWING SUBSET OF TAGS */
 
   if( FD_UNLIKELY( !wksp ) ) {
     FD_LOG_WARNING(( "NULL wksp" ));
@@ -27,13 +40,24 @@ fd_wksp_checkpt( fd_wksp_t *  wksp,
     return FD_WKSP_ERR_INVAL;
   }
 
+  if( FD_UNLIKELY( !((t0<t1) & (tpool || t1==t0+1UL)) ) ) {
+    FD_LOG_WARNING(( "bad tpool threads" ));
+    return FD_WKSP_ERR_INVAL;
+  }
+
   style = fd_int_if( !!style, style, FD_WKSP_CHECKPT_STYLE_DEFAULT );
 
+  if( FD_UNLIKELY( base && style!=FD_WKSP_CHECKPT_STYLE_FRAME ) ) {
+    FD_LOG_WARNING(( "incremental checkpt requires FRAME style" ));
+    return FD_WKSP_ERR_INVAL;
+  }
+
   if( FD_UNLIKELY( !uinfo ) ) uinfo = "";
 
   switch( style ) {
 
-  case FD_WKSP_CHECKPT_STYLE_RAW: {
+  case FD_WKSP_CHECKPT_STYLE_RAW:
+  case FD_WKSP_CHECKPT_STYLE_FRAME: {
 
   //FD_LOG_INFO(( "Checkpt wksp \"%s\" to \"%s\" (mode 0%03lo), style %i, uinfo \"%s\"", wksp->name, path, mode, style, uinfo ));
 
@@ -91,6 +115,13 @@ fd_wksp_checkpt( fd_wksp_t *  wksp,
     prep = fd_wksp_private_checkpt_buf  ( prep, uinfo,             fd_cstr_nlen( uinfo, 16383UL )                    );
     fd_wksp_private_checkpt_publish( checkpt, prep );
 
+    if( style==FD_WKSP_CHECKPT_STYLE_FRAME ) {
+      err = fd_io_buffered_ostream_flush( checkpt ); if( FD_UNLIKELY( err ) ) goto io_err;
+      err = fd_wksp_private_checkpt_frame( tpool, t0, t1, wksp, fd, path, base ); /* logs details */
+      fd_wksp_private_unlock( wksp );
+      goto fini;
+    }
+
   //FD_LOG_INFO(( "Checkpt allocations" ));
 
     ulong part_max = wksp->part_max;
@@ -178,7 +209,7 @@ fd_wksp_checkpt( fd_wksp_t *  wksp,
 #   undef WBUF_FOOTPRINT
 #   undef WBUF_ALIGN
 
-  } /* FD_WKSP_CHECKPT_STYLE_RAW */
+  } /* FD_WKSP_CHECKPT_STYLE_RAW / FD_WKSP_CHECKPT_STYLE_FRAME */
 
   default:
     break;
@@ -249,6 +280,16 @@ int
 fd_wksp_restore( fd_wksp_t *  wksp,
                  char const * path,
                  uint         new_seed ) {
+  return fd_wksp_restore_tpool( NULL, 0UL, 1UL, wksp, path, new_seed );
+}
+
+int
+fd_wksp_restore_tpool( fd_tpool_t * tpool,
+                       ulong        t0,
+                       ulong        t1,
+                       fd_wksp_t *  wksp,
+                       char const * path,
+                       uint         new_seed ) {
 
   if( FD_UNLIKELY( !wksp ) ) {
     FD_LOG_WARNING(( "NULL wksp" ));
@@ -260,6 +301,11 @@ fd_wksp_restore( fd_wksp_t *  wksp,
     return FD_WKSP_ERR_INVAL;
   }
 
+  if( FD_UNLIKELY( !((t0<t1) & (tpool || t1==t0+1UL)) ) ) {
+    FD_LOG_WARNING(( "bad tpool threads" ));
+    return FD_WKSP_ERR_INVAL;
+  }
+
   FD_LOG_INFO(( "Restore checkpt \"%s\" into wksp \"%s\" (seed %u)", path, wksp->name, new_seed ));
 
   int fd = open( path, O_RDONLY, (mode_t)0 );
@@ -311,7 +357,8 @@ fd_wksp_restore( fd_wksp_t *  wksp,
 
   switch( style ) {
 
-  case FD_WKSP_CHECKPT_STYLE_RAW: {
+  case FD_WKSP_CHECKPT_STYLE_RAW:
+  case FD_WKSP_CHECKPT_STYLE_FRAME: {
 
     FD_LOG_INFO(( "Restore metadata" ));
 
@@ -369,6 +416,13 @@ fd_wksp_restore( fd_wksp_t *  wksp,
 
     ulong wksp_part_cnt = 0UL;
 
+    if( style==FD_WKSP_CHECKPT_STYLE_FRAME ) {
+      wksp_dirty = 1;
+      err = fd_wksp_private_restore_frame( tpool, t0, t1, wksp, path, data_lo, data_hi, &wksp_part_cnt ); /* logs details */
+      if( FD_UNLIKELY( err ) ) goto unlock;
+      goto rebuild;
+    }
+
     for(;;) {
 
       /* Restore the allocation header */
@@ -425,6 +479,7 @@ fd_wksp_restore( fd_wksp_t *  wksp,
       wksp_part_cnt++;
     }
 
+  rebuild:
     FD_LOG_INFO(( "Rebuilding wksp with restored allocations" ));
 
     wksp_dirty = 1;
@@ -441,7 +496,7 @@ fd_wksp_restore( fd_wksp_t *  wksp,
     FD_LOG_INFO(( "Restore successful" ));
     break;
 
-  } /* FD_WKSP_CHECKPT_STYLE_RAW */
+  } /* FD_WKSP_CHECKPT_STYLE_RAW / FD_WKSP_CHECKPT_STYLE_FRAME */
 
   default:
     err_info = "unsupported style";
@@ -531,12 +586,13 @@ fd_wksp_restore_preview( char const * path,
   ulong style_ul; RESTORE_ULONG( style_ul ); int style = (int)(uint)style_ul;
 
   switch( style ) {
-  case FD_WKSP_CHECKPT_STYLE_RAW: {
+  case FD_WKSP_CHECKPT_STYLE_RAW:
+  case FD_WKSP_CHECKPT_STYLE_FRAME: {
     ulong tseed_ul;   RESTORE_ULONG( tseed_ul  ); *out_seed = (uint)tseed_ul;
     ulong tpart_max;  RESTORE_ULONG( tpart_max ); *out_part_max = tpart_max;
     ulong tdata_max;  RESTORE_ULONG( tdata_max ); *out_data_max = tdata_max;
     break;
-  } /* FD_WKSP_CHECKPT_STYLE_RAW */
+  } /* FD_WKSP_CHECKPT_STYLE_RAW / FD_WKSP_CHECKPT_STYLE_FRAME */
 
   default:
     err = FD_WKSP_ERR_FAIL;
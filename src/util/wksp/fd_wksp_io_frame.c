@@ -0,0 +1,959 @@
+#define _GNU_SOURCE /* MAP_ANONYMOUS */
+
+#include "fd_wksp_private.h"
+#include "../checkpt/fd_checkpt.h"
+#include "../rng/fd_rng.h"
+#include "../tpool/fd_tpool.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* A FRAME style checkpt has the layout:
+
+     metadata   same as a RAW style checkpt (written by fd_wksp_io.c)
+     frames     one fd_checkpt frame per window of FD_WKSP_CHECKPT_FRAME_SZ
+                bytes of the data region with allocated bytes (in no
+                particular order, frames are appended as they complete)
+     ptab       fd_checkpt frame with the allocated partitions, sorted
+     index      fd_checkpt frame with the location and hash of the frame
+                of each window
+     bases      fd_checkpt frame with the id and path of the checkpts
+                an incremental checkpt depends on
+     footer     fd_wksp_private_frame_footer_t, stored raw at the end
+
+   A frame contains the allocated bytes of its window, partition by
+   partition, in gaddr order.  The hash of a window covers the tag and
+   the range of the allocated bytes in the window in addition to the
+   bytes themselves, such that two windows with the same hash can be
+   restored from the same frame.  An incremental checkpt copies the
+   index entries of the windows with the same hash as in its base
+   (adjusting which checkpt has the frame) instead of writing them.
+
+   The hash is seeded with a secure random seed drawn when the full
+   checkpt is made and inherited by the incremental checkpts made from
+   it, such that the contents of a window cannot be chosen to collide
+   with a different window in a base.  The bases are recorded by their
+   canonical path such that a checkpt can be restored independently of
+   the working directory it was made from. */
+
+#define FD_WKSP_PRIVATE_FRAME_PATH_MAX (4096UL)
+
+FD_STATIC_ASSERT( FD_WKSP_PRIVATE_FRAME_PATH_MAX>=PATH_MAX, realpath );
+
+struct fd_wksp_private_frame_footer {
+  ulong magic;       /* ==FD_WKSP_MAGIC */
+  ulong id;          /* Arbitrary, unique id of this checkpt */
+  ulong seed;        /* Seed of the window hashes, same for this checkpt and its bases */
+  ulong frame_style; /* FD_CHECKPT_FRAME_STYLE_* of all frames */
+  ulong frame_sz;    /* Byte size of the window covered by a frame */
+  ulong data_lo;     /* Data region of the checkpointed wksp is [data_lo,data_hi) */
+  ulong data_hi;
+  ulong part_cnt;    /* Number of allocated partitions */
+  ulong ptab_off;    /* ptab frame is at [ptab_off,ptab_off+ptab_sz) of the checkpt */
+  ulong ptab_sz;
+  ulong index_off;   /* index frame is at [index_off,index_off+index_sz) of the checkpt */
+  ulong index_sz;
+  ulong base_cnt;    /* Number of checkpts this depends on, in [0,FD_WKSP_CHECKPT_BASE_MAX] */
+  ulong base_off;    /* bases frame is at [base_off,base_off+base_sz) of the checkpt */
+  ulong base_sz;
+};
+
+typedef struct fd_wksp_private_frame_footer fd_wksp_private_frame_footer_t;
+
+struct fd_wksp_private_frame_part {
+  ulong tag;
+  ulong gaddr_lo;
+  ulong gaddr_hi;
+};
+
+typedef struct fd_wksp_private_frame_part fd_wksp_private_frame_part_t;
+
+struct fd_wksp_private_frame {
+  ulong off;  /* Offset of the window frame in the checkpt with the frame */
+  ulong sz;   /* Byte size of the window frame, 0 if there are no allocated bytes in the window */
+  ulong hash; /* Hash of the allocations in the window */
+  ulong src;  /* 0 if the frame is in this checkpt, i if the frame is in base i-1 */
+};
+
+typedef struct fd_wksp_private_frame fd_wksp_private_frame_t;
+
+struct fd_wksp_private_frame_base {
+  ulong id;
+  char  path[ FD_WKSP_PRIVATE_FRAME_PATH_MAX ];
+};
+
+typedef struct fd_wksp_private_frame_base fd_wksp_private_frame_base_t;
+
+/* A fd_wksp_private_frame_file_t is a FRAME style checkpt file mapped
+   read only into the caller's address space. */
+
+struct fd_wksp_private_frame_file {
+  int                            fd;
+  uchar const *                  map;
+  ulong                          map_sz;
+  fd_wksp_private_frame_footer_t footer[1];
+};
+
+typedef struct fd_wksp_private_frame_file fd_wksp_private_frame_file_t;
+
+/* Misc helpers *******************************************************/
+
+#if FD_HAS_LZ4
+#define FD_WKSP_PRIVATE_FRAME_STYLE FD_CHECKPT_FRAME_STYLE_LZ4
+#else
+#define FD_WKSP_PRIVATE_FRAME_STYLE FD_CHECKPT_FRAME_STYLE_RAW
+#endif
+
+/* fd_wksp_private_frame_csz_max returns an upper bound of the byte size
+   of a frame with usz allocated bytes over piece_cnt partitions (see
+   FD_CHECKPT_PRIVATE_CSZ_MAX, each piece is compressed in chunks of at
+   most FD_CHECKPT_PRIVATE_CHUNK_USZ_MAX bytes). */
+
+FD_FN_CONST static inline ulong
+fd_wksp_private_frame_csz_max( ulong usz,
+                               ulong piece_cnt ) {
+  ulong chunk_cnt = piece_cnt + usz / FD_CHECKPT_PRIVATE_CHUNK_USZ_MAX;
+  return usz + usz/255UL + 19UL*chunk_cnt;
+}
+
+/* fd_wksp_private_frame_hash returns the hash with the given seed of
+   the allocations in the window [win_lo,win_hi).  part0 is the index in
+   ptab of the first partition that ends after win_lo. */
+
+static ulong
+fd_wksp_private_frame_hash( fd_wksp_t const *                    wksp,
+                            fd_wksp_private_frame_part_t const * ptab,
+                            ulong                                part_cnt,
+                            ulong                                part0,
+                            ulong                                seed,
+                            ulong                                win_lo,
+                            ulong                                win_hi ) {
+  ulong hash = fd_hash( seed, &win_lo, sizeof(ulong) );
+  for( ulong j=part0; (j<part_cnt) && (ptab[ j ].gaddr_lo<win_hi); j++ ) {
+    ulong lo = fd_ulong_max( ptab[ j ].gaddr_lo, win_lo );
+    ulong hi = fd_ulong_min( ptab[ j ].gaddr_hi, win_hi );
+    ulong meta[3] = { ptab[ j ].tag, lo, hi };
+    hash = fd_hash( hash, meta, sizeof(meta) );
+    hash = fd_hash( hash, fd_wksp_laddr_fast( wksp, lo ), hi-lo );
+  }
+  return hash;
+}
+
+/* fd_wksp_private_frame_part0 sets part0[k] to the index of the first
+   partition in ptab that ends after the start of window k for k in
+   [0,win_cnt).  Returns the max over windows of the frame size bound.
+   Assumes ptab is sorted and non-overlapping. */
+
+static ulong
+fd_wksp_private_frame_part0( fd_wksp_private_frame_part_t const * ptab,
+                             ulong                                part_cnt,
+                             ulong *                              part0,
+                             ulong                                data_lo,
+                             ulong                                data_hi,
+                             ulong                                frame_sz,
+                             ulong                                win_cnt ) {
+  ulong csz_max = 0UL;
+  ulong j       = 0UL;
+  for( ulong k=0UL; k<win_cnt; k++ ) {
+    ulong win_lo = data_lo + k*frame_sz;
+    ulong win_hi = fd_ulong_min( win_lo + frame_sz, data_hi );
+    while( (j<part_cnt) && (ptab[ j ].gaddr_hi<=win_lo) ) j++;
+    part0[ k ] = j;
+
+    ulong usz       = 0UL;
+    ulong piece_cnt = 0UL;
+    for( ulong i=j; (i<part_cnt) && (ptab[ i ].gaddr_lo<win_hi); i++ ) {
+      usz += fd_ulong_min( ptab[ i ].gaddr_hi, win_hi ) - fd_ulong_max( ptab[ i ].gaddr_lo, win_lo );
+      piece_cnt++;
+    }
+    csz_max = fd_ulong_max( csz_max, fd_wksp_private_frame_csz_max( usz, piece_cnt ) );
+  }
+  return csz_max;
+}
+
+/* fd_wksp_private_frame_scratch_{alloc,free} acquire and release
+   sz bytes of page aligned anonymous memory for temporary use. */
+
+static void *
+fd_wksp_private_frame_scratch_alloc( ulong sz ) {
+  void * mem = mmap( NULL, sz, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0 );
+  if( FD_UNLIKELY( mem==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(NULL,%lu KiB,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0) failed (%i-%s)",
+                     sz>>10, errno, fd_io_strerror( errno ) ));
+    return NULL;
+  }
+  return mem;
+}
+
+static void
+fd_wksp_private_frame_scratch_free( void * mem,
+                                    ulong  sz ) {
+  if( FD_UNLIKELY( munmap( mem, sz ) ) )
+    FD_LOG_WARNING(( "munmap failed (%i-%s); attempting to continue", errno, fd_io_strerror( errno ) ));
+}
+
+/* fd_wksp_private_frame_pwrite writes the sz bytes at buf to offset off
+   of fd.  Returns 0 on success and an errno compat error code on
+   failure. */
+
+static int
+fd_wksp_private_frame_pwrite( int          fd,
+                              void const * buf,
+                              ulong        sz,
+                              ulong        off ) {
+  uchar const * cur = (uchar const *)buf;
+  while( sz ) {
+    long wsz = (long)pwrite( fd, cur, sz, (off_t)off );
+    if( FD_UNLIKELY( wsz<=0L ) ) {
+      if( FD_LIKELY( wsz<0L && errno==EINTR ) ) continue;
+      return wsz<0L ? errno : EIO;
+    }
+    cur += (ulong)wsz;
+    off += (ulong)wsz;
+    sz  -= (ulong)wsz;
+  }
+  return 0;
+}
+
+/* fd_wksp_private_frame_file_open maps the FRAME style checkpt at path
+   into file and validates its footer.  Returns 0 on success and -1 on
+   failure (logs details, file is unmapped and closed). */
+
+static int
+fd_wksp_private_frame_file_open( fd_wksp_private_frame_file_t * file,
+                                 char const *                   path ) {
+  int fd = open( path, O_RDONLY, (mode_t)0 );
+  if( FD_UNLIKELY( fd==-1 ) ) {
+    FD_LOG_WARNING(( "open(\"%s\",O_RDONLY,0) failed (%i-%s)", path, errno, fd_io_strerror( errno ) ));
+    return -1;
+  }
+
+  struct stat st[1];
+  if( FD_UNLIKELY( fstat( fd, st ) ) ) {
+    FD_LOG_WARNING(( "fstat(\"%s\") failed (%i-%s)", path, errno, fd_io_strerror( errno ) ));
+    close( fd );
+    return -1;
+  }
+
+  ulong map_sz = (ulong)st->st_size;
+  if( FD_UNLIKELY( map_sz<sizeof(fd_wksp_private_frame_footer_t) ) ) {
+    FD_LOG_WARNING(( "\"%s\" is too small to be a FRAME style checkpt", path ));
+    close( fd );
+    return -1;
+  }
+
+  void * map = mmap( NULL, map_sz, PROT_READ, MAP_SHARED, fd, 0 );
+  if( FD_UNLIKELY( map==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(\"%s\",%lu KiB) failed (%i-%s)", path, map_sz>>10, errno, fd_io_strerror( errno ) ));
+    close( fd );
+    return -1;
+  }
+
+  fd_wksp_private_frame_footer_t * footer = file->footer;
+  memcpy( footer, (uchar const *)map + map_sz - sizeof(fd_wksp_private_frame_footer_t), sizeof(fd_wksp_private_frame_footer_t) );
+
+  ulong body_sz = map_sz - sizeof(fd_wksp_private_frame_footer_t);
+  if( FD_UNLIKELY( !( (footer->magic==FD_WKSP_MAGIC)                                                      &
+                      (footer->frame_sz>=FD_SHMEM_NORMAL_PAGE_SZ)                                         &
+                      (footer->data_lo<footer->data_hi)                                                   &
+                      (footer->ptab_off <=body_sz) & (footer->ptab_sz <=body_sz-footer->ptab_off )        &
+                      (footer->index_off<=body_sz) & (footer->index_sz<=body_sz-footer->index_off)        &
+                      (footer->base_off <=body_sz) & (footer->base_sz <=body_sz-footer->base_off )        &
+                      (footer->base_cnt<=FD_WKSP_CHECKPT_BASE_MAX) ) ) ) {
+    FD_LOG_WARNING(( "\"%s\" does not have a valid FRAME style checkpt footer", path ));
+    munmap( map, map_sz );
+    close( fd );
+    return -1;
+  }
+
+  file->fd     = fd;
+  file->map    = (uchar const *)map;
+  file->map_sz = map_sz;
+  return 0;
+}
+
+static void
+fd_wksp_private_frame_file_close( fd_wksp_private_frame_file_t * file ) {
+  if( FD_UNLIKELY( munmap( (void *)file->map, file->map_sz ) ) )
+    FD_LOG_WARNING(( "munmap failed (%i-%s); attempting to continue", errno, fd_io_strerror( errno ) ));
+  if( FD_UNLIKELY( close( file->fd ) ) )
+    FD_LOG_WARNING(( "close failed (%i-%s); attempting to continue", errno, fd_io_strerror( errno ) ));
+}
+
+/* fd_wksp_private_frame_file_index restores the frame index and the
+   bases of file into index (indexed [0,win_cnt)) and base (indexed
+   [0,footer->base_cnt)).  Returns 0 on success and -1 on failure (logs
+   details). */
+
+static int
+fd_wksp_private_frame_file_index( fd_wksp_private_frame_file_t const * file,
+                                  fd_wksp_private_frame_t *            index,
+                                  ulong                                win_cnt,
+                                  fd_wksp_private_frame_base_t *       base ) {
+  fd_wksp_private_frame_footer_t const * footer = file->footer;
+  int                                    style  = (int)footer->frame_style;
+
+  fd_restore_t _restore[1];
+  fd_restore_t * restore;
+  int err = 0;
+
+  restore = fd_restore_init_mmio( _restore, file->map + footer->index_off, footer->index_sz );
+  if( FD_UNLIKELY( !restore ) ) return -1; /* logs details */
+  err |= fd_restore_frame_open ( restore, style );
+  err |= fd_restore_buf        ( restore, index, win_cnt*sizeof(fd_wksp_private_frame_t) );
+  err |= fd_restore_frame_close( restore );
+  fd_restore_fini( restore );
+  if( FD_UNLIKELY( err ) ) return -1; /* logs details */
+
+  restore = fd_restore_init_mmio( _restore, file->map + footer->base_off, footer->base_sz );
+  if( FD_UNLIKELY( !restore ) ) return -1; /* logs details */
+  err |= fd_restore_frame_open( restore, style );
+  for( ulong i=0UL; i<footer->base_cnt; i++ ) {
+    ulong len = 0UL;
+    err |= fd_restore_buf( restore, &base[ i ].id, sizeof(ulong) );
+    err |= fd_restore_buf( restore, &len,          sizeof(ulong) );
+    if( FD_UNLIKELY( err || len>=FD_WKSP_PRIVATE_FRAME_PATH_MAX ) ) { err = -1; break; }
+    err |= fd_restore_buf( restore, base[ i ].path, len );
+    base[ i ].path[ len ] = '\0';
+  }
+  if( FD_LIKELY( !err ) ) err |= fd_restore_frame_close( restore );
+  fd_restore_fini( restore );
+  if( FD_UNLIKELY( err ) ) {
+    FD_LOG_WARNING(( "corrupt bases" ));
+    return -1;
+  }
+
+  return 0;
+}
+
+/* Checkpt ************************************************************/
+
+struct fd_wksp_private_frame_checkpt {
+  fd_wksp_t const *                    wksp;
+  fd_wksp_private_frame_part_t const * ptab;
+  ulong                                part_cnt;
+  ulong const *                        part0;
+  ulong                                data_lo;
+  ulong                                data_hi;
+  ulong                                frame_sz;
+  ulong                                seed;
+  fd_wksp_private_frame_t *            index;
+  fd_wksp_private_frame_t const *      base_index; /* NULL if not incremental */
+  uchar *                              wbuf;       /* Indexed [0,wbuf_sz*(t1-t0)) */
+  ulong                                wbuf_sz;
+  ulong                                t0;
+  int                                  fd;
+  ulong                                off;        /* Offset where the next frame goes, advanced atomically */
+  ulong                                write_cnt;  /* Number of frames written */
+  int                                  err;
+};
+
+typedef struct fd_wksp_private_frame_checkpt fd_wksp_private_frame_checkpt_t;
+
+static void
+fd_wksp_private_checkpt_frame_task( void * tpool,
+                                    ulong  t0,      ulong t1,
+                                    void * args,
+                                    void * reduce,  ulong stride,
+                                    ulong  l0,      ulong l1,
+                                    ulong  m0,      ulong m1,
+                                    ulong  n0,      ulong n1 ) {
+  (void)tpool; (void)t0; (void)t1; (void)reduce; (void)stride; (void)l0; (void)l1; (void)n1;
+
+  fd_wksp_private_frame_checkpt_t * ctx = (fd_wksp_private_frame_checkpt_t *)args;
+
+  fd_wksp_t const *                    wksp     = ctx->wksp;
+  fd_wksp_private_frame_part_t const * ptab     = ctx->ptab;
+  ulong                                part_cnt = ctx->part_cnt;
+  uchar *                              wbuf     = ctx->wbuf + (n0-ctx->t0)*ctx->wbuf_sz;
+
+  fd_checkpt_t _checkpt[1];
+
+  for( ulong k=m0; k<m1; k++ ) {
+    if( FD_UNLIKELY( FD_VOLATILE_CONST( ctx->err ) ) ) return;
+
+    ulong win_lo = ctx->data_lo + k*ctx->frame_sz;
+    ulong win_hi = fd_ulong_min( win_lo + ctx->frame_sz, ctx->data_hi );
+    ulong part0  = ctx->part0[ k ];
+
+    fd_wksp_private_frame_t * frame = ctx->index + k;
+
+    /* Windows without allocated bytes have no frame */
+
+    if( (part0>=part_cnt) || (ptab[ part0 ].gaddr_lo>=win_hi) ) {
+      *frame = (fd_wksp_private_frame_t){ .off = 0UL, .sz = 0UL, .hash = win_lo, .src = 0UL };
+      continue;
+    }
+
+    ulong hash = fd_wksp_private_frame_hash( wksp, ptab, part_cnt, part0, ctx->seed, win_lo, win_hi );
+
+    /* If the window is unchanged since the base checkpt, reference the
+       base frame (unless it would get too deep in the bases) */
+
+    fd_wksp_private_frame_t const * base_frame = ctx->base_index ? ctx->base_index + k : NULL;
+    if( base_frame && base_frame->sz && base_frame->hash==hash && base_frame->src<FD_WKSP_CHECKPT_BASE_MAX ) {
+      *frame = (fd_wksp_private_frame_t){ .off = base_frame->off, .sz = base_frame->sz, .hash = hash, .src = base_frame->src+1UL };
+      continue;
+    }
+
+    /* Compress the window into this thread's buffer and append it to
+       the checkpt */
+
+    fd_checkpt_t * checkpt = fd_checkpt_init_mmio( _checkpt, wbuf, ctx->wbuf_sz );
+    if( FD_UNLIKELY( !checkpt ) ) { FD_VOLATILE( ctx->err ) = 1; return; } /* logs details */
+
+    ulong sz;
+    int   err = fd_checkpt_frame_open( checkpt, FD_WKSP_PRIVATE_FRAME_STYLE );
+    for( ulong j=part0; !err && (j<part_cnt) && (ptab[ j ].gaddr_lo<win_hi); j++ ) {
+      ulong lo = fd_ulong_max( ptab[ j ].gaddr_lo, win_lo );
+      ulong hi = fd_ulong_min( ptab[ j ].gaddr_hi, win_hi );
+      err = fd_checkpt_buf( checkpt, fd_wksp_laddr_fast( wksp, lo ), hi-lo );
+    }
+    if( FD_LIKELY( !err ) ) err = fd_checkpt_frame_close_advanced( checkpt, &sz );
+    fd_checkpt_fini( checkpt );
+    if( FD_UNLIKELY( err ) ) { FD_VOLATILE( ctx->err ) = 1; return; } /* logs details */
+
+#   if FD_HAS_ATOMIC
+    ulong off = FD_ATOMIC_FETCH_AND_ADD( &ctx->off, sz );
+    FD_ATOMIC_FETCH_AND_ADD( &ctx->write_cnt, 1UL );
+#   else
+    ulong off = ctx->off; ctx->off += sz;
+    ctx->write_cnt++;
+#   endif
+
+    err = fd_wksp_private_frame_pwrite( ctx->fd, wbuf, sz, off );
+    if( FD_UNLIKELY( err ) ) {
+      FD_LOG_WARNING(( "pwrite failed (%i-%s)", err, fd_io_strerror( err ) ));
+      FD_VOLATILE( ctx->err ) = 1;
+      return;
+    }
+
+    *frame = (fd_wksp_private_frame_t){ .off = off, .sz = sz, .hash = hash, .src = 0UL };
+  }
+}
+
+int
+fd_wksp_private_checkpt_frame( fd_tpool_t * tpool,
+                               ulong        t0,
+                               ulong        t1,
+                               fd_wksp_t *  wksp,
+                               int          fd,
+                               char const * path,
+                               char const * base ) {
+
+# if !FD_HAS_ATOMIC
+  t1 = t0 + 1UL; /* frames are appended atomically */
+# endif
+
+  ulong data_lo  = wksp->gaddr_lo;
+  ulong data_hi  = wksp->gaddr_hi;
+  ulong frame_sz = FD_WKSP_CHECKPT_FRAME_SZ;
+  ulong win_cnt  = (data_hi - data_lo + frame_sz - 1UL) / frame_sz;
+
+  if( FD_UNLIKELY( !((0UL<data_lo) & (data_lo<=data_hi)) ) ) goto corrupt_wksp;
+
+  /* Count the allocations, doing the same basic partition checks as a
+     RAW style checkpt */
+
+  ulong                     part_max = wksp->part_max;
+  fd_wksp_private_pinfo_t * pinfo    = fd_wksp_private_pinfo( wksp );
+
+  ulong part_cnt = 0UL;
+  do {
+    ulong cycle_tag  = wksp->cycle_tag++;
+    ulong gaddr_last = data_lo;
+    ulong i          = fd_wksp_private_pinfo_idx( wksp->part_head_cidx );
+    while( !fd_wksp_private_pinfo_idx_is_null( i ) ) {
+      if( FD_UNLIKELY( i>=part_max ) || FD_UNLIKELY( pinfo[ i ].cycle_tag==cycle_tag ) ) goto corrupt_wksp;
+      pinfo[ i ].cycle_tag = cycle_tag; /* mark i as visited */
+      ulong gaddr_lo = pinfo[ i ].gaddr_lo;
+      ulong gaddr_hi = pinfo[ i ].gaddr_hi;
+      if( FD_UNLIKELY( !((gaddr_last==gaddr_lo) & (gaddr_lo<gaddr_hi) & (gaddr_hi<=data_hi)) ) ) goto corrupt_wksp;
+      gaddr_last = gaddr_hi;
+      part_cnt += (ulong)!!pinfo[ i ].tag;
+      i = fd_wksp_private_pinfo_idx( pinfo[ i ].next_cidx );
+    }
+  } while(0);
+
+  /* Open the base checkpt of an incremental checkpt */
+
+  fd_wksp_private_frame_file_t base_file[1];
+  int                          has_base = !!base;
+  if( has_base ) {
+    if( FD_UNLIKELY( fd_wksp_private_frame_file_open( base_file, base ) ) ) { /* logs details */
+      FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed because base \"%s\" could not be opened", wksp->name, path, base ));
+      return FD_WKSP_ERR_FAIL;
+    }
+    fd_wksp_private_frame_footer_t const * footer = base_file->footer;
+    if( FD_UNLIKELY( (footer->frame_style!=(ulong)FD_WKSP_PRIVATE_FRAME_STYLE) | (footer->frame_sz!=frame_sz) |
+                     (footer->data_lo!=data_lo) | (footer->data_hi!=data_hi) ) ) {
+      FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed because base \"%s\" is not a compatible checkpt of this wksp",
+                       wksp->name, path, base ));
+      fd_wksp_private_frame_file_close( base_file );
+      return FD_WKSP_ERR_FAIL;
+    }
+  }
+
+  /* Acquire scratch memory for the partition table, the index and, for
+     an incremental checkpt, the base index */
+
+  ulong scratch_sz = FD_LAYOUT_INIT;
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_part_t), part_cnt*sizeof(fd_wksp_private_frame_part_t) );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(ulong),                        win_cnt *sizeof(ulong)                        );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_t),      win_cnt *sizeof(fd_wksp_private_frame_t)      );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_t),      win_cnt *sizeof(fd_wksp_private_frame_t)      );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_base_t), (FD_WKSP_CHECKPT_BASE_MAX+1UL)*sizeof(fd_wksp_private_frame_base_t) );
+  scratch_sz = FD_LAYOUT_FINI  ( scratch_sz, FD_SHMEM_NORMAL_PAGE_SZ );
+
+  void * scratch = fd_wksp_private_frame_scratch_alloc( scratch_sz ); /* logs details */
+  if( FD_UNLIKELY( !scratch ) ) {
+    if( has_base ) fd_wksp_private_frame_file_close( base_file );
+    return FD_WKSP_ERR_FAIL;
+  }
+
+  FD_SCRATCH_ALLOC_INIT( l, scratch );
+  fd_wksp_private_frame_part_t * ptab       = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_part_t), part_cnt*sizeof(fd_wksp_private_frame_part_t) );
+  ulong *                        part0      = FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong),                        win_cnt *sizeof(ulong)                        );
+  fd_wksp_private_frame_t *      index      = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_t),      win_cnt *sizeof(fd_wksp_private_frame_t)      );
+  fd_wksp_private_frame_t *      base_index = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_t),      win_cnt *sizeof(fd_wksp_private_frame_t)      );
+  fd_wksp_private_frame_base_t * base_tbl   = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_base_t), (FD_WKSP_CHECKPT_BASE_MAX+1UL)*sizeof(fd_wksp_private_frame_base_t) );
+  FD_SCRATCH_ALLOC_FINI( l, FD_SHMEM_NORMAL_PAGE_SZ );
+
+  void * wbuf    = NULL;
+  ulong  wbuf_sz = 0UL;
+  int    err     = FD_WKSP_ERR_FAIL;
+
+  /* The new checkpt depends on base and on what base depends on (the
+     ones beyond FD_WKSP_CHECKPT_BASE_MAX are not referenced) */
+
+  ulong base_cnt = 0UL;
+  ulong seed     = 0UL;
+  if( has_base ) {
+    if( FD_UNLIKELY( fd_wksp_private_frame_file_index( base_file, base_index, win_cnt, base_tbl+1UL ) ) ) { /* logs details */
+      FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed because base \"%s\" is corrupt", wksp->name, path, base ));
+      goto done;
+    }
+    if( FD_UNLIKELY( !realpath( base, base_tbl[ 0 ].path ) ) ) {
+      FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed because realpath(\"%s\") failed (%i-%s)",
+                       wksp->name, path, base, errno, fd_io_strerror( errno ) ));
+      goto done;
+    }
+    base_tbl[ 0 ].id = base_file->footer->id;
+    seed     = base_file->footer->seed;
+    base_cnt = fd_ulong_min( base_file->footer->base_cnt + 1UL, FD_WKSP_CHECKPT_BASE_MAX );
+  } else {
+    if( FD_UNLIKELY( !fd_rng_secure( &seed, sizeof(ulong) ) ) ) { /* logs details */
+      FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed because no hash seed could be generated", wksp->name, path ));
+      goto done;
+    }
+  }
+
+  /* Gather the partition table (sorted by construction) */
+
+  do {
+    ulong j = 0UL;
+    ulong i = fd_wksp_private_pinfo_idx( wksp->part_head_cidx );
+    while( !fd_wksp_private_pinfo_idx_is_null( i ) ) {
+      if( pinfo[ i ].tag ) ptab[ j++ ] = (fd_wksp_private_frame_part_t){ .tag      = pinfo[ i ].tag,
+                                                                         .gaddr_lo = pinfo[ i ].gaddr_lo,
+                                                                         .gaddr_hi = pinfo[ i ].gaddr_hi };
+      i = fd_wksp_private_pinfo_idx( pinfo[ i ].next_cidx );
+    }
+  } while(0);
+
+  ulong frame_csz_max = fd_wksp_private_frame_part0( ptab, part_cnt, part0, data_lo, data_hi, frame_sz, win_cnt );
+
+  /* Acquire a compression buffer for each thread */
+
+  wbuf_sz = fd_ulong_align_up( fd_ulong_max( frame_csz_max, 1UL ), FD_SHMEM_NORMAL_PAGE_SZ );
+  wbuf    = fd_wksp_private_frame_scratch_alloc( wbuf_sz*(t1-t0) ); /* logs details */
+  if( FD_UNLIKELY( !wbuf ) ) goto done;
+
+  /* Write the window frames in parallel */
+
+  off_t hdr_off = lseek( fd, (off_t)0, SEEK_CUR );
+  if( FD_UNLIKELY( hdr_off<(off_t)0 ) ) {
+    FD_LOG_WARNING(( "lseek(\"%s\") failed (%i-%s)", path, errno, fd_io_strerror( errno ) ));
+    goto done;
+  }
+
+  fd_wksp_private_frame_checkpt_t ctx[1] = {{
+    .wksp       = wksp,
+    .ptab       = ptab,
+    .part_cnt   = part_cnt,
+    .part0      = part0,
+    .data_lo    = data_lo,
+    .data_hi    = data_hi,
+    .frame_sz   = frame_sz,
+    .seed       = seed,
+    .index      = index,
+    .base_index = has_base ? base_index : NULL,
+    .wbuf       = (uchar *)wbuf,
+    .wbuf_sz    = wbuf_sz,
+    .t0         = t0,
+    .fd         = fd,
+    .off        = (ulong)hdr_off,
+    .write_cnt  = 0UL,
+    .err        = 0
+  }};
+
+# if FD_HAS_ATOMIC
+  fd_tpool_exec_all_taskq( tpool, t0, t1, fd_wksp_private_checkpt_frame_task, NULL, ctx, NULL, 1UL, 0UL, win_cnt );
+# else
+  fd_tpool_exec_all_block( tpool, t0, t1, fd_wksp_private_checkpt_frame_task, NULL, ctx, NULL, 1UL, 0UL, win_cnt );
+# endif
+
+  if( FD_UNLIKELY( ctx->err ) ) {
+    FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed writing frames", wksp->name, path ));
+    goto done;
+  }
+
+  /* Append the partition table, the index, the bases and the footer */
+
+  if( FD_UNLIKELY( lseek( fd, (off_t)ctx->off, SEEK_SET )!=(off_t)ctx->off ) ) {
+    FD_LOG_WARNING(( "lseek(\"%s\") failed (%i-%s)", path, errno, fd_io_strerror( errno ) ));
+    goto done;
+  }
+
+  do {
+    uchar        _wbuf[ FD_CHECKPT_WBUF_MIN ] __attribute__((aligned(4096)));
+    fd_checkpt_t _checkpt[1];
+
+    fd_checkpt_t * checkpt = fd_checkpt_init_stream( _checkpt, fd, _wbuf, FD_CHECKPT_WBUF_MIN );
+    if( FD_UNLIKELY( !checkpt ) ) goto done; /* logs details */
+
+    fd_wksp_private_frame_footer_t footer[1] = {{
+      .magic       = FD_WKSP_MAGIC,
+      .id          = fd_hash( (ulong)fd_log_wallclock(), index, win_cnt*sizeof(fd_wksp_private_frame_t) ),
+      .seed        = seed,
+      .frame_style = (ulong)FD_WKSP_PRIVATE_FRAME_STYLE,
+      .frame_sz    = frame_sz,
+      .data_lo     = data_lo,
+      .data_hi     = data_hi,
+      .part_cnt    = part_cnt,
+      .base_cnt    = base_cnt
+    }};
+
+    ulong off;
+    int   cerr = 0;
+
+    cerr |= fd_checkpt_frame_open_advanced ( checkpt, FD_WKSP_PRIVATE_FRAME_STYLE, &off );
+    cerr |= fd_checkpt_buf                 ( checkpt, ptab, part_cnt*sizeof(fd_wksp_private_frame_part_t) );
+    cerr |= fd_checkpt_frame_close_advanced( checkpt, &footer->ptab_sz );
+    footer->ptab_off  = ctx->off + off;
+    footer->ptab_sz  -= off;
+
+    cerr |= fd_checkpt_frame_open_advanced ( checkpt, FD_WKSP_PRIVATE_FRAME_STYLE, &off );
+    cerr |= fd_checkpt_buf                 ( checkpt, index, win_cnt*sizeof(fd_wksp_private_frame_t) );
+    cerr |= fd_checkpt_frame_close_advanced( checkpt, &footer->index_sz );
+    footer->index_off = ctx->off + off;
+    footer->index_sz -= off;
+
+    ulong base_len[ FD_WKSP_CHECKPT_BASE_MAX ];
+    cerr |= fd_checkpt_frame_open_advanced ( checkpt, FD_WKSP_PRIVATE_FRAME_STYLE, &off );
+    for( ulong i=0UL; i<base_cnt; i++ ) {
+      base_len[ i ] = strlen( base_tbl[ i ].path );
+      cerr |= fd_checkpt_buf( checkpt, &base_tbl[ i ].id, sizeof(ulong) );
+      cerr |= fd_checkpt_buf( checkpt, &base_len[ i ],    sizeof(ulong) );
+      cerr |= fd_checkpt_buf( checkpt, base_tbl[ i ].path, base_len[ i ] );
+    }
+    cerr |= fd_checkpt_frame_close_advanced( checkpt, &footer->base_sz );
+    footer->base_off  = ctx->off + off;
+    footer->base_sz  -= off;
+
+    cerr |= fd_checkpt_frame_open ( checkpt, FD_CHECKPT_FRAME_STYLE_RAW );
+    cerr |= fd_checkpt_buf        ( checkpt, footer, sizeof(fd_wksp_private_frame_footer_t) );
+    cerr |= fd_checkpt_frame_close( checkpt );
+
+    fd_checkpt_fini( checkpt );
+    if( FD_UNLIKELY( cerr ) ) {
+      FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed writing index", wksp->name, path ));
+      goto done;
+    }
+
+    FD_LOG_INFO(( "Checkpt wksp \"%s\" to \"%s\": %lu partitions, %lu frames written (%lu bases)",
+                  wksp->name, path, part_cnt, ctx->write_cnt, base_cnt ));
+  } while(0);
+
+  err = FD_WKSP_SUCCESS;
+
+done:
+  if( wbuf     ) fd_wksp_private_frame_scratch_free( wbuf, wbuf_sz*(t1-t0) );
+  fd_wksp_private_frame_scratch_free( scratch, scratch_sz );
+  if( has_base ) fd_wksp_private_frame_file_close( base_file );
+  return err;
+
+corrupt_wksp:
+  FD_LOG_WARNING(( "Checkpt wksp \"%s\" to \"%s\" failed due to wksp corruption", wksp->name, path ));
+  return FD_WKSP_ERR_CORRUPT;
+}
+
+/* Restore ************************************************************/
+
+struct fd_wksp_private_frame_restore {
+  fd_wksp_t *                          wksp;
+  fd_wksp_private_frame_part_t const * ptab;
+  ulong                                part_cnt;
+  ulong const *                        part0;
+  ulong                                data_lo;
+  ulong                                data_hi;
+  ulong                                frame_sz;
+  ulong                                seed;
+  int                                  frame_style;
+  fd_wksp_private_frame_t const *      index;
+  fd_wksp_private_frame_file_t const * file;     /* Indexed [0,base_cnt], file[0] is the checkpt, file[i] is base i-1 */
+  ulong                                base_cnt;
+  int                                  err;
+};
+
+typedef struct fd_wksp_private_frame_restore fd_wksp_private_frame_restore_t;
+
+static void
+fd_wksp_private_restore_frame_task( void * tpool,
+                                    ulong  t0,      ulong t1,
+                                    void * args,
+                                    void * reduce,  ulong stride,
+                                    ulong  l0,      ulong l1,
+                                    ulong  m0,      ulong m1,
+                                    ulong  n0,      ulong n1 ) {
+  (void)tpool; (void)t0; (void)t1; (void)reduce; (void)stride; (void)l0; (void)l1; (void)n0; (void)n1;
+
+  fd_wksp_private_frame_restore_t * ctx = (fd_wksp_private_frame_restore_t *)args;
+
+  fd_wksp_t *                          wksp     = ctx->wksp;
+  fd_wksp_private_frame_part_t const * ptab     = ctx->ptab;
+  ulong                                part_cnt = ctx->part_cnt;
+
+  fd_restore_t _restore[1];
+
+  for( ulong k=m0; k<m1; k++ ) {
+    if( FD_UNLIKELY( FD_VOLATILE_CONST( ctx->err ) ) ) return;
+
+    ulong win_lo = ctx->data_lo + k*ctx->frame_sz;
+    ulong win_hi = fd_ulong_min( win_lo + ctx->frame_sz, ctx->data_hi );
+    ulong part0  = ctx->part0[ k ];
+
+    fd_wksp_private_frame_t const * frame = ctx->index + k;
+
+    int is_empty = (part0>=part_cnt) || (ptab[ part0 ].gaddr_lo>=win_hi);
+    if( is_empty ) {
+      if( FD_UNLIKELY( frame->sz ) ) {
+        FD_LOG_WARNING(( "frame %lu does not match the partition table", k ));
+        FD_VOLATILE( ctx->err ) = 1;
+        return;
+      }
+      continue;
+    }
+
+    if( FD_UNLIKELY( !frame->sz || frame->src>ctx->base_cnt ) ) {
+      FD_LOG_WARNING(( "frame %lu is corrupt", k ));
+      FD_VOLATILE( ctx->err ) = 1;
+      return;
+    }
+
+    fd_wksp_private_frame_file_t const * file = ctx->file + frame->src;
+    ulong body_sz = file->map_sz - sizeof(fd_wksp_private_frame_footer_t);
+    if( FD_UNLIKELY( !((frame->off<=body_sz) & (frame->sz<=body_sz-frame->off)) ) ) {
+      FD_LOG_WARNING(( "frame %lu is outside its checkpt", k ));
+      FD_VOLATILE( ctx->err ) = 1;
+      return;
+    }
+
+    fd_restore_t * restore = fd_restore_init_mmio( _restore, file->map + frame->off, frame->sz );
+    if( FD_UNLIKELY( !restore ) ) { FD_VOLATILE( ctx->err ) = 1; return; } /* logs details */
+
+    int err = fd_restore_frame_open( restore, ctx->frame_style );
+    for( ulong j=part0; !err && (j<part_cnt) && (ptab[ j ].gaddr_lo<win_hi); j++ ) {
+      ulong lo = fd_ulong_max( ptab[ j ].gaddr_lo, win_lo );
+      ulong hi = fd_ulong_min( ptab[ j ].gaddr_hi, win_hi );
+      err = fd_restore_buf( restore, fd_wksp_laddr_fast( wksp, lo ), hi-lo );
+    }
+    if( FD_LIKELY( !err ) ) err = fd_restore_frame_close( restore );
+    fd_restore_fini( restore );
+    if( FD_UNLIKELY( err ) ) { FD_VOLATILE( ctx->err ) = 1; return; } /* logs details */
+
+    if( FD_UNLIKELY( fd_wksp_private_frame_hash( wksp, ptab, part_cnt, part0, ctx->seed, win_lo, win_hi )!=frame->hash ) ) {
+      FD_LOG_WARNING(( "frame %lu failed hash check", k ));
+      FD_VOLATILE( ctx->err ) = 1;
+      return;
+    }
+  }
+}
+
+int
+fd_wksp_private_restore_frame( fd_tpool_t * tpool,
+                               ulong        t0,
+                               ulong        t1,
+                               fd_wksp_t *  wksp,
+                               char const * path,
+                               ulong        data_lo,
+                               ulong        data_hi,
+                               ulong *      _part_cnt ) {
+
+  fd_wksp_private_frame_file_t file[ FD_WKSP_CHECKPT_BASE_MAX+1UL ];
+  ulong                        file_cnt = 0UL;
+
+  void * scratch    = NULL;
+  ulong  scratch_sz = 0UL;
+  int    err        = FD_WKSP_ERR_FAIL;
+
+  if( FD_UNLIKELY( fd_wksp_private_frame_file_open( file, path ) ) ) goto fail; /* logs details */
+  file_cnt = 1UL;
+
+  fd_wksp_private_frame_footer_t const * footer = file->footer;
+
+  ulong frame_sz = footer->frame_sz;
+  ulong part_cnt = footer->part_cnt;
+  ulong base_cnt = footer->base_cnt;
+  int   style    = (int)footer->frame_style;
+
+  if( FD_UNLIKELY( (footer->data_lo!=data_lo) | (footer->data_hi!=data_hi) ) ) {
+    FD_LOG_WARNING(( "frame footer does not match the checkpt metadata" ));
+    goto fail;
+  }
+
+  ulong wksp_part_max = wksp->part_max;
+  ulong wksp_data_lo  = wksp->gaddr_lo;
+  ulong wksp_data_hi  = wksp->gaddr_hi;
+
+  if( FD_UNLIKELY( part_cnt>wksp_part_max ) ) {
+    FD_LOG_WARNING(( "Restore \"%s\" to wksp \"%s\" failed because too few wksp partitions (checkpt %lu allocations, wksp part_max %lu)",
+                     path, wksp->name, part_cnt, wksp_part_max ));
+    goto fail;
+  }
+
+  ulong win_cnt = (data_hi - data_lo + frame_sz - 1UL) / frame_sz;
+
+  scratch_sz = FD_LAYOUT_INIT;
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_part_t), part_cnt*sizeof(fd_wksp_private_frame_part_t) );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(ulong),                        win_cnt *sizeof(ulong)                        );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_t),      win_cnt *sizeof(fd_wksp_private_frame_t)      );
+  scratch_sz = FD_LAYOUT_APPEND( scratch_sz, alignof(fd_wksp_private_frame_base_t), FD_WKSP_CHECKPT_BASE_MAX*sizeof(fd_wksp_private_frame_base_t) );
+  scratch_sz = FD_LAYOUT_FINI  ( scratch_sz, FD_SHMEM_NORMAL_PAGE_SZ );
+
+  scratch = fd_wksp_private_frame_scratch_alloc( scratch_sz ); /* logs details */
+  if( FD_UNLIKELY( !scratch ) ) goto fail;
+
+  FD_SCRATCH_ALLOC_INIT( l, scratch );
+  fd_wksp_private_frame_part_t * ptab     = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_part_t), part_cnt*sizeof(fd_wksp_private_frame_part_t) );
+  ulong *                        part0    = FD_SCRATCH_ALLOC_APPEND( l, alignof(ulong),                        win_cnt *sizeof(ulong)                        );
+  fd_wksp_private_frame_t *      index    = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_t),      win_cnt *sizeof(fd_wksp_private_frame_t)      );
+  fd_wksp_private_frame_base_t * base_tbl = FD_SCRATCH_ALLOC_APPEND( l, alignof(fd_wksp_private_frame_base_t), FD_WKSP_CHECKPT_BASE_MAX*sizeof(fd_wksp_private_frame_base_t) );
+  FD_SCRATCH_ALLOC_FINI( l, FD_SHMEM_NORMAL_PAGE_SZ );
+
+  /* Load the partition table, the index and the bases */
+
+  do {
+    fd_restore_t   _restore[1];
+    fd_restore_t * restore = fd_restore_init_mmio( _restore, file->map + footer->ptab_off, footer->ptab_sz );
+    if( FD_UNLIKELY( !restore ) ) goto fail; /* logs details */
+    int rerr = 0;
+    rerr |= fd_restore_frame_open ( restore, style );
+    rerr |= fd_restore_buf        ( restore, ptab, part_cnt*sizeof(fd_wksp_private_frame_part_t) );
+    rerr |= fd_restore_frame_close( restore );
+    fd_restore_fini( restore );
+    if( FD_UNLIKELY( rerr ) ) goto fail; /* logs details */
+  } while(0);
+
+  if( FD_UNLIKELY( fd_wksp_private_frame_file_index( file, index, win_cnt, base_tbl ) ) ) goto fail; /* logs details */
+
+  for( ulong i=0UL; i<base_cnt; i++ ) {
+    fd_wksp_private_frame_file_t * base = file + file_cnt;
+    if( FD_UNLIKELY( fd_wksp_private_frame_file_open( base, base_tbl[ i ].path ) ) ) { /* logs details */
+      FD_LOG_WARNING(( "Restore \"%s\" to wksp \"%s\" failed because base \"%s\" could not be opened", path, wksp->name, base_tbl[ i ].path ));
+      goto fail;
+    }
+    file_cnt++;
+    if( FD_UNLIKELY( (base->footer->id         !=base_tbl[ i ].id) | (base->footer->frame_style!=footer->frame_style) |
+                     (base->footer->frame_sz   !=frame_sz        ) | (base->footer->data_lo    !=data_lo            ) |
+                     (base->footer->data_hi    !=data_hi         ) | (base->footer->seed       !=footer->seed       ) ) ) {
+      FD_LOG_WARNING(( "Restore \"%s\" to wksp \"%s\" failed because base \"%s\" is not the checkpt it was made from",
+                       path, wksp->name, base_tbl[ i ].path ));
+      goto fail;
+    }
+  }
+
+  /* Validate the partition table and record the allocations in the
+     wksp */
+
+  fd_wksp_private_pinfo_t * pinfo = fd_wksp_private_pinfo( wksp );
+
+  ulong gaddr_last = data_lo;
+  for( ulong j=0UL; j<part_cnt; j++ ) {
+    ulong tag      = ptab[ j ].tag;
+    ulong gaddr_lo = ptab[ j ].gaddr_lo;
+    ulong gaddr_hi = ptab[ j ].gaddr_hi;
+
+    if( FD_UNLIKELY( !((!!tag) & (gaddr_last<=gaddr_lo) & (gaddr_lo<gaddr_hi) & (gaddr_hi<=data_hi)) ) ) {
+      FD_LOG_WARNING(( "Restore \"%s\" to wksp \"%s\" failed because partition table is corrupt", path, wksp->name ));
+      goto fail;
+    }
+
+    if( FD_UNLIKELY( !((wksp_data_lo<=gaddr_lo) & (gaddr_hi<=wksp_data_hi)) ) ) {
+      FD_LOG_WARNING(( "Restore \"%s\" to wksp \"%s\" failed because checkpt partition [0x%016lx,0x%016lx) tag %lu "
+                       "does not fit into wksp data region [0x%016lx,0x%016lx)",
+                       path, wksp->name, gaddr_lo, gaddr_hi, tag, wksp_data_lo, wksp_data_hi ));
+      goto fail;
+    }
+
+    pinfo[ j ].gaddr_lo = gaddr_lo;
+    pinfo[ j ].gaddr_hi = gaddr_hi;
+    pinfo[ j ].tag      = tag;
+    gaddr_last = gaddr_hi;
+
+#   if FD_HAS_DEEPASAN
+    /* Poison the restored allocations (see fd_wksp_restore) */
+    ulong laddr_lo = (ulong)fd_wksp_laddr_fast( wksp, gaddr_lo );
+    ulong laddr_hi = laddr_lo + (gaddr_hi - gaddr_lo);
+    ulong aligned_laddr_lo = fd_ulong_align_up( laddr_lo, FD_ASAN_ALIGN );
+    ulong aligned_laddr_hi = fd_ulong_align_dn( laddr_hi, FD_ASAN_ALIGN );
+    if( aligned_laddr_lo < aligned_laddr_hi ) {
+      fd_asan_poison( (void*)aligned_laddr_lo, aligned_laddr_hi - aligned_laddr_lo );
+    }
+#   endif
+  }
+
+  /* Restore the window frames in parallel */
+
+  fd_wksp_private_frame_part0( ptab, part_cnt, part0, data_lo, data_hi, frame_sz, win_cnt );
+
+  fd_wksp_private_frame_restore_t ctx[1] = {{
+    .wksp        = wksp,
+    .ptab        = ptab,
+    .part_cnt    = part_cnt,
+    .part0       = part0,
+    .data_lo     = data_lo,
+    .data_hi     = data_hi,
+    .frame_sz    = frame_sz,
+    .seed        = footer->seed,
+    .frame_style = style,
+    .index       = index,
+    .file        = file,
+    .base_cnt    = base_cnt,
+    .err         = 0
+  }};
+
+# if FD_HAS_ATOMIC
+  fd_tpool_exec_all_taskq( tpool, t0, t1, fd_wksp_private_restore_frame_task, NULL, ctx, NULL, 1UL, 0UL, win_cnt );
+# else
+  fd_tpool_exec_all_block( tpool, t0, t1, fd_wksp_private_restore_frame_task, NULL, ctx, NULL, 1UL, 0UL, win_cnt );
+# endif
+
+  if( FD_UNLIKELY( ctx->err ) ) {
+    FD_LOG_WARNING(( "Restore \"%s\" to wksp \"%s\" failed restoring frames", path, wksp->name ));
+    goto fail;
+  }
+
+  *_part_cnt = part_cnt;
+  err        = FD_WKSP_SUCCESS;
+
+fail:
+  if( scratch ) fd_wksp_private_frame_scratch_free( scratch, scratch_sz );
+  for( ulong i=0UL; i<file_cnt; i++ ) fd_wksp_private_frame_file_close( file + i );
+  return err;
+}
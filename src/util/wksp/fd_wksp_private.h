@@ -596,6 +596,41 @@ fd_wksp_private_restore_buf( fd_io_buffered_istream_t * in,
                              ulong                      buf_max,
                              ulong *                    _buf_sz );
 
+/* fd_wksp_private_checkpt_frame writes the FRAME style sections that
+   follow the checkpt metadata (see fd_wksp_checkpt_tpool).  fd is the
+   open checkpt file positioned just after the metadata.  base is the
+   path of the base checkpt of an incremental checkpt or NULL.  Assumes
+   the caller has the wksp lock.  Returns FD_WKSP_SUCCESS (0) on success
+   and a FD_WKSP_ERR_* on failure (logs details). */
+
+int
+fd_wksp_private_checkpt_frame( fd_tpool_t * tpool,
+                               ulong        t0,
+                               ulong        t1,
+                               fd_wksp_t *  wksp,
+                               int          fd,
+                               char const * path,
+                               char const * base );
+
+/* fd_wksp_private_restore_frame restores the allocations of the FRAME
+   style checkpt at path into wksp.  [data_lo,data_hi) is the data
+   region of the checkpointed wksp (from the checkpt metadata).  On
+   success, returns FD_WKSP_SUCCESS (0), the allocations are in the
+   first *_part_cnt wksp partition infos and the wksp needs to be
+   rebuilt.  On failure, returns FD_WKSP_ERR_FAIL (logs details) and the
+   wksp might have been modified.  Assumes the caller has the wksp
+   lock. */
+
+int
+fd_wksp_private_restore_frame( fd_tpool_t * tpool,
+                               ulong        t0,
+                               ulong        t1,
+                               fd_wksp_t *  wksp,
+                               char const * path,
+                               ulong        data_lo,
+                               ulong        data_hi,
+                               ulong *      _part_cnt );
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_util_wksp_fd_wksp_private_h */
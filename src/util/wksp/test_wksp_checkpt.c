@@ -0,0 +1,198 @@
+#include "../fd_util.h"
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define ALLOC_MAX (512UL)
+
+struct test_alloc {
+  ulong gaddr;
+  ulong sz;
+  ulong tag;
+};
+
+typedef struct test_alloc test_alloc_t;
+
+static test_alloc_t alloc_tbl[ ALLOC_MAX ];
+static ulong        alloc_cnt;
+
+static uchar tpool_mem[ FD_TPOOL_FOOTPRINT(FD_TILE_MAX) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+
+/* fill fills the sz bytes at p with a mix of compressible and random
+   data */
+
+static void
+fill( uchar *    p,
+      ulong      sz,
+      fd_rng_t * rng ) {
+  int compressible = (int)(fd_rng_uint( rng ) & 1U);
+  for( ulong i=0UL; i<sz; i++ ) p[ i ] = compressible ? (uchar)(i>>6) : fd_rng_uchar( rng );
+}
+
+static void
+test_alloc( fd_wksp_t * wksp,
+            fd_rng_t *  rng ) {
+  while( alloc_cnt<ALLOC_MAX ) {
+    ulong sz    = fd_rng_uint_roll( rng, 4U ) ? 1UL + fd_rng_ulong_roll( rng, 8192UL ) : 1UL + fd_rng_ulong_roll( rng, 1UL<<21 );
+    ulong align = 1UL << fd_rng_uint_roll( rng, 13U );
+    ulong tag   = 1UL + fd_rng_ulong_roll( rng, 1000UL );
+    ulong gaddr = fd_wksp_alloc( wksp, align, sz, tag );
+    if( !gaddr ) break;
+    fill( fd_wksp_laddr_fast( wksp, gaddr ), sz, rng );
+    alloc_tbl[ alloc_cnt++ ] = (test_alloc_t){ .gaddr = gaddr, .sz = sz, .tag = tag };
+  }
+}
+
+/* test_match checks that the allocations of wksp1 are those of wksp0
+   (as tracked in alloc_tbl). */
+
+static void
+test_match( fd_wksp_t * wksp0,
+            fd_wksp_t * wksp1 ) {
+  FD_TEST( !fd_wksp_verify( wksp1 ) );
+
+  fd_wksp_usage_t usage0[1]; FD_TEST( fd_wksp_usage( wksp0, NULL, 0UL, usage0 )==usage0 );
+  fd_wksp_usage_t usage1[1]; FD_TEST( fd_wksp_usage( wksp1, NULL, 0UL, usage1 )==usage1 );
+  FD_TEST( usage0->total_cnt==usage1->total_cnt );
+  FD_TEST( usage0->free_sz  ==usage1->free_sz   );
+
+  for( ulong i=0UL; i<alloc_cnt; i++ ) {
+    test_alloc_t const * a = alloc_tbl + i;
+    FD_TEST( fd_wksp_tag( wksp1, a->gaddr )==a->tag );
+    FD_TEST( !memcmp( fd_wksp_laddr_fast( wksp0, a->gaddr ), fd_wksp_laddr_fast( wksp1, a->gaddr ), a->sz ) );
+  }
+}
+
+static ulong
+file_sz( char const * path ) {
+  struct stat st[1];
+  FD_TEST( !stat( path, st ) );
+  return (ulong)st->st_size;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "normal"        );
+  ulong        page_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 8192UL          );
+  ulong        near_cpu  = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+  char const * path_pfx  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--path",     NULL, "/tmp"          );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+
+  FD_LOG_NOTICE(( "Using --page-sz %s --page-cnt %lu --near-cpu %lu --path %s", _page_sz, page_cnt, near_cpu, path_pfx ));
+
+  fd_wksp_t * wksp0 = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "test_checkpt0", 0UL ); FD_TEST( wksp0 );
+  fd_wksp_t * wksp1 = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "test_checkpt1", 0UL ); FD_TEST( wksp1 );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  ulong        tpool_cnt = fd_tile_cnt();
+  fd_tpool_t * tpool     = fd_tpool_init( tpool_mem, tpool_cnt ); FD_TEST( tpool );
+  for( ulong i=1UL; i<tpool_cnt; i++ ) FD_TEST( fd_tpool_worker_push( tpool, i, NULL, 0UL ) );
+
+  char path[3][ 4096 ];
+  for( ulong i=0UL; i<3UL; i++ )
+    FD_TEST( fd_cstr_printf_check( path[i], 4096UL, NULL, "%s/test_wksp_checkpt.%lu.%lu", path_pfx, fd_log_group_id(), i ) );
+
+  ulong mode  = 0600UL;
+  int   frame = FD_WKSP_CHECKPT_STYLE_FRAME;
+
+  /* Bad args */
+
+  FD_TEST( fd_wksp_checkpt_tpool( tpool, 1UL, 1UL, wksp0, path[0], mode, frame, "", NULL )==FD_WKSP_ERR_INVAL );
+  FD_TEST( fd_wksp_checkpt_tpool( NULL,  0UL, 2UL, wksp0, path[0], mode, frame, "", NULL )==FD_WKSP_ERR_INVAL );
+  FD_TEST( fd_wksp_checkpt_tpool( NULL,  0UL, 1UL, wksp0, path[0], mode, FD_WKSP_CHECKPT_STYLE_RAW, "", path[1] )==FD_WKSP_ERR_INVAL );
+  FD_TEST( fd_wksp_restore_tpool( tpool, 1UL, 1UL, wksp1, path[0], 1U )==FD_WKSP_ERR_INVAL );
+
+  /* Full checkpt of an empty and then a populated wksp */
+
+  FD_TEST( !fd_wksp_checkpt_tpool( tpool, 0UL, tpool_cnt, wksp0, path[0], mode, frame, "empty", NULL ) );
+  FD_TEST( !fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[0], 1U ) );
+  test_match( wksp0, wksp1 );
+  FD_TEST( unlink( path[0] )==0 );
+
+  test_alloc( wksp0, rng );
+  FD_LOG_NOTICE(( "%lu allocations", alloc_cnt ));
+
+  FD_TEST( !fd_wksp_checkpt_tpool( tpool, 0UL, tpool_cnt, wksp0, path[0], mode, frame, "full", NULL ) );
+  FD_TEST( !fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[0], 2U ) );
+  test_match( wksp0, wksp1 );
+
+  /* Serial restore of a parallel checkpt */
+
+  fd_wksp_reset( wksp1, 3U );
+  FD_TEST( !fd_wksp_restore( wksp1, path[0], 3U ) );
+  test_match( wksp0, wksp1 );
+
+  /* Incremental checkpt after modifying a few allocations */
+
+  for( ulong i=0UL; i<8UL; i++ ) {
+    test_alloc_t * a = alloc_tbl + fd_rng_ulong_roll( rng, alloc_cnt );
+    ((uchar *)fd_wksp_laddr_fast( wksp0, a->gaddr ))[ fd_rng_ulong_roll( rng, a->sz ) ]++;
+  }
+
+  FD_TEST( !fd_wksp_checkpt_tpool( tpool, 0UL, tpool_cnt, wksp0, path[1], mode, frame, "incr", path[0] ) );
+  FD_LOG_NOTICE(( "full %lu bytes, incremental %lu bytes", file_sz( path[0] ), file_sz( path[1] ) ));
+  FD_TEST( file_sz( path[1] )<file_sz( path[0] ) );
+  FD_TEST( !fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[1], 4U ) );
+  test_match( wksp0, wksp1 );
+
+  /* Incremental checkpt of an incremental checkpt after freeing and
+     reallocating some allocations (shifting allocations changes the
+     tags and ranges seen by a window even if the data is unchanged) */
+
+  for( ulong i=0UL; i<4UL; i++ ) {
+    ulong j = fd_rng_ulong_roll( rng, alloc_cnt );
+    fd_wksp_free( wksp0, alloc_tbl[ j ].gaddr );
+    alloc_tbl[ j ] = alloc_tbl[ --alloc_cnt ];
+  }
+  test_alloc( wksp0, rng );
+
+  FD_TEST( !fd_wksp_checkpt_tpool( tpool, 0UL, tpool_cnt, wksp0, path[2], mode, frame, "incr2", path[1] ) );
+  FD_TEST( !fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[2], 5U ) );
+  test_match( wksp0, wksp1 );
+
+  /* Bases are recorded by canonical path, so an incremental checkpt
+     made with a relative base restores from any working directory */
+
+  do {
+    char cwd[ 4096 ]; FD_TEST( getcwd( cwd, 4096UL ) );
+    FD_TEST( !chdir( path_pfx ) );
+    FD_TEST( !unlink( path[2] ) );
+    FD_TEST( !fd_wksp_checkpt_tpool( tpool, 0UL, tpool_cnt, wksp0, path[2], mode, frame, "incr3", strrchr( path[1], '/' )+1 ) );
+    FD_TEST( !chdir( "/" ) );
+    FD_TEST( !fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[2], 6U ) );
+    test_match( wksp0, wksp1 );
+    FD_TEST( !chdir( cwd ) );
+  } while(0);
+
+  /* Restoring an incremental checkpt fails if a checkpt it depends on
+     is missing and the wksp is left clean */
+
+  FD_TEST( unlink( path[0] )==0 );
+  FD_TEST( fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[2], 7U )!=FD_WKSP_SUCCESS );
+  FD_TEST( !fd_wksp_verify( wksp1 ) );
+
+  /* RAW style checkpts through the tpool API */
+
+  FD_TEST( unlink( path[1] )==0 );
+  FD_TEST( !fd_wksp_checkpt_tpool( tpool, 0UL, tpool_cnt, wksp0, path[1], mode, FD_WKSP_CHECKPT_STYLE_RAW, "raw", NULL ) );
+  FD_TEST( !fd_wksp_restore_tpool( tpool, 0UL, tpool_cnt, wksp1, path[1], 8U ) );
+  test_match( wksp0, wksp1 );
+
+  FD_TEST( unlink( path[1] )==0 );
+  FD_TEST( unlink( path[2] )==0 );
+
+  FD_TEST( fd_tpool_fini( tpool )==(void *)tpool_mem );
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_delete_anonymous( wksp1 );
+  fd_wksp_delete_anonymous( wksp0 );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
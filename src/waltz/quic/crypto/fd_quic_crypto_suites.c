@@ -594,6 +594,77 @@ fd_quic_crypto_decrypt_hdr(
   return FD_QUIC_SUCCESS;
 }
 
+FD_STATIC_ASSERT( FD_QUIC_CRYPTO_BATCH_MAX<=FD_AES_GCM_BATCH_MAX, quic_crypto_batch );
+
+void
+fd_quic_crypto_hp_mask_batch(
+    uchar const * const *                 sample,
+    fd_quic_crypto_keys_t const * const * keys,
+    uchar                                 (* mask)[16],
+    ulong                                 cnt ) {
+
+  /* TODO this is hardcoded to AES-128 */
+  uchar const * hp_key[ FD_QUIC_CRYPTO_BATCH_MAX ];
+  uchar *       out   [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  for( ulong j=0UL; j<cnt; j++ ) {
+    hp_key[j] = keys[j]->hp_key;
+    out   [j] = mask[j];
+  }
+  fd_aes_128_encrypt_batch( hp_key, sample, out, cnt );
+}
+
+ulong
+fd_quic_crypto_decrypt_batch( fd_quic_crypto_batch_pkt_t const * pkt,
+                              ulong                              cnt ) {
+
+  fd_aes_gcm_batch_msg_t msg  [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  uchar                  nonce[ FD_QUIC_CRYPTO_BATCH_MAX ][ FD_QUIC_NONCE_SZ ];
+  uchar                  idx  [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  ulong                  msg_cnt = 0UL;
+
+  for( ulong j=0UL; j<cnt; j++ ) {
+    uchar * buf            = pkt[j].buf;
+    ulong   buf_sz         = pkt[j].buf_sz;
+    ulong   pkt_number_off = pkt[j].pkt_number_off;
+    ulong   pkt_number     = pkt[j].pkt_number;
+
+    /* same checks as fd_quic_crypto_decrypt */
+    if( FD_UNLIKELY( ( pkt_number_off >= buf_sz      ) |
+                     ( buf_sz < FD_QUIC_SHORTEST_PKT ) ) ) continue;
+
+    ulong hdr_sz = pkt_number_off + ( buf[0] & 0x03u ) + 1u;
+    if( FD_UNLIKELY( buf_sz < hdr_sz+FD_QUIC_CRYPTO_TAG_SZ ) ) continue;
+
+    /* nonce is quic-iv XORed with *reconstructed* packet-number */
+    uchar const * quic_iv = pkt[j].keys->iv;
+    fd_memcpy( nonce[msg_cnt], quic_iv, FD_QUIC_NONCE_SZ );
+    for( uint k=0; k<4; ++k ) {
+      uint i = FD_QUIC_NONCE_SZ - 4 + k;
+      nonce[msg_cnt][i] = (uchar)( quic_iv[i] ^ ( (uchar)( (pkt_number>>( (3u - k) * 8u ))&0xFF ) ) );
+    }
+
+    msg[msg_cnt] = (fd_aes_gcm_batch_msg_t) {
+      .key    = pkt[j].keys->pkt_key,
+      .iv     = nonce[msg_cnt],
+      .aad    = buf,
+      .aad_sz = hdr_sz,
+      .c      = buf + hdr_sz,
+      .p      = buf + hdr_sz,
+      .sz     = buf_sz - hdr_sz - FD_QUIC_CRYPTO_TAG_SZ,
+      .tag    = buf + buf_sz - FD_QUIC_CRYPTO_TAG_SZ
+    };
+    idx[msg_cnt] = (uchar)j;
+    msg_cnt++;
+  }
+
+  if( FD_UNLIKELY( !msg_cnt ) ) return 0UL;
+  ulong msg_ok = fd_aes_128_gcm_aead_decrypt_batch( msg, msg_cnt );
+
+  ulong ok = 0UL;
+  for( ulong i=0UL; i<msg_cnt; i++ ) ok |= ( (msg_ok>>i)&1UL ) << idx[i];
+  return ok;
+}
+
 int
 fd_quic_crypto_lookup_suite( uchar major,
                              uchar minor );
@@ -448,6 +448,57 @@ fd_quic_crypto_decrypt_hdr(
     fd_quic_crypto_keys_t const *  keys );
 
 
+/* batched packet protection removal
+
+   The batch API processes a burst of (short header) packets, possibly
+   belonging to different connections, in a single call.  This amortizes
+   the per-packet AES key setup and lets the AES-GCM implementation
+   process multiple packets in parallel (see fd_aes_gcm.h).
+
+   FD_QUIC_CRYPTO_BATCH_MAX is the max number of packets per call. */
+
+#define FD_QUIC_CRYPTO_BATCH_MAX (64UL)
+
+/* fd_quic_crypto_hp_mask_batch computes the header protection masks of
+   cnt packets.  sample[i] points to the FD_QUIC_HP_SAMPLE_SZ byte
+   sample of packet i (see rfc9001 section 5.4.2), keys[i] are the keys
+   of its connection and encryption level.  The 16 byte mask is written
+   to mask[i].  The caller applies the mask (allowing it to inspect the
+   unprotected header before committing to in-place modification). */
+
+void
+fd_quic_crypto_hp_mask_batch(
+    uchar const * const *                 sample,
+    fd_quic_crypto_keys_t const * const * keys,
+    uchar                                 (* mask)[16],
+    ulong                                 cnt );
+
+/* fd_quic_crypto_batch_pkt_t describes a packet to decrypt in a batch.
+   Fields match the arguments of fd_quic_crypto_decrypt. */
+
+struct fd_quic_crypto_batch_pkt {
+  uchar *                        buf;            /* header already unprotected */
+  ulong                          buf_sz;
+  ulong                          pkt_number_off;
+  ulong                          pkt_number;     /* reconstructed */
+  fd_quic_crypto_keys_t const *  keys;
+};
+
+typedef struct fd_quic_crypto_batch_pkt fd_quic_crypto_batch_pkt_t;
+
+/* fd_quic_crypto_decrypt_batch is the batched version of
+   fd_quic_crypto_decrypt for cnt packets (cnt in
+   [0,FD_QUIC_CRYPTO_BATCH_MAX]).  Payloads are decrypted in place.
+   Returns a bit mask where bit i is set if packet i was decrypted and
+   authenticated successfully (fd_quic_crypto_decrypt would have
+   returned FD_QUIC_SUCCESS).  The payload of failed packets is
+   undefined. */
+
+ulong
+fd_quic_crypto_decrypt_batch( fd_quic_crypto_batch_pkt_t const * pkt,
+                              ulong                              cnt );
+
+
 /* look up crypto suite by major/minor
 
    return
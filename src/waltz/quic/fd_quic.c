@@ -29,12 +29,6 @@
 #define CONN_ID(CONN_ID) (CONN_ID)->conn_id[0], (CONN_ID)->conn_id[1], (CONN_ID)->conn_id[2], (CONN_ID)->conn_id[3],  \
                          (CONN_ID)->conn_id[4], (CONN_ID)->conn_id[5], (CONN_ID)->conn_id[6], (CONN_ID)->conn_id[7]
 
-/* Declare priority queue for time based processing */
-#define PRQ_NAME      service_queue
-#define PRQ_T         fd_quic_event_t
-#define PRQ_TIMEOUT_T ulong
-#include "../../util/tmpl/fd_prq.c"
-
 /* Declare map type for stream_id -> stream* */
 #define MAP_NAME              fd_quic_stream_map
 #define MAP_KEY               stream_id
@@ -84,7 +78,7 @@ struct fd_quic_layout {
   ulong conns_off;       /* offset of connection mem region  */
   ulong conn_footprint;  /* sizeof a conn                    */
   ulong conn_map_off;    /* offset of conn map mem region    */
-  ulong event_queue_off; /* offset of event queue mem region */
+  ulong svc_wheel_off;   /* offset of service wheel mem region */
   int   lg_slot_cnt;     /* see conn_map_new                 */
   ulong tls_off;         /* offset of fd_quic_tls_t          */
   ulong stream_pool_off; /* offset of the stream pool        */
@@ -148,11 +142,9 @@ fd_quic_footprint_ext( fd_quic_limits_t const * limits,
   offs                    += conn_map_footprint;
 
   /* allocate space for events priority queue */
-  offs                        = fd_ulong_align_up( offs, service_queue_align() );
-  layout->event_queue_off     = offs;
-  ulong event_queue_footprint = service_queue_footprint( conn_cnt + 1 );
-  if( FD_UNLIKELY( !event_queue_footprint ) ) { FD_LOG_WARNING(( "invalid service_queue_footprint" )); return 0UL; }
-  offs                       += event_queue_footprint;
+  offs                        = fd_ulong_align_up( offs, fd_quic_svc_wheel_align() );
+  layout->svc_wheel_off       = offs;
+  offs                       += fd_quic_svc_wheel_footprint();
 
   /* allocate space for fd_quic_tls_t */
   offs                 = fd_ulong_align_up( offs, fd_quic_tls_align() );
@@ -372,6 +364,11 @@ fd_quic_init( fd_quic_t * quic ) {
 
   if( FD_UNLIKELY( !config->role          ) ) { FD_LOG_WARNING(( "cfg.role not set"      )); return NULL; }
   if( FD_UNLIKELY( !config->idle_timeout  ) ) { FD_LOG_WARNING(( "zero cfg.idle_timeout" )); return NULL; }
+  if( FD_UNLIKELY( config->conn_reserved_cnt >= limits->conn_cnt ) ) {
+    FD_LOG_WARNING(( "cfg.conn_reserved_cnt (%lu) must be less than limits.conn_cnt (%lu)",
+                     config->conn_reserved_cnt, limits->conn_cnt ));
+    return NULL;
+  }
 
   do {
     ulong x = 0U;
@@ -457,15 +454,10 @@ fd_quic_init( fd_quic_t * quic ) {
     return NULL;
   }
 
-  /* State: Initialize service queue */
+  /* State: Initialize service wheel */
 
-  ulong  service_queue_laddr = (ulong)quic + layout.event_queue_off;
-  void * v_service_queue = service_queue_new( (void *)service_queue_laddr, limits->conn_cnt+1U );
-  state->service_queue = service_queue_join( v_service_queue );
-  if( FD_UNLIKELY( !state->service_queue ) ) {
-    FD_LOG_WARNING(( "NULL service_queue" ));
-    return NULL;
-  }
+  ulong svc_wheel_laddr = (ulong)quic + layout.svc_wheel_off;
+  state->svc_wheel = fd_quic_svc_wheel_new( (void *)svc_wheel_laddr, state->now );
 
   /* Check TX AIO */
 
@@ -837,10 +829,10 @@ fd_quic_fini( fd_quic_t * quic ) {
 
   fd_quic_tls_delete( state->tls ); state->tls = NULL;
 
-  /* Delete service queue */
+  /* Delete service wheel */
 
-  service_queue_delete( service_queue_leave( state->service_queue ) );
-  state->service_queue = NULL;
+  fd_quic_svc_wheel_delete( state->svc_wheel );
+  state->svc_wheel = NULL;
 
   /* Delete conn ID map */
 
@@ -1301,6 +1293,37 @@ fd_quic_send_retry( fd_quic_t *                  quic,
   return 0UL;
 }
 
+/* fd_quic_conn_admit checks whether a new server conn may be created.
+   Unstaked peers may not use the conn_reserved_cnt slots kept for
+   staked peers (all new conns are unstaked until the handshake
+   completes).  If no slot is available and eviction is enabled, the
+   least recently active established unstaked conn can be freed to
+   make room.  Eviction requires retry to be enabled, so that only
+   peers that passed address validation can evict conns (spoofed
+   Initial packets cannot).  The eviction is only done if evict is
+   non-zero, i.e. once the retry token was validated.  Returns 1 if a
+   conn may be created, 0 otherwise. */
+
+static int
+fd_quic_conn_admit( fd_quic_t * quic,
+                    int         evict ) {
+  fd_quic_state_t * state = fd_quic_get_state( quic );
+
+  ulong unstaked_max = quic->limits.conn_cnt - quic->config.conn_reserved_cnt;
+  if( FD_LIKELY( state->conns && state->unstaked_conn_cnt < unstaked_max ) ) return 1;
+
+  fd_quic_conn_t * victim = state->lru_head;
+  if( !quic->config.conn_evict || !quic->config.retry || !victim ) return 0;
+  if( !evict ) return 1;
+
+  FD_DEBUG( FD_LOG_DEBUG(( "evicting unstaked conn %p conn_idx: %lu", (void *)victim, victim->conn_idx )) );
+  fd_quic_cb_conn_final( quic, victim ); /* inform user before freeing */
+  fd_quic_conn_free( quic, victim );
+  quic->metrics.conn_aborted_cnt++;
+  quic->metrics.conn_evicted_cnt++;
+  return 1;
+}
+
 /* fd_quic_handle_v1_initial handles an "Initial"-type packet.
    Valid for both server and client.  Initial packets are used to
    establish QUIC conns and wrap the TLS handshake flow among other
@@ -1390,7 +1413,7 @@ fd_quic_handle_v1_initial( fd_quic_t *               quic,
 
       /* Early check: Is conn free? */
 
-      if( FD_UNLIKELY( !state->conns ) ) {
+      if( FD_UNLIKELY( !fd_quic_conn_admit( quic, 0 ) ) ) {
         FD_DEBUG( FD_LOG_DEBUG(( "ignoring conn request: no free conn slots" )) );
         quic->metrics.conn_err_no_slots_cnt++;
         return FD_QUIC_PARSE_FAIL; /* FIXME better error code? */
@@ -1582,6 +1605,13 @@ fd_quic_handle_v1_initial( fd_quic_t *               quic,
         metrics->conn_retry_cnt++;
       }
 
+      /* Make room for new conn, evicting an unstaked conn if needed */
+
+      if( FD_UNLIKELY( !fd_quic_conn_admit( quic, 1 ) ) ) {
+        quic->metrics.conn_err_no_slots_cnt++;
+        return FD_QUIC_PARSE_FAIL;
+      }
+
       /* Allocate new conn */
 
       conn = fd_quic_conn_create( quic,
@@ -1768,6 +1798,7 @@ fd_quic_handle_v1_initial( fd_quic_t *               quic,
   /* update last activity */
   conn->last_activity = state->now;
   conn->flags &= ~( FD_QUIC_CONN_FLAGS_PING_SENT | FD_QUIC_CONN_FLAGS_PING );
+  fd_quic_conn_lru_touch( state, conn );
 
   /* update expected packet number */
   do {
@@ -1934,6 +1965,7 @@ fd_quic_handle_v1_handshake(
   /* update last activity */
   conn->last_activity = fd_quic_get_state( quic )->now;
   conn->flags &= ~( FD_QUIC_CONN_FLAGS_PING_SENT | FD_QUIC_CONN_FLAGS_PING );
+  fd_quic_conn_lru_touch( fd_quic_get_state( quic ), conn );
 
   /* update expected packet number */
   do {
@@ -2132,7 +2164,17 @@ fd_quic_handle_v1_one_rtt( fd_quic_t *           quic,
     /* this decrypts the header */
     int server = conn->server;
 
-    if( FD_UNLIKELY(
+    /* was packet protection already removed by the receive batch? */
+    fd_quic_state_t * state = fd_quic_get_state( quic );
+    int pre_decrypted = state->rx_pre_ptr==cur_ptr;
+    state->rx_pre_ptr = NULL;
+    if( FD_UNLIKELY( pre_decrypted && !state->rx_pre_ok ) ) {
+      FD_DEBUG( FD_LOG_DEBUG(( "fd_quic_crypto_decrypt_batch failed" )) );
+      quic->metrics.conn_err_tls_fail_cnt++;
+      return FD_QUIC_PARSE_FAIL;
+    }
+
+    if( !pre_decrypted && FD_UNLIKELY(
           fd_quic_crypto_decrypt_hdr( cur_ptr, tot_sz,
                                       pn_offset,
                                       suite,
@@ -2175,6 +2217,19 @@ fd_quic_handle_v1_one_rtt( fd_quic_t *           quic,
     /* is current packet in the current key phase? */
     int current_key_phase = conn->key_phase == key_phase;
 
+    /* the batch derived the nonce and keys from the connection state at
+       the start of the burst.  If an earlier authenticated packet of the
+       same burst changed either, the payload was authenticated under the
+       wrong assumptions (sequential processing would have failed too).
+       Packets that failed authentication do not update the connection
+       state, so they cannot trigger this. */
+    if( FD_UNLIKELY( pre_decrypted &&
+                     ( ( pkt_number!=state->rx_pre_pkt_number ) | !current_key_phase ) ) ) {
+      FD_DEBUG( FD_LOG_DEBUG(( "stale batch decrypt" )) );
+      quic->metrics.conn_err_tls_fail_cnt++;
+      return FD_QUIC_PARSE_FAIL;
+    }
+
     /* is this a new request to change key_phase? */
     if( !current_key_phase && !conn->key_phase_upd ) {
       FD_DEBUG( FD_LOG_DEBUG(( "key update started" )); )
@@ -2218,7 +2273,7 @@ fd_quic_handle_v1_one_rtt( fd_quic_t *           quic,
                                                      : &conn->new_keys[!server];
 
     /* this decrypts the header and payload */
-    if( FD_UNLIKELY(
+    if( !pre_decrypted && FD_UNLIKELY(
           fd_quic_crypto_decrypt( cur_ptr, tot_sz,
                                   pn_offset,
                                   pkt_number,
@@ -2264,6 +2319,7 @@ fd_quic_handle_v1_one_rtt( fd_quic_t *           quic,
   /* update last activity */
   conn->last_activity = fd_quic_get_state( quic )->now;
   conn->flags &= ~( FD_QUIC_CONN_FLAGS_PING_SENT | FD_QUIC_CONN_FLAGS_PING );
+  fd_quic_conn_lru_touch( fd_quic_get_state( quic ), conn );
 
   /* update expected packet number */
   do {
@@ -2283,37 +2339,15 @@ fd_quic_schedule_conn( fd_quic_conn_t * conn ) {
 
   ulong             timeout = conn->next_service_time;
 
-  /* scheduled? */
+  /* scheduled? remove, then reinsert at new time */
   if( conn->in_service ) {
-    /* find conn in events, then remove, update, insert */
-    fd_quic_event_t * event     = NULL;
-    ulong             event_idx = 0;
-    ulong             cnt   = service_queue_cnt( state->service_queue );
-    for( ulong j = 0; j < cnt; ++j ) {
-      fd_quic_event_t * cur_event = state->service_queue + j;
-      if( cur_event->conn == conn ) {
-        event     = cur_event;
-        event_idx = j;
-        break;
-      }
-    }
-
-    if( FD_LIKELY( event ) ) {
-      /* remove key */
-      service_queue_remove( state->service_queue, event_idx );
-
-      /* TODO can use a priority queue key-reduce operation, which may be done more
-         quickly than remove, insert */
-    }
+    fd_quic_svc_wheel_remove( state->svc_wheel, &conn->svc );
   }
 
   timeout = fd_ulong_max( timeout, state->now + 1UL );
 
-  /* insert key */
-  fd_quic_event_t event[1] = {{ .timeout = timeout, .conn = conn }};
-  service_queue_insert( state->service_queue, event );
+  fd_quic_svc_wheel_insert( state->svc_wheel, &conn->svc, timeout );
 
-  conn->sched_service_time = timeout;
   conn->next_service_time  = timeout;
   conn->in_service         = 1;
 }
@@ -2348,31 +2382,10 @@ fd_quic_reschedule_conn( fd_quic_conn_t * conn,
     timeout = fd_ulong_min( timeout, conn->next_service_time );
 
     /* in the queue, but already scheduled sooner */
-    if( timeout >= conn->sched_service_time ) {
+    if( timeout >= conn->svc.timeout ) {
       return;
     }
 
-    /* find conn in events, then remove, update, insert */
-    fd_quic_event_t * event     = NULL;
-    ulong             event_idx = 0;
-    ulong             cnt   = service_queue_cnt( state->service_queue );
-    for( ulong j = 0; j < cnt; ++j ) {
-      fd_quic_event_t * cur_event = state->service_queue + j;
-      if( cur_event->conn == conn ) {
-        event     = cur_event;
-        event_idx = j;
-        break;
-      }
-    }
-
-    if( FD_LIKELY( event ) ) {
-      /* remove key */
-      service_queue_remove( state->service_queue, event_idx );
-
-      /* TODO can use a priority queue key-reduce operation, which may be done more
-         quickly than remove, insert */
-    }
-
     conn->next_service_time = timeout;
     fd_quic_schedule_conn( conn );
 
@@ -2981,6 +2994,177 @@ fd_quic_process_packet( fd_quic_t * quic,
 # undef DECODE_UINT32
 }
 
+/* fd_quic_rx_udp_payload locates the UDP payload of the Ethernet frame
+   data[0,data_sz).  Applies the same checks as fd_quic_process_packet.
+   Returns a pointer to the payload and sets *payload_sz on success.
+   Returns NULL if the frame is not a valid UDP/IPv4 datagram. */
+
+static uchar *
+fd_quic_rx_udp_payload( uchar * data,
+                        ulong   data_sz,
+                        ulong * payload_sz ) {
+
+  if( FD_UNLIKELY( data_sz > 0xffffu ) ) return NULL;
+
+  uchar * cur_ptr = data;
+  ulong   cur_sz  = data_sz;
+
+  fd_eth_hdr_t eth[1];
+  ulong rc = fd_quic_decode_eth( eth, cur_ptr, cur_sz );
+  if( FD_UNLIKELY( ( rc == FD_QUIC_PARSE_FAIL ) |
+                   ( eth->net_type != FD_ETH_HDR_TYPE_IP ) ) ) return NULL;
+  cur_ptr += rc;
+  cur_sz  -= rc;
+
+  fd_ip4_hdr_t ip4[1];
+  rc = fd_quic_decode_ip4( ip4, cur_ptr, cur_sz );
+  if( FD_UNLIKELY( ( rc == FD_QUIC_PARSE_FAIL ) |
+                   ( ip4->protocol != FD_IP4_HDR_PROTOCOL_UDP ) |
+                   ( ip4->net_tot_len > cur_sz ) ) ) return NULL;
+  cur_ptr += rc;
+  cur_sz  -= rc;
+
+  fd_udp_hdr_t udp[1];
+  rc = fd_quic_decode_udp( udp, cur_ptr, cur_sz );
+  if( FD_UNLIKELY( ( rc == FD_QUIC_PARSE_FAIL ) |
+                   ( udp->net_len > cur_sz ) ) ) return NULL;
+
+  *payload_sz = udp->net_len - rc;
+  return cur_ptr + rc;
+}
+
+/* fd_quic_rx_pre_t records the result of removing packet protection of
+   a received datagram ahead of time. */
+
+struct fd_quic_rx_pre {
+  uchar const * ptr;        /* short header packet, NULL if not done */
+  ulong         pkt_number; /* reconstructed packet number */
+  int           ok;         /* 1 if authenticated */
+};
+
+typedef struct fd_quic_rx_pre fd_quic_rx_pre_t;
+
+/* fd_quic_rx_batch_decrypt removes header and packet protection of the
+   1-RTT packets in batch[0,batch_cnt) (batch_cnt<=FD_QUIC_CRYPTO_BATCH_MAX)
+   using the batched crypto API.  This is the common case for TPU
+   traffic (one short header packet per datagram) and avoids the per-
+   packet AES key schedule and GHASH setup of fd_quic_crypto_decrypt.
+
+   Datagrams it cannot handle (long header packets, unknown connection,
+   no 1-RTT keys, key update in progress, ...) are left untouched and
+   take the regular path.  Packet numbers are reconstructed against the
+   expected packet number of the connection at the start of the burst,
+   never against other packets of the burst, which are unauthenticated
+   at that point.  fd_quic_handle_v1_one_rtt re-checks the packet number
+   once earlier packets were processed.  The result for batch[j] is
+   written to pre[j] and consumed by fd_quic_handle_v1_one_rtt. */
+
+static void
+fd_quic_rx_batch_decrypt( fd_quic_t *               quic,
+                          fd_aio_pkt_info_t const * batch,
+                          ulong                     batch_cnt,
+                          fd_quic_rx_pre_t *        pre ) {
+
+  fd_quic_state_t * state     = fd_quic_get_state( quic );
+  uint              enc_level = fd_quic_enc_level_appdata_id;
+  uint              pn_space  = fd_quic_enc_level_to_pn_space( enc_level );
+
+  /* find short header packets of known connections */
+
+  ulong                         idx   [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  fd_quic_conn_t *              conn  [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  fd_quic_crypto_batch_pkt_t    pkt   [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  uchar const *                 sample[ FD_QUIC_CRYPTO_BATCH_MAX ];
+  fd_quic_crypto_keys_t const * keys  [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  ulong                         cnt = 0UL;
+
+  for( ulong j=0UL; j<batch_cnt; j++ ) {
+    pre[j] = (fd_quic_rx_pre_t) { .ptr = NULL };
+
+    ulong   cur_sz  = 0UL;
+    uchar * cur_ptr = fd_quic_rx_udp_payload( batch[j].buf, batch[j].buf_sz, &cur_sz );
+    if( FD_UNLIKELY( !cur_ptr ) ) continue;
+
+    if( FD_UNLIKELY( ( cur_sz < FD_QUIC_SHORTEST_PKT ) |
+                     ( cur_sz > 1500                 ) |
+                     ( !!( cur_ptr[0] & 0x80u )      ) ) ) continue;
+
+    fd_quic_conn_id_t dst_conn_id = { 8u, {0}, {0} };
+    fd_memcpy( &dst_conn_id.conn_id, cur_ptr+1, FD_QUIC_CONN_ID_SZ );
+    fd_quic_conn_entry_t * entry = fd_quic_conn_map_query( state->conn_map, &dst_conn_id );
+    if( FD_UNLIKELY( !entry || !entry->conn->suites[ enc_level ] ) ) continue;
+
+    fd_quic_one_rtt_t one_rtt[1];
+    one_rtt->dst_conn_id_len = 8;
+    if( FD_UNLIKELY( fd_quic_decode_one_rtt( one_rtt, cur_ptr, cur_sz ) == FD_QUIC_PARSE_FAIL ) ) continue;
+
+    /* same checks as fd_quic_crypto_decrypt_hdr */
+    ulong pn_offset = one_rtt->pkt_num_pnoff;
+    if( FD_UNLIKELY( ( cur_sz < FD_QUIC_CRYPTO_TAG_SZ ) |
+                     ( pn_offset + 4UL + FD_QUIC_HP_SAMPLE_SZ > cur_sz ) ) ) continue;
+
+    fd_quic_conn_t * c = entry->conn;
+    idx   [cnt] = j;
+    conn  [cnt] = c;
+    keys  [cnt] = &c->keys[ enc_level ][ !c->server ];
+    sample[cnt] = cur_ptr + pn_offset + 4UL;
+    pkt   [cnt] = (fd_quic_crypto_batch_pkt_t) {
+      .buf            = cur_ptr,
+      .buf_sz         = cur_sz,
+      .pkt_number_off = pn_offset,
+      .keys           = keys[cnt]
+    };
+    cnt++;
+  }
+
+  if( FD_UNLIKELY( !cnt ) ) return;
+
+  /* remove header protection */
+
+  uchar mask[ FD_QUIC_CRYPTO_BATCH_MAX ][ 16 ];
+  fd_quic_crypto_hp_mask_batch( sample, keys, mask, cnt );
+
+  ulong dec_cnt = 0UL;
+  for( ulong i=0UL; i<cnt; i++ ) {
+    uchar * cur_ptr   = pkt[i].buf;
+    uint    first     = (uint)cur_ptr[0] ^ ( (uint)mask[i][0] & 0x1fu );
+    uint    key_phase = ( first >> 2u ) & 1u;
+
+    /* key update requested by peer, leave to regular path */
+    if( FD_UNLIKELY( key_phase != conn[i]->key_phase ) ) continue;
+
+    ulong pn_offset     = pkt[i].pkt_number_off;
+    ulong pkt_number_sz = ( first & 0x03u ) + 1u;
+    cur_ptr[0] = (uchar)first;
+    for( ulong k=0UL; k<pkt_number_sz; k++ ) cur_ptr[ pn_offset+k ] ^= mask[i][ 1UL+k ];
+
+    /* reconstruct against the connection state only.  Packets earlier
+       in the burst are not authenticated yet, so a forged one must not
+       move the expected packet number of the ones that follow. */
+    ulong pkt_number = fd_quic_parse_bits( cur_ptr + pn_offset, 0, 8u * pkt_number_sz );
+    fd_quic_reconstruct_pkt_num( &pkt_number, pkt_number_sz, conn[i]->exp_pkt_number[ pn_space ] );
+
+    /* compact in place (dec_cnt<=i) */
+    idx [dec_cnt]            = idx[i];
+    conn[dec_cnt]            = conn[i];
+    pkt [dec_cnt]            = pkt[i];
+    pkt [dec_cnt].pkt_number = pkt_number;
+    dec_cnt++;
+  }
+
+  /* remove packet protection */
+
+  ulong ok = fd_quic_crypto_decrypt_batch( pkt, dec_cnt );
+
+  for( ulong k=0UL; k<dec_cnt; k++ ) {
+    pre[ idx[k] ] = (fd_quic_rx_pre_t) {
+      .ptr        = pkt[k].buf,
+      .pkt_number = pkt[k].pkt_number,
+      .ok         = (int)( (ok>>k)&1UL )
+    };
+  }
+}
+
 /* main receive-side entry point */
 int
 fd_quic_aio_cb_receive( void *                    context,
@@ -3003,10 +3187,26 @@ fd_quic_aio_cb_receive( void *                    context,
 
   /* this aio interface is configured as one-packet per buffer
      so batch[0] refers to one buffer
-     as such, we simply forward each individual packet to a handling function */
-  for( ulong j = 0; j < batch_cnt; ++j ) {
-    fd_quic_process_packet( quic, batch[ j ].buf, batch[ j ].buf_sz );
-    quic->metrics.net_rx_byte_cnt += batch[ j ].buf_sz;
+     as such, we simply forward each individual packet to a handling function.
+     Bursts first have their 1-RTT packet protection removed in batches */
+  fd_quic_rx_pre_t pre[ FD_QUIC_CRYPTO_BATCH_MAX ];
+  for( ulong j0 = 0; j0 < batch_cnt; j0 += FD_QUIC_CRYPTO_BATCH_MAX ) {
+    ulong chunk_cnt = fd_ulong_min( batch_cnt - j0, FD_QUIC_CRYPTO_BATCH_MAX );
+    if( chunk_cnt > 1UL ) {
+      fd_quic_rx_batch_decrypt( quic, batch + j0, chunk_cnt, pre );
+    } else {
+      pre[0] = (fd_quic_rx_pre_t) { .ptr = NULL };
+    }
+
+    for( ulong k = 0; k < chunk_cnt; ++k ) {
+      fd_aio_pkt_info_t const * pkt = batch + j0 + k;
+      state->rx_pre_ptr        = pre[k].ptr;
+      state->rx_pre_pkt_number = pre[k].pkt_number;
+      state->rx_pre_ok         = pre[k].ok;
+      fd_quic_process_packet( quic, pkt->buf, pkt->buf_sz );
+      state->rx_pre_ptr        = NULL;
+      quic->metrics.net_rx_byte_cnt += pkt->buf_sz;
+    }
   }
 
   /* the assumption here at present is that any packet that could not be processed
@@ -3259,7 +3459,6 @@ fd_quic_tls_cb_peer_params( void *        context,
 void
 fd_quic_tls_cb_handshake_complete( fd_quic_tls_hs_t * hs,
                                    void *             context ) {
-  (void)hs;
   fd_quic_conn_t * conn = (fd_quic_conn_t*)context;
 
   /* need to send quic handshake completion */
@@ -3279,6 +3478,11 @@ fd_quic_tls_cb_handshake_complete( fd_quic_tls_hs_t * hs,
       conn->handshake_complete = 1;
       conn->state              = FD_QUIC_CONN_STATE_HANDSHAKE_COMPLETE;
 
+      /* remember peer identity, hs is freed once the conn is active */
+      fd_memcpy( conn->peer_pubkey,
+                 conn->server ? hs->hs.srv.client_pubkey : hs->hs.cli.server_pubkey,
+                 32UL );
+
       fd_quic_limits_t * limits = &conn->quic->limits;
       if( conn->server ) {
         /* other stream types (0x00 and 0x02) use set_max_streams */
@@ -3395,23 +3599,14 @@ fd_quic_service( fd_quic_t * quic ) {
 
   /* service events */
   fd_quic_conn_t * conn = NULL;
-  while( service_queue_cnt( state->service_queue ) ) {
-    fd_quic_event_t * event = &state->service_queue[0];
-
-    /* copy before removing event */
-    conn = event->conn;
-
-    ulong service_time = event->timeout;
-    if( now < service_time ) {
-      break;
-    }
+  fd_quic_svc_node_t * node = NULL;
+  while( ( node = fd_quic_svc_wheel_pop( state->svc_wheel, now ) ) ) {
+    /* node was removed from the wheel, later reinserted at new time */
+    conn = fd_quic_svc_conn( node );
 
     /* set an initial next_service_time */
     conn->next_service_time = now + fd_quic_get_service_interval( quic );
 
-    /* remove event, later reinserted at new time */
-    service_queue_remove_min( state->service_queue );
-
     /* unset "in service queue" */
     conn->in_service = 0;
 
@@ -4816,9 +5011,12 @@ fd_quic_conn_service( fd_quic_t * quic, fd_quic_conn_t * conn, ulong now ) {
             /* move straight to ACTIVE */
             conn->state = FD_QUIC_CONN_STATE_ACTIVE;
 
-            /* user callback */
+            /* user callback, may mark the conn staked */
             fd_quic_cb_conn_new( quic, conn );
 
+            /* established unstaked conns become eligible for eviction */
+            if( !conn->staked ) fd_quic_conn_lru_insert( fd_quic_get_state( quic ), conn );
+
             /* clear out hs_data here, as we don't need it anymore */
             fd_quic_tls_hs_data_t * hs_data = NULL;
 
@@ -4922,11 +5120,19 @@ fd_quic_conn_free( fd_quic_t *      quic,
     }
   }
 
-  /* no need to remove this connection from the events queue
-     free is called from two places:
-       fini    - service will never be called again. All events are destroyed
-       service - removes event before calling free. Event only allowed to be
-       enqueued once */
+  /* remove from the service wheel
+     free is called from three places:
+       fini    - service will never be called again
+       service - conn was popped from the wheel before calling free
+       admit   - evicted conn may still be scheduled */
+  if( conn->in_service ) {
+    fd_quic_svc_wheel_remove( state->svc_wheel, &conn->svc );
+    conn->in_service = 0;
+  }
+
+  /* remove from unstaked accounting */
+  fd_quic_conn_lru_remove( state, conn );
+  if( conn->server && !conn->staked ) state->unstaked_conn_cnt--;
 
   /* remove all stream ids from map, and free stream */
 
@@ -5202,7 +5408,6 @@ fd_quic_conn_create( fd_quic_t *               quic,
   }
 
   conn->next_service_time   = state->now;
-  conn->sched_service_time  = ~0UL;
 
   /* immediately schedule it */
   fd_quic_schedule_conn( conn );
@@ -5346,6 +5551,12 @@ fd_quic_conn_create( fd_quic_t *               quic,
   conn->rx_initial_max_stream_data_bidi_local  = our_tp->initial_max_stream_data_bidi_local;
   conn->rx_initial_max_stream_data_bidi_remote = our_tp->initial_max_stream_data_bidi_remote;
 
+  /* conns start out unstaked, until marked otherwise by the user */
+  conn->staked = 0;
+  conn->in_lru = 0;
+  conn->lru_prev = conn->lru_next = NULL;
+  if( conn->server ) state->unstaked_conn_cnt++;
+
   /* update metrics */
   quic->metrics.conn_active_cnt++;
   quic->metrics.conn_created_cnt++;
@@ -5363,12 +5574,7 @@ fd_quic_get_next_wakeup( fd_quic_t * quic ) {
     return state->now;
   }
 
-  ulong t = ~(ulong)0;
-  if( service_queue_cnt( state->service_queue ) ) {
-    t = state->service_queue[0].timeout;
-  }
-
-  return t;
+  return fd_quic_svc_wheel_min( state->svc_wheel );
 }
 
 /* frame handling function default definitions */
@@ -159,6 +159,18 @@ struct __attribute__((aligned(16UL))) fd_quic_config {
    /* retry: whether address validation using retry packets is enabled (RFC 9000, Section 8.1.2) */
   int retry;
 
+  /* conn_reserved_cnt: number of conn slots reserved for staked peers
+     (server only).  Conns that are still handshaking or that were not
+     marked staked (fd_quic_conn_set_staked) share the remaining
+     limits.conn_cnt-conn_reserved_cnt slots. */
+  ulong conn_reserved_cnt;
+
+  /* conn_evict: if non-zero, a new conn that finds no slot available
+     evicts the least recently active established unstaked conn instead
+     of being rejected (server only).  Ignored unless retry is enabled,
+     as eviction is only done on behalf of address-validated peers. */
+  int conn_evict;
+
   /* TLS config ********************************************/
 
   /* identity_key: Ed25519 public key of node identity */
@@ -330,6 +342,7 @@ union fd_quic_metrics {
     ulong conn_aborted_cnt;        /* number of conns aborted */
     ulong conn_retry_cnt;          /* number of conns established with retry */
     ulong conn_err_no_slots_cnt;   /* number of conns that failed to create due to lack of slots */
+    ulong conn_evicted_cnt;        /* number of unstaked conns evicted to admit a new conn */
     ulong conn_err_tls_fail_cnt;   /* number of conns that aborted due to TLS failure */
     ulong conn_err_retry_fail_cnt; /* number of conns that failed during retry (e.g. invalid token) */
 
@@ -261,6 +261,22 @@ fd_quic_conn_get_max_streams( fd_quic_conn_t * conn, uint dirtype ) {
   return conn->max_concur_streams[type];
 }
 
+FD_QUIC_API void
+fd_quic_conn_set_staked( fd_quic_conn_t * conn, int staked ) {
+  staked = !!staked;
+  if( !conn->server || (int)conn->staked==staked ) return;
+
+  fd_quic_state_t * state = fd_quic_get_state( conn->quic );
+  conn->staked = (uint)staked & 1U;
+  if( staked ) {
+    fd_quic_conn_lru_remove( state, conn );
+    state->unstaked_conn_cnt--;
+  } else {
+    state->unstaked_conn_cnt++;
+    if( conn->state==FD_QUIC_CONN_STATE_ACTIVE ) fd_quic_conn_lru_insert( state, conn );
+  }
+}
+
 /* update the tree weight
    called whenever weight may have changed */
 void
@@ -7,6 +7,7 @@
 #include "crypto/fd_quic_crypto_suites.h"
 #include "templ/fd_quic_transport_params.h"
 #include "fd_quic_pkt_meta.h"
+#include "fd_quic_svc_wheel.h"
 #include "templ/fd_quic_union.h"
 
 #define FD_QUIC_CONN_STATE_INVALID            0 /* dead object / freed */
@@ -82,12 +83,23 @@ struct fd_quic_conn {
   uint               established : 1;     /* used by clients to determine whether to
                                              switch the destination conn id used */
   uint               transport_params_set : 1;
+  uint               staked      : 1;     /* peer was marked staked via fd_quic_conn_set_staked */
+  uint               in_lru      : 1;     /* whether the conn is in the unstaked conn LRU list */
 
   uint               version;             /* QUIC version of the connection */
 
   ulong              next_service_time;   /* time service should be called next */
-  ulong              sched_service_time;  /* time service is scheduled for, if in_service=1 */
-  int                in_service;          /* whether the conn is in the service queue */
+  fd_quic_svc_node_t svc;                 /* service wheel entry, svc.timeout is the
+                                             time service is scheduled for, if in_service=1 */
+  int                in_service;          /* whether the conn is in the service wheel */
+
+  /* unstaked conn LRU list (server only), least recently active first */
+  fd_quic_conn_t *   lru_prev;
+  fd_quic_conn_t *   lru_next;
+
+  /* Ed25519 identity key of the peer from its TLS certificate, valid
+     once handshake_complete is set */
+  uchar              peer_pubkey[ 32 ];
   uchar              called_conn_new;     /* whether we need to call conn_final on teardown */
 
   /* we can have multiple connection ids */
@@ -381,6 +393,22 @@ FD_QUIC_API ulong
 fd_quic_conn_get_max_streams( fd_quic_conn_t * conn, uint type );
 
 
+/* fd_quic_conn_peer_pubkey returns the peer's Ed25519 identity key as
+   presented in its TLS certificate.  Returns NULL if the handshake has
+   not completed yet. */
+FD_FN_PURE static inline uchar const *
+fd_quic_conn_peer_pubkey( fd_quic_conn_t const * conn ) {
+  return conn->handshake_complete ? conn->peer_pubkey : NULL;
+}
+
+/* fd_quic_conn_set_staked marks a server conn as belonging to a staked
+   (staked!=0) or unstaked peer.  Conns start out unstaked.  Staked
+   conns may use the slots reserved via config.conn_reserved_cnt and
+   are never evicted to admit new conns.  CB-safe, typically called
+   from the conn_new callback. */
+FD_QUIC_API void
+fd_quic_conn_set_staked( fd_quic_conn_t * conn, int staked );
+
 /* update the tree weight
    called whenever weight may have changed */
 void
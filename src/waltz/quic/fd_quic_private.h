@@ -9,6 +9,7 @@
 #include "crypto/fd_quic_crypto_suites.h"
 #include "tls/fd_quic_tls.h"
 #include "fd_quic_stream_pool.h"
+#include "fd_quic_svc_wheel.h"
 
 #include "../../util/net/fd_eth.h"
 #include "../../util/net/fd_ip4.h"
@@ -36,15 +37,6 @@ enum {
 
 #define FD_QUIC_MAGIC (0xdadf8cfa01cc5460UL)
 
-/* events for time based processing */
-struct fd_quic_event {
-  ulong            timeout;
-
-  fd_quic_conn_t * conn; /* connection or NULL */
-  /* possibly "type", etc., for other kinds of service */
-};
-typedef struct fd_quic_event fd_quic_event_t;
-
 /* structure for a cummulative summation tree */
 struct fd_quic_cs_tree {
   ulong cnt;
@@ -84,7 +76,13 @@ struct __attribute__((aligned(16UL))) fd_quic_state_private {
   fd_quic_conn_t *        conns;          /* free list of unused connections */
   ulong                   free_conns;     /* count of free connections */
   fd_quic_conn_map_t *    conn_map;       /* map connection ids -> connection */
-  fd_quic_event_t *       service_queue;  /* priority queue of connections by service time */
+  fd_quic_svc_wheel_t *   svc_wheel;      /* timing wheel of connections by service time */
+
+  /* unstaked server conns: count (including conns still handshaking)
+     and LRU list of established ones, least recently active first */
+  ulong                   unstaked_conn_cnt;
+  fd_quic_conn_t *        lru_head;
+  fd_quic_conn_t *        lru_tail;
   fd_quic_stream_pool_t * stream_pool;    /* stream pool */
 
   fd_quic_cs_tree_t *     cs_tree;        /* cummulative summation tree */
@@ -117,6 +115,15 @@ struct __attribute__((aligned(16UL))) fd_quic_state_private {
 
   /* Scratch space for packet protection */
   uchar                   crypt_scratch[FD_QUIC_MTU];
+
+  /* Receive burst state (see fd_quic_rx_batch_decrypt).  rx_pre_ptr
+     points to the short header packet about to be processed if its
+     protection was already removed as part of a batch, NULL otherwise.
+     rx_pre_ok is 1 if the batch authenticated it and rx_pre_pkt_number
+     is the packet number its nonce was derived from. */
+  uchar const *           rx_pre_ptr;
+  ulong                   rx_pre_pkt_number;
+  int                     rx_pre_ok;
 };
 
 /* FD_QUIC_STATE_OFF is the offset of fd_quic_state_t within fd_quic_t. */
@@ -174,6 +181,53 @@ ulong
 fd_quic_get_service_interval( fd_quic_t * quic );
 
 
+/* fd_quic_svc_conn returns the connection containing the given
+   service wheel node */
+static inline fd_quic_conn_t *
+fd_quic_svc_conn( fd_quic_svc_node_t * node ) {
+  return (fd_quic_conn_t *)( (ulong)node - offsetof( fd_quic_conn_t, svc ) );
+}
+
+/* Unstaked conn LRU list *********************************************/
+
+/* fd_quic_conn_lru_insert appends conn to the tail (most recently
+   active end) of the unstaked conn LRU list.  conn must not be in the
+   list. */
+static inline void
+fd_quic_conn_lru_insert( fd_quic_state_t * state,
+                         fd_quic_conn_t *  conn ) {
+  conn->lru_prev = state->lru_tail;
+  conn->lru_next = NULL;
+  if( state->lru_tail ) state->lru_tail->lru_next = conn;
+  else                  state->lru_head           = conn;
+  state->lru_tail = conn;
+  conn->in_lru    = 1;
+}
+
+/* fd_quic_conn_lru_remove unlinks conn from the unstaked conn LRU
+   list.  No-op if conn is not in the list. */
+static inline void
+fd_quic_conn_lru_remove( fd_quic_state_t * state,
+                         fd_quic_conn_t *  conn ) {
+  if( !conn->in_lru ) return;
+  if( conn->lru_prev ) conn->lru_prev->lru_next = conn->lru_next;
+  else                 state->lru_head          = conn->lru_next;
+  if( conn->lru_next ) conn->lru_next->lru_prev = conn->lru_prev;
+  else                 state->lru_tail          = conn->lru_prev;
+  conn->lru_prev = conn->lru_next = NULL;
+  conn->in_lru   = 0;
+}
+
+/* fd_quic_conn_lru_touch marks conn as most recently active.  Called
+   on every received packet. */
+static inline void
+fd_quic_conn_lru_touch( fd_quic_state_t * state,
+                        fd_quic_conn_t *  conn ) {
+  if( !conn->in_lru || state->lru_tail==conn ) return;
+  fd_quic_conn_lru_remove( state, conn );
+  fd_quic_conn_lru_insert( state, conn );
+}
+
 /* reschedule a connection */
 void
 fd_quic_reschedule_conn( fd_quic_conn_t * conn,
@@ -0,0 +1,161 @@
+#include "fd_quic_svc_wheel.h"
+
+#define TICK_LG  FD_QUIC_SVC_WHEEL_TICK_LG
+#define SLOT_LG  FD_QUIC_SVC_WHEEL_SLOT_LG
+#define SLOT_CNT FD_QUIC_SVC_WHEEL_SLOT_CNT
+#define LVL_CNT  FD_QUIC_SVC_WHEEL_LVL_CNT
+
+fd_quic_svc_wheel_t *
+fd_quic_svc_wheel_new( void * mem,
+                       ulong  now ) {
+  fd_quic_svc_wheel_t * wheel = (fd_quic_svc_wheel_t *)mem;
+  memset( wheel, 0, sizeof(fd_quic_svc_wheel_t) );
+  wheel->cur = now >> TICK_LG;
+  return wheel;
+}
+
+/* fd_quic_svc_wheel_link adds node to the slot for tick relative to
+   the current tick.  Requires tick>=wheel->cur. */
+
+static inline void
+fd_quic_svc_wheel_link( fd_quic_svc_wheel_t * wheel,
+                        fd_quic_svc_node_t *  node,
+                        ulong                 tick ) {
+  ulong diff = tick ^ wheel->cur;
+  ulong lvl  = diff ? (ulong)fd_ulong_find_msb( diff ) / SLOT_LG : 0UL;
+  ulong idx  = ( tick >> ( lvl*SLOT_LG ) ) & ( SLOT_CNT-1UL );
+
+  fd_quic_svc_node_t ** head = &wheel->slot[ lvl ][ idx ];
+  node->prev = NULL;
+  node->next = *head;
+  node->slot = lvl*SLOT_CNT + idx;
+  if( *head ) (*head)->prev = node;
+  *head = node;
+
+  wheel->occupied[ lvl ] |= 1UL<<idx;
+}
+
+static inline void
+fd_quic_svc_wheel_unlink( fd_quic_svc_wheel_t * wheel,
+                          fd_quic_svc_node_t *  node ) {
+  ulong lvl = node->slot / SLOT_CNT;
+  ulong idx = node->slot % SLOT_CNT;
+
+  if( node->next ) node->next->prev = node->prev;
+  if( node->prev ) {
+    node->prev->next = node->next;
+  } else {
+    wheel->slot[ lvl ][ idx ] = node->next;
+    if( !node->next ) wheel->occupied[ lvl ] &= ~(1UL<<idx);
+  }
+  node->prev = NULL;
+  node->next = NULL;
+}
+
+void
+fd_quic_svc_wheel_insert( fd_quic_svc_wheel_t * wheel,
+                          fd_quic_svc_node_t *  node,
+                          ulong                 timeout ) {
+  node->timeout = timeout;
+  fd_quic_svc_wheel_link( wheel, node, fd_ulong_max( timeout >> TICK_LG, wheel->cur ) );
+  wheel->cnt++;
+}
+
+void
+fd_quic_svc_wheel_remove( fd_quic_svc_wheel_t * wheel,
+                          fd_quic_svc_node_t *  node ) {
+  fd_quic_svc_wheel_unlink( wheel, node );
+  wheel->cnt--;
+}
+
+/* fd_quic_svc_wheel_first finds the earliest non-empty slot.  Returns
+   its level, or LVL_CNT if the wheel is empty. */
+
+static inline ulong
+fd_quic_svc_wheel_first( fd_quic_svc_wheel_t const * wheel,
+                         ulong *                     idx ) {
+  for( ulong lvl=0UL; lvl<LVL_CNT; lvl++ ) {
+    if( wheel->occupied[ lvl ] ) {
+      *idx = (ulong)fd_ulong_find_lsb( wheel->occupied[ lvl ] );
+      return lvl;
+    }
+  }
+  return LVL_CNT;
+}
+
+/* fd_quic_svc_wheel_slot_tick returns the first tick covered by slot
+   idx of level lvl. */
+
+static inline ulong
+fd_quic_svc_wheel_slot_tick( fd_quic_svc_wheel_t const * wheel,
+                             ulong                       lvl,
+                             ulong                       idx ) {
+  ulong shift = lvl*SLOT_LG;
+  ulong hi    = shift+SLOT_LG<64UL ? ( wheel->cur >> ( shift+SLOT_LG ) ) << ( shift+SLOT_LG ) : 0UL;
+  return hi | ( idx << shift );
+}
+
+fd_quic_svc_node_t *
+fd_quic_svc_wheel_pop( fd_quic_svc_wheel_t * wheel,
+                       ulong                 now ) {
+  ulong now_tick = now >> TICK_LG;
+
+  for(;;) {
+    ulong idx;
+    ulong lvl = fd_quic_svc_wheel_first( wheel, &idx );
+    if( FD_UNLIKELY( lvl==LVL_CNT ) ) return NULL;
+
+    ulong tick = fd_quic_svc_wheel_slot_tick( wheel, lvl, idx );
+    if( tick > now_tick ) return NULL;
+
+    /* Advance to the start of the earliest slot.  No node is scheduled
+       before it, so this does not skip anything. */
+    wheel->cur = tick;
+
+    fd_quic_svc_node_t * node = wheel->slot[ lvl ][ idx ];
+
+    if( lvl ) {
+      /* Cascade: redistribute the slot among lower levels */
+      wheel->slot[ lvl ][ idx ] = NULL;
+      wheel->occupied[ lvl ] &= ~(1UL<<idx);
+      while( node ) {
+        fd_quic_svc_node_t * next = node->next;
+        fd_quic_svc_wheel_link( wheel, node, fd_ulong_max( node->timeout >> TICK_LG, tick ) );
+        node = next;
+      }
+      continue;
+    }
+
+    /* Level 0 slots hold a single tick.  If that tick is in the past,
+       all of its nodes are due.  Otherwise find one that is. */
+    if( tick < now_tick ) {
+      fd_quic_svc_wheel_remove( wheel, node );
+      return node;
+    }
+    for( ; node; node=node->next ) {
+      if( node->timeout <= now ) {
+        fd_quic_svc_wheel_remove( wheel, node );
+        return node;
+      }
+    }
+    return NULL;
+  }
+}
+
+ulong
+fd_quic_svc_wheel_min( fd_quic_svc_wheel_t const * wheel ) {
+  ulong idx;
+  ulong lvl = fd_quic_svc_wheel_first( wheel, &idx );
+  if( FD_UNLIKELY( lvl==LVL_CNT ) ) return ULONG_MAX;
+
+  ulong min = ULONG_MAX;
+  for( fd_quic_svc_node_t const * node = wheel->slot[ lvl ][ idx ]; node; node=node->next ) {
+    min = fd_ulong_min( min, node->timeout );
+  }
+  return min;
+}
+
+#undef LVL_CNT
+#undef SLOT_CNT
+#undef SLOT_LG
+#undef TICK_LG
@@ -0,0 +1,122 @@
+#ifndef HEADER_fd_src_waltz_quic_fd_quic_svc_wheel_h
+#define HEADER_fd_src_waltz_quic_fd_quic_svc_wheel_h
+
+#include "../../util/bits/fd_bits.h"
+
+/* fd_quic_svc_wheel is a hierarchical timing wheel used to schedule
+   connection service.  It replaces a binary heap keyed by service time,
+   making schedule, reschedule and cancel O(1) (the heap was O(log n)
+   and rescheduling additionally required a linear search for the
+   connection's heap entry).
+
+   Time is divided into ticks of 2^FD_QUIC_SVC_WHEEL_TICK_LG ns.  The
+   wheel has FD_QUIC_SVC_WHEEL_LVL_CNT levels with 64 slots each.  A
+   node due at tick t is placed at the level of the most significant
+   6-bit group in which t differs from the wheel's current tick, so
+   level 0 holds nodes due within the current 64 tick window, level 1
+   within the current 4096 tick window, etc.  When the current tick
+   advances into the range of a higher level slot, that slot is
+   cascaded (its nodes re-inserted at lower levels).  Each node is
+   cascaded at most LVL_CNT times.  A per-level occupancy bit mask finds
+   the earliest non-empty slot in O(1).
+
+   Nodes are due in tick order.  Nodes due within the same tick are
+   popped in unspecified order.  No node is ever popped before its
+   timeout.
+
+   Nodes are intrusive (embedded in fd_quic_conn_t). */
+
+#define FD_QUIC_SVC_WHEEL_ALIGN    (64UL)
+#define FD_QUIC_SVC_WHEEL_TICK_LG  (10)    /* 1 tick = 1024 ns */
+#define FD_QUIC_SVC_WHEEL_SLOT_LG  (6)
+#define FD_QUIC_SVC_WHEEL_SLOT_CNT (64UL)
+#define FD_QUIC_SVC_WHEEL_LVL_CNT  (9UL)   /* covers all 64-TICK_LG tick bits */
+
+FD_STATIC_ASSERT( FD_QUIC_SVC_WHEEL_LVL_CNT*FD_QUIC_SVC_WHEEL_SLOT_LG >= 64UL-FD_QUIC_SVC_WHEEL_TICK_LG, svc_wheel );
+
+/* fd_quic_svc_node_t is a wheel entry */
+
+struct fd_quic_svc_node {
+  struct fd_quic_svc_node * prev;
+  struct fd_quic_svc_node * next;
+  ulong                     timeout; /* scheduled time in ns */
+  ulong                     slot;    /* level*SLOT_CNT + slot index */
+};
+
+typedef struct fd_quic_svc_node fd_quic_svc_node_t;
+
+struct __attribute__((aligned(FD_QUIC_SVC_WHEEL_ALIGN))) fd_quic_svc_wheel {
+  ulong                cur;  /* current tick, all nodes are due at or after */
+  ulong                cnt;  /* number of nodes in wheel */
+  ulong                occupied[ FD_QUIC_SVC_WHEEL_LVL_CNT ];
+  fd_quic_svc_node_t * slot    [ FD_QUIC_SVC_WHEEL_LVL_CNT ][ FD_QUIC_SVC_WHEEL_SLOT_CNT ];
+};
+
+typedef struct fd_quic_svc_wheel fd_quic_svc_wheel_t;
+
+FD_PROTOTYPES_BEGIN
+
+FD_FN_CONST static inline ulong
+fd_quic_svc_wheel_align( void ) {
+  return FD_QUIC_SVC_WHEEL_ALIGN;
+}
+
+FD_FN_CONST static inline ulong
+fd_quic_svc_wheel_footprint( void ) {
+  return sizeof(fd_quic_svc_wheel_t);
+}
+
+/* fd_quic_svc_wheel_new initializes an empty wheel in mem, starting at
+   time now (ns).  Returns mem as an fd_quic_svc_wheel_t. */
+
+fd_quic_svc_wheel_t *
+fd_quic_svc_wheel_new( void * mem,
+                       ulong  now );
+
+static inline void *
+fd_quic_svc_wheel_delete( fd_quic_svc_wheel_t * wheel ) {
+  return (void *)wheel;
+}
+
+/* fd_quic_svc_wheel_cnt returns the number of scheduled nodes */
+
+FD_FN_PURE static inline ulong
+fd_quic_svc_wheel_cnt( fd_quic_svc_wheel_t const * wheel ) {
+  return wheel->cnt;
+}
+
+/* fd_quic_svc_wheel_insert schedules node at time timeout (ns).  node
+   must not currently be in the wheel.  timeout may be in the past, in
+   which case the node is due immediately. */
+
+void
+fd_quic_svc_wheel_insert( fd_quic_svc_wheel_t * wheel,
+                          fd_quic_svc_node_t *  node,
+                          ulong                 timeout );
+
+/* fd_quic_svc_wheel_remove unschedules node.  node must currently be
+   in the wheel. */
+
+void
+fd_quic_svc_wheel_remove( fd_quic_svc_wheel_t * wheel,
+                          fd_quic_svc_node_t *  node );
+
+/* fd_quic_svc_wheel_pop removes and returns a node with timeout<=now.
+   Returns NULL if no node is due.  Repeated calls return nodes in
+   non-decreasing tick order.  now should not go backwards between
+   calls. */
+
+fd_quic_svc_node_t *
+fd_quic_svc_wheel_pop( fd_quic_svc_wheel_t * wheel,
+                       ulong                 now );
+
+/* fd_quic_svc_wheel_min returns the earliest timeout in the wheel, or
+   ULONG_MAX if the wheel is empty.  This scans the earliest non-empty
+   slot. */
+
+FD_FN_PURE ulong
+fd_quic_svc_wheel_min( fd_quic_svc_wheel_t const * wheel );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_waltz_quic_fd_quic_svc_wheel_h */
@@ -118,6 +118,124 @@ test_secret_gen( uchar const * expected_output,
   FD_TEST( 0==memcmp( new_secret, expected_output, output_sz ) );
 }
 
+/* test_decrypt_batch checks that batched removal of packet protection
+   matches fd_quic_crypto_decrypt{_hdr} for a burst of 1-RTT packets of
+   different connections, and compares their throughput. */
+
+#define BATCH_PKT_MAX (1500UL)
+
+static void
+test_decrypt_batch( fd_quic_crypto_suite_t const * suite,
+                    fd_quic_crypto_keys_t const *  base_keys,
+                    fd_rng_t *                     rng,
+                    ulong                          payload_sz_max ) {
+
+  ulong const cnt       = FD_QUIC_CRYPTO_BATCH_MAX;
+  ulong const pn_offset = 1UL + FD_QUIC_CONN_ID_SZ;
+
+  static fd_quic_crypto_keys_t keys[ FD_QUIC_CRYPTO_BATCH_MAX ];
+  static uchar  cipher[ FD_QUIC_CRYPTO_BATCH_MAX ][ BATCH_PKT_MAX ];
+  static uchar  single[ FD_QUIC_CRYPTO_BATCH_MAX ][ BATCH_PKT_MAX ];
+  static uchar  batch [ FD_QUIC_CRYPTO_BATCH_MAX ][ BATCH_PKT_MAX ];
+  ulong         sz    [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  ulong         pn    [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  ulong         tot_sz = 0UL;
+
+  for( ulong j=0UL; j<cnt; j++ ) {
+    /* per-connection keys */
+    keys[j] = *base_keys;
+    keys[j].pkt_key[0] ^= (uchar)j;
+    keys[j].iv     [1] ^= (uchar)j;
+    keys[j].hp_key [2] ^= (uchar)j;
+
+    /* short header: flags, dst conn id, 2 byte packet number */
+    uchar hdr[ 1UL + FD_QUIC_CONN_ID_SZ + 2UL ];
+    hdr[0] = 0x41;
+    for( ulong k=1UL; k<sizeof(hdr); k++ ) hdr[k] = fd_rng_uchar( rng );
+    pn[j] = fd_ulong_load_2_fast( hdr+pn_offset );
+    pn[j] = (ulong)fd_ushort_bswap( (ushort)pn[j] );
+
+    uchar payload[ BATCH_PKT_MAX ];
+    ulong payload_sz = 20UL + fd_rng_ulong_roll( rng, payload_sz_max-20UL+1UL );
+    for( ulong k=0UL; k<payload_sz; k++ ) payload[k] = fd_rng_uchar( rng );
+
+    sz[j] = BATCH_PKT_MAX;
+    FD_TEST( fd_quic_crypto_encrypt( cipher[j], &sz[j], hdr, sizeof(hdr), payload, payload_sz,
+                                     suite, &keys[j], &keys[j], pn[j] )==FD_QUIC_SUCCESS );
+    tot_sz += sz[j];
+  }
+
+  /* Corrupt one packet */
+  cipher[7][ sz[7]-1UL ] ^= 0x10;
+
+  uchar const *                 sample  [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  fd_quic_crypto_keys_t const * keys_ptr[ FD_QUIC_CRYPTO_BATCH_MAX ];
+  fd_quic_crypto_batch_pkt_t    pkt     [ FD_QUIC_CRYPTO_BATCH_MAX ];
+  uchar                         mask    [ FD_QUIC_CRYPTO_BATCH_MAX ][ 16 ];
+
+# define DECRYPT_SINGLE do {                                                          \
+    for( ulong j=0UL; j<cnt; j++ ) {                                                  \
+      fd_memcpy( single[j], cipher[j], sz[j] );                                       \
+      FD_TEST( fd_quic_crypto_decrypt_hdr( single[j], sz[j], pn_offset,               \
+                                           suite, &keys[j] )==FD_QUIC_SUCCESS );      \
+      ok_single |= (ulong)( fd_quic_crypto_decrypt( single[j], sz[j], pn_offset,      \
+                                                    pn[j], suite, &keys[j] )          \
+                            ==FD_QUIC_SUCCESS ) << j;                                 \
+    }                                                                                 \
+  } while(0)
+
+# define DECRYPT_BATCH do {                                                           \
+    for( ulong j=0UL; j<cnt; j++ ) {                                                  \
+      fd_memcpy( batch[j], cipher[j], sz[j] );                                        \
+      sample  [j] = batch[j] + pn_offset + 4UL;                                       \
+      keys_ptr[j] = &keys[j];                                                         \
+    }                                                                                 \
+    fd_quic_crypto_hp_mask_batch( sample, keys_ptr, mask, cnt );                      \
+    for( ulong j=0UL; j<cnt; j++ ) {                                                  \
+      batch[j][0] ^= (uchar)( mask[j][0] & 0x1fu );                                   \
+      ulong pn_sz = ( batch[j][0] & 0x03u ) + 1UL;                                    \
+      for( ulong k=0UL; k<pn_sz; k++ ) batch[j][ pn_offset+k ] ^= mask[j][ 1UL+k ];   \
+      pkt[j] = (fd_quic_crypto_batch_pkt_t) {                                         \
+        .buf = batch[j], .buf_sz = sz[j], .pkt_number_off = pn_offset,                \
+        .pkt_number = pn[j], .keys = &keys[j] };                                      \
+    }                                                                                 \
+    ok_batch = fd_quic_crypto_decrypt_batch( pkt, cnt );                              \
+  } while(0)
+
+  ulong ok_single = 0UL;
+  ulong ok_batch  = 0UL;
+  DECRYPT_SINGLE;
+  DECRYPT_BATCH;
+
+  FD_TEST( ok_single==( ~0UL & ~(1UL<<7) ) );
+  FD_TEST( ok_batch ==ok_single );
+  for( ulong j=0UL; j<cnt; j++ ) {
+    if( !( (ok_single>>j)&1UL ) ) continue;
+    FD_TEST( 0==memcmp( single[j], batch[j], sz[j]-FD_QUIC_CRYPTO_TAG_SZ ) );
+  }
+
+  /* Throughput (includes copying the ciphertext) */
+
+  ulong iter_cnt = 2048UL;
+  long  dt_single = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) { DECRYPT_SINGLE; FD_COMPILER_FORGET( ok_single ); }
+  dt_single += fd_log_wallclock();
+
+  long  dt_batch = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) { DECRYPT_BATCH; FD_COMPILER_FORGET( ok_batch ); }
+  dt_batch += fd_log_wallclock();
+
+# undef DECRYPT_BATCH
+# undef DECRYPT_SINGLE
+
+  double pkt_tot = (double)( iter_cnt*cnt );
+  double bit_tot = 8.*(double)( iter_cnt*tot_sz );
+  FD_LOG_NOTICE(( "decrypt (payload_sz<=%4lu): single %7.3f Mpps %7.3f Gbps, batch %7.3f Mpps %7.3f Gbps",
+                  payload_sz_max,
+                  1e3*pkt_tot/(double)dt_single, bit_tot/(double)dt_single,
+                  1e3*pkt_tot/(double)dt_batch,  bit_tot/(double)dt_batch ));
+}
+
 int
 main( int     argc,
       char ** argv ) {
@@ -348,6 +466,11 @@ main( int     argc,
         suite,
         &client_keys ) == FD_QUIC_FAILED );
 
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+  test_decrypt_batch( suite, &client_keys, rng,  128UL );
+  test_decrypt_batch( suite, &client_keys, rng, 1200UL );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
   fd_quic_crypto_ctx_fini( &crypto_ctx );
 
   FD_LOG_NOTICE(( "pass" ));
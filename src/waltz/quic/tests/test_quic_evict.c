@@ -0,0 +1,161 @@
+#include "../fd_quic.h"
+#include "fd_quic_test_helpers.h"
+
+/* test_quic_evict checks that a server with conn_evict only evicts
+   established unstaked conns on behalf of peers that passed address
+   validation (retry).  Without retry, a new conn that finds no free
+   slot must be rejected instead. */
+
+static ulong server_conn_new_cnt;
+static ulong server_conn_final_cnt;
+
+static void
+my_conn_new( fd_quic_conn_t * conn,
+             void *           vp_context ) {
+  (void)conn; (void)vp_context;
+  server_conn_new_cnt++;
+}
+
+static void
+my_conn_final( fd_quic_conn_t * conn,
+               void *           vp_context ) {
+  (void)conn; (void)vp_context;
+  server_conn_final_cnt++;
+}
+
+static ulong now = 123UL;
+
+static ulong
+test_clock( void * ctx ) {
+  (void)ctx;
+  return now;
+}
+
+static void
+service( fd_quic_t * client_quic,
+         fd_quic_t * server_quic,
+         ulong       iter_cnt ) {
+  for( ulong j=0UL; j<iter_cnt; j++ ) {
+    ulong ct = fd_quic_get_next_wakeup( client_quic );
+    ulong st = fd_quic_get_next_wakeup( server_quic );
+    ulong next_wakeup = fd_ulong_min( ct, st );
+    if( next_wakeup==~0UL ) break;
+    if( next_wakeup>now ) now = next_wakeup;
+    fd_quic_service( client_quic );
+    fd_quic_service( server_quic );
+  }
+}
+
+static void
+test_evict( fd_wksp_t * wksp,
+            fd_rng_t *  rng,
+            int         retry ) {
+  FD_LOG_NOTICE(( "Testing eviction (retry %d)", retry ));
+
+  fd_quic_limits_t quic_limits = {
+    .conn_cnt           = 2,
+    .conn_id_cnt        = 4,
+    .conn_id_sparsity   = 4.0,
+    .handshake_cnt      = 2,
+    .stream_cnt         = { 0, 0, 4, 0 },
+    .initial_stream_cnt = { 0, 0, 4, 0 },
+    .stream_pool_cnt    = 16,
+    .inflight_pkt_cnt   = 64,
+    .tx_buf_sz          = 1<<12
+  };
+
+  fd_quic_t * client_quic = fd_quic_new_anonymous( wksp, &quic_limits, FD_QUIC_ROLE_CLIENT, rng );
+  FD_TEST( client_quic );
+
+  /* Server only has room for one conn */
+  quic_limits.conn_cnt = 1;
+  fd_quic_t * server_quic = fd_quic_new_anonymous( wksp, &quic_limits, FD_QUIC_ROLE_SERVER, rng );
+  FD_TEST( server_quic );
+
+  server_quic->cb.now               = test_clock;
+  server_quic->cb.conn_new          = my_conn_new;
+  server_quic->cb.conn_final        = my_conn_final;
+  server_quic->config.retry         = retry;
+  server_quic->config.conn_evict    = 1;
+  client_quic->cb.now               = test_clock;
+
+  server_conn_new_cnt   = 0UL;
+  server_conn_final_cnt = 0UL;
+
+  fd_quic_virtual_pair_t vp;
+  fd_quic_virtual_pair_init( &vp, server_quic, client_quic );
+
+  FD_TEST( fd_quic_init( server_quic ) );
+  FD_TEST( fd_quic_init( client_quic ) );
+
+  /* First conn takes the only slot */
+
+  fd_quic_conn_t * conn0 = fd_quic_connect( client_quic,
+      server_quic->config.net.ip_addr,
+      server_quic->config.net.listen_udp_port,
+      server_quic->config.sni );
+  FD_TEST( conn0 );
+  service( client_quic, server_quic, 20UL );
+  FD_TEST( server_conn_new_cnt==1UL );
+  FD_TEST( conn0->state==FD_QUIC_CONN_STATE_ACTIVE );
+
+  /* Second conn finds no free slot */
+
+  fd_quic_conn_t * conn1 = fd_quic_connect( client_quic,
+      server_quic->config.net.ip_addr,
+      server_quic->config.net.listen_udp_port,
+      server_quic->config.sni );
+  FD_TEST( conn1 );
+  service( client_quic, server_quic, 20UL );
+
+  if( retry ) {
+    /* Address-validated peer evicts the established conn */
+    FD_TEST( server_quic->metrics.conn_evicted_cnt==1UL );
+    FD_TEST( server_conn_final_cnt==1UL );
+    FD_TEST( server_conn_new_cnt==2UL );
+  } else {
+    /* Unvalidated peer is rejected, established conn is untouched */
+    FD_TEST( server_quic->metrics.conn_evicted_cnt==0UL );
+    FD_TEST( server_quic->metrics.conn_err_no_slots_cnt>0UL );
+    FD_TEST( server_conn_final_cnt==0UL );
+    FD_TEST( server_conn_new_cnt==1UL );
+  }
+
+  fd_quic_virtual_pair_fini( &vp );
+  fd_wksp_free_laddr( fd_quic_delete( fd_quic_leave( fd_quic_fini( server_quic ) ) ) );
+  fd_wksp_free_laddr( fd_quic_delete( fd_quic_leave( fd_quic_fini( client_quic ) ) ) );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot          ( &argc, &argv );
+  fd_quic_test_boot( &argc, &argv );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  ulong cpu_idx = fd_tile_cpu_id( fd_tile_idx() );
+  if( cpu_idx>fd_shmem_cpu_cnt() ) cpu_idx = 0UL;
+
+  char const * _page_sz  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",   NULL, "gigantic"                   );
+  ulong        page_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt",  NULL, 1UL                          );
+  ulong        numa_idx  = fd_env_strip_cmdline_ulong( &argc, &argv, "--numa-idx",  NULL, fd_shmem_numa_idx( cpu_idx ) );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-cnt %lu, --page-sz %s, --numa-idx %lu)", page_cnt, _page_sz, numa_idx ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, fd_shmem_cpu_idx( numa_idx ), "wksp", 0UL );
+  FD_TEST( wksp );
+
+  test_evict( wksp, rng, 0 );
+  test_evict( wksp, rng, 1 );
+
+  fd_wksp_delete_anonymous( wksp );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_quic_test_halt();
+  fd_halt();
+  return 0;
+}
@@ -0,0 +1,203 @@
+#include "../fd_quic_svc_wheel.h"
+#include "../../../util/fd_util.h"
+
+/* Baseline: binary heap, as used by fd_quic prior to the wheel */
+
+struct bench_event {
+  ulong timeout;
+  ulong idx;
+};
+typedef struct bench_event bench_event_t;
+
+#define PRQ_NAME      bench_prq
+#define PRQ_T         bench_event_t
+#define PRQ_TIMEOUT_T ulong
+#include "../../../util/tmpl/fd_prq.c"
+
+#define NODE_MAX (1UL<<20)
+
+static fd_quic_svc_wheel_t wheel_mem[1];
+static fd_quic_svc_node_t  node    [ NODE_MAX ];
+static uchar               sched   [ NODE_MAX ];
+
+static uchar __attribute__((aligned(64))) prq_mem[ 16UL*(NODE_MAX+4UL) ];
+
+/* test_svc_wheel_ref checks the wheel against a brute force scan over
+   nodes, using a random mix of inserts, removes, reschedules and time
+   advances */
+
+static void
+test_svc_wheel_ref( fd_rng_t * rng ) {
+  ulong const node_cnt = 1024UL;
+  ulong       now      = 1700000000000000000UL;
+
+  fd_quic_svc_wheel_t * wheel = fd_quic_svc_wheel_new( wheel_mem, now );
+  FD_TEST( fd_quic_svc_wheel_cnt( wheel )==0UL );
+  FD_TEST( fd_quic_svc_wheel_min( wheel )==ULONG_MAX );
+  FD_TEST( !fd_quic_svc_wheel_pop( wheel, ULONG_MAX-1UL ) );
+
+  memset( sched, 0, node_cnt );
+  ulong cnt = 0UL;
+
+  for( ulong iter=0UL; iter<200000UL; iter++ ) {
+    ulong idx = fd_rng_ulong_roll( rng, node_cnt );
+    uint  r   = fd_rng_uint( rng );
+
+    /* spread of timeouts spanning several wheel levels */
+    ulong delta = fd_rng_ulong( rng ) >> ( 24 + (r>>27) );
+
+    switch( r & 3U ) {
+    case 0U:
+    case 1U:
+      if( sched[ idx ] ) {
+        fd_quic_svc_wheel_remove( wheel, &node[ idx ] );
+        cnt--;
+      }
+      /* occasionally schedule in the past */
+      fd_quic_svc_wheel_insert( wheel, &node[ idx ], ( r & 4U ) ? now + delta : now - ( delta & 0xffffUL ) );
+      sched[ idx ] = ( r & 4U ) ? 1 : 2; /* 2: in the past, due immediately, so not ordered */
+      cnt++;
+      break;
+    case 2U:
+      if( sched[ idx ] ) {
+        fd_quic_svc_wheel_remove( wheel, &node[ idx ] );
+        sched[ idx ] = 0;
+        cnt--;
+      }
+      break;
+    case 3U: {
+      now += delta >> ( r & 8U ? 20 : 8 );
+      ulong last = 0UL;
+      for(;;) {
+        fd_quic_svc_node_t * n = fd_quic_svc_wheel_pop( wheel, now );
+        if( !n ) break;
+        ulong i = (ulong)( n - node );
+        FD_TEST( i<node_cnt && sched[ i ] );
+        FD_TEST( n->timeout<=now );
+        if( sched[ i ]==1 ) {
+          FD_TEST( ( n->timeout>>FD_QUIC_SVC_WHEEL_TICK_LG ) >= last );
+          last = n->timeout>>FD_QUIC_SVC_WHEEL_TICK_LG;
+        }
+        sched[ i ] = 0;
+        cnt--;
+      }
+      break;
+    }
+    }
+
+    FD_TEST( fd_quic_svc_wheel_cnt( wheel )==cnt );
+
+    if( (iter & 63UL)==0UL ) {
+      ulong min = ULONG_MAX;
+      for( ulong i=0UL; i<node_cnt; i++ ) if( sched[ i ] ) min = fd_ulong_min( min, node[ i ].timeout );
+      FD_TEST( fd_quic_svc_wheel_min( wheel )==min );
+    }
+  }
+
+  /* drain */
+  while( fd_quic_svc_wheel_pop( wheel, ULONG_MAX-1UL ) ) cnt--;
+  FD_TEST( cnt==0UL );
+  FD_TEST( fd_quic_svc_wheel_cnt( wheel )==0UL );
+  FD_TEST( fd_quic_svc_wheel_delete( wheel )==wheel_mem );
+}
+
+/* Benchmark: node_cnt connections with service times randomized within
+   svc_interval.  Each step advances time by step_ns, services (pops and
+   reschedules) all due connections, and reschedules resched_cnt random
+   connections earlier, mimicking packet arrival in fd_quic. */
+
+static void
+bench_svc_wheel( fd_rng_t * rng,
+                 ulong      node_cnt,
+                 ulong      step_cnt,
+                 ulong      step_ns,
+                 ulong      svc_interval,
+                 ulong      resched_cnt ) {
+  ulong now = 1700000000000000000UL;
+
+  fd_quic_svc_wheel_t * wheel = fd_quic_svc_wheel_new( wheel_mem, now );
+  for( ulong i=0UL; i<node_cnt; i++ ) {
+    fd_quic_svc_wheel_insert( wheel, &node[ i ], now + 1UL + fd_rng_ulong_roll( rng, svc_interval ) );
+  }
+
+  ulong svc_cnt     = 0UL;
+  ulong resched_tot = 0UL;
+  long  dt          = -fd_log_wallclock();
+  for( ulong step=0UL; step<step_cnt; step++ ) {
+    now += step_ns;
+    fd_quic_svc_node_t * n;
+    while( ( n = fd_quic_svc_wheel_pop( wheel, now ) ) ) {
+      fd_quic_svc_wheel_insert( wheel, n, now + 1UL + fd_rng_ulong_roll( rng, svc_interval ) );
+      svc_cnt++;
+    }
+    for( ulong j=0UL; j<resched_cnt; j++ ) {
+      fd_quic_svc_node_t * r = &node[ fd_rng_ulong_roll( rng, node_cnt ) ];
+      ulong timeout = now + 1UL + fd_rng_ulong_roll( rng, step_ns<<4 );
+      if( timeout < r->timeout ) {
+        fd_quic_svc_wheel_remove( wheel, r );
+        fd_quic_svc_wheel_insert( wheel, r, timeout );
+        resched_tot++;
+      }
+    }
+  }
+  dt += fd_log_wallclock();
+
+  FD_TEST( fd_quic_svc_wheel_cnt( wheel )==node_cnt );
+  ulong op_cnt = svc_cnt + resched_tot;
+  FD_LOG_NOTICE(( "wheel: %lu conns, %lu services, %lu reschedules, %.3f ns/op",
+                  node_cnt, svc_cnt, resched_tot, (double)dt / (double)fd_ulong_max( op_cnt, 1UL ) ));
+  fd_quic_svc_wheel_delete( wheel );
+
+  /* Baseline heap.  Reschedule is not benchmarked as the heap cannot
+     locate an entry without a linear search. */
+
+  now = 1700000000000000000UL;
+  FD_TEST( bench_prq_footprint( node_cnt )<=sizeof(prq_mem) );
+  bench_event_t * prq = bench_prq_join( bench_prq_new( prq_mem, node_cnt ) );
+  for( ulong i=0UL; i<node_cnt; i++ ) {
+    bench_event_t ev[1] = {{ .timeout = now + 1UL + fd_rng_ulong_roll( rng, svc_interval ), .idx = i }};
+    bench_prq_insert( prq, ev );
+  }
+
+  svc_cnt = 0UL;
+  dt      = -fd_log_wallclock();
+  for( ulong step=0UL; step<step_cnt; step++ ) {
+    now += step_ns;
+    while( prq[0].timeout<=now ) {
+      bench_event_t ev[1] = {{ .timeout = now + 1UL + fd_rng_ulong_roll( rng, svc_interval ), .idx = prq[0].idx }};
+      bench_prq_remove_min( prq );
+      bench_prq_insert( prq, ev );
+      svc_cnt++;
+    }
+  }
+  dt += fd_log_wallclock();
+
+  FD_LOG_NOTICE(( "heap:  %lu conns, %lu services, %.3f ns/op",
+                  node_cnt, svc_cnt, (double)dt / (double)fd_ulong_max( svc_cnt, 1UL ) ));
+  bench_prq_delete( bench_prq_leave( prq ) );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong conn_cnt     = fd_env_strip_cmdline_ulong( &argc, &argv, "--conn-cnt",     NULL, NODE_MAX    );
+  ulong step_cnt     = fd_env_strip_cmdline_ulong( &argc, &argv, "--step-cnt",     NULL, 20000UL     );
+  ulong step_ns      = fd_env_strip_cmdline_ulong( &argc, &argv, "--step-ns",      NULL, 5000UL      );
+  ulong svc_interval = fd_env_strip_cmdline_ulong( &argc, &argv, "--svc-interval", NULL, 100000000UL );
+  ulong resched_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--resched-cnt",  NULL, 64UL        );
+  if( FD_UNLIKELY( !conn_cnt || conn_cnt>NODE_MAX ) ) FD_LOG_ERR(( "--conn-cnt must be in [1,%lu]", NODE_MAX ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  test_svc_wheel_ref( rng );
+
+  bench_svc_wheel( rng, conn_cnt, step_cnt, step_ns, svc_interval, resched_cnt );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -140,6 +140,8 @@ fd_xsk_aio_join( void *     shxsk_aio,
   xsk_aio->tx_stack       = fd_xsk_aio_tx_stack( xsk_aio );
   xsk_aio->tx_stack_depth = params->tx_depth;
   xsk_aio->tx_top         = 0;
+  xsk_aio->spare_off      = (params->rx_depth + params->tx_depth) * params->frame_sz;
+  xsk_aio->spare_cnt      = params->umem_sz / params->frame_sz - params->rx_depth - params->tx_depth;
 
   /* Setup local TX */
 
@@ -285,6 +287,28 @@ fd_xsk_aio_service( fd_xsk_aio_t * xsk_aio ) {
 }
 
 
+ulong
+fd_xsk_aio_spare_cnt( fd_xsk_aio_t const * xsk_aio ) {
+  return xsk_aio->spare_cnt;
+}
+
+ulong
+fd_xsk_aio_spare_off( fd_xsk_aio_t const * xsk_aio,
+                      ulong                idx ) {
+  return xsk_aio->spare_off + idx*xsk_aio->frame_sz;
+}
+
+ulong
+fd_xsk_aio_rx_swap( fd_xsk_aio_t * xsk_aio,
+                    ulong          pkt_idx,
+                    ulong          frame_off ) {
+  fd_xsk_frame_meta_t * meta = fd_xsk_aio_meta( xsk_aio ) + pkt_idx;
+  ulong old_off = meta->off & ~(xsk_aio->frame_sz - 1UL);
+  meta->off = frame_off;
+  return old_off;
+}
+
+
 void
 fd_xsk_aio_tx_complete( fd_xsk_aio_t * xsk_aio ) {
   ulong tx_completed = fd_xsk_tx_complete( xsk_aio->xsk,
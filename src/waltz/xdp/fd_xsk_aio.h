@@ -100,6 +100,36 @@ fd_xsk_aio_get_tx( fd_xsk_aio_t const * xsk_aio );
 void
 fd_xsk_aio_service( fd_xsk_aio_t * xsk_aio );
 
+/* fd_xsk_aio_rx_swap allows the rx callback to keep the UMEM frame of
+   a received packet past the end of the callback, instead of having it
+   returned to the fill ring by fd_xsk_aio_service.  pkt_idx is the
+   index of the packet in the batch currently being delivered to the rx
+   callback, frame_off is the byte offset (relative to
+   fd_xsk_umem_laddr) of a frame owned by the caller that is handed to
+   the fill ring in its place.  Returns the byte offset of the frame
+   the packet was received in, which is owned by the caller from then
+   on.  Only valid to call from within the rx callback.
+
+   fd_xsk_aio_spare_cnt returns the number of UMEM frames that are
+   neither used as rx nor as tx frames by xsk_aio, and are thus owned
+   by the caller initially.  fd_xsk_aio_spare_off returns the byte
+   offset of the idx-th such frame, idx in [0,spare_cnt).  Callers
+   keeping frames must hand a frame back for each frame kept, so the
+   number of frames a caller can keep at any point in time is bounded
+   by the spare frame count. */
+
+ulong
+fd_xsk_aio_rx_swap( fd_xsk_aio_t * xsk_aio,
+                    ulong          pkt_idx,
+                    ulong          frame_off );
+
+FD_FN_PURE ulong
+fd_xsk_aio_spare_cnt( fd_xsk_aio_t const * xsk_aio );
+
+FD_FN_PURE ulong
+fd_xsk_aio_spare_off( fd_xsk_aio_t const * xsk_aio,
+                      ulong                idx );
+
 FD_PROTOTYPES_END
 
 #endif /* defined(__linux__) */
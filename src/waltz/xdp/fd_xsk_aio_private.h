@@ -37,6 +37,12 @@ struct __attribute__((aligned(FD_XSK_AIO_ALIGN))) fd_xsk_aio_private {
 
   ulong   frame_sz;       /* Frame size from fd_xsk_params_t */
 
+  /* spare_{off,cnt}: Byte offset from frame_mem of the first UMEM
+     frame not used as an rx or tx frame, and the number of such frames.
+     See fd_xsk_aio_rx_swap. */
+  ulong   spare_off;
+  ulong   spare_cnt;
+
   /* Variable-length data *********************************************/
 
   /* ... fd_xsk_frame_meta_t[ pkt_depth ] follows ... */
@@ -455,6 +455,27 @@ test_xsk_aio_rx( void *                    ctx,
   return FD_AIO_SUCCESS;
 }
 
+/* fd_xsk_aio_t mock fd_aio_t receiver that keeps the frame of the
+   last packet of each batch, handing a spare frame back instead */
+
+static ulong _rx_kept_off;
+
+static int
+test_xsk_aio_rx_keep( void *                    ctx,
+                      fd_aio_pkt_info_t const * batch,
+                      ulong                     batch_cnt,
+                      ulong *                   opt_batch_idx,
+                      int                       flush ) {
+  (void)batch;
+  (void)opt_batch_idx;
+  (void)flush;
+
+  fd_xsk_aio_t * xsk_aio = (fd_xsk_aio_t *)ctx;
+  _rx_call_cnt++;
+  _rx_kept_off = fd_xsk_aio_rx_swap( xsk_aio, batch_cnt-1UL, fd_xsk_aio_spare_off( xsk_aio, 0UL ) );
+  return FD_AIO_SUCCESS;
+}
+
 void
 test_xsk_aio( void ) {
   /* Alignment checks */
@@ -629,6 +650,30 @@ test_xsk_aio( void ) {
     FD_TEST( _rx_batch[i].buf_sz==3U );
   }
 
+  /* Keep received frames */
+
+  FD_TEST( fd_xsk_aio_spare_cnt( xsk_aio )==16UL );
+  FD_TEST( fd_xsk_aio_spare_off( xsk_aio, 0UL )==16UL*2048UL );
+  FD_TEST( fd_xsk_aio_spare_off( xsk_aio, 1UL )==17UL*2048UL );
+
+  fd_aio_t * rx_keep = fd_aio_new( &_rx, xsk_aio, test_xsk_aio_rx_keep );
+  FD_TEST( rx_keep );
+  fd_xsk_aio_set_rx( xsk_aio, rx_keep );
+
+  test_xsk_ring_fr.cons = 12U;
+  test_xsk_ring_rx.packets[2] = (struct xdp_desc) { .addr=2U*2048U,      .len=3U };
+  test_xsk_ring_rx.packets[3] = (struct xdp_desc) { .addr=3U*2048U+256U, .len=3U };
+  test_xsk_ring_rx.prod = 12U;
+
+  fd_xsk_aio_service( xsk_aio );
+
+  FD_TEST( _rx_call_cnt==3UL );
+  FD_TEST( _rx_kept_off==3UL*2048UL );
+  FD_TEST( test_xsk_ring_rx.cons==12U );
+  FD_TEST( test_xsk_ring_fr.prod==20U );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 2 ]== 2UL*2048UL );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 3 ]==16UL*2048UL );
+
   /* Clean up */
 
   FD_TEST( fd_xsk_aio_leave ( xsk_aio   ) );